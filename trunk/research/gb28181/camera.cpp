@@ -0,0 +1,481 @@
+/*
+Synthetic GB28181 cameras, to measure how many cameras a SRS process (a CPU core) could ingest over UDP.
+
+Each camera registers to the SIP server over TCP, answers the INVITE with the SSRC in SDP, then sends H.264 in RTP/PS
+over UDP to the media port. Run SRS with stream_caster gb28181, and set media_transport to udp, for example:
+    make && ./camera -h 127.0.0.1 -s 5060 -n 1000 -r 25 -b 1000
+Then watch the CPU of SRS by top, and the packets/lost stats in logs, increase the cameras until CPU is full.
+
+Note that each camera uses a SIP TCP connection, so please increase the open files by `ulimit -n`.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
+#include <getopt.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include <string>
+#include <vector>
+using namespace std;
+
+// The max RTP payload of PS, to avoid IP fragment.
+#define CAMERA_RTP_PAYLOAD 1400
+// The max payload of a PES packet, limited by the 16bits PES_packet_length.
+#define CAMERA_PES_PAYLOAD 60000
+
+// The SPS and PPS of H.264, from avatar.h264 of srs-bench.
+static const char* camera_sps = "\x67\x64\x00\x20\xac\xd9\x40\xc0\x29\xb0\x11\x00\x00\x03\x00\x01\x00\x00\x03\x00\x32\x0f\x18\x31\x96";
+static const int camera_sps_size = 25;
+static const char* camera_pps = "\x68\xeb\xec\xb2\x2c";
+static const int camera_pps_size = 5;
+
+struct CameraConfig
+{
+    string host;
+    int sip_port;
+    int cameras;
+    int fps;
+    int kbps;
+    int gop;
+    int duration;
+    string domain;
+    string server_id;
+};
+
+enum CameraState
+{
+    CameraStateConnecting = 0,
+    CameraStateRegistered,
+    CameraStatePublishing,
+};
+
+struct Camera
+{
+    int index;
+    string device_id;
+    CameraState state;
+    int sip_fd;
+    string sip_buffer;
+    // The media to send to, parsed from INVITE.
+    uint32_t ssrc;
+    sockaddr_in media;
+    // The RTP state.
+    uint16_t seq;
+    int64_t frames;
+    int64_t next_frame_us;
+};
+
+struct CameraStat
+{
+    int64_t packets;
+    int64_t bytes;
+    int64_t frames;
+    int64_t errors;
+};
+
+int64_t camera_now_us()
+{
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+string camera_fmt(const char* fmt, ...)
+{
+    char buf[4096];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    return buf;
+}
+
+// Get the value of SIP header, such as Call-ID, in the message header.
+string camera_sip_header(const string& msg, const string& name)
+{
+    size_t pos = 0;
+    while (pos < msg.length()) {
+        size_t eol = msg.find("\r\n", pos);
+        if (eol == string::npos) eol = msg.length();
+        string line = msg.substr(pos, eol - pos);
+        pos = eol + 2;
+
+        if (line.length() > name.length() && strncasecmp(line.c_str(), name.c_str(), name.length()) == 0 && line[name.length()] == ':') {
+            string v = line.substr(name.length() + 1);
+            while (!v.empty() && v[0] == ' ') v = v.substr(1);
+            return v;
+        }
+    }
+    return "";
+}
+
+// Get the value of SDP line, such as y=0200000001, in the message body.
+string camera_sdp_line(const string& body, const string& prefix)
+{
+    size_t pos = body.find(string("\n") + prefix);
+    if (pos == string::npos) return "";
+    pos += 1 + prefix.length();
+    size_t eol = body.find_first_of("\r\n", pos);
+    return body.substr(pos, eol == string::npos ? string::npos : eol - pos);
+}
+
+int camera_sip_send(Camera* c, const string& msg)
+{
+    size_t nn = 0;
+    while (nn < msg.length()) {
+        int r0 = ::send(c->sip_fd, msg.data() + nn, msg.length() - nn, 0);
+        if (r0 < 0 && errno == EAGAIN) {
+            usleep(1000);
+            continue;
+        }
+        if (r0 <= 0) return -1;
+        nn += r0;
+    }
+    return 0;
+}
+
+int camera_register(CameraConfig* conf, Camera* c)
+{
+    string msg = camera_fmt("REGISTER sip:%s@%s SIP/2.0\r\n"
+        "Via: SIP/2.0/TCP 127.0.0.1:5060;rport;branch=z9hG4bK%u\r\n"
+        "From: <sip:%s@%s>;tag=%u\r\n"
+        "To: <sip:%s@%s>\r\n"
+        "Call-ID: %u%u\r\n"
+        "CSeq: 1 REGISTER\r\n"
+        "Contact: <sip:%s@127.0.0.1:5060>\r\n"
+        "Max-Forwards: 70\r\n"
+        "Expires: 3600\r\n"
+        "Content-Length: 0\r\n\r\n",
+        conf->server_id.c_str(), conf->domain.c_str(), (uint32_t)random(),
+        c->device_id.c_str(), conf->domain.c_str(), (uint32_t)random(),
+        c->device_id.c_str(), conf->domain.c_str(),
+        (uint32_t)random(), (uint32_t)random(),
+        c->device_id.c_str());
+    return camera_sip_send(c, msg);
+}
+
+// Response 200 OK for INVITE, with the SSRC in SDP, then we're able to publish media.
+int camera_on_invite(CameraConfig* conf, Camera* c, const string& header, const string& body)
+{
+    string y = camera_sdp_line(body, "y=");
+    string m = camera_sdp_line(body, "m=video ");
+    if (y.empty() || m.empty()) {
+        printf("Camera %s: Invalid INVITE SDP %s\n", c->device_id.c_str(), body.c_str());
+        return -1;
+    }
+
+    c->ssrc = (uint32_t)strtoul(y.c_str(), NULL, 10);
+    c->media.sin_family = AF_INET;
+    c->media.sin_port = htons(atoi(m.c_str()));
+    c->media.sin_addr.s_addr = inet_addr(conf->host.c_str());
+
+    if (m.find("TCP/") != string::npos) {
+        printf("Camera %s: Server requires media over TCP, please set media_transport to udp\n", c->device_id.c_str());
+        return -1;
+    }
+
+    string sdp = camera_fmt("v=0\r\n"
+        "o=%s 0 0 IN IP4 127.0.0.1\r\n"
+        "s=Play\r\n"
+        "c=IN IP4 127.0.0.1\r\n"
+        "t=0 0\r\n"
+        "m=video %d RTP/AVP 96\r\n"
+        "a=sendonly\r\n"
+        "a=rtpmap:96 PS/90000\r\n"
+        "y=%s\r\n",
+        c->device_id.c_str(), 15060 + c->index, y.c_str());
+
+    string msg = camera_fmt("SIP/2.0 200 OK\r\n"
+        "Via: %s\r\n"
+        "From: %s\r\n"
+        "To: %s;tag=%u\r\n"
+        "Call-ID: %s\r\n"
+        "CSeq: %s\r\n"
+        "Contact: <sip:%s@127.0.0.1:5060>\r\n"
+        "Content-Type: Application/SDP\r\n"
+        "Content-Length: %d\r\n\r\n",
+        camera_sip_header(header, "Via").c_str(), camera_sip_header(header, "From").c_str(),
+        camera_sip_header(header, "To").c_str(), (uint32_t)random(), camera_sip_header(header, "Call-ID").c_str(),
+        camera_sip_header(header, "CSeq").c_str(), c->device_id.c_str(), (int)sdp.length());
+    return camera_sip_send(c, msg + sdp);
+}
+
+// Consume the SIP messages from server, which is framed by Content-Length.
+int camera_on_sip(CameraConfig* conf, Camera* c)
+{
+    char buf[4096];
+    int nn = ::recv(c->sip_fd, buf, sizeof(buf), 0);
+    if (nn == 0 || (nn < 0 && errno != EAGAIN)) {
+        printf("Camera %s: SIP disconnected, r0=%d, errno=%d\n", c->device_id.c_str(), nn, errno);
+        return -1;
+    }
+    if (nn < 0) return 0;
+    c->sip_buffer.append(buf, nn);
+
+    while (true) {
+        size_t pos = c->sip_buffer.find("\r\n\r\n");
+        if (pos == string::npos) return 0;
+
+        string header = c->sip_buffer.substr(0, pos + 2);
+        int length = atoi(camera_sip_header(header, "Content-Length").c_str());
+        if (c->sip_buffer.length() < pos + 4 + length) return 0;
+
+        string body = c->sip_buffer.substr(pos + 4, length);
+        c->sip_buffer = c->sip_buffer.substr(pos + 4 + length);
+
+        if (header.find("SIP/2.0 200") == 0 && c->state == CameraStateConnecting) {
+            c->state = CameraStateRegistered;
+        } else if (header.find("INVITE ") == 0) {
+            if (camera_on_invite(conf, c, header, body) != 0) return -1;
+        } else if (header.find("ACK ") == 0) {
+            if (c->state != CameraStatePublishing) {
+                c->state = CameraStatePublishing;
+                c->next_frame_us = camera_now_us();
+            }
+        } else if (header.find("BYE ") == 0) {
+            c->state = CameraStateRegistered;
+        }
+    }
+
+    return 0;
+}
+
+void camera_ps_ts(string& s, uint8_t fb, int64_t v)
+{
+    s.append(1, (char)(fb | ((v >> 29) & 0x0e) | 0x01));
+    s.append(1, (char)(v >> 22));
+    s.append(1, (char)(((v >> 14) & 0xfe) | 0x01));
+    s.append(1, (char)(v >> 7));
+    s.append(1, (char)(((v << 1) & 0xfe) | 0x01));
+}
+
+// Build a PS pack for a frame, with pack header, PSM for keyframe and video PES packets.
+void camera_ps_pack(string& pack, int64_t ts, bool keyframe, int size)
+{
+    pack.clear();
+
+    // Table 2-33 – Program Stream pack header, SCR is not used by SRS.
+    pack.append("\x00\x00\x01\xba\x44\x00\x04\x00\x04\x01\x01\x89\xc3\xf8", 14);
+
+    if (keyframe) {
+        // The PSM of H.264 and AAC.
+        pack.append("\x00\x00\x01\xbc\x00\x12\xe0\xff\x00\x00\x00\x08\x1b\xe0\x00\x00\x0f\xc0\x00\x00\x00\x00\x00\x00", 24);
+    }
+
+    string frame;
+    if (keyframe) {
+        frame.append("\x00\x00\x00\x01", 4); frame.append(camera_sps, camera_sps_size);
+        frame.append("\x00\x00\x00\x01", 4); frame.append(camera_pps, camera_pps_size);
+        frame.append("\x00\x00\x00\x01\x65\x88\x84", 7);
+    } else {
+        frame.append("\x00\x00\x00\x01\x41\x9a\x02", 7);
+    }
+    // The filler never contains start code.
+    if ((int)frame.length() < size) {
+        frame.append(size - frame.length(), (char)0xaa);
+    }
+
+    for (size_t pos = 0; pos < frame.length(); pos += CAMERA_PES_PAYLOAD) {
+        int nn = (int)min((size_t)CAMERA_PES_PAYLOAD, frame.length() - pos);
+        bool first = !pos;
+
+        pack.append("\x00\x00\x01\xe0", 4);
+        int length = 3 + (first ? 5 : 0) + nn;
+        pack.append(1, (char)(length >> 8));
+        pack.append(1, (char)length);
+        pack.append(1, (char)0x80);
+        pack.append(1, (char)(first ? 0x80 : 0x00));
+        pack.append(1, (char)(first ? 5 : 0));
+        if (first) camera_ps_ts(pack, 0x20, ts);
+        pack.append(frame.data() + pos, nn);
+    }
+}
+
+// Send the PS pack in RTP packets, the marker is set for the last packet.
+void camera_send_frame(int fd, Camera* c, const string& pack, uint32_t ts, CameraStat* stat)
+{
+    char buf[12 + CAMERA_RTP_PAYLOAD];
+    for (size_t pos = 0; pos < pack.length(); pos += CAMERA_RTP_PAYLOAD) {
+        int nn = (int)min((size_t)CAMERA_RTP_PAYLOAD, pack.length() - pos);
+        bool marker = pos + nn >= pack.length();
+
+        uint16_t seq = c->seq++;
+        buf[0] = (char)0x80;
+        buf[1] = (char)(marker ? 0xe0 : 0x60);
+        buf[2] = (char)(seq >> 8); buf[3] = (char)seq;
+        buf[4] = (char)(ts >> 24); buf[5] = (char)(ts >> 16); buf[6] = (char)(ts >> 8); buf[7] = (char)ts;
+        buf[8] = (char)(c->ssrc >> 24); buf[9] = (char)(c->ssrc >> 16); buf[10] = (char)(c->ssrc >> 8); buf[11] = (char)c->ssrc;
+        memcpy(buf + 12, pack.data() + pos, nn);
+
+        if (::sendto(fd, buf, 12 + nn, 0, (sockaddr*)&c->media, sizeof(sockaddr_in)) != 12 + nn) {
+            stat->errors++;
+            continue;
+        }
+        stat->packets++;
+        stat->bytes += 12 + nn;
+    }
+    stat->frames++;
+}
+
+int camera_connect(CameraConfig* conf, Camera* c)
+{
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(conf->sip_port);
+    addr.sin_addr.s_addr = inet_addr(conf->host.c_str());
+    if (::connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+
+    int v = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &v, sizeof(v));
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    c->sip_fd = fd;
+
+    return camera_register(conf, c);
+}
+
+void camera_usage(char* argv0)
+{
+    printf("Usage: %s [-h host] [-s sip_port] [-n cameras] [-r fps] [-b kbps] [-g gop] [-d duration]\n"
+        "   -h  The SRS server IP. Default: 127.0.0.1\n"
+        "   -s  The SIP TCP port. Default: 5060\n"
+        "   -n  The number of cameras. Default: 1\n"
+        "   -r  The frame rate of each camera. Default: 25\n"
+        "   -b  The bitrate in kbps of each camera. Default: 1000\n"
+        "   -g  The GOP in frames. Default: 50\n"
+        "   -d  The duration in seconds to run, 0 for forever. Default: 0\n", argv0);
+}
+
+int main(int argc, char** argv)
+{
+    CameraConfig conf;
+    conf.host = "127.0.0.1";
+    conf.sip_port = 5060;
+    conf.cameras = 1;
+    conf.fps = 25;
+    conf.kbps = 1000;
+    conf.gop = 50;
+    conf.duration = 0;
+    conf.domain = "3402000000";
+    conf.server_id = "34020000002000000001";
+
+    int opt;
+    while ((opt = getopt(argc, argv, "h:s:n:r:b:g:d:")) != -1) {
+        switch (opt) {
+            case 'h': conf.host = optarg; break;
+            case 's': conf.sip_port = atoi(optarg); break;
+            case 'n': conf.cameras = atoi(optarg); break;
+            case 'r': conf.fps = atoi(optarg); break;
+            case 'b': conf.kbps = atoi(optarg); break;
+            case 'g': conf.gop = atoi(optarg); break;
+            case 'd': conf.duration = atoi(optarg); break;
+            default: camera_usage(argv[0]); exit(-1);
+        }
+    }
+    if (conf.cameras <= 0 || conf.fps <= 0 || conf.kbps <= 0 || conf.gop <= 0) {
+        camera_usage(argv[0]);
+        exit(-1);
+    }
+
+    srandom((unsigned)camera_now_us());
+
+    // All cameras send media by the same UDP socket, because SRS dispatch packets by SSRC.
+    int media_fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    int sndbuf = 10 * 1024 * 1024;
+    setsockopt(media_fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+
+    vector<Camera> cameras(conf.cameras);
+    for (int i = 0; i < conf.cameras; i++) {
+        Camera* c = &cameras[i];
+        c->index = i;
+        c->device_id = camera_fmt("34020000001320%06d", i);
+        c->state = CameraStateConnecting;
+        c->sip_fd = -1;
+        c->ssrc = 0;
+        c->seq = (uint16_t)random();
+        c->frames = 0;
+        c->next_frame_us = 0;
+        memset(&c->media, 0, sizeof(sockaddr_in));
+
+        if (camera_connect(&conf, c) != 0) {
+            printf("Camera %s: Connect to %s:%d failed, errno=%d\n", c->device_id.c_str(), conf.host.c_str(), conf.sip_port, errno);
+            exit(-1);
+        }
+    }
+    printf("Start %d cameras to %s:%d, fps=%d, kbps=%d, gop=%d\n", conf.cameras, conf.host.c_str(), conf.sip_port,
+        conf.fps, conf.kbps, conf.gop);
+
+    int frame_size = conf.kbps * 1000 / 8 / conf.fps;
+    int64_t frame_us = 1000000 / conf.fps;
+    int64_t starttime = camera_now_us();
+    int64_t last_print = starttime;
+
+    CameraStat stat, last;
+    memset(&stat, 0, sizeof(stat));
+    memset(&last, 0, sizeof(last));
+
+    vector<pollfd> fds(conf.cameras);
+    string pack;
+
+    while (!conf.duration || camera_now_us() - starttime < (int64_t)conf.duration * 1000000) {
+        for (int i = 0; i < conf.cameras; i++) {
+            fds[i].fd = cameras[i].sip_fd;
+            fds[i].events = POLLIN;
+            fds[i].revents = 0;
+        }
+        ::poll(&fds[0], fds.size(), 1);
+
+        for (int i = 0; i < conf.cameras; i++) {
+            if ((fds[i].revents & (POLLIN | POLLERR | POLLHUP)) && camera_on_sip(&conf, &cameras[i]) != 0) {
+                exit(-1);
+            }
+        }
+
+        // Send the frames of all cameras which is due, the keyframe is larger than others.
+        int64_t now = camera_now_us();
+        int publishing = 0;
+        for (int i = 0; i < conf.cameras; i++) {
+            Camera* c = &cameras[i];
+            if (c->state != CameraStatePublishing) continue;
+            publishing++;
+
+            while (c->next_frame_us <= now) {
+                bool keyframe = (c->frames % conf.gop) == 0;
+                int64_t ts = c->frames * 90000 / conf.fps;
+                camera_ps_pack(pack, ts, keyframe, keyframe ? frame_size * 3 : frame_size);
+                camera_send_frame(media_fd, c, pack, (uint32_t)ts, &stat);
+
+                c->frames++;
+                c->next_frame_us += frame_us;
+            }
+        }
+
+        if (now - last_print >= 5 * 1000000) {
+            double elapsed = (now - last_print) / 1000000.0;
+            printf("Cameras=%d, publishing=%d, fps=%.1f, pps=%.1f, kbps=%.1f, errors=%" PRId64 "\n", conf.cameras, publishing,
+                (stat.frames - last.frames) / elapsed, (stat.packets - last.packets) / elapsed,
+                (stat.bytes - last.bytes) * 8 / 1000.0 / elapsed, stat.errors);
+            last = stat;
+            last_print = now;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,112 @@
+/*
+Benchmark the SRTP cipher suites in packets/sec per core, libsrtp should be built with openssl for GCM:
+g++ srtp-bench.cpp -I../../objs/srtp2/include -I../../objs/openssl/include \
+    ../../objs/srtp2/lib/libsrtp2.a ../../objs/openssl/lib/libcrypto.a -ldl -lpthread -g -O2 -o srtp-bench &&
+./srtp-bench 1200 3
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/time.h>
+#include <srtp2/srtp.h>
+
+int64_t now_us()
+{
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000 * 1000 + tv.tv_usec;
+}
+
+typedef void (*set_policy_t)(srtp_crypto_policy_t* p);
+
+// Protect packets for seconds by the cipher suite, return the packets/sec, or -1 if not supported.
+double bench(set_policy_t set_policy, int key_len, int size, int seconds)
+{
+    srtp_policy_t policy;
+    memset(&policy, 0, sizeof(policy));
+    set_policy(&policy.rtp);
+    set_policy(&policy.rtcp);
+    policy.ssrc.type = ssrc_any_outbound;
+    policy.window_size = 8192;
+    policy.allow_repeat_tx = 1;
+
+    uint8_t key[64];
+    for (int i = 0; i < key_len; i++) {
+        key[i] = (uint8_t)rand();
+    }
+    policy.key = key;
+
+    srtp_t ctx = NULL;
+    if (srtp_create(&ctx, &policy) != srtp_err_status_ok) {
+        return -1;
+    }
+
+    // The RTP packet, with 12 bytes header and payload, and room for the auth tag.
+    uint8_t* pkt = new uint8_t[size + 64];
+    memset(pkt, 0xab, size);
+    pkt[0] = 0x80; pkt[1] = 96;
+    pkt[8] = 0x12; pkt[9] = 0x34; pkt[10] = 0x56; pkt[11] = 0x78;
+
+    int64_t nn = 0;
+    int64_t start = now_us();
+    int64_t deadline = start + (int64_t)seconds * 1000 * 1000;
+    uint16_t seq = 0;
+    while (true) {
+        // Check the time every batch of packets.
+        for (int i = 0; i < 1000; i++, nn++, seq++) {
+            pkt[2] = (uint8_t)(seq >> 8); pkt[3] = (uint8_t)seq;
+            pkt[0] = 0x80; pkt[1] = 96;
+
+            int len = size;
+            if (srtp_protect(ctx, pkt, &len) != srtp_err_status_ok) {
+                srtp_dealloc(ctx);
+                delete[] pkt;
+                return -1;
+            }
+        }
+        if (now_us() >= deadline) {
+            break;
+        }
+    }
+
+    double pps = nn * 1000.0 * 1000 / (now_us() - start);
+    srtp_dealloc(ctx);
+    delete[] pkt;
+    return pps;
+}
+
+int main(int argc, char** argv)
+{
+    int size = (argc > 1) ? atoi(argv[1]) : 1200;
+    int seconds = (argc > 2) ? atoi(argv[2]) : 3;
+
+    if (srtp_init() != srtp_err_status_ok) {
+        printf("srtp init failed\n");
+        return -1;
+    }
+
+    struct {
+        const char* name;
+        set_policy_t set_policy;
+        int key_len;
+    } suites[] = {
+        {"AES_CM_128_HMAC_SHA1_80", srtp_crypto_policy_set_rtp_default, SRTP_AES_ICM_128_KEY_LEN_WSALT},
+        {"AES_CM_128_HMAC_SHA1_32", srtp_crypto_policy_set_aes_cm_128_hmac_sha1_32, SRTP_AES_ICM_128_KEY_LEN_WSALT},
+        {"AEAD_AES_128_GCM", srtp_crypto_policy_set_aes_gcm_128_16_auth, SRTP_AES_GCM_128_KEY_LEN_WSALT},
+        {"AEAD_AES_256_GCM", srtp_crypto_policy_set_aes_gcm_256_16_auth, SRTP_AES_GCM_256_KEY_LEN_WSALT},
+    };
+
+    printf("Protect RTP packets of %d bytes for %ds each suite, on one core\n", size, seconds);
+    for (int i = 0; i < (int)(sizeof(suites) / sizeof(suites[0])); i++) {
+        double pps = bench(suites[i].set_policy, suites[i].key_len, size, seconds);
+        if (pps < 0) {
+            printf("%-24s not supported, please build libsrtp with openssl\n", suites[i].name);
+            continue;
+        }
+        printf("%-24s %10.0f packets/s, %8.1f Mbps\n", suites[i].name, pps, pps * size * 8 / 1000 / 1000);
+    }
+
+    srtp_shutdown();
+    return 0;
+}
@@ -0,0 +1,194 @@
+/*
+Benchmark the hop of SRTP offload, that is the cost of the hybrid thread to protect a batch of RTP packets
+inline, compared to hand it to a worker thread and wait for the done notification by pipe:
+g++ srtp-offload-bench.cpp -I../../objs/srtp2/include -I../../objs/openssl/include \
+    ../../objs/srtp2/lib/libsrtp2.a ../../objs/openssl/lib/libcrypto.a -ldl -lpthread -g -O2 -o srtp-offload-bench &&
+./srtp-offload-bench 1200 16 3
+The "hybrid cpu" is the CPU time of the calling thread for each batch, which is what the offload saves for
+the RTP work, and the "wall" is the latency of each batch. The offload only pays off when the worker runs on
+another core, so it's a net loss on a single core host.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <srtp2/srtp.h>
+
+int64_t now_us()
+{
+    timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000 * 1000 + tv.tv_usec;
+}
+
+int64_t cpu_us()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (int64_t)ts.tv_sec * 1000 * 1000 + ts.tv_nsec / 1000;
+}
+
+struct Batch
+{
+    srtp_t ctx;
+    uint8_t** packets;
+    int nn_packets;
+    int size;
+    uint16_t seq;
+};
+
+// Protect all packets in batch, as SrsSRTP::do_protect_rtps.
+void protect(Batch* b)
+{
+    for (int i = 0; i < b->nn_packets; i++, b->seq++) {
+        uint8_t* pkt = b->packets[i];
+        pkt[0] = 0x80; pkt[1] = 96;
+        pkt[2] = (uint8_t)(b->seq >> 8); pkt[3] = (uint8_t)b->seq;
+
+        int len = b->size;
+        if (srtp_protect(b->ctx, pkt, &len) != srtp_err_status_ok) {
+            printf("protect failed\n");
+            exit(-1);
+        }
+    }
+}
+
+// The worker thread, as SrsAsyncSrtpWorkers::do_cycle, notify the caller by pipe.
+struct Worker
+{
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    Batch* task;
+    bool quit;
+    int pipes[2];
+};
+
+void* worker_cycle(void* arg)
+{
+    Worker* w = (Worker*)arg;
+    while (true) {
+        pthread_mutex_lock(&w->lock);
+        while (!w->task && !w->quit) {
+            pthread_cond_wait(&w->cond, &w->lock);
+        }
+        Batch* b = w->task;
+        w->task = NULL;
+        pthread_mutex_unlock(&w->lock);
+
+        if (!b) {
+            break;
+        }
+
+        protect(b);
+        if (write(w->pipes[1], "d", 1) != 1) {
+            printf("notify failed\n");
+            exit(-1);
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char** argv)
+{
+    int size = (argc > 1) ? atoi(argv[1]) : 1200;
+    int nn_packets = (argc > 2) ? atoi(argv[2]) : 16;
+    int seconds = (argc > 3) ? atoi(argv[3]) : 3;
+
+    if (srtp_init() != srtp_err_status_ok) {
+        printf("srtp init failed\n");
+        return -1;
+    }
+
+    srtp_policy_t policy;
+    memset(&policy, 0, sizeof(policy));
+    srtp_crypto_policy_set_rtp_default(&policy.rtp);
+    srtp_crypto_policy_set_rtcp_default(&policy.rtcp);
+    policy.ssrc.type = ssrc_any_outbound;
+    policy.window_size = 8192;
+    policy.allow_repeat_tx = 1;
+
+    uint8_t key[SRTP_AES_ICM_128_KEY_LEN_WSALT];
+    for (int i = 0; i < (int)sizeof(key); i++) {
+        key[i] = (uint8_t)rand();
+    }
+    policy.key = key;
+
+    Batch b;
+    memset(&b, 0, sizeof(b));
+    if (srtp_create(&b.ctx, &policy) != srtp_err_status_ok) {
+        printf("srtp create failed\n");
+        return -1;
+    }
+    b.nn_packets = nn_packets;
+    b.size = size;
+    b.packets = new uint8_t*[nn_packets];
+    for (int i = 0; i < nn_packets; i++) {
+        b.packets[i] = new uint8_t[size + 64];
+        memset(b.packets[i], 0xab, size);
+    }
+
+    Worker w;
+    memset(&w, 0, sizeof(w));
+    pthread_mutex_init(&w.lock, NULL);
+    pthread_cond_init(&w.cond, NULL);
+    if (pipe(w.pipes) < 0) {
+        printf("create pipe failed\n");
+        return -1;
+    }
+
+    pthread_t trd;
+    pthread_create(&trd, NULL, worker_cycle, &w);
+
+    printf("Protect batches of %d RTP packets of %d bytes for %ds each mode, %ld cores\n",
+        nn_packets, size, seconds, sysconf(_SC_NPROCESSORS_ONLN));
+
+    double inline_cpu = 0;
+    for (int mode = 0; mode < 2; mode++) {
+        int64_t nn = 0;
+        int64_t start = now_us(), cpu_start = cpu_us();
+        int64_t deadline = start + (int64_t)seconds * 1000 * 1000;
+        while (now_us() < deadline) {
+            for (int i = 0; i < 100; i++, nn++) {
+                if (mode == 0) {
+                    protect(&b);
+                    continue;
+                }
+
+                // Hand the batch to worker, then wait for it done, as SrsAsyncSrtpWorkers::protect_rtps.
+                pthread_mutex_lock(&w.lock);
+                w.task = &b;
+                pthread_cond_signal(&w.cond);
+                pthread_mutex_unlock(&w.lock);
+
+                char buf[64];
+                if (read(w.pipes[0], buf, sizeof(buf)) <= 0) {
+                    printf("read pipe failed\n");
+                    return -1;
+                }
+            }
+        }
+
+        double cpu = (cpu_us() - cpu_start) / (double)nn;
+        double wall = (now_us() - start) / (double)nn;
+        if (mode == 0) {
+            inline_cpu = cpu;
+        }
+        printf("%-8s hybrid cpu %7.2fus/batch, wall %7.2fus/batch, %10.0f batches/s, hybrid cpu saved %5.1f%%\n",
+            mode == 0 ? "inline" : "offload", cpu, wall, 1000.0 * 1000 / wall,
+            mode == 0 ? 0.0 : (inline_cpu - cpu) * 100 / inline_cpu);
+    }
+
+    pthread_mutex_lock(&w.lock);
+    w.quit = true;
+    pthread_cond_signal(&w.cond);
+    pthread_mutex_unlock(&w.lock);
+    pthread_join(trd, NULL);
+
+    srtp_dealloc(b.ctx);
+    srtp_shutdown();
+    return 0;
+}
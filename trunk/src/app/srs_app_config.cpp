@@ -2274,7 +2274,7 @@ srs_error_t SrsConfig::check_normal_config()
             && n != "inotify_auto_reload" && n != "auto_reload_for_docker" && n != "tcmalloc_release_rate"
             && n != "query_latest_version" && n != "first_wait_for_qlv" && n != "threads"
             && n != "circuit_breaker" && n != "is_full" && n != "in_docker" && n != "tencentcloud_cls"
-            && n != "exporter"
+            && n != "exporter" && n != "edge_relay"
             ) {
             return srs_error_new(ERROR_SYSTEM_CONFIG_INVALID, "illegal directive %s", n.c_str());
         }
@@ -2347,7 +2347,7 @@ srs_error_t SrsConfig::check_normal_config()
             if (n != "enabled" && n != "listen" && n != "dir" && n != "candidate" && n != "ecdsa" && n != "tcp"
                 && n != "encrypt" && n != "reuseport" && n != "merge_nalus" && n != "black_hole" && n != "protocol"
                 && n != "ip_family" && n != "api_as_candidates" && n != "resolve_api_domain"
-                && n != "keep_api_domain" && n != "use_auto_detect_network_ip") {
+                && n != "keep_api_domain" && n != "use_auto_detect_network_ip" && n != "srtp_gcm") {
                 return srs_error_new(ERROR_SYSTEM_CONFIG_INVALID, "illegal rtc_server.%s", n.c_str());
             }
         }
@@ -2361,6 +2361,15 @@ srs_error_t SrsConfig::check_normal_config()
             }
         }
     }
+    if (true) {
+        SrsConfDirective* conf = root->get("edge_relay");
+        for (int i = 0; conf && i < (int)conf->directives.size(); i++) {
+            string n = conf->at(i)->name;
+            if (n != "enabled" && n != "listen") {
+                return srs_error_new(ERROR_SYSTEM_CONFIG_INVALID, "illegal edge_relay.%s", n.c_str());
+            }
+        }
+    }
 
     ////////////////////////////////////////////////////////////////////////
     // check listen for rtmp.
@@ -2480,7 +2489,8 @@ srs_error_t SrsConfig::check_normal_config()
         for (int i = 0; stream_caster && i < (int)stream_caster->directives.size(); i++) {
             SrsConfDirective* conf = stream_caster->at(i);
             string n = conf->name;
-            if (n != "enabled" && n != "caster" && n != "output" && n != "listen" && n != "sip") {
+            if (n != "enabled" && n != "caster" && n != "output" && n != "listen" && n != "sip"
+                && n != "media_transport") {
                 return srs_error_new(ERROR_SYSTEM_CONFIG_INVALID, "illegal stream_caster.%s", n.c_str());
             }
 
@@ -2589,7 +2599,7 @@ srs_error_t SrsConfig::check_normal_config()
                 for (int j = 0; j < (int)conf->directives.size(); j++) {
                     string m = conf->at(j)->name;
                     if (m != "enabled" && m != "dash_fragment" && m != "dash_update_period" && m != "dash_timeshift" && m != "dash_path"
-                        && m != "dash_mpd_file" && m != "dash_window_size" && m != "dash_dispose" && m != "dash_cleanup") {
+                        && m != "dash_mpd_file" && m != "dash_window_size" && m != "dash_dispose" && m != "dash_cleanup" && m != "dash_chunk") {
                         return srs_error_new(ERROR_SYSTEM_CONFIG_INVALID, "illegal vhost.dash.%s of %s", m.c_str(), vhost->arg0().c_str());
                     }
                 }
@@ -2614,16 +2624,20 @@ srs_error_t SrsConfig::check_normal_config()
                     string m = conf->at(j)->name;
                     if (m != "enabled" && m != "on_connect" && m != "on_close" && m != "on_publish"
                         && m != "on_unpublish" && m != "on_play" && m != "on_stop"
-                        && m != "on_dvr" && m != "on_hls" && m != "on_hls_notify") {
+                        && m != "on_dvr" && m != "on_hls" && m != "on_hls_notify" && m != "cache_ttl"
+                        && m != "cache_negative_ttl") {
                         return srs_error_new(ERROR_SYSTEM_CONFIG_INVALID, "illegal vhost.http_hooks.%s of %s", m.c_str(), vhost->arg0().c_str());
                     }
                 }
             } else if (n == "forward") {
                 for (int j = 0; j < (int)conf->directives.size(); j++) {
                     string m = conf->at(j)->name;
-                    if (m != "enabled" && m != "destination" && m != "backend") {
+                    if (m != "enabled" && m != "destination" && m != "backend" && m != "backpressure") {
                         return srs_error_new(ERROR_SYSTEM_CONFIG_INVALID, "illegal vhost.forward.%s of %s", m.c_str(), vhost->arg0().c_str());
                     }
+                    if (m == "backpressure" && conf->at(j)->arg0() != "drop" && conf->at(j)->arg0() != "disconnect") {
+                        return srs_error_new(ERROR_SYSTEM_CONFIG_INVALID, "illegal vhost.forward.backpressure %s of %s", conf->at(j)->arg0().c_str(), vhost->arg0().c_str());
+                    }
                 }
             } else if (n == "security") {
                 for (int j = 0; j < (int)conf->directives.size(); j++) {
@@ -2657,17 +2671,17 @@ srs_error_t SrsConfig::check_normal_config()
             } else if (n == "rtc") {
                 for (int j = 0; j < (int)conf->directives.size(); j++) {
                     string m = conf->at(j)->name;
-                    if (m != "enabled" && m != "nack" && m != "twcc" && m != "nack_no_copy"
+                    if (m != "enabled" && m != "nack" && m != "twcc" && m != "pacer" && m != "nack_no_copy"
                         && m != "bframe" && m != "aac" && m != "stun_timeout" && m != "stun_strict_check"
                         && m != "dtls_role" && m != "dtls_version" && m != "drop_for_pt" && m != "rtc_to_rtmp"
-                        && m != "pli_for_rtmp" && m != "rtmp_to_rtc" && m != "keep_bframe") {
+                        && m != "pli_for_rtmp" && m != "jitter_for_rtmp" && m != "rtmp_to_rtc" && m != "keep_bframe") {
                         return srs_error_new(ERROR_SYSTEM_CONFIG_INVALID, "illegal vhost.rtc.%s of %s", m.c_str(), vhost->arg0().c_str());
                     }
                 }
             } else if (n == "srt") {
                 for (int j = 0; j < (int)conf->directives.size(); j++) {
                     string m = conf->at(j)->name;
-                    if (m != "enabled" && m != "srt_to_rtmp") {
+                    if (m != "enabled" && m != "srt_to_rtmp" && m != "srt_to_hls") {
                         return srs_error_new(ERROR_SYSTEM_CONFIG_INVALID, "illegal vhost.srt.%s of %s", m.c_str(), vhost->arg0().c_str());
                     }
                 }
@@ -3236,6 +3250,44 @@ srs_utime_t SrsConfig::get_threads_interval()
     return v * SRS_UTIME_SECONDS;
 }
 
+bool SrsConfig::get_threads_async_file_io()
+{
+    SRS_OVERWRITE_BY_ENV_BOOL2("srs.threads.async_file_io"); // SRS_THREADS_ASYNC_FILE_IO
+
+    static bool DEFAULT = true;
+
+    SrsConfDirective* conf = root->get("threads");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("async_file_io");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    return SRS_CONF_PERFER_TRUE(conf->arg0());
+}
+
+int SrsConfig::get_threads_srtp_workers()
+{
+    SRS_OVERWRITE_BY_ENV_INT("srs.threads.srtp_workers"); // SRS_THREADS_SRTP_WORKERS
+
+    static int DEFAULT = 0;
+
+    SrsConfDirective* conf = root->get("threads");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("srtp_workers");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+
+    return ::atoi(conf->arg0().c_str());
+}
+
 bool SrsConfig::get_circuit_breaker()
 {
     SRS_OVERWRITE_BY_ENV_BOOL2("srs.circuit_breaker.enabled"); // SRS_CIRCUIT_BREAKER_ENABLED
@@ -3787,6 +3839,44 @@ string SrsConfig::get_exporter_tag()
     return conf->arg0();
 }
 
+bool SrsConfig::get_edge_relay_enabled()
+{
+    SRS_OVERWRITE_BY_ENV_BOOL("srs.edge_relay.enabled"); // SRS_EDGE_RELAY_ENABLED
+
+    static bool DEFAULT = false;
+
+    SrsConfDirective* conf = root->get("edge_relay");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("enabled");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    return SRS_CONF_PERFER_FALSE(conf->arg0());
+}
+
+string SrsConfig::get_edge_relay_listen()
+{
+    SRS_OVERWRITE_BY_ENV_STRING("srs.edge_relay.listen"); // SRS_EDGE_RELAY_LISTEN
+
+    static string DEFAULT = "./objs/srs.edge.sock";
+
+    SrsConfDirective* conf = root->get("edge_relay");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("listen");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+
+    return conf->arg0();
+}
+
 vector<SrsConfDirective*> SrsConfig::get_stream_casters()
 {
     srs_assert(root);
@@ -3870,6 +3960,22 @@ int SrsConfig::get_stream_caster_listen(SrsConfDirective* conf)
     return ::atoi(conf->arg0().c_str());
 }
 
+string SrsConfig::get_stream_caster_media_transport(SrsConfDirective* conf)
+{
+    static string DEFAULT = "tcp";
+
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("media_transport");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+
+    return conf->arg0();
+}
+
 bool SrsConfig::get_stream_caster_sip_enable(SrsConfDirective* conf)
 {
     static bool DEFAULT = true;
@@ -4257,6 +4363,25 @@ bool SrsConfig::get_rtc_server_encrypt()
     return SRS_CONF_PERFER_TRUE(conf->arg0());
 }
 
+bool SrsConfig::get_rtc_server_srtp_gcm()
+{
+    SRS_OVERWRITE_BY_ENV_BOOL2("srs.rtc_server.srtp_gcm"); // SRS_RTC_SERVER_SRTP_GCM
+
+    static bool DEFAULT = true;
+
+    SrsConfDirective* conf = root->get("rtc_server");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("srtp_gcm");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+
+    return SRS_CONF_PERFER_TRUE(conf->arg0());
+}
+
 int SrsConfig::get_rtc_server_reuseport()
 {
     int v = get_rtc_server_reuseport2();
@@ -4570,6 +4695,35 @@ srs_utime_t SrsConfig::get_rtc_pli_for_rtmp(string vhost)
     return v;
 }
 
+srs_utime_t SrsConfig::get_rtc_jitter_for_rtmp(string vhost)
+{
+    static srs_utime_t DEFAULT = 300 * SRS_UTIME_MILLISECONDS;
+    srs_utime_t v = 0;
+
+    if (!srs_getenv("srs.vhost.rtc.jitter_for_rtmp").empty()) { // SRS_VHOST_RTC_JITTER_FOR_RTMP
+        v = (srs_utime_t)(::atof(srs_getenv("srs.vhost.rtc.jitter_for_rtmp").c_str()) * SRS_UTIME_SECONDS);
+    } else {
+        SrsConfDirective* conf = get_rtc(vhost);
+        if (!conf) {
+            return DEFAULT;
+        }
+
+        conf = conf->get("jitter_for_rtmp");
+        if (!conf || conf->arg0().empty()) {
+            return DEFAULT;
+        }
+
+        v = (srs_utime_t)(::atof(conf->arg0().c_str()) * SRS_UTIME_SECONDS);
+    }
+
+    if (v < 0 || v > 3 * SRS_UTIME_SECONDS) {
+        srs_warn("Reset jitter %dms to %dms", srsu2msi(v), srsu2msi(DEFAULT));
+        return DEFAULT;
+    }
+
+    return v;
+}
+
 bool SrsConfig::get_rtc_nack_enabled(string vhost)
 {
     SRS_OVERWRITE_BY_ENV_BOOL2("srs.vhost.rtc.nack"); // SRS_VHOST_RTC_NACK
@@ -4627,6 +4781,25 @@ bool SrsConfig::get_rtc_twcc_enabled(string vhost)
     return SRS_CONF_PERFER_TRUE(conf->arg0());
 }
 
+bool SrsConfig::get_rtc_pacer_enabled(string vhost)
+{
+    SRS_OVERWRITE_BY_ENV_BOOL("srs.vhost.rtc.pacer"); // SRS_VHOST_RTC_PACER
+
+    static bool DEFAULT = false;
+
+    SrsConfDirective* conf = get_rtc(vhost);
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("pacer");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    return SRS_CONF_PERFER_FALSE(conf->arg0());
+}
+
 SrsConfDirective* SrsConfig::get_vhost(string vhost, bool try_default_vhost)
 {
     srs_assert(root);
@@ -5447,6 +5620,43 @@ SrsConfDirective* SrsConfig::get_forward_backend(string vhost)
     return conf->get("backend");
 }
 
+string SrsConfig::get_forward_backpressure(string vhost, string destination)
+{
+    SRS_OVERWRITE_BY_ENV_STRING("srs.vhost.forward.backpressure"); // SRS_VHOST_FORWARD_BACKPRESSURE
+
+    static string DEFAULT = "drop";
+
+    SrsConfDirective* conf = get_vhost(vhost);
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("forward");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    // The policy for the specified destinations overwrites the policy for all destinations.
+    string policy = DEFAULT;
+    for (int i = 0; i < (int)conf->directives.size(); i++) {
+        SrsConfDirective* dir = conf->directives.at(i);
+        if (dir->name != "backpressure" || dir->arg0().empty()) {
+            continue;
+        }
+
+        if (dir->args.size() == 1) {
+            policy = dir->arg0();
+            continue;
+        }
+
+        if (std::find(dir->args.begin() + 1, dir->args.end(), destination) != dir->args.end()) {
+            return dir->arg0();
+        }
+    }
+
+    return policy;
+}
+
 SrsConfDirective* SrsConfig::get_vhost_http_hooks(string vhost)
 {
     SrsConfDirective* conf = get_vhost(vhost);
@@ -5490,6 +5700,44 @@ bool SrsConfig::get_vhost_http_hooks_enabled(SrsConfDirective* vhost)
     return SRS_CONF_PERFER_FALSE(conf->arg0());
 }
 
+srs_utime_t SrsConfig::get_vhost_http_hooks_cache_ttl(string vhost)
+{
+    SRS_OVERWRITE_BY_ENV_SECONDS("srs.vhost.http_hooks.cache_ttl"); // SRS_VHOST_HTTP_HOOKS_CACHE_TTL
+
+    static srs_utime_t DEFAULT = 0;
+
+    SrsConfDirective* conf = get_vhost_http_hooks(vhost);
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("cache_ttl");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+
+    return srs_utime_t(::atoi(conf->arg0().c_str()) * SRS_UTIME_SECONDS);
+}
+
+srs_utime_t SrsConfig::get_vhost_http_hooks_cache_negative_ttl(string vhost)
+{
+    SRS_OVERWRITE_BY_ENV_SECONDS("srs.vhost.http_hooks.cache_negative_ttl"); // SRS_VHOST_HTTP_HOOKS_CACHE_NEGATIVE_TTL
+
+    static srs_utime_t DEFAULT = 0;
+
+    SrsConfDirective* conf = get_vhost_http_hooks(vhost);
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("cache_negative_ttl");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+
+    return srs_utime_t(::atoi(conf->arg0().c_str()) * SRS_UTIME_SECONDS);
+}
+
 SrsConfDirective* SrsConfig::get_vhost_on_connect(string vhost)
 {
     SRS_OVERWRITE_BY_ENV_DIRECTIVE("srs.vhost.http_hooks.on_connect"); // SRS_VHOST_HTTP_HOOKS_ON_CONNECT
@@ -6721,6 +6969,25 @@ srs_utime_t SrsConfig::get_dash_dispose(std::string vhost)
     return (srs_utime_t)(::atoi(conf->arg0().c_str()) * SRS_UTIME_SECONDS);
 }
 
+srs_utime_t SrsConfig::get_dash_chunk(string vhost)
+{
+    SRS_OVERWRITE_BY_ENV_FLOAT_SECONDS("srs.vhost.dash.dash_chunk"); // SRS_VHOST_DASH_DASH_CHUNK
+
+    static srs_utime_t DEFAULT = 0;
+
+    SrsConfDirective* conf = get_dash(vhost);
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("dash_chunk");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+
+    return (srs_utime_t)(::atof(conf->arg0().c_str()) * SRS_UTIME_SECONDS);
+}
+
 SrsConfDirective* SrsConfig::get_hls(string vhost)
 {
     SrsConfDirective* conf = get_vhost(vhost);
@@ -8045,6 +8312,26 @@ bool SrsConfig::get_srt_to_rtmp(std::string vhost)
     return SRS_CONF_PERFER_FALSE(conf->arg0());
 }
 
+bool SrsConfig::get_srt_to_hls(std::string vhost)
+{
+    SRS_OVERWRITE_BY_ENV_BOOL("srs.vhost.srt.srt_to_hls"); // SRS_VHOST_SRT_SRT_TO_HLS
+    SRS_OVERWRITE_BY_ENV_BOOL("srs.vhost.srt.to_hls"); // SRS_VHOST_SRT_TO_HLS
+
+    static bool DEFAULT = false;
+
+    SrsConfDirective* conf = get_srt(vhost);
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("srt_to_hls");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+
+    return SRS_CONF_PERFER_FALSE(conf->arg0());
+}
+
 bool SrsConfig::get_http_stream_enabled()
 {
     SrsConfDirective* conf = root->get("http_server");
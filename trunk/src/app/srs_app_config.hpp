@@ -443,6 +443,10 @@ public:
 // Thread pool section.
 public:
     virtual srs_utime_t get_threads_interval();
+    // Whether execute the file I/O, such as m3u8 write and HLS cleanup, in the file I/O thread.
+    virtual bool get_threads_async_file_io();
+    // Get the number of SRTP worker threads, 0 to disable.
+    virtual int get_threads_srtp_workers();
     virtual bool get_circuit_breaker();
     virtual int get_high_threshold();
     virtual int get_high_pulse();
@@ -482,6 +486,8 @@ public:
     virtual std::string get_stream_caster_output(SrsConfDirective* conf);
     // Get the listen port of stream caster.
     virtual int get_stream_caster_listen(SrsConfDirective* conf);
+    // Get the media transport of GB28181, tcp or udp.
+    virtual std::string get_stream_caster_media_transport(SrsConfDirective* conf);
     // Get the sip.enabled configuration.
     virtual bool get_stream_caster_sip_enable(SrsConfDirective* conf);
     // Get the sip.listen port configuration.
@@ -508,6 +514,7 @@ public:
     virtual std::string get_rtc_server_ip_family();
     virtual bool get_rtc_server_ecdsa();
     virtual bool get_rtc_server_encrypt();
+    virtual bool get_rtc_server_srtp_gcm();
     virtual int get_rtc_server_reuseport();
     virtual bool get_rtc_server_merge_nalus();
 public:
@@ -528,9 +535,13 @@ public:
     int get_rtc_drop_for_pt(std::string vhost);
     bool get_rtc_to_rtmp(std::string vhost);
     srs_utime_t get_rtc_pli_for_rtmp(std::string vhost);
+    // Get the time to wait for the lost video packets, for RTC to RTMP.
+    srs_utime_t get_rtc_jitter_for_rtmp(std::string vhost);
     bool get_rtc_nack_enabled(std::string vhost);
     bool get_rtc_nack_no_copy(std::string vhost);
     bool get_rtc_twcc_enabled(std::string vhost);
+    // Whether pace the packets for player, by the bandwidth estimated by TWCC.
+    bool get_rtc_pacer_enabled(std::string vhost);
 
 // vhost specified section
 public:
@@ -651,6 +662,8 @@ public:
     virtual SrsConfDirective* get_forwards(std::string vhost);
     // Get the forward directive of backend.
     virtual SrsConfDirective* get_forward_backend(std::string vhost);
+    // Get the backpressure policy of forward destination, drop or disconnect.
+    virtual std::string get_forward_backpressure(std::string vhost, std::string destination);
 
 public:
     // Whether the srt sevice enabled
@@ -694,6 +707,8 @@ private:
 public:
     bool get_srt_enabled(std::string vhost);
     bool get_srt_to_rtmp(std::string vhost);
+    // Whether write the original TS packets of SRT to HLS, without demux and remux.
+    bool get_srt_to_hls(std::string vhost);
 
 // http_hooks section
 private:
@@ -704,6 +719,10 @@ public:
     // @remark, if not enabled, donot callback all http hooks.
     virtual bool get_vhost_http_hooks_enabled(std::string vhost);
     virtual bool get_vhost_http_hooks_enabled(SrsConfDirective* vhost);
+    // Get the TTL to cache the allowed decision of on_connect and on_play, 0 to disable.
+    virtual srs_utime_t get_vhost_http_hooks_cache_ttl(std::string vhost);
+    // Get the TTL to cache the denied decision of on_connect and on_play, 0 to disable.
+    virtual srs_utime_t get_vhost_http_hooks_cache_negative_ttl(std::string vhost);
     // Get the on_connect callbacks of vhost.
     // @return the on_connect callback directive, the args is the url to callback.
     virtual SrsConfDirective* get_vhost_on_connect(std::string vhost);
@@ -905,6 +924,8 @@ public:
     virtual bool get_dash_cleanup(std::string vhost);
     // The timeout in srs_utime_t to dispose the dash.
     virtual srs_utime_t get_dash_dispose(std::string vhost);
+    // Get the duration of CMAF chunk in srs_utime_t, 0 to disable the low-latency chunked mode.
+    virtual srs_utime_t get_dash_chunk(std::string vhost);
 // hls section
 private:
     // Get the hls directive of vhost.
@@ -1114,6 +1135,11 @@ public:
     virtual std::string get_exporter_listen();
     virtual std::string get_exporter_label();
     virtual std::string get_exporter_tag();
+public:
+    // Whether share the pull of edge by the processes on the same box.
+    virtual bool get_edge_relay_enabled();
+    // Get the unix domain socket path of edge relay.
+    virtual std::string get_edge_relay_listen();
 };
 
 #endif
@@ -26,6 +26,29 @@ SrsPps* _srs_pps_fids = NULL;
 SrsPps* _srs_pps_fids_level0 = NULL;
 SrsPps* _srs_pps_dispose = NULL;
 
+uint64_t srs_resource_hash(const SrsResourceFastKey& key)
+{
+    // Mix the words by the finalizer of MurmurHash3, so the packed address spreads over all bits.
+    uint64_t h = key.id ^ (key.addr[0] * 0x9e3779b97f4a7c15ULL) ^ (key.addr[1] * 0xc2b2ae3d27d4eb4fULL);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return (h > 1)? h : h + 2;
+}
+
+uint64_t srs_resource_hash(const std::string& key)
+{
+    // The FNV-1a hash of string.
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (int i = 0; i < (int)key.length(); i++) {
+        h ^= (uint8_t)key.at(i);
+        h *= 0x100000001b3ULL;
+    }
+    return (h > 1)? h : h + 2;
+}
+
 ISrsDisposingHandler::ISrsDisposingHandler()
 {
 }
@@ -42,9 +65,6 @@ SrsResourceManager::SrsResourceManager(const std::string& label, bool verbose)
     trd = NULL;
     p_disposing_ = NULL;
     removing_ = false;
-
-    nn_level0_cache_ = 100000;
-    conns_level0_cache_ = new SrsResourceFastIdItem[nn_level0_cache_];
 }
 
 SrsResourceManager::~SrsResourceManager()
@@ -65,8 +85,6 @@ SrsResourceManager::~SrsResourceManager()
         ISrsResource* resource = *it;
         srs_freep(resource);
     }
-
-    srs_freepa(conns_level0_cache_);
 }
 
 srs_error_t SrsResourceManager::start()
@@ -130,46 +148,19 @@ void SrsResourceManager::add(ISrsResource* conn, bool* exists)
 void SrsResourceManager::add_with_id(const std::string& id, ISrsResource* conn)
 {
     add(conn);
-    conns_id_[id] = conn;
+    conns_id_.set(id, conn);
 }
 
-void SrsResourceManager::add_with_fast_id(uint64_t id, ISrsResource* conn)
+void SrsResourceManager::add_with_fast_id(const SrsResourceFastKey& id, ISrsResource* conn)
 {
-    bool exists = false;
-    add(conn, &exists);
-    conns_fast_id_[id] = conn;
-
-    if (exists) {
-        return;
-    }
-
-    // For new resource, build the level-0 cache for fast-id.
-    SrsResourceFastIdItem* item = &conns_level0_cache_[(id | id>>32) % nn_level0_cache_];
-
-    // Ignore if exits item.
-    if (item->fast_id && item->fast_id == id) {
-        return;
-    }
-
-    // Fresh one, create the item.
-    if (!item->fast_id) {
-        item->fast_id = id;
-        item->impl = conn;
-        item->nn_collisions = 1;
-        item->available = true;
-    }
-
-    // Collision, increase the collisions.
-    if (item->fast_id != id) {
-        item->nn_collisions++;
-        item->available = false;
-    }
+    add(conn);
+    conns_fast_id_.set(id, conn);
 }
 
 void SrsResourceManager::add_with_name(const std::string& name, ISrsResource* conn)
 {
     add(conn);
-    conns_name_[name] = conn;
+    conns_name_.set(name, conn);
 }
 
 ISrsResource* SrsResourceManager::at(int index)
@@ -180,28 +171,28 @@ ISrsResource* SrsResourceManager::at(int index)
 ISrsResource* SrsResourceManager::find_by_id(std::string id)
 {
     ++_srs_pps_ids->sugar;
-    map<string, ISrsResource*>::iterator it = conns_id_.find(id);
-    return (it != conns_id_.end())? it->second : NULL;
+    return conns_id_.find(id);
 }
 
-ISrsResource* SrsResourceManager::find_by_fast_id(uint64_t id)
+ISrsResource* SrsResourceManager::find_by_fast_id(const SrsResourceFastKey& id)
 {
-    SrsResourceFastIdItem* item = &conns_level0_cache_[(id | id>>32) % nn_level0_cache_];
-    if (item->available && item->fast_id == id) {
+    bool first = false;
+    ISrsResource* conn = conns_fast_id_.find(id, &first);
+
+    // Stat the lookup, whether found in the first slot.
+    if (first) {
         ++_srs_pps_fids_level0->sugar;
-        return item->impl;
+    } else {
+        ++_srs_pps_fids->sugar;
     }
 
-    ++_srs_pps_fids->sugar;
-    map<uint64_t, ISrsResource*>::iterator it = conns_fast_id_.find(id);
-    return (it != conns_fast_id_.end())? it->second : NULL;
+    return conn;
 }
 
 ISrsResource* SrsResourceManager::find_by_name(std::string name)
 {
     ++_srs_pps_ids->sugar;
-    map<string, ISrsResource*>::iterator it = conns_name_.find(name);
-    return (it != conns_name_.end())? it->second : NULL;
+    return conns_name_.find(name);
 }
 
 void SrsResourceManager::subscribe(ISrsDisposingHandler* h)
@@ -354,41 +345,9 @@ void SrsResourceManager::do_clear()
 
 void SrsResourceManager::dispose(ISrsResource* c)
 {
-    for (map<string, ISrsResource*>::iterator it = conns_name_.begin(); it != conns_name_.end();) {
-        if (c != it->second) {
-            ++it;
-        } else {
-            // Use C++98 style: https://stackoverflow.com/a/4636230
-            conns_name_.erase(it++);
-        }
-    }
-
-    for (map<string, ISrsResource*>::iterator it = conns_id_.begin(); it != conns_id_.end();) {
-        if (c != it->second) {
-            ++it;
-        } else {
-            // Use C++98 style: https://stackoverflow.com/a/4636230
-            conns_id_.erase(it++);
-        }
-    }
-
-    for (map<uint64_t, ISrsResource*>::iterator it = conns_fast_id_.begin(); it != conns_fast_id_.end();) {
-        if (c != it->second) {
-            ++it;
-        } else {
-            // Update the level-0 cache for fast-id.
-            uint64_t id = it->first;
-            SrsResourceFastIdItem* item = &conns_level0_cache_[(id | id>>32) % nn_level0_cache_];
-            item->nn_collisions--;
-            if (!item->nn_collisions) {
-                item->fast_id = 0;
-                item->available = false;
-            }
-
-            // Use C++98 style: https://stackoverflow.com/a/4636230
-            conns_fast_id_.erase(it++);
-        }
-    }
+    conns_name_.erase(c);
+    conns_id_.erase(c);
+    conns_fast_id_.erase(c);
 
     vector<ISrsResource*>::iterator it = std::find(conns_.begin(), conns_.end(), c);
     if (it != conns_.end()) {
@@ -39,24 +39,176 @@ public:
     virtual void on_disposing(ISrsResource* c) = 0;
 };
 
-// The item to identify the fast id object.
-class SrsResourceFastIdItem
+// The fast key to identify the resource, for example, the packed UDP peer address ip:port, or the SSRC.
+struct SrsResourceFastKey
 {
+    // For int id or IPv4 address, the packed id, and the address is zero.
+    // For IPv6 address, the family and port.
+    uint64_t id;
+    // For IPv6 address, the 16 bytes address.
+    uint64_t addr[2];
 public:
-    // If available, use the resource in item.
-    bool available;
-    // How many resource have the same fast-id, which contribute a collision.
-    int nn_collisions;
-    // The first fast-id of resources.
-    uint64_t fast_id;
-    // The first resource object.
-    ISrsResource* impl;
+    SrsResourceFastKey(uint64_t v = 0) {
+        id = v;
+        addr[0] = addr[1] = 0;
+    }
+    bool empty() const {
+        return !id && !addr[0] && !addr[1];
+    }
+    bool operator==(const SrsResourceFastKey& o) const {
+        return id == o.id && addr[0] == o.addr[0] && addr[1] == o.addr[1];
+    }
+};
+
+// The hash of key for the fast table, never be 0 or 1, which are reserved for empty and deleted slot.
+extern uint64_t srs_resource_hash(const SrsResourceFastKey& key);
+extern uint64_t srs_resource_hash(const std::string& key);
+
+// The flat hash table with open addressing and linear probing, to find resource by key, because it's in the
+// hot path of each UDP packet. It's cache friendly, as all slots are in one array and we compare the hash
+// before the key, so generally only one cache line is touched for each lookup.
+template<typename K>
+class SrsResourceFastTable
+{
+private:
+    struct SrsFastSlot
+    {
+        // The hash of key, 0 for empty slot, 1 for deleted slot.
+        uint64_t hash;
+        K key;
+        ISrsResource* impl;
+        SrsFastSlot() : hash(0), impl(NULL) {
+        }
+    };
+private:
+    SrsFastSlot* slots_;
+    // The capacity is power of 2, so we use mask to get the index.
+    uint32_t capacity_;
+    uint32_t size_;
+    uint32_t deleted_;
+    // The keys of resource, to erase the resource by keys without scanning all slots. The key might be
+    // overwrote by other resource, so we check the resource of slot when erasing.
+    std::map<ISrsResource*, std::vector<K> > keys_;
+public:
+    SrsResourceFastTable() {
+        capacity_ = 64;
+        slots_ = new SrsFastSlot[capacity_];
+        size_ = deleted_ = 0;
+    }
+    virtual ~SrsResourceFastTable() {
+        srs_freepa(slots_);
+    }
 public:
-    SrsResourceFastIdItem() {
-        available = false;
-        nn_collisions = 0;
-        fast_id = 0;
-        impl = NULL;
+    // Find the resource by key, and set the pfirst to true if found in the first slot, for stat.
+    ISrsResource* find(const K& key, bool* pfirst = NULL) {
+        SrsFastSlot* slot = lookup(key, pfirst);
+        return slot ? slot->impl : NULL;
+    }
+    // Set the resource of key, ignore if key exists and not overwrite.
+    void set(const K& key, ISrsResource* impl, bool overwrite = true) {
+        // Keep the load factor under 0.5, including the deleted slots.
+        if ((size_ + deleted_ + 1) * 2 > capacity_) {
+            rehash((size_ + 1) * 4 > capacity_ ? capacity_ * 2 : capacity_);
+        }
+
+        uint64_t hash = srs_resource_hash(key);
+        uint32_t mask = capacity_ - 1;
+        SrsFastSlot* free_slot = NULL;
+        for (uint32_t i = (uint32_t)hash & mask, n = 0; n < capacity_; i = (i + 1) & mask, n++) {
+            SrsFastSlot* slot = &slots_[i];
+            if (slot->hash == hash && slot->key == key) {
+                if (overwrite && slot->impl != impl) {
+                    slot->impl = impl;
+                    keys_[impl].push_back(key);
+                }
+                return;
+            }
+            if (slot->hash == 1 && !free_slot) {
+                free_slot = slot;
+            }
+            if (!slot->hash) {
+                if (!free_slot) {
+                    free_slot = slot;
+                }
+                break;
+            }
+        }
+
+        if (free_slot->hash == 1) {
+            deleted_--;
+        }
+        free_slot->hash = hash;
+        free_slot->key = key;
+        free_slot->impl = impl;
+        size_++;
+        keys_[impl].push_back(key);
+    }
+    // Remove all keys of the resource.
+    void erase(ISrsResource* impl) {
+        typename std::map<ISrsResource*, std::vector<K> >::iterator it = keys_.find(impl);
+        if (it == keys_.end()) {
+            return;
+        }
+
+        std::vector<K>& keys = it->second;
+        for (int i = 0; i < (int)keys.size(); i++) {
+            SrsFastSlot* slot = lookup(keys.at(i), NULL);
+            if (slot && slot->impl == impl) {
+                slot->hash = 1;
+                slot->key = K();
+                slot->impl = NULL;
+                size_--;
+                deleted_++;
+            }
+        }
+
+        keys_.erase(it);
+    }
+    int size() {
+        return (int)size_;
+    }
+private:
+    SrsFastSlot* lookup(const K& key, bool* pfirst) {
+        uint64_t hash = srs_resource_hash(key);
+        uint32_t mask = capacity_ - 1;
+        for (uint32_t i = (uint32_t)hash & mask, n = 0; n < capacity_; i = (i + 1) & mask, n++) {
+            SrsFastSlot* slot = &slots_[i];
+            if (!slot->hash) {
+                return NULL;
+            }
+            if (slot->hash == hash && slot->key == key) {
+                if (pfirst) {
+                    *pfirst = !n;
+                }
+                return slot;
+            }
+        }
+        return NULL;
+    }
+    void rehash(uint32_t capacity) {
+        SrsFastSlot* slots = slots_;
+        uint32_t nn_slots = capacity_;
+
+        slots_ = new SrsFastSlot[capacity];
+        capacity_ = capacity;
+        size_ = deleted_ = 0;
+
+        uint32_t mask = capacity_ - 1;
+        for (uint32_t i = 0; i < nn_slots; i++) {
+            SrsFastSlot* slot = &slots[i];
+            if (slot->hash <= 1) {
+                continue;
+            }
+
+            uint32_t j = (uint32_t)slot->hash & mask;
+            while (slots_[j].hash) {
+                j = (j + 1) & mask;
+            }
+            slots_[j] = *slot;
+            size_++;
+        }
+
+        srs_freepa(slots);
     }
 };
 
@@ -83,14 +235,11 @@ private:
     // The connections without any id.
     std::vector<ISrsResource*> conns_;
     // The connections with resource id.
-    std::map<std::string, ISrsResource*> conns_id_;
-    // The connections with resource fast(int) id.
-    std::map<uint64_t, ISrsResource*> conns_fast_id_;
-    // The level-0 fast cache for fast id.
-    int nn_level0_cache_;
-    SrsResourceFastIdItem* conns_level0_cache_;
+    SrsResourceFastTable<std::string> conns_id_;
+    // The connections with resource fast id, for example, the packed UDP peer address.
+    SrsResourceFastTable<SrsResourceFastKey> conns_fast_id_;
     // The connections with resource name.
-    std::map<std::string, ISrsResource*> conns_name_;
+    SrsResourceFastTable<std::string> conns_name_;
 public:
     SrsResourceManager(const std::string& label, bool verbose = false);
     virtual ~SrsResourceManager();
@@ -104,11 +253,13 @@ public:
 public:
     void add(ISrsResource* conn, bool* exists = NULL);
     void add_with_id(const std::string& id, ISrsResource* conn);
-    void add_with_fast_id(uint64_t id, ISrsResource* conn);
+    // Add resource with fast id, overwrite if the id exists, the last resource wins, for example, the new
+    // session after ICE restart from the same address.
+    void add_with_fast_id(const SrsResourceFastKey& id, ISrsResource* conn);
     void add_with_name(const std::string& name, ISrsResource* conn);
     ISrsResource* at(int index);
     ISrsResource* find_by_id(std::string id);
-    ISrsResource* find_by_fast_id(uint64_t id);
+    ISrsResource* find_by_fast_id(const SrsResourceFastKey& id);
     ISrsResource* find_by_name(std::string name);
 public:
     void subscribe(ISrsDisposingHandler* h);
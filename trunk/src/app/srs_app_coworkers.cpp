@@ -7,6 +7,7 @@
 #include <srs_app_coworkers.hpp>
 
 #include <stdlib.h>
+#include <algorithm>
 using namespace std;
 
 #include <srs_protocol_json.hpp>
@@ -16,21 +17,167 @@ using namespace std;
 #include <srs_protocol_utility.hpp>
 #include <srs_protocol_utility.hpp>
 #include <srs_kernel_utility.hpp>
+#include <srs_app_statistic.hpp>
+#include <srs_app_http_hooks.hpp>
+#include <srs_core_performance.hpp>
+#include <srs_core_autofree.hpp>
+
+SrsCoWorkerStream::SrsCoWorkerStream()
+{
+    port = 0;
+}
+
+SrsCoWorkerStream::~SrsCoWorkerStream()
+{
+}
+
+string SrsCoWorkerStream::url()
+{
+    return srs_generate_stream_url(vhost, app, stream);
+}
+
+SrsCoWorkerStream* SrsCoWorkerStream::copy()
+{
+    SrsCoWorkerStream* cp = new SrsCoWorkerStream();
+    cp->vhost = vhost;
+    cp->app = app;
+    cp->stream = stream;
+    cp->ip = ip;
+    cp->port = port;
+    return cp;
+}
+
+SrsCoWorkerDelta::SrsCoWorkerDelta()
+{
+    version = 0;
+    publish = false;
+    stream = NULL;
+}
+
+SrsCoWorkerDelta::~SrsCoWorkerDelta()
+{
+    srs_freep(stream);
+}
+
+SrsCoWorkerPeer::SrsCoWorkerPeer(SrsCoWorkers* owner, string api)
+{
+    owner_ = owner;
+    trd_ = NULL;
+    wait_ = srs_cond_new();
+
+    this->api = api;
+    version = 0;
+    synced = false;
+    self = false;
+}
+
+SrsCoWorkerPeer::~SrsCoWorkerPeer()
+{
+    srs_freep(trd_);
+    srs_cond_destroy(wait_);
+
+    clear();
+}
+
+string SrsCoWorkerPeer::host()
+{
+    string host = api;
+    int port = 0;
+    if (api.find(":") != string::npos) {
+        srs_parse_hostport(api, host, port);
+    }
+    return host;
+}
+
+void SrsCoWorkerPeer::clear()
+{
+    map<string, SrsCoWorkerStream*>::iterator it;
+    for (it = streams.begin(); it != streams.end(); ++it) {
+        SrsCoWorkerStream* s = it->second;
+        srs_freep(s);
+    }
+    streams.clear();
+
+    synced = false;
+    version = 0;
+}
+
+srs_error_t SrsCoWorkerPeer::start()
+{
+    srs_error_t err = srs_success;
+
+    if (trd_) {
+        return err;
+    }
+
+    trd_ = new SrsSTCoroutine("coworker", this);
+    if ((err = trd_->start()) != srs_success) {
+        return srs_error_wrap(err, "start coworker %s", api.c_str());
+    }
+
+    return err;
+}
+
+void SrsCoWorkerPeer::resync()
+{
+    srs_cond_signal(wait_);
+}
+
+srs_error_t SrsCoWorkerPeer::cycle()
+{
+    srs_error_t err = srs_success;
+
+    while (true) {
+        if ((err = trd_->pull()) != srs_success) {
+            return srs_error_wrap(err, "coworker");
+        }
+
+        // Drop the directory of co-worker which is unavailable, for its streams are not available either.
+        if (!self && (err = owner_->sync(this)) != srs_success) {
+            if (synced) {
+                srs_warn("CoWorkers: Ignore error, %s", srs_error_desc(err).c_str());
+            }
+            srs_freep(err);
+            owner_->forget(this);
+        }
+
+        srs_cond_timedwait(wait_, SRS_PERF_COWORKERS_SYNC_INTERVAL);
+    }
+
+    return err;
+}
 
 SrsCoWorkers* SrsCoWorkers::_instance = NULL;
 
 SrsCoWorkers::SrsCoWorkers()
 {
+    version_ = 0;
+    trd_ = new SrsDummyCoroutine();
 }
 
 SrsCoWorkers::~SrsCoWorkers()
 {
+    srs_freep(trd_);
+
     map<string, SrsRequest*>::iterator it;
     for (it = streams.begin(); it != streams.end(); ++it) {
         SrsRequest* r = it->second;
         srs_freep(r);
     }
     streams.clear();
+
+    for (deque<SrsCoWorkerDelta*>::iterator it = deltas_.begin(); it != deltas_.end(); ++it) {
+        SrsCoWorkerDelta* delta = *it;
+        srs_freep(delta);
+    }
+    deltas_.clear();
+
+    locations_.clear();
+    for (map<string, SrsCoWorkerPeer*>::iterator it = peers_.begin(); it != peers_.end(); ++it) {
+        SrsCoWorkerPeer* peer = it->second;
+        srs_freep(peer);
+    }
+    peers_.clear();
 }
 
 SrsCoWorkers* SrsCoWorkers::instance()
@@ -49,28 +196,13 @@ SrsJsonAny* SrsCoWorkers::dumps(string vhost, string coworker, string app, strin
         return SrsJsonAny::null();
     }
 
-    // The service port parsing from listen port.
-    string listen_host;
-    int listen_port = SRS_CONSTS_RTMP_DEFAULT_PORT;
-    vector<string> listen_hostports = _srs_config->get_listens();
-    if (!listen_hostports.empty()) {
-        string list_hostport = listen_hostports.at(0);
-
-        if (list_hostport.find(":") != string::npos) {
-            srs_parse_hostport(list_hostport, listen_host, listen_port);
-        } else {
-            listen_port = ::atoi(list_hostport.c_str());
-        }
-    }
-
     // The ip of server, we use the request coworker-host as ip, if listen host is localhost or loopback.
     // For example, the server may behind a NAT(192.x.x.x), while its ip is a docker ip(172.x.x.x),
     // we should use the NAT(192.x.x.x) address as it's the exposed ip.
     // @see https://github.com/ossrs/srs/issues/1501
     string service_ip;
-    if (listen_host != SRS_CONSTS_LOCALHOST && listen_host != SRS_CONSTS_LOOPBACK && listen_host != SRS_CONSTS_LOOPBACK6) {
-        service_ip = listen_host;
-    }
+    int listen_port = SRS_CONSTS_RTMP_DEFAULT_PORT;
+    service(service_ip, listen_port);
     if (service_ip.empty()) {
         int coworker_port;
         string coworker_host = coworker;
@@ -122,6 +254,28 @@ SrsRequest* SrsCoWorkers::find_stream_info(string vhost, string app, string stre
     return it->second;
 }
 
+void SrsCoWorkers::service(string& ip, int& port)
+{
+    // The service port parsing from listen port.
+    string listen_host;
+    port = SRS_CONSTS_RTMP_DEFAULT_PORT;
+    vector<string> listen_hostports = _srs_config->get_listens();
+    if (!listen_hostports.empty()) {
+        string list_hostport = listen_hostports.at(0);
+
+        if (list_hostport.find(":") != string::npos) {
+            srs_parse_hostport(list_hostport, listen_host, port);
+        } else {
+            port = ::atoi(list_hostport.c_str());
+        }
+    }
+
+    // Empty ip if listen at localhost or loopback, the co-worker should use the host it connects to.
+    if (listen_host != SRS_CONSTS_LOCALHOST && listen_host != SRS_CONSTS_LOOPBACK && listen_host != SRS_CONSTS_LOOPBACK6) {
+        ip = listen_host;
+    }
+}
+
 srs_error_t SrsCoWorkers::on_publish(SrsLiveSource* s, SrsRequest* r)
 {
     srs_error_t err = srs_success;
@@ -136,6 +290,11 @@ srs_error_t SrsCoWorkers::on_publish(SrsLiveSource* s, SrsRequest* r)
     
     // Always use the latest one.
     streams[url] = r->copy();
+
+    // Update the stream directory for origin cluster.
+    if (_srs_config->get_vhost_origin_cluster(r->vhost)) {
+        update(true, r);
+    }
     
     return err;
 }
@@ -149,5 +308,381 @@ void SrsCoWorkers::on_unpublish(SrsLiveSource* s, SrsRequest* r)
         srs_freep(it->second);
         streams.erase(it);
     }
+
+    if (_srs_config->get_vhost_origin_cluster(r->vhost)) {
+        update(false, r);
+    }
+}
+
+
+srs_error_t SrsCoWorkers::start()
+{
+    srs_error_t err = srs_success;
+
+    // Ignore if no co-workers to sync the directory from.
+    if (peers().empty()) {
+        return err;
+    }
+
+    srs_freep(trd_);
+    trd_ = new SrsSTCoroutine("coworkers", this);
+    if ((err = trd_->start()) != srs_success) {
+        return srs_error_wrap(err, "start coworkers");
+    }
+
+    return err;
+}
+
+SrsCoWorkerStream* SrsCoWorkers::lookup(string vhost, string app, string stream)
+{
+    // Try the default vhost if not found, because the vhost of edge or client might not exists in origin.
+    for (int i = 0; i < 2; i++) {
+        string url = srs_generate_stream_url(i == 0 ? vhost : SRS_CONSTS_RTMP_DEFAULT_VHOST, app, stream);
+        map<string, SrsCoWorkerPeer*>::iterator it = locations_.find(url);
+        if (it == locations_.end()) {
+            continue;
+        }
+
+        // Never use the directory which is not synced, because the stream might be moved to other origin.
+        SrsCoWorkerPeer* peer = it->second;
+        if (!peer->synced) {
+            return NULL;
+        }
+
+        map<string, SrsCoWorkerStream*>::iterator it2 = peer->streams.find(url);
+        return (it2 != peer->streams.end()) ? it2->second : NULL;
+    }
+
+    return NULL;
 }
 
+SrsJsonObject* SrsCoWorkers::dumps_directory(string epoch, int64_t since)
+{
+    SrsJsonObject* obj = SrsJsonAny::object();
+    obj->set("epoch", SrsJsonAny::str(SrsStatistic::instance()->service_id().c_str()));
+    obj->set("version", SrsJsonAny::integer(version_));
+
+    SrsJsonArray* arr = SrsJsonAny::array();
+    obj->set("streams", arr);
+
+    // Dump the deltas since the version, if the deltas are still available.
+    bool incremental = epoch == SrsStatistic::instance()->service_id() && since <= version_;
+    if (incremental && since < version_) {
+        incremental = !deltas_.empty() && deltas_.front()->version <= since + 1;
+    }
+
+    if (incremental) {
+        obj->set("since", SrsJsonAny::integer(since));
+        for (deque<SrsCoWorkerDelta*>::iterator it = deltas_.begin(); it != deltas_.end(); ++it) {
+            SrsCoWorkerDelta* delta = *it;
+            if (delta->version > since) {
+                arr->append(srs_coworker_dumps(delta->publish, delta->stream));
+            }
+        }
+        return obj;
+    }
+
+    // Dump the whole directory, that is all streams of origin cluster.
+    obj->set("full", SrsJsonAny::boolean(true));
+
+    string ip;
+    int port = SRS_CONSTS_RTMP_DEFAULT_PORT;
+    service(ip, port);
+
+    for (map<string, SrsRequest*>::iterator it = streams.begin(); it != streams.end(); ++it) {
+        SrsRequest* r = it->second;
+        if (!_srs_config->get_vhost_origin_cluster(r->vhost)) {
+            continue;
+        }
+
+        SrsCoWorkerStream s;
+        s.vhost = r->vhost;
+        s.app = r->app;
+        s.stream = r->stream;
+        s.ip = ip;
+        s.port = port;
+        arr->append(srs_coworker_dumps(true, &s));
+    }
+
+    return obj;
+}
+
+srs_error_t SrsCoWorkers::on_directory(string api, SrsJsonObject* directory)
+{
+    srs_error_t err = srs_success;
+
+    SrsJsonAny* prop = NULL;
+    if ((prop = directory->ensure_property_string("epoch")) == NULL) {
+        return srs_error_new(ERROR_OCLUSTER_DISCOVER, "no epoch");
+    }
+    string epoch = prop->to_str();
+
+    if ((prop = directory->ensure_property_integer("version")) == NULL) {
+        return srs_error_new(ERROR_OCLUSTER_DISCOVER, "no version");
+    }
+    int64_t version = prop->to_integer();
+
+    SrsJsonArray* arr = NULL;
+    if ((prop = directory->ensure_property_array("streams")) == NULL) {
+        return srs_error_new(ERROR_OCLUSTER_DISCOVER, "no streams");
+    }
+    arr = prop->to_array();
+
+    prop = directory->ensure_property_boolean("full");
+    bool full = prop && prop->to_boolean();
+
+    // Find the co-worker by the API to sync from, or by the epoch for the pushed deltas.
+    SrsCoWorkerPeer* peer = NULL;
+    if (!api.empty()) {
+        map<string, SrsCoWorkerPeer*>::iterator it = peers_.find(api);
+        if (it != peers_.end()) {
+            peer = it->second;
+        } else {
+            peer = peers_[api] = new SrsCoWorkerPeer(this, api);
+        }
+    } else {
+        for (map<string, SrsCoWorkerPeer*>::iterator it = peers_.begin(); it != peers_.end(); ++it) {
+            if (it->second->epoch == epoch) {
+                peer = it->second;
+                break;
+            }
+        }
+    }
+
+    // Ignore the deltas from unknown co-worker, which will be synced by the coroutine.
+    if (!peer) {
+        return err;
+    }
+
+    // The co-worker is this server itself, for user might config all origins as co-workers.
+    if (epoch == SrsStatistic::instance()->service_id()) {
+        forget(peer);
+        peer->self = true;
+        return err;
+    }
+
+    if (full) {
+        forget(peer);
+        peer->epoch = epoch;
+    } else {
+        // Ignore the stale deltas, which are already synced.
+        if (peer->synced && peer->epoch == epoch && version <= peer->version) {
+            return err;
+        }
+
+        // Resync the whole directory if the co-worker restarted, or some deltas are lost.
+        prop = directory->ensure_property_integer("since");
+        int64_t since = prop ? prop->to_integer() : -1;
+        if (!peer->synced || peer->epoch != epoch || since != peer->version) {
+            srs_warn("CoWorkers: Resync %s, epoch=%s/%s, version=%" PRId64 ", since=%" PRId64 "/%" PRId64,
+                peer->api.c_str(), peer->epoch.c_str(), epoch.c_str(), version, peer->version, since);
+            peer->synced = false;
+            peer->resync();
+            return err;
+        }
+    }
+
+    for (int i = 0; i < arr->count(); i++) {
+        SrsJsonAny* item = arr->at(i);
+        if (!item->is_object()) {
+            continue;
+        }
+
+        SrsJsonObject* obj = item->to_object();
+        SrsCoWorkerStream* s = new SrsCoWorkerStream();
+        if ((prop = obj->ensure_property_string("vhost")) != NULL) s->vhost = prop->to_str();
+        if ((prop = obj->ensure_property_string("app")) != NULL) s->app = prop->to_str();
+        if ((prop = obj->ensure_property_string("stream")) != NULL) s->stream = prop->to_str();
+        if ((prop = obj->ensure_property_string("ip")) != NULL) s->ip = prop->to_str();
+        if ((prop = obj->ensure_property_integer("port")) != NULL) s->port = (int)prop->to_integer();
+
+        // Use the host of co-worker, if origin listens at localhost or loopback.
+        if (s->ip.empty()) {
+            s->ip = peer->host();
+        }
+
+        bool publish = true;
+        if ((prop = obj->ensure_property_string("action")) != NULL) {
+            publish = prop->to_str() != "unpublish";
+        }
+        apply(peer, publish, s);
+    }
+
+    peer->version = version;
+    peer->synced = true;
+
+    return err;
+}
+
+vector<string> SrsCoWorkers::peers()
+{
+    vector<string> apis;
+
+    vector<SrsConfDirective*> vhosts;
+    _srs_config->get_vhosts(vhosts);
+    for (int i = 0; i < (int)vhosts.size(); i++) {
+        SrsConfDirective* conf = vhosts.at(i);
+        if (!_srs_config->get_vhost_origin_cluster(conf) && !_srs_config->get_vhost_is_edge(conf)) {
+            continue;
+        }
+
+        vector<string> coworkers = _srs_config->get_vhost_coworkers(conf->arg0());
+        for (int j = 0; j < (int)coworkers.size(); j++) {
+            string coworker = coworkers.at(j);
+            if (std::find(apis.begin(), apis.end(), coworker) == apis.end()) {
+                apis.push_back(coworker);
+            }
+        }
+    }
+
+    return apis;
+}
+
+srs_error_t SrsCoWorkers::cycle()
+{
+    srs_error_t err = srs_success;
+
+    while (true) {
+        if ((err = trd_->pull()) != srs_success) {
+            return srs_error_wrap(err, "coworkers");
+        }
+
+        // Start the new co-workers, which are added by reload, each syncs in its own coroutine.
+        vector<string> apis = peers();
+        for (int i = 0; i < (int)apis.size(); i++) {
+            string api = apis.at(i);
+
+            SrsCoWorkerPeer* peer = NULL;
+            map<string, SrsCoWorkerPeer*>::iterator it = peers_.find(api);
+            if (it != peers_.end()) {
+                peer = it->second;
+            } else {
+                peer = peers_[api] = new SrsCoWorkerPeer(this, api);
+            }
+
+            if ((err = peer->start()) != srs_success) {
+                return srs_error_wrap(err, "start %s", api.c_str());
+            }
+        }
+
+        srs_usleep(SRS_PERF_COWORKERS_SYNC_INTERVAL);
+    }
+
+    return err;
+}
+
+srs_error_t SrsCoWorkers::sync(SrsCoWorkerPeer* peer)
+{
+    srs_error_t err = srs_success;
+
+    // Request the whole directory if not synced, by the empty epoch.
+    string url = srs_fmt("http://%s/api/v1/clusters?directory=1&epoch=%s&since=%" PRId64, peer->api.c_str(),
+        peer->synced ? peer->epoch.c_str() : "", peer->version);
+
+    SrsJsonObject* res = NULL;
+    SrsAutoFree(SrsJsonObject, res);
+    if ((err = SrsHttpHooks::discover_directory(url, &res)) != srs_success) {
+        return srs_error_wrap(err, "sync %s", peer->api.c_str());
+    }
+
+    SrsJsonObject* directory = res->get_property("data")->to_object();
+    if ((err = on_directory(peer->api, directory)) != srs_success) {
+        return srs_error_wrap(err, "sync %s", peer->api.c_str());
+    }
+
+    return err;
+}
+
+void SrsCoWorkers::update(bool publish, SrsRequest* r)
+{
+    SrsCoWorkerDelta* delta = new SrsCoWorkerDelta();
+    delta->version = ++version_;
+    delta->publish = publish;
+
+    SrsCoWorkerStream* s = delta->stream = new SrsCoWorkerStream();
+    s->vhost = r->vhost;
+    s->app = r->app;
+    s->stream = r->stream;
+    service(s->ip, s->port);
+
+    deltas_.push_back(delta);
+    while ((int)deltas_.size() > SRS_PERF_COWORKERS_DELTAS) {
+        SrsCoWorkerDelta* first = deltas_.front();
+        deltas_.pop_front();
+        srs_freep(first);
+    }
+
+    notify(r, delta);
+}
+
+void SrsCoWorkers::notify(SrsRequest* r, SrsCoWorkerDelta* delta)
+{
+    vector<string> coworkers = _srs_config->get_vhost_coworkers(r->vhost);
+    if (coworkers.empty() || !_srs_hooks_async) {
+        return;
+    }
+
+    SrsJsonObject* obj = SrsJsonAny::object();
+    SrsAutoFree(SrsJsonObject, obj);
+
+    obj->set("epoch", SrsJsonAny::str(SrsStatistic::instance()->service_id().c_str()));
+    obj->set("version", SrsJsonAny::integer(delta->version));
+    obj->set("since", SrsJsonAny::integer(delta->version - 1));
+    obj->set("streams", SrsJsonAny::array()->append(srs_coworker_dumps(delta->publish, delta->stream)));
+    string data = obj->dumps();
+
+    // Push the delta to co-workers in order, by the async worker, so the publisher never waits for it.
+    SrsContextId cid = _srs_context->get_id();
+    for (int i = 0; i < (int)coworkers.size(); i++) {
+        string url = "http://" + coworkers.at(i) + "/api/v1/clusters";
+        _srs_hooks_async->execute(new SrsHttpHooksAsyncCall(cid, "on_cluster", url, data));
+    }
+}
+
+void SrsCoWorkers::apply(SrsCoWorkerPeer* peer, bool publish, SrsCoWorkerStream* s)
+{
+    string url = s->url();
+
+    map<string, SrsCoWorkerStream*>::iterator it = peer->streams.find(url);
+    if (it != peer->streams.end()) {
+        SrsCoWorkerStream* prev = it->second;
+        srs_freep(prev);
+        peer->streams.erase(it);
+    }
+
+    if (publish) {
+        peer->streams[url] = s;
+        locations_[url] = peer;
+        return;
+    }
+
+    srs_freep(s);
+    map<string, SrsCoWorkerPeer*>::iterator it2 = locations_.find(url);
+    if (it2 != locations_.end() && it2->second == peer) {
+        locations_.erase(it2);
+    }
+}
+
+void SrsCoWorkers::forget(SrsCoWorkerPeer* peer)
+{
+    map<string, SrsCoWorkerStream*>::iterator it;
+    for (it = peer->streams.begin(); it != peer->streams.end(); ++it) {
+        map<string, SrsCoWorkerPeer*>::iterator it2 = locations_.find(it->first);
+        if (it2 != locations_.end() && it2->second == peer) {
+            locations_.erase(it2);
+        }
+    }
+
+    peer->clear();
+}
+
+SrsJsonObject* srs_coworker_dumps(bool publish, SrsCoWorkerStream* s)
+{
+    return SrsJsonAny::object()
+        ->set("action", SrsJsonAny::str(publish ? "publish" : "unpublish"))
+        ->set("vhost", SrsJsonAny::str(s->vhost.c_str()))
+        ->set("app", SrsJsonAny::str(s->app.c_str()))
+        ->set("stream", SrsJsonAny::str(s->stream.c_str()))
+        ->set("ip", SrsJsonAny::str(s->ip.c_str()))
+        ->set("port", SrsJsonAny::integer(s->port));
+}
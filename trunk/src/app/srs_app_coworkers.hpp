@@ -11,19 +11,108 @@
 
 #include <string>
 #include <map>
+#include <deque>
+#include <vector>
+
+#include <srs_app_st.hpp>
 
 class SrsJsonAny;
+class SrsJsonObject;
 class SrsRequest;
 class SrsLiveSource;
+class SrsCoWorkers;
+
+// The location of a stream in origin cluster, that is the RTMP service of origin which publishes the stream.
+class SrsCoWorkerStream
+{
+public:
+    std::string vhost;
+    std::string app;
+    std::string stream;
+    // The RTMP service of origin, the ip is empty if origin doesn't know its ip, and the co-worker should use
+    // the host of origin's HTTP API instead.
+    std::string ip;
+    int port;
+public:
+    SrsCoWorkerStream();
+    virtual ~SrsCoWorkerStream();
+public:
+    virtual std::string url();
+    virtual SrsCoWorkerStream* copy();
+};
+
+// The delta of stream directory, when stream is published or unpublished.
+class SrsCoWorkerDelta
+{
+public:
+    // The version of directory after applied this delta.
+    int64_t version;
+    // Whether the stream is published, or unpublished.
+    bool publish;
+    SrsCoWorkerStream* stream;
+public:
+    SrsCoWorkerDelta();
+    virtual ~SrsCoWorkerDelta();
+};
+
+// The stream directory replicated from a co-worker, which is identified by the HTTP API. Each co-worker is synced in
+// its own coroutine, so a slow or unavailable co-worker never delays the others.
+class SrsCoWorkerPeer : public ISrsCoroutineHandler
+{
+private:
+    SrsCoWorkers* owner_;
+    // The coroutine to sync directory, NULL if not started.
+    SrsCoroutine* trd_;
+    srs_cond_t wait_;
+public:
+    // The HTTP API of co-worker, for example, 127.0.0.1:1985.
+    std::string api;
+    // The service id of co-worker, which is changed when restarted.
+    std::string epoch;
+    // The version of directory of co-worker, the next delta should be version+1.
+    int64_t version;
+    // Whether the directory is synced, or should resync by the bulk API.
+    bool synced;
+    // Whether the co-worker is this server itself.
+    bool self;
+    std::map<std::string, SrsCoWorkerStream*> streams;
+public:
+    SrsCoWorkerPeer(SrsCoWorkers* owner, std::string api);
+    virtual ~SrsCoWorkerPeer();
+public:
+    // Get the host of HTTP API, which is used as ip of stream if empty.
+    virtual std::string host();
+    virtual void clear();
+    // Start the coroutine to sync directory, ignore if already started.
+    virtual srs_error_t start();
+    // Sync the directory immediately, for example, some deltas are lost.
+    virtual void resync();
+// Interface ISrsCoroutineHandler
+public:
+    virtual srs_error_t cycle();
+};
 
 // For origin cluster.
-class SrsCoWorkers
+// The origins push the deltas of stream directory to co-workers when stream is published or unpublished, and the
+// origins and edges sync the directory from co-workers incrementally by the version, so the location of stream is
+// resolved from the replicated directory, without querying each co-worker by HTTP for each player.
+class SrsCoWorkers : public ISrsCoroutineHandler
 {
 private:
     static SrsCoWorkers* _instance;
 private:
     std::map<std::string, SrsRequest*> streams;
+    // The version of local directory, increased when stream is published or unpublished.
+    int64_t version_;
+    // The recent deltas of local directory, for co-workers to sync incrementally.
+    std::deque<SrsCoWorkerDelta*> deltas_;
+    // The directory replicated from co-workers, keyed by the HTTP API of co-worker.
+    std::map<std::string, SrsCoWorkerPeer*> peers_;
+    // The index of streams to co-workers which publish them, keyed by the stream url.
+    std::map<std::string, SrsCoWorkerPeer*> locations_;
+    SrsCoroutine* trd_;
 private:
+    friend class SrsCoWorkerPeer;
     SrsCoWorkers();
     virtual ~SrsCoWorkers();
 public:
@@ -32,9 +121,44 @@ public:
     virtual SrsJsonAny* dumps(std::string vhost, std::string coworker, std::string app, std::string stream);
 private:
     virtual SrsRequest* find_stream_info(std::string vhost, std::string app, std::string stream);
+    // Get the RTMP service of this server, the ip is empty if listen at localhost or loopback.
+    virtual void service(std::string& ip, int& port);
 public:
     virtual srs_error_t on_publish(SrsLiveSource* s, SrsRequest* r);
     virtual void on_unpublish(SrsLiveSource* s, SrsRequest* r);
+// The stream directory.
+public:
+    // Start the coroutine to sync directory from co-workers, each co-worker in its own coroutine, and the new
+    // co-workers added by reload are started by it.
+    virtual srs_error_t start();
+    // Find the origin of stream from the directory of co-workers, without querying by HTTP.
+    // @return The location of stream, NULL if not found, which is owned by directory.
+    virtual SrsCoWorkerStream* lookup(std::string vhost, std::string app, std::string stream);
+    // Dump the local directory since version, for co-worker to sync. The deltas since the version are dumped if the
+    // epoch matches and the deltas are available, or the whole directory otherwise.
+    virtual SrsJsonObject* dumps_directory(std::string epoch, int64_t since);
+    // Apply the directory pulled from or pushed by co-worker.
+    // @param api The HTTP API of co-worker, empty to find the co-worker by epoch of directory.
+    virtual srs_error_t on_directory(std::string api, SrsJsonObject* directory);
+    // Get the HTTP APIs of co-workers to sync directory from, of origin cluster or edge vhosts.
+    virtual std::vector<std::string> peers();
+// Interface ISrsCoroutineHandler
+public:
+    virtual srs_error_t cycle();
+private:
+    // Sync the directory from co-worker, in the coroutine of co-worker.
+    virtual srs_error_t sync(SrsCoWorkerPeer* peer);
+    // Update the local directory and push the delta to co-workers.
+    virtual void update(bool publish, SrsRequest* r);
+    virtual void notify(SrsRequest* r, SrsCoWorkerDelta* delta);
+    // Apply the stream to directory of co-worker, which takes the ownership of stream.
+    virtual void apply(SrsCoWorkerPeer* peer, bool publish, SrsCoWorkerStream* s);
+    // Drop the directory of co-worker, when it's unavailable or should resync.
+    virtual void forget(SrsCoWorkerPeer* peer);
 };
 
+// Dump the stream as a delta of directory.
+extern SrsJsonObject* srs_coworker_dumps(bool publish, SrsCoWorkerStream* s);
+
 #endif
+
@@ -67,14 +67,117 @@ srs_error_t SrsInitMp4::write(SrsFormat* format, bool video, int tid)
     return err;
 }
 
+SrsDashPartialFragment::SrsDashPartialFragment()
+{
+    size = 0;
+    cond_ = srs_cond_new();
+    nn_waiters_ = 0;
+    removed_ = false;
+}
+
+SrsDashPartialFragment::~SrsDashPartialFragment()
+{
+    srs_cond_destroy(cond_);
+}
+
+SrsDashPartialFragments* _srs_dash_partials = NULL;
+
+SrsDashPartialFragments::SrsDashPartialFragments()
+{
+}
+
+SrsDashPartialFragments::~SrsDashPartialFragments()
+{
+    std::map<std::string, SrsDashPartialFragment*>::iterator it;
+    for (it = fragments_.begin(); it != fragments_.end(); ++it) {
+        SrsDashPartialFragment* fragment = it->second;
+        srs_freep(fragment);
+    }
+    fragments_.clear();
+}
+
+void SrsDashPartialFragments::update(std::string path, std::string tmppath, int64_t size)
+{
+    string key = key_of(path);
+
+    SrsDashPartialFragment* fragment = NULL;
+    std::map<std::string, SrsDashPartialFragment*>::iterator it = fragments_.find(key);
+    if (it != fragments_.end()) {
+        fragment = it->second;
+    } else {
+        fragment = new SrsDashPartialFragment();
+        fragments_[key] = fragment;
+    }
+
+    fragment->tmppath = tmppath;
+    fragment->size = size;
+
+    srs_cond_broadcast(fragment->cond_);
+}
+
+void SrsDashPartialFragments::remove(std::string path)
+{
+    std::map<std::string, SrsDashPartialFragment*>::iterator it = fragments_.find(key_of(path));
+    if (it == fragments_.end()) {
+        return;
+    }
+
+    SrsDashPartialFragment* fragment = it->second;
+    fragments_.erase(it);
+
+    // Free it by the last waiting player, which is still waiting on the cond.
+    fragment->removed_ = true;
+    srs_cond_broadcast(fragment->cond_);
+
+    if (!fragment->nn_waiters_) {
+        srs_freep(fragment);
+    }
+}
+
+SrsDashPartialFragment* SrsDashPartialFragments::fetch(std::string path)
+{
+    std::map<std::string, SrsDashPartialFragment*>::iterator it = fragments_.find(key_of(path));
+    return (it != fragments_.end())? it->second : NULL;
+}
+
+void SrsDashPartialFragments::wait(std::string path, srs_utime_t timeout)
+{
+    SrsDashPartialFragment* fragment = fetch(path);
+    if (!fragment) {
+        return;
+    }
+
+    fragment->nn_waiters_++;
+    srs_cond_timedwait(fragment->cond_, timeout);
+    fragment->nn_waiters_--;
+
+    if (fragment->removed_ && !fragment->nn_waiters_) {
+        srs_freep(fragment);
+    }
+}
+
+string SrsDashPartialFragments::key_of(string path)
+{
+    // The path from config might contain duplicated slash, for example, ./objs/nginx/html//live/livestream.
+    return srs_string_replace(path, "//", "/");
+}
+
 SrsFragmentedMp4::SrsFragmentedMp4()
 {
     fw = new SrsFileWriter();
     enc = new SrsMp4M2tsSegmentEncoder();
+    mpd_ = NULL;
+    video_ = false;
+    chunk_ = 0;
+    chunk_dts_ = -1;
 }
 
 SrsFragmentedMp4::~SrsFragmentedMp4()
 {
+    if (chunk_) {
+        _srs_dash_partials->remove(fullpath());
+    }
+
     srs_freep(enc);
     srs_freep(fw);
 }
@@ -105,8 +208,21 @@ srs_error_t SrsFragmentedMp4::initialize(SrsRequest* r, bool video, int64_t time
         return srs_error_wrap(err, "Open fmp4 failed, path=%s", path_tmp.c_str());
     }
     
-    if ((err = enc->initialize(fw, (uint32_t)sequence_number, time, tid)) != srs_success) {
-        return srs_error_wrap(err, "init encoder, seq=%u, time=%" PRId64 ", tid=%u", (uint32_t)sequence_number, time, tid);
+    // The sequence number of moof increases continuously, not the number of fragment.
+    mpd_ = mpd;
+    video_ = video;
+    uint32_t moof_sequence = mpd->moof_sequence(video);
+    if ((err = enc->initialize(fw, moof_sequence, time, tid)) != srs_success) {
+        return srs_error_wrap(err, "init encoder, seq=%u, time=%" PRId64 ", tid=%u", moof_sequence, time, tid);
+    }
+
+    // For low-latency DASH, the fragment is available once the styp is writen.
+    chunk_ = _srs_config->get_dash_chunk(r->vhost);
+    if (chunk_) {
+        if ((err = fw->flush()) != srs_success) {
+            return srs_error_wrap(err, "flush styp");
+        }
+        _srs_dash_partials->update(fullpath(), path_tmp, fw->tellg());
     }
     
     return err;
@@ -115,6 +231,19 @@ srs_error_t SrsFragmentedMp4::initialize(SrsRequest* r, bool video, int64_t time
 srs_error_t SrsFragmentedMp4::write(SrsSharedPtrMessage* shared_msg, SrsFormat* format)
 {
     srs_error_t err = srs_success;
+
+    // Write the cached samples as a chunk, before writing the sample of next chunk.
+    if (chunk_ && (shared_msg->is_audio() || shared_msg->is_video())) {
+        int64_t dts = (int64_t)shared_msg->timestamp;
+        if (chunk_dts_ == -1) {
+            chunk_dts_ = dts;
+        } else if ((dts - chunk_dts_) * SRS_UTIME_MILLISECONDS >= chunk_) {
+            if ((err = flush_chunk((uint64_t)dts)) != srs_success) {
+                return srs_error_wrap(err, "flush chunk");
+            }
+            chunk_dts_ = dts;
+        }
+    }
     
     if (shared_msg->is_audio()) {
         uint8_t* sample = (uint8_t*)format->raw;
@@ -148,26 +277,52 @@ srs_error_t SrsFragmentedMp4::reap(uint64_t& dts)
     if ((err = enc->flush(dts)) != srs_success) {
         return srs_error_wrap(err, "Flush encoder failed");
     }
+    mpd_->set_moof_sequence(video_, enc->sequence());
     
     srs_freep(fw);
     
     if ((err = rename()) != srs_success) {
         return srs_error_wrap(err, "rename");
     }
+
+    // The fragment is completed, player should read the official file.
+    if (chunk_) {
+        _srs_dash_partials->remove(fullpath());
+    }
     
     return err;
 }
 
+srs_error_t SrsFragmentedMp4::flush_chunk(uint64_t dts)
+{
+    srs_error_t err = srs_success;
+
+    if ((err = enc->flush_chunk(dts)) != srs_success) {
+        return srs_error_wrap(err, "encode chunk");
+    }
+    mpd_->set_moof_sequence(video_, enc->sequence());
+
+    if ((err = fw->flush()) != srs_success) {
+        return srs_error_wrap(err, "flush chunk");
+    }
+
+    _srs_dash_partials->update(fullpath(), tmppath(), fw->tellg());
+
+    return err;
+}
+
 SrsMpdWriter::SrsMpdWriter()
 {
     req = NULL;
     timeshit = update_period = fragment = 0;
 
     window_size_ = 0;
+    chunk_ = 0;
     availability_start_time_ = 0;
 
     video_number_ = 0;
     audio_number_ = 0;
+    video_moof_sequence_ = audio_moof_sequence_ = 1;
 }
 
 SrsMpdWriter::~SrsMpdWriter()
@@ -204,9 +359,11 @@ srs_error_t SrsMpdWriter::on_publish()
     string mpd_path = srs_path_build_stream(mpd_file, req->vhost, req->app, req->stream);
     fragment_home = srs_path_dirname(mpd_path) + "/" + req->stream;
     window_size_ = _srs_config->get_dash_window_size(r->vhost);
+    chunk_ = _srs_config->get_dash_chunk(r->vhost);
 
-    srs_trace("DASH: Config fragment=%dms, period=%dms, window=%d, timeshit=%dms, home=%s, mpd=%s",
-        srsu2msi(fragment), srsu2msi(update_period), window_size_, srsu2msi(timeshit), home.c_str(), mpd_file.c_str());
+    srs_trace("DASH: Config fragment=%dms, period=%dms, window=%d, timeshit=%dms, chunk=%dms, home=%s, mpd=%s",
+        srsu2msi(fragment), srsu2msi(update_period), window_size_, srsu2msi(timeshit), srsu2msi(chunk_), home.c_str(),
+        mpd_file.c_str());
 
     return srs_success;
 }
@@ -249,6 +406,14 @@ srs_error_t SrsMpdWriter::write(SrsFormat* format, SrsFragmentWindow* afragments
        << "    minBufferTime=\"PT" << srs_fmt("%.3f", 2 * last_duration) << "S\" >" << endl;
 
     ss << "    <BaseURL>" << req->stream << "/" << "</BaseURL>" << endl;
+
+    // For low-latency DASH, the fragment is available after the first chunk is writen, so player is able to
+    // request it earlier, by the duration of fragment except the first chunk.
+    string availability_time_offset;
+    if (chunk_) {
+        availability_time_offset = "availabilityTimeOffset=\"" + srs_fmt("%.3f", srsu2s(srs_max(0, fragment - chunk_)))
+            + "\" availabilityTimeComplete=\"false\" ";
+    }
     
     ss << "    <Period start=\"PT0S\">" << endl;
     
@@ -259,12 +424,19 @@ srs_error_t SrsMpdWriter::write(SrsFormat* format, SrsFragmentWindow* afragments
         ss << "                <SegmentTemplate initialization=\"$RepresentationID$-init.mp4\" "
                                             << "media=\"$RepresentationID$-$Number$.m4s\" "
                                             << "startNumber=\"" << afragments->at(start_index)->number() << "\" "
+                                            << availability_time_offset
                                             << "timescale=\"1000\">" << endl;
         ss << "                    <SegmentTimeline>" << endl;
         for (int i = start_index; i < afragments->size(); ++i) {
             ss << "                        <S t=\"" << srsu2ms(afragments->at(i)->get_start_dts()) << "\" "
                                           << "d=\"" << srsu2ms(afragments->at(i)->duration()) << "\" />"  << endl;
         }
+        // The fragment in writing, with the expected duration, is also available for low-latency DASH.
+        if (chunk_) {
+            SrsFragment* last = afragments->at(afragments->size() - 1);
+            ss << "                        <S t=\"" << srsu2ms(last->get_start_dts() + last->duration()) << "\" "
+                                          << "d=\"" << srsu2ms(fragment) << "\" />"  << endl;
+        }
         ss << "                    </SegmentTimeline>" << endl;
         ss << "                </SegmentTemplate>" << endl;
         ss << "            </Representation>" << endl;
@@ -280,12 +452,19 @@ srs_error_t SrsMpdWriter::write(SrsFormat* format, SrsFragmentWindow* afragments
         ss << "                <SegmentTemplate initialization=\"$RepresentationID$-init.mp4\" "
                                             << "media=\"$RepresentationID$-$Number$.m4s\" "
                                             << "startNumber=\"" << vfragments->at(start_index)->number() << "\" "
+                                            << availability_time_offset
                                             << "timescale=\"1000\">" << endl;
         ss << "                    <SegmentTimeline>" << endl;
         for (int i = start_index; i < vfragments->size(); ++i) {
             ss << "                        <S t=\"" << srsu2ms(vfragments->at(i)->get_start_dts()) << "\" "
                                           << "d=\"" << srsu2ms(vfragments->at(i)->duration()) << "\" />"  << endl;
         }
+        // The fragment in writing, with the expected duration, is also available for low-latency DASH.
+        if (chunk_) {
+            SrsFragment* last = vfragments->at(vfragments->size() - 1);
+            ss << "                        <S t=\"" << srsu2ms(last->get_start_dts() + last->duration()) << "\" "
+                                          << "d=\"" << srsu2ms(fragment) << "\" />"  << endl;
+        }
         ss << "                    </SegmentTimeline>" << endl;
         ss << "                </SegmentTemplate>" << endl;
         ss << "            </Representation>" << endl;
@@ -337,6 +516,20 @@ srs_error_t SrsMpdWriter::get_fragment(bool video, std::string& home, std::strin
     return err;
 }
 
+uint32_t SrsMpdWriter::moof_sequence(bool video)
+{
+    return video ? video_moof_sequence_ : audio_moof_sequence_;
+}
+
+void SrsMpdWriter::set_moof_sequence(bool video, uint32_t sequence)
+{
+    if (video) {
+        video_moof_sequence_ = sequence;
+    } else {
+        audio_moof_sequence_ = sequence;
+    }
+}
+
 void SrsMpdWriter::set_availability_start_time(srs_utime_t t)
 {
     availability_start_time_ = t;
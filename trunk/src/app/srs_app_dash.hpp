@@ -11,8 +11,10 @@
 
 #include <string>
 #include <vector>
+#include <map>
 
 #include <srs_app_fragment.hpp>
+#include <srs_protocol_st.hpp>
 
 class SrsRequest;
 class SrsOriginHub;
@@ -37,12 +39,64 @@ public:
     virtual srs_error_t write(SrsFormat* format, bool video, int tid);
 };
 
+// The fragment in writing, for low-latency DASH.
+class SrsDashPartialFragment
+{
+public:
+    // The tmp file of fragment, which is renamed to official file when completed.
+    std::string tmppath;
+    // The bytes flushed to the tmp file, available for reading.
+    int64_t size;
+private:
+    friend class SrsDashPartialFragments;
+    // Signal the players waiting for this fragment, when it's updated or completed.
+    srs_cond_t cond_;
+    // The number of waiting players, and whether removed, the last player frees the removed fragment.
+    int nn_waiters_;
+    bool removed_;
+public:
+    SrsDashPartialFragment();
+    virtual ~SrsDashPartialFragment();
+};
+
+// The fragments in writing, indexed by the official path of fragment. Player is able to request the fragment
+// before it's completed, and we deliver each CMAF chunk in HTTP chunked encoding as soon as it's writen.
+class SrsDashPartialFragments
+{
+private:
+    std::map<std::string, SrsDashPartialFragment*> fragments_;
+public:
+    SrsDashPartialFragments();
+    virtual ~SrsDashPartialFragments();
+public:
+    // Update the available bytes of fragment in writing.
+    virtual void update(std::string path, std::string tmppath, int64_t size);
+    // Remove the fragment when completed or disposed.
+    virtual void remove(std::string path);
+    // Fetch the fragment in writing, NULL if not exists or completed.
+    virtual SrsDashPartialFragment* fetch(std::string path);
+    // Wait for the fragment to be updated or completed, in timeout, only wakeup the players of this fragment.
+    virtual void wait(std::string path, srs_utime_t timeout);
+private:
+    virtual std::string key_of(std::string path);
+};
+
+extern SrsDashPartialFragments* _srs_dash_partials;
+
 // The FMP4(Fragmented MP4) for DASH streaming.
 class SrsFragmentedMp4 : public SrsFragment
 {
 private:
     SrsFileWriter* fw;
     SrsMp4M2tsSegmentEncoder* enc;
+    // The MPD writer to update the sequence number of moof, and whether fragment is video.
+    SrsMpdWriter* mpd_;
+    bool video_;
+private:
+    // The duration of CMAF chunk, 0 for disabled.
+    srs_utime_t chunk_;
+    // The dts in ms of the first sample in current chunk, -1 if no sample.
+    int64_t chunk_dts_;
 public:
     SrsFragmentedMp4();
     virtual ~SrsFragmentedMp4();
@@ -53,6 +107,9 @@ public:
     virtual srs_error_t write(SrsSharedPtrMessage* shared_msg, SrsFormat* format);
     // Reap the fragment, close the fd and rename tmp to official file.
     virtual srs_error_t reap(uint64_t& dts);
+private:
+    // Write the cached samples as a chunk, and make it available for player.
+    virtual srs_error_t flush_chunk(uint64_t dts);
 };
 
 // The writer to write MPD for DASH.
@@ -73,12 +130,17 @@ private:
     std::string mpd_file;
     // The number of fragments in MPD file.
     int window_size_;
+    // The duration of CMAF chunk, 0 for disabled.
+    srs_utime_t chunk_;
     // The availabilityStartTime in MPD file.
     srs_utime_t availability_start_time_;
     // The number of current video segment.
     uint64_t video_number_;
     // The number of current audio segment.
     uint64_t audio_number_;
+    // The sequence number of next moof of video and audio, which increases for each moof, including chunks.
+    uint32_t video_moof_sequence_;
+    uint32_t audio_moof_sequence_;
 private:
     // The home for fragment, relative to home.
     std::string fragment_home;
@@ -97,6 +159,9 @@ public:
     // Get the fragment relative home and filename.
     // The basetime is the absolute time in srs_utime_t, while the sn(sequence number) is basetime/fragment.
     virtual srs_error_t get_fragment(bool video, std::string& home, std::string& filename, int64_t time, int64_t& sn);
+    // Get or update the sequence number of next moof, because a fragment might contain many moofs of chunks.
+    virtual uint32_t moof_sequence(bool video);
+    virtual void set_moof_sequence(bool video, uint32_t sequence);
     // Set the availabilityStartTime once, map the timestamp in media to utc time.
     virtual void set_availability_start_time(srs_utime_t t);
     virtual srs_utime_t get_availability_start_time();
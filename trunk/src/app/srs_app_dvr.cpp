@@ -25,8 +25,7 @@ using namespace std;
 #include <srs_app_utility.hpp>
 #include <srs_kernel_mp4.hpp>
 #include <srs_app_fragment.hpp>
-
-#define SRS_FWRITE_CACHE_SIZE 65536
+#include <srs_core_performance.hpp>
 
 SrsDvrSegmenter::SrsDvrSegmenter()
 {
@@ -98,7 +97,7 @@ srs_error_t SrsDvrSegmenter::open()
     }
     
     // Set libc file write cache buffer size
-    if ((err = fs->set_iobuf_size(SRS_FWRITE_CACHE_SIZE)) != srs_success) {
+    if ((err = fs->set_iobuf_size(SRS_PERF_FWRITE_CACHE_SIZE)) != srs_success) {
         return srs_error_wrap(err, "set iobuf size for file %s", path.c_str());
     }
 
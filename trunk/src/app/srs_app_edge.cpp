@@ -7,6 +7,9 @@
 #include <srs_app_edge.hpp>
 
 #include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
@@ -36,6 +39,8 @@ using namespace std;
 #include <srs_protocol_amf0.hpp>
 #include <srs_app_http_client.hpp>
 #include <srs_app_tencentcloud.hpp>
+#include <srs_app_listener.hpp>
+#include <srs_app_coworkers.hpp>
 
 // when edge timeout, retry next.
 #define SRS_EDGE_INGESTER_TIMEOUT (5 * SRS_UTIME_SECONDS)
@@ -51,9 +56,10 @@ SrsEdgeUpstream::~SrsEdgeUpstream()
 {
 }
 
-SrsEdgeRtmpUpstream::SrsEdgeRtmpUpstream(string r)
+SrsEdgeRtmpUpstream::SrsEdgeRtmpUpstream(string r, string relay)
 {
     redirect = r;
+    relay_ = relay;
     sdk = NULL;
     selected_port = 0;
 }
@@ -101,6 +107,14 @@ srs_error_t SrsEdgeRtmpUpstream::connect(SrsRequest* r, SrsLbRoundRobin* lb)
         // support vhost tranform for edge,
         std::string vhost = _srs_config->get_vhost_edge_transform_vhost(req->vhost);
         vhost = srs_string_replace(vhost, "[vhost]", req->vhost);
+
+        // Pull from the leader of edge relay, which is also an edge of the vhost, so we use the vhost
+        // of client, and the leader transforms the vhost when it pulls from origin.
+        if (!relay_.empty()) {
+            server = selected_ip = SRS_CONSTS_LOCALHOST;
+            port = selected_port = SRS_CONSTS_RTMP_DEFAULT_PORT;
+            vhost = req->vhost;
+        }
         
         url = srs_generate_rtmp_url(server, port, req->host, vhost, req->app, req->stream, req->param);
     }
@@ -109,6 +123,9 @@ srs_error_t SrsEdgeRtmpUpstream::connect(SrsRequest* r, SrsLbRoundRobin* lb)
     srs_utime_t cto = SRS_EDGE_INGESTER_TIMEOUT;
     srs_utime_t sto = SRS_CONSTS_RTMP_PULSE;
     sdk = new SrsSimpleRtmpClient(url, cto, sto);
+    if (!relay_.empty()) {
+        sdk->set_unix_path(relay_);
+    }
 
 #ifdef SRS_APM
     // Create a client span and store it to an AMF0 propagator.
@@ -127,7 +144,8 @@ srs_error_t SrsEdgeRtmpUpstream::connect(SrsRequest* r, SrsLbRoundRobin* lb)
         return srs_error_wrap(err, "edge pull %s stream failed", url.c_str());
     }
 
-    srs_trace("edge-pull publish url %s, stream=%s%s as %s", url.c_str(), req->stream.c_str(), req->param.c_str(), stream.c_str());
+    srs_trace("edge-pull publish url %s%s, stream=%s%s as %s", url.c_str(), relay_.empty() ? "" : (", relay=" + relay_).c_str(),
+        req->stream.c_str(), req->param.c_str(), stream.c_str());
     
     return err;
 }
@@ -399,7 +417,7 @@ SrsEdgeIngester::SrsEdgeIngester()
     span_main_ = NULL;
 #endif
     
-    upstream = new SrsEdgeRtmpUpstream("");
+    upstream = new SrsEdgeRtmpUpstream("", "");
     lb = new SrsLbRoundRobin();
     trd = new SrsDummyCoroutine();
 }
@@ -528,11 +546,27 @@ srs_error_t SrsEdgeIngester::do_cycle()
     srs_error_t err = srs_success;
 
     std::string redirect;
+    // Whether failed to pull from the leader of edge relay, then pull from origin directly.
+    bool relay_failed = false;
+    // Whether failed to pull from the origin in stream directory, then pull from the configured origins.
+    bool located_failed = false;
     while (true) {
         if ((err = trd->pull()) != srs_success) {
             return srs_error_wrap(err, "do cycle pull");
         }
 
+        // Try to be the leader of edge relay, for example, the previous leader quit.
+        if ((err = _srs_edge_relay->elect()) != srs_success) {
+            srs_warn("EdgeRelay: Ignore error, %s", srs_error_desc(err).c_str());
+            srs_freep(err);
+        }
+
+        // The follower always pulls from leader by RTMP, no matter what protocol the leader uses.
+        std::string relay;
+        if (!relay_failed && redirect.empty() && _srs_edge_relay->is_follower()) {
+            relay = _srs_edge_relay->path();
+        }
+
         // Use protocol in config.
         string edge_protocol = _srs_config->get_vhost_edge_protocol(req->vhost);
 
@@ -542,12 +576,29 @@ srs_error_t SrsEdgeIngester::do_cycle()
             edge_protocol = req->protocol;
         }
 
+        // Resolve the origin which publishes the stream from the directory synced from origin cluster, so we
+        // pull from it directly, without the RTMP redirect of origin.
+        std::string located;
+        if (!located_failed && relay.empty() && redirect.empty() && edge_protocol == "rtmp") {
+            std::string vhost = _srs_config->get_vhost_edge_transform_vhost(req->vhost);
+            vhost = srs_string_replace(vhost, "[vhost]", req->vhost);
+
+            SrsCoWorkerStream* location = SrsCoWorkers::instance()->lookup(vhost, req->app, req->stream);
+            if (location && !location->ip.empty() && location->port > 0) {
+                located = srs_fmt("rtmp://%s:%d/%s", location->ip.c_str(), location->port, req->app.c_str());
+            }
+        }
+
         // Create object by protocol.
         srs_freep(upstream);
-        if (edge_protocol == "flv" || edge_protocol == "flvs") {
+        if (!relay.empty()) {
+            upstream = new SrsEdgeRtmpUpstream(redirect, relay);
+        } else if (!located.empty()) {
+            upstream = new SrsEdgeRtmpUpstream(located, "");
+        } else if (edge_protocol == "flv" || edge_protocol == "flvs") {
             upstream = new SrsEdgeFlvUpstream(edge_protocol == "flv"? "http" : "https");
         } else {
-            upstream = new SrsEdgeRtmpUpstream(redirect);
+            upstream = new SrsEdgeRtmpUpstream(redirect, "");
         }
         
         if ((err = source->on_source_id_changed(_srs_context->get_id())) != srs_success) {
@@ -555,7 +606,23 @@ srs_error_t SrsEdgeIngester::do_cycle()
         }
         
         if ((err = upstream->connect(req, lb)) != srs_success) {
-            return srs_error_wrap(err, "connect upstream");
+            // The origin in directory is not available, for example, the directory is stale.
+            if (!located.empty()) {
+                srs_warn("EdgeIngester: Pull from origins for %s unavailable, %s", located.c_str(), srs_error_desc(err).c_str());
+                srs_freep(err);
+                located_failed = true;
+                continue;
+            }
+
+            if (relay.empty()) {
+                return srs_error_wrap(err, "connect upstream");
+            }
+
+            // The leader is not available, for example, it's starting or quit, so we pull from origin.
+            srs_warn("EdgeRelay: Pull from origin for leader unavailable, %s", srs_error_desc(err).c_str());
+            srs_freep(err);
+            relay_failed = true;
+            continue;
         }
         
         if ((err = edge->on_ingest_play()) != srs_success) {
@@ -1111,3 +1178,103 @@ void SrsPublishEdge::on_proxy_unpublish()
     srs_trace("edge change from %d to state %d (init).", pstate, state);
 }
 
+SrsEdgeRelay* _srs_edge_relay = NULL;
+
+SrsEdgeRelay::SrsEdgeRelay()
+{
+    handler_ = NULL;
+    lock_fd_ = -1;
+    listener_ = NULL;
+}
+
+SrsEdgeRelay::~SrsEdgeRelay()
+{
+    close();
+}
+
+srs_error_t SrsEdgeRelay::initialize(ISrsTcpHandler* handler, string path)
+{
+    handler_ = handler;
+    path_ = path;
+
+    return elect();
+}
+
+srs_error_t SrsEdgeRelay::elect()
+{
+    srs_error_t err = srs_success;
+
+    // Ignore if disabled, or we're already the leader.
+    if (path_.empty() || listener_) {
+        return err;
+    }
+
+    if (lock_fd_ < 0) {
+        string lock_file = path_ + ".lock";
+        if ((lock_fd_ = ::open(lock_file.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644)) < 0) {
+            return srs_error_new(ERROR_SYSTEM_FILE_OPENE, "open lock %s", lock_file.c_str());
+        }
+    }
+
+    // The lock is held by the leader, we're the follower.
+    if (::flock(lock_fd_, LOCK_EX | LOCK_NB) < 0) {
+        if (errno == EWOULDBLOCK) {
+            return err;
+        }
+        return srs_error_new(ERROR_SYSTEM_FILE_LOCK, "lock %s.lock", path_.c_str());
+    }
+
+    // We're the leader now, remove the socket file left by the previous leader.
+    ::unlink(path_.c_str());
+
+    listener_ = new SrsUnixListener(handler_);
+    listener_->set_path(path_)->set_label("Edge-Relay");
+    if ((err = listener_->listen()) != srs_success) {
+        srs_freep(listener_);
+        ::flock(lock_fd_, LOCK_UN);
+        return srs_error_wrap(err, "edge relay listen");
+    }
+
+    srs_trace("EdgeRelay: Elected as leader, serve followers at %s", path_.c_str());
+
+    return err;
+}
+
+void SrsEdgeRelay::close()
+{
+    if (listener_) {
+        listener_->close();
+        srs_freep(listener_);
+        ::unlink(path_.c_str());
+    }
+
+    // Release the lock by closing the fd, so a follower will be elected.
+    if (lock_fd_ >= 0) {
+        ::close(lock_fd_);
+        lock_fd_ = -1;
+    }
+
+    // Never elect again, for the server is quiting.
+    path_ = "";
+}
+
+bool SrsEdgeRelay::is_leader()
+{
+    return listener_ != NULL;
+}
+
+bool SrsEdgeRelay::is_follower()
+{
+    return !path_.empty() && !listener_;
+}
+
+bool SrsEdgeRelay::is_relay(ISrsListener* listener)
+{
+    return listener_ && listener == listener_;
+}
+
+string SrsEdgeRelay::path()
+{
+    return path_;
+}
+
@@ -33,6 +33,9 @@ class ISrsHttpMessage;
 class SrsHttpFileReader;
 class SrsFlvDecoder;
 class ISrsApmSpan;
+class ISrsTcpHandler;
+class ISrsListener;
+class SrsUnixListener;
 
 // The state of edge, auto machine
 enum SrsEdgeState
@@ -81,6 +84,8 @@ private:
     // For RTMP 302, if not empty,
     // use this <ip[:port]> as upstream.
     std::string redirect;
+    // If not empty, pull from the leader of edge relay over this unix domain socket.
+    std::string relay_;
     SrsSimpleRtmpClient* sdk;
 private:
     // Current selected server, the ip:port.
@@ -88,7 +93,8 @@ private:
     int selected_port;
 public:
     // @param rediect, override the server. ignore if empty.
-    SrsEdgeRtmpUpstream(std::string r);
+    // @param relay, the unix domain socket of edge relay leader. ignore if empty.
+    SrsEdgeRtmpUpstream(std::string r, std::string relay);
     virtual ~SrsEdgeRtmpUpstream();
 public:
     virtual srs_error_t connect(SrsRequest* r, SrsLbRoundRobin* lb);
@@ -249,5 +255,39 @@ public:
     virtual void on_proxy_unpublish();
 };
 
+// The edge relay, to share the pull of a stream by the edge processes on the same box. The process which
+// holds the lock file is the leader, which pulls from origin and serves the followers over the unix domain
+// socket, while the followers pull from the leader, so there is only one pull from origin for each stream.
+// Once the leader quit, the lock is released by system, and a follower will be elected when it pulls again.
+class SrsEdgeRelay
+{
+private:
+    ISrsTcpHandler* handler_;
+    // The unix domain socket path, and the lock file is path.lock.
+    std::string path_;
+    int lock_fd_;
+    // The listener of leader, to serve the followers.
+    SrsUnixListener* listener_;
+public:
+    SrsEdgeRelay();
+    virtual ~SrsEdgeRelay();
+public:
+    // Start the edge relay and try to be the leader, the handler is used to serve the followers.
+    srs_error_t initialize(ISrsTcpHandler* handler, std::string path);
+    // Try to be the leader, ignore if disabled, or already leader, or the lock is held by another process.
+    srs_error_t elect();
+    // Release the leadership, and stop serving the followers.
+    void close();
+public:
+    bool is_leader();
+    // Whether pull from the leader over unix domain socket.
+    bool is_follower();
+    // Whether the listener serves the followers.
+    bool is_relay(ISrsListener* listener);
+    std::string path();
+};
+
+extern SrsEdgeRelay* _srs_edge_relay;
+
 #endif
 
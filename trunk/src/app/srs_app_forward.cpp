@@ -7,6 +7,7 @@
 #include <srs_app_forward.hpp>
 
 #include <stdlib.h>
+#include <algorithm>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
@@ -30,28 +31,165 @@ using namespace std;
 #include <srs_kernel_utility.hpp>
 #include <srs_app_rtmp_conn.hpp>
 
-SrsForwarder::SrsForwarder(SrsOriginHub* h)
+SrsForwardCursor::SrsForwardCursor(SrsForwardRing* ring)
+{
+    ring_ = ring;
+    seq_ = 0;
+
+    ring_->attach(this);
+}
+
+SrsForwardCursor::~SrsForwardCursor()
+{
+    ring_->detach(this);
+}
+
+SrsForwardRing::SrsForwardRing(int capacity)
+{
+    capacity_ = capacity;
+    msgs_ = new SrsSharedPtrMessage*[capacity_];
+    tail_ = head_ = 0;
+    keyframe_ = -1;
+    queue_size_ = 0;
+    last_timestamp_ = 0;
+}
+
+SrsForwardRing::~SrsForwardRing()
+{
+    clear();
+    srs_freepa(msgs_);
+}
+
+void SrsForwardRing::set_queue_size(srs_utime_t queue_size)
+{
+    queue_size_ = queue_size;
+}
+
+void SrsForwardRing::push(SrsSharedPtrMessage* msg)
+{
+    // Drop the oldest message when full, so the slow cursors lose it.
+    if (head_ - tail_ >= capacity_) {
+        srs_freep(msgs_[tail_ % capacity_]);
+        tail_++;
+    }
+
+    SrsSharedPtrMessage* copy = msg->copy();
+    msgs_[head_ % capacity_] = copy;
+
+    if (copy->is_video() && SrsFlvVideo::keyframe(copy->payload, copy->size) && !SrsFlvVideo::sh(copy->payload, copy->size)) {
+        keyframe_ = head_;
+    }
+    if (copy->is_av()) {
+        last_timestamp_ = copy->timestamp;
+    }
+    head_++;
+
+    shrink();
+}
+
+bool SrsForwardRing::lagged(SrsForwardCursor* cursor)
+{
+    return cursor->seq_ < tail_;
+}
+
+void SrsForwardRing::dump(SrsForwardCursor* cursor, int max, SrsSharedPtrMessage** msgs, int& count)
+{
+    if (cursor->seq_ < tail_) {
+        cursor->seq_ = tail_;
+    }
+
+    count = 0;
+    while (count < max && cursor->seq_ < head_) {
+        msgs[count++] = msgs_[cursor->seq_ % capacity_]->copy();
+        cursor->seq_++;
+    }
+
+    // Release the messages consumed by all cursors.
+    shrink();
+}
+
+void SrsForwardRing::skip(SrsForwardCursor* cursor)
+{
+    cursor->seq_ = (keyframe_ >= 0) ? keyframe_ : head_;
+}
+
+void SrsForwardRing::clear()
+{
+    for (int64_t seq = tail_; seq < head_; seq++) {
+        srs_freep(msgs_[seq % capacity_]);
+    }
+    tail_ = head_;
+    keyframe_ = -1;
+    // The timestamp restarts when republish, or the new messages are expired by the stale one.
+    last_timestamp_ = 0;
+}
+
+int SrsForwardRing::size()
+{
+    return (int)(head_ - tail_);
+}
+
+void SrsForwardRing::attach(SrsForwardCursor* cursor)
+{
+    skip(cursor);
+    cursors_.push_back(cursor);
+}
+
+void SrsForwardRing::detach(SrsForwardCursor* cursor)
+{
+    std::vector<SrsForwardCursor*>::iterator it = std::find(cursors_.begin(), cursors_.end(), cursor);
+    if (it != cursors_.end()) {
+        cursors_.erase(it);
+    }
+}
+
+void SrsForwardRing::shrink()
+{
+    // Keep the messages not consumed by any cursor, and from the latest keyframe for the new cursors.
+    int64_t min_seq = head_;
+    for (int i = 0; i < (int)cursors_.size(); i++) {
+        min_seq = srs_min(min_seq, cursors_.at(i)->seq_);
+    }
+    if (keyframe_ >= 0) {
+        min_seq = srs_min(min_seq, keyframe_);
+    }
+
+    // Drop the messages exceed the queue size, even not consumed, so the slow cursors lose them.
+    int64_t queue_size = srsu2ms(queue_size_);
+    while (tail_ < head_) {
+        SrsSharedPtrMessage* msg = msgs_[tail_ % capacity_];
+        bool consumed = tail_ < min_seq;
+        bool expired = queue_size > 0 && msg->timestamp + queue_size < last_timestamp_;
+        if (!consumed && !expired) {
+            break;
+        }
+
+        srs_freep(msg);
+        tail_++;
+    }
+
+    if (keyframe_ < tail_) {
+        keyframe_ = -1;
+    }
+}
+
+SrsForwarder::SrsForwarder(SrsOriginHub* h, SrsForwardRing* r)
 {
     hub = h;
+    ring = r;
     
     req = NULL;
-    sh_video = sh_audio = NULL;
+    backpressure = SrsForwardBackpressureDrop;
+    nn_lagged = 0;
     
     sdk = NULL;
     trd = new SrsDummyCoroutine();
-    queue = new SrsMessageQueue();
-    jitter = new SrsRtmpJitter();
 }
 
 SrsForwarder::~SrsForwarder()
 {
     srs_freep(sdk);
     srs_freep(trd);
-    srs_freep(queue);
-    srs_freep(jitter);
-    
-    srs_freep(sh_video);
-    srs_freep(sh_audio);
     
     srs_freep(req);
 }
@@ -73,9 +211,9 @@ srs_error_t SrsForwarder::initialize(SrsRequest* r, string ep)
     return err;
 }
 
-void SrsForwarder::set_queue_size(srs_utime_t queue_size)
+void SrsForwarder::set_backpressure(string v)
 {
-    queue->set_queue_size(queue_size);
+    backpressure = (v == "disconnect") ? SrsForwardBackpressureDisconnect : SrsForwardBackpressureDrop;
 }
 
 srs_error_t SrsForwarder::on_publish()
@@ -97,65 +235,19 @@ void SrsForwarder::on_unpublish()
     sdk->close();
 }
 
-srs_error_t SrsForwarder::on_meta_data(SrsSharedPtrMessage* shared_metadata)
-{
-    srs_error_t err = srs_success;
-    
-    SrsSharedPtrMessage* metadata = shared_metadata->copy();
-    
-    // TODO: FIXME: config the jitter of Forwarder.
-    if ((err = jitter->correct(metadata, SrsRtmpJitterAlgorithmOFF)) != srs_success) {
-        return srs_error_wrap(err, "jitter");
-    }
-    
-    if ((err = queue->enqueue(metadata)) != srs_success) {
-        return srs_error_wrap(err, "enqueue metadata");
-    }
-    
-    return err;
-}
-
-srs_error_t SrsForwarder::on_audio(SrsSharedPtrMessage* shared_audio)
+srs_error_t SrsForwarder::on_sequence_header(SrsSharedPtrMessage* metadata, SrsSharedPtrMessage* vsh, SrsSharedPtrMessage* ash)
 {
     srs_error_t err = srs_success;
     
-    SrsSharedPtrMessage* msg = shared_audio->copy();
-    
-    // TODO: FIXME: config the jitter of Forwarder.
-    if ((err = jitter->correct(msg, SrsRtmpJitterAlgorithmOFF)) != srs_success) {
-        return srs_error_wrap(err, "jitter");
-    }
-    
-    if (SrsFlvAudio::sh(msg->payload, msg->size)) {
-        srs_freep(sh_audio);
-        sh_audio = msg->copy();
-    }
-    
-    if ((err = queue->enqueue(msg)) != srs_success) {
-        return srs_error_wrap(err, "enqueue audio");
-    }
-    
-    return err;
-}
-
-srs_error_t SrsForwarder::on_video(SrsSharedPtrMessage* shared_video)
-{
-    srs_error_t err = srs_success;
-    
-    SrsSharedPtrMessage* msg = shared_video->copy();
-    
-    // TODO: FIXME: config the jitter of Forwarder.
-    if ((err = jitter->correct(msg, SrsRtmpJitterAlgorithmOFF)) != srs_success) {
-        return srs_error_wrap(err, "jitter");
+    // TODO: FIXME: maybe need to zero the sequence header timestamp.
+    if (metadata && (err = sdk->send_and_free_message(metadata->copy())) != srs_success) {
+        return srs_error_wrap(err, "send metadata");
     }
-    
-    if (SrsFlvVideo::sh(msg->payload, msg->size)) {
-        srs_freep(sh_video);
-        sh_video = msg->copy();
+    if (vsh && (err = sdk->send_and_free_message(vsh->copy())) != srs_success) {
+        return srs_error_wrap(err, "send video sh");
     }
-    
-    if ((err = queue->enqueue(msg)) != srs_success) {
-        return srs_error_wrap(err, "enqueue video");
+    if (ash && (err = sdk->send_and_free_message(ash->copy())) != srs_success) {
+        return srs_error_wrap(err, "send audio sh");
     }
     
     return err;
@@ -227,10 +319,6 @@ srs_error_t SrsForwarder::do_cycle()
         return srs_error_wrap(err, "sdk publish");
     }
     
-    if ((err = hub->on_forwarder_start(this)) != srs_success) {
-        return srs_error_wrap(err, "notify hub start");
-    }
-    
     if ((err = forward()) != srs_success) {
         return srs_error_wrap(err, "forward");
     }
@@ -252,17 +340,12 @@ srs_error_t SrsForwarder::forward()
     
     SrsMessageArray msgs(SYS_MAX_FORWARD_SEND_MSGS);
     
-    // update sequence header
-    // TODO: FIXME: maybe need to zero the sequence header timestamp.
-    if (sh_video) {
-        if ((err = sdk->send_and_free_message(sh_video->copy())) != srs_success) {
-            return srs_error_wrap(err, "send video sh");
-        }
-    }
-    if (sh_audio) {
-        if ((err = sdk->send_and_free_message(sh_audio->copy())) != srs_success) {
-            return srs_error_wrap(err, "send audio sh");
-        }
+    // Start from the latest keyframe in ring, after the metadata and sequence headers.
+    SrsForwardCursor* cursor = new SrsForwardCursor(ring);
+    SrsAutoFree(SrsForwardCursor, cursor);
+    
+    if ((err = hub->on_forwarder_start(this)) != srs_success) {
+        return srs_error_wrap(err, "notify hub start");
     }
     
     while (true) {
@@ -285,12 +368,26 @@ srs_error_t SrsForwarder::forward()
             srs_freep(msg);
         }
         
+        // The destination is too slow, apply the backpressure policy.
+        if (ring->lagged(cursor)) {
+            nn_lagged++;
+            if (backpressure == SrsForwardBackpressureDisconnect) {
+                return srs_error_new(ERROR_SYSTEM_FORWARD_LAGGED, "lagged %d times", nn_lagged);
+            }
+            
+            ring->skip(cursor);
+            srs_warn("Forwarder: Drop messages to keyframe for %s, lagged %d times", ep_forward.c_str(), nn_lagged);
+
+            // The dropped messages might contain the new sequence header, so feed the latest one before keyframe.
+            if ((err = hub->on_forwarder_start(this)) != srs_success) {
+                return srs_error_wrap(err, "notify hub skip");
+            }
+        }
+        
         // forward all messages.
         // each msg in msgs.msgs must be free, for the SrsMessageArray never free them.
         int count = 0;
-        if ((err = queue->dump_packets(msgs.max, msgs.msgs, count)) != srs_success) {
-            return srs_error_wrap(err, "dump packets");
-        }
+        ring->dump(cursor, msgs.max, msgs.msgs, count);
         
         // pithy print
         if (pprint->can_print()) {
@@ -10,20 +10,88 @@
 #include <srs_core.hpp>
 
 #include <string>
+#include <vector>
 
+#include <srs_core_performance.hpp>
 #include <srs_app_st.hpp>
 
 class ISrsProtocolReadWriter;
 class SrsSharedPtrMessage;
 class SrsOnMetaDataPacket;
-class SrsMessageQueue;
-class SrsRtmpJitter;
 class SrsRtmpClient;
 class SrsRequest;
 class SrsLiveSource;
 class SrsOriginHub;
 class SrsKbps;
 class SrsSimpleRtmpClient;
+class SrsForwardRing;
+
+// The cursor of a forwarder to read the shared ring, which starts at the latest keyframe.
+class SrsForwardCursor
+{
+    friend class SrsForwardRing;
+private:
+    SrsForwardRing* ring_;
+    // The sequence of the next message to read.
+    int64_t seq_;
+public:
+    SrsForwardCursor(SrsForwardRing* ring);
+    virtual ~SrsForwardCursor();
+};
+
+// The ring of messages shared by all forwarders of a stream, where each forwarder reads by its own cursor, so
+// the message is copied once for all destinations, rather than copied to the queue of each forwarder.
+// The ring keeps the messages from the slowest cursor or the latest keyframe, bounded by the queue size and the
+// capacity, and the messages are dropped for the cursors which are too slow.
+class SrsForwardRing
+{
+    friend class SrsForwardCursor;
+private:
+    // The capacity of ring.
+    int capacity_;
+    // The messages in [tail_, head_), the message of sequence seq is at msgs_[seq % capacity_].
+    SrsSharedPtrMessage** msgs_;
+    int64_t tail_;
+    int64_t head_;
+    // The sequence of the latest video keyframe, -1 if not in ring.
+    int64_t keyframe_;
+    // The max duration of messages in ring.
+    srs_utime_t queue_size_;
+    // The timestamp in ms of the latest audio or video message.
+    int64_t last_timestamp_;
+    std::vector<SrsForwardCursor*> cursors_;
+public:
+    SrsForwardRing(int capacity = SRS_PERF_FORWARD_RING_SIZE);
+    virtual ~SrsForwardRing();
+public:
+    virtual void set_queue_size(srs_utime_t queue_size);
+    // Put a copy of message to ring.
+    virtual void push(SrsSharedPtrMessage* msg);
+    // Whether the cursor is too slow, that some messages are dropped before it read.
+    virtual bool lagged(SrsForwardCursor* cursor);
+    // Dump the copies of messages for cursor, which should be freed by user.
+    virtual void dump(SrsForwardCursor* cursor, int max, SrsSharedPtrMessage** msgs, int& count);
+    // Move the cursor to the latest keyframe, or the head if no keyframe, to catch up the stream.
+    virtual void skip(SrsForwardCursor* cursor);
+    // Free all messages and reset the timestamp, when stream is unpublished.
+    virtual void clear();
+    // Get the number of messages in ring.
+    virtual int size();
+private:
+    virtual void attach(SrsForwardCursor* cursor);
+    virtual void detach(SrsForwardCursor* cursor);
+    // Drop the messages which are consumed by all cursors, or exceed the queue size or capacity.
+    virtual void shrink();
+};
+
+// The policy of forwarder when the destination is too slow to consume the stream.
+enum SrsForwardBackpressure
+{
+    // Drop the messages and skip to the latest keyframe.
+    SrsForwardBackpressureDrop = 0,
+    // Disconnect and reconnect to the destination.
+    SrsForwardBackpressureDisconnect,
+};
 
 // Forward the stream to other servers.
 class SrsForwarder : public ISrsCoroutineHandler
@@ -40,29 +108,24 @@ private:
 private:
     SrsOriginHub* hub;
     SrsSimpleRtmpClient* sdk;
-    SrsRtmpJitter* jitter;
-    SrsMessageQueue* queue;
-    // Cache the sequence header for retry when slave is failed.
-    SrsSharedPtrMessage* sh_audio;
-    SrsSharedPtrMessage* sh_video;
+    // The messages shared by all forwarders of stream.
+    SrsForwardRing* ring;
+    SrsForwardBackpressure backpressure;
+    // The number of times that messages are dropped for this destination.
+    int nn_lagged;
 public:
-    SrsForwarder(SrsOriginHub* h);
+    SrsForwarder(SrsOriginHub* h, SrsForwardRing* r);
     virtual ~SrsForwarder();
 public:
     virtual srs_error_t initialize(SrsRequest* r, std::string ep);
-    virtual void set_queue_size(srs_utime_t queue_size);
+    // Set the backpressure policy, drop or disconnect.
+    virtual void set_backpressure(std::string v);
 public:
     virtual srs_error_t on_publish();
     virtual void on_unpublish();
-    // Forward the audio packet.
-    // @param shared_metadata, directly ptr, copy it if need to save it.
-    virtual srs_error_t on_meta_data(SrsSharedPtrMessage* shared_metadata);
-    // Forward the audio packet.
-    // @param shared_audio, directly ptr, copy it if need to save it.
-    virtual srs_error_t on_audio(SrsSharedPtrMessage* shared_audio);
-    // Forward the video packet.
-    // @param shared_video, directly ptr, copy it if need to save it.
-    virtual srs_error_t on_video(SrsSharedPtrMessage* shared_video);
+    // Send the metadata and sequence headers, when connected to the destination.
+    // @remark Any of them might be NULL.
+    virtual srs_error_t on_sequence_header(SrsSharedPtrMessage* metadata, SrsSharedPtrMessage* vsh, SrsSharedPtrMessage* ash);
 // Interface ISrsReusableThread2Handler.
 public:
     virtual srs_error_t cycle();
@@ -9,6 +9,7 @@
 #include <srs_kernel_utility.hpp>
 #include <srs_kernel_log.hpp>
 #include <srs_kernel_error.hpp>
+#include <srs_app_threads.hpp>
 
 #include <unistd.h>
 #include <sstream>
@@ -181,7 +182,7 @@ void SrsFragmentWindow::dispose()
     
     for (it = fragments.begin(); it != fragments.end(); ++it) {
         SrsFragment* fragment = *it;
-        if ((err = fragment->unlink_file()) != srs_success) {
+        if ((err = _srs_async_file_worker->unlink(fragment->fullpath())) != srs_success) {
             srs_warn("Unlink ts failed %s", srs_error_desc(err).c_str());
             srs_freep(err);
         }
@@ -191,7 +192,7 @@ void SrsFragmentWindow::dispose()
     
     for (it = expired_fragments.begin(); it != expired_fragments.end(); ++it) {
         SrsFragment* fragment = *it;
-        if ((err = fragment->unlink_file()) != srs_success) {
+        if ((err = _srs_async_file_worker->unlink(fragment->fullpath())) != srs_success) {
             srs_warn("Unlink ts failed %s", srs_error_desc(err).c_str());
             srs_freep(err);
         }
@@ -236,7 +237,7 @@ void SrsFragmentWindow::clear_expired(bool delete_files)
     
     for (it = expired_fragments.begin(); it != expired_fragments.end(); ++it) {
         SrsFragment* fragment = *it;
-        if (delete_files && (err = fragment->unlink_file()) != srs_success) {
+        if (delete_files && (err = _srs_async_file_worker->unlink(fragment->fullpath())) != srs_success) {
             srs_warn("Unlink ts failed, %s", srs_error_desc(err).c_str());
             srs_freep(err);
         }
@@ -22,6 +22,7 @@
 #include <srs_app_pithy_print.hpp>
 #include <srs_app_rtmp_conn.hpp>
 #include <srs_protocol_raw_avc.hpp>
+#include <srs_core_performance.hpp>
 
 #include <sstream>
 using namespace std;
@@ -33,6 +34,10 @@ using namespace std;
 #define SRS_GB_MAX_TIMEOUT 3
 #define SRS_GB_LARGE_PACKET 1500
 #define SRS_GB_SESSION_DRIVE_INTERVAL (300 * SRS_UTIME_MILLISECONDS)
+// The max size of a PS pack over UDP, generally a video frame.
+#define SRS_GB_UDP_MAX_PACK (4 * 1024 * 1024)
+// The media over UDP is disconnected, if no packets in this duration.
+#define SRS_GB_UDP_TIMEOUT (3 * SRS_UTIME_SECONDS)
 
 extern bool srs_is_rtcp(const uint8_t* data, size_t len);
 
@@ -76,6 +81,7 @@ SrsLazyGbSession::SrsLazyGbSession(SrsLazyObjectWrapper<SrsLazyGbSession>* wrapp
     sip_ = new SrsLazyObjectWrapper<SrsLazyGbSipTcpConn>();
     media_ = new SrsLazyObjectWrapper<SrsLazyGbMediaTcpConn>();
     muxer_ = new SrsGbMuxer(this);
+    udp_ = new SrsGbMediaUdpStream(muxer_);
     state_ = SrsGbSessionStateInit;
 
     connecting_starttime_ = 0;
@@ -103,6 +109,7 @@ SrsLazyGbSession::SrsLazyGbSession(SrsLazyObjectWrapper<SrsLazyGbSession>* wrapp
     cid_ = _srs_context->generate_id();
     _srs_context->set_id(cid_); // Also change current coroutine cid as session's.
     trd_ = new SrsSTCoroutine("GBS", this, cid_);
+    udp_->set_cid(cid_);
 }
 
 SrsLazyGbSession::~SrsLazyGbSession()
@@ -110,6 +117,7 @@ SrsLazyGbSession::~SrsLazyGbSession()
     srs_freep(trd_);
     srs_freep(sip_);
     srs_freep(media_);
+    srs_freep(udp_);
     srs_freep(muxer_);
     srs_freep(ppp_);
 }
@@ -218,6 +226,11 @@ void SrsLazyGbSession::on_media_transport(SrsLazyObjectWrapper<SrsLazyGbMediaTcp
     media_->resource()->set_cid(cid_);
 }
 
+void SrsLazyGbSession::on_udp_packet(char* data, int size)
+{
+    udp_->enqueue(data, size);
+}
+
 std::string SrsLazyGbSession::pip()
 {
     return pip_;
@@ -231,6 +244,10 @@ srs_error_t SrsLazyGbSession::start()
         return srs_error_wrap(err, "coroutine");
     }
 
+    if ((err = udp_->start()) != srs_success) {
+        return srs_error_wrap(err, "udp");
+    }
+
     return err;
 }
 
@@ -241,6 +258,7 @@ srs_error_t SrsLazyGbSession::cycle()
     // Interrupt the SIP and media transport when session terminated.
     sip_->resource()->interrupt();
     media_->resource()->interrupt();
+    udp_->interrupt();
 
     // Note that we added wrapper to manager, so we must free the wrapper, not this connection.
     SrsLazyObjectWrapper<SrsLazyGbSession>* wrapper = wrapper_root_;
@@ -304,6 +322,10 @@ srs_error_t SrsLazyGbSession::do_cycle()
                 alive, (total_packs_ + media_packs_), (total_recovered_ + media_recovered_), (total_reserved_ + media_reserved_),
                 (total_msgs_ + media_msgs_), (total_msgs_dropped_ + media_msgs_dropped_), media_id_, pack_alive, media_packs_,
                 media_recovered_, media_reserved_, media_msgs_, media_msgs_dropped_);
+            if (udp_->nn_packets_) {
+                srs_trace("Session: UDP packets=%" PRId64 ", lost=%" PRId64 ", late=%" PRId64 ", reordered=%" PRId64 ", packs=%" PRId64 ", drop=%" PRId64 ", overflow=%" PRId64,
+                    udp_->nn_packets_, udp_->nn_lost_, udp_->nn_late_, udp_->nn_reordered_, udp_->nn_packs_, udp_->nn_dropped_packs_, udp_->nn_overflow_);
+            }
         }
     }
 
@@ -329,7 +351,7 @@ srs_error_t SrsLazyGbSession::drive_state()
         }
 
         // Invite if media is not connected.
-        if (sip_->resource()->is_registered() && !media_->resource()->is_connected()) {
+        if (sip_->resource()->is_registered() && !media_connected()) {
             uint32_t ssrc = 0;
             if ((err = sip_->resource()->invite_request(&ssrc)) != srs_success) {
                 return srs_error_wrap(err, "invite");
@@ -349,12 +371,12 @@ srs_error_t SrsLazyGbSession::drive_state()
             }
 
             srs_trace("Session: Connecting timeout, nn=%d, state=%s, sip=%s, media=%d", nn_timeout_, srs_gb_session_state(state_).c_str(),
-                srs_gb_sip_state(sip_->resource()->state()).c_str(), media_->resource()->is_connected());
+                srs_gb_sip_state(sip_->resource()->state()).c_str(), media_connected());
             sip_->resource()->reset_to_register();
             SRS_GB_CHANGE_STATE_TO(SrsGbSessionStateInit);
         }
 
-        if (sip_->resource()->is_stable() && media_->resource()->is_connected()) {
+        if (sip_->resource()->is_stable() && media_connected()) {
             SRS_GB_CHANGE_STATE_TO(SrsGbSessionStateEstablished);
         }
     }
@@ -366,14 +388,14 @@ srs_error_t SrsLazyGbSession::drive_state()
         }
 
         // When media disconnected, we wait for a while then reinvite.
-        if (!media_->resource()->is_connected()) {
+        if (!media_connected()) {
             if (!reinviting_starttime_) {
                 reinviting_starttime_ = srs_update_system_time();
             }
             if (srs_get_system_time() - reinviting_starttime_ > reinvite_wait_) {
                 reinviting_starttime_ = 0;
                 srs_trace("Session: Re-invite for disconnect, state=%s, sip=%s, media=%d", srs_gb_session_state(state_).c_str(),
-                    srs_gb_sip_state(sip_->resource()->state()).c_str(), media_->resource()->is_connected());
+                    srs_gb_sip_state(sip_->resource()->state()).c_str(), media_connected());
                 sip_->resource()->reset_to_register();
                 SRS_GB_CHANGE_STATE_TO(SrsGbSessionStateInit);
             }
@@ -383,6 +405,11 @@ srs_error_t SrsLazyGbSession::drive_state()
     return err;
 }
 
+bool SrsLazyGbSession::media_connected()
+{
+    return media_->resource()->is_connected() || udp_->is_active();
+}
+
 SrsGbSessionState SrsLazyGbSession::set_state(SrsGbSessionState v)
 {
     SrsGbSessionState state = state_;
@@ -405,6 +432,7 @@ SrsGbListener::SrsGbListener()
     conf_ = NULL;
     sip_listener_ = new SrsTcpListener(this);
     media_listener_ = new SrsTcpListener(this);
+    media_udp_listener_ = new SrsUdpListener(this);
 }
 
 SrsGbListener::~SrsGbListener()
@@ -412,6 +440,7 @@ SrsGbListener::~SrsGbListener()
     srs_freep(conf_);
     srs_freep(sip_listener_);
     srs_freep(media_listener_);
+    srs_freep(media_udp_listener_);
 }
 
 srs_error_t SrsGbListener::initialize(SrsConfDirective* conf)
@@ -425,6 +454,7 @@ srs_error_t SrsGbListener::initialize(SrsConfDirective* conf)
     if (true) {
         int port = _srs_config->get_stream_caster_listen(conf);
         media_listener_->set_endpoint(ip, port)->set_label("GB-TCP");
+        media_udp_listener_->set_endpoint(ip, port)->set_label("GB-UDP")->set_batch(SRS_PERF_UDP_RECV_BATCH);
     }
 
     bool sip_enabled = _srs_config->get_stream_caster_sip_enable(conf);
@@ -446,6 +476,10 @@ srs_error_t SrsGbListener::listen()
         return srs_error_wrap(err, "listen");
     }
 
+    if ((err = media_udp_listener_->listen()) != srs_success) {
+        return srs_error_wrap(err, "listen");
+    }
+
     if ((err = sip_listener_->listen()) != srs_success) {
         return srs_error_wrap(err, "listen");
     }
@@ -492,6 +526,32 @@ srs_error_t SrsGbListener::on_tcp_client(ISrsListener* listener, srs_netfd_t stf
     return err;
 }
 
+srs_error_t SrsGbListener::on_udp_packet(const sockaddr* from, const int fromlen, char* buf, int nb_buf)
+{
+    // Ignore the RTCP from device, and the packet which is not RTP.
+    if (nb_buf < 12 || srs_is_rtcp((const uint8_t*)buf, nb_buf)) {
+        return srs_success;
+    }
+
+    // Dispatch to session by SSRC, which is added to manager when inviting device.
+    uint32_t ssrc = ((uint8_t)buf[8] << 24) | ((uint8_t)buf[9] << 16) | ((uint8_t)buf[10] << 8) | (uint8_t)buf[11];
+    SrsLazyObjectWrapper<SrsLazyGbSession>* session = dynamic_cast<SrsLazyObjectWrapper<SrsLazyGbSession>*>(_srs_gb_manager->find_by_fast_id(ssrc));
+    if (!session) {
+        return srs_success; // Ignore any media packet when no session.
+    }
+
+    // Switch to the context of session for logs of device, and restore it for the other devices of listener.
+    SrsContextId cid = _srs_context->get_id();
+    _srs_context->set_id(session->resource()->get_id());
+
+    // Only queue the packet, which is consumed by the session, so the listener is never blocked by a device.
+    session->resource()->on_udp_packet(buf, nb_buf);
+
+    _srs_context->set_id(cid);
+
+    return srs_success;
+}
+
 SrsLazyGbSipTcpConn::SrsLazyGbSipTcpConn(SrsLazyObjectWrapper<SrsLazyGbSipTcpConn>* wrapper_root)
 {
     wrapper_root_ = wrapper_root;
@@ -792,7 +852,9 @@ srs_error_t SrsLazyGbSipTcpConn::invite_request(uint32_t* pssrc)
     local_sdp.media_descs_.push_back(SrsMediaDesc("video"));
     SrsMediaDesc& media = local_sdp.media_descs_.at(0);
     media.port_ = media_port; // Read from config.
-    media.protos_ = "TCP/RTP/AVP";
+    // Ask device to send RTP over TCP(RFC4571) or UDP, both are listened at the same media port.
+    bool media_over_udp = _srs_config->get_stream_caster_media_transport(conf_) == "udp";
+    media.protos_ = media_over_udp ? "RTP/AVP" : "TCP/RTP/AVP";
     media.connection_ = ""; // Disable media level connection.
     media.recvonly_ = true;
 
@@ -1471,6 +1533,393 @@ srs_error_t SrsLazyGbMediaTcpConn::bind_session(uint32_t ssrc, SrsLazyObjectWrap
     return err;
 }
 
+SrsGbRtpSlot::SrsGbRtpSlot()
+{
+    used_ = false;
+    marker_ = false;
+    seq_ = 0;
+    payload_ = NULL;
+    size_ = 0;
+    capacity_ = 0;
+}
+
+SrsGbRtpSlot::~SrsGbRtpSlot()
+{
+    srs_freepa(payload_);
+}
+
+SrsGbMediaUdpStream::SrsGbMediaUdpStream(SrsGbMuxer* muxer)
+{
+    muxer_ = muxer;
+    demuxer_ = new SrsPsPackDemuxer();
+    wait_ = srs_cond_new();
+    trd_ = new SrsSTCoroutine("gb-udp", this);
+
+    slots_ = new SrsGbRtpSlot[SRS_PERF_GB_UDP_REORDER_SLOTS];
+    started_ = false;
+    next_seq_ = 0;
+    nn_buffered_ = 0;
+    blocked_at_ = 0;
+
+    pack_ = NULL;
+    pack_size_ = pack_capacity_ = 0;
+    // Drop bytes until the first pack header.
+    pack_corrupt_ = true;
+    last_active_ = 0;
+
+    nn_packets_ = nn_lost_ = nn_late_ = 0;
+    nn_reordered_ = nn_packs_ = nn_dropped_packs_ = 0;
+    nn_overflow_ = 0;
+}
+
+SrsGbMediaUdpStream::~SrsGbMediaUdpStream()
+{
+    srs_freep(trd_);
+    srs_cond_destroy(wait_);
+
+    for (vector<SrsGbRtpSlot*>::iterator it = queue_.begin(); it != queue_.end(); ++it) {
+        SrsGbRtpSlot* pkt = *it;
+        srs_freep(pkt);
+    }
+    for (vector<SrsGbRtpSlot*>::iterator it = pool_.begin(); it != pool_.end(); ++it) {
+        SrsGbRtpSlot* pkt = *it;
+        srs_freep(pkt);
+    }
+
+    srs_freep(demuxer_);
+    srs_freepa(slots_);
+    srs_freepa(pack_);
+}
+
+void SrsGbMediaUdpStream::set_cid(const SrsContextId& cid)
+{
+    trd_->set_cid(cid);
+}
+
+void SrsGbMediaUdpStream::enqueue(char* data, int size)
+{
+    if ((int)queue_.size() >= SRS_PERF_GB_UDP_QUEUE_SIZE) {
+        nn_overflow_++;
+        return;
+    }
+
+    SrsGbRtpSlot* pkt = NULL;
+    if (pool_.empty()) {
+        pkt = new SrsGbRtpSlot();
+    } else {
+        pkt = pool_.back();
+        pool_.pop_back();
+    }
+
+    if (pkt->capacity_ < size) {
+        srs_freepa(pkt->payload_);
+        pkt->capacity_ = srs_max(size, SRS_GB_LARGE_PACKET);
+        pkt->payload_ = new char[pkt->capacity_];
+    }
+    memcpy(pkt->payload_, data, size);
+    pkt->size_ = size;
+
+    queue_.push_back(pkt);
+    srs_cond_signal(wait_);
+}
+
+void SrsGbMediaUdpStream::interrupt()
+{
+    trd_->interrupt();
+}
+
+srs_error_t SrsGbMediaUdpStream::start()
+{
+    srs_error_t err = srs_success;
+
+    if ((err = trd_->start()) != srs_success) {
+        return srs_error_wrap(err, "coroutine");
+    }
+
+    return err;
+}
+
+srs_error_t SrsGbMediaUdpStream::cycle()
+{
+    srs_error_t err = do_cycle();
+
+    if (err != srs_success) {
+        srs_warn("GB: UDP stream err %s", srs_error_desc(err).c_str());
+    }
+
+    return err;
+}
+
+srs_error_t SrsGbMediaUdpStream::do_cycle()
+{
+    srs_error_t err = srs_success;
+
+    vector<SrsGbRtpSlot*> pkts;
+    while (true) {
+        // Wakeup to give up the lost packets, even if no more packets.
+        if (queue_.empty() && nn_buffered_ > 0) {
+            srs_cond_timedwait(wait_, SRS_PERF_GB_UDP_REORDER_TIMEOUT * SRS_UTIME_MILLISECONDS);
+        } else if (queue_.empty()) {
+            srs_cond_wait(wait_);
+        }
+
+        if ((err = trd_->pull()) != srs_success) {
+            return srs_error_wrap(err, "pull");
+        }
+
+        // The reorder timeout is tens of ms, so we update the time for each batch.
+        srs_update_system_time();
+
+        // Consume all queued packets, while the listener might queue more when muxer switches context.
+        pkts.swap(queue_);
+        for (int i = 0; i < (int)pkts.size(); i++) {
+            SrsGbRtpSlot* pkt = pkts.at(i);
+
+            // Never stop the stream for error of a packet.
+            if ((err = on_rtp(pkt->payload_, pkt->size_)) != srs_success) {
+                srs_warn("GB: Ignore UDP packet of size=%d, err %s", pkt->size_, srs_error_desc(err).c_str());
+                srs_freep(err);
+            }
+
+            pool_.push_back(pkt);
+        }
+        pkts.clear();
+
+        check_reorder(srs_get_system_time());
+    }
+
+    return err;
+}
+
+srs_error_t SrsGbMediaUdpStream::on_rtp(char* data, int size)
+{
+    srs_error_t err = srs_success;
+
+    // Parse the RTP header, see https://www.rfc-editor.org/rfc/rfc3550#section-5.1
+    uint8_t* p = (uint8_t*)data;
+    if (size < 12 || (p[0] >> 6) != 2) {
+        return srs_error_new(ERROR_RTC_RTP_MUXER, "invalid rtp size=%d, v=%d", size, size > 0 ? (p[0] >> 6) : 0);
+    }
+
+    int pos = 12 + (p[0] & 0x0f) * 4;
+    if ((p[0] & 0x10) && pos + 4 <= size) {
+        pos += 4 + ((p[pos + 2] << 8) | p[pos + 3]) * 4;
+    }
+    int end = size;
+    if (p[0] & 0x20) {
+        end -= p[size - 1];
+    }
+    if (pos > end) {
+        return srs_error_new(ERROR_RTC_RTP_MUXER, "invalid rtp size=%d, header=%d, end=%d", size, pos, end);
+    }
+
+    bool marker = (p[1] & 0x80);
+    uint16_t seq = (p[2] << 8) | p[3];
+    char* payload = data + pos;
+    int nn_payload = end - pos;
+
+    nn_packets_++;
+    last_active_ = srs_get_system_time();
+
+    if (!started_) {
+        started_ = true;
+        next_seq_ = seq;
+    }
+
+    // The late or duplicated packet, which is already consumed or lost.
+    int16_t distance = srs_rtp_seq_distance(next_seq_, seq);
+    if (distance < 0 && distance > -SRS_PERF_GB_UDP_REORDER_SLOTS) {
+        nn_late_++;
+        return err;
+    }
+
+    // The sequence jumps too far, device restarts the stream or lost many packets, so restart from this packet.
+    if (distance <= -SRS_PERF_GB_UDP_REORDER_SLOTS || distance >= SRS_PERF_GB_UDP_REORDER_SLOTS) {
+        if (distance > 0) nn_lost_ += distance;
+        for (int i = 0; i < SRS_PERF_GB_UDP_REORDER_SLOTS; i++) {
+            slots_[i].used_ = false;
+        }
+        nn_buffered_ = 0;
+        blocked_at_ = 0;
+        next_seq_ = seq;
+        pack_corrupt_ = true;
+        distance = 0;
+    }
+
+    // Generally the packets are in order, consume it directly without copy to reorder buffer.
+    if (distance == 0) {
+        consume(payload, nn_payload, marker);
+        next_seq_++;
+        consume_buffered();
+        return err;
+    }
+
+    // The packet is out of order, buffer it to wait for the previous packets.
+    SrsGbRtpSlot& slot = slots_[seq & (SRS_PERF_GB_UDP_REORDER_SLOTS - 1)];
+    if (slot.used_) {
+        nn_late_++;
+        return err;
+    }
+
+    if (slot.capacity_ < nn_payload) {
+        srs_freepa(slot.payload_);
+        slot.capacity_ = srs_max(nn_payload, SRS_GB_LARGE_PACKET);
+        slot.payload_ = new char[slot.capacity_];
+    }
+    memcpy(slot.payload_, payload, nn_payload);
+    slot.size_ = nn_payload;
+    slot.seq_ = seq;
+    slot.marker_ = marker;
+    slot.used_ = true;
+    nn_buffered_++;
+    nn_reordered_++;
+
+    if (!blocked_at_) {
+        blocked_at_ = last_active_;
+    }
+
+    // Too many packets wait for the lost one, skip to the first buffered packet.
+    if (nn_buffered_ > SRS_PERF_GB_UDP_REORDER_SLOTS / 2) {
+        skip_lost();
+        return err;
+    }
+
+    check_reorder(last_active_);
+
+    return err;
+}
+
+void SrsGbMediaUdpStream::check_reorder(srs_utime_t now)
+{
+    if (nn_buffered_ > 0 && blocked_at_ && now - blocked_at_ >= SRS_PERF_GB_UDP_REORDER_TIMEOUT * SRS_UTIME_MILLISECONDS) {
+        skip_lost();
+    }
+}
+
+void SrsGbMediaUdpStream::skip_lost()
+{
+    while (!slots_[next_seq_ & (SRS_PERF_GB_UDP_REORDER_SLOTS - 1)].used_) {
+        next_seq_++;
+        nn_lost_++;
+    }
+    pack_corrupt_ = true;
+    consume_buffered();
+}
+
+bool SrsGbMediaUdpStream::is_active()
+{
+    return last_active_ && srs_get_system_time() - last_active_ < SRS_GB_UDP_TIMEOUT;
+}
+
+void SrsGbMediaUdpStream::consume_buffered()
+{
+    while (nn_buffered_ > 0) {
+        SrsGbRtpSlot& slot = slots_[next_seq_ & (SRS_PERF_GB_UDP_REORDER_SLOTS - 1)];
+        if (!slot.used_ || slot.seq_ != next_seq_) {
+            break;
+        }
+
+        slot.used_ = false;
+        nn_buffered_--;
+        next_seq_++;
+
+        consume(slot.payload_, slot.size_, slot.marker_);
+    }
+
+    // Restart the clock for the next lost packet, if any packets are still buffered.
+    blocked_at_ = nn_buffered_ > 0 ? srs_get_system_time() : 0;
+}
+
+void SrsGbMediaUdpStream::consume(char* payload, int size, bool marker)
+{
+    uint8_t* p = (uint8_t*)payload;
+    bool pack_start = size >= 4 && p[0] == 0x00 && p[1] == 0x00 && p[2] == 0x01 && p[3] == 0xba;
+
+    // For corrupt pack, drop bytes until the next pack header.
+    if (pack_corrupt_) {
+        pack_size_ = 0;
+        if (!pack_start) {
+            return;
+        }
+        pack_corrupt_ = false;
+    }
+
+    // A new pack starts, the previous pack is done if no marker.
+    if (pack_start && pack_size_) {
+        flush_pack();
+    }
+
+    if (pack_size_ + size > SRS_GB_UDP_MAX_PACK) {
+        srs_warn("GB: Drop pack size=%d, max=%d", pack_size_ + size, SRS_GB_UDP_MAX_PACK);
+        nn_dropped_packs_++;
+        pack_size_ = 0;
+        pack_corrupt_ = true;
+        return;
+    }
+
+    if (pack_capacity_ < pack_size_ + size) {
+        int capacity = srs_max(pack_size_ + size, 2 * pack_capacity_);
+        char* buf = new char[capacity];
+        if (pack_size_) memcpy(buf, pack_, pack_size_);
+        srs_freepa(pack_);
+        pack_ = buf;
+        pack_capacity_ = capacity;
+    }
+    memcpy(pack_ + pack_size_, payload, size);
+    pack_size_ += size;
+
+    // The marker indicates the end of a pack, generally a frame.
+    if (marker) {
+        flush_pack();
+    }
+}
+
+void SrsGbMediaUdpStream::flush_pack()
+{
+    if (!pack_size_) {
+        return;
+    }
+
+    nn_packs_++;
+    srs_error_t err = demuxer_->demux(pack_, pack_size_, this);
+    pack_size_ = 0;
+
+    if (err != srs_success) {
+        nn_dropped_packs_++;
+        srs_warn("GB: Ignore pack err %s", srs_error_desc(err).c_str());
+        srs_freep(err);
+    }
+}
+
+srs_error_t SrsGbMediaUdpStream::on_ps_video(SrsTsStream vcodec, int64_t dts, int64_t pts, char* data, int size)
+{
+    SrsBuffer avs(data, size);
+    srs_error_t err = muxer_->on_video_frame(vcodec, dts, &avs);
+    if (err != srs_success) {
+        srs_warn("Muxer: Ignore video err %s", srs_error_desc(err).c_str());
+        srs_freep(err);
+    }
+
+    return srs_success;
+}
+
+srs_error_t SrsGbMediaUdpStream::on_ps_audio(SrsTsStream acodec, int64_t dts, int64_t pts, char* data, int size)
+{
+    // Only AAC is supported by muxer, ignore others such as G.711.
+    if (acodec != SrsTsStreamAudioAAC && acodec != SrsTsStreamReserved) {
+        return srs_success;
+    }
+
+    SrsBuffer avs(data, size);
+    srs_error_t err = muxer_->on_audio_frame(dts, &avs);
+    if (err != srs_success) {
+        srs_warn("Muxer: Ignore audio err %s", srs_error_desc(err).c_str());
+        srs_freep(err);
+    }
+
+    return srs_success;
+}
+
 SrsMpegpsQueue::SrsMpegpsQueue()
 {
     nb_audios = nb_videos = 0;
@@ -1595,11 +2044,14 @@ srs_error_t SrsGbMuxer::on_ts_message(SrsTsMessage* msg)
 
     SrsBuffer avs(msg->payload->bytes(), msg->payload->length());
     if (msg->sid == SrsTsPESStreamIdVideoCommon) {
-        if ((err = on_ts_video(msg, &avs)) != srs_success) {
+        SrsPsDecodeHelper* h = (SrsPsDecodeHelper*)msg->ps_helper_;
+        srs_assert(h && h->ctx_ && h->ps_);
+
+        if ((err = on_video_frame(h->ctx_->video_stream_type_, msg->dts, &avs)) != srs_success) {
             return srs_error_wrap(err, "ts: consume video");
         }
     } else {
-        if ((err = on_ts_audio(msg, &avs)) != srs_success) {
+        if ((err = on_audio_frame(msg->dts, &avs)) != srs_success) {
             return srs_error_wrap(err, "ts: consume audio");
         }
     }
@@ -1607,7 +2059,7 @@ srs_error_t SrsGbMuxer::on_ts_message(SrsTsMessage* msg)
     return err;
 }
 
-srs_error_t SrsGbMuxer::on_ts_video(SrsTsMessage* msg, SrsBuffer* avs)
+srs_error_t SrsGbMuxer::on_video_frame(SrsTsStream vcodec, int64_t ts_dts, SrsBuffer* avs)
 {
     srs_error_t err = srs_success;
 
@@ -1616,33 +2068,30 @@ srs_error_t SrsGbMuxer::on_ts_video(SrsTsMessage* msg, SrsBuffer* avs)
         return srs_error_wrap(err, "connect");
     }
 
-    SrsPsDecodeHelper* h = (SrsPsDecodeHelper*)msg->ps_helper_;
-    srs_assert(h && h->ctx_ && h->ps_);
-
-    if (h->ctx_->video_stream_type_ == SrsTsStreamVideoH264) {
-        if ((err = mux_h264(msg, avs)) != srs_success){
+    if (vcodec == SrsTsStreamVideoH264) {
+        if ((err = mux_h264(ts_dts, avs)) != srs_success){
             return srs_error_wrap(err, "mux h264");
         }
 #ifdef SRS_H265
-    } else if (h->ctx_->video_stream_type_ == SrsTsStreamVideoHEVC) {
-        if ((err = mux_h265(msg, avs)) != srs_success){
+    } else if (vcodec == SrsTsStreamVideoHEVC) {
+        if ((err = mux_h265(ts_dts, avs)) != srs_success){
             return srs_error_wrap(err, "mux hevc");
         }
 #endif
     } else {
-        return srs_error_new(ERROR_STREAM_CASTER_TS_CODEC, "ts: unsupported stream codec=%d", h->ctx_->video_stream_type_);
+        return srs_error_new(ERROR_STREAM_CASTER_TS_CODEC, "ts: unsupported stream codec=%d", vcodec);
     }
 
     return err;
 }
 
-srs_error_t SrsGbMuxer::mux_h264(SrsTsMessage *msg, SrsBuffer *avs)
+srs_error_t SrsGbMuxer::mux_h264(int64_t ts_dts, SrsBuffer *avs)
 {
     srs_error_t err = srs_success;
 
     // ts tbn to flv tbn.
-    uint32_t dts = (uint32_t)(msg->dts / 90);
-    uint32_t pts = (uint32_t)(msg->dts / 90);
+    uint32_t dts = (uint32_t)(ts_dts / 90);
+    uint32_t pts = (uint32_t)(ts_dts / 90);
 
     // send each frame.
     while (!avs->empty()) {
@@ -1799,13 +2248,13 @@ srs_error_t SrsGbMuxer::write_h264_ipb_frame(char* frame, int frame_size, uint32
 }
 
 #ifdef SRS_H265
-srs_error_t SrsGbMuxer::mux_h265(SrsTsMessage *msg, SrsBuffer *avs)
+srs_error_t SrsGbMuxer::mux_h265(int64_t ts_dts, SrsBuffer *avs)
 {
     srs_error_t err = srs_success;
 
     // ts tbn to flv tbn.
-    uint32_t dts = (uint32_t)(msg->dts / 90);
-    uint32_t pts = (uint32_t)(msg->dts / 90);
+    uint32_t dts = (uint32_t)(ts_dts / 90);
+    uint32_t pts = (uint32_t)(ts_dts / 90);
 
     // send each frame.
     while (!avs->empty()) {
@@ -1975,7 +2424,7 @@ srs_error_t SrsGbMuxer::write_h265_ipb_frame(char* frame, int frame_size, uint32
 }
 #endif
 
-srs_error_t SrsGbMuxer::on_ts_audio(SrsTsMessage* msg, SrsBuffer* avs)
+srs_error_t SrsGbMuxer::on_audio_frame(int64_t ts_dts, SrsBuffer* avs)
 {
     srs_error_t err = srs_success;
 
@@ -1985,7 +2434,7 @@ srs_error_t SrsGbMuxer::on_ts_audio(SrsTsMessage* msg, SrsBuffer* avs)
     }
 
     // ts tbn to flv tbn.
-    uint32_t dts = (uint32_t)(msg->dts / 90);
+    uint32_t dts = (uint32_t)(ts_dts / 90);
 
     // send each frame.
     while (!avs->empty()) {
@@ -2099,7 +2548,7 @@ srs_error_t SrsGbMuxer::connect()
 
     srs_utime_t cto = SRS_CONSTS_RTMP_TIMEOUT;
     srs_utime_t sto = SRS_CONSTS_RTMP_PULSE;
-    sdk_ = new SrsSimpleRtmpClient(url, cto, sto);
+    sdk_ = srs_rtmp_publisher_create(url, cto, sto);
 
     if ((err = sdk_->connect()) != srs_success) {
         close();
@@ -29,11 +29,12 @@ class SrsSipMessage;
 class SrsLazyGbSession;
 class SrsLazyGbSipTcpConn;
 class SrsLazyGbMediaTcpConn;
+class SrsGbMediaUdpStream;
 class SrsLazyGbSipTcpReceiver;
 class SrsLazyGbSipTcpSender;
 class SrsAlonePithyPrint;
 class SrsGbMuxer;
-class SrsSimpleRtmpClient;
+class ISrsRtmpPublisher;
 struct SrsRawAacStreamCodec;
 class SrsRawH264Stream;
 #ifdef SRS_H265
@@ -100,6 +101,8 @@ private:
     SrsLazyObjectWrapper<SrsLazyGbSession>* wrapper_root_;
     SrsLazyObjectWrapper<SrsLazyGbSipTcpConn>* sip_;
     SrsLazyObjectWrapper<SrsLazyGbMediaTcpConn>* media_;
+    // The media over UDP, which is dispatched by SSRC from the media UDP listener.
+    SrsGbMediaUdpStream* udp_;
     SrsGbMuxer* muxer_;
 private:
     // The candidate for SDP in configuration.
@@ -147,6 +150,8 @@ public:
     SrsLazyObjectWrapper<SrsLazyGbSipTcpConn>* sip_transport();
     // When got available media transport.
     void on_media_transport(SrsLazyObjectWrapper<SrsLazyGbMediaTcpConn>* media);
+    // When got a RTP packet over UDP, from the media UDP listener, which is queued to consume in coroutine.
+    void on_udp_packet(char* data, int size);
     // Get the candidate for SDP generation, the public IP address for device to connect to.
     std::string pip();
 // Interface ISrsStartable
@@ -158,6 +163,8 @@ public:
 private:
     virtual srs_error_t do_cycle();
     srs_error_t drive_state();
+    // Whether media is connected over TCP, or active over UDP.
+    bool media_connected();
 private:
     SrsGbSessionState set_state(SrsGbSessionState v);
 // Interface ISrsResource
@@ -167,11 +174,12 @@ public:
 };
 
 // The SIP and Media listener for GB.
-class SrsGbListener : public ISrsListener, public ISrsTcpHandler
+class SrsGbListener : public ISrsListener, public ISrsTcpHandler, public ISrsUdpHandler
 {
 private:
     SrsConfDirective* conf_;
     SrsTcpListener* media_listener_;
+    SrsUdpListener* media_udp_listener_;
     SrsTcpListener* sip_listener_;
 public:
     SrsGbListener();
@@ -183,6 +191,9 @@ public:
 // Interface ISrsTcpHandler
 public:
     virtual srs_error_t on_tcp_client(ISrsListener* listener, srs_netfd_t stfd);
+// Interface ISrsUdpHandler
+public:
+    virtual srs_error_t on_udp_packet(const sockaddr* from, const int fromlen, char* buf, int nb_buf);
 };
 
 // A GB28181 TCP SIP connection.
@@ -380,6 +391,102 @@ private:
     srs_error_t bind_session(uint32_t ssrc, SrsLazyObjectWrapper<SrsLazyGbSession>** psession);
 };
 
+// The RTP packet in the reorder buffer of media over UDP, only the payload is kept. It's also used for the queue of
+// the whole RTP packets, to reuse the buffer.
+struct SrsGbRtpSlot
+{
+public:
+    bool used_;
+    bool marker_;
+    uint16_t seq_;
+    char* payload_;
+    int size_;
+    int capacity_;
+public:
+    SrsGbRtpSlot();
+    virtual ~SrsGbRtpSlot();
+};
+
+// A GB28181 media stream over UDP, for PS over RTP. The packets of all devices are received in batch by the media
+// UDP listener, then dispatched to the queue of session by SSRC. The stream consumes the queue in its own coroutine,
+// and reorders packets by sequence before joining to PS pack, so the listener is never blocked by a device.
+class SrsGbMediaUdpStream : public ISrsPsPackDemuxHandler, public ISrsStartable, public ISrsCoroutineHandler
+{
+private:
+    SrsCoroutine* trd_;
+    SrsGbMuxer* muxer_;
+    SrsPsPackDemuxer* demuxer_;
+private:
+    // The RTP packets from listener, to consume in coroutine.
+    std::vector<SrsGbRtpSlot*> queue_;
+    // The free packets, to reuse the buffer.
+    std::vector<SrsGbRtpSlot*> pool_;
+    srs_cond_t wait_;
+private:
+    // The reorder buffer, the packet is at the slot of its sequence.
+    SrsGbRtpSlot* slots_;
+    bool started_;
+    // The sequence of next packet to consume.
+    uint16_t next_seq_;
+    // The number of packets in reorder buffer.
+    int nn_buffered_;
+    // When the next sequence is lost and packets are buffered, 0 if not blocked.
+    srs_utime_t blocked_at_;
+private:
+    // The bytes of current PS pack, joined by RTP payloads.
+    char* pack_;
+    int pack_size_;
+    int pack_capacity_;
+    // Whether current pack is corrupt for packet lost, so we drop bytes until the next pack header.
+    bool pack_corrupt_;
+    // The last time we got a packet.
+    srs_utime_t last_active_;
+public:
+    uint64_t nn_packets_;
+    uint64_t nn_lost_;
+    uint64_t nn_late_;
+    uint64_t nn_reordered_;
+    uint64_t nn_packs_;
+    uint64_t nn_dropped_packs_;
+    // The packets dropped for queue is full.
+    uint64_t nn_overflow_;
+public:
+    SrsGbMediaUdpStream(SrsGbMuxer* muxer);
+    virtual ~SrsGbMediaUdpStream();
+public:
+    // Set the cid of coroutine, generally the cid of session.
+    void set_cid(const SrsContextId& cid);
+    // Push a RTP packet to queue, which is copied and consumed in dedicate coroutine.
+    void enqueue(char* data, int size);
+    // Interrupt the coroutine.
+    void interrupt();
+// Interface ISrsStartable
+public:
+    virtual srs_error_t start();
+// Interface ISrsOneCycleThreadHandler
+public:
+    virtual srs_error_t cycle();
+private:
+    srs_error_t do_cycle();
+public:
+    // When got a RTP packet over UDP. Note that the data is only valid in this call.
+    srs_error_t on_rtp(char* data, int size);
+    // Whether got packets recently, that is the media is connected.
+    bool is_active();
+private:
+    // Consume the packets in reorder buffer, from the next sequence.
+    void consume_buffered();
+    // Give up the lost packets if blocked for too long, skip to the first buffered packet.
+    void check_reorder(srs_utime_t now);
+    void skip_lost();
+    void consume(char* payload, int size, bool marker);
+    void flush_pack();
+// Interface ISrsPsPackDemuxHandler
+public:
+    virtual srs_error_t on_ps_video(SrsTsStream vcodec, int64_t dts, int64_t pts, char* data, int size);
+    virtual srs_error_t on_ps_audio(SrsTsStream acodec, int64_t dts, int64_t pts, char* data, int size);
+};
+
 // The queue for mpegts over udp to send packets.
 // For the aac in mpegts contains many flv packets in a pes packet,
 // we must recalc the timestamp.
@@ -404,7 +511,7 @@ class SrsGbMuxer
 private:
     SrsLazyGbSession* session_;
     std::string output_;
-    SrsSimpleRtmpClient* sdk_;
+    ISrsRtmpPublisher* sdk_;
 private:
     SrsRawH264Stream* avc_;
     std::string h264_sps_;
@@ -433,17 +540,18 @@ public:
 public:
     srs_error_t initialize(std::string output);
     srs_error_t on_ts_message(SrsTsMessage* msg);
+    // Mux the video frame in annexb, or audio frames in ADTS, where the dts is in 90kHz.
+    srs_error_t on_video_frame(SrsTsStream vcodec, int64_t ts_dts, SrsBuffer* avs);
+    srs_error_t on_audio_frame(int64_t ts_dts, SrsBuffer* avs);
 private:
-    virtual srs_error_t on_ts_video(SrsTsMessage* msg, SrsBuffer* avs);
-    virtual srs_error_t mux_h264(SrsTsMessage* msg, SrsBuffer* avs);
+    virtual srs_error_t mux_h264(int64_t ts_dts, SrsBuffer* avs);
     virtual srs_error_t write_h264_sps_pps(uint32_t dts, uint32_t pts);
     virtual srs_error_t write_h264_ipb_frame(char* frame, int frame_size, uint32_t dts, uint32_t pts);
 #ifdef SRS_H265
-    virtual srs_error_t mux_h265(SrsTsMessage* msg, SrsBuffer* avs);
+    virtual srs_error_t mux_h265(int64_t ts_dts, SrsBuffer* avs);
     virtual srs_error_t write_h265_vps_sps_pps(uint32_t dts, uint32_t pts);
     virtual srs_error_t write_h265_ipb_frame(char* frame, int frame_size, uint32_t dts, uint32_t pts);
 #endif
-    virtual srs_error_t on_ts_audio(SrsTsMessage* msg, SrsBuffer* avs);
     virtual srs_error_t write_audio_raw_frame(char* frame, int frame_size, SrsRawAacStreamCodec* codec, uint32_t dts);
     virtual srs_error_t rtmp_write_packet(char type, uint32_t timestamp, char* data, int size);
 private:
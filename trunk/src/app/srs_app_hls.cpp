@@ -5,9 +5,11 @@
 //
 
 #include <srs_app_hls.hpp>
+#include <srs_protocol_http_stack.hpp>
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <time.h>
 #include <fcntl.h>
 #include <stdlib.h>
 #include <string.h>
@@ -34,6 +36,11 @@ using namespace std;
 #include <srs_app_utility.hpp>
 #include <srs_app_http_hooks.hpp>
 #include <srs_protocol_format.hpp>
+#include <srs_core_performance.hpp>
+#include <srs_app_threads.hpp>
+#ifdef SRS_SRT
+#include <srs_app_srt_source.hpp>
+#endif
 #include <openssl/rand.h>
 
 // drop the segment when duration of ts too small.
@@ -182,6 +189,120 @@ string SrsDvrAsyncCallOnHlsNotify::to_string()
     return "on_hls_notify: " + ts_url;
 }
 
+SrsHlsPlaylist::SrsHlsPlaylist()
+{
+    body_offset_ = 0;
+    body_crc_ = 0;
+}
+
+SrsHlsPlaylist::~SrsHlsPlaylist()
+{
+}
+
+void SrsHlsPlaylist::append(const string& lines)
+{
+    uint32_t crc = srs_crc32_ieee(lines.data(), (int)lines.length());
+
+    body_.append(lines);
+    sizes_.push_back(lines.length());
+    crcs_.push_back(crc);
+    body_crc_ += crc;
+}
+
+void SrsHlsPlaylist::shrink(int nn_segments)
+{
+    while ((int)sizes_.size() > nn_segments) {
+        body_offset_ += sizes_.front();
+        body_crc_ -= crcs_.front();
+        sizes_.pop_front();
+        crcs_.pop_front();
+    }
+
+    // Compact the body when most of it is trimmed, so it's amortized O(1) for each segment.
+    if (body_offset_ > 0 && body_offset_ >= body_.length() / 2) {
+        body_.erase(0, body_offset_);
+        body_offset_ = 0;
+    }
+}
+
+void SrsHlsPlaylist::update(const string& header)
+{
+    header_ = header;
+
+    // The header contains the media sequence, and the body is identified by the CRC of lines of segments.
+    uint32_t crc = srs_crc32_ieee(header.data(), (int)header.length());
+    int length = (int)(header_.length() + body_.length() - body_offset_);
+    etag = srs_fmt("\"%x-%x-%x\"", crc, body_crc_, length);
+
+    // For example, Wed, 21 Oct 2015 07:28:00 GMT
+    time_t now = (time_t)srsu2ms(srs_get_system_time()) / 1000;
+    last_modified = srs_http_format_date(now);
+}
+
+int SrsHlsPlaylist::size()
+{
+    return (int)sizes_.size();
+}
+
+string SrsHlsPlaylist::content()
+{
+    string v;
+    v.reserve(header_.length() + body_.length() - body_offset_);
+    v.append(header_);
+    v.append(body_, body_offset_, string::npos);
+    return v;
+}
+
+SrsHlsPlaylistCache::SrsHlsPlaylistCache()
+{
+}
+
+SrsHlsPlaylistCache::~SrsHlsPlaylistCache()
+{
+    std::map<std::string, SrsHlsPlaylist*>::iterator it;
+    for (it = playlists_.begin(); it != playlists_.end(); ++it) {
+        SrsHlsPlaylist* playlist = it->second;
+        srs_freep(playlist);
+    }
+    playlists_.clear();
+}
+
+SrsHlsPlaylist* SrsHlsPlaylistCache::create(string path)
+{
+    string key = key_of(path);
+
+    std::map<std::string, SrsHlsPlaylist*>::iterator it = playlists_.find(key);
+    if (it != playlists_.end()) {
+        return it->second;
+    }
+
+    return playlists_[key] = new SrsHlsPlaylist();
+}
+
+void SrsHlsPlaylistCache::remove(string path)
+{
+    std::map<std::string, SrsHlsPlaylist*>::iterator it = playlists_.find(key_of(path));
+    if (it != playlists_.end()) {
+        SrsHlsPlaylist* playlist = it->second;
+        srs_freep(playlist);
+        playlists_.erase(it);
+    }
+}
+
+SrsHlsPlaylist* SrsHlsPlaylistCache::fetch(string path)
+{
+    std::map<std::string, SrsHlsPlaylist*>::iterator it = playlists_.find(key_of(path));
+    return (it != playlists_.end()) ? it->second : NULL;
+}
+
+string SrsHlsPlaylistCache::key_of(string path)
+{
+    // The hls_path might ends with slash, so the path might be ./objs/nginx/html//live/livestream.m3u8
+    return srs_string_replace(path, "//", "/");
+}
+
+SrsHlsPlaylistCache* _srs_hls_playlists = NULL;
+
 SrsHlsMuxer::SrsHlsMuxer()
 {
     req = NULL;
@@ -233,8 +354,10 @@ void SrsHlsMuxer::dispose()
         srs_freep(current);
     }
     
-    if (unlink(m3u8.c_str()) < 0) {
-        srs_warn("dispose unlink path failed. file=%s", m3u8.c_str());
+    _srs_hls_playlists->remove(m3u8);
+    if ((err = _srs_async_file_worker->unlink(m3u8)) != srs_success) {
+        srs_warn("dispose unlink path failed. file=%s, %s", m3u8.c_str(), srs_error_desc(err).c_str());
+        srs_freep(err);
     }
     
     srs_trace("gracefully dispose hls %s", req? req->get_stream_url().c_str() : "");
@@ -353,8 +476,18 @@ srs_error_t SrsHlsMuxer::update_config(SrsRequest* r, string entry_prefix,
     hls_key_url = key_url;
    
     // generate the m3u8 dir and path.
+    string previous = m3u8;
     m3u8_url = srs_path_build_stream(m3u8_file, req->vhost, req->app, req->stream);
     m3u8 = path + "/" + m3u8_url;
+
+    // The playlist in memory must match the segments in window, or it's rebuilt when refresh the m3u8.
+    SrsHlsPlaylist* pl = _srs_hls_playlists->fetch(m3u8);
+    if (!previous.empty() && previous != m3u8) {
+        _srs_hls_playlists->remove(previous);
+    }
+    if (pl && pl->size() != segments->size()) {
+        _srs_hls_playlists->remove(m3u8);
+    }
     
     // when update config, reset the history target duration.
     max_td = fragment * _srs_config->get_hls_td_ratio(r->vhost);
@@ -514,6 +647,11 @@ srs_error_t SrsHlsMuxer::segment_open()
         return srs_error_wrap(err, "open hls muxer");
     }
 
+    // Set libc file write cache buffer size, to write the TS packets in large block.
+    if ((err = current->writer->set_iobuf_size(SRS_PERF_FWRITE_CACHE_SIZE)) != srs_success) {
+        return srs_error_wrap(err, "set iobuf size for file %s", tmp_file.c_str());
+    }
+
     // reset the context for a new ts start.
     context->reset();
     
@@ -628,6 +766,28 @@ srs_error_t SrsHlsMuxer::flush_video(SrsTsMessageCache* cache)
     return err;
 }
 
+srs_error_t SrsHlsMuxer::write_ts(char* data, int size, int64_t dts)
+{
+    srs_error_t err = srs_success;
+
+    // if current is NULL, segment is not open, ignore the packets.
+    if (!current) {
+        srs_warn("write ts ignored, for segment is not open.");
+        return err;
+    }
+
+    // update the duration of segment.
+    if (dts >= 0) {
+        current->append(dts / 90);
+    }
+
+    if ((err = current->writer->write(data, size, NULL)) != srs_success) {
+        return srs_error_wrap(err, "hls: write ts");
+    }
+
+    return err;
+}
+
 srs_error_t SrsHlsMuxer::segment_close()
 {
     srs_error_t err = do_segment_close();
@@ -681,6 +841,9 @@ srs_error_t SrsHlsMuxer::do_segment_close()
         // close the muxer of finished segment.
         srs_freep(current->tscw);
 
+        // Render the lines of segment once, and append to the playlist in memory.
+        playlist()->append(render_m3u8_segment(current));
+
         segments->append(current);
         current = NULL;
     } else {
@@ -690,14 +853,16 @@ srs_error_t SrsHlsMuxer::do_segment_close()
         srs_trace("Drop ts segment, sequence_no=%d, uri=%s, duration=%dms",
             current->sequence_no, current->uri.c_str(), srsu2msi(current->duration()));
         
-        // rename from tmp to real path
+        // Remove the tmp file right now, rather than in the file I/O thread, because the next segment reuses the
+        // sequence number, so it also reuses the tmp path, which should never be removed by the queued unlink.
         if ((err = current->unlink_tmpfile()) != srs_success) {
-            return srs_error_wrap(err, "rename");
+            return srs_error_wrap(err, "unlink");
         }
     }
     
     // shrink the segments.
     segments->shrink(hls_window);
+    playlist()->shrink(segments->size());
     
     // refresh the m3u8, donot contains the removed ts
     err = refresh_m3u8();
@@ -758,24 +923,23 @@ srs_error_t SrsHlsMuxer::refresh_m3u8()
         return err;
     }
     
-    std::string temp_m3u8 = m3u8 + ".temp";
-    if ((err = _refresh_m3u8(temp_m3u8)) == srs_success) {
-        if (rename(temp_m3u8.c_str(), m3u8.c_str()) < 0) {
-            err = srs_error_new(ERROR_HLS_WRITE_FAILED, "hls: rename m3u8 file failed. %s => %s", temp_m3u8.c_str(), m3u8.c_str());
-        }
+    // Update the m3u8 in memory, for HTTP server to serve it.
+    SrsHlsPlaylist* pl = playlist();
+    if ((err = _refresh_m3u8(pl)) != srs_success) {
+        return srs_error_wrap(err, "hls: build m3u8");
     }
-    
-    // remove the temp file.
-    if (srs_path_exists(temp_m3u8)) {
-        if (unlink(temp_m3u8.c_str()) < 0) {
-            srs_warn("ignore remove m3u8 failed, %s", temp_m3u8.c_str());
-        }
+
+    // Write the m3u8 to temp file then rename in the file I/O thread, to never block on disk. It's the only
+    // copy of the whole m3u8, which is moved to the task, because the file I/O thread never shares memory.
+    string content = pl->content();
+    if ((err = _srs_async_file_worker->write(m3u8, content)) != srs_success) {
+        return srs_error_wrap(err, "hls: write m3u8 %s", m3u8.c_str());
     }
     
     return err;
 }
 
-srs_error_t SrsHlsMuxer::_refresh_m3u8(string m3u8_file)
+srs_error_t SrsHlsMuxer::_refresh_m3u8(SrsHlsPlaylist* playlist)
 {
     srs_error_t err = srs_success;
     
@@ -784,11 +948,6 @@ srs_error_t SrsHlsMuxer::_refresh_m3u8(string m3u8_file)
         return err;
     }
     
-    SrsFileWriter writer;
-    if ((err = writer.open(m3u8_file)) != srs_success) {
-        return srs_error_wrap(err, "hls: open m3u8 file %s", m3u8_file.c_str());
-    }
-    
     // #EXTM3U\n
     // #EXT-X-VERSION:3\n
     std::stringstream ss;
@@ -818,55 +977,71 @@ srs_error_t SrsHlsMuxer::_refresh_m3u8(string m3u8_file)
     
     ss << "#EXT-X-TARGETDURATION:" << target_duration << SRS_CONSTS_LF;
     
-    // write all segments
+    // Only the header is rebuilt, the segments are rendered once when it's added to window, because a segment
+    // never changes after closed. So for a large window, the lines of segments are never copied.
+    playlist->update(ss.str());
+    
+    return err;
+}
+
+SrsHlsPlaylist* SrsHlsMuxer::playlist()
+{
+    SrsHlsPlaylist* pl = _srs_hls_playlists->fetch(m3u8);
+    if (pl) {
+        return pl;
+    }
+
+    // Render all segments in window once, for the playlist is removed or the m3u8 path is changed.
+    pl = _srs_hls_playlists->create(m3u8);
     for (int i = 0; i < segments->size(); i++) {
         SrsHlsSegment* segment = dynamic_cast<SrsHlsSegment*>(segments->at(i));
+        pl->append(render_m3u8_segment(segment));
+    }
+
+    return pl;
+}
+
+string SrsHlsMuxer::render_m3u8_segment(SrsHlsSegment* segment)
+{
+    std::stringstream ss;
+    
+    if (segment->is_sequence_header()) {
+        // #EXT-X-DISCONTINUITY\n
+        ss << "#EXT-X-DISCONTINUITY" << SRS_CONSTS_LF;
+    }
+    
+    if(hls_keys && ((segment->sequence_no % hls_fragments_per_key) == 0)) {
+        char hexiv[33];
+        srs_data_to_hex(hexiv, segment->iv, 16);
+        hexiv[32] = '\0';
         
-        if (segment->is_sequence_header()) {
-            // #EXT-X-DISCONTINUITY\n
-            ss << "#EXT-X-DISCONTINUITY" << SRS_CONSTS_LF;
-        }
+        string key_file = srs_path_build_stream(hls_key_file, req->vhost, req->app, req->stream);
+        key_file = srs_string_replace(key_file, "[seq]", srs_int2str(segment->sequence_no));
         
-        if(hls_keys && ((segment->sequence_no % hls_fragments_per_key) == 0)) {
-            char hexiv[33];
-            srs_data_to_hex(hexiv, segment->iv, 16);
-            hexiv[32] = '\0';
-            
-            string key_file = srs_path_build_stream(hls_key_file, req->vhost, req->app, req->stream);
-            key_file = srs_string_replace(key_file, "[seq]", srs_int2str(segment->sequence_no));
-            
-            string key_path = key_file;
-            //if key_url is not set,only use the file name
-            if (!hls_key_url.empty()) {
-                key_path = hls_key_url + key_file;
-            }
-            
-            ss << "#EXT-X-KEY:METHOD=AES-128,URI=" << "\"" << key_path << "\",IV=0x" << hexiv << SRS_CONSTS_LF;
+        string key_path = key_file;
+        //if key_url is not set,only use the file name
+        if (!hls_key_url.empty()) {
+            key_path = hls_key_url + key_file;
         }
         
-        // "#EXTINF:4294967295.208,\n"
-        ss.precision(3);
-        ss.setf(std::ios::fixed, std::ios::floatfield);
-        ss << "#EXTINF:" << srsu2msi(segment->duration()) / 1000.0 << ", no desc" << SRS_CONSTS_LF;
-        
-        // {file name}\n
-        std::string seg_uri = segment->uri;
-        if (true) {
-	        std::stringstream stemp;
-	        stemp << srsu2msi(segment->duration());
-	        seg_uri = srs_string_replace(seg_uri, "[duration]", stemp.str());
-        }
-        //ss << segment->uri << SRS_CONSTS_LF;
-        ss << seg_uri << SRS_CONSTS_LF;
+        ss << "#EXT-X-KEY:METHOD=AES-128,URI=" << "\"" << key_path << "\",IV=0x" << hexiv << SRS_CONSTS_LF;
     }
     
-    // write m3u8 to writer.
-    std::string m3u8 = ss.str();
-    if ((err = writer.write((char*)m3u8.c_str(), (int)m3u8.length(), NULL)) != srs_success) {
-        return srs_error_wrap(err, "hls: write m3u8");
+    // "#EXTINF:4294967295.208,\n"
+    ss.precision(3);
+    ss.setf(std::ios::fixed, std::ios::floatfield);
+    ss << "#EXTINF:" << srsu2msi(segment->duration()) / 1000.0 << ", no desc" << SRS_CONSTS_LF;
+    
+    // {file name}\n
+    std::string seg_uri = segment->uri;
+    if (true) {
+        std::stringstream stemp;
+        stemp << srsu2msi(segment->duration());
+        seg_uri = srs_string_replace(seg_uri, "[duration]", stemp.str());
     }
+    ss << seg_uri << SRS_CONSTS_LF;
     
-    return err;
+    return ss.str();
 }
 
 SrsHlsController::SrsHlsController()
@@ -1090,6 +1265,48 @@ srs_error_t SrsHlsController::write_video(SrsVideoFrame* frame, int64_t dts)
     return err;
 }
 
+srs_error_t SrsHlsController::write_ts(const string& psi, char* data, int size, int64_t dts, bool keyframe, bool pure_audio)
+{
+    srs_error_t err = srs_success;
+
+    // Reap the segment before the frame, so that the new segment starts with the keyframe.
+    bool reap = false;
+    if (dts >= 0) {
+        if (pure_audio) {
+            reap = muxer->is_segment_absolutely_overflow();
+        } else if (muxer->is_segment_overflow()) {
+            reap = !muxer->wait_keyframe() || keyframe;
+        }
+    }
+
+    if (reap) {
+        if ((err = muxer->segment_close()) != srs_success) {
+            srs_error_t r0 = muxer->segment_open();
+            if (r0 != srs_success) {
+                srs_warn("close segment err %s", srs_error_desc(r0).c_str());
+                srs_freep(r0);
+            }
+
+            return srs_error_wrap(err, "hls: segment close");
+        }
+
+        if ((err = muxer->segment_open()) != srs_success) {
+            return srs_error_wrap(err, "hls: segment open");
+        }
+
+        // Each segment starts with PAT and PMT, so that it's decodable by itself.
+        if (!psi.empty() && (err = muxer->write_ts((char*)psi.data(), (int)psi.size(), -1)) != srs_success) {
+            return srs_error_wrap(err, "hls: write psi");
+        }
+    }
+
+    if ((err = muxer->write_ts(data, size, dts)) != srs_success) {
+        return srs_error_wrap(err, "hls: write ts");
+    }
+
+    return err;
+}
+
 srs_error_t SrsHlsController::reap_segment()
 {
     srs_error_t err = srs_success;
@@ -1232,6 +1449,16 @@ srs_error_t SrsHls::on_publish()
     if (!_srs_config->get_hls_enabled(req->vhost)) {
         return err;
     }
+
+#ifdef SRS_SRT
+    // Ignore if HLS is written by the original TS packets of SRT stream, see SrsHlsFromSrtBridge.
+    if (_srs_config->get_srt_to_hls(req->vhost)) {
+        SrsSrtSource* srt = _srs_srt_sources->fetch(req);
+        if (srt && !srt->can_publish()) {
+            return err;
+        }
+    }
+#endif
     
     if ((err = controller->on_publish(req)) != srs_success) {
         return srs_error_wrap(err, "hls: on publish");
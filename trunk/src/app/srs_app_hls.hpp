@@ -11,6 +11,8 @@
 
 #include <string>
 #include <vector>
+#include <map>
+#include <deque>
 
 #include <srs_kernel_codec.hpp>
 #include <srs_kernel_file.hpp>
@@ -97,6 +99,64 @@ public:
     virtual std::string to_string();
 };
 
+// The m3u8 playlist in memory, to serve by HTTP without reading the file.
+// @remark The lines of segments are appended when segment is added to window, and trimmed by advancing
+//      the offset when segment is removed, so only the header is rebuilt when refresh the m3u8.
+class SrsHlsPlaylist
+{
+public:
+    // The ETag of content, for conditional GET with If-None-Match.
+    std::string etag;
+    // The HTTP date when updated, for conditional GET with If-Modified-Since.
+    std::string last_modified;
+private:
+    // The header of m3u8, such as the media sequence and target duration.
+    std::string header_;
+    // The rendered lines of segments in window, starts from the offset.
+    std::string body_;
+    size_t body_offset_;
+    // The length and CRC32 of rendered lines of each segment in window.
+    std::deque<size_t> sizes_;
+    std::deque<uint32_t> crcs_;
+    // The sum of CRC32 of segments in window, to build the ETag without scanning the body.
+    uint32_t body_crc_;
+public:
+    SrsHlsPlaylist();
+    virtual ~SrsHlsPlaylist();
+public:
+    // Append the rendered lines of a new segment.
+    virtual void append(const std::string& lines);
+    // Remove the lines of the oldest segments, to keep the last N segments.
+    virtual void shrink(int nn_segments);
+    // Update the header, then the ETag and Last-Modified of playlist.
+    virtual void update(const std::string& header);
+    // The number of segments in playlist.
+    virtual int size();
+    // Copy the whole content of m3u8, the header and the lines of segments.
+    virtual std::string content();
+};
+
+// The m3u8 playlists of all HLS streams, indexed by the path of m3u8 file, so that
+// the HTTP server could response with the latest m3u8, or 304 if not modified.
+class SrsHlsPlaylistCache
+{
+private:
+    std::map<std::string, SrsHlsPlaylist*> playlists_;
+public:
+    SrsHlsPlaylistCache();
+    virtual ~SrsHlsPlaylistCache();
+public:
+    // Fetch the playlist of m3u8 file, create an empty one if not found.
+    virtual SrsHlsPlaylist* create(std::string path);
+    virtual void remove(std::string path);
+    // Fetch the playlist of m3u8 file, return NULL if not found.
+    virtual SrsHlsPlaylist* fetch(std::string path);
+private:
+    std::string key_of(std::string path);
+};
+
+extern SrsHlsPlaylistCache* _srs_hls_playlists;
+
 // Mux the HLS stream(m3u8 and ts files).
 // Generally, the m3u8 muxer only provides methods to open/close segments,
 // to flush video/audio, without any mechenisms.
@@ -204,13 +264,20 @@ public:
     virtual bool pure_audio();
     virtual srs_error_t flush_audio(SrsTsMessageCache* cache);
     virtual srs_error_t flush_video(SrsTsMessageCache* cache);
+    // Write the TS packets to segment as is, for example, the original TS from SRT.
+    // @param dts The dts in 90kHz of frame starts in packets, to update the duration of segment, or -1 if no frame.
+    virtual srs_error_t write_ts(char* data, int size, int64_t dts);
     // Close segment(ts).
     virtual srs_error_t segment_close();
 private:
     virtual srs_error_t do_segment_close();
     virtual srs_error_t write_hls_key();
     virtual srs_error_t refresh_m3u8();
-    virtual srs_error_t _refresh_m3u8(std::string m3u8_file);
+    virtual srs_error_t _refresh_m3u8(SrsHlsPlaylist* playlist);
+    // Fetch the playlist in memory, or create it with all segments in window, for example, the m3u8 path changed.
+    virtual SrsHlsPlaylist* playlist();
+    // Render the lines of segment in m3u8, only once because segment never changes after closed.
+    virtual std::string render_m3u8_segment(SrsHlsSegment* segment);
 };
 
 // The hls stream cache,
@@ -259,6 +326,13 @@ public:
     virtual srs_error_t write_audio(SrsAudioFrame* frame, int64_t pts);
     // write video to muxer.
     virtual srs_error_t write_video(SrsVideoFrame* frame, int64_t dts);
+    // Write the original TS packets to muxer, without demux and remux, for example, from SRT. The segment is only
+    // reaped at the start of a video keyframe, or an audio frame for pure audio stream.
+    // @param psi The PAT and PMT packets, written at the start of each new segment.
+    // @param dts The dts in 90kHz of frame starts in packets, or -1 if no frame.
+    // @param keyframe Whether the frame is video keyframe.
+    // @param pure_audio Whether the stream is pure audio, so we reap by audio frame.
+    virtual srs_error_t write_ts(const std::string& psi, char* data, int size, int64_t dts, bool keyframe, bool pure_audio);
 private:
     // Reopen the muxer for a new hls segment,
     // close current segment, open a new segment,
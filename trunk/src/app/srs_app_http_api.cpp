@@ -30,6 +30,7 @@ using namespace std;
 #include <srs_protocol_amf0.hpp>
 #include <srs_protocol_utility.hpp>
 #include <srs_app_coworkers.hpp>
+#include <srs_app_http_hooks.hpp>
 
 #if defined(__linux__) || defined(SRS_OSX)
 #include <sys/utsname.h>
@@ -975,10 +976,43 @@ SrsGoApiClusters::~SrsGoApiClusters()
 
 srs_error_t SrsGoApiClusters::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessage* r)
 {
+    srs_error_t err = srs_success;
+
     SrsJsonObject* obj = SrsJsonAny::object();
     SrsAutoFree(SrsJsonObject, obj);
     
     obj->set("code", SrsJsonAny::integer(ERROR_SUCCESS));
+
+    SrsCoWorkers* coworkers = SrsCoWorkers::instance();
+
+    // The deltas of stream directory pushed by co-worker.
+    string body;
+    if (r->is_http_post() && (err = r->body_read_all(body)) != srs_success) {
+        return srs_error_wrap(err, "read body");
+    }
+    if (!body.empty()) {
+        SrsJsonAny* json = SrsJsonAny::loads(body);
+        SrsAutoFree(SrsJsonAny, json);
+        if (!json || !json->is_object()) {
+            return srs_api_response_code(w, r, ERROR_OCLUSTER_DISCOVER);
+        }
+
+        if ((err = coworkers->on_directory("", json->to_object())) != srs_success) {
+            int code = srs_error_code(err);
+            srs_freep(err);
+            return srs_api_response_code(w, r, code);
+        }
+        return srs_api_response(w, r, obj->dumps());
+    }
+
+    // The stream directory for co-worker to sync, incrementally since the version of epoch. It's only for the
+    // request with directory, while the others are the lookup of stream, even if no stream.
+    if (r->query_get("directory") == "1") {
+        string since = r->query_get("since");
+        obj->set("data", coworkers->dumps_directory(r->query_get("epoch"), ::atoll(since.c_str())));
+        return srs_api_response(w, r, obj->dumps());
+    }
+
     SrsJsonObject* data = SrsJsonAny::object();
     obj->set("data", data);
     
@@ -993,7 +1027,6 @@ srs_error_t SrsGoApiClusters::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMess
               ->set("app", SrsJsonAny::str(app.c_str()))
               ->set("stream", SrsJsonAny::str(stream.c_str())));
     
-    SrsCoWorkers* coworkers = SrsCoWorkers::instance();
     data->set("origin", coworkers->dumps(vhost, coworker, app, stream));
     
     return srs_api_response(w, r, obj->dumps());
@@ -1128,6 +1161,9 @@ srs_error_t SrsGoApiMetrics::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessa
      * clients gauge
      * clients_total counter
      * error counter
+     * hooks_latency_ms histogram
+     * hooks_errors_total counter
+     * hooks_connects_total counter
     */
 
     SrsStatistic* stat = SrsStatistic::instance();
@@ -1226,6 +1262,55 @@ srs_error_t SrsGoApiMetrics::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessa
        << nerrs
        << "\n";
 
+    // The latency and connections of HTTP hooks, for each endpoint.
+    std::map<std::string, SrsHttpHooksEndpoint*>& endpoints = _srs_http_hooks_pool->endpoints();
+    if (!endpoints.empty()) {
+        std::map<std::string, SrsHttpHooksEndpoint*>::iterator it;
+
+        ss << "# HELP srs_hooks_latency_ms The latency of SRS HTTP hooks in ms.\n"
+           << "# TYPE srs_hooks_latency_ms histogram\n";
+        for (it = endpoints.begin(); it != endpoints.end(); ++it) {
+            SrsHttpHooksEndpoint* ep = it->second;
+            int64_t count = 0;
+            for (int i = 0; i < SRS_HTTP_HOOKS_LATENCY_BUCKETS; i++) {
+                count += ep->latency_buckets_[i];
+                ss << "srs_hooks_latency_ms_bucket{endpoint=\"" << it->first << "\",le=\""
+                   << SrsHttpHooksEndpoint::latency_bounds_[i] << "\"} " << count << "\n";
+            }
+            count += ep->latency_buckets_[SRS_HTTP_HOOKS_LATENCY_BUCKETS];
+            ss << "srs_hooks_latency_ms_bucket{endpoint=\"" << it->first << "\",le=\"+Inf\"} " << count << "\n"
+               << "srs_hooks_latency_ms_sum{endpoint=\"" << it->first << "\"} " << srsu2ms(ep->latency_sum_) << "\n"
+               << "srs_hooks_latency_ms_count{endpoint=\"" << it->first << "\"} " << ep->nn_requests_ << "\n";
+        }
+
+        ss << "# HELP srs_hooks_errors_total The total errors of SRS HTTP hooks.\n"
+           << "# TYPE srs_hooks_errors_total counter\n";
+        for (it = endpoints.begin(); it != endpoints.end(); ++it) {
+            ss << "srs_hooks_errors_total{endpoint=\"" << it->first << "\"} " << it->second->nn_errors_ << "\n";
+        }
+
+        ss << "# HELP srs_hooks_connects_total The total new connections of SRS HTTP hooks, others are reused.\n"
+           << "# TYPE srs_hooks_connects_total counter\n";
+        for (it = endpoints.begin(); it != endpoints.end(); ++it) {
+            ss << "srs_hooks_connects_total{endpoint=\"" << it->first << "\"} " << it->second->nn_connects_ << "\n";
+        }
+    }
+
+    // The decision cache of HTTP hooks, the hit ratio is hits/(hits+misses).
+    if (_srs_http_hooks_cache->nn_hits_ || _srs_http_hooks_cache->nn_misses_) {
+        ss << "# HELP srs_hooks_cache_hits_total The total decisions of SRS HTTP hooks from cache.\n"
+           << "# TYPE srs_hooks_cache_hits_total counter\n"
+           << "srs_hooks_cache_hits_total " << _srs_http_hooks_cache->nn_hits_ << "\n";
+
+        ss << "# HELP srs_hooks_cache_misses_total The total decisions of SRS HTTP hooks not in cache.\n"
+           << "# TYPE srs_hooks_cache_misses_total counter\n"
+           << "srs_hooks_cache_misses_total " << _srs_http_hooks_cache->nn_misses_ << "\n";
+
+        ss << "# HELP srs_hooks_cache_entries The number of decisions in cache of SRS HTTP hooks.\n"
+           << "# TYPE srs_hooks_cache_entries gauge\n"
+           << "srs_hooks_cache_entries " << _srs_http_hooks_cache->size() << "\n";
+    }
+
     w->header()->set_content_type("text/plain; charset=utf-8");
 
     return srs_api_response(w, r, ss.str());
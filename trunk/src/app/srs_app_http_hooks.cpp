@@ -6,6 +6,7 @@
 
 #include <srs_app_http_hooks.hpp>
 
+#include <string.h>
 #include <sstream>
 using namespace std;
 
@@ -66,16 +67,16 @@ srs_error_t SrsHttpHooks::on_connect(string url, SrsRequest* req)
     
     std::string data = obj->dumps();
     std::string res;
-    int status_code;
+    int status_code = 0;
+    bool cached = false;
     
-    SrsHttpClient http;
-    if ((err = do_post(&http, url, data, status_code, res)) != srs_success) {
-        return srs_error_wrap(err, "http: on_connect failed, client_id=%s, url=%s, request=%s, response=%s, code=%d",
-            cid.c_str(), url.c_str(), data.c_str(), res.c_str(), status_code);
+    if ((err = do_post_with_cache("on_connect", url, req, data, status_code, res, cached)) != srs_success) {
+        return srs_error_wrap(err, "http: on_connect failed, client_id=%s, url=%s, request=%s, response=%s, code=%d, cached=%d",
+            cid.c_str(), url.c_str(), data.c_str(), res.c_str(), status_code, cached);
     }
     
-    srs_trace("http: on_connect ok, client_id=%s, url=%s, request=%s, response=%s",
-              cid.c_str(), url.c_str(), data.c_str(), res.c_str());
+    srs_trace("http: on_connect ok, client_id=%s, url=%s, request=%s, response=%s, cached=%d",
+              cid.c_str(), url.c_str(), data.c_str(), res.c_str(), cached);
     
     return err;
 }
@@ -101,23 +102,13 @@ void SrsHttpHooks::on_close(string url, SrsRequest* req, int64_t send_bytes, int
     obj->set("send_bytes", SrsJsonAny::integer(send_bytes));
     obj->set("recv_bytes", SrsJsonAny::integer(recv_bytes));
     
+    // Notify by the async worker, never wait for the response.
     std::string data = obj->dumps();
-    std::string res;
-    int status_code;
-    
-    SrsHttpClient http;
-    if ((err = do_post(&http, url, data, status_code, res)) != srs_success) {
-        int ret = srs_error_code(err);
+    if ((err = _srs_hooks_async->execute(new SrsHttpHooksAsyncCall(cid, "on_close", url, data))) != srs_success) {
+        srs_warn("http: ignore on_close failed, client_id=%s, url=%s, request=%s, %s",
+            cid.c_str(), url.c_str(), data.c_str(), srs_error_desc(err).c_str());
         srs_freep(err);
-        srs_warn("http: ignore on_close failed, client_id=%s, url=%s, request=%s, response=%s, code=%d, ret=%d",
-            cid.c_str(), url.c_str(), data.c_str(), res.c_str(), status_code, ret);
-        return;
     }
-    
-    srs_trace("http: on_close ok, client_id=%s, url=%s, request=%s, response=%s",
-        cid.c_str(), url.c_str(), data.c_str(), res.c_str());
-    
-    return;
 }
 
 srs_error_t SrsHttpHooks::on_publish(string url, SrsRequest* req)
@@ -152,8 +143,7 @@ srs_error_t SrsHttpHooks::on_publish(string url, SrsRequest* req)
     std::string res;
     int status_code;
     
-    SrsHttpClient http;
-    if ((err = do_post(&http, url, data, status_code, res)) != srs_success) {
+    if ((err = do_post(url, data, status_code, res)) != srs_success) {
         return srs_error_wrap(err, "http: on_publish failed, client_id=%s, url=%s, request=%s, response=%s, code=%d",
             cid.c_str(), url.c_str(), data.c_str(), res.c_str(), status_code);
     }
@@ -196,8 +186,7 @@ void SrsHttpHooks::on_unpublish(string url, SrsRequest* req)
     std::string res;
     int status_code;
     
-    SrsHttpClient http;
-    if ((err = do_post(&http, url, data, status_code, res)) != srs_success) {
+    if ((err = do_post(url, data, status_code, res)) != srs_success) {
         int ret = srs_error_code(err);
         srs_freep(err);
         srs_warn("http: ignore on_unpublish failed, client_id=%s, url=%s, request=%s, response=%s, status=%d, ret=%d",
@@ -242,16 +231,16 @@ srs_error_t SrsHttpHooks::on_play(string url, SrsRequest* req)
     
     std::string data = obj->dumps();
     std::string res;
-    int status_code;
+    int status_code = 0;
+    bool cached = false;
     
-    SrsHttpClient http;
-    if ((err = do_post(&http, url, data, status_code, res)) != srs_success) {
-        return srs_error_wrap(err, "http: on_play failed, client_id=%s, url=%s, request=%s, response=%s, status=%d",
-            cid.c_str(), url.c_str(), data.c_str(), res.c_str(), status_code);
+    if ((err = do_post_with_cache("on_play", url, req, data, status_code, res, cached)) != srs_success) {
+        return srs_error_wrap(err, "http: on_play failed, client_id=%s, url=%s, request=%s, response=%s, status=%d, cached=%d",
+            cid.c_str(), url.c_str(), data.c_str(), res.c_str(), status_code, cached);
     }
     
-    srs_trace("http: on_play ok, client_id=%s, url=%s, request=%s, response=%s",
-        cid.c_str(), url.c_str(), data.c_str(), res.c_str());
+    srs_trace("http: on_play ok, client_id=%s, url=%s, request=%s, response=%s, cached=%d",
+        cid.c_str(), url.c_str(), data.c_str(), res.c_str(), cached);
     
     return err;
 }
@@ -284,23 +273,13 @@ void SrsHttpHooks::on_stop(string url, SrsRequest* req)
         obj->set("stream_id", SrsJsonAny::str(stream->id.c_str()));
     }
     
+    // Notify by the async worker, never wait for the response.
     std::string data = obj->dumps();
-    std::string res;
-    int status_code;
-    
-    SrsHttpClient http;
-    if ((err = do_post(&http, url, data, status_code, res)) != srs_success) {
-        int ret = srs_error_code(err);
+    if ((err = _srs_hooks_async->execute(new SrsHttpHooksAsyncCall(cid, "on_stop", url, data))) != srs_success) {
+        srs_warn("http: ignore on_stop failed, client_id=%s, url=%s, request=%s, %s",
+            cid.c_str(), url.c_str(), data.c_str(), srs_error_desc(err).c_str());
         srs_freep(err);
-        srs_warn("http: ignore on_stop failed, client_id=%s, url=%s, request=%s, response=%s, code=%d, ret=%d",
-            cid.c_str(), url.c_str(), data.c_str(), res.c_str(), status_code, ret);
-        return;
     }
-    
-    srs_trace("http: on_stop ok, client_id=%s, url=%s, request=%s, response=%s",
-        cid.c_str(), url.c_str(), data.c_str(), res.c_str());
-    
-    return;
 }
 
 srs_error_t SrsHttpHooks::on_dvr(SrsContextId c, string url, SrsRequest* req, string file)
@@ -338,8 +317,7 @@ srs_error_t SrsHttpHooks::on_dvr(SrsContextId c, string url, SrsRequest* req, st
     std::string res;
     int status_code;
     
-    SrsHttpClient http;
-    if ((err = do_post(&http, url, data, status_code, res)) != srs_success) {
+    if ((err = do_post(url, data, status_code, res)) != srs_success) {
         return srs_error_wrap(err, "http post on_dvr uri failed, client_id=%s, url=%s, request=%s, response=%s, code=%d",
             cid.c_str(), url.c_str(), data.c_str(), res.c_str(), status_code);
     }
@@ -396,8 +374,7 @@ srs_error_t SrsHttpHooks::on_hls(SrsContextId c, string url, SrsRequest* req, st
     std::string res;
     int status_code;
     
-    SrsHttpClient http;
-    if ((err = do_post(&http, url, data, status_code, res)) != srs_success) {
+    if ((err = do_post(url, data, status_code, res)) != srs_success) {
         return srs_error_wrap(err, "http: post %s with %s, status=%d, res=%s", url.c_str(), data.c_str(), status_code, res.c_str());
     }
     
@@ -485,8 +462,7 @@ srs_error_t SrsHttpHooks::discover_co_workers(string url, string& host, int& por
     std::string res;
     int status_code;
     
-    SrsHttpClient http;
-    if ((err = do_post(&http, url, "", status_code, res)) != srs_success) {
+    if ((err = do_post(url, "", status_code, res)) != srs_success) {
         return srs_error_wrap(err, "http: post %s, status=%d, res=%s", url.c_str(), status_code, res.c_str());
     }
     
@@ -533,6 +509,38 @@ srs_error_t SrsHttpHooks::discover_co_workers(string url, string& host, int& por
     return err;
 }
 
+srs_error_t SrsHttpHooks::discover_directory(string url, SrsJsonObject** pres)
+{
+    srs_error_t err = srs_success;
+
+    std::string res;
+    int status_code;
+
+    if ((err = do_post(url, "", status_code, res)) != srs_success) {
+        return srs_error_wrap(err, "http: post %s, status=%d, res=%s", url.c_str(), status_code, res.c_str());
+    }
+
+    SrsJsonAny* jr = NULL;
+    if ((jr = SrsJsonAny::loads(res)) == NULL) {
+        return srs_error_new(ERROR_OCLUSTER_DISCOVER, "load json from %s", res.c_str());
+    }
+
+    if (!jr->is_object()) {
+        srs_freep(jr);
+        return srs_error_new(ERROR_OCLUSTER_DISCOVER, "response %s", res.c_str());
+    }
+
+    SrsJsonObject* robj = jr->to_object();
+    if (robj->ensure_property_object("data") == NULL) {
+        srs_freep(robj);
+        return srs_error_new(ERROR_OCLUSTER_DISCOVER, "parse data %s", res.c_str());
+    }
+
+    *pres = robj;
+
+    return err;
+}
+
 srs_error_t SrsHttpHooks::on_forward_backend(string url, SrsRequest* req, std::vector<std::string>& rtmp_urls)
 {
     srs_error_t err = srs_success;
@@ -559,8 +567,7 @@ srs_error_t SrsHttpHooks::on_forward_backend(string url, SrsRequest* req, std::v
     std::string res;
     int status_code;
 
-    SrsHttpClient http;
-    if ((err = do_post(&http, url, data, status_code, res)) != srs_success) {
+    if ((err = do_post(url, data, status_code, res)) != srs_success) {
         return srs_error_wrap(err, "http: on_forward_backend failed, client_id=%s, url=%s, request=%s, response=%s, code=%d",
             cid.c_str(), url.c_str(), data.c_str(), res.c_str(), status_code);
     }
@@ -604,35 +611,15 @@ srs_error_t SrsHttpHooks::on_forward_backend(string url, SrsRequest* req, std::v
     return err;
 }
 
-srs_error_t SrsHttpHooks::do_post(SrsHttpClient* hc, std::string url, std::string req, int& code, string& res)
+srs_error_t SrsHttpHooks::do_post(std::string url, std::string req, int& code, string& res)
 {
     srs_error_t err = srs_success;
     
-    SrsHttpUri uri;
-    if ((err = uri.initialize(url)) != srs_success) {
+    // Reuse the keep-alive connection to the endpoint of url.
+    if ((err = _srs_http_hooks_pool->post(url, req, code, res)) != srs_success) {
         return srs_error_wrap(err, "http: post failed. url=%s", url.c_str());
     }
     
-    if ((err = hc->initialize(uri.get_schema(), uri.get_host(), uri.get_port())) != srs_success) {
-        return srs_error_wrap(err, "http: init client");
-    }
-    
-    string path = uri.get_path();
-    if (!uri.get_query().empty()) {
-        path += "?" + uri.get_query();
-    }
-    
-    ISrsHttpMessage* msg = NULL;
-    if ((err = hc->post(path, req, &msg)) != srs_success) {
-        return srs_error_wrap(err, "http: client post");
-    }
-    SrsAutoFree(ISrsHttpMessage, msg);
-    
-    code = msg->status_code();
-    if ((err = msg->body_read_all(res)) != srs_success) {
-        return srs_error_wrap(err, "http: body read");
-    }
-    
     // ensure the http status is ok.
     if (code != SRS_CONSTS_HTTP_OK && code != SRS_CONSTS_HTTP_Created) {
         return srs_error_new(ERROR_HTTP_STATUS_INVALID, "http: status %d", code);
@@ -671,3 +658,411 @@ srs_error_t SrsHttpHooks::do_post(SrsHttpClient* hc, std::string url, std::strin
     
     return err;
 }
+
+srs_error_t SrsHttpHooks::do_post_with_cache(string action, string url, SrsRequest* req, string data, int& code, string& res, bool& cached)
+{
+    srs_error_t err = srs_success;
+
+    cached = false;
+    srs_utime_t ttl = _srs_config->get_vhost_http_hooks_cache_ttl(req->vhost);
+    srs_utime_t negative_ttl = _srs_config->get_vhost_http_hooks_cache_negative_ttl(req->vhost);
+    if (ttl <= 0 && negative_ttl <= 0) {
+        return do_post(url, data, code, res);
+    }
+
+    std::string key = SrsHttpHooksCache::key(action, url, req);
+    if (_srs_http_hooks_cache->fetch(key, &err)) {
+        cached = true;
+        return err;
+    }
+
+    err = do_post(url, data, code, res);
+    _srs_http_hooks_cache->update(key, err, code, res, ttl, negative_ttl);
+
+    return err;
+}
+
+// The max time to wait for a connection of endpoint, when exceed the max connections.
+#define SRS_HTTP_HOOKS_WAIT_TIMEOUT (3 * SRS_UTIME_SECONDS)
+// Close the idle connection after this time, which should be less than the keep-alive timeout of server,
+// for example, 75s for nginx and 60s for most load balancers.
+#define SRS_HTTP_HOOKS_IDLE_TIMEOUT (30 * SRS_UTIME_SECONDS)
+
+SrsHttpHooksPool* _srs_http_hooks_pool = NULL;
+
+const int SrsHttpHooksEndpoint::latency_bounds_[SRS_HTTP_HOOKS_LATENCY_BUCKETS] = {
+    5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000
+};
+
+SrsHttpHooksEndpoint::SrsHttpHooksEndpoint(string schema, string host, int port)
+{
+    schema_ = schema;
+    host_ = host;
+    port_ = port;
+    nn_active_ = 0;
+    cond_ = srs_cond_new();
+
+    memset(latency_buckets_, 0, sizeof(latency_buckets_));
+    latency_sum_ = 0;
+    nn_requests_ = 0;
+    nn_errors_ = 0;
+    nn_connects_ = 0;
+}
+
+SrsHttpHooksEndpoint::~SrsHttpHooksEndpoint()
+{
+    close_idles();
+    srs_cond_destroy(cond_);
+}
+
+string SrsHttpHooksEndpoint::url()
+{
+    return srs_fmt("%s://%s:%d", schema_.c_str(), host_.c_str(), port_);
+}
+
+srs_error_t SrsHttpHooksEndpoint::acquire(SrsHttpClient** pclient, bool* reused, bool fresh)
+{
+    srs_error_t err = srs_success;
+
+    // Bound the concurrency, wait for a client to be released.
+    srs_utime_t starttime = srs_update_system_time();
+    while (nn_active_ >= SRS_PERF_HTTP_HOOKS_MAX_CONNS) {
+        srs_utime_t elapsed = srs_update_system_time() - starttime;
+        if (elapsed >= SRS_HTTP_HOOKS_WAIT_TIMEOUT) {
+            return srs_error_new(ERROR_HTTP_HOOKS_BUSY, "exceed %d conns, wait=%dms",
+                SRS_PERF_HTTP_HOOKS_MAX_CONNS, srsu2msi(elapsed));
+        }
+        srs_cond_timedwait(cond_, SRS_HTTP_HOOKS_WAIT_TIMEOUT - elapsed);
+    }
+
+    // Reuse the most recently used client, and free it if idle for a long time, because it might be closed
+    // by server, and all the clients before it are idle longer.
+    srs_utime_t now = srs_update_system_time();
+    while (!fresh && !idles_.empty()) {
+        SrsHttpClient* client = idles_.back();
+        srs_utime_t idle_time = idle_times_.back();
+        idles_.pop_back();
+        idle_times_.pop_back();
+
+        if (now - idle_time < SRS_HTTP_HOOKS_IDLE_TIMEOUT) {
+            nn_active_++;
+            *pclient = client;
+            *reused = true;
+            return err;
+        }
+
+        srs_freep(client);
+    }
+
+    SrsHttpClient* client = new SrsHttpClient();
+    if ((err = client->initialize(schema_, host_, port_)) != srs_success) {
+        srs_freep(client);
+        return srs_error_wrap(err, "http: init client");
+    }
+
+    nn_active_++;
+    nn_connects_++;
+    *pclient = client;
+    *reused = false;
+
+    return err;
+}
+
+void SrsHttpHooksEndpoint::release(SrsHttpClient* client, bool keep_alive)
+{
+    nn_active_--;
+
+    if (keep_alive && (int)idles_.size() < SRS_PERF_HTTP_HOOKS_MAX_CONNS) {
+        idles_.push_back(client);
+        idle_times_.push_back(srs_update_system_time());
+    } else {
+        srs_freep(client);
+    }
+
+    srs_cond_signal(cond_);
+}
+
+void SrsHttpHooksEndpoint::close_idles()
+{
+    for (int i = 0; i < (int)idles_.size(); i++) {
+        SrsHttpClient* client = idles_.at(i);
+        srs_freep(client);
+    }
+    idles_.clear();
+    idle_times_.clear();
+}
+
+void SrsHttpHooksEndpoint::on_response(srs_utime_t elapsed, bool ok)
+{
+    nn_requests_++;
+    if (!ok) {
+        nn_errors_++;
+    }
+
+    latency_sum_ += elapsed;
+
+    int ms = srsu2msi(elapsed);
+    int i = 0;
+    while (i < SRS_HTTP_HOOKS_LATENCY_BUCKETS && ms > latency_bounds_[i]) {
+        i++;
+    }
+    latency_buckets_[i]++;
+}
+
+SrsHttpHooksPool::SrsHttpHooksPool()
+{
+}
+
+SrsHttpHooksPool::~SrsHttpHooksPool()
+{
+    std::map<std::string, SrsHttpHooksEndpoint*>::iterator it;
+    for (it = endpoints_.begin(); it != endpoints_.end(); ++it) {
+        SrsHttpHooksEndpoint* ep = it->second;
+        srs_freep(ep);
+    }
+}
+
+srs_error_t SrsHttpHooksPool::post(string url, string req, int& code, string& res)
+{
+    srs_error_t err = srs_success;
+
+    SrsHttpUri uri;
+    if ((err = uri.initialize(url)) != srs_success) {
+        return srs_error_wrap(err, "parse url");
+    }
+
+    string path = uri.get_path();
+    if (!uri.get_query().empty()) {
+        path += "?" + uri.get_query();
+    }
+
+    SrsHttpHooksEndpoint* ep = NULL;
+    string key = srs_fmt("%s://%s:%d", uri.get_schema().c_str(), uri.get_host().c_str(), uri.get_port());
+    std::map<std::string, SrsHttpHooksEndpoint*>::iterator it = endpoints_.find(key);
+    if (it != endpoints_.end()) {
+        ep = it->second;
+    } else {
+        ep = endpoints_[key] = new SrsHttpHooksEndpoint(uri.get_schema(), uri.get_host(), uri.get_port());
+    }
+
+    srs_utime_t starttime = srs_update_system_time();
+
+    // The reused connection might be closed by server when idle, so we retry once by a new connection. Note that
+    // the server might receive the request twice, if it closes the connection without response.
+    bool fresh = false;
+    for (int i = 0; i < 2; i++) {
+        SrsHttpClient* hc = NULL;
+        bool reused = false;
+        if ((err = ep->acquire(&hc, &reused, fresh)) != srs_success) {
+            break;
+        }
+
+        bool keep_alive = false;
+        err = do_post(hc, path, req, code, res, keep_alive);
+        ep->release(hc, err == srs_success && keep_alive);
+
+        if (err != srs_success && reused && i == 0) {
+            srs_warn("http: retry for reused conn of %s, %s", key.c_str(), srs_error_desc(err).c_str());
+            srs_freep(err);
+
+            // The other idle connections are probably closed by server too, so drop them and dial a new one.
+            ep->close_idles();
+            fresh = true;
+            continue;
+        }
+        break;
+    }
+
+    ep->on_response(srs_update_system_time() - starttime, err == srs_success);
+
+    return err;
+}
+
+std::map<std::string, SrsHttpHooksEndpoint*>& SrsHttpHooksPool::endpoints()
+{
+    return endpoints_;
+}
+
+srs_error_t SrsHttpHooksPool::do_post(SrsHttpClient* hc, string path, string req, int& code, string& res, bool& keep_alive)
+{
+    srs_error_t err = srs_success;
+
+    ISrsHttpMessage* msg = NULL;
+    if ((err = hc->post(path, req, &msg)) != srs_success) {
+        return srs_error_wrap(err, "http: client post");
+    }
+    SrsAutoFree(ISrsHttpMessage, msg);
+
+    code = msg->status_code();
+    if ((err = msg->body_read_all(res)) != srs_success) {
+        return srs_error_wrap(err, "http: body read");
+    }
+
+    // Reuse the connection only if the whole response is read, and server doesn't close it.
+    keep_alive = msg->is_keep_alive();
+
+    return err;
+}
+
+SrsHttpHooksCacheEntry::SrsHttpHooksCacheEntry()
+{
+    expired = 0;
+    code = ERROR_SUCCESS;
+}
+
+SrsHttpHooksCacheEntry::~SrsHttpHooksCacheEntry()
+{
+}
+
+SrsHttpHooksCache* _srs_http_hooks_cache = NULL;
+
+SrsHttpHooksCache::SrsHttpHooksCache(int capacity)
+{
+    capacity_ = capacity;
+    nn_hits_ = 0;
+    nn_misses_ = 0;
+}
+
+SrsHttpHooksCache::~SrsHttpHooksCache()
+{
+    std::list<SrsHttpHooksCacheEntry*>::iterator it;
+    for (it = lru_.begin(); it != lru_.end(); ++it) {
+        SrsHttpHooksCacheEntry* entry = *it;
+        srs_freep(entry);
+    }
+    lru_.clear();
+    entries_.clear();
+}
+
+string SrsHttpHooksCache::key(string action, string url, SrsRequest* req)
+{
+    // Use a separator which never in url, to avoid ambiguous keys.
+    return action + "\n" + url + "\n" + req->vhost + "\n" + req->app + "\n" + req->stream + "\n" + req->param;
+}
+
+bool SrsHttpHooksCache::fetch(string key, srs_error_t* perr)
+{
+    std::map<std::string, std::list<SrsHttpHooksCacheEntry*>::iterator>::iterator it = entries_.find(key);
+    if (it == entries_.end()) {
+        nn_misses_++;
+        return false;
+    }
+
+    SrsHttpHooksCacheEntry* entry = *it->second;
+    if (entry->expired <= srs_get_system_time()) {
+        erase(key);
+        nn_misses_++;
+        return false;
+    }
+
+    nn_hits_++;
+    lru_.splice(lru_.begin(), lru_, it->second);
+
+    if (entry->code != ERROR_SUCCESS) {
+        *perr = srs_error_new(entry->code, "cached %s", entry->desc.c_str());
+    } else {
+        *perr = srs_success;
+    }
+
+    return true;
+}
+
+void SrsHttpHooksCache::update(string key, srs_error_t err, int code, string res, srs_utime_t ttl, srs_utime_t negative_ttl)
+{
+    // Only cache the decision of backend, that is allowed, HTTP 4xx or a non-zero code in response, never the
+    // errors of network or backend such as HTTP 5xx.
+    int ecode = srs_error_code(err);
+    bool denied = ecode == ERROR_RESPONSE_CODE || (ecode == ERROR_HTTP_STATUS_INVALID && code >= 400 && code < 500);
+    if (err != srs_success && !denied) {
+        return;
+    }
+
+    // The backend is able to override the TTL by response object, for example, {"code": 0, "cache_ttl": 60}.
+    srs_utime_t expires = denied ? negative_ttl : ttl;
+    SrsJsonAny* info = SrsJsonAny::loads(res);
+    SrsAutoFree(SrsJsonAny, info);
+    if (info && info->is_object()) {
+        SrsJsonAny* prop = info->to_object()->ensure_property_integer("cache_ttl");
+        if (prop) {
+            expires = srs_utime_t(prop->to_integer() * SRS_UTIME_SECONDS);
+        }
+    }
+
+    erase(key);
+    if (expires <= 0) {
+        return;
+    }
+
+    SrsHttpHooksCacheEntry* entry = new SrsHttpHooksCacheEntry();
+    entry->key = key;
+    entry->expired = srs_get_system_time() + expires;
+    if (denied) {
+        entry->code = ecode;
+        entry->desc = srs_error_summary(err);
+    }
+
+    lru_.push_front(entry);
+    entries_[key] = lru_.begin();
+
+    // Evict the least recently used decisions.
+    while ((int)lru_.size() > capacity_) {
+        erase(lru_.back()->key);
+    }
+}
+
+int SrsHttpHooksCache::size()
+{
+    return (int)lru_.size();
+}
+
+void SrsHttpHooksCache::erase(string key)
+{
+    std::map<std::string, std::list<SrsHttpHooksCacheEntry*>::iterator>::iterator it = entries_.find(key);
+    if (it == entries_.end()) {
+        return;
+    }
+
+    SrsHttpHooksCacheEntry* entry = *it->second;
+    lru_.erase(it->second);
+    entries_.erase(it);
+    srs_freep(entry);
+}
+
+SrsHttpHooksAsyncCall::SrsHttpHooksAsyncCall(SrsContextId cid, string action, string url, string data)
+{
+    cid_ = cid;
+    action_ = action;
+    url_ = url;
+    data_ = data;
+}
+
+SrsHttpHooksAsyncCall::~SrsHttpHooksAsyncCall()
+{
+}
+
+srs_error_t SrsHttpHooksAsyncCall::call()
+{
+    srs_error_t err = srs_success;
+
+    std::string res;
+    int status_code = 0;
+
+    if ((err = SrsHttpHooks::do_post(url_, data_, status_code, res)) != srs_success) {
+        int ret = srs_error_code(err);
+        srs_freep(err);
+        srs_warn("http: ignore %s failed, client_id=%s, url=%s, request=%s, response=%s, code=%d, ret=%d",
+            action_.c_str(), cid_.c_str(), url_.c_str(), data_.c_str(), res.c_str(), status_code, ret);
+        return err;
+    }
+
+    srs_trace("http: %s ok, client_id=%s, url=%s, request=%s, response=%s",
+        action_.c_str(), cid_.c_str(), url_.c_str(), data_.c_str(), res.c_str());
+
+    return err;
+}
+
+string SrsHttpHooksAsyncCall::to_string()
+{
+    return srs_fmt("%s: client_id=%s, url=%s", action_.c_str(), cid_.c_str(), url_.c_str());
+}
+
@@ -11,12 +11,19 @@
 
 #include <string>
 #include <vector>
+#include <map>
+#include <list>
+
+#include <srs_core_performance.hpp>
+#include <srs_app_st.hpp>
+#include <srs_app_async_call.hpp>
 
 class SrsHttpUri;
 class SrsStSocket;
 class SrsRequest;
 class SrsHttpParser;
 class SrsHttpClient;
+class SrsJsonObject;
 
 // the http hooks, http callback api,
 // for some event, such as on_connect, call
@@ -24,6 +31,7 @@ class SrsHttpClient;
 // TODO: Refine to global variable.
 class SrsHttpHooks
 {
+    friend class SrsHttpHooksAsyncCall;
 private:
     SrsHttpHooks();
 public:
@@ -36,6 +44,7 @@ public:
     // The on_close hook, when client disconnect to srs, where client is valid by on_connect.
     // @param url the api server url, to process the event.
     //         ignore if empty.
+    // @remark It's async, the client never wait for the response.
     static void on_close(std::string url, SrsRequest* req, int64_t send_bytes, int64_t recv_bytes);
     // The on_publish hook, when client(encoder) start to publish stream
     // @param url the api server url, to valid the client.
@@ -52,6 +61,7 @@ public:
     // The on_stop hook, when client stop to play the stream.
     // @param url the api server url, to process the event.
     //         ignore if empty.
+    // @remark It's async, the client never wait for the response.
     static void on_stop(std::string url, SrsRequest* req);
     // The on_dvr hook, when reap a dvr file.
     // @param url the api server url, to process the event.
@@ -80,13 +90,152 @@ public:
     static srs_error_t on_hls_notify(SrsContextId cid, std::string url, SrsRequest* req, std::string ts_url, int nb_notify);
     // Discover co-workers for origin cluster.
     static srs_error_t discover_co_workers(std::string url, std::string& host, int& port);
+    // Sync the stream directory of co-worker for origin cluster.
+    // @param pres The response object with the directory in data, user must free it.
+    static srs_error_t discover_directory(std::string url, SrsJsonObject** pres);
     // The on_forward_backend hook, when publish stream start to forward
     // @param url the api server url, to valid the client.
     //         ignore if empty.
     static srs_error_t on_forward_backend(std::string url, SrsRequest* req, std::vector<std::string>& rtmp_urls);
 private:
-    static srs_error_t do_post(SrsHttpClient* hc, std::string url, std::string req, int& code, std::string& res);
+    static srs_error_t do_post(std::string url, std::string req, int& code, std::string& res);
+    // Post the req, or use the cached decision if the cache of vhost is enabled.
+    // @param cached Whether the decision is from cache.
+    static srs_error_t do_post_with_cache(std::string action, std::string url, SrsRequest* req, std::string data,
+        int& code, std::string& res, bool& cached);
+};
+
+// The number of buckets of latency histogram for HTTP hooks.
+#define SRS_HTTP_HOOKS_LATENCY_BUCKETS 10
+
+// The keep-alive HTTP clients to an endpoint of hooks, which is schema://host:port, to reuse the connections
+// rather than connect for each hook. The concurrency is bounded, and the latency is stat in histogram.
+class SrsHttpHooksEndpoint
+{
+private:
+    std::string schema_;
+    std::string host_;
+    int port_;
+    // The idle clients, the last one is the most recently used.
+    std::vector<SrsHttpClient*> idles_;
+    std::vector<srs_utime_t> idle_times_;
+    // The number of clients in using.
+    int nn_active_;
+    srs_cond_t cond_;
+public:
+    // The upper bound in ms of each bucket of latency histogram, the last is +Inf.
+    static const int latency_bounds_[SRS_HTTP_HOOKS_LATENCY_BUCKETS];
+    // The number of hooks in each bucket, not cumulative.
+    int64_t latency_buckets_[SRS_HTTP_HOOKS_LATENCY_BUCKETS + 1];
+    // The sum of latency in srs_utime_t.
+    srs_utime_t latency_sum_;
+    int64_t nn_requests_;
+    int64_t nn_errors_;
+    // The number of new connections, so the reused is requests minus it.
+    int64_t nn_connects_;
+public:
+    SrsHttpHooksEndpoint(std::string schema, std::string host, int port);
+    virtual ~SrsHttpHooksEndpoint();
+public:
+    std::string url();
+    // Get an idle client, or create a new one, wait if exceed the max connections.
+    // @param reused Whether the client is reused, which might be closed by server.
+    // @param fresh Whether to create a new client, never reuse the idle ones.
+    srs_error_t acquire(SrsHttpClient** pclient, bool* reused, bool fresh);
+    // Put the client back to reuse if keep alive, or free it.
+    void release(SrsHttpClient* client, bool keep_alive);
+    // Free all idle clients, which are probably closed by server, for example, the server restarts.
+    void close_idles();
+    // Stat the latency of a hook.
+    void on_response(srs_utime_t elapsed, bool ok);
+};
+
+// The pool of HTTP hooks endpoints.
+class SrsHttpHooksPool
+{
+private:
+    std::map<std::string, SrsHttpHooksEndpoint*> endpoints_;
+public:
+    SrsHttpHooksPool();
+    virtual ~SrsHttpHooksPool();
+public:
+    // Post the req to url by the keep-alive client, and read the whole response.
+    srs_error_t post(std::string url, std::string req, int& code, std::string& res);
+    std::map<std::string, SrsHttpHooksEndpoint*>& endpoints();
+private:
+    srs_error_t do_post(SrsHttpClient* hc, std::string path, std::string req, int& code, std::string& res, bool& keep_alive);
+};
+
+extern SrsHttpHooksPool* _srs_http_hooks_pool;
+
+// The decision of a hook in cache.
+class SrsHttpHooksCacheEntry
+{
+public:
+    std::string key;
+    // The time to expire the decision.
+    srs_utime_t expired;
+    // The error code of decision, ERROR_SUCCESS for allowed.
+    int code;
+    // The description of error, for the denied decision.
+    std::string desc;
+public:
+    SrsHttpHooksCacheEntry();
+    virtual ~SrsHttpHooksCacheEntry();
+};
+
+// The LRU cache of decisions of on_connect and on_play, keyed by the hook url, vhost, app, stream and param, so
+// the players of a hot stream with the same token are allowed or denied without calling the backend for each one.
+class SrsHttpHooksCache
+{
+private:
+    int capacity_;
+    // The most recently used entry is at the front.
+    std::list<SrsHttpHooksCacheEntry*> lru_;
+    std::map<std::string, std::list<SrsHttpHooksCacheEntry*>::iterator> entries_;
+public:
+    int64_t nn_hits_;
+    int64_t nn_misses_;
+public:
+    SrsHttpHooksCache(int capacity = SRS_PERF_HTTP_HOOKS_CACHE_SIZE);
+    virtual ~SrsHttpHooksCache();
+public:
+    // Build the key of decision for the hook action and url.
+    static std::string key(std::string action, std::string url, SrsRequest* req);
+    // Fetch the decision, return false if not cached or expired.
+    // @param perr Output the error of denied decision, or srs_success for allowed.
+    virtual bool fetch(std::string key, srs_error_t* perr);
+    // Cache the decision of the response res, while err is the error of hook. The backend is able to override the
+    // TTL by cache_ttl in response object, and the errors which is not a decision, such as timeout, are ignored.
+    // @param code The HTTP status code.
+    virtual void update(std::string key, srs_error_t err, int code, std::string res, srs_utime_t ttl, srs_utime_t negative_ttl);
+    // Get the number of cached decisions.
+    virtual int size();
+private:
+    virtual void erase(std::string key);
 };
 
+extern SrsHttpHooksCache* _srs_http_hooks_cache;
+
+// The async call for the notification hooks, such as on_stop, which never block the client to quit, and
+// all the notifications are sent one by one over the keep-alive connection by the async worker.
+class SrsHttpHooksAsyncCall : public ISrsAsyncCallTask
+{
+private:
+    SrsContextId cid_;
+    std::string action_;
+    std::string url_;
+    std::string data_;
+public:
+    SrsHttpHooksAsyncCall(SrsContextId cid, std::string action, std::string url, std::string data);
+    virtual ~SrsHttpHooksAsyncCall();
+public:
+    virtual srs_error_t call();
+    virtual std::string to_string();
+};
+
+// The async worker for notification hooks.
+extern SrsAsyncCallWorker* _srs_hooks_async;
+
 #endif
 
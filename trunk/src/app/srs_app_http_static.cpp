@@ -38,9 +38,71 @@ using namespace std;
 #include <srs_app_statistic.hpp>
 #include <srs_app_hybrid.hpp>
 #include <srs_protocol_log.hpp>
+#include <srs_app_hls.hpp>
+#include <srs_app_dash.hpp>
+#include <srs_kernel_mp4.hpp>
 
 #define SRS_CONTEXT_IN_HLS "hls_ctx"
 
+// The timeout to wait for the next chunk of DASH fragment in writing.
+#define SRS_DASH_PARTIAL_TIMEOUT (10 * SRS_UTIME_SECONDS)
+// The buffer to read the DASH fragment in writing.
+#define SRS_DASH_PARTIAL_BUFFER_SIZE 4096
+
+// Response the m3u8 content, or 304 if the client already has the same content.
+srs_error_t srs_hls_serve_playlist(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, const string& content, string etag, string last_modified)
+{
+    srs_error_t err = srs_success;
+
+    bool not_modified = false;
+    string if_none_match = r->header()->get("If-None-Match");
+    if (!if_none_match.empty()) {
+        not_modified = !etag.empty() && if_none_match.find(etag) != string::npos;
+    } else {
+        // Not modified if the content is not changed since the date of client, in seconds.
+        time_t since = 0, modified = 0;
+        if (srs_http_parse_date(r->header()->get("If-Modified-Since"), &since) && srs_http_parse_date(last_modified, &modified)) {
+            not_modified = modified <= since;
+        }
+    }
+
+    if (!etag.empty()) {
+        w->header()->set("ETag", etag);
+    }
+    if (!last_modified.empty()) {
+        w->header()->set("Last-Modified", last_modified);
+    }
+    w->header()->set_content_type("application/vnd.apple.mpegurl");
+
+    if (not_modified) {
+        w->header()->set_content_length(0);
+        w->write_header(SRS_CONSTS_HTTP_NotModified);
+    } else {
+        w->header()->set_content_length(content.length());
+        w->write_header(SRS_CONSTS_HTTP_OK);
+        if (!content.empty() && (err = w->write((char*)content.data(), content.length())) != srs_success) {
+            return srs_error_wrap(err, "write bytes=%d", (int)content.length());
+        }
+    }
+
+    if ((err = w->final_request()) != srs_success) {
+        return srs_error_wrap(err, "final request");
+    }
+
+    return err;
+}
+
+string srs_hls_playlist_variant_etag(string etag, string ctx)
+{
+    // For example, the ETag "8f1a-0-2c" of playlist, with hls_ctx is "8f1a-0-2c-5e3d".
+    if (etag.length() < 2 || etag.at(etag.length() - 1) != '"') {
+        return etag;
+    }
+
+    uint32_t crc = srs_crc32_ieee(ctx.data(), (int)ctx.length());
+    return etag.substr(0, etag.length() - 1) + srs_fmt("-%x\"", crc);
+}
+
 SrsHlsVirtualConn::SrsHlsVirtualConn()
 {
     req = NULL;
@@ -202,17 +264,24 @@ srs_error_t SrsHlsStream::serve_exists_session(ISrsHttpResponseWriter* w, ISrsHt
 {
     srs_error_t err = srs_success;
 
-    // Read m3u8 content.
-    SrsFileReader* fs = factory->create_file_reader();
-    SrsAutoFree(SrsFileReader, fs);
+    // Use the m3u8 content in memory if HLS is muxing, or read m3u8 content from file.
+    string content, etag, last_modified;
+    SrsHlsPlaylist* playlist = _srs_hls_playlists->fetch(fullpath);
+    if (playlist) {
+        content = playlist->content();
+        etag = playlist->etag;
+        last_modified = playlist->last_modified;
+    } else {
+        SrsFileReader* fs = factory->create_file_reader();
+        SrsAutoFree(SrsFileReader, fs);
 
-    if ((err = fs->open(fullpath)) != srs_success) {
-        return srs_error_wrap(err, "open %s", fullpath.c_str());
-    }
+        if ((err = fs->open(fullpath)) != srs_success) {
+            return srs_error_wrap(err, "open %s", fullpath.c_str());
+        }
 
-    string content;
-    if ((err = srs_ioutil_read_all(fs, content)) != srs_success) {
-        return srs_error_wrap(err, "read %s", fullpath.c_str());
+        if ((err = srs_ioutil_read_all(fs, content)) != srs_success) {
+            return srs_error_wrap(err, "read %s", fullpath.c_str());
+        }
     }
 
     // Rebuild the m3u8 content, make .ts with hls_ctx.
@@ -230,18 +299,17 @@ srs_error_t SrsHlsStream::serve_exists_session(ISrsHttpResponseWriter* w, ISrsHt
         } else {
             content = srs_string_replace(content, ".ts", query);
         }
-    }
 
-    // Response with rebuilt content.
-    w->header()->set_content_type("application/vnd.apple.mpegurl");
-    w->header()->set_content_length(content.length());
-    w->write_header(SRS_CONSTS_HTTP_OK);
-    if (!content.empty()) {
-        w->write((char*)content.data(), content.length());
+        // The rebuilt content is a variant of playlist for each session, so the ETag is made by the ETag of
+        // playlist and the session, to never match the raw playlist or the playlist of other session.
+        if (!etag.empty()) {
+            etag = srs_hls_playlist_variant_etag(etag, ctx);
+        }
     }
 
-    if ((err = w->final_request()) != srs_success) {
-        return srs_error_wrap(err, "final request");
+    // Response with rebuilt content.
+    if ((err = srs_hls_serve_playlist(w, r, content, etag, last_modified)) != srs_success) {
+        return srs_error_wrap(err, "serve %s", fullpath.c_str());
     }
 
     return err;
@@ -382,6 +450,107 @@ bool SrsHlsStream::is_interrupt(std::string id) {
     return false;
 }
 
+SrsMp4IndexCacheEntry::SrsMp4IndexCacheEntry()
+{
+    mtime = 0;
+    size = 0;
+    index = NULL;
+}
+
+SrsMp4IndexCacheEntry::~SrsMp4IndexCacheEntry()
+{
+    srs_freep(index);
+}
+
+SrsMp4IndexCache* _srs_mp4_indexes = NULL;
+
+SrsMp4IndexCache::SrsMp4IndexCache(int capacity)
+{
+    capacity_ = capacity;
+}
+
+SrsMp4IndexCache::~SrsMp4IndexCache()
+{
+    std::list<SrsMp4IndexCacheEntry*>::iterator it;
+    for (it = lru_.begin(); it != lru_.end(); ++it) {
+        SrsMp4IndexCacheEntry* entry = *it;
+        srs_freep(entry);
+    }
+    lru_.clear();
+    entries_.clear();
+}
+
+srs_error_t SrsMp4IndexCache::fetch(string path, ISrsFileReaderFactory* factory, SrsMp4VodIndex** pindex)
+{
+    srs_error_t err = srs_success;
+
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) {
+        return srs_error_new(ERROR_SYSTEM_FILE_NOT_EXISTS, "stat %s", path.c_str());
+    }
+
+    // Use the cached index if file not changed, and move it to the front.
+    std::map<std::string, std::list<SrsMp4IndexCacheEntry*>::iterator>::iterator it = entries_.find(path);
+    if (it != entries_.end()) {
+        SrsMp4IndexCacheEntry* entry = *it->second;
+        if (entry->mtime == (int64_t)st.st_mtime && entry->size == (int64_t)st.st_size) {
+            lru_.splice(lru_.begin(), lru_, it->second);
+            *pindex = entry->index;
+            return err;
+        }
+
+        erase(path);
+    }
+
+    SrsFileReader* fs = factory->create_file_reader();
+    SrsAutoFree(SrsFileReader, fs);
+
+    if ((err = fs->open(path)) != srs_success) {
+        return srs_error_wrap(err, "open %s", path.c_str());
+    }
+
+    SrsMp4VodIndex* index = new SrsMp4VodIndex();
+    if ((err = index->initialize(fs)) != srs_success) {
+        srs_freep(index);
+        return srs_error_wrap(err, "load index %s", path.c_str());
+    }
+
+    SrsMp4IndexCacheEntry* entry = new SrsMp4IndexCacheEntry();
+    entry->path = path;
+    entry->mtime = (int64_t)st.st_mtime;
+    entry->size = (int64_t)st.st_size;
+    entry->index = index;
+
+    lru_.push_front(entry);
+    entries_[path] = lru_.begin();
+
+    // Evict the least recently used index.
+    while ((int)lru_.size() > capacity_) {
+        erase(lru_.back()->path);
+    }
+
+    *pindex = index;
+    return err;
+}
+
+int SrsMp4IndexCache::size()
+{
+    return (int)lru_.size();
+}
+
+void SrsMp4IndexCache::erase(string path)
+{
+    std::map<std::string, std::list<SrsMp4IndexCacheEntry*>::iterator>::iterator it = entries_.find(path);
+    if (it == entries_.end()) {
+        return;
+    }
+
+    SrsMp4IndexCacheEntry* entry = *it->second;
+    lru_.erase(it->second);
+    entries_.erase(it);
+    srs_freep(entry);
+}
+
 SrsVodStream::SrsVodStream(string root_dir) : SrsHttpFileServer(root_dir)
 {
 }
@@ -521,6 +690,78 @@ srs_error_t SrsVodStream::serve_mp4_stream(ISrsHttpResponseWriter* w, ISrsHttpMe
     return err;
 }
 
+srs_error_t SrsVodStream::serve_mp4_seek(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, string fullpath, srs_utime_t time, int64_t start, int64_t end)
+{
+    srs_error_t err = srs_success;
+
+    srs_assert(start >= 0);
+    srs_assert(end == -1 || end >= 0);
+
+    SrsMp4VodIndex* index = NULL;
+    if ((err = _srs_mp4_indexes->fetch(fullpath, fs_factory, &index)) != srs_success) {
+        return srs_error_wrap(err, "mp4 index %s", fullpath.c_str());
+    }
+
+    // The trimmed mp4 is the head, and the body [body_start, body_end) in file.
+    string head;
+    int64_t body_start = 0, body_end = 0;
+    if ((err = index->trim(srsu2ms(time), head, body_start, body_end)) != srs_success) {
+        return srs_error_wrap(err, "trim mp4 %s, time=%dms", fullpath.c_str(), srsu2msi(time));
+    }
+
+    SrsFileReader* fs = fs_factory->create_file_reader();
+    SrsAutoFree(SrsFileReader, fs);
+
+    if ((err = fs->open(fullpath)) != srs_success) {
+        return srs_error_wrap(err, "fs open");
+    }
+
+    // parse -1 to whole file.
+    int64_t nb_head = (int64_t)head.size();
+    int64_t filesize = nb_head + body_end - body_start;
+    if (end == -1) {
+        end = filesize - 1;
+    }
+
+    if (end >= filesize || start > end) {
+        return srs_error_new(ERROR_HTTP_REMUX_OFFSET_OVERFLOW, "http mp4 seek %s overflow. size=%" PRId64 ", range=%" PRId64 "-%" PRId64,
+            fullpath.c_str(), filesize, start, end);
+    }
+
+    int64_t left = end - start + 1;
+    w->header()->set_content_length(left);
+    w->header()->set_content_type("video/mp4");
+
+    // Response the content range header, only for range request.
+    if (left < filesize) {
+        std::stringstream content_range;
+        content_range << "bytes " << start << "-" << end << "/" << filesize;
+        w->header()->set("Content-Range", content_range.str());
+        w->write_header(SRS_CONSTS_HTTP_PartialContent);
+    } else {
+        w->write_header(SRS_CONSTS_HTTP_OK);
+    }
+
+    // Write the head, the ftyp, moov and mdat header.
+    if (start < nb_head) {
+        int64_t size = srs_min(left, nb_head - start);
+        if ((err = w->write((char*)head.data() + start, (int)size)) != srs_success) {
+            return srs_error_wrap(err, "write head size=%" PRId64, size);
+        }
+        left -= size;
+    }
+
+    // Write the samples from file.
+    if (left > 0) {
+        fs->seek2(body_start + srs_max(0, start - nb_head));
+        if ((err = copy(w, fs, r, left)) != srs_success) {
+            return srs_error_wrap(err, "read mp4=%s size=%" PRId64, fullpath.c_str(), left);
+        }
+    }
+
+    return err;
+}
+
 srs_error_t SrsVodStream::serve_m3u8_ctx(ISrsHttpResponseWriter * w, ISrsHttpMessage * r, std::string fullpath)
 {
     srs_error_t err = srs_success;
@@ -543,6 +784,16 @@ srs_error_t SrsVodStream::serve_m3u8_ctx(ISrsHttpResponseWriter * w, ISrsHttpMes
         return srs_error_wrap(err, "hls ctx");
     }
 
+    // Serve the m3u8 in memory, if HLS is muxing.
+    if (!served) {
+        SrsHlsPlaylist* playlist = _srs_hls_playlists->fetch(fullpath);
+        if (playlist) {
+            // Copy the playlist, because it might be changed when coroutine switching.
+            string content = playlist->content(), etag = playlist->etag, last_modified = playlist->last_modified;
+            return srs_hls_serve_playlist(w, r, content, etag, last_modified);
+        }
+    }
+
     // Serve by default HLS handler.
     if (!served) {
         return SrsHttpFileServer::serve_m3u8_ctx(w, r, fullpath);
@@ -574,6 +825,68 @@ srs_error_t SrsVodStream::serve_ts_ctx(ISrsHttpResponseWriter * w, ISrsHttpMessa
     return err;
 }
 
+srs_error_t SrsVodStream::serve_m4s_ctx(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, std::string fullpath)
+{
+    srs_error_t err = srs_success;
+
+    SrsDashPartialFragment* fragment = _srs_dash_partials->fetch(fullpath);
+    if (!fragment) {
+        return SrsHttpFileServer::serve_m4s_ctx(w, r, fullpath);
+    }
+
+    // Open the tmp file in writing, we're able to read it even after it's renamed or removed.
+    SrsFileReader* fs = fs_factory->create_file_reader();
+    SrsAutoFree(SrsFileReader, fs);
+
+    if ((err = fs->open(fragment->tmppath)) != srs_success) {
+        return srs_error_wrap(err, "open file %s", fragment->tmppath.c_str());
+    }
+
+    // Never set the content length, to response in chunked encoding.
+    w->header()->set_content_type("video/mp4");
+    w->write_header(SRS_CONSTS_HTTP_OK);
+
+    char* buf = new char[SRS_DASH_PARTIAL_BUFFER_SIZE];
+    SrsAutoFreeA(char, buf);
+
+    int64_t sent = 0;
+    srs_utime_t deadline = srs_update_system_time() + SRS_DASH_PARTIAL_TIMEOUT;
+    while (true) {
+        // If the fragment is completed or disposed, send all bytes of file.
+        fragment = _srs_dash_partials->fetch(fullpath);
+        int64_t available = fragment? fragment->size : fs->filesize();
+
+        while (sent < available) {
+            ssize_t nread = 0;
+            int max_read = (int)srs_min(available - sent, SRS_DASH_PARTIAL_BUFFER_SIZE);
+            if ((err = fs->read(buf, max_read, &nread)) != srs_success) {
+                return srs_error_wrap(err, "read %d bytes", max_read);
+            }
+
+            if ((err = w->write(buf, (int)nread)) != srs_success) {
+                return srs_error_wrap(err, "write %d bytes", (int)nread);
+            }
+
+            sent += nread;
+            deadline = srs_update_system_time() + SRS_DASH_PARTIAL_TIMEOUT;
+        }
+
+        if (!fragment) {
+            break;
+        }
+
+        // Quit if no chunk for a long time, for example, the encoder is stuck.
+        if (srs_update_system_time() > deadline) {
+            return srs_error_new(ERROR_SOCKET_TIMEOUT, "timeout for fragment %s, sent=%" PRId64, fullpath.c_str(), sent);
+        }
+
+        // Wait for the next chunk of this fragment.
+        _srs_dash_partials->wait(fullpath, SRS_DASH_PARTIAL_TIMEOUT);
+    }
+
+    return w->final_request();
+}
+
 SrsHttpStaticServer::SrsHttpStaticServer(SrsServer* svr)
 {
     server = svr;
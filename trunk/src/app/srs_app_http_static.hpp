@@ -11,7 +11,13 @@
 
 #include <srs_app_http_conn.hpp>
 
+#include <list>
+#include <map>
+
+#include <srs_core_performance.hpp>
+
 class ISrsFileReaderFactory;
+class SrsMp4VodIndex;
 
 // HLS virtual connection, build on query string ctx of hls stream.
 class SrsHlsVirtualConn: public ISrsExpire
@@ -54,6 +60,50 @@ private:
     srs_error_t on_timer(srs_utime_t interval);
 };
 
+// Response the m3u8 content with ETag and Last-Modified, or 304 for conditional GET.
+extern srs_error_t srs_hls_serve_playlist(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, const std::string& content, std::string etag, std::string last_modified);
+// The ETag of playlist rebuilt for a HLS session, by the ETag of playlist and the hls_ctx.
+extern std::string srs_hls_playlist_variant_etag(std::string etag, std::string ctx);
+
+// The cached index of MP4 file.
+class SrsMp4IndexCacheEntry
+{
+public:
+    std::string path;
+    // The mtime and size of file, to check whether file changed.
+    int64_t mtime;
+    int64_t size;
+    SrsMp4VodIndex* index;
+public:
+    SrsMp4IndexCacheEntry();
+    virtual ~SrsMp4IndexCacheEntry();
+};
+
+// The LRU cache of MP4 indexes for VOD, keyed by path and validated by the mtime and size of file, so we never
+// parse the moov of hot files for each request.
+class SrsMp4IndexCache
+{
+private:
+    int capacity_;
+    // The most recently used entry is at the front.
+    std::list<SrsMp4IndexCacheEntry*> lru_;
+    std::map<std::string, std::list<SrsMp4IndexCacheEntry*>::iterator> entries_;
+public:
+    SrsMp4IndexCache(int capacity = SRS_PERF_MP4_INDEX_CACHE_SIZE);
+    virtual ~SrsMp4IndexCache();
+public:
+    // Fetch the index of MP4 file, load it by the reader if not cached or file changed.
+    // @remark The index is owned by cache, user should never use it after coroutine switching, because it might
+    //      be evicted by other requests.
+    virtual srs_error_t fetch(std::string path, ISrsFileReaderFactory* factory, SrsMp4VodIndex** pindex);
+    // Get the number of cached indexes.
+    virtual int size();
+private:
+    virtual void erase(std::string path);
+};
+
+extern SrsMp4IndexCache* _srs_mp4_indexes;
+
 // The Vod streaming, like FLV, MP4 or HLS streaming.
 class SrsVodStream : public SrsHttpFileServer
 {
@@ -70,9 +120,14 @@ protected:
     virtual srs_error_t serve_flv_stream(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, std::string fullpath, int64_t offset);
     // Support mp4 with start and offset in query string.
     virtual srs_error_t serve_mp4_stream(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, std::string fullpath, int64_t start, int64_t end);
+    // Support mp4 seek by time, for example, http://server/file.mp4?start=10.5 in seconds, served by a trimmed mp4
+    // which starts from the keyframe, built from the cached index without reading the mdat.
+    virtual srs_error_t serve_mp4_seek(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, std::string fullpath, srs_utime_t time, int64_t start, int64_t end);
     // Support HLS streaming with pseudo session id.
     virtual srs_error_t serve_m3u8_ctx(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, std::string fullpath);
     virtual srs_error_t serve_ts_ctx(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, std::string fullpath);
+    // Support low-latency DASH, to deliver the fragment in writing by chunked encoding.
+    virtual srs_error_t serve_m4s_ctx(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, std::string fullpath);
 };
 
 // The http static server instance,
@@ -12,6 +12,7 @@
 #include <srs_protocol_st.hpp>
 #include <srs_app_utility.hpp>
 #include <srs_app_dvr.hpp>
+#include <srs_app_http_hooks.hpp>
 #include <srs_app_tencentcloud.hpp>
 
 using namespace std;
@@ -181,6 +182,11 @@ srs_error_t SrsHybridServer::initialize()
         return srs_error_wrap(err, "dvr async");
     }
 
+    // Start the async call for notification hooks.
+    if ((err = _srs_hooks_async->start()) != srs_success) {
+        return srs_error_wrap(err, "hooks async");
+    }
+
 #ifdef SRS_APM
     // Initialize TencentCloud CLS object.
     if ((err = _srs_cls->initialize()) != srs_success) {
@@ -81,6 +81,7 @@ SrsUdpListener::SrsUdpListener(ISrsUdpHandler* h)
     label_ = "UDP";
     
     nb_buf = SRS_UDP_MAX_PACKET_SIZE;
+    nn_batch_ = 1;
     buf = new char[nb_buf];
     
     trd = new SrsDummyCoroutine();
@@ -106,6 +107,16 @@ SrsUdpListener* SrsUdpListener::set_endpoint(const std::string& i, int p)
     return this;
 }
 
+SrsUdpListener* SrsUdpListener::set_batch(int n)
+{
+    nn_batch_ = srs_max(1, srs_min(n, SRS_PERF_UDP_RECV_BATCH));
+
+    srs_freepa(buf);
+    buf = new char[nb_buf * nn_batch_];
+
+    return this;
+}
+
 int SrsUdpListener::fd()
 {
     return srs_netfd_fileno(lfd);
@@ -205,16 +216,13 @@ srs_error_t SrsUdpListener::cycle()
             return srs_error_new(ERROR_SOCKET_READ, "udp read, nread=%d", nread);
         }
 
-        // Drop UDP health check packet of Aliyun SLB.
-        //      Healthcheck udp check
-        // @see https://help.aliyun.com/document_detail/27595.html
-        if (nread == 21 && buf[0] == 0x48 && buf[1] == 0x65 && buf[2] == 0x61 && buf[3] == 0x6c
-            && buf[19] == 0x63 && buf[20] == 0x6b) {
-            continue;
+        if ((err = on_packet((const sockaddr*)&from, nb_from, buf, nread)) != srs_success) {
+            return srs_error_wrap(err, "handle packet %d bytes", nread);
         }
 
-        if ((err = handler->on_udp_packet((const sockaddr*)&from, nb_from, buf, nread)) != srs_success) {
-            return srs_error_wrap(err, "handle packet %d bytes", nread);
+        // For a busy port, such as the media of many devices, there are always more packets in kernel.
+        if (nn_batch_ > 1 && (err = consume_batch()) != srs_success) {
+            return srs_error_wrap(err, "consume batch");
         }
         
         if (SrsUdpPacketRecvCycleInterval > 0) {
@@ -225,6 +233,65 @@ srs_error_t SrsUdpListener::cycle()
     return err;
 }
 
+srs_error_t SrsUdpListener::consume_batch()
+{
+    srs_error_t err = srs_success;
+
+#ifdef __linux__
+    mmsghdr msgs[SRS_PERF_UDP_RECV_BATCH];
+    iovec iovs[SRS_PERF_UDP_RECV_BATCH];
+    sockaddr_storage froms[SRS_PERF_UDP_RECV_BATCH];
+
+    memset(msgs, 0, sizeof(msgs));
+    for (int i = 0; i < nn_batch_; i++) {
+        iovs[i].iov_base = buf + i * nb_buf;
+        iovs[i].iov_len = nb_buf;
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_name = &froms[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+    }
+
+    // The fd is non-blocking by ST, so it returns immediately if no packets.
+    int nn = ::recvmmsg(fd(), msgs, nn_batch_, MSG_DONTWAIT, NULL);
+    for (int i = 0; i < nn; i++) {
+        int nread = (int)msgs[i].msg_len;
+        if (nread <= 0) continue;
+
+        char* data = (char*)iovs[i].iov_base;
+        if ((err = on_packet((const sockaddr*)&froms[i], (int)msgs[i].msg_hdr.msg_namelen, data, nread)) != srs_success) {
+            return srs_error_wrap(err, "handle packet %d bytes", nread);
+        }
+    }
+#else
+    for (int i = 0; i < nn_batch_; i++) {
+        sockaddr_storage from;
+        socklen_t nb_from = sizeof(from);
+        int nread = ::recvfrom(fd(), buf, nb_buf, MSG_DONTWAIT, (sockaddr*)&from, &nb_from);
+        if (nread <= 0) break;
+
+        if ((err = on_packet((const sockaddr*)&from, (int)nb_from, buf, nread)) != srs_success) {
+            return srs_error_wrap(err, "handle packet %d bytes", nread);
+        }
+    }
+#endif
+
+    return err;
+}
+
+srs_error_t SrsUdpListener::on_packet(const sockaddr* from, const int fromlen, char* data, int size)
+{
+    // Drop UDP health check packet of Aliyun SLB.
+    //      Healthcheck udp check
+    // @see https://help.aliyun.com/document_detail/27595.html
+    if (size == 21 && data[0] == 0x48 && data[1] == 0x65 && data[2] == 0x61 && data[3] == 0x6c
+        && data[19] == 0x63 && data[20] == 0x6b) {
+        return srs_success;
+    }
+
+    return handler->on_udp_packet(from, fromlen, data, size);
+}
+
 SrsTcpListener::SrsTcpListener(ISrsTcpHandler* h)
 {
     handler = h;
@@ -321,6 +388,88 @@ srs_error_t SrsTcpListener::cycle()
     return err;
 }
 
+SrsUnixListener::SrsUnixListener(ISrsTcpHandler* h)
+{
+    handler = h;
+    lfd = NULL;
+    label_ = "UNIX";
+    trd = new SrsDummyCoroutine();
+}
+
+SrsUnixListener::~SrsUnixListener()
+{
+    srs_freep(trd);
+    srs_close_stfd(lfd);
+}
+
+SrsUnixListener* SrsUnixListener::set_label(const std::string& label)
+{
+    label_ = label;
+    return this;
+}
+
+SrsUnixListener* SrsUnixListener::set_path(const std::string& path)
+{
+    path_ = path;
+    return this;
+}
+
+srs_error_t SrsUnixListener::listen()
+{
+    srs_error_t err = srs_success;
+
+    // Ignore if not configured.
+    if (path_.empty()) return err;
+
+    srs_close_stfd(lfd);
+    if ((err = srs_unix_listen(path_, &lfd)) != srs_success) {
+        return srs_error_wrap(err, "listen at %s", path_.c_str());
+    }
+
+    srs_freep(trd);
+    trd = new SrsSTCoroutine("unix", this);
+    if ((err = trd->start()) != srs_success) {
+        return srs_error_wrap(err, "start coroutine");
+    }
+
+    int fd = srs_netfd_fileno(lfd);
+    srs_trace("%s listen at unix://%s, fd=%d", label_.c_str(), path_.c_str(), fd);
+
+    return err;
+}
+
+void SrsUnixListener::close()
+{
+    trd->stop();
+    srs_close_stfd(lfd);
+}
+
+srs_error_t SrsUnixListener::cycle()
+{
+    srs_error_t err = srs_success;
+
+    while (true) {
+        if ((err = trd->pull()) != srs_success) {
+            return srs_error_wrap(err, "unix listener");
+        }
+
+        srs_netfd_t fd = srs_accept(lfd, NULL, NULL, SRS_UTIME_NO_TIMEOUT);
+        if(fd == NULL){
+            return srs_error_new(ERROR_SOCKET_ACCEPT, "accept at fd=%d", srs_netfd_fileno(lfd));
+        }
+
+        if ((err = srs_fd_closeexec(srs_netfd_fileno(fd))) != srs_success) {
+            return srs_error_wrap(err, "set closeexec");
+        }
+
+        if ((err = handler->on_tcp_client(this, fd)) != srs_success) {
+            return srs_error_wrap(err, "handle fd=%d", srs_netfd_fileno(fd));
+        }
+    }
+
+    return err;
+}
+
 SrsMultipleTcpListeners::SrsMultipleTcpListeners(ISrsTcpHandler* h)
 {
     handler_ = h;
@@ -398,7 +547,6 @@ SrsUdpMuxSocket::SrsUdpMuxSocket(srs_netfd_t fd)
     fromlen = 0;
     peer_port = 0;
 
-    fast_id_ = 0;
     address_changed_ = false;
     cache_buffer_ = new SrsBuffer(buf, nb_buf);
 }
@@ -429,10 +577,16 @@ int SrsUdpMuxSocket::recvfrom(srs_utime_t timeout)
         return 0;
     }
 
-    // Parse address from cache.
+    // Pack the address to fast id, for both IPv4 and IPv6.
     if (from.ss_family == AF_INET) {
         sockaddr_in* addr = (sockaddr_in*)&from;
-        fast_id_ = uint64_t(addr->sin_port)<<48 | uint64_t(addr->sin_addr.s_addr);
+        fast_id_ = SrsResourceFastKey(uint64_t(addr->sin_port)<<48 | uint64_t(addr->sin_addr.s_addr));
+    } else if (from.ss_family == AF_INET6) {
+        sockaddr_in6* addr = (sockaddr_in6*)&from;
+        fast_id_.id = uint64_t(addr->sin6_port)<<16 | uint64_t(AF_INET6);
+        memcpy(fast_id_.addr, &addr->sin6_addr, sizeof(fast_id_.addr));
+    } else {
+        fast_id_ = SrsResourceFastKey();
     }
 
     // We will regenerate the peer_ip, peer_port and peer_id.
@@ -558,7 +712,7 @@ std::string SrsUdpMuxSocket::peer_id()
     return peer_id_;
 }
 
-uint64_t SrsUdpMuxSocket::fast_id()
+const SrsResourceFastKey& SrsUdpMuxSocket::fast_id()
 {
     ++_srs_pps_fast_addrs->sugar;
     return fast_id_;
@@ -17,6 +17,7 @@
 #include <vector>
 
 #include <srs_app_st.hpp>
+#include <srs_app_conn.hpp>
 
 struct sockaddr;
 
@@ -80,8 +81,11 @@ protected:
     srs_netfd_t lfd;
     SrsCoroutine* trd;
 protected:
+    // The buffer for a batch of packets, each packet is nb_buf bytes.
     char* buf;
     int nb_buf;
+    // The max number of packets received in a batch, 1 to disable batch.
+    int nn_batch_;
 protected:
     ISrsUdpHandler* handler;
     std::string ip;
@@ -92,6 +96,8 @@ public:
 public:
     SrsUdpListener* set_label(const std::string& label);
     SrsUdpListener* set_endpoint(const std::string& i, int p);
+    // Receive at most n packets in a batch, only for the busy port such as the media of many devices.
+    SrsUdpListener* set_batch(int n);
 private:
     virtual int fd();
     virtual srs_netfd_t stfd();
@@ -103,6 +109,10 @@ public:
 // Interface ISrsReusableThreadHandler.
 public:
     virtual srs_error_t cycle();
+private:
+    // Read the packets already received by kernel, without blocking.
+    srs_error_t consume_batch();
+    srs_error_t on_packet(const sockaddr* from, const int fromlen, char* data, int size);
 };
 
 // Bind and listen tcp port, use handler to process the client.
@@ -132,6 +142,30 @@ public:
     virtual srs_error_t cycle();
 };
 
+// Bind and listen unix domain socket, use handler to process the client from the same box.
+class SrsUnixListener : public ISrsCoroutineHandler, public ISrsListener
+{
+private:
+    std::string label_;
+    srs_netfd_t lfd;
+    SrsCoroutine* trd;
+private:
+    ISrsTcpHandler* handler;
+    std::string path_;
+public:
+    SrsUnixListener(ISrsTcpHandler* h);
+    virtual ~SrsUnixListener();
+public:
+    SrsUnixListener* set_label(const std::string& label);
+    SrsUnixListener* set_path(const std::string& path);
+public:
+    virtual srs_error_t listen();
+    void close();
+// Interface ISrsReusableThreadHandler.
+public:
+    virtual srs_error_t cycle();
+};
+
 // Bind and listen tcp port, use handler to process the client.
 class SrsMultipleTcpListeners : public ISrsListener, public ISrsTcpHandler
 {
@@ -175,8 +209,8 @@ private:
     std::string peer_id_;
     // If the address changed, we should generate the peer_id.
     bool address_changed_;
-    // For IPv4 client, we use 8 bytes int id to find it fastly.
-    uint64_t fast_id_;
+    // The packed address of IPv4 or IPv6 client, to find it fastly without the peer id string.
+    SrsResourceFastKey fast_id_;
 public:
     SrsUdpMuxSocket(srs_netfd_t fd);
     virtual ~SrsUdpMuxSocket();
@@ -191,7 +225,8 @@ public:
     std::string get_peer_ip() const;
     int get_peer_port() const;
     std::string peer_id();
-    uint64_t fast_id();
+    // Get the packed address of client, empty if not IPv4 or IPv6.
+    const SrsResourceFastKey& fast_id();
     SrsBuffer* buffer();
     SrsUdpMuxSocket* copy_sendonly();
 };
@@ -650,7 +650,7 @@ srs_error_t SrsMpegtsOverUdp::connect()
     
     srs_utime_t cto = SRS_CONSTS_RTMP_TIMEOUT;
     srs_utime_t sto = SRS_CONSTS_RTMP_PULSE;
-    sdk = new SrsSimpleRtmpClient(output, cto, sto);
+    sdk = srs_rtmp_publisher_create(output, cto, sto);
     
     if ((err = sdk->connect()) != srs_success) {
         close();
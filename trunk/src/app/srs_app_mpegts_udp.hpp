@@ -25,7 +25,7 @@ class SrsSharedPtrMessage;
 class SrsRawAacStream;
 struct SrsRawAacStreamCodec;
 class SrsPithyPrint;
-class SrsSimpleRtmpClient;
+class ISrsRtmpPublisher;
 class SrsMpegtsOverUdp;
 
 #include <srs_app_st.hpp>
@@ -73,7 +73,7 @@ private:
     SrsSimpleStream* buffer;
     std::string output;
 private:
-    SrsSimpleRtmpClient* sdk;
+    ISrsRtmpPublisher* sdk;
 private:
     SrsRawH264Stream* avc;
     std::string h264_sps;
@@ -139,16 +139,19 @@ srs_error_t SrsGoApiRtcPlay::do_serve_http(ISrsHttpResponseWriter* w, ISrsHttpMe
     // For client to specifies whether encrypt by SRTP.
     string srtp = r->query_get("encrypt");
     string dtls = r->query_get("dtls");
+    // For client to specifies the simulcast layer by RID.
+    string layer = r->query_get("layer");
 
     srs_trace(
-            "RTC play %s, api=%s, tid=%s, clientip=%s, app=%s, stream=%s, offer=%dB, eip=%s, codec=%s, srtp=%s, dtls=%s",
+            "RTC play %s, api=%s, tid=%s, clientip=%s, app=%s, stream=%s, offer=%dB, eip=%s, codec=%s, srtp=%s, dtls=%s, layer=%s",
             streamurl.c_str(), api.c_str(), tid.c_str(), clientip.c_str(), ruc.req_->app.c_str(),
             ruc.req_->stream.c_str(), remote_sdp_str.length(),
-            eip.c_str(), codec.c_str(), srtp.c_str(), dtls.c_str()
+            eip.c_str(), codec.c_str(), srtp.c_str(), dtls.c_str(), layer.c_str()
     );
 
     ruc.eip_ = eip;
     ruc.codec_ = codec;
+    ruc.layer_ = layer;
     ruc.publish_ = false;
     ruc.dtls_ = (dtls != "false");
 
@@ -627,6 +630,7 @@ srs_error_t SrsGoApiRtcWhip::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessa
     if (action.empty()) {
         action = "publish";
     }
+    string layer = r->query_get("layer");
     if (srs_string_ends_with(r->path(), "/whip-play/")) {
         action = "play";
     }
@@ -652,6 +656,7 @@ srs_error_t SrsGoApiRtcWhip::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMessa
 
     ruc.eip_ = eip;
     ruc.codec_ = codec;
+    ruc.layer_ = layer;
     ruc.publish_ = (action == "publish");
     ruc.dtls_ = ruc.srtp_ = true;
 
@@ -48,6 +48,8 @@ using namespace std;
 #include <srs_protocol_kbps.hpp>
 #include <srs_kernel_kbps.hpp>
 #include <srs_app_rtc_network.hpp>
+#include <srs_app_rtc_pacer.hpp>
+#include <srs_core_performance.hpp>
 
 SrsPps* _srs_pps_sstuns = NULL;
 SrsPps* _srs_pps_srtcps = NULL;
@@ -172,7 +174,10 @@ srs_error_t SrsSecurityTransport::srtp_initialize()
         return err;
     }
     
-    if ((err = srtp_->initialize(recv_key, send_key)) != srs_success) {
+    SrsSrtpProfile profile = dtls_->get_srtp_profile();
+    srs_trace("RTC: SRTP profile %s", profile == SrsSrtpProfileAeadAes128Gcm ? "AEAD_AES_128_GCM" : "AES128_CM_SHA1_80");
+
+    if ((err = srtp_->initialize(recv_key, send_key, profile)) != srs_success) {
         return srs_error_wrap(err, "srtp init");
     }
 
@@ -184,6 +189,11 @@ srs_error_t SrsSecurityTransport::protect_rtp(void* packet, int* nb_cipher)
     return srtp_->protect_rtp(packet, nb_cipher);
 }
 
+srs_error_t SrsSecurityTransport::protect_rtps(void** packets, int* nb_ciphers, int nn_packets)
+{
+    return srtp_->protect_rtps(packets, nb_ciphers, nn_packets);
+}
+
 srs_error_t SrsSecurityTransport::protect_rtcp(void* packet, int* nb_cipher)
 {
     return srtp_->protect_rtcp(packet, nb_cipher);
@@ -212,6 +222,11 @@ srs_error_t SrsSemiSecurityTransport::protect_rtp(void* packet, int* nb_cipher)
     return srs_success;
 }
 
+srs_error_t SrsSemiSecurityTransport::protect_rtps(void** packets, int* nb_ciphers, int nn_packets)
+{
+    return srs_success;
+}
+
 srs_error_t SrsSemiSecurityTransport::protect_rtcp(void* packet, int* nb_cipher)
 {
     return srs_success;
@@ -267,6 +282,11 @@ srs_error_t SrsPlaintextTransport::protect_rtp(void* packet, int* nb_cipher)
     return srs_success;
 }
 
+srs_error_t SrsPlaintextTransport::protect_rtps(void** packets, int* nb_ciphers, int nn_packets)
+{
+    return srs_success;
+}
+
 srs_error_t SrsPlaintextTransport::protect_rtcp(void* packet, int* nb_cipher)
 {
     return srs_success;
@@ -642,6 +662,12 @@ srs_error_t SrsRtcPlayStream::cycle()
 
     while (true) {
         if ((err = trd_->pull()) != srs_success) {
+            // Send-out the pending batch of packets, before quit.
+            srs_error_t r0 = session_->flush_packets();
+            if (r0 != srs_success) {
+                srs_warn("play flush packets when quit, err: %s", srs_error_desc(r0).c_str());
+                srs_freep(r0);
+            }
             return srs_error_wrap(err, "rtc sender thread");
         }
 
@@ -649,14 +675,29 @@ srs_error_t SrsRtcPlayStream::cycle()
         SrsRtpPacket* pkt = NULL;
         consumer->dump_packet(&pkt);
         if (!pkt) {
+            // Send-out the batch of packets, before waiting for packets.
+            if ((err = session_->flush_packets()) != srs_success) {
+                uint32_t nn = 0;
+                if (epp->can_print(err, &nn)) {
+                    srs_warn("play flush packets, nn=%u/%u, err: %s", epp->nn_count, nn, srs_error_desc(err).c_str());
+                }
+                srs_freep(err);
+            }
+
             // TODO: FIXME: We should check the quit event.
             consumer->wait(mw_msgs);
             continue;
         }
 
-        // Send-out the RTP packet and do cleanup
+        // Wait for pacer, to avoid bursts of packets, such as keyframe.
+        session_->pace_packet((int)pkt->nb_bytes());
+
+        // Send-out the RTP packet and do cleanup, in batch to protect them by SRTP together.
         // @remark Note that the pkt might be set to NULL.
-        if ((err = send_packet(pkt)) != srs_success) {
+        session_->set_batching(true);
+        err = send_packet(pkt);
+        session_->set_batching(false);
+        if (err != srs_success) {
             uint32_t nn = 0;
             if (epp->can_print(err, &nn)) {
                 srs_warn("play send packets=%u, nn=%u/%u, err: %s", 1, epp->nn_count, nn, srs_error_desc(err).c_str());
@@ -714,6 +755,21 @@ srs_error_t SrsRtcPlayStream::send_packet(SrsRtpPacket*& pkt)
         }
     }
 
+    // For simulcast, find the track by layer, and only forward the selected layer.
+    if (!track && !pkt->is_audio()) {
+        SrsRtcVideoSendTrack* simulcast = fetch_simulcast_track(ssrc);
+
+        uint32_t pli_ssrc = 0;
+        if (simulcast && !simulcast->on_layer_packet(pkt, srs_get_system_time(), &pli_ssrc)) {
+            if (pli_ssrc) {
+                pli_worker_->request_keyframe(pli_ssrc, cid_);
+            }
+            return err;
+        }
+
+        track = simulcast;
+    }
+
     // Ignore if no track found.
     if (!track) {
         srs_warn("RTC: Drop for ssrc %u not found", ssrc);
@@ -736,6 +792,51 @@ srs_error_t SrsRtcPlayStream::send_packet(SrsRtpPacket*& pkt)
     return err;
 }
 
+SrsRtcVideoSendTrack* SrsRtcPlayStream::fetch_simulcast_track(uint32_t ssrc)
+{
+    map<uint32_t, SrsRtcVideoSendTrack*>::iterator it = simulcast_tracks_.find(ssrc);
+    if (it != simulcast_tracks_.end()) {
+        return it->second;
+    }
+
+    // The SSRC of layer is bound when publisher got the RTP packet with RID, so we find it in source.
+    SrsRtcTrackDescription* layer = source_->find_simulcast_layer(ssrc);
+    if (!layer) {
+        return NULL;
+    }
+
+    for (map<uint32_t, SrsRtcVideoSendTrack*>::iterator it = video_tracks_.begin(); it != video_tracks_.end(); ++it) {
+        SrsRtcVideoSendTrack* track = it->second;
+        if (track->is_simulcast() && track->get_track_id() == layer->id_) {
+            track->add_layer(ssrc, layer->rid_);
+            simulcast_tracks_[ssrc] = track;
+            return track;
+        }
+    }
+
+    return NULL;
+}
+
+void SrsRtcPlayStream::set_simulcast_layer(std::string rid)
+{
+    for (map<uint32_t, SrsRtcVideoSendTrack*>::iterator it = video_tracks_.begin(); it != video_tracks_.end(); ++it) {
+        SrsRtcVideoSendTrack* track = it->second;
+        if (track->is_simulcast()) {
+            track->set_layer(rid);
+        }
+    }
+}
+
+void SrsRtcPlayStream::on_bandwidth(int64_t bps)
+{
+    for (map<uint32_t, SrsRtcVideoSendTrack*>::iterator it = video_tracks_.begin(); it != video_tracks_.end(); ++it) {
+        SrsRtcVideoSendTrack* track = it->second;
+        if (track->is_simulcast()) {
+            track->on_bandwidth(bps);
+        }
+    }
+}
+
 void SrsRtcPlayStream::set_all_tracks_status(bool status)
 {
     std::ostringstream merged_log;
@@ -893,6 +994,10 @@ uint32_t SrsRtcPlayStream::get_video_publish_ssrc(uint32_t play_ssrc)
     std::map<uint32_t, SrsRtcVideoSendTrack*>::iterator it;
     for (it = video_tracks_.begin(); it != video_tracks_.end(); ++it) {
         if (it->second->has_ssrc(play_ssrc)) {
+            // For simulcast, request keyframe of the current layer.
+            if (it->second->is_simulcast()) {
+                return it->second->get_layer_ssrc();
+            }
             return it->first;
         }
     }
@@ -1146,10 +1251,22 @@ srs_error_t SrsRtcPublishStream::initialize(SrsRequest* r, SrsRtcSourceDescripti
     }
     if (twcc_id > 0) {
         twcc_id_ = twcc_id;
-        extension_types_.register_by_uri(twcc_id_, kTWCCExt);
         rtcp_twcc_.set_media_ssrc(media_ssrc);
     }
 
+    // The extension layout is built by the extmaps of each track, and the TWCC is for all tracks of transport, so
+    // register it to the track without TWCC, for example, the audio track of h5demo, if the id is not used.
+    if (twcc_id > 0) {
+        std::vector<SrsRtcRecvTrack*> tracks(video_tracks_.begin(), video_tracks_.end());
+        tracks.insert(tracks.end(), audio_tracks_.begin(), audio_tracks_.end());
+        for (int i = 0; i < (int)tracks.size(); ++i) {
+            SrsRtpExtensionTypes* types = tracks.at(i)->extension_types();
+            if (types->get_type(twcc_id) == SrsRtpExtensionTypes::kInvalidType) {
+                types->register_by_uri(twcc_id, kTWCCExt);
+            }
+        }
+    }
+
     nack_enabled_ = _srs_config->get_rtc_nack_enabled(req_->vhost);
     nack_no_copy_ = _srs_config->get_rtc_nack_no_copy(req_->vhost);
     pt_to_drop_ = (uint16_t)_srs_config->get_rtc_drop_for_pt(req_->vhost);
@@ -1386,8 +1503,16 @@ srs_error_t SrsRtcPublishStream::do_on_rtp_plaintext(SrsRtpPacket*& pkt, SrsBuff
 {
     srs_error_t err = srs_success;
 
+    // Find the track by SSRC before decoding, because the extmaps are negotiated for each track.
+    uint32_t ssrc = srs_rtp_fast_parse_ssrc(buf->data(), buf->size());
+    SrsRtcAudioRecvTrack* audio_track = get_audio_track(ssrc);
+    SrsRtcVideoRecvTrack* video_track = get_video_track(ssrc);
+    if (!audio_track && !video_track) {
+        return srs_error_new(ERROR_RTC_RTP, "unknown ssrc=%u", ssrc);
+    }
+
     pkt->set_decode_handler(this);
-    pkt->set_extension_types(&extension_types_);
+    pkt->set_extension_types(audio_track ? audio_track->extension_types() : video_track->extension_types());
     pkt->header.ignore_padding(false);
 
     if ((err = pkt->decode(buf)) != srs_success) {
@@ -1395,9 +1520,6 @@ srs_error_t SrsRtcPublishStream::do_on_rtp_plaintext(SrsRtpPacket*& pkt, SrsBuff
     }
 
     // For source to consume packet.
-    uint32_t ssrc = pkt->header.get_ssrc();
-    SrsRtcAudioRecvTrack* audio_track = get_audio_track(ssrc);
-    SrsRtcVideoRecvTrack* video_track = get_video_track(ssrc);
     if (audio_track) {
         pkt->frame_type = SrsFrameTypeAudio;
         if ((err = audio_track->on_rtp(source, pkt)) != srs_success) {
@@ -1634,6 +1756,19 @@ srs_error_t SrsRtcPublishStream::do_request_keyframe(uint32_t ssrc, SrsContextId
     return err;
 }
 
+bool SrsRtcPublishStream::bind_simulcast_ssrc(char* buf, int size, uint32_t ssrc)
+{
+    for (int i = 0; i < (int)video_tracks_.size(); ++i) {
+        SrsRtcVideoRecvTrack* track = video_tracks_.at(i);
+        if (track->bind_simulcast_ssrc(buf, size, ssrc)) {
+            source->bind_simulcast_layer(track->get_track_id(), track->get_rid(), ssrc);
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void SrsRtcPublishStream::simulate_nack_drop(int nn)
 {
     nn_simulate_nack_drop = nn;
@@ -1748,13 +1883,22 @@ SrsRtcConnection::SrsRtcConnection(SrsRtcServer* s, const SrsContextId& cid)
     cache_iov_ = new iovec();
     cache_iov_->iov_base = new char[kRtpPacketSize];
     cache_iov_->iov_len = kRtpPacketSize;
-    cache_buffer_ = new SrsBuffer((char*)cache_iov_->iov_base, kRtpPacketSize);
+
+    batching_ = false;
+    flushing_ = false;
+    batch_iovs_ = NULL;
+    batch_twcc_sns_ = NULL;
+    nn_batch_ = 0;
 
     last_stun_time = 0;
     session_timeout = 0;
     disposing_ = false;
 
     twcc_id_ = 0;
+    twcc_sn_ = 0;
+    bwe_ = new SrsRtcBandwidthEstimator();
+    pacer_ = new SrsRtcPacer();
+    pacer_enabled_ = false;
     nn_simulate_player_nack_drop = 0;
     pli_epp = new SrsErrorPithyPrint();
 
@@ -1794,10 +1938,18 @@ SrsRtcConnection::~SrsRtcConnection()
         srs_freepa(iov_base);
         srs_freep(cache_iov_);
     }
-    srs_freep(cache_buffer_);
+
+    for (int i = 0; batch_iovs_ && i < SRS_PERF_RTC_SEND_BATCH; i++) {
+        char* iov_base = (char*)batch_iovs_[i].iov_base;
+        srs_freepa(iov_base);
+    }
+    srs_freepa(batch_iovs_);
+    srs_freepa(batch_twcc_sns_);
 
     srs_freep(req_);
     srs_freep(pli_epp);
+    srs_freep(bwe_);
+    srs_freep(pacer_);
 }
 
 void SrsRtcConnection::on_before_dispose(ISrsResource* c)
@@ -1967,6 +2119,10 @@ srs_error_t SrsRtcConnection::add_player(SrsRtcUserConfig* ruc, SrsSdp& local_sd
         return srs_error_wrap(err, "create player");
     }
 
+    if (!ruc->layer_.empty()) {
+        players_[req->get_stream_url()]->set_simulcast_layer(ruc->layer_);
+    }
+
     return err;
 }
 
@@ -2030,7 +2186,8 @@ srs_error_t SrsRtcConnection::dispatch_rtcp(SrsRtcpCommon* rtcp)
 
     // For TWCC packet.
     if (SrsRtcpType_rtpfb == rtcp->type() && 15 == rtcp->get_rc()) {
-        return on_rtcp_feedback_twcc(rtcp->data(), rtcp->size());
+        SrsRtcpTWCC* twcc = dynamic_cast<SrsRtcpTWCC*>(rtcp);
+        return on_rtcp_feedback_twcc(twcc);
     }
 
     // For REMB packet.
@@ -2107,17 +2264,48 @@ srs_error_t SrsRtcConnection::dispatch_rtcp(SrsRtcpCommon* rtcp)
     return err;
 }
 
-srs_error_t SrsRtcConnection::on_rtcp_feedback_twcc(char* data, int nb_data)
+srs_error_t SrsRtcConnection::on_rtcp_feedback_twcc(SrsRtcpTWCC* rtcp)
 {
-    return srs_success;
+    srs_error_t err = srs_success;
+
+    // Ignore if not player, or TWCC is not enabled for player.
+    if (!twcc_id_ || !rtcp) {
+        return err;
+    }
+
+    if ((err = bwe_->on_twcc_feedback(rtcp, srs_get_system_time())) != srs_success) {
+        return srs_error_wrap(err, "twcc feedback");
+    }
+
+    on_bwe_update();
+
+    return err;
 }
 
 srs_error_t SrsRtcConnection::on_rtcp_feedback_remb(SrsRtcpPsfbCommon *rtcp)
 {
-    //ignore REMB
+    SrsRtcpRemb* remb = dynamic_cast<SrsRtcpRemb*>(rtcp);
+    if (!remb || !remb->is_remb()) {
+        return srs_success;
+    }
+
+    bwe_->on_remb(remb->get_bitrate());
+    on_bwe_update();
+
     return srs_success;
 }
 
+void SrsRtcConnection::on_bwe_update()
+{
+    // The bitrate of players is the same, because all players share the same transport.
+    SrsStatistic* stat = SrsStatistic::instance();
+    for (map<string, SrsRtcPlayStream*>::iterator it = players_.begin(); it != players_.end(); ++it) {
+        SrsRtcPlayStream* player = it->second;
+        player->on_bandwidth(bwe_->bitrate());
+        stat->on_client_bwe(player->context_id().c_str(), (int)(bwe_->bitrate() / 1000), (int)(pacer_->rate() / 1000), bwe_->loss());
+    }
+}
+
 srs_error_t SrsRtcConnection::on_rtp_cipher(char* data, int nb_data)
 {
     srs_error_t err = srs_success;
@@ -2158,13 +2346,22 @@ srs_error_t SrsRtcConnection::find_publisher(char* buf, int size, SrsRtcPublishS
     }
 
     map<uint32_t, SrsRtcPublishStream*>::iterator it = publishers_ssrc_map_.find(ssrc);
-    if(it == publishers_ssrc_map_.end()) {
-        return srs_error_new(ERROR_RTC_NO_PUBLISHER, "no publisher for ssrc:%u", ssrc);
+    if(it != publishers_ssrc_map_.end()) {
+        *ppublisher = it->second;
+        return err;
     }
 
-    *ppublisher = it->second;
+    // For simulcast, bind the unknown SSRC to layer by RID.
+    for (map<string, SrsRtcPublishStream*>::iterator it = publishers_.begin(); it != publishers_.end(); ++it) {
+        SrsRtcPublishStream* publisher = it->second;
+        if (publisher->bind_simulcast_ssrc(buf, size, ssrc)) {
+            publishers_ssrc_map_[ssrc] = publisher;
+            *ppublisher = publisher;
+            return err;
+        }
+    }
 
-    return err;
+    return srs_error_new(ERROR_RTC_NO_PUBLISHER, "no publisher for ssrc:%u", ssrc);
 }
 
 srs_error_t SrsRtcConnection::on_dtls_handshake_done()
@@ -2417,21 +2614,148 @@ void SrsRtcConnection::simulate_player_drop_packet(SrsRtpHeader* h, int nn_bytes
     nn_simulate_player_nack_drop--;
 }
 
+void SrsRtcConnection::pace_packet(int nb_bytes)
+{
+    srs_error_t err = srs_success;
+
+    if (!pacer_enabled_) {
+        return;
+    }
+
+    // Never pace under the bitrate we're sending, because we can't change the bitrate of stream, so the pacer
+    // only smooths the bursts, for example, keyframe.
+    int64_t bitrate = srs_max(bwe_->bitrate(), bwe_->sent_bitrate());
+    pacer_->set_rate((int64_t)(bitrate * SRS_PERF_RTC_PACING_FACTOR));
+
+    while (true) {
+        srs_utime_t delay = pacer_->on_packet(nb_bytes, srs_update_system_time());
+        if (!delay) {
+            break;
+        }
+
+        // Never hold the batch of packets when waiting for pacer.
+        if ((err = flush_packets()) != srs_success) {
+            srs_warn("RTC: flush packets err %s", srs_error_desc(err).c_str());
+            srs_freep(err);
+        }
+
+        srs_usleep(delay);
+    }
+}
+
+void SrsRtcConnection::set_batching(bool v)
+{
+    batching_ = v;
+}
+
+srs_error_t SrsRtcConnection::flush_packets()
+{
+    srs_error_t err = srs_success;
+
+    if (!nn_batch_) {
+        return err;
+    }
+
+    int nn_packets = nn_batch_;
+    nn_batch_ = 0;
+
+    // Cipher all RTP packets to SRTP packets, by the same SRTP context.
+    void* packets[SRS_PERF_RTC_SEND_BATCH];
+    int nb_ciphers[SRS_PERF_RTC_SEND_BATCH];
+    for (int i = 0; i < nn_packets; i++) {
+        packets[i] = batch_iovs_[i].iov_base;
+        nb_ciphers[i] = (int)batch_iovs_[i].iov_len;
+    }
+
+    // The packets failed to protect are set to 0 bytes, we skip them and send the others.
+    err = networks_->available()->protect_rtps(packets, nb_ciphers, nn_packets);
+
+    // The write might switch coroutine, so the packets from other coroutines are sent directly.
+    flushing_ = true;
+
+    for (int i = 0; i < nn_packets; i++) {
+        if (nb_ciphers[i] <= 0) {
+            continue;
+        }
+
+        iovec* iov = &batch_iovs_[i];
+        iov->iov_len = (size_t)nb_ciphers[i];
+
+        // Record the packet for TWCC feedback.
+        if (twcc_id_) {
+            bwe_->on_packet_sent(batch_twcc_sns_[i], (int)iov->iov_len, srs_get_system_time());
+        }
+
+        ++_srs_pps_srtps->sugar;
+
+        srs_error_t r0 = networks_->available()->write(iov->iov_base, iov->iov_len, NULL);
+        if (r0 != srs_success) {
+            srs_warn("RTC: Write %d bytes err %s", iov->iov_len, srs_error_desc(r0).c_str());
+            srs_freep(r0);
+        }
+    }
+
+    flushing_ = false;
+
+    if (err != srs_success) {
+        return srs_error_wrap(err, "srtp protect %d packets", nn_packets);
+    }
+
+    return err;
+}
+
 srs_error_t SrsRtcConnection::do_send_packet(SrsRtpPacket* pkt)
 {
     srs_error_t err = srs_success;
 
-    // For this message, select the first iovec.
-    iovec* iov = cache_iov_;
-    iov->iov_len = kRtpPacketSize;
-    cache_buffer_->skip(-1 * cache_buffer_->pos());
+    // Append to the batch for player, or send it directly, for example, the NACK response.
+    bool batch = batching_ && !flushing_;
+    if (batch && !batch_iovs_) {
+        batch_iovs_ = new iovec[SRS_PERF_RTC_SEND_BATCH];
+        for (int i = 0; i < SRS_PERF_RTC_SEND_BATCH; i++) {
+            batch_iovs_[i].iov_base = new char[kRtpPacketSize];
+        }
+        batch_twcc_sns_ = new uint16_t[SRS_PERF_RTC_SEND_BATCH];
+    }
+
+    // For this message, select the first iovec, or the next one in batch.
+    iovec* iov = batch ? &batch_iovs_[nn_batch_] : cache_iov_;
+    SrsBuffer buf((char*)iov->iov_base, kRtpPacketSize);
+
+    // Set the transport-wide sequence number, for TWCC feedback of player.
+    if (twcc_id_) {
+        pkt->header.set_twcc_sequence_number(twcc_id_, ++twcc_sn_);
+    }
 
     // Marshal packet to bytes in iovec.
     if (true) {
-        if ((err = pkt->encode(cache_buffer_)) != srs_success) {
+        if ((err = pkt->encode(&buf)) != srs_success) {
             return srs_error_wrap(err, "encode packet");
         }
-        iov->iov_len = cache_buffer_->pos();
+        iov->iov_len = buf.pos();
+    }
+
+    // For NACK simulator, drop packet. The dropped packet is recorded, so it's lost for estimator.
+    if (nn_simulate_player_nack_drop) {
+        if (twcc_id_) {
+            bwe_->on_packet_sent(twcc_sn_, (int)iov->iov_len, srs_get_system_time());
+        }
+        simulate_player_drop_packet(&pkt->header, (int)iov->iov_len);
+        iov->iov_len = 0;
+        return err;
+    }
+
+    // Detail log, should disable it in release version.
+    srs_info("RTC: SEND PT=%u, SSRC=%#x, SEQ=%u, Time=%u, %u/%u bytes", pkt->header.get_payload_type(), pkt->header.get_ssrc(),
+        pkt->header.get_sequence(), pkt->header.get_timestamp(), pkt->nb_bytes(), iov->iov_len);
+
+    // Send the batch when it's full.
+    if (batch) {
+        batch_twcc_sns_[nn_batch_++] = twcc_sn_;
+        if (nn_batch_ >= SRS_PERF_RTC_SEND_BATCH) {
+            return flush_packets();
+        }
+        return err;
     }
 
     // Cipher RTP to SRTP packet.
@@ -2443,11 +2767,9 @@ srs_error_t SrsRtcConnection::do_send_packet(SrsRtpPacket* pkt)
         iov->iov_len = (size_t)nn_encrypt;
     }
 
-    // For NACK simulator, drop packet.
-    if (nn_simulate_player_nack_drop) {
-        simulate_player_drop_packet(&pkt->header, (int)iov->iov_len);
-        iov->iov_len = 0;
-        return err;
+    // Record the packet for TWCC feedback.
+    if (twcc_id_) {
+        bwe_->on_packet_sent(twcc_sn_, (int)iov->iov_len, srs_get_system_time());
     }
 
     ++_srs_pps_srtps->sugar;
@@ -2458,10 +2780,6 @@ srs_error_t SrsRtcConnection::do_send_packet(SrsRtpPacket* pkt)
         return err;
     }
 
-    // Detail log, should disable it in release version.
-    srs_info("RTC: SEND PT=%u, SSRC=%#x, SEQ=%u, Time=%u, %u/%u bytes", pkt->header.get_payload_type(), pkt->header.get_ssrc(),
-        pkt->header.get_sequence(), pkt->header.get_timestamp(), pkt->nb_bytes(), iov->iov_len);
-
     return err;
 }
 
@@ -2599,6 +2917,16 @@ srs_error_t SrsRtcConnection::negotiate_publish_capability(SrsRtcUserConfig* ruc
             track_desc->add_rtp_extension_desc(remote_twcc_id, kTWCCExt);
         }
 
+        // Accept the audio-level, which is decoded by the extension layout of publisher.
+        if (remote_media_desc.is_audio()) {
+            map<int, string> extmaps = remote_media_desc.get_extmaps();
+            for(map<int, string>::iterator it = extmaps.begin(); it != extmaps.end(); ++it) {
+                if (it->second == kAudioLevelUri) {
+                    track_desc->add_rtp_extension_desc(it->first, it->second);
+                }
+            }
+        }
+
         if (remote_media_desc.is_audio()) {
             // Update the ruc, which is about user specified configuration.
             ruc->audio_before_video_ = !nn_any_video_parsed;
@@ -2812,6 +3140,42 @@ srs_error_t SrsRtcConnection::negotiate_publish_capability(SrsRtcUserConfig* ruc
         track_desc->create_auxiliary_payload(remote_media_desc.find_media_with_encoding_name("rtx"));
         track_desc->create_auxiliary_payload(remote_media_desc.find_media_with_encoding_name("ulpfec"));
 
+        // For simulcast by RID, there is no SSRC in SDP, so we create a track for each layer, which shares the same
+        // track id, and bind the SSRC when got the RTP packet with RID, see https://www.rfc-editor.org/rfc/rfc8853
+        if (remote_media_desc.is_video() && remote_media_desc.simulcast_direction_ == "send") {
+            int remote_rid_id = 0, remote_mid_id = 0;
+            map<int, string> extmaps = remote_media_desc.get_extmaps();
+            for(map<int, string>::iterator it = extmaps.begin(); it != extmaps.end(); ++it) {
+                if (it->second == kRidExt) {
+                    remote_rid_id = it->first;
+                } else if (it->second == kMidExt) {
+                    remote_mid_id = it->first;
+                }
+            }
+
+            if (!remote_rid_id) {
+                return srs_error_new(ERROR_RTC_SDP_EXCHANGE, "no rid extension for simulcast, mid=%s", remote_media_desc.mid_.c_str());
+            }
+
+            track_desc->add_rtp_extension_desc(remote_rid_id, kRidExt);
+            if (remote_mid_id) {
+                track_desc->add_rtp_extension_desc(remote_mid_id, kMidExt);
+            }
+
+            for (int j = 0; j < (int)remote_media_desc.simulcast_rids_.size(); ++j) {
+                SrsRtcTrackDescription* track_desc_copy = track_desc->copy();
+                track_desc_copy->id_ = remote_media_desc.msid_tracker_.empty() ? remote_media_desc.mid_ : remote_media_desc.msid_tracker_;
+                track_desc_copy->msid_ = remote_media_desc.msid_;
+                track_desc_copy->rid_ = remote_media_desc.simulcast_rids_.at(j);
+                stream_desc->video_track_descs_.push_back(track_desc_copy);
+            }
+
+            vector<string> rids = remote_media_desc.simulcast_rids_;
+            srs_trace("RTC: Simulcast publish mid=%s, track=%s, layers=%s", remote_media_desc.mid_.c_str(),
+                remote_media_desc.msid_tracker_.c_str(), srs_join_vector_string(rids, ",").c_str());
+            continue;
+        }
+
         std::string track_id;
         for (int j = 0; j < (int)remote_media_desc.ssrc_infos_.size(); ++j) {
             const SrsSSRCInfo& ssrc_info = remote_media_desc.ssrc_infos_.at(j);
@@ -2946,6 +3310,14 @@ srs_error_t SrsRtcConnection::generate_publish_local_sdp_for_video(SrsSdp& local
     for (int i = 0;  i < (int)stream_desc->video_track_descs_.size(); ++i) {
         SrsRtcTrackDescription* video_track = stream_desc->video_track_descs_.at(i);
 
+        // For simulcast, all layers share the same media description, with a RID for each layer.
+        if (!video_track->rid_.empty() && i > 0 && stream_desc->video_track_descs_.at(i - 1)->mid_ == video_track->mid_) {
+            SrsMediaDesc& local_media_desc = local_sdp.media_descs_.back();
+            local_media_desc.rids_.push_back(SrsRidInfo(video_track->rid_, "recv"));
+            local_media_desc.simulcast_rids_.push_back(video_track->rid_);
+            continue;
+        }
+
         local_sdp.media_descs_.push_back(SrsMediaDesc("video"));
         SrsMediaDesc& local_media_desc = local_sdp.media_descs_.back();
 
@@ -2980,6 +3352,12 @@ srs_error_t SrsRtcConnection::generate_publish_local_sdp_for_video(SrsSdp& local
             local_media_desc.payload_types_.push_back(payload->generate_media_payload_type());
         }
 
+        if (!video_track->rid_.empty()) {
+            local_media_desc.rids_.push_back(SrsRidInfo(video_track->rid_, "recv"));
+            local_media_desc.simulcast_direction_ = "recv";
+            local_media_desc.simulcast_rids_.push_back(video_track->rid_);
+        }
+
         if(!unified_plan) {
             // For PlanB, only need media desc info, not ssrc info;
             break;
@@ -3093,6 +3471,17 @@ srs_error_t SrsRtcConnection::negotiate_play_capability(SrsRtcUserConfig* ruc, s
         }
 
         for (int j = 0; j < (int)track_descs.size(); ++j) {
+            // For simulcast, create only one track for all layers, which selects the layer for player.
+            bool simulcast_negotiated = false;
+            for (int k = 0; k < j && !track_descs.at(j)->rid_.empty(); ++k) {
+                if (track_descs.at(k)->id_ == track_descs.at(j)->id_ && !track_descs.at(k)->rid_.empty()) {
+                    simulcast_negotiated = true;
+                }
+            }
+            if (simulcast_negotiated) {
+                continue;
+            }
+
             SrsRtcTrackDescription* track = track_descs.at(j)->copy();
 
             // We should clear the extmaps of source(publisher).
@@ -3145,6 +3534,11 @@ srs_error_t SrsRtcConnection::negotiate_play_capability(SrsRtcUserConfig* ruc, s
                 track->rtx_ssrc_ = 0;
             }
 
+            // For simulcast, the SSRC of layers changes, so we use the SSRC of player as key.
+            if (!track->rid_.empty()) {
+                publish_ssrc = track->ssrc_;
+            }
+
             track->set_direction("sendonly");
             sub_relations.insert(make_pair(publish_ssrc, track));
         }
@@ -3414,7 +3808,9 @@ srs_error_t SrsRtcConnection::create_player(SrsRequest* req, std::map<uint32_t,
             ++it;
         }
     }
-    srs_trace("RTC connection player gcc=%d", twcc_id);
+    twcc_id_ = twcc_id;
+    pacer_enabled_ = twcc_id && _srs_config->get_rtc_pacer_enabled(req->vhost);
+    srs_trace("RTC connection player gcc=%d, pacer=%d", twcc_id, pacer_enabled_);
 
     // TODO: Start player when DTLS done. Removed it because we don't support single PC now.
     // If DTLS done, start the player. Because maybe create some players after DTLS done.
@@ -3469,6 +3865,12 @@ srs_error_t SrsRtcConnection::create_publisher(SrsRequest* req, SrsRtcSourceDesc
 
     for(int i = 0; i < (int)stream_desc->video_track_descs_.size(); ++i) {
         SrsRtcTrackDescription* track_desc = stream_desc->video_track_descs_.at(i);
+
+        // The SSRC of simulcast layer is unknown, see find_publisher.
+        if (!track_desc->rid_.empty() && !track_desc->ssrc_) {
+            continue;
+        }
+
         if(publishers_ssrc_map_.end() != publishers_ssrc_map_.find(track_desc->ssrc_)) {
             return srs_error_new(ERROR_RTC_DUPLICATED_SSRC, " duplicate ssrc %d, track id: %s",
                 track_desc->ssrc_, track_desc->id_.c_str());
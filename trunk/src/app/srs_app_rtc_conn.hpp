@@ -56,6 +56,8 @@ class SrsRtcNetworks;
 class SrsRtcUdpNetwork;
 class ISrsRtcNetwork;
 class SrsRtcTcpNetwork;
+class SrsRtcBandwidthEstimator;
+class SrsRtcPacer;
 
 const uint8_t kSR   = 200;
 const uint8_t kRR   = 201;
@@ -83,6 +85,9 @@ public:
     // Encrypt the packet(paintext) to cipher, which is aso the packet ptr.
     // The nb_cipher should be initialized to the size of cipher, with some paddings.
     virtual srs_error_t protect_rtp(void* packet, int* nb_cipher) = 0;
+    // Encrypt a batch of packets, the nb_ciphers[i] is the size of packets[i], updated to the size of cipher, or
+    // 0 if failed to encrypt the packet.
+    virtual srs_error_t protect_rtps(void** packets, int* nb_ciphers, int nn_packets) = 0;
     virtual srs_error_t protect_rtcp(void* packet, int* nb_cipher) = 0;
     // Decrypt the packet(cipher) to plaintext, which is also the packet ptr.
     // The nb_plaintext should be initialized to the size of cipher.
@@ -111,6 +116,7 @@ public:
     // Encrypt the packet(paintext) to cipher, which is aso the packet ptr.
     // The nb_cipher should be initialized to the size of cipher, with some paddings.
     srs_error_t protect_rtp(void* packet, int* nb_cipher);
+    srs_error_t protect_rtps(void** packets, int* nb_ciphers, int nn_packets);
     srs_error_t protect_rtcp(void* packet, int* nb_cipher);
     // Decrypt the packet(cipher) to plaintext, which is also the packet ptr.
     // The nb_plaintext should be initialized to the size of cipher.
@@ -133,6 +139,7 @@ public:
     virtual ~SrsSemiSecurityTransport();
 public:
     srs_error_t protect_rtp(void* packet, int* nb_cipher);
+    srs_error_t protect_rtps(void** packets, int* nb_ciphers, int nn_packets);
     srs_error_t protect_rtcp(void* packet, int* nb_cipher);
 };
 
@@ -154,6 +161,7 @@ public:
     virtual srs_error_t write_dtls_data(void* data, int size);
 public:
     srs_error_t protect_rtp(void* packet, int* nb_cipher);
+    srs_error_t protect_rtps(void** packets, int* nb_ciphers, int nn_packets);
     srs_error_t protect_rtcp(void* packet, int* nb_cipher);
     srs_error_t unprotect_rtp(void* packet, int* nb_plaintext);
     srs_error_t unprotect_rtcp(void* packet, int* nb_plaintext);
@@ -219,6 +227,8 @@ private:
     // key: publish_ssrc, value: send track to process rtp/rtcp
     std::map<uint32_t, SrsRtcAudioSendTrack*> audio_tracks_;
     std::map<uint32_t, SrsRtcVideoSendTrack*> video_tracks_;
+    // For simulcast, key: ssrc of layer from publisher, value: send track which selects the layer.
+    std::map<uint32_t, SrsRtcVideoSendTrack*> simulcast_tracks_;
     // The pithy print for special stage.
     SrsErrorPithyPrint* nack_epp;
 private:
@@ -259,9 +269,14 @@ public:
     virtual srs_error_t cycle();
 private:
     srs_error_t send_packet(SrsRtpPacket*& pkt);
+    SrsRtcVideoSendTrack* fetch_simulcast_track(uint32_t ssrc);
 public:
     // Directly set the status of track, generally for init to set the default value.
     void set_all_tracks_status(bool status);
+    // For simulcast, specify the layer by RID, or empty to select layer by bandwidth.
+    void set_simulcast_layer(std::string rid);
+    // For simulcast, select the layer by the estimated bandwidth of player in bps.
+    void on_bandwidth(int64_t bps);
 public:
     srs_error_t on_rtcp(SrsRtcpCommon* rtcp);
 private:
@@ -352,7 +367,6 @@ private:
     int twcc_id_;
     uint8_t twcc_fb_count_;
     SrsRtcpTWCC rtcp_twcc_;
-    SrsRtpExtensionTypes extension_types_;
     bool is_started;
     srs_utime_t last_time_send_twcc_;
 public:
@@ -386,6 +400,9 @@ private:
 public:
     void request_keyframe(uint32_t ssrc, SrsContextId cid);
     virtual srs_error_t do_request_keyframe(uint32_t ssrc, SrsContextId cid);
+public:
+    // For simulcast, bind the unknown SSRC to the layer by RID in RTP packet, return whether bound.
+    bool bind_simulcast_ssrc(char* buf, int size, uint32_t ssrc);
 public:
     void simulate_nack_drop(int nn);
 private:
@@ -429,7 +446,13 @@ private:
     SrsRtcServer* server_;
 private:
     iovec* cache_iov_;
-    SrsBuffer* cache_buffer_;
+    // The batch of packets for player, protected by SRTP together then sent, see SRS_PERF_RTC_SEND_BATCH.
+    bool batching_;
+    // Whether flushing the batch, the packets should be sent directly, for example, the NACK response.
+    bool flushing_;
+    iovec* batch_iovs_;
+    uint16_t* batch_twcc_sns_;
+    int nn_batch_;
 private:
     // key: stream id
     std::map<std::string, SrsRtcPlayStream*> players_;
@@ -459,6 +482,13 @@ private:
 private:
     // twcc handler
     int twcc_id_;
+    // The transport-wide sequence number for player, see https://datatracker.ietf.org/doc/html/draft-holmer-rmcat-transport-wide-cc-extensions-01
+    uint16_t twcc_sn_;
+    // The bandwidth estimator for player, driven by TWCC feedback and REMB.
+    SrsRtcBandwidthEstimator* bwe_;
+    // The pacer for player, to smooth the bursts of packets.
+    SrsRtcPacer* pacer_;
+    bool pacer_enabled_;
     // Simulators.
     int nn_simulate_player_nack_drop;
     // Pithy print for PLI request.
@@ -510,8 +540,11 @@ public:
 private:
     srs_error_t dispatch_rtcp(SrsRtcpCommon* rtcp);
 public:
-    srs_error_t on_rtcp_feedback_twcc(char* buf, int nb_buf);
+    srs_error_t on_rtcp_feedback_twcc(SrsRtcpTWCC* rtcp);
     srs_error_t on_rtcp_feedback_remb(SrsRtcpPsfbCommon *rtcp);
+private:
+    // Update the estimated bitrate to pacer and stat of players.
+    void on_bwe_update();
 public:
     srs_error_t on_dtls_handshake_done();
     srs_error_t on_dtls_alert(std::string type, std::string desc);
@@ -531,6 +564,11 @@ public:
     // Simulate the NACK to drop nn packets.
     void simulate_nack_drop(int nn);
     void simulate_player_drop_packet(SrsRtpHeader* h, int nn_bytes);
+    // Wait for the pacer before sending packet of player, to avoid bursts of packets.
+    void pace_packet(int nb_bytes);
+    // Whether send packets in batch, the player should flush the batch before switching coroutine.
+    void set_batching(bool v);
+    srs_error_t flush_packets();
     srs_error_t do_send_packet(SrsRtpPacket* pkt);
     // Directly set the status of play track, generally for init to set the default value.
     void set_all_tracks_status(std::string stream_uri, bool is_publish, bool status);
@@ -20,6 +20,7 @@ using namespace std;
 #include <srs_app_log.hpp>
 #include <srs_kernel_utility.hpp>
 #include <srs_protocol_utility.hpp>
+#include <srs_app_threads.hpp>
 
 #include <srtp2/srtp.h>
 #include <openssl/ssl.h>
@@ -181,11 +182,15 @@ SSL_CTX* srs_build_dtls_ctx(SrsDtlsVersion version, std::string role)
         // @see https://www.openssl.org/docs/man1.0.2/man3/SSL_CTX_set_read_ahead.html
         SSL_CTX_set_read_ahead(dtls_ctx, 1);
 
-        // TODO: Maybe we can use SRTP-GCM in future.
+        // Prefer SRTP-GCM which is much cheaper than HMAC-SHA1 with AES-NI, server selects the first profile
+        // in our list which is also offered by client, please read ssl/d1_srtp.c
         // @see https://bugs.chromium.org/p/chromium/issues/detail?id=713701
         // @see https://groups.google.com/forum/#!topic/discuss-webrtc/PvCbWSetVAQ
-        // @remark Only support SRTP_AES128_CM_SHA1_80, please read ssl/d1_srtp.c
-        srs_assert(SSL_CTX_set_tlsext_use_srtp(dtls_ctx, "SRTP_AES128_CM_SHA1_80") == 0);
+        if (_srs_config->get_rtc_server_srtp_gcm() && srs_srtp_gcm_supported()) {
+            srs_assert(SSL_CTX_set_tlsext_use_srtp(dtls_ctx, "SRTP_AEAD_AES_128_GCM:SRTP_AES128_CM_SHA1_80") == 0);
+        } else {
+            srs_assert(SSL_CTX_set_tlsext_use_srtp(dtls_ctx, "SRTP_AES128_CM_SHA1_80") == 0);
+        }
     }
 
     return dtls_ctx;
@@ -641,13 +646,21 @@ void SrsDtlsImpl::state_trace(uint8_t* data, int length, bool incoming, int r0,
 
 const int SRTP_MASTER_KEY_KEY_LEN = 16;
 const int SRTP_MASTER_KEY_SALT_LEN = 14;
+// For AEAD_AES_128_GCM, the salt is 12 bytes, see https://www.rfc-editor.org/rfc/rfc7714#section-12
+const int SRTP_GCM_MASTER_KEY_SALT_LEN = 12;
 srs_error_t SrsDtlsImpl::get_srtp_key(std::string& recv_key, std::string& send_key)
 {
     srs_error_t err = srs_success;
 
+    int salt_len = SRTP_MASTER_KEY_SALT_LEN;
+    if (get_srtp_profile() == SrsSrtpProfileAeadAes128Gcm) {
+        salt_len = SRTP_GCM_MASTER_KEY_SALT_LEN;
+    }
+
     unsigned char material[SRTP_MASTER_KEY_LEN * 2] = {0};  // client(SRTP_MASTER_KEY_KEY_LEN + SRTP_MASTER_KEY_SALT_LEN) + server
+    int nb_material = (SRTP_MASTER_KEY_KEY_LEN + salt_len) * 2;
     static const string dtls_srtp_lable = "EXTRACTOR-dtls_srtp";
-    if (!SSL_export_keying_material(dtls, material, sizeof(material), dtls_srtp_lable.c_str(), dtls_srtp_lable.size(), NULL, 0, 0)) {
+    if (!SSL_export_keying_material(dtls, material, nb_material, dtls_srtp_lable.c_str(), dtls_srtp_lable.size(), NULL, 0, 0)) {
         return srs_error_new(ERROR_RTC_SRTP_INIT, "SSL export key r0=%lu", ERR_get_error());
     }
 
@@ -657,9 +670,9 @@ srs_error_t SrsDtlsImpl::get_srtp_key(std::string& recv_key, std::string& send_k
     offset += SRTP_MASTER_KEY_KEY_LEN;
     std::string server_master_key(reinterpret_cast<char*>(material + offset), SRTP_MASTER_KEY_KEY_LEN);
     offset += SRTP_MASTER_KEY_KEY_LEN;
-    std::string client_master_salt(reinterpret_cast<char*>(material + offset), SRTP_MASTER_KEY_SALT_LEN);
-    offset += SRTP_MASTER_KEY_SALT_LEN;
-    std::string server_master_salt(reinterpret_cast<char*>(material + offset), SRTP_MASTER_KEY_SALT_LEN);
+    std::string client_master_salt(reinterpret_cast<char*>(material + offset), salt_len);
+    offset += salt_len;
+    std::string server_master_salt(reinterpret_cast<char*>(material + offset), salt_len);
 
     if (is_dtls_client()) {
         recv_key = server_master_key + server_master_salt;
@@ -672,6 +685,16 @@ srs_error_t SrsDtlsImpl::get_srtp_key(std::string& recv_key, std::string& send_k
     return err;
 }
 
+SrsSrtpProfile SrsDtlsImpl::get_srtp_profile()
+{
+    SRTP_PROTECTION_PROFILE* profile = dtls? SSL_get_selected_srtp_profile(dtls) : NULL;
+    if (profile && profile->id == SRTP_AEAD_AES_128_GCM) {
+        return SrsSrtpProfileAeadAes128Gcm;
+    }
+
+    return SrsSrtpProfileAes128CmSha1_80;
+}
+
 void SrsDtlsImpl::callback_by_ssl(std::string type, std::string desc)
 {
     srs_error_t err = srs_success;
@@ -1043,10 +1066,44 @@ srs_error_t SrsDtls::get_srtp_key(std::string& recv_key, std::string& send_key)
     return impl->get_srtp_key(recv_key, send_key);
 }
 
+SrsSrtpProfile SrsDtls::get_srtp_profile()
+{
+    return impl->get_srtp_profile();
+}
+
+bool srs_srtp_gcm_supported()
+{
+    static int supported = -1;
+    if (supported >= 0) {
+        return supported;
+    }
+
+    // The GCM cipher is only available when libsrtp is built with openssl, so we try to create a context.
+    srtp_policy_t policy;
+    bzero(&policy, sizeof(policy));
+    srtp_crypto_policy_set_aes_gcm_128_16_auth(&policy.rtp);
+    srtp_crypto_policy_set_aes_gcm_128_16_auth(&policy.rtcp);
+    policy.ssrc.type = ssrc_any_outbound;
+    policy.window_size = 8192;
+
+    uint8_t key[SRTP_AES_GCM_128_KEY_LEN_WSALT] = {0};
+    policy.key = key;
+
+    srtp_t ctx = NULL;
+    supported = (srtp_create(&ctx, &policy) == srtp_err_status_ok);
+    if (ctx) {
+        srtp_dealloc(ctx);
+    }
+
+    return supported;
+}
+
 SrsSRTP::SrsSRTP()
 {
     recv_ctx_ = NULL;
     send_ctx_ = NULL;
+    // Only lock the send context if shared by SRTP worker threads.
+    send_lock_ = (_srs_async_srtp && _srs_async_srtp->enabled())? new SrsThreadMutex() : NULL;
 }
 
 SrsSRTP::~SrsSRTP()
@@ -1058,20 +1115,25 @@ SrsSRTP::~SrsSRTP()
     if (send_ctx_) {
         srtp_dealloc(send_ctx_);
     }
+
+    srs_freep(send_lock_);
 }
 
-srs_error_t SrsSRTP::initialize(string recv_key, std::string send_key)
+srs_error_t SrsSRTP::initialize(string recv_key, std::string send_key, SrsSrtpProfile profile)
 {
     srs_error_t err = srs_success;
 
     srtp_policy_t policy;
     bzero(&policy, sizeof(policy));
 
-    // TODO: Maybe we can use SRTP-GCM in future.
-    // @see https://bugs.chromium.org/p/chromium/issues/detail?id=713701
-    // @see https://groups.google.com/forum/#!topic/discuss-webrtc/PvCbWSetVAQ
-    srtp_crypto_policy_set_aes_cm_128_hmac_sha1_80(&policy.rtp);
-    srtp_crypto_policy_set_aes_cm_128_hmac_sha1_80(&policy.rtcp);
+    // For AEAD_AES_128_GCM, the auth tag is 16 bytes, see https://www.rfc-editor.org/rfc/rfc7714#section-14.2
+    if (profile == SrsSrtpProfileAeadAes128Gcm) {
+        srtp_crypto_policy_set_aes_gcm_128_16_auth(&policy.rtp);
+        srtp_crypto_policy_set_aes_gcm_128_16_auth(&policy.rtcp);
+    } else {
+        srtp_crypto_policy_set_aes_cm_128_hmac_sha1_80(&policy.rtp);
+        srtp_crypto_policy_set_aes_cm_128_hmac_sha1_80(&policy.rtcp);
+    }
 
     policy.ssrc.value = 0;
     // TODO: adjust window_size
@@ -1113,6 +1175,8 @@ srs_error_t SrsSRTP::protect_rtp(void* packet, int* nb_cipher)
         return srs_error_new(ERROR_RTC_SRTP_PROTECT, "not ready");
     }
 
+    SrsThreadLocker(send_lock_);
+
     srtp_err_status_t r0 = srtp_err_status_ok;
     if ((r0 = srtp_protect(send_ctx_, packet, nb_cipher)) != srtp_err_status_ok) {
         return srs_error_new(ERROR_RTC_SRTP_PROTECT, "rtp protect r0=%u", r0);
@@ -1121,6 +1185,44 @@ srs_error_t SrsSRTP::protect_rtp(void* packet, int* nb_cipher)
     return err;
 }
 
+srs_error_t SrsSRTP::protect_rtps(void** packets, int* nb_ciphers, int nn_packets)
+{
+    // If DTLS/SRTP is not ready, fail all packets.
+    if (!send_ctx_) {
+        memset(nb_ciphers, 0, sizeof(int) * nn_packets);
+        return srs_error_new(ERROR_RTC_SRTP_PROTECT, "not ready");
+    }
+
+    // Protect in SRTP worker thread, or in the caller thread if no worker.
+    return _srs_async_srtp->protect_rtps(this, packets, nb_ciphers, nn_packets);
+}
+
+srs_error_t SrsSRTP::do_protect_rtps(void** packets, int* nb_ciphers, int nn_packets)
+{
+    srs_error_t err = srs_success;
+
+    SrsThreadLocker(send_lock_);
+
+    // Never drop the whole batch for a bad packet, only skip it.
+    int nn_failed = 0;
+    srtp_t ctx = send_ctx_;
+    for (int i = 0; i < nn_packets; i++) {
+        srtp_err_status_t r0 = srtp_err_status_ok;
+        if ((r0 = srtp_protect(ctx, packets[i], &nb_ciphers[i])) != srtp_err_status_ok) {
+            if (!nn_failed++) {
+                err = srs_error_new(ERROR_RTC_SRTP_PROTECT, "rtp protect #%d r0=%u", i, r0);
+            }
+            nb_ciphers[i] = 0;
+        }
+    }
+
+    if (nn_failed) {
+        return srs_error_wrap(err, "failed %d/%d packets", nn_failed, nn_packets);
+    }
+
+    return err;
+}
+
 srs_error_t SrsSRTP::protect_rtcp(void* packet, int* nb_cipher)
 {
     srs_error_t err = srs_success;
@@ -1130,6 +1232,8 @@ srs_error_t SrsSRTP::protect_rtcp(void* packet, int* nb_cipher)
         return srs_error_new(ERROR_RTC_SRTP_PROTECT, "not ready");
     }
 
+    SrsThreadLocker(send_lock_);
+
     srtp_err_status_t r0 = srtp_err_status_ok;
     if ((r0 = srtp_protect_rtcp(send_ctx_, packet, nb_cipher)) != srtp_err_status_ok) {
         return srs_error_new(ERROR_RTC_SRTP_PROTECT, "rtcp protect r0=%u", r0);
@@ -18,6 +18,7 @@
 #include <srs_app_st.hpp>
 
 class SrsRequest;
+class SrsThreadMutex;
 
 class SrsDtlsCertificate
 {
@@ -64,6 +65,16 @@ enum SrsDtlsVersion {
     SrsDtlsVersion1_2
 };
 
+// The SRTP protection profile negotiated by DTLS, the value is the IANA id.
+// @see https://www.iana.org/assignments/srtp-protection/srtp-protection.xhtml
+enum SrsSrtpProfile {
+    SrsSrtpProfileAes128CmSha1_80 = 0x0001,
+    SrsSrtpProfileAeadAes128Gcm = 0x0007,
+};
+
+// Whether libsrtp supports AEAD_AES_128_GCM, which requires libsrtp built with openssl.
+extern bool srs_srtp_gcm_supported();
+
 class ISrsDtlsCallback
 {
 public:
@@ -120,6 +131,8 @@ protected:
     void state_trace(uint8_t* data, int length, bool incoming, int r0, int r1, bool arq);
 public:
     srs_error_t get_srtp_key(std::string& recv_key, std::string& send_key);
+    // Get the SRTP profile selected by DTLS handshake.
+    SrsSrtpProfile get_srtp_profile();
     void callback_by_ssl(std::string type, std::string desc);
 protected:
     virtual srs_error_t on_final_out_data(uint8_t* data, int size) = 0;
@@ -210,6 +223,7 @@ public:
     srs_error_t on_dtls(char* data, int nb_data);
 public:
     srs_error_t get_srtp_key(std::string& recv_key, std::string& send_key);
+    SrsSrtpProfile get_srtp_profile();
 };
 
 class SrsSRTP
@@ -217,14 +231,23 @@ class SrsSRTP
 private:
     srtp_t recv_ctx_;
     srtp_t send_ctx_;
+    // The send context might be used by SRTP worker thread, see SrsAsyncSrtpWorkers. It's NULL if no worker,
+    // so never lock for each packet.
+    SrsThreadMutex* send_lock_;
 public:
     SrsSRTP();
     virtual ~SrsSRTP();
 public:
-    // Intialize srtp context with recv_key and send_key.
-    srs_error_t initialize(std::string recv_key, std::string send_key);
+    // Intialize srtp context with recv_key and send_key, for the profile negotiated by DTLS.
+    srs_error_t initialize(std::string recv_key, std::string send_key, SrsSrtpProfile profile = SrsSrtpProfileAes128CmSha1_80);
 public:
     srs_error_t protect_rtp(void* packet, int* nb_cipher);
+    // Protect a batch of RTP packets, to amortize the cost of context for each packet.
+    // @remark The nb_ciphers[i] is the size of packets[i], updated to the size of cipher.
+    // @remark The nb_ciphers[i] is set to 0 if failed to protect packets[i], and the error is returned.
+    srs_error_t protect_rtps(void** packets, int* nb_ciphers, int nn_packets);
+    // Protect a batch of RTP packets in the caller thread.
+    srs_error_t do_protect_rtps(void** packets, int* nb_ciphers, int nn_packets);
     srs_error_t protect_rtcp(void* packet, int* nb_cipher);
     srs_error_t unprotect_rtp(void* packet, int* nb_plaintext);
     srs_error_t unprotect_rtcp(void* packet, int* nb_plaintext);
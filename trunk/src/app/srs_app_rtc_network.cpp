@@ -137,6 +137,11 @@ srs_error_t SrsRtcDummyNetwork::protect_rtp(void* packet, int* nb_cipher)
     return srs_success;
 }
 
+srs_error_t SrsRtcDummyNetwork::protect_rtps(void** packets, int* nb_ciphers, int nn_packets)
+{
+    return srs_success;
+}
+
 srs_error_t SrsRtcDummyNetwork::protect_rtcp(void* packet, int* nb_cipher)
 {
     return srs_success;
@@ -228,6 +233,11 @@ srs_error_t SrsRtcUdpNetwork::protect_rtp(void* packet, int* nb_cipher)
     return transport_->protect_rtp(packet, nb_cipher);
 }
 
+srs_error_t SrsRtcUdpNetwork::protect_rtps(void** packets, int* nb_ciphers, int nn_packets)
+{
+    return transport_->protect_rtps(packets, nb_ciphers, nn_packets);
+}
+
 srs_error_t SrsRtcUdpNetwork::protect_rtcp(void* packet, int* nb_cipher)
 {
     return transport_->protect_rtcp(packet, nb_cipher);
@@ -350,8 +360,8 @@ void SrsRtcUdpNetwork::update_sendonly_socket(SrsUdpMuxSocket* skt)
         peer_addresses_[peer_id] = addr_cache = skt->copy_sendonly();
         _srs_rtc_manager->add_with_id(peer_id, conn_);
 
-        uint64_t fast_id = skt->fast_id();
-        if (fast_id) {
+        const SrsResourceFastKey& fast_id = skt->fast_id();
+        if (!fast_id.empty()) {
             _srs_rtc_manager->add_with_fast_id(fast_id, conn_);
         }
     }
@@ -484,6 +494,11 @@ srs_error_t SrsRtcTcpNetwork::protect_rtp(void* packet, int* nb_cipher)
     return transport_->protect_rtp(packet, nb_cipher);
 }
 
+srs_error_t SrsRtcTcpNetwork::protect_rtps(void** packets, int* nb_ciphers, int nn_packets)
+{
+    return transport_->protect_rtps(packets, nb_ciphers, nn_packets);
+}
+
 srs_error_t SrsRtcTcpNetwork::protect_rtcp(void* packet, int* nb_cipher)
 {
     return transport_->protect_rtcp(packet, nb_cipher);
@@ -92,6 +92,8 @@ public:
 public:
     // Protect RTP packet by SRTP context.
     virtual srs_error_t protect_rtp(void* packet, int* nb_cipher) = 0;
+    // Protect a batch of RTP packets by SRTP context.
+    virtual srs_error_t protect_rtps(void** packets, int* nb_ciphers, int nn_packets) = 0;
     // Protect RTCP packet by SRTP context.
     virtual srs_error_t protect_rtcp(void* packet, int* nb_cipher) = 0;
 public:
@@ -111,6 +113,7 @@ public:
     virtual srs_error_t on_dtls_alert(std::string type, std::string desc);
 public:
     virtual srs_error_t protect_rtp(void* packet, int* nb_cipher);
+    virtual srs_error_t protect_rtps(void** packets, int* nb_ciphers, int nn_packets);
     virtual srs_error_t protect_rtcp(void* packet, int* nb_cipher);
     virtual bool is_establelished();
 // Interface ISrsStreamWriter.
@@ -153,6 +156,7 @@ public:
     virtual srs_error_t on_dtls_alert(std::string type, std::string desc);
     srs_error_t on_dtls_handshake_done();
     srs_error_t protect_rtp(void* packet, int* nb_cipher);
+    srs_error_t protect_rtps(void** packets, int* nb_ciphers, int nn_packets);
     srs_error_t protect_rtcp(void* packet, int* nb_cipher);
 // When got data from socket.
 public:
@@ -200,6 +204,8 @@ public:
     virtual srs_error_t on_dtls_alert(std::string type, std::string desc);
     // Protect RTP packet by SRTP context.
     virtual srs_error_t protect_rtp(void* packet, int* nb_cipher);
+    // Protect a batch of RTP packets by SRTP context.
+    virtual srs_error_t protect_rtps(void** packets, int* nb_ciphers, int nn_packets);
     // Protect RTCP packet by SRTP context.
     virtual srs_error_t protect_rtcp(void* packet, int* nb_cipher);
 
@@ -0,0 +1,395 @@
+//
+// Copyright (c) 2013-2023 The SRS Authors
+//
+// SPDX-License-Identifier: MIT or MulanPSL-2.0
+//
+
+#include <srs_app_rtc_pacer.hpp>
+
+#include <math.h>
+#include <string.h>
+
+using namespace std;
+
+#include <srs_kernel_error.hpp>
+#include <srs_kernel_log.hpp>
+#include <srs_kernel_utility.hpp>
+
+// The size of sent packets history, should be able to divide 65536, for the uint16 sn to wrap around.
+const int kRtcBweHistorySize = 4096;
+
+// The start, min and max estimated bitrate in bps.
+const int64_t kRtcBweStartBitrate = 1000 * 1000;
+const int64_t kRtcBweMinBitrate = 50 * 1000;
+const int64_t kRtcBweMaxBitrate = 50 * 1000 * 1000;
+
+// The packets sent in this duration is a group, for the delay variation.
+const srs_utime_t kRtcBweGroupDuration = 5 * SRS_UTIME_MILLISECONDS;
+
+// The trendline filter, @see https://webrtc.googlesource.com/src/+/refs/heads/main/modules/congestion_controller/goog_cc/trendline_estimator.cc
+const int kRtcBweTrendlineWindow = 20;
+const double kRtcBweTrendlineSmoothing = 0.9;
+const double kRtcBweTrendlineGain = 4.0;
+const int kRtcBweMaxDeltas = 60;
+
+// The adaptive threshold of overuse detector, in ms.
+const double kRtcBweThresholdStart = 12.5;
+const double kRtcBweThresholdMin = 6;
+const double kRtcBweThresholdMax = 600;
+const double kRtcBweThresholdUp = 0.0087;
+const double kRtcBweThresholdDown = 0.039;
+const double kRtcBweOveruseTime = 10;
+
+// The window to calculate the acked and sent bitrate.
+const srs_utime_t kRtcBweAckedWindow = 500 * SRS_UTIME_MILLISECONDS;
+const srs_utime_t kRtcBweSentWindow = 1 * SRS_UTIME_SECONDS;
+// The min packets to calculate the loss rate.
+const int kRtcBweLossPackets = 20;
+
+// The max bytes for burst of pacer, in duration at the pacing rate.
+const srs_utime_t kRtcPacerMaxBurst = 20 * SRS_UTIME_MILLISECONDS;
+
+SrsRtcBandwidthEstimator::SrsRtcBandwidthEstimator()
+{
+    history_ = new SrsRtcSentPacket[kRtcBweHistorySize];
+    memset(history_, 0, sizeof(SrsRtcSentPacket) * kRtcBweHistorySize);
+
+    bitrate_ = kRtcBweStartBitrate;
+    remb_bitrate_ = 0;
+    acked_bitrate_ = 0;
+    acked_bytes_ = 0;
+    acked_start_ = -1;
+    sent_bitrate_ = 0;
+    sent_bytes_ = 0;
+    sent_start_ = -1;
+    loss_ = 0;
+    nn_lost_ = 0;
+    nn_packets_ = 0;
+    last_update_ = -1;
+
+    memset(&group_, 0, sizeof(SrsRtcPacketGroup));
+    memset(&prev_group_, 0, sizeof(SrsRtcPacketGroup));
+
+    accumulated_delay_ = 0;
+    smoothed_delay_ = 0;
+    nn_deltas_ = 0;
+    first_arrival_ = -1;
+
+    threshold_ = kRtcBweThresholdStart;
+    trend_ = 0;
+    time_over_using_ = -1;
+    overuse_counter_ = 0;
+    last_threshold_update_ = -1;
+    state_ = SrsRtcBweStateNormal;
+}
+
+SrsRtcBandwidthEstimator::~SrsRtcBandwidthEstimator()
+{
+    srs_freepa(history_);
+}
+
+void SrsRtcBandwidthEstimator::on_packet_sent(uint16_t sn, int size, srs_utime_t now)
+{
+    SrsRtcSentPacket* pkt = &history_[sn % kRtcBweHistorySize];
+    pkt->in_use = true;
+    pkt->sn = sn;
+    pkt->size = size;
+    pkt->send_time = now;
+
+    if (sent_start_ < 0) {
+        sent_start_ = now;
+    }
+
+    sent_bytes_ += size;
+    if (now - sent_start_ >= kRtcBweSentWindow) {
+        sent_bitrate_ = sent_bytes_ * 8 * SRS_UTIME_SECONDS / (now - sent_start_);
+        sent_bytes_ = 0;
+        sent_start_ = now;
+    }
+}
+
+srs_error_t SrsRtcBandwidthEstimator::on_twcc_feedback(SrsRtcpTWCC* twcc, srs_utime_t now)
+{
+    srs_error_t err = srs_success;
+
+    const vector<SrsRtcpTWCCStatus>& status = twcc->get_recv_status();
+    for (int i = 0; i < (int)status.size(); i++) {
+        const SrsRtcpTWCCStatus& s = status.at(i);
+
+        // Ignore if not sent by us, or already acked by previous feedback.
+        SrsRtcSentPacket* pkt = &history_[s.sn % kRtcBweHistorySize];
+        if (!pkt->in_use || pkt->sn != s.sn) {
+            continue;
+        }
+
+        nn_packets_++;
+        if (!s.received) {
+            nn_lost_++;
+            continue;
+        }
+        pkt->in_use = false;
+
+        // Update the acked bitrate, by the received time of peer.
+        if (acked_start_ < 0) {
+            acked_start_ = s.recv_time;
+        }
+        acked_bytes_ += pkt->size;
+        if (s.recv_time - acked_start_ >= kRtcBweAckedWindow) {
+            acked_bitrate_ = acked_bytes_ * 8 * SRS_UTIME_SECONDS / (s.recv_time - acked_start_);
+            acked_bytes_ = 0;
+            acked_start_ = s.recv_time;
+        }
+
+        // Group the packets sent in a burst, and detect the delay variation between groups.
+        if (group_.valid && pkt->send_time - group_.first_send > kRtcBweGroupDuration) {
+            on_packet_group(&group_);
+            group_.valid = false;
+        }
+
+        if (!group_.valid) {
+            group_.valid = true;
+            group_.size = 0;
+            group_.first_send = group_.last_send = pkt->send_time;
+            group_.last_recv = s.recv_time;
+        }
+
+        group_.size += pkt->size;
+        group_.last_send = srs_max(group_.last_send, pkt->send_time);
+        group_.last_recv = srs_max(group_.last_recv, s.recv_time);
+    }
+
+    // Update the loss rate when got enough packets.
+    bool loss_updated = false;
+    if (nn_packets_ >= kRtcBweLossPackets) {
+        loss_ = (float)nn_lost_ / nn_packets_;
+        nn_lost_ = nn_packets_ = 0;
+        loss_updated = true;
+    }
+
+    update_bitrate(now);
+
+    // The loss-based controller, decrease the bitrate when loss more than 10%.
+    if (loss_updated && loss_ > 0.1) {
+        bitrate_ = (int64_t)(bitrate_ * (1 - 0.5 * loss_));
+        bitrate_ = srs_max(kRtcBweMinBitrate, bitrate_);
+    }
+
+    return err;
+}
+
+void SrsRtcBandwidthEstimator::on_remb(uint64_t bitrate)
+{
+    remb_bitrate_ = (int64_t)bitrate;
+}
+
+int64_t SrsRtcBandwidthEstimator::bitrate()
+{
+    if (remb_bitrate_ > 0) {
+        return srs_max(kRtcBweMinBitrate, srs_min(bitrate_, remb_bitrate_));
+    }
+    return bitrate_;
+}
+
+int64_t SrsRtcBandwidthEstimator::sent_bitrate()
+{
+    return sent_bitrate_;
+}
+
+int64_t SrsRtcBandwidthEstimator::acked_bitrate()
+{
+    return acked_bitrate_;
+}
+
+float SrsRtcBandwidthEstimator::loss()
+{
+    return loss_;
+}
+
+SrsRtcBweState SrsRtcBandwidthEstimator::state()
+{
+    return state_;
+}
+
+void SrsRtcBandwidthEstimator::on_packet_group(SrsRtcPacketGroup* group)
+{
+    if (prev_group_.valid) {
+        double send_delta = (double)(group->last_send - prev_group_.last_send) / SRS_UTIME_MILLISECONDS;
+        double recv_delta = (double)(group->last_recv - prev_group_.last_recv) / SRS_UTIME_MILLISECONDS;
+
+        update_trendline(recv_delta - send_delta, group->last_recv);
+        detect(trend_, send_delta, group->last_recv);
+    }
+
+    prev_group_ = *group;
+}
+
+void SrsRtcBandwidthEstimator::update_trendline(double delta_ms, srs_utime_t arrival)
+{
+    nn_deltas_ = srs_min(nn_deltas_ + 1, kRtcBweMaxDeltas);
+
+    accumulated_delay_ += delta_ms;
+    smoothed_delay_ = kRtcBweTrendlineSmoothing * smoothed_delay_ + (1 - kRtcBweTrendlineSmoothing) * accumulated_delay_;
+
+    if (first_arrival_ < 0) {
+        first_arrival_ = arrival;
+    }
+
+    delay_hist_.push_back(make_pair((double)(arrival - first_arrival_) / SRS_UTIME_MILLISECONDS, smoothed_delay_));
+    if ((int)delay_hist_.size() > kRtcBweTrendlineWindow) {
+        delay_hist_.pop_front();
+    }
+
+    // Keep the previous trend, util the window is full.
+    if ((int)delay_hist_.size() < kRtcBweTrendlineWindow) {
+        return;
+    }
+
+    // The slope of the delay by linear regression, which is the trend of delay.
+    double sum_x = 0, sum_y = 0;
+    for (deque< pair<double, double> >::iterator it = delay_hist_.begin(); it != delay_hist_.end(); ++it) {
+        sum_x += it->first;
+        sum_y += it->second;
+    }
+
+    double avg_x = sum_x / delay_hist_.size();
+    double avg_y = sum_y / delay_hist_.size();
+
+    double numerator = 0, denominator = 0;
+    for (deque< pair<double, double> >::iterator it = delay_hist_.begin(); it != delay_hist_.end(); ++it) {
+        numerator += (it->first - avg_x) * (it->second - avg_y);
+        denominator += (it->first - avg_x) * (it->first - avg_x);
+    }
+
+    if (denominator != 0) {
+        trend_ = numerator / denominator;
+    }
+}
+
+void SrsRtcBandwidthEstimator::detect(double trend, double ts_delta_ms, srs_utime_t now)
+{
+    double modified_trend = srs_min(nn_deltas_, kRtcBweMaxDeltas) * trend * kRtcBweTrendlineGain;
+
+    if (modified_trend > threshold_) {
+        if (time_over_using_ < 0) {
+            time_over_using_ = ts_delta_ms / 2;
+        } else {
+            time_over_using_ += ts_delta_ms;
+        }
+        overuse_counter_++;
+
+        // Overusing when keep over the threshold for a while.
+        if (time_over_using_ > kRtcBweOveruseTime && overuse_counter_ > 1) {
+            time_over_using_ = 0;
+            overuse_counter_ = 0;
+            state_ = SrsRtcBweStateOverusing;
+        }
+    } else if (modified_trend < -threshold_) {
+        time_over_using_ = -1;
+        overuse_counter_ = 0;
+        state_ = SrsRtcBweStateUnderusing;
+    } else {
+        time_over_using_ = -1;
+        overuse_counter_ = 0;
+        state_ = SrsRtcBweStateNormal;
+    }
+
+    update_threshold(modified_trend, now);
+}
+
+void SrsRtcBandwidthEstimator::update_threshold(double trend, srs_utime_t now)
+{
+    if (last_threshold_update_ < 0) {
+        last_threshold_update_ = now;
+    }
+
+    // Ignore the large spikes, for example, the delay of keyframe.
+    double abs_trend = fabs(trend);
+    if (abs_trend > threshold_ + 15) {
+        last_threshold_update_ = now;
+        return;
+    }
+
+    double k = abs_trend < threshold_ ? kRtcBweThresholdDown : kRtcBweThresholdUp;
+    double elapsed = srs_min((double)(now - last_threshold_update_) / SRS_UTIME_MILLISECONDS, 100.0);
+
+    threshold_ += k * (abs_trend - threshold_) * elapsed;
+    threshold_ = srs_max(kRtcBweThresholdMin, srs_min(threshold_, kRtcBweThresholdMax));
+    last_threshold_update_ = now;
+}
+
+void SrsRtcBandwidthEstimator::update_bitrate(srs_utime_t now)
+{
+    double elapsed = 0;
+    if (last_update_ >= 0) {
+        elapsed = srs_min((double)(now - last_update_) / SRS_UTIME_SECONDS, 1.0);
+    }
+    last_update_ = now;
+
+    if (state_ == SrsRtcBweStateOverusing) {
+        // Decrease to 85% of the acked bitrate, which is the real capacity of network.
+        int64_t base = acked_bitrate_ ? acked_bitrate_ : bitrate_;
+        bitrate_ = srs_min(bitrate_, (int64_t)(0.85 * base));
+    } else if (state_ == SrsRtcBweStateNormal) {
+        // Increase 8% per second, but never exceed the acked bitrate too much.
+        bitrate_ = (int64_t)(bitrate_ * pow(1.08, elapsed));
+        if (acked_bitrate_ > 0) {
+            bitrate_ = srs_min(bitrate_, (int64_t)(1.5 * acked_bitrate_) + 10 * 1000);
+        }
+    }
+
+    bitrate_ = srs_max(kRtcBweMinBitrate, srs_min(bitrate_, kRtcBweMaxBitrate));
+}
+
+SrsRtcPacer::SrsRtcPacer()
+{
+    rate_ = kRtcBweStartBitrate;
+    budget_ = 0;
+    last_update_ = -1;
+}
+
+SrsRtcPacer::~SrsRtcPacer()
+{
+}
+
+void SrsRtcPacer::set_rate(int64_t bps)
+{
+    if (bps > 0) {
+        rate_ = bps;
+    }
+}
+
+int64_t SrsRtcPacer::rate()
+{
+    return rate_;
+}
+
+srs_utime_t SrsRtcPacer::on_packet(int size, srs_utime_t now)
+{
+    update(now);
+
+    // Wait util the debt is paid off.
+    if (budget_ < 0) {
+        return -budget_ * 8 * SRS_UTIME_SECONDS / rate_ + 1;
+    }
+
+    // Allow to send the packet even the budget is not enough, and pay off the debt later.
+    budget_ -= size;
+    return 0;
+}
+
+void SrsRtcPacer::update(srs_utime_t now)
+{
+    if (last_update_ < 0) {
+        last_update_ = now;
+    }
+
+    srs_utime_t elapsed = now - last_update_;
+    if (elapsed <= 0) {
+        return;
+    }
+    last_update_ = now;
+
+    int64_t max_budget = rate_ * kRtcPacerMaxBurst / 8 / SRS_UTIME_SECONDS;
+    budget_ = srs_min(max_budget, budget_ + rate_ * elapsed / 8 / SRS_UTIME_SECONDS);
+}
+
@@ -0,0 +1,139 @@
+//
+// Copyright (c) 2013-2023 The SRS Authors
+//
+// SPDX-License-Identifier: MIT or MulanPSL-2.0
+//
+
+#ifndef SRS_APP_RTC_PACER_HPP
+#define SRS_APP_RTC_PACER_HPP
+
+#include <srs_core.hpp>
+
+#include <deque>
+
+#include <srs_kernel_rtc_rtcp.hpp>
+
+// The state of network, detected by the trend of delay.
+enum SrsRtcBweState
+{
+    SrsRtcBweStateNormal = 0,
+    SrsRtcBweStateOverusing,
+    SrsRtcBweStateUnderusing,
+};
+
+// The packet sent to peer, to match with the TWCC feedback.
+struct SrsRtcSentPacket
+{
+    // Whether the slot is used, because sn is uint16 so we can't use -1.
+    bool in_use;
+    uint16_t sn;
+    int size;
+    srs_utime_t send_time;
+};
+
+// A group of packets, sent in a short burst, to calculate the delay variation between groups.
+struct SrsRtcPacketGroup
+{
+    bool valid;
+    int size;
+    srs_utime_t first_send;
+    srs_utime_t last_send;
+    srs_utime_t last_recv;
+};
+
+// The send side bandwidth estimator for player, like GCC(Google Congestion Control), driven by the TWCC feedback
+// and REMB from player. The delay-based controller detects the network overuse by the trend of delay variation
+// between packet groups, and the loss-based controller decreases the bitrate when packets are lost.
+// @see https://datatracker.ietf.org/doc/html/draft-ietf-rmcat-gcc-02
+class SrsRtcBandwidthEstimator
+{
+private:
+    // The history of sent packets, indexed by the TWCC sn.
+    SrsRtcSentPacket* history_;
+private:
+    // The estimated bitrate in bps.
+    int64_t bitrate_;
+    // The bitrate in bps, by REMB from peer, 0 if no REMB.
+    int64_t remb_bitrate_;
+    // The bitrate in bps, acknowledged by peer in TWCC feedback.
+    int64_t acked_bitrate_;
+    int64_t acked_bytes_;
+    srs_utime_t acked_start_;
+    // The bitrate in bps, sent to peer.
+    int64_t sent_bitrate_;
+    int64_t sent_bytes_;
+    srs_utime_t sent_start_;
+    // The loss rate in [0, 1], by TWCC feedback.
+    float loss_;
+    int nn_lost_;
+    int nn_packets_;
+    srs_utime_t last_update_;
+private:
+    // The current and previous packet group, to calculate the delay variation.
+    SrsRtcPacketGroup group_;
+    SrsRtcPacketGroup prev_group_;
+    // The trendline filter of delay, in ms.
+    double accumulated_delay_;
+    double smoothed_delay_;
+    int nn_deltas_;
+    srs_utime_t first_arrival_;
+    std::deque< std::pair<double, double> > delay_hist_;
+    // The overuse detector with adaptive threshold.
+    double threshold_;
+    double trend_;
+    double time_over_using_;
+    int overuse_counter_;
+    srs_utime_t last_threshold_update_;
+    SrsRtcBweState state_;
+public:
+    SrsRtcBandwidthEstimator();
+    virtual ~SrsRtcBandwidthEstimator();
+public:
+    // When sent packet with TWCC sn, should record it to match the feedback.
+    void on_packet_sent(uint16_t sn, int size, srs_utime_t now);
+    // When got TWCC feedback from peer, update the estimated bitrate.
+    srs_error_t on_twcc_feedback(SrsRtcpTWCC* twcc, srs_utime_t now);
+    // When got REMB from peer, which limits the estimated bitrate.
+    void on_remb(uint64_t bitrate);
+public:
+    // Get the estimated bitrate in bps.
+    int64_t bitrate();
+    // Get the bitrate in bps, sent to peer.
+    int64_t sent_bitrate();
+    // Get the bitrate in bps, acknowledged by peer.
+    int64_t acked_bitrate();
+    // Get the loss rate in [0, 1].
+    float loss();
+    SrsRtcBweState state();
+private:
+    void on_packet_group(SrsRtcPacketGroup* group);
+    void update_trendline(double delta_ms, srs_utime_t arrival);
+    void detect(double trend, double ts_delta_ms, srs_utime_t now);
+    void update_threshold(double trend, srs_utime_t now);
+    void update_bitrate(srs_utime_t now);
+};
+
+// The leaky bucket pacer, to smooth the bursts of packets, for example, the keyframe which is
+// consists of lots of packets, by sending packets at the pacing rate.
+class SrsRtcPacer
+{
+private:
+    // The pacing rate in bps.
+    int64_t rate_;
+    // The budget in bytes, negative if in debt.
+    int64_t budget_;
+    srs_utime_t last_update_;
+public:
+    SrsRtcPacer();
+    virtual ~SrsRtcPacer();
+public:
+    void set_rate(int64_t bps);
+    int64_t rate();
+    // Consume the budget for packet, return the time to wait before sending it, or 0 to send it now.
+    srs_utime_t on_packet(int size, srs_utime_t now);
+private:
+    void update(srs_utime_t now);
+};
+
+#endif
+
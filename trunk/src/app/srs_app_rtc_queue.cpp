@@ -204,12 +204,28 @@ SrsRtpNackForReceiver::SrsRtpNackForReceiver(SrsRtpRingBuffer* rtp, size_t queue
     pre_check_time_ = 0;
     rtt_ = 0;
 
-    srs_info("max_queue_size=%u, nack opt: max_count=%d, max_alive_time=%us, first_nack_interval=%" PRId64 ", nack_interval=%" PRId64,
-        max_queue_size_, opts_.max_count, opts_.max_alive_time, opts_.first_nack_interval, opts_.nack_interval);
+    // The window of lost seqs might be larger than the max queue size, because there are received
+    // packets between them, so we use a larger ring, at least 64 slots for a bitmap word.
+    capacity_ = 64;
+    while (capacity_ < (int)max_queue_size_ * 2 && capacity_ < 32768) {
+        capacity_ <<= 1;
+    }
+
+    infos_ = new SrsRtpNackInfo[capacity_];
+    bitmap_ = new uint64_t[capacity_ / 64];
+    memset(bitmap_, 0, sizeof(uint64_t) * (capacity_ / 64));
+
+    begin_ = end_ = 0;
+    size_ = 0;
+
+    srs_info("max_queue_size=%u, capacity=%d, nack opt: max_count=%d, max_alive_time=%us, first_nack_interval=%" PRId64 ", nack_interval=%" PRId64,
+        max_queue_size_, capacity_, opts_.max_count, opts_.max_alive_time, opts_.first_nack_interval, opts_.nack_interval);
 }
 
 SrsRtpNackForReceiver::~SrsRtpNackForReceiver()
 {
+    srs_freepa(infos_);
+    srs_freepa(bitmap_);
 }
 
 void SrsRtpNackForReceiver::insert(uint16_t first, uint16_t last)
@@ -220,40 +236,82 @@ void SrsRtpNackForReceiver::insert(uint16_t first, uint16_t last)
         return;
     }
 
+    srs_utime_t now = srs_update_system_time();
+
     for (uint16_t s = first; s != last; ++s) {
-        queue_[s] = SrsRtpNackInfo();
+        // If the window exceed the capacity, the list is full, see check_queue_size.
+        if (!expand(s)) {
+            rtp_->notify_nack_list_full();
+            clear();
+            expand(s);
+        }
+
+        int index = s & (capacity_ - 1);
+        uint64_t bit = ((uint64_t)1) << (index & 63);
+        if ((bitmap_[index >> 6] & bit) == 0) {
+            bitmap_[index >> 6] |= bit;
+            ++size_;
+        }
+
+        SrsRtpNackInfo& info = infos_[index];
+        info.generate_time_ = now;
+        info.pre_req_nack_time_ = 0;
+        info.req_nack_count_ = 0;
     }
 }
 
 void SrsRtpNackForReceiver::remove(uint16_t seq)
 {
-    queue_.erase(seq);
+    if (!in_window(seq)) {
+        return;
+    }
+
+    int index = seq & (capacity_ - 1);
+    uint64_t bit = ((uint64_t)1) << (index & 63);
+    if ((bitmap_[index >> 6] & bit) == 0) {
+        return;
+    }
+
+    bitmap_[index >> 6] &= ~bit;
+    --size_;
+
+    if (seq == begin_) {
+        shrink();
+    }
 }
 
 SrsRtpNackInfo* SrsRtpNackForReceiver::find(uint16_t seq)
 {
-    std::map<uint16_t, SrsRtpNackInfo>::iterator iter = queue_.find(seq);
+    if (!in_window(seq)) {
+        return NULL;
+    }
 
-    if (iter == queue_.end()) {
+    int index = seq & (capacity_ - 1);
+    if ((bitmap_[index >> 6] & (((uint64_t)1) << (index & 63))) == 0) {
         return NULL;
     }
 
-    return &(iter->second);
+    return &infos_[index];
 }
 
 void SrsRtpNackForReceiver::check_queue_size()
 {
-    if (queue_.size() >= max_queue_size_) {
+    if (size_ >= max_queue_size_) {
         rtp_->notify_nack_list_full();
-        queue_.clear();
+        clear();
     }
 }
 
+size_t SrsRtpNackForReceiver::size()
+{
+    return size_;
+}
+
 void SrsRtpNackForReceiver::get_nack_seqs(SrsRtcpNack& seqs, uint32_t& timeout_nacks)
 {
     // If circuit-breaker is enabled, disable nack.
     if (_srs_circuit_breaker->hybrid_high_water_level()) {
-        queue_.clear();
+        clear();
         ++_srs_pps_snack4->sugar;
         return;
     }
@@ -266,16 +324,50 @@ void SrsRtpNackForReceiver::get_nack_seqs(SrsRtcpNack& seqs, uint32_t& timeout_n
     }
     pre_check_time_ = now;
 
-    std::map<uint16_t, SrsRtpNackInfo>::iterator iter = queue_.begin();
-    while (iter != queue_.end()) {
-        const uint16_t& seq = iter->first;
-        SrsRtpNackInfo& nack_info = iter->second;
+    if (!size_) {
+        return;
+    }
+
+    srs_utime_t nack_interval = srs_max(opts_.min_nack_interval, opts_.nack_interval / 3);
+    if(opts_.nack_interval < 50 * SRS_UTIME_MILLISECONDS){
+        nack_interval = srs_max(opts_.min_nack_interval, opts_.nack_interval);
+    }
+
+    // The PID/BLP pair to build, the BLP is the bitmap of following 16 seqs.
+    uint16_t pid = 0, blp = 0;
+    bool has_pid = false;
+
+    uint16_t seq = begin_;
+    int left = (uint16_t)(end_ - begin_);
+    while (left > 0) {
+        // Skip the received seqs in bitmap word, to find the next lost seq.
+        int index = seq & (capacity_ - 1);
+        int nn = srs_min(64 - (index & 63), left);
+        uint64_t word = bitmap_[index >> 6] >> (index & 63);
+        if (nn < 64) {
+            word &= (((uint64_t)1) << nn) - 1;
+        }
+        if (!word) {
+            seq += nn;
+            left -= nn;
+            continue;
+        }
+
+        int skip = __builtin_ctzll(word);
+        seq += skip;
+        left -= skip;
+        index = seq & (capacity_ - 1);
+
+        SrsRtpNackInfo& nack_info = infos_[index];
 
         int alive_time = now - nack_info.generate_time_;
         if (alive_time > opts_.max_alive_time || nack_info.req_nack_count_ > opts_.max_count) {
             ++timeout_nacks;
             rtp_->notify_drop_seq(seq);
-            queue_.erase(iter++);
+            bitmap_[index >> 6] &= ~(((uint64_t)1) << (index & 63));
+            --size_;
+            ++seq;
+            --left;
             continue;
         }
 
@@ -284,19 +376,32 @@ void SrsRtpNackForReceiver::get_nack_seqs(SrsRtcpNack& seqs, uint32_t& timeout_n
             break;
         }
 
-        srs_utime_t nack_interval = srs_max(opts_.min_nack_interval, opts_.nack_interval / 3);
-        if(opts_.nack_interval < 50 * SRS_UTIME_MILLISECONDS){
-            nack_interval = srs_max(opts_.min_nack_interval, opts_.nack_interval);
-        }
-
         if (now - nack_info.pre_req_nack_time_ >= nack_interval ) {
             ++nack_info.req_nack_count_;
             nack_info.pre_req_nack_time_ = now;
-            seqs.add_lost_sn(seq);
+
+            uint16_t distance = seq - pid;
+            if (has_pid && distance <= 16) {
+                blp |= 1 << (distance - 1);
+            } else {
+                if (has_pid) {
+                    seqs.add_lost_pid_blp(pid, blp);
+                }
+                pid = seq;
+                blp = 0;
+                has_pid = true;
+            }
         }
 
-        ++iter;
+        ++seq;
+        --left;
     }
+
+    if (has_pid) {
+        seqs.add_lost_pid_blp(pid, blp);
+    }
+
+    shrink();
 }
 
 void SrsRtpNackForReceiver::update_rtt(int rtt)
@@ -312,3 +417,68 @@ void SrsRtpNackForReceiver::update_rtt(int rtt)
     opts_.nack_interval = srs_min(opts_.nack_interval, opts_.max_nack_interval);
 }
 
+
+bool SrsRtpNackForReceiver::in_window(uint16_t seq)
+{
+    return size_ && (uint16_t)(seq - begin_) < (uint16_t)(end_ - begin_);
+}
+
+bool SrsRtpNackForReceiver::expand(uint16_t seq)
+{
+    if (!size_) {
+        begin_ = seq;
+        end_ = seq + 1;
+        return true;
+    }
+
+    if (in_window(seq)) {
+        return true;
+    }
+
+    // Newer than the window, move the end.
+    if (srs_rtp_seq_distance(begin_, seq) > 0) {
+        if ((uint16_t)(seq + 1 - begin_) > capacity_) {
+            shrink();
+        }
+        if ((uint16_t)(seq + 1 - begin_) > capacity_) {
+            return false;
+        }
+
+        end_ = seq + 1;
+        return true;
+    }
+
+    // Older than the window, move the begin, the slots out of window are always empty.
+    if ((uint16_t)(end_ - seq) > capacity_) {
+        return false;
+    }
+
+    begin_ = seq;
+    return true;
+}
+
+void SrsRtpNackForReceiver::shrink()
+{
+    if (!size_) {
+        begin_ = end_;
+        return;
+    }
+
+    // There must be a lost seq in window, so it stops before the end.
+    while (begin_ != end_) {
+        int index = begin_ & (capacity_ - 1);
+        uint64_t word = bitmap_[index >> 6] >> (index & 63);
+        if (word) {
+            begin_ += __builtin_ctzll(word);
+            return;
+        }
+        begin_ += 64 - (index & 63);
+    }
+}
+
+void SrsRtpNackForReceiver::clear()
+{
+    memset(bitmap_, 0, sizeof(uint64_t) * (capacity_ / 64));
+    begin_ = end_ = 0;
+    size_ = 0;
+}
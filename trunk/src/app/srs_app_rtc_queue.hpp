@@ -101,11 +101,23 @@ struct SrsRtpNackInfo
     SrsRtpNackInfo();
 };
 
+// The NACK list of receiver, a fixed-capacity ring indexed by seq % capacity, with a loss bitmap to
+// find the lost seqs quickly, so it never allocates for each lost packet like std::map.
+// @remark The window of seqs is [begin_, end_), oldest to newest, should never exceed the capacity.
 class SrsRtpNackForReceiver
 {
 private:
-    // Nack queue, seq order, oldest to newest.
-    std::map<uint16_t, SrsRtpNackInfo, SrsSeqCompareLess> queue_;
+    // The capacity of ring, power of 2, so the slot of seq is seq & (capacity - 1).
+    int capacity_;
+    // The nack info of each slot, only valid when the bit of slot is set in bitmap.
+    SrsRtpNackInfo* infos_;
+    // The loss bitmap, one bit for each slot, set if the seq is lost and waiting for nack.
+    uint64_t* bitmap_;
+    // The window of seqs in ring, [begin_, end_), valid when size_ is not zero.
+    uint16_t begin_;
+    uint16_t end_;
+    // The number of lost seqs in ring.
+    size_t size_;
     // Max nack count.
     size_t max_queue_size_;
     SrsRtpRingBuffer* rtp_;
@@ -122,10 +134,20 @@ public:
     void remove(uint16_t seq);
     SrsRtpNackInfo* find(uint16_t seq);
     void check_queue_size();
+    // Get the number of lost seqs.
+    size_t size();
 public:
     void get_nack_seqs(SrsRtcpNack& seqs, uint32_t& timeout_nacks);
 public:
     void update_rtt(int rtt);
+private:
+    // Whether seq is in the window of ring.
+    bool in_window(uint16_t seq);
+    // Expand the window to include seq, return false if exceed the capacity.
+    bool expand(uint16_t seq);
+    // Advance the begin of window to the oldest lost seq.
+    void shrink();
+    void clear();
 };
 
 #endif
@@ -16,6 +16,7 @@ using namespace std;
 
 #include <srs_kernel_error.hpp>
 #include <srs_kernel_log.hpp>
+#include <srs_protocol_utility.hpp>
 
 // TODO: FIXME: Maybe we should use json.encode to escape it?
 const std::string kCRLF = "\r\n";
@@ -262,6 +263,37 @@ srs_error_t SrsSSRCGroup::encode(std::ostringstream& os)
     return err;
 }
 
+SrsRidInfo::SrsRidInfo()
+{
+}
+
+SrsRidInfo::SrsRidInfo(const std::string& rid, const std::string& direction)
+{
+    rid_ = rid;
+    direction_ = direction;
+}
+
+SrsRidInfo::~SrsRidInfo()
+{
+}
+
+srs_error_t SrsRidInfo::encode(std::ostringstream& os)
+{
+    srs_error_t err = srs_success;
+
+    if (rid_.empty()) {
+        return srs_error_new(ERROR_RTC_SDP_DECODE, "invalid rid");
+    }
+
+    os << "a=rid:" << rid_ << " " << direction_;
+    if (!params_.empty()) {
+        os << " " << params_;
+    }
+    os << kCRLF;
+
+    return err;
+}
+
 SrsMediaPayloadType::SrsMediaPayloadType(int payload_type)
 {
     payload_type_ = payload_type;
@@ -440,6 +472,16 @@ srs_error_t SrsMediaDesc::encode(std::ostringstream& os)
         }
     }
 
+    for (std::vector<SrsRidInfo>::iterator iter = rids_.begin(); iter != rids_.end(); ++iter) {
+        if ((err = iter->encode(os)) != srs_success) {
+            return srs_error_wrap(err, "encode rid failed");
+        }
+    }
+
+    if (!simulcast_rids_.empty()) {
+        os << "a=simulcast:" << simulcast_direction_ << " " << srs_join_vector_string(simulcast_rids_, ";") << kCRLF;
+    }
+
     for (std::vector<SrsSSRCInfo>::iterator iter = ssrc_infos_.begin(); iter != ssrc_infos_.end(); ++iter) {
         SrsSSRCInfo& ssrc_info = *iter;
 
@@ -510,6 +552,10 @@ srs_error_t SrsMediaDesc::parse_attribute(const std::string& content)
         return parse_attr_ssrc(value);
     } else if (attribute == "ssrc-group") {
         return parse_attr_ssrc_group(value);
+    } else if (attribute == "rid") {
+        return parse_attr_rid(value);
+    } else if (attribute == "simulcast") {
+        return parse_attr_simulcast(value);
     } else if (attribute == "rtcp-mux") {
         rtcp_mux_ = true;
     } else if (attribute == "rtcp-rsize") {
@@ -730,6 +776,89 @@ srs_error_t SrsMediaDesc::parse_attr_ssrc_group(const std::string& value)
     return err;
 }
 
+srs_error_t SrsMediaDesc::parse_attr_rid(const std::string& value)
+{
+    srs_error_t err = srs_success;
+    // @see: https://www.rfc-editor.org/rfc/rfc8851#section-10
+    // a=rid:<rid-id> <direction> [pt=<fmt-list>;]<restriction>...
+
+    std::istringstream is(value);
+
+    SrsRidInfo rid;
+    FETCH(is, rid.rid_);
+    FETCH(is, rid.direction_);
+
+    if (rid.direction_ != "send" && rid.direction_ != "recv") {
+        return srs_error_new(ERROR_RTC_SDP_DECODE, "invalid rid line=%s", value.c_str());
+    }
+
+    if (is.tellg() != -1) {
+        rid.params_ = is.str().substr(is.tellg());
+        skip_first_spaces(rid.params_);
+    }
+
+    rids_.push_back(rid);
+
+    return err;
+}
+
+srs_error_t SrsMediaDesc::parse_attr_simulcast(const std::string& value)
+{
+    srs_error_t err = srs_success;
+    // @see: https://www.rfc-editor.org/rfc/rfc8853#section-5.1
+    // a=simulcast:<direction> <rid-id>[,<alt-rid-id>];<rid-id>... [<direction> ...]
+
+    std::istringstream is(value);
+
+    FETCH(is, simulcast_direction_);
+    if (simulcast_direction_ != "send" && simulcast_direction_ != "recv") {
+        return srs_error_new(ERROR_RTC_SDP_DECODE, "invalid simulcast direction=%s", simulcast_direction_.c_str());
+    }
+
+    std::string streams;
+    FETCH(is, streams);
+
+    // We only receive simulcast from publisher, or send to player, never both in one media.
+    std::string other;
+    if (is >> other) {
+        return srs_error_new(ERROR_RTC_SDP_DECODE, "not support bidirectional simulcast line=%s", value.c_str());
+    }
+
+    simulcast_rids_.clear();
+    std::vector<std::string> vec = split_str(streams, ";");
+    for (int i = 0; i < (int)vec.size(); ++i) {
+        // The alternative formats of a layer, for example, "h,h2", we pick the first one which is not paused. The
+        // paused layer starts with ~, which is also a layer to receive, so we pick the first one if all paused.
+        std::vector<std::string> alts = split_str(vec.at(i), ",");
+        std::string rid;
+        bool rid_paused = true;
+        for (int j = 0; j < (int)alts.size(); ++j) {
+            std::string alt = alts.at(j);
+            bool paused = !alt.empty() && alt.at(0) == '~';
+            if (paused) {
+                alt = alt.substr(1);
+            }
+
+            if (alt.empty() || alt.find_first_not_of("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-_") != std::string::npos) {
+                return srs_error_new(ERROR_RTC_SDP_DECODE, "invalid simulcast rid=%s, line=%s", alts.at(j).c_str(), value.c_str());
+            }
+
+            if (rid.empty() || (rid_paused && !paused)) {
+                rid = alt;
+                rid_paused = paused;
+            }
+        }
+
+        simulcast_rids_.push_back(rid);
+    }
+
+    if (simulcast_rids_.empty()) {
+        return srs_error_new(ERROR_RTC_SDP_DECODE, "invalid simulcast line=%s", value.c_str());
+    }
+
+    return err;
+}
+
 SrsSSRCInfo& SrsMediaDesc::fetch_or_create_ssrc_info(uint32_t ssrc)
 {
     for (size_t i = 0; i < ssrc_infos_.size(); ++i) {
@@ -375,14 +375,13 @@ srs_error_t SrsRtcServer::on_udp_packet(SrsUdpMuxSocket* skt)
     bool is_rtp_or_rtcp = srs_is_rtp_or_rtcp((uint8_t*)data, size);
     bool is_rtcp = srs_is_rtcp((uint8_t*)data, size);
 
-    uint64_t fast_id = skt->fast_id();
-    // Try fast id first, if not found, search by long peer id.
-    if (fast_id) {
+    // Find session by the packed address for IPv4 and IPv6 first, if not found, search by the peer id string.
+    const SrsResourceFastKey& fast_id = skt->fast_id();
+    if (!fast_id.empty()) {
         session = (SrsRtcConnection*)_srs_rtc_manager->find_by_fast_id(fast_id);
     }
     if (!session) {
-        string peer_id = skt->peer_id();
-        session = (SrsRtcConnection*)_srs_rtc_manager->find_by_id(peer_id);
+        session = (SrsRtcConnection*)_srs_rtc_manager->find_by_id(skt->peer_id());
     }
 
     if (session) {
@@ -393,7 +392,6 @@ srs_error_t SrsRtcServer::on_udp_packet(SrsUdpMuxSocket* skt)
     // For STUN, the peer address may change.
     if (!is_rtp_or_rtcp && srs_is_stun((uint8_t*)data, size)) {
         ++_srs_pps_rstuns->sugar;
-        string peer_id = skt->peer_id();
 
         // TODO: FIXME: Should support ICE renomination, to switch network between candidates.
         SrsStunPacket ping;
@@ -408,12 +406,12 @@ srs_error_t SrsRtcServer::on_udp_packet(SrsUdpMuxSocket* skt)
         }
 
         srs_info("recv stun packet from %s, fast=%" PRId64 ", use-candidate=%d, ice-controlled=%d, ice-controlling=%d",
-            peer_id.c_str(), fast_id, ping.get_use_candidate(), ping.get_ice_controlled(), ping.get_ice_controlling());
+            skt->peer_id().c_str(), fast_id.id, ping.get_use_candidate(), ping.get_ice_controlled(), ping.get_ice_controlling());
 
         // TODO: FIXME: For ICE trickle, we may get STUN packets before SDP answer, so maybe should response it.
         if (!session) {
             return srs_error_new(ERROR_RTC_STUN, "no session, stun username=%s, peer_id=%s, fast=%" PRId64,
-                ping.get_username().c_str(), peer_id.c_str(), fast_id);
+                ping.get_username().c_str(), skt->peer_id().c_str(), fast_id.id);
         }
 
         // For each binding request, update the UDP socket.
@@ -427,7 +425,7 @@ srs_error_t SrsRtcServer::on_udp_packet(SrsUdpMuxSocket* skt)
     // For DTLS, RTCP or RTP, which does not support peer address changing.
     if (!session) {
         string peer_id = skt->peer_id();
-        return srs_error_new(ERROR_RTC_STUN, "no session, peer_id=%s, fast=%" PRId64, peer_id.c_str(), fast_id);
+        return srs_error_new(ERROR_RTC_STUN, "no session, peer_id=%s, fast=%" PRId64, peer_id.c_str(), fast_id.id);
     }
 
     // Note that we don't(except error) switch to the context of session, for performance issue.
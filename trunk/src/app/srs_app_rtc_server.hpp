@@ -58,6 +58,8 @@ public:
     std::string eip_;
     std::string codec_;
     std::string api_;
+    // For simulcast, the layer by RID specified by player, empty to select layer by bandwidth.
+    std::string layer_;
 
     // Session data.
     std::string local_sdp_str_;
@@ -29,6 +29,7 @@
 #include <srs_app_log.hpp>
 #include <srs_app_threads.hpp>
 #include <srs_app_statistic.hpp>
+#include <srs_core_performance.hpp>
 
 #ifdef SRS_FFMPEG_FIT
 #include <srs_app_rtc_codec.hpp>
@@ -36,6 +37,7 @@
 
 #include <srs_protocol_kbps.hpp>
 #include <srs_protocol_raw_avc.hpp>
+#include <srs_protocol_stream.hpp>
 
 // The NACK sent by us(SFU).
 SrsPps* _srs_pps_snack = NULL;
@@ -71,6 +73,11 @@ const int kVideoSamplerate  = 90000;
 // see @doc https://groups.google.com/g/discuss-webrtc/c/gH5ysR3SoZI
 const int kRtpMaxPayloadSize = kRtpPacketSize - 300;
 
+// For simulcast, the window to measure the bitrate of layers, and the interval to probe the upper layer.
+const srs_utime_t kSimulcastWindow = 1 * SRS_UTIME_SECONDS;
+const srs_utime_t kSimulcastProbeInterval = 5 * SRS_UTIME_SECONDS;
+const srs_utime_t kSimulcastMaxProbeInterval = 60 * SRS_UTIME_SECONDS;
+
 using namespace std;
 
 // TODO: Add this function into SrsRtpMux class.
@@ -307,6 +314,56 @@ SrsRtcSource* SrsRtcSourceManager::fetch(SrsRequest* r)
 
 SrsRtcSourceManager* _srs_rtc_sources = NULL;
 
+srs_error_t srs_rtc_fetch_bridge_source(SrsRequest* r, bool edge, SrsRtcSource** pps)
+{
+    srs_error_t err = srs_success;
+
+    *pps = NULL;
+
+    bool rtc_server_enabled = _srs_config->get_rtc_server_enabled();
+    bool rtc_enabled = _srs_config->get_rtc_enabled(r->vhost);
+    if (!rtc_server_enabled || !rtc_enabled || edge) {
+        return err;
+    }
+
+    SrsRtcSource* rtc = NULL;
+    if ((err = _srs_rtc_sources->fetch_or_create(r, &rtc)) != srs_success) {
+        return srs_error_wrap(err, "create source");
+    }
+
+    if (!rtc->can_publish()) {
+        return srs_error_new(ERROR_SYSTEM_STREAM_BUSY, "rtc stream %s busy", r->get_stream_url().c_str());
+    }
+
+    *pps = rtc;
+    return err;
+}
+
+srs_error_t srs_rtc_bridge_live_source(SrsRequest* r, bool edge, SrsLiveSource* source)
+{
+    srs_error_t err = srs_success;
+
+    SrsRtcSource* rtc = NULL;
+    if ((err = srs_rtc_fetch_bridge_source(r, edge, &rtc)) != srs_success) {
+        return srs_error_wrap(err, "rtc source");
+    }
+
+    // Bridge to RTC streaming, the audio is transcoded to Opus by FFmpeg.
+#ifdef SRS_FFMPEG_FIT
+    if (rtc) {
+        SrsRtcFromRtmpBridge* bridge = new SrsRtcFromRtmpBridge(rtc);
+        if ((err = bridge->initialize(r)) != srs_success) {
+            srs_freep(bridge);
+            return srs_error_wrap(err, "bridge init");
+        }
+
+        source->set_bridge(bridge);
+    }
+#endif
+
+    return err;
+}
+
 ISrsRtcPublishStream::ISrsRtcPublishStream()
 {
 }
@@ -629,6 +686,11 @@ srs_error_t SrsRtcSource::on_rtp(SrsRtpPacket* pkt)
         return err;
     }
 
+    // Encode the payload once for all players, who only encode the header then.
+    if (!consumers.empty() && (err = pkt->cache_payload()) != srs_success) {
+        return srs_error_wrap(err, "cache payload");
+    }
+
     for (int i = 0; i < (int)consumers.size(); i++) {
         SrsRtcConsumer* consumer = consumers.at(i);
         if ((err = consumer->enqueue(pkt->copy())) != srs_success) {
@@ -636,7 +698,7 @@ srs_error_t SrsRtcSource::on_rtp(SrsRtpPacket* pkt)
         }
     }
 
-    if (bridge_ && (err = bridge_->on_rtp(pkt)) != srs_success) {
+    if (bridge_ && is_bridge_layer(pkt) && (err = bridge_->on_rtp(pkt)) != srs_success) {
         return srs_error_wrap(err, "bridge consume message");
     }
 
@@ -684,6 +746,61 @@ std::vector<SrsRtcTrackDescription*> SrsRtcSource::get_track_desc(std::string ty
     return track_descs;
 }
 
+void SrsRtcSource::bind_simulcast_layer(std::string id, std::string rid, uint32_t ssrc)
+{
+    if (!stream_desc_) {
+        return;
+    }
+
+    SrsRtcTrackDescription* desc = stream_desc_->find_track_description_by_rid(id, rid);
+    if (desc) {
+        desc->ssrc_ = ssrc;
+    }
+}
+
+SrsRtcTrackDescription* SrsRtcSource::find_simulcast_layer(uint32_t ssrc)
+{
+    if (!stream_desc_ || !ssrc) {
+        return NULL;
+    }
+
+    for (int i = 0; i < (int)stream_desc_->video_track_descs_.size(); ++i) {
+        SrsRtcTrackDescription* desc = stream_desc_->video_track_descs_.at(i);
+        if (!desc->rid_.empty() && desc->ssrc_ == ssrc) {
+            return desc;
+        }
+    }
+
+    return NULL;
+}
+
+bool SrsRtcSource::is_bridge_layer(SrsRtpPacket* pkt)
+{
+    if (pkt->is_audio()) {
+        return true;
+    }
+
+    SrsRtcTrackDescription* desc = find_simulcast_layer(pkt->header.get_ssrc());
+    return !desc || is_bridge_layer(desc);
+}
+
+bool SrsRtcSource::is_bridge_layer(SrsRtcTrackDescription* desc)
+{
+    if (desc->rid_.empty()) {
+        return true;
+    }
+
+    // The layers share the same track id, and the first one is picked.
+    for (int i = 0; i < (int)stream_desc_->video_track_descs_.size(); ++i) {
+        SrsRtcTrackDescription* layer = stream_desc_->video_track_descs_.at(i);
+        if (layer->id_ == desc->id_ && !layer->rid_.empty()) {
+            return layer == desc;
+        }
+    }
+
+    return false;
+}
+
 srs_error_t SrsRtcSource::on_timer(srs_utime_t interval)
 {
     srs_error_t err = srs_success;
@@ -703,6 +820,12 @@ srs_error_t SrsRtcSource::on_timer(srs_utime_t interval)
 
     for (int i = 0; i < (int)stream_desc_->video_track_descs_.size(); i++) {
         SrsRtcTrackDescription* desc = stream_desc_->video_track_descs_.at(i);
+
+        // Only request key frame for the layer consumed by bridge.
+        if (!is_bridge_layer(desc)) {
+            continue;
+        }
+
         srs_trace("RTC: to rtmp bridge request key frame, ssrc=%u, publisher cid=%s", desc->ssrc_, publish_stream_->context_id().c_str());
         publish_stream_->request_keyframe(desc->ssrc_, publish_stream_->context_id());
     }
@@ -710,216 +833,854 @@ srs_error_t SrsRtcSource::on_timer(srs_utime_t interval)
     return err;
 }
 
-#ifdef SRS_FFMPEG_FIT
-
-SrsRtcFromRtmpBridge::SrsRtcFromRtmpBridge(SrsRtcSource* source)
+ISrsRtcFrameBuilderHandler::ISrsRtcFrameBuilderHandler()
 {
-    req = NULL;
-    source_ = source;
-    format = new SrsRtmpFormat();
-    codec_ = new SrsAudioTranscoder();
-    latest_codec_ = SrsAudioCodecIdForbidden;
-    rtmp_to_rtc = false;
-    keep_bframe = false;
-    merge_nalus = false;
-    meta = new SrsMetaCache();
-    audio_sequence = 0;
-    video_sequence = 0;
-
-    // audio track ssrc
-    if (true) {
-        std::vector<SrsRtcTrackDescription*> descs = source->get_track_desc("audio", "opus");
-        if (!descs.empty()) {
-            audio_ssrc = descs.at(0)->ssrc_;
-        }
-        // Note we must use the PT of source, see https://github.com/ossrs/srs/pull/3079
-        audio_payload_type_ = descs.empty() ? kAudioPayloadType : descs.front()->media_->pt_;
-    }
-
-    // video track ssrc
-    if (true) {
-        std::vector<SrsRtcTrackDescription*> descs = source->get_track_desc("video", "H264");
-        if (!descs.empty()) {
-            video_ssrc = descs.at(0)->ssrc_;
-        }
-        // Note we must use the PT of source, see https://github.com/ossrs/srs/pull/3079
-        video_payload_type_ = descs.empty() ? kVideoPayloadType : descs.front()->media_->pt_;
-    }
 }
 
-SrsRtcFromRtmpBridge::~SrsRtcFromRtmpBridge()
+ISrsRtcFrameBuilderHandler::~ISrsRtcFrameBuilderHandler()
 {
-    srs_freep(format);
-    srs_freep(codec_);
-    srs_freep(meta);
 }
 
-srs_error_t SrsRtcFromRtmpBridge::initialize(SrsRequest* r)
+SrsRtcFrameBuilder::SrsRtcFrameBuilder(ISrsRtcFrameBuilderHandler* handler)
 {
-    srs_error_t err = srs_success;
-
-    req = r;
-    rtmp_to_rtc = _srs_config->get_rtc_from_rtmp(req->vhost);
-
-    if (rtmp_to_rtc) {
-        if ((err = format->initialize()) != srs_success) {
-            return srs_error_wrap(err, "format initialize");
-        }
-
-        // Setup the SPS/PPS parsing strategy.
-        format->try_annexb_first = _srs_config->try_annexb_first(r->vhost);
-    }
+    handler_ = handler;
+    jitter_ = 300 * SRS_UTIME_MILLISECONDS;
 
-    keep_bframe = _srs_config->get_rtc_keep_bframe(req->vhost);
-    merge_nalus = _srs_config->get_rtc_server_merge_nalus();
-    srs_trace("RTC bridge from RTMP, rtmp2rtc=%d, keep_bframe=%d, merge_nalus=%d",
-              rtmp_to_rtc, keep_bframe, merge_nalus);
+    capacity_ = SRS_PERF_RTC_FRAME_BUILDER_SLOTS;
+    slots_ = new SrsRtcFrameSlot[capacity_];
+    memset(slots_, 0, sizeof(SrsRtcFrameSlot) * capacity_);
 
-    return err;
+    waiting_keyframe_ = true;
+    ssrc_ = 0;
+    head_sn_ = cursor_sn_ = highest_sn_ = 0;
+    blocked_at_ = 0;
+    stalled_ = false;
+    first_frame_ = false;
+    reset_frame();
 }
 
-srs_error_t SrsRtcFromRtmpBridge::on_publish()
+SrsRtcFrameBuilder::~SrsRtcFrameBuilder()
 {
-    srs_error_t err = srs_success;
-
-    if (!rtmp_to_rtc) {
-        return err;
-    }
-
-    // TODO: FIXME: Should sync with bridge?
-    if ((err = source_->on_publish()) != srs_success) {
-        return srs_error_wrap(err, "source publish");
-    }
-
-    // Reset the metadata cache, to make VLC happy when disable/enable stream.
-    // @see https://github.com/ossrs/srs/issues/1630#issuecomment-597979448
-    meta->clear();
-
-    return err;
+    reset();
+    srs_freepa(slots_);
 }
 
-void SrsRtcFromRtmpBridge::on_unpublish()
+void SrsRtcFrameBuilder::set_jitter(srs_utime_t v)
 {
-    if (!rtmp_to_rtc) {
-        return;
-    }
-
-    // Reset the metadata cache, to make VLC happy when disable/enable stream.
-    // @see https://github.com/ossrs/srs/issues/1630#issuecomment-597979448
-    meta->update_previous_vsh();
-    meta->update_previous_ash();
-
-    // @remark This bridge might be disposed here, so never use it.
-    // TODO: FIXME: Should sync with bridge?
-    source_->on_unpublish();
+    jitter_ = v;
 }
 
-srs_error_t SrsRtcFromRtmpBridge::on_audio(SrsSharedPtrMessage* msg)
+srs_error_t SrsRtcFrameBuilder::on_rtp(SrsRtpPacket* pkt, srs_utime_t now)
 {
     srs_error_t err = srs_success;
 
-    if (!rtmp_to_rtc) {
+    if (!pkt->payload()) {
         return err;
     }
 
-    // TODO: FIXME: Support parsing OPUS for RTC.
-    if ((err = format->on_audio(msg)) != srs_success) {
-        return srs_error_wrap(err, "format consume audio");
+    // Ignore the other streams, for example, the other simulcast layers, even the keyframe, so we never send the
+    // SPS/PPS of other streams. We follow the stream of the first keyframe.
+    if (ssrc_ && pkt->header.get_ssrc() != ssrc_) {
+        return err;
     }
 
-    // Try to init codec when startup or codec changed.
-    if (format->acodec && (err = init_codec(format->acodec->id)) != srs_success) {
-        return srs_error_wrap(err, "init codec");
+    bool keyframe = pkt->is_keyframe();
+    if (keyframe && (err = on_sequence_header(pkt)) != srs_success) {
+        return srs_error_wrap(err, "sequence header");
     }
 
-    // Ignore if no format->acodec, it means the codec is not parsed, or unknown codec.
-    // @issue https://github.com/ossrs/srs/issues/1506#issuecomment-562079474
-    if (!format->acodec) {
-        return err;
+    uint16_t sn = pkt->header.get_sequence();
+    if (waiting_keyframe_) {
+        if (!keyframe) {
+            return err;
+        }
+        resync(pkt);
+        return scan(now);
     }
 
-    // ts support audio codec: aac/mp3
-    SrsAudioCodecId acodec = format->acodec->id;
-    if (acodec != SrsAudioCodecIdAAC && acodec != SrsAudioCodecIdMP3) {
+    int16_t distance = srs_rtp_seq_distance(head_sn_, sn);
+    if (distance < 0) {
+        // The reordered packet of first frame, before the keyframe packet we resync at, so we move the head
+        // backward to build the whole frame.
+        SrsRtpPacket* head = slots_[head_sn_ & (capacity_ - 1)].pkt;
+        bool same_frame = first_frame_ && head && head->header.get_timestamp() == pkt->header.get_timestamp();
+        if (!same_frame || srs_rtp_seq_distance(sn, highest_sn_) >= capacity_) {
+            return err;
+        }
+        head_sn_ = cursor_sn_ = sn;
+        stalled_ = false;
+        reset_frame();
+    } else if (distance >= capacity_) {
+        // Too many packets lost, we should never wait for them.
+        srs_warn("RTC: frame builder overflow, head=%hu, sn=%hu, keyframe=%d", head_sn_, sn, keyframe);
+        reset();
+        if (keyframe) {
+            resync(pkt);
+            return scan(now);
+        }
         return err;
+    } else if (keyframe && blocked_at_ && pkt->header.get_timestamp() != frame_ts_) {
+        // Blocked by lost packet, but there is a new keyframe, so we drop the old frames and start from it.
+        srs_warn("RTC: frame builder resync, head=%hu, cursor=%hu, sn=%hu", head_sn_, cursor_sn_, sn);
+        reset();
+        resync(pkt);
+        return scan(now);
     }
 
-    // ignore sequence header
-    srs_assert(format->audio);
+    SrsRtcFrameSlot& slot = slots_[sn & (capacity_ - 1)];
+    if (slot.pkt) {
+        // Duplicated packet, for example, the NACK retransmission after the packet arrived.
+        return err;
+    }
 
-    if (format->acodec->id == SrsAudioCodecIdMP3) {
-        return transcode(format->audio);
+    slot.sn = sn;
+    slot.pkt = pkt->copy();
+    if (srs_rtp_seq_distance(highest_sn_, sn) > 0) {
+        highest_sn_ = sn;
     }
 
-    // When drop aac audio packet, never transcode.
-    if (acodec != SrsAudioCodecIdAAC) {
+    return scan(now);
+}
+
+srs_error_t SrsRtcFrameBuilder::on_sequence_header(SrsRtpPacket* pkt)
+{
+    srs_error_t err = srs_success;
+
+    // TODO: handle sps and pps in 2 rtp packets
+    SrsRtpSTAPPayload* stap_payload = dynamic_cast<SrsRtpSTAPPayload*>(pkt->payload());
+    if (!stap_payload) {
         return err;
     }
 
-    char* adts_audio = NULL;
-    int nn_adts_audio = 0;
-    // TODO: FIXME: Reserve 7 bytes header when create shared message.
-    if ((err = aac_raw_append_adts_header(msg, format, &adts_audio, &nn_adts_audio)) != srs_success) {
-        return srs_error_wrap(err, "aac append header");
+    SrsSample* sps = stap_payload->get_sps();
+    SrsSample* pps = stap_payload->get_pps();
+    if (NULL == sps || NULL == pps) {
+        return srs_error_new(ERROR_RTC_RTP_MUXER, "no sps or pps in stap-a rtp. sps: %p, pps:%p", sps, pps);
     }
 
-    if (!adts_audio) {
-        return err;
+    // h264 raw to h264 packet.
+    std::string sh;
+    SrsRawH264Stream* avc = new SrsRawH264Stream();
+    SrsAutoFree(SrsRawH264Stream, avc);
+
+    if ((err = avc->mux_sequence_header(string(sps->bytes, sps->size), string(pps->bytes, pps->size), sh)) != srs_success) {
+        return srs_error_wrap(err, "mux sequence header");
     }
 
-    SrsAudioFrame aac;
-    aac.dts = format->audio->dts;
-    aac.cts = format->audio->cts;
-    if ((err = aac.add_sample(adts_audio, nn_adts_audio)) == srs_success) {
-        // If OK, transcode the AAC to Opus and consume it.
-        err = transcode(&aac);
+    // h264 packet to flv packet.
+    char* flv = NULL;
+    int nb_flv = 0;
+    if ((err = avc->mux_avc2flv(sh, SrsVideoAvcFrameTypeKeyFrame, SrsVideoAvcFrameTraitSequenceHeader, pkt->get_avsync_time(),
+        pkt->get_avsync_time(), &flv, &nb_flv)) != srs_success) {
+        return srs_error_wrap(err, "avc to flv");
     }
 
-    srs_freepa(adts_audio);
+    SrsMessageHeader header;
+    header.initialize_video(nb_flv, pkt->get_avsync_time(), 1);
+    SrsCommonMessage rtmp;
+    if ((err = rtmp.create(&header, flv, nb_flv)) != srs_success) {
+        return srs_error_wrap(err, "create rtmp");
+    }
+
+    if ((err = handler_->on_frame(&rtmp)) != srs_success) {
+        return srs_error_wrap(err, "on sequence header");
+    }
 
     return err;
 }
 
-srs_error_t SrsRtcFromRtmpBridge::init_codec(SrsAudioCodecId codec)
+srs_error_t SrsRtcFrameBuilder::scan(srs_utime_t now)
 {
     srs_error_t err = srs_success;
 
-    // Ignore if not changed.
-    if (latest_codec_ == codec) return err;
+    // Each packet is scanned only once, because the cursor never moves backward, except the head of first frame
+    // moves backward by reordered packet.
+    while (!waiting_keyframe_ && !stalled_) {
+        SrsRtcFrameSlot& slot = slots_[cursor_sn_ & (capacity_ - 1)];
+        if (!slot.pkt || slot.sn != cursor_sn_) {
+            break;
+        }
 
-    // Create a new codec.
-    srs_freep(codec_);
-    codec_ = new SrsAudioTranscoder();
+        SrsRtpPacket* pkt = slot.pkt;
+        uint32_t ts = pkt->header.get_timestamp();
 
-    // Initialize the codec according to the codec in stream.
-    int bitrate = 48000; // The output bitrate in bps.
-    if ((err = codec_->initialize(codec, SrsAudioCodecIdOpus, kAudioChannel, kAudioSamplerate, bitrate)) != srs_success) {
-        return srs_error_wrap(err, "init codec=%d", codec);
+        // The previous frame is finished without marker, when got the packet of next frame.
+        if (has_frame_ts_ && ts != frame_ts_) {
+            if ((err = build_frame(cursor_sn_)) != srs_success) {
+                return srs_error_wrap(err, "build frame");
+            }
+            continue;
+        }
+
+        if (!has_frame_ts_) {
+            has_frame_ts_ = true;
+            frame_ts_ = ts;
+        }
+        keyframe_ = keyframe_ || pkt->is_keyframe();
+
+        SrsRtpFUAPayload2* fua_payload = dynamic_cast<SrsRtpFUAPayload2*>(pkt->payload());
+        SrsRtpSTAPPayload* stap_payload = fua_payload ? NULL : dynamic_cast<SrsRtpSTAPPayload*>(pkt->payload());
+        SrsRtpRawPayload* raw_payload = (fua_payload || stap_payload) ? NULL : dynamic_cast<SrsRtpRawPayload*>(pkt->payload());
+        if (fua_payload) {
+            if (fua_payload->start) {
+                corrupt_ = corrupt_ || fua_open_;
+                fua_open_ = true;
+                nb_payload_ += 4 + 1;
+            } else {
+                corrupt_ = corrupt_ || !fua_open_;
+            }
+            nb_payload_ += fua_payload->size;
+            if (fua_payload->end) {
+                fua_open_ = false;
+            }
+        } else if (stap_payload) {
+            for (int i = 0; i < (int)stap_payload->nalus.size(); ++i) {
+                SrsSample* sample = stap_payload->nalus.at(i);
+                if (sample->size > 0) {
+                    nb_payload_ += 4 + sample->size;
+                }
+            }
+        } else if (raw_payload && raw_payload->nn_payload > 0) {
+            nb_payload_ += 4 + raw_payload->nn_payload;
+        }
+
+        cursor_sn_++;
+        if (pkt->header.get_marker()) {
+            if ((err = build_frame(cursor_sn_)) != srs_success) {
+                return srs_error_wrap(err, "build frame");
+            }
+        }
     }
 
-    // Update the latest codec in stream.
-    if (latest_codec_ == SrsAudioCodecIdForbidden) {
-        srs_trace("RTMP2RTC: Init audio codec to %d(%s)", codec, srs_audio_codec_id2str(codec).c_str());
-    } else {
-        srs_trace("RTMP2RTC: Switch audio codec %d(%s) to %d(%s)", latest_codec_, srs_audio_codec_id2str(latest_codec_).c_str(),
-            codec, srs_audio_codec_id2str(codec).c_str());
+    if (waiting_keyframe_ || (!stalled_ && srs_rtp_seq_distance(cursor_sn_, highest_sn_) < 0)) {
+        blocked_at_ = 0;
+        return err;
+    }
+
+    // Blocked by lost packet, wait for the NACK retransmission.
+    if (!blocked_at_) {
+        blocked_at_ = now;
+    } else if (now - blocked_at_ >= jitter_) {
+        srs_warn("RTC: frame builder drop frames, head=%hu, lost=%hu, highest=%hu, wait=%dms", head_sn_, cursor_sn_,
+            highest_sn_, srsu2msi(now - blocked_at_));
+        reset();
     }
-    latest_codec_ = codec;
 
     return err;
 }
 
-srs_error_t SrsRtcFromRtmpBridge::transcode(SrsAudioFrame* audio)
+srs_error_t SrsRtcFrameBuilder::build_frame(uint16_t end)
 {
     srs_error_t err = srs_success;
 
-    std::vector<SrsAudioFrame *> out_audios;
-    if ((err = codec_->transcode(audio, out_audios)) != srs_success) {
-        return srs_error_wrap(err, "recode error");
-    }
+    SrsRtpPacket* head = slots_[head_sn_ & (capacity_ - 1)].pkt;
+    srs_assert(head);
 
-    // Save OPUS packets in shared message.
-    if (out_audios.empty()) {
+    // The first frame might be incomplete, because we resync at a reordered packet of keyframe, so wait for the
+    // packets before the head. For other frames, it's not decodable, so are the following frames, until the next
+    // keyframe.
+    if ((corrupt_ || fua_open_) && first_frame_) {
+        stalled_ = true;
+        return err;
+    }
+    if (corrupt_ || fua_open_) {
+        srs_warn("RTC: frame builder drop corrupt frame, head=%hu, end=%hu", head_sn_, end);
+        reset();
+        return err;
+    }
+
+    // type_codec1 + avc_type + composition time + nalu size + nalu
+    SrsCommonMessage rtmp;
+    if (nb_payload_ > 0) {
+        int nb_payload = 1 + 1 + 3 + nb_payload_;
+        rtmp.header.initialize_video(nb_payload, head->get_avsync_time(), 1);
+        rtmp.create_payload(nb_payload);
+        rtmp.size = nb_payload;
+    }
+
+    char* p = rtmp.payload;
+    if (p) {
+        *p++ = keyframe_ ? 0x17 : 0x27; // type(4 bits): key or inter frame; code(4bits): avc
+        *p++ = 0x01; // avc_type: nalu
+        *p++ = 0x0;  // composition time
+        *p++ = 0x0;
+        *p++ = 0x0;
+    }
+
+    // Gather the NALUs to message, and free the packets.
+    char* nalu = NULL;
+    for (uint16_t sn = head_sn_; sn != end; ++sn) {
+        SrsRtcFrameSlot& slot = slots_[sn & (capacity_ - 1)];
+        SrsRtpPacket* pkt = slot.pkt;
+        slot.pkt = NULL;
+        SrsAutoFree(SrsRtpPacket, pkt);
+
+        if (!p) {
+            continue;
+        }
+
+        SrsRtpFUAPayload2* fua_payload = dynamic_cast<SrsRtpFUAPayload2*>(pkt->payload());
+        if (fua_payload) {
+            if (fua_payload->start) {
+                // Skip 4 bytes to write the NALU size when got the end fragment.
+                nalu = p;
+                p += 4;
+                *p++ = fua_payload->nri | fua_payload->nalu_type;
+            }
+            memcpy(p, fua_payload->payload, fua_payload->size);
+            p += fua_payload->size;
+            if (fua_payload->end) {
+                SrsBuffer b(nalu, 4);
+                b.write_4bytes((int)(p - nalu - 4));
+            }
+            continue;
+        }
+
+        SrsRtpSTAPPayload* stap_payload = dynamic_cast<SrsRtpSTAPPayload*>(pkt->payload());
+        if (stap_payload) {
+            for (int i = 0; i < (int)stap_payload->nalus.size(); ++i) {
+                SrsSample* sample = stap_payload->nalus.at(i);
+                if (sample->size > 0) {
+                    SrsBuffer b(p, 4);
+                    b.write_4bytes(sample->size);
+                    memcpy(p + 4, sample->bytes, sample->size);
+                    p += 4 + sample->size;
+                }
+            }
+            continue;
+        }
+
+        SrsRtpRawPayload* raw_payload = dynamic_cast<SrsRtpRawPayload*>(pkt->payload());
+        if (raw_payload && raw_payload->nn_payload > 0) {
+            SrsBuffer b(p, 4);
+            b.write_4bytes(raw_payload->nn_payload);
+            memcpy(p + 4, raw_payload->payload, raw_payload->nn_payload);
+            p += 4 + raw_payload->nn_payload;
+        }
+    }
+
+    head_sn_ = end;
+    first_frame_ = false;
+    reset_frame();
+
+    if (rtmp.payload && (err = handler_->on_frame(&rtmp)) != srs_success) {
+        return srs_error_wrap(err, "on frame");
+    }
+
+    return err;
+}
+
+void SrsRtcFrameBuilder::resync(SrsRtpPacket* pkt)
+{
+    uint16_t sn = pkt->header.get_sequence();
+
+    waiting_keyframe_ = false;
+    ssrc_ = pkt->header.get_ssrc();
+    head_sn_ = cursor_sn_ = highest_sn_ = sn;
+    blocked_at_ = 0;
+    stalled_ = false;
+    first_frame_ = true;
+    reset_frame();
+
+    SrsRtcFrameSlot& slot = slots_[sn & (capacity_ - 1)];
+    slot.sn = sn;
+    slot.pkt = pkt->copy();
+}
+
+void SrsRtcFrameBuilder::reset()
+{
+    for (int i = 0; i < capacity_; i++) {
+        srs_freep(slots_[i].pkt);
+    }
+
+    waiting_keyframe_ = true;
+    blocked_at_ = 0;
+    stalled_ = false;
+    first_frame_ = false;
+    reset_frame();
+}
+
+void SrsRtcFrameBuilder::reset_frame()
+{
+    has_frame_ts_ = false;
+    frame_ts_ = 0;
+    keyframe_ = false;
+    nb_payload_ = 0;
+    fua_open_ = false;
+    corrupt_ = false;
+}
+
+SrsRtcH264Packager::SrsRtcH264Packager(SrsRtcSource* source)
+{
+    source_ = source;
+    sequence_ = 0;
+    ssrc_ = 0;
+
+    std::vector<SrsRtcTrackDescription*> descs = source->get_track_desc("video", "H264");
+    if (!descs.empty()) {
+        ssrc_ = descs.at(0)->ssrc_;
+    }
+    // Note we must use the PT of source, see https://github.com/ossrs/srs/pull/3079
+    payload_type_ = descs.empty() ? kVideoPayloadType : descs.front()->media_->pt_;
+}
+
+SrsRtcH264Packager::~SrsRtcH264Packager()
+{
+}
+
+srs_error_t SrsRtcH264Packager::package_stap_a(uint32_t timestamp, const char* sps, int nb_sps, const char* pps, int nb_pps, SrsRtpPacket* pkt)
+{
+    srs_error_t err = srs_success;
+
+    if (nb_sps <= 0 || nb_pps <= 0) {
+        return srs_error_new(ERROR_RTC_RTP_MUXER, "sps/pps empty");
+    }
+
+    pkt->header.set_payload_type(payload_type_);
+    pkt->header.set_ssrc(ssrc_);
+    pkt->frame_type = SrsFrameTypeVideo;
+    pkt->nalu_type = (SrsAvcNaluType)kStapA;
+    pkt->header.set_marker(false);
+    pkt->header.set_sequence(sequence_++);
+    pkt->header.set_timestamp(timestamp);
+
+    SrsRtpSTAPPayload* stap = new SrsRtpSTAPPayload();
+    pkt->set_payload(stap, SrsRtspPacketPayloadTypeSTAP);
+
+    uint8_t header = sps[0];
+    stap->nri = (SrsAvcNaluType)header;
+
+    // Copy the SPS/PPS bytes, because it may change.
+    char* payload = pkt->wrap(nb_sps + nb_pps);
+
+    stap->nalus.push_back(new SrsSample(payload, nb_sps));
+    memcpy(payload, sps, nb_sps);
+    payload += nb_sps;
+
+    stap->nalus.push_back(new SrsSample(payload, nb_pps));
+    memcpy(payload, pps, nb_pps);
+
+    srs_info("RTC STAP-A seq=%u, sps %d, pps %d bytes", pkt->header.get_sequence(), nb_sps, nb_pps);
+
+    return err;
+}
+
+srs_error_t SrsRtcH264Packager::package_samples(SrsSharedPtrMessage* msg, uint32_t timestamp, const vector<SrsSample*>& samples, vector<SrsRtpPacket*>& pkts)
+{
+    srs_error_t err = srs_success;
+
+    for (int i = 0; i < (int)samples.size(); i++) {
+        SrsSample* sample = samples[i];
+
+        // We always ignore bframe here, if config to discard bframe,
+        // the bframe flag will not be set.
+        if (sample->bframe) {
+            continue;
+        }
+
+        if (sample->size <= kRtpMaxPayloadSize) {
+            if ((err = package_single_nalu(msg, timestamp, sample, pkts)) != srs_success) {
+                return srs_error_wrap(err, "package single nalu");
+            }
+        } else {
+            if ((err = package_fu_a(msg, timestamp, sample, kRtpMaxPayloadSize, pkts)) != srs_success) {
+                return srs_error_wrap(err, "package fu-a");
+            }
+        }
+    }
+
+    if (!pkts.empty()) {
+        pkts.back()->header.set_marker(true);
+    }
+
+    return err;
+}
+
+srs_error_t SrsRtcH264Packager::package_nalus(SrsSharedPtrMessage* msg, uint32_t timestamp, const vector<SrsSample*>& samples, vector<SrsRtpPacket*>& pkts)
+{
+    srs_error_t err = srs_success;
+
+    SrsRtpRawNALUs* raw = new SrsRtpRawNALUs();
+    SrsAvcNaluType first_nalu_type = SrsAvcNaluTypeReserved;
+
+    for (int i = 0; i < (int)samples.size(); i++) {
+        SrsSample* sample = samples[i];
+
+        // We always ignore bframe here, if config to discard bframe,
+        // the bframe flag will not be set.
+        if (sample->bframe) {
+            continue;
+        }
+
+        if (!sample->size) {
+            continue;
+        }
+
+        if (first_nalu_type == SrsAvcNaluTypeReserved) {
+            first_nalu_type = SrsAvcNaluType((uint8_t)(sample->bytes[0] & kNalTypeMask));
+        }
+
+        raw->push_back(sample->copy());
+    }
+
+    // Ignore empty.
+    int nn_bytes = raw->nb_bytes();
+    if (nn_bytes <= 0) {
+        srs_freep(raw);
+        return err;
+    }
+
+    if (nn_bytes < kRtpMaxPayloadSize) {
+        // Package NALUs in a single RTP packet.
+        SrsRtpPacket* pkt = new SrsRtpPacket();
+        pkts.push_back(pkt);
+
+        pkt->header.set_payload_type(payload_type_);
+        pkt->header.set_ssrc(ssrc_);
+        pkt->frame_type = SrsFrameTypeVideo;
+        pkt->nalu_type = (SrsAvcNaluType)first_nalu_type;
+        pkt->header.set_sequence(sequence_++);
+        pkt->header.set_timestamp(timestamp);
+        pkt->set_payload(raw, SrsRtspPacketPayloadTypeNALU);
+        pkt->wrap(msg);
+    } else {
+        // We must free it, should never use RTP packets to free it,
+        // because more than one RTP packet will refer to it.
+        SrsAutoFree(SrsRtpRawNALUs, raw);
+
+        // Package NALUs in FU-A RTP packets.
+        int fu_payload_size = kRtpMaxPayloadSize;
+
+        // The first byte is store in FU-A header.
+        uint8_t header = raw->skip_first_byte();
+        uint8_t nal_type = header & kNalTypeMask;
+        int nb_left = nn_bytes - 1;
+
+        int num_of_packet = 1 + (nn_bytes - 1) / fu_payload_size;
+        for (int i = 0; i < num_of_packet; ++i) {
+            int packet_size = srs_min(nb_left, fu_payload_size);
+
+            SrsRtpFUAPayload* fua = new SrsRtpFUAPayload();
+            if ((err = raw->read_samples(fua->nalus, packet_size)) != srs_success) {
+                srs_freep(fua);
+                return srs_error_wrap(err, "read samples %d bytes, left %d, total %d", packet_size, nb_left, nn_bytes);
+            }
+
+            SrsRtpPacket* pkt = new SrsRtpPacket();
+            pkts.push_back(pkt);
+
+            pkt->header.set_payload_type(payload_type_);
+            pkt->header.set_ssrc(ssrc_);
+            pkt->frame_type = SrsFrameTypeVideo;
+            pkt->nalu_type = (SrsAvcNaluType)kFuA;
+            pkt->header.set_sequence(sequence_++);
+            pkt->header.set_timestamp(timestamp);
+
+            fua->nri = (SrsAvcNaluType)header;
+            fua->nalu_type = (SrsAvcNaluType)nal_type;
+            fua->start = bool(i == 0);
+            fua->end = bool(i == num_of_packet - 1);
+
+            pkt->set_payload(fua, SrsRtspPacketPayloadTypeFUA);
+            pkt->wrap(msg);
+
+            nb_left -= packet_size;
+        }
+    }
+
+    return err;
+}
+
+// Single NAL Unit Packet @see https://tools.ietf.org/html/rfc6184#section-5.6
+srs_error_t SrsRtcH264Packager::package_single_nalu(SrsSharedPtrMessage* msg, uint32_t timestamp, SrsSample* sample, vector<SrsRtpPacket*>& pkts)
+{
+    srs_error_t err = srs_success;
+
+    SrsRtpPacket* pkt = new SrsRtpPacket();
+    pkts.push_back(pkt);
+
+    pkt->header.set_payload_type(payload_type_);
+    pkt->header.set_ssrc(ssrc_);
+    pkt->frame_type = SrsFrameTypeVideo;
+    pkt->nalu_type = (SrsAvcNaluType)(sample->bytes[0] & kNalTypeMask);
+    pkt->header.set_sequence(sequence_++);
+    pkt->header.set_timestamp(timestamp);
+
+    SrsRtpRawPayload* raw = new SrsRtpRawPayload();
+    pkt->set_payload(raw, SrsRtspPacketPayloadTypeRaw);
+
+    raw->payload = sample->bytes;
+    raw->nn_payload = sample->size;
+
+    pkt->wrap(msg);
+
+    return err;
+}
+
+srs_error_t SrsRtcH264Packager::package_fu_a(SrsSharedPtrMessage* msg, uint32_t timestamp, SrsSample* sample, int fu_payload_size, vector<SrsRtpPacket*>& pkts)
+{
+    srs_error_t err = srs_success;
+
+    char* p = sample->bytes + 1;
+    int nb_left = sample->size - 1;
+    uint8_t header = sample->bytes[0];
+    uint8_t nal_type = header & kNalTypeMask;
+
+    int num_of_packet = 1 + (nb_left - 1) / fu_payload_size;
+    for (int i = 0; i < num_of_packet; ++i) {
+        int packet_size = srs_min(nb_left, fu_payload_size);
+
+        SrsRtpPacket* pkt = new SrsRtpPacket();
+        pkts.push_back(pkt);
+
+        pkt->header.set_payload_type(payload_type_);
+        pkt->header.set_ssrc(ssrc_);
+        pkt->frame_type = SrsFrameTypeVideo;
+        pkt->nalu_type = (SrsAvcNaluType)kFuA;
+        pkt->header.set_sequence(sequence_++);
+        pkt->header.set_timestamp(timestamp);
+
+        SrsRtpFUAPayload2* fua = new SrsRtpFUAPayload2();
+        pkt->set_payload(fua, SrsRtspPacketPayloadTypeFUA2);
+
+        fua->nri = (SrsAvcNaluType)header;
+        fua->nalu_type = (SrsAvcNaluType)nal_type;
+        fua->start = bool(i == 0);
+        fua->end = bool(i == num_of_packet - 1);
+
+        fua->payload = p;
+        fua->size = packet_size;
+
+        pkt->wrap(msg);
+
+        p += packet_size;
+        nb_left -= packet_size;
+    }
+
+    return err;
+}
+
+srs_error_t SrsRtcH264Packager::consume_packets(vector<SrsRtpPacket*>& pkts)
+{
+    srs_error_t err = srs_success;
+
+    for (int i = 0; i < (int)pkts.size(); i++) {
+        SrsRtpPacket* pkt = pkts[i];
+        if ((err = source_->on_rtp(pkt)) != srs_success) {
+            err = srs_error_wrap(err, "consume video");
+            break;
+        }
+    }
+
+    for (int i = 0; i < (int)pkts.size(); i++) {
+        SrsRtpPacket* pkt = pkts[i];
+        srs_freep(pkt);
+    }
+
+    return err;
+}
+
+#ifdef SRS_FFMPEG_FIT
+
+SrsRtcFromRtmpBridge::SrsRtcFromRtmpBridge(SrsRtcSource* source)
+{
+    req = NULL;
+    source_ = source;
+    format = new SrsRtmpFormat();
+    codec_ = new SrsAudioTranscoder();
+    latest_codec_ = SrsAudioCodecIdForbidden;
+    rtmp_to_rtc = false;
+    keep_bframe = false;
+    merge_nalus = false;
+    meta = new SrsMetaCache();
+    audio_sequence = 0;
+    video_packager_ = new SrsRtcH264Packager(source);
+
+    // audio track ssrc
+    if (true) {
+        std::vector<SrsRtcTrackDescription*> descs = source->get_track_desc("audio", "opus");
+        if (!descs.empty()) {
+            audio_ssrc = descs.at(0)->ssrc_;
+        }
+        // Note we must use the PT of source, see https://github.com/ossrs/srs/pull/3079
+        audio_payload_type_ = descs.empty() ? kAudioPayloadType : descs.front()->media_->pt_;
+    }
+}
+
+SrsRtcFromRtmpBridge::~SrsRtcFromRtmpBridge()
+{
+    srs_freep(format);
+    srs_freep(codec_);
+    srs_freep(meta);
+    srs_freep(video_packager_);
+}
+
+srs_error_t SrsRtcFromRtmpBridge::initialize(SrsRequest* r)
+{
+    srs_error_t err = srs_success;
+
+    req = r;
+    rtmp_to_rtc = _srs_config->get_rtc_from_rtmp(req->vhost);
+
+    if (rtmp_to_rtc) {
+        if ((err = format->initialize()) != srs_success) {
+            return srs_error_wrap(err, "format initialize");
+        }
+
+        // Setup the SPS/PPS parsing strategy.
+        format->try_annexb_first = _srs_config->try_annexb_first(r->vhost);
+    }
+
+    keep_bframe = _srs_config->get_rtc_keep_bframe(req->vhost);
+    merge_nalus = _srs_config->get_rtc_server_merge_nalus();
+    srs_trace("RTC bridge from RTMP, rtmp2rtc=%d, keep_bframe=%d, merge_nalus=%d",
+              rtmp_to_rtc, keep_bframe, merge_nalus);
+
+    return err;
+}
+
+srs_error_t SrsRtcFromRtmpBridge::on_publish()
+{
+    srs_error_t err = srs_success;
+
+    if (!rtmp_to_rtc) {
+        return err;
+    }
+
+    // TODO: FIXME: Should sync with bridge?
+    if ((err = source_->on_publish()) != srs_success) {
+        return srs_error_wrap(err, "source publish");
+    }
+
+    // Reset the metadata cache, to make VLC happy when disable/enable stream.
+    // @see https://github.com/ossrs/srs/issues/1630#issuecomment-597979448
+    meta->clear();
+
+    return err;
+}
+
+void SrsRtcFromRtmpBridge::on_unpublish()
+{
+    if (!rtmp_to_rtc) {
+        return;
+    }
+
+    // Reset the metadata cache, to make VLC happy when disable/enable stream.
+    // @see https://github.com/ossrs/srs/issues/1630#issuecomment-597979448
+    meta->update_previous_vsh();
+    meta->update_previous_ash();
+
+    // @remark This bridge might be disposed here, so never use it.
+    // TODO: FIXME: Should sync with bridge?
+    source_->on_unpublish();
+}
+
+srs_error_t SrsRtcFromRtmpBridge::on_audio(SrsSharedPtrMessage* msg)
+{
+    srs_error_t err = srs_success;
+
+    if (!rtmp_to_rtc) {
+        return err;
+    }
+
+    // TODO: FIXME: Support parsing OPUS for RTC.
+    if ((err = format->on_audio(msg)) != srs_success) {
+        return srs_error_wrap(err, "format consume audio");
+    }
+
+    // Try to init codec when startup or codec changed.
+    if (format->acodec && (err = init_codec(format->acodec->id)) != srs_success) {
+        return srs_error_wrap(err, "init codec");
+    }
+
+    // Ignore if no format->acodec, it means the codec is not parsed, or unknown codec.
+    // @issue https://github.com/ossrs/srs/issues/1506#issuecomment-562079474
+    if (!format->acodec) {
+        return err;
+    }
+
+    // ts support audio codec: aac/mp3
+    SrsAudioCodecId acodec = format->acodec->id;
+    if (acodec != SrsAudioCodecIdAAC && acodec != SrsAudioCodecIdMP3) {
+        return err;
+    }
+
+    // ignore sequence header
+    srs_assert(format->audio);
+
+    if (format->acodec->id == SrsAudioCodecIdMP3) {
+        return transcode(format->audio);
+    }
+
+    // When drop aac audio packet, never transcode.
+    if (acodec != SrsAudioCodecIdAAC) {
+        return err;
+    }
+
+    char* adts_audio = NULL;
+    int nn_adts_audio = 0;
+    // TODO: FIXME: Reserve 7 bytes header when create shared message.
+    if ((err = aac_raw_append_adts_header(msg, format, &adts_audio, &nn_adts_audio)) != srs_success) {
+        return srs_error_wrap(err, "aac append header");
+    }
+
+    if (!adts_audio) {
+        return err;
+    }
+
+    SrsAudioFrame aac;
+    aac.dts = format->audio->dts;
+    aac.cts = format->audio->cts;
+    if ((err = aac.add_sample(adts_audio, nn_adts_audio)) == srs_success) {
+        // If OK, transcode the AAC to Opus and consume it.
+        err = transcode(&aac);
+    }
+
+    srs_freepa(adts_audio);
+
+    return err;
+}
+
+srs_error_t SrsRtcFromRtmpBridge::init_codec(SrsAudioCodecId codec)
+{
+    srs_error_t err = srs_success;
+
+    // Ignore if not changed.
+    if (latest_codec_ == codec) return err;
+
+    // Create a new codec.
+    srs_freep(codec_);
+    codec_ = new SrsAudioTranscoder();
+
+    // Initialize the codec according to the codec in stream.
+    int bitrate = 48000; // The output bitrate in bps.
+    if ((err = codec_->initialize(codec, SrsAudioCodecIdOpus, kAudioChannel, kAudioSamplerate, bitrate)) != srs_success) {
+        return srs_error_wrap(err, "init codec=%d", codec);
+    }
+
+    // Update the latest codec in stream.
+    if (latest_codec_ == SrsAudioCodecIdForbidden) {
+        srs_trace("RTMP2RTC: Init audio codec to %d(%s)", codec, srs_audio_codec_id2str(codec).c_str());
+    } else {
+        srs_trace("RTMP2RTC: Switch audio codec %d(%s) to %d(%s)", latest_codec_, srs_audio_codec_id2str(latest_codec_).c_str(),
+            codec, srs_audio_codec_id2str(codec).c_str());
+    }
+    latest_codec_ = codec;
+
+    return err;
+}
+
+srs_error_t SrsRtcFromRtmpBridge::transcode(SrsAudioFrame* audio)
+{
+    srs_error_t err = srs_success;
+
+    std::vector<SrsAudioFrame *> out_audios;
+    if ((err = codec_->transcode(audio, out_audios)) != srs_success) {
+        return srs_error_wrap(err, "recode error");
+    }
+
+    // Save OPUS packets in shared message.
+    if (out_audios.empty()) {
         return err;
     }
 
@@ -1009,7 +1770,7 @@ srs_error_t SrsRtcFromRtmpBridge::on_video(SrsSharedPtrMessage* msg)
         SrsRtpPacket* pkt = new SrsRtpPacket();
         SrsAutoFree(SrsRtpPacket, pkt);
 
-        if ((err = package_stap_a(source_, msg, pkt)) != srs_success) {
+        if ((err = package_stap_a(msg, pkt)) != srs_success) {
             return srs_error_wrap(err, "package stap-a");
         }
 
@@ -1020,38 +1781,25 @@ srs_error_t SrsRtcFromRtmpBridge::on_video(SrsSharedPtrMessage* msg)
 
     // If merge Nalus, we pcakges all NALUs(samples) as one NALU, in a RTP or FUA packet.
     vector<SrsRtpPacket*> pkts;
+    uint32_t timestamp = (uint32_t)(msg->timestamp * 90);
     if (merge_nalus && nn_samples > 1) {
-        if ((err = package_nalus(msg, samples, pkts)) != srs_success) {
-            return srs_error_wrap(err, "package nalus as one");
+        err = video_packager_->package_nalus(msg, timestamp, samples, pkts);
+        if (err == srs_success && !pkts.empty()) {
+            pkts.back()->header.set_marker(true);
         }
     } else {
         // By default, we package each NALU(sample) to a RTP or FUA packet.
-        for (int i = 0; i < nn_samples; i++) {
-            SrsSample* sample = samples[i];
-
-            // We always ignore bframe here, if config to discard bframe,
-            // the bframe flag will not be set.
-            if (sample->bframe) {
-                continue;
-            }
-
-            if (sample->size <= kRtpMaxPayloadSize) {
-                if ((err = package_single_nalu(msg, sample, pkts)) != srs_success) {
-                    return srs_error_wrap(err, "package single nalu");
-                }
-            } else {
-                if ((err = package_fu_a(msg, sample, kRtpMaxPayloadSize, pkts)) != srs_success) {
-                    return srs_error_wrap(err, "package fu-a");
-                }
-            }
-        }
+        err = video_packager_->package_samples(msg, timestamp, samples, pkts);
     }
 
-    if (!pkts.empty()) {
-        pkts.back()->header.set_marker(true);
+    if (err != srs_success) {
+        for (int i = 0; i < (int)pkts.size(); i++) {
+            srs_freep(pkts[i]);
+        }
+        return srs_error_wrap(err, "package video");
     }
 
-    return consume_packets(pkts);
+    return video_packager_->consume_packets(pkts);
 }
 
 srs_error_t SrsRtcFromRtmpBridge::filter(SrsSharedPtrMessage* msg, SrsFormat* format, bool& has_idr, vector<SrsSample*>& samples)
@@ -1084,246 +1832,21 @@ srs_error_t SrsRtcFromRtmpBridge::filter(SrsSharedPtrMessage* msg, SrsFormat* fo
     return err;
 }
 
-srs_error_t SrsRtcFromRtmpBridge::package_stap_a(SrsRtcSource* source, SrsSharedPtrMessage* msg, SrsRtpPacket* pkt)
+srs_error_t SrsRtcFromRtmpBridge::package_stap_a(SrsSharedPtrMessage* msg, SrsRtpPacket* pkt)
 {
-    srs_error_t err = srs_success;
-
     SrsFormat* format = meta->vsh_format();
     if (!format || !format->vcodec) {
-        return err;
+        return srs_success;
     }
 
-    // Note that the sps/pps may change, so we should copy it.
+    // Note that the sps/pps may change, so the packager copies it.
     const vector<char>& sps = format->vcodec->sequenceParameterSetNALUnit;
     const vector<char>& pps = format->vcodec->pictureParameterSetNALUnit;
     if (sps.empty() || pps.empty()) {
         return srs_error_new(ERROR_RTC_RTP_MUXER, "sps/pps empty");
     }
 
-    pkt->header.set_payload_type(video_payload_type_);
-    pkt->header.set_ssrc(video_ssrc);
-    pkt->frame_type = SrsFrameTypeVideo;
-    pkt->nalu_type = (SrsAvcNaluType)kStapA;
-    pkt->header.set_marker(false);
-    pkt->header.set_sequence(video_sequence++);
-    pkt->header.set_timestamp(msg->timestamp * 90);
-
-    SrsRtpSTAPPayload* stap = new SrsRtpSTAPPayload();
-    pkt->set_payload(stap, SrsRtspPacketPayloadTypeSTAP);
-
-    uint8_t header = sps[0];
-    stap->nri = (SrsAvcNaluType)header;
-
-    // Copy the SPS/PPS bytes, because it may change.
-    int size = (int)(sps.size() + pps.size());
-    char* payload = pkt->wrap(size);
-
-    if (true) {
-        SrsSample* sample = new SrsSample();
-        sample->bytes = payload;
-        sample->size = (int)sps.size();
-        stap->nalus.push_back(sample);
-
-        memcpy(payload, (char*)&sps[0], sps.size());
-        payload += (int)sps.size();
-    }
-
-    if (true) {
-        SrsSample* sample = new SrsSample();
-        sample->bytes = payload;
-        sample->size = (int)pps.size();
-        stap->nalus.push_back(sample);
-
-        memcpy(payload, (char*)&pps[0], pps.size());
-        payload += (int)pps.size();
-    }
-
-    srs_info("RTC STAP-A seq=%u, sps %d, pps %d bytes", pkt->header.get_sequence(), sps.size(), pps.size());
-
-    return err;
-}
-
-srs_error_t SrsRtcFromRtmpBridge::package_nalus(SrsSharedPtrMessage* msg, const vector<SrsSample*>& samples, vector<SrsRtpPacket*>& pkts)
-{
-    srs_error_t err = srs_success;
-
-    SrsRtpRawNALUs* raw = new SrsRtpRawNALUs();
-    SrsAvcNaluType first_nalu_type = SrsAvcNaluTypeReserved;
-
-    for (int i = 0; i < (int)samples.size(); i++) {
-        SrsSample* sample = samples[i];
-
-        // We always ignore bframe here, if config to discard bframe,
-        // the bframe flag will not be set.
-        if (sample->bframe) {
-            continue;
-        }
-
-        if (!sample->size) {
-            continue;
-        }
-
-        if (first_nalu_type == SrsAvcNaluTypeReserved) {
-            first_nalu_type = SrsAvcNaluType((uint8_t)(sample->bytes[0] & kNalTypeMask));
-        }
-
-        raw->push_back(sample->copy());
-    }
-
-    // Ignore empty.
-    int nn_bytes = raw->nb_bytes();
-    if (nn_bytes <= 0) {
-        srs_freep(raw);
-        return err;
-    }
-
-    if (nn_bytes < kRtpMaxPayloadSize) {
-        // Package NALUs in a single RTP packet.
-        SrsRtpPacket* pkt = new SrsRtpPacket();
-        pkts.push_back(pkt);
-
-        pkt->header.set_payload_type(video_payload_type_);
-        pkt->header.set_ssrc(video_ssrc);
-        pkt->frame_type = SrsFrameTypeVideo;
-        pkt->nalu_type = (SrsAvcNaluType)first_nalu_type;
-        pkt->header.set_sequence(video_sequence++);
-        pkt->header.set_timestamp(msg->timestamp * 90);
-        pkt->set_payload(raw, SrsRtspPacketPayloadTypeNALU);
-        pkt->wrap(msg);
-    } else {
-        // We must free it, should never use RTP packets to free it,
-        // because more than one RTP packet will refer to it.
-        SrsAutoFree(SrsRtpRawNALUs, raw);
-
-        // Package NALUs in FU-A RTP packets.
-        int fu_payload_size = kRtpMaxPayloadSize;
-
-        // The first byte is store in FU-A header.
-        uint8_t header = raw->skip_first_byte();
-        uint8_t nal_type = header & kNalTypeMask;
-        int nb_left = nn_bytes - 1;
-
-        int num_of_packet = 1 + (nn_bytes - 1) / fu_payload_size;
-        for (int i = 0; i < num_of_packet; ++i) {
-            int packet_size = srs_min(nb_left, fu_payload_size);
-
-            SrsRtpFUAPayload* fua = new SrsRtpFUAPayload();
-            if ((err = raw->read_samples(fua->nalus, packet_size)) != srs_success) {
-                srs_freep(fua);
-                return srs_error_wrap(err, "read samples %d bytes, left %d, total %d", packet_size, nb_left, nn_bytes);
-            }
-
-            SrsRtpPacket* pkt = new SrsRtpPacket();
-            pkts.push_back(pkt);
-
-            pkt->header.set_payload_type(video_payload_type_);
-            pkt->header.set_ssrc(video_ssrc);
-            pkt->frame_type = SrsFrameTypeVideo;
-            pkt->nalu_type = (SrsAvcNaluType)kFuA;
-            pkt->header.set_sequence(video_sequence++);
-            pkt->header.set_timestamp(msg->timestamp * 90);
-
-            fua->nri = (SrsAvcNaluType)header;
-            fua->nalu_type = (SrsAvcNaluType)nal_type;
-            fua->start = bool(i == 0);
-            fua->end = bool(i == num_of_packet - 1);
-
-            pkt->set_payload(fua, SrsRtspPacketPayloadTypeFUA);
-            pkt->wrap(msg);
-
-            nb_left -= packet_size;
-        }
-    }
-
-    return err;
-}
-
-// Single NAL Unit Packet @see https://tools.ietf.org/html/rfc6184#section-5.6
-srs_error_t SrsRtcFromRtmpBridge::package_single_nalu(SrsSharedPtrMessage* msg, SrsSample* sample, vector<SrsRtpPacket*>& pkts)
-{
-    srs_error_t err = srs_success;
-
-    SrsRtpPacket* pkt = new SrsRtpPacket();
-    pkts.push_back(pkt);
-
-    pkt->header.set_payload_type(video_payload_type_);
-    pkt->header.set_ssrc(video_ssrc);
-    pkt->frame_type = SrsFrameTypeVideo;
-    pkt->header.set_sequence(video_sequence++);
-    pkt->header.set_timestamp(msg->timestamp * 90);
-
-    SrsRtpRawPayload* raw = new SrsRtpRawPayload();
-    pkt->set_payload(raw, SrsRtspPacketPayloadTypeRaw);
-
-    raw->payload = sample->bytes;
-    raw->nn_payload = sample->size;
-
-    pkt->wrap(msg);
-
-    return err;
-}
-
-srs_error_t SrsRtcFromRtmpBridge::package_fu_a(SrsSharedPtrMessage* msg, SrsSample* sample, int fu_payload_size, vector<SrsRtpPacket*>& pkts)
-{
-    srs_error_t err = srs_success;
-
-    char* p = sample->bytes + 1;
-    int nb_left = sample->size - 1;
-    uint8_t header = sample->bytes[0];
-    uint8_t nal_type = header & kNalTypeMask;
-
-    int num_of_packet = 1 + (nb_left - 1) / fu_payload_size;
-    for (int i = 0; i < num_of_packet; ++i) {
-        int packet_size = srs_min(nb_left, fu_payload_size);
-
-        SrsRtpPacket* pkt = new SrsRtpPacket();
-        pkts.push_back(pkt);
-
-        pkt->header.set_payload_type(video_payload_type_);
-        pkt->header.set_ssrc(video_ssrc);
-        pkt->frame_type = SrsFrameTypeVideo;
-        pkt->header.set_sequence(video_sequence++);
-        pkt->header.set_timestamp(msg->timestamp * 90);
-
-        SrsRtpFUAPayload2* fua = new SrsRtpFUAPayload2();
-        pkt->set_payload(fua, SrsRtspPacketPayloadTypeFUA2);
-
-        fua->nri = (SrsAvcNaluType)header;
-        fua->nalu_type = (SrsAvcNaluType)nal_type;
-        fua->start = bool(i == 0);
-        fua->end = bool(i == num_of_packet - 1);
-
-        fua->payload = p;
-        fua->size = packet_size;
-
-        pkt->wrap(msg);
-
-        p += packet_size;
-        nb_left -= packet_size;
-    }
-
-    return err;
-}
-
-srs_error_t SrsRtcFromRtmpBridge::consume_packets(vector<SrsRtpPacket*>& pkts)
-{
-    srs_error_t err = srs_success;
-
-    // TODO: FIXME: Consume a range of packets.
-    for (int i = 0; i < (int)pkts.size(); i++) {
-        SrsRtpPacket* pkt = pkts[i];
-        if ((err = source_->on_rtp(pkt)) != srs_success) {
-            err = srs_error_wrap(err, "consume sps/pps");
-            break;
-        }
-    }
-
-    for (int i = 0; i < (int)pkts.size(); i++) {
-        SrsRtpPacket* pkt = pkts[i];
-        srs_freep(pkt);
-    }
-
-    return err;
+    return video_packager_->package_stap_a((uint32_t)(msg->timestamp * 90), &sps[0], (int)sps.size(), &pps[0], (int)pps.size(), pkt);
 }
 
 SrsRtmpFromRtcBridge::SrsRtmpFromRtcBridge(SrsLiveSource *src)
@@ -1333,16 +1856,14 @@ SrsRtmpFromRtcBridge::SrsRtmpFromRtcBridge(SrsLiveSource *src)
     is_first_audio = true;
     is_first_video = true;
     format = NULL;
-    rtp_key_frame_ts_ = -1;
-    header_sn_ = 0;
-    memset(cache_video_pkts_, 0, sizeof(cache_video_pkts_));
+    video_builder_ = new SrsRtcFrameBuilder(this);
 }
 
 SrsRtmpFromRtcBridge::~SrsRtmpFromRtcBridge()
 {
     srs_freep(codec_);
     srs_freep(format);
-    clear_cached_video();
+    srs_freep(video_builder_);
 }
 
 srs_error_t SrsRtmpFromRtcBridge::initialize(SrsRequest* r)
@@ -1368,6 +1889,9 @@ srs_error_t SrsRtmpFromRtcBridge::initialize(SrsRequest* r)
     // Setup the SPS/PPS parsing strategy.
     format->try_annexb_first = _srs_config->try_annexb_first(r->vhost);
 
+    // The time to wait for the lost video packets, by NACK.
+    video_builder_->set_jitter(_srs_config->get_rtc_jitter_for_rtmp(r->vhost));
+
     return err;
 }
 
@@ -1403,7 +1927,7 @@ srs_error_t SrsRtmpFromRtcBridge::on_rtp(SrsRtpPacket *pkt)
     if (pkt->is_audio()) {
         err = transcode_audio(pkt);
     } else {
-        err = packet_video(pkt);
+        err = video_builder_->on_rtp(pkt, srs_get_system_time());
     }
 
     return err;
@@ -1477,364 +2001,343 @@ void SrsRtmpFromRtcBridge::packet_aac(SrsCommonMessage* audio, char* data, int l
     } else {
         stream.write_1bytes(1);
     }
-    stream.write_bytes(data, len);
-    audio->size = rtmp_len;
+    stream.write_bytes(data, len);
+    audio->size = rtmp_len;
+}
+
+srs_error_t SrsRtmpFromRtcBridge::on_frame(SrsCommonMessage* frame)
+{
+    return source_->on_video(frame);
+}
+#endif
+
+#ifdef SRS_SRT
+
+SrsRtcFromSrtBridge::SrsRtcFromSrtBridge(SrsRtcSource* source) : ISrsSrtSourceBridge()
+{
+    req_ = NULL;
+    source_ = source;
+    ts_ctx_ = new SrsTsContext();
+    keep_bframe_ = false;
+#ifdef SRS_FFMPEG_FIT
+    codec_ = NULL;
+#endif
+
+    audio_sequence_ = 0;
+    audio_ssrc_ = 0;
+    video_packager_ = new SrsRtcH264Packager(source);
+
+    // audio track ssrc
+    if (true) {
+        std::vector<SrsRtcTrackDescription*> descs = source->get_track_desc("audio", "opus");
+        if (!descs.empty()) {
+            audio_ssrc_ = descs.at(0)->ssrc_;
+        }
+        // Note we must use the PT of source, see https://github.com/ossrs/srs/pull/3079
+        audio_payload_type_ = descs.empty() ? kAudioPayloadType : descs.front()->media_->pt_;
+    }
+}
+
+SrsRtcFromSrtBridge::~SrsRtcFromSrtBridge()
+{
+    srs_freep(ts_ctx_);
+#ifdef SRS_FFMPEG_FIT
+    srs_freep(codec_);
+#endif
+    srs_freep(req_);
+    srs_freep(video_packager_);
+}
+
+srs_error_t SrsRtcFromSrtBridge::initialize(SrsRequest* req)
+{
+    srs_error_t err = srs_success;
+
+    req_ = req->copy();
+    keep_bframe_ = _srs_config->get_rtc_keep_bframe(req->vhost);
+
+#ifdef SRS_FFMPEG_FIT
+    codec_ = new SrsAudioTranscoder();
+
+    // The output bitrate in bps.
+    int bitrate = 48000;
+    if ((err = codec_->initialize(SrsAudioCodecIdAAC, SrsAudioCodecIdOpus, kAudioChannel, kAudioSamplerate, bitrate)) != srs_success) {
+        return srs_error_wrap(err, "init codec");
+    }
+#endif
+
+    srs_trace("RTC bridge from SRT, keep_bframe=%d", keep_bframe_);
+
+    return err;
+}
+
+srs_error_t SrsRtcFromSrtBridge::on_publish()
+{
+    srs_error_t err = srs_success;
+
+    // Reset the SPS/PPS, which should be updated by the new stream.
+    sps_ = pps_ = "";
+
+    if ((err = source_->on_publish()) != srs_success) {
+        return srs_error_wrap(err, "source publish");
+    }
+
+    return err;
 }
 
-srs_error_t SrsRtmpFromRtcBridge::packet_video(SrsRtpPacket* src)
+srs_error_t SrsRtcFromSrtBridge::on_packet(SrsSrtPacket* pkt)
 {
     srs_error_t err = srs_success;
 
-    // TODO: Only copy when need
-    SrsRtpPacket* pkt = src->copy();
-
-    if (pkt->is_keyframe()) {
-        return packet_video_key_frame(pkt);
-    }
-
-    // store in cache
-    int index = cache_index(pkt->header.get_sequence());
-    cache_video_pkts_[index].in_use = true;
-    srs_freep(cache_video_pkts_[index].pkt);
-    cache_video_pkts_[index].pkt = pkt;
-    cache_video_pkts_[index].sn = pkt->header.get_sequence();
-    cache_video_pkts_[index].ts = pkt->get_avsync_time();
-    cache_video_pkts_[index].rtp_ts = pkt->header.get_timestamp();
-
-    // check whether to recovery lost packet and can construct a video frame
-    if (lost_sn_ == pkt->header.get_sequence()) {
-        uint16_t tail_sn = 0;
-        int sn = find_next_lost_sn(lost_sn_, tail_sn);
-        if (-1 == sn ) {
-            if (check_frame_complete(header_sn_, tail_sn)) {
-                if ((err = packet_video_rtmp(header_sn_, tail_sn)) != srs_success) {
-                    err = srs_error_wrap(err, "fail to pack video frame");
-                }
-            }
-        } else if (-2 == sn) {
-            return srs_error_new(ERROR_RTC_RTP_MUXER, "video cache is overflow");
-        } else {
-            lost_sn_ = (uint16_t)sn;
+    char* buf = pkt->data();
+    int nb_buf = pkt->size();
+
+    int nb_packet = nb_buf / SRS_TS_PACKET_SIZE;
+    for (int i = 0; i < nb_packet; i++) {
+        SrsBuffer stream(buf + (i * SRS_TS_PACKET_SIZE), SRS_TS_PACKET_SIZE);
+
+        // Ignore the corrupt packet, like SrsRtmpFromSrtBridge, SRT handles the packet loss.
+        if ((err = ts_ctx_->decode(&stream, this)) != srs_success) {
+            srs_warn("parse ts packet err=%s", srs_error_desc(err).c_str());
+            srs_error_reset(err);
+            continue;
         }
     }
 
     return err;
 }
 
-srs_error_t SrsRtmpFromRtcBridge::packet_video_key_frame(SrsRtpPacket* pkt)
+void SrsRtcFromSrtBridge::on_unpublish()
 {
-    srs_error_t err = srs_success;
-
-    // TODO: handle sps and pps in 2 rtp packets
-    SrsRtpSTAPPayload* stap_payload = dynamic_cast<SrsRtpSTAPPayload*>(pkt->payload());
-    if (stap_payload) {
-        SrsSample* sps = stap_payload->get_sps();
-        SrsSample* pps = stap_payload->get_pps();
-        if (NULL == sps || NULL == pps) {
-            return srs_error_new(ERROR_RTC_RTP_MUXER, "no sps or pps in stap-a rtp. sps: %p, pps:%p", sps, pps);
-        } else {
-            // h264 raw to h264 packet.
-            std::string sh;
-            SrsRawH264Stream* avc = new SrsRawH264Stream();
-            SrsAutoFree(SrsRawH264Stream, avc);
+    source_->on_unpublish();
+}
 
-            if ((err = avc->mux_sequence_header(string(sps->bytes, sps->size), string(pps->bytes, pps->size), sh)) != srs_success) {
-                return srs_error_wrap(err, "mux sequence header");
-            }
+srs_error_t SrsRtcFromSrtBridge::on_ts_message(SrsTsMessage* msg)
+{
+    srs_error_t err = srs_success;
 
-            // h264 packet to flv packet.
-            char* flv = NULL;
-            int nb_flv = 0;
-            if ((err = avc->mux_avc2flv(sh, SrsVideoAvcFrameTypeKeyFrame, SrsVideoAvcFrameTraitSequenceHeader, pkt->get_avsync_time(),
-                    pkt->get_avsync_time(), &flv, &nb_flv)) != srs_success) {
-                return srs_error_wrap(err, "avc to flv");
-            }
+    // When the audio SID is private stream 1, we use common audio.
+    // @see https://github.com/ossrs/srs/issues/740
+    if (msg->channel->apply == SrsTsPidApplyAudio && msg->sid == SrsTsPESStreamIdPrivateStream1) {
+        msg->sid = SrsTsPESStreamIdAudioCommon;
+    }
 
-            SrsMessageHeader header;
-            header.initialize_video(nb_flv, pkt->get_avsync_time(), 1);
-            SrsCommonMessage rtmp;
-            if ((err = rtmp.create(&header, flv, nb_flv)) != srs_success) {
-                return srs_error_wrap(err, "create rtmp");
-            }
+    // Ignore when not audio/video, or not adts/annexb format.
+    if (msg->stream_number() != 0 || msg->payload->length() <= 0) {
+        return err;
+    }
 
-            if ((err = source_->on_video(&rtmp)) != srs_success) {
-                return err;
-            }
+    // WebRTC NOT support HEVC, so we only deliver H.264.
+    if (msg->channel->stream == SrsTsStreamVideoH264) {
+        if ((err = on_ts_video_avc(msg)) != srs_success) {
+            return srs_error_wrap(err, "ts: consume video");
         }
     }
 
-    if (-1 == rtp_key_frame_ts_) {
-        rtp_key_frame_ts_ = pkt->header.get_timestamp();
-        header_sn_ = pkt->header.get_sequence();
-        lost_sn_ = header_sn_ + 1;
-        // Received key frame and clean cache of old p frame pkts
-        clear_cached_video();
-        srs_trace("set ts=%u, header=%hu, lost=%hu", (uint32_t)rtp_key_frame_ts_, header_sn_, lost_sn_);
-    } else if (rtp_key_frame_ts_ != pkt->header.get_timestamp()) {
-        //new key frame, clean cache
-        int64_t old_ts = rtp_key_frame_ts_;
-        uint16_t old_header_sn = header_sn_;
-        uint16_t old_lost_sn = lost_sn_;
-        rtp_key_frame_ts_ = pkt->header.get_timestamp();
-        header_sn_ = pkt->header.get_sequence();
-        lost_sn_ = header_sn_ + 1;
-        clear_cached_video();
-        srs_warn("drop old ts=%u, header=%hu, lost=%hu, set new ts=%u, header=%hu, lost=%hu",
-            (uint32_t)old_ts, old_header_sn, old_lost_sn, (uint32_t)rtp_key_frame_ts_, header_sn_, lost_sn_);
-    }
-
-    uint16_t index = cache_index(pkt->header.get_sequence());
-    cache_video_pkts_[index].in_use = true;
-    srs_freep(cache_video_pkts_[index].pkt);
-    cache_video_pkts_[index].pkt = pkt;
-    cache_video_pkts_[index].sn = pkt->header.get_sequence();
-    cache_video_pkts_[index].ts = pkt->get_avsync_time();
-    cache_video_pkts_[index].rtp_ts = pkt->header.get_timestamp();
-
-    int32_t sn = lost_sn_;
-    uint16_t tail_sn = 0;
-    if (srs_rtp_seq_distance(header_sn_, pkt->header.get_sequence()) < 0){
-        // When receive previous pkt in the same frame, update header sn;
-        header_sn_ = pkt->header.get_sequence();
-        sn = find_next_lost_sn(header_sn_, tail_sn);
-    } else if (lost_sn_ == pkt->header.get_sequence()) {
-        sn = find_next_lost_sn(lost_sn_, tail_sn);
-    }
-
-    if (-1 == sn) {
-        if (check_frame_complete(header_sn_, tail_sn)) {
-            if ((err = packet_video_rtmp(header_sn_, tail_sn)) != srs_success) {
-                err = srs_error_wrap(err, "fail to packet key frame");
-            }
+#ifdef SRS_FFMPEG_FIT
+    if (msg->channel->stream == SrsTsStreamAudioAAC) {
+        if ((err = on_ts_audio(msg)) != srs_success) {
+            return srs_error_wrap(err, "ts: consume audio");
         }
-    } else if (-2 == sn) {
-        return srs_error_new(ERROR_RTC_RTP_MUXER, "video cache is overflow");
-    } else {
-        lost_sn_ = (uint16_t)sn;
     }
+#endif
 
     return err;
 }
 
-srs_error_t SrsRtmpFromRtcBridge::packet_video_rtmp(const uint16_t start, const uint16_t end)
+srs_error_t SrsRtcFromSrtBridge::on_ts_video_avc(SrsTsMessage* msg)
 {
     srs_error_t err = srs_success;
 
-    int nb_payload = 0;
-    int16_t cnt = srs_rtp_seq_distance(start, end) + 1;
-    srs_assert(cnt >= 1);
+    // Copy the PES payload once, then all RTP packets of frame refer to it.
+    int size = msg->payload->length();
+    char* payload = new char[size];
+    memcpy(payload, msg->payload->bytes(), size);
 
-    for (uint16_t i = 0; i < (uint16_t)cnt; ++i) {
-        uint16_t sn = start + i;
-        uint16_t index = cache_index(sn);
-        SrsRtpPacket* pkt = cache_video_pkts_[index].pkt;
+    SrsSharedPtrMessage* shared = new SrsSharedPtrMessage();
+    SrsAutoFree(SrsSharedPtrMessage, shared);
+    shared->wrap(payload, size);
 
-        // fix crash when pkt->payload() if pkt is nullptr;
-        if (!pkt) continue;
+    SrsRawH264Stream avc;
+    SrsBuffer avs(shared->payload, shared->size);
 
-        // calculate nalu len
-        SrsRtpFUAPayload2* fua_payload = dynamic_cast<SrsRtpFUAPayload2*>(pkt->payload());
-        if (fua_payload && fua_payload->size > 0) {
-            if (fua_payload->start) {
-                nb_payload += 1 + 4;
+    bool has_idr = false;
+    vector<SrsSample> samples;
+    while (!avs.empty()) {
+        char* frame = NULL;
+        int frame_size = 0;
+        if ((err = avc.annexb_demux(&avs, &frame, &frame_size)) != srs_success) {
+            return srs_error_wrap(err, "demux annexb");
+        }
+
+        if (frame == NULL || frame_size == 0) {
+            continue;
+        }
+
+        // The SPS/PPS is packaged in STAP-A before IDR.
+        if (avc.is_sps(frame, frame_size)) {
+            if ((err = avc.sps_demux(frame, frame_size, sps_)) != srs_success) {
+                return srs_error_wrap(err, "demux sps");
             }
-            nb_payload += fua_payload->size;
             continue;
         }
 
-        SrsRtpSTAPPayload* stap_payload = dynamic_cast<SrsRtpSTAPPayload*>(pkt->payload());
-        if (stap_payload) {
-            for (int j = 0; j < (int)stap_payload->nalus.size(); ++j) {
-                SrsSample* sample = stap_payload->nalus.at(j);
-                if (sample->size > 0) {    
-                    nb_payload += 4 + sample->size;
-                }
+        if (avc.is_pps(frame, frame_size)) {
+            if ((err = avc.pps_demux(frame, frame_size, pps_)) != srs_success) {
+                return srs_error_wrap(err, "demux pps");
             }
             continue;
         }
 
-        SrsRtpRawPayload* raw_payload = dynamic_cast<SrsRtpRawPayload*>(pkt->payload());
-        if (raw_payload && raw_payload->nn_payload > 0) {
-            nb_payload += 4 + raw_payload->nn_payload;
+        SrsAvcNaluType nal_type = (SrsAvcNaluType)(frame[0] & kNalTypeMask);
+        if (nal_type == SrsAvcNaluTypeAccessUnitDelimiter) {
             continue;
         }
-    }
+        if (nal_type == SrsAvcNaluTypeIDR) {
+            has_idr = true;
+        }
 
-    if (0 == nb_payload) {
-        srs_warn("empty nalu");
-        return err;
-    }
-	
-    //type_codec1 + avc_type + composition time + nalu size + nalu
-    nb_payload += 1 + 1 + 3;
+        // Because RTC does not support B-frame, so we will drop them.
+        SrsSample sample(frame, frame_size);
+        if (!keep_bframe_) {
+            if ((err = sample.parse_bframe()) != srs_success) {
+                return srs_error_wrap(err, "parse bframe");
+            }
+            if (sample.bframe) {
+                continue;
+            }
+        }
 
-    SrsCommonMessage rtmp;
-    SrsRtpPacket* pkt = cache_video_pkts_[cache_index(start)].pkt;
-    rtmp.header.initialize_video(nb_payload, pkt->get_avsync_time(), 1);
-    rtmp.create_payload(nb_payload);
-    rtmp.size = nb_payload;
-    SrsBuffer payload(rtmp.payload, rtmp.size);
-    if (pkt->is_keyframe()) {
-        payload.write_1bytes(0x17); // type(4 bits): key frame; code(4bits): avc
-        rtp_key_frame_ts_ = -1;
-    } else {
-        payload.write_1bytes(0x27); // type(4 bits): inter frame; code(4bits): avc
+        samples.push_back(sample);
     }
-    payload.write_1bytes(0x01); // avc_type: nalu
-    payload.write_1bytes(0x0);  // composition time
-    payload.write_1bytes(0x0);
-    payload.write_1bytes(0x0);
-
-    int nalu_len = 0;
-    for (uint16_t i = 0; i < (uint16_t)cnt; ++i) {
-        uint16_t index = cache_index((start + i));
-        SrsRtpPacket* pkt = cache_video_pkts_[index].pkt;
 
-        // fix crash when pkt->payload() if pkt is nullptr;
-        if (!pkt) continue;
+    // The RTP timestamp is the presentation time, in 90kHz which is the same as TS.
+    uint32_t timestamp = (uint32_t)msg->pts;
 
-        cache_video_pkts_[index].in_use = false;
-        cache_video_pkts_[index].pkt = NULL;
-        cache_video_pkts_[index].ts = 0;
-        cache_video_pkts_[index].rtp_ts = 0;
-        cache_video_pkts_[index].sn = 0;
-
-        SrsRtpFUAPayload2* fua_payload = dynamic_cast<SrsRtpFUAPayload2*>(pkt->payload());
-        if (fua_payload && fua_payload->size > 0) {
-            if (fua_payload->start) {
-                nalu_len = fua_payload->size + 1;
-                //skip 4 bytes to write nalu_len future
-                payload.skip(4);
-                payload.write_1bytes(fua_payload->nri | fua_payload->nalu_type);
-                payload.write_bytes(fua_payload->payload, fua_payload->size);
-            } else {
-                nalu_len += fua_payload->size;
-                payload.write_bytes(fua_payload->payload, fua_payload->size);
-                if (fua_payload->end) {
-                    //write nalu_len back
-                    payload.skip(-(4 + nalu_len));
-                    payload.write_4bytes(nalu_len);
-                    payload.skip(nalu_len);
-                }
-            }
-            srs_freep(pkt);
-            continue;
-        }
+    // Well, for each IDR, we append a SPS/PPS before it, which is packaged in STAP-A.
+    if (has_idr) {
+        SrsRtpPacket* pkt = new SrsRtpPacket();
+        SrsAutoFree(SrsRtpPacket, pkt);
 
-        SrsRtpSTAPPayload* stap_payload = dynamic_cast<SrsRtpSTAPPayload*>(pkt->payload());
-        if (stap_payload) {
-            for (int j = 0; j < (int)stap_payload->nalus.size(); ++j) {
-                SrsSample* sample = stap_payload->nalus.at(j);
-                if (sample->size > 0) {  
-                    payload.write_4bytes(sample->size);
-                    payload.write_bytes(sample->bytes, sample->size);
-                }
-            }
-            srs_freep(pkt);
-            continue;
+        if ((err = video_packager_->package_stap_a(timestamp, sps_.data(), (int)sps_.size(), pps_.data(), (int)pps_.size(), pkt)) != srs_success) {
+            return srs_error_wrap(err, "package stap-a");
         }
 
-        SrsRtpRawPayload* raw_payload = dynamic_cast<SrsRtpRawPayload*>(pkt->payload());
-        if (raw_payload && raw_payload->nn_payload > 0) {
-            payload.write_4bytes(raw_payload->nn_payload);
-            payload.write_bytes(raw_payload->payload, raw_payload->nn_payload);
-            srs_freep(pkt);
-            continue;
+        if ((err = source_->on_rtp(pkt)) != srs_success) {
+            return srs_error_wrap(err, "consume sps/pps");
         }
-
-        srs_freep(pkt);
     }
 
-    if ((err = source_->on_video(&rtmp)) != srs_success) {
-        srs_warn("fail to pack video frame");
+    vector<SrsSample*> nalus;
+    for (int i = 0; i < (int)samples.size(); i++) {
+        nalus.push_back(&samples[i]);
     }
 
-    header_sn_ = end + 1;
-    uint16_t tail_sn = 0;
-    int sn = find_next_lost_sn(header_sn_, tail_sn);
-    if (-1 == sn) {
-        if (check_frame_complete(header_sn_, tail_sn)) {
-            err = packet_video_rtmp(header_sn_, tail_sn);
+    vector<SrsRtpPacket*> pkts;
+    if ((err = video_packager_->package_samples(shared, timestamp, nalus, pkts)) != srs_success) {
+        for (int i = 0; i < (int)pkts.size(); i++) {
+            srs_freep(pkts[i]);
         }
-    } else if (-2 == sn) {
-        return srs_error_new(ERROR_RTC_RTP_MUXER, "video cache is overflow");
-    } else {
-        lost_sn_ = sn;
+        return srs_error_wrap(err, "package nalu");
     }
 
-    return err;
+    return video_packager_->consume_packets(pkts);
 }
 
-int32_t SrsRtmpFromRtcBridge::find_next_lost_sn(uint16_t current_sn, uint16_t& end_sn)
+#ifdef SRS_FFMPEG_FIT
+srs_error_t SrsRtcFromSrtBridge::on_ts_audio(SrsTsMessage* msg)
 {
-    uint32_t last_rtp_ts = cache_video_pkts_[cache_index(header_sn_)].rtp_ts;
-    for (int i = 0; i < s_cache_size; ++i) {
-        uint16_t lost_sn = current_sn + i;
-        int index = cache_index(lost_sn);
+    srs_error_t err = srs_success;
+
+    SrsRawAacStream aac;
+    SrsBuffer avs(msg->payload->bytes(), msg->payload->length());
+
+    // ts tbn to flv tbn.
+    uint32_t pts = (uint32_t)(msg->pts / 90);
+
+    // The transcoder eats the whole ADTS frame, so we only demux it for the sample rate and the size.
+    int frame_idx = 0;
+    while (!avs.empty()) {
+        char* adts = avs.head();
+
+        char* frame = NULL;
+        int frame_size = 0;
+        SrsRawAacStreamCodec codec;
+        if ((err = aac.adts_demux(&avs, &frame, &frame_size, codec)) != srs_success) {
+            return srs_error_wrap(err, "demux adts");
+        }
 
-        if (!cache_video_pkts_[index].in_use) {
-            return lost_sn;
+        if (frame_size <= 0) {
+            continue;
+        }
+
+        // May have more than one aac frame in PES packet, and shared same timestamp,
+        // so we must calculate each aac frame's timestamp.
+        int sample_rate = 44100;
+        switch (codec.sound_rate) {
+            case SrsAudioSampleRate5512: sample_rate = 5512; break;
+            case SrsAudioSampleRate11025: sample_rate = 11025; break;
+            case SrsAudioSampleRate22050: sample_rate = 22050; break;
+            case SrsAudioSampleRate44100:
+            default: sample_rate = 44100; break;
         }
-        //check time first, avoid two small frame mixed case decode fail
-        if (last_rtp_ts != cache_video_pkts_[index].rtp_ts) {
-            end_sn = lost_sn - 1;
-            return -1;
+
+        SrsAudioFrame audio;
+        audio.dts = (int64_t)(pts + (frame_idx++ * (1024.0 * 1000.0 / sample_rate)));
+        if ((err = audio.add_sample(adts, (int)(avs.head() - adts))) != srs_success) {
+            return srs_error_wrap(err, "add sample");
         }
 
-        if (cache_video_pkts_[index].pkt->header.get_marker()) {
-            end_sn = lost_sn;
-            return -1;
+        if ((err = transcode(&audio)) != srs_success) {
+            return srs_error_wrap(err, "transcode");
         }
     }
 
-    srs_error("cache overflow. the packet count of video frame is more than %u", s_cache_size);
-    return -2;
+    return err;
 }
 
-void SrsRtmpFromRtcBridge::clear_cached_video()
+srs_error_t SrsRtcFromSrtBridge::transcode(SrsAudioFrame* audio)
 {
-    for (size_t i = 0; i < s_cache_size; i++)
-    {
-        if (cache_video_pkts_[i].in_use) {
-            srs_freep(cache_video_pkts_[i].pkt);
-            cache_video_pkts_[i].sn = 0;
-            cache_video_pkts_[i].ts = 0;
-            cache_video_pkts_[i].rtp_ts = 0;
-            cache_video_pkts_[i].in_use = false;
-        }
+    srs_error_t err = srs_success;
+
+    std::vector<SrsAudioFrame*> out_audios;
+    if ((err = codec_->transcode(audio, out_audios)) != srs_success) {
+        return srs_error_wrap(err, "recode error");
     }
-}
 
-bool SrsRtmpFromRtcBridge::check_frame_complete(const uint16_t start, const uint16_t end)
-{
-    int16_t cnt = srs_rtp_seq_distance(start, end) + 1;
-    srs_assert(cnt >= 1);
+    for (std::vector<SrsAudioFrame*>::iterator it = out_audios.begin(); it != out_audios.end(); ++it) {
+        SrsAudioFrame* out_audio = *it;
 
-    uint16_t fu_s_c = 0;
-    uint16_t fu_e_c = 0;
-    for (uint16_t i = 0; i < (uint16_t)cnt; ++i) {
-        int index = cache_index((start + i));
-        SrsRtpPacket* pkt = cache_video_pkts_[index].pkt;
+        SrsRtpPacket* pkt = new SrsRtpPacket();
+        SrsAutoFree(SrsRtpPacket, pkt);
 
-        // fix crash when pkt->payload() if pkt is nullptr;
-        if (!pkt) continue;
+        pkt->header.set_payload_type(audio_payload_type_);
+        pkt->header.set_ssrc(audio_ssrc_);
+        pkt->frame_type = SrsFrameTypeAudio;
+        pkt->header.set_marker(true);
+        pkt->header.set_sequence(audio_sequence_++);
+        pkt->header.set_timestamp(out_audio->dts * 48);
 
-        SrsRtpFUAPayload2* fua_payload = dynamic_cast<SrsRtpFUAPayload2*>(pkt->payload());
-        if (!fua_payload) continue;
+        SrsRtpRawPayload* raw = new SrsRtpRawPayload();
+        pkt->set_payload(raw, SrsRtspPacketPayloadTypeRaw);
 
-        if (fua_payload->start) {
-            ++fu_s_c;
-        }
+        srs_assert(out_audio->nb_samples == 1);
+        raw->payload = pkt->wrap(out_audio->samples[0].bytes, out_audio->samples[0].size);
+        raw->nn_payload = out_audio->samples[0].size;
 
-        if (fua_payload->end) {
-            ++fu_e_c;
+        if ((err = source_->on_rtp(pkt)) != srs_success) {
+            err = srs_error_wrap(err, "consume opus");
+            break;
         }
     }
 
-    return fu_s_c == fu_e_c;
+    codec_->free_frames(out_audios);
+
+    return err;
 }
 #endif
 
+#endif
+
 SrsCodecPayload::SrsCodecPayload()
 {
     pt_of_publisher_ = pt_ = 0;
@@ -2257,6 +2760,7 @@ SrsRtcTrackDescription* SrsRtcTrackDescription::copy()
     cp->direction_ = direction_;
     cp->mid_ = mid_;
     cp->msid_ = msid_;
+    cp->rid_ = rid_;
     cp->is_active_ = is_active_;
     cp->media_ = media_ ? media_->copy():NULL;
     cp->red_ = red_ ? red_->copy():NULL;
@@ -2311,6 +2815,18 @@ SrsRtcTrackDescription* SrsRtcSourceDescription::find_track_description_by_ssrc(
     return NULL;
 }
 
+SrsRtcTrackDescription* SrsRtcSourceDescription::find_track_description_by_rid(std::string id, std::string rid)
+{
+    for (int i = 0; i < (int)video_track_descs_.size(); ++i) {
+        SrsRtcTrackDescription* desc = video_track_descs_.at(i);
+        if (!desc->rid_.empty() && desc->id_ == id && desc->rid_ == rid) {
+            return desc;
+        }
+    }
+
+    return NULL;
+}
+
 SrsRtcRecvTrack::SrsRtcRecvTrack(SrsRtcConnection* session, SrsRtcTrackDescription* track_desc, bool is_audio)
 {
     session_ = session;
@@ -2330,6 +2846,12 @@ SrsRtcRecvTrack::SrsRtcRecvTrack(SrsRtcConnection* session, SrsRtcTrackDescripti
     rate_ = 0.0;
 
     last_sender_report_sys_time_ = 0;
+
+    // Build the extension layout once by the negotiated extmaps, so we decode the extensions of each packet by it.
+    std::map<int, std::string>::iterator it;
+    for (it = track_desc_->extmaps_.begin(); it != track_desc_->extmaps_.end(); ++it) {
+        extension_types_.register_by_uri(it->first, it->second);
+    }
 }
 
 SrsRtcRecvTrack::~SrsRtcRecvTrack()
@@ -2349,6 +2871,11 @@ uint32_t SrsRtcRecvTrack::get_ssrc()
     return track_desc_->ssrc_;
 }
 
+SrsRtpExtensionTypes* SrsRtcRecvTrack::extension_types()
+{
+    return &extension_types_;
+}
+
 void SrsRtcRecvTrack::update_rtt(int rtt)
 {
     nack_receiver_->update_rtt(rtt);
@@ -2446,6 +2973,40 @@ std::string SrsRtcRecvTrack::get_track_id()
     return track_desc_->id_;
 }
 
+std::string SrsRtcRecvTrack::get_rid()
+{
+    return track_desc_->rid_;
+}
+
+bool SrsRtcRecvTrack::bind_simulcast_ssrc(char* buf, int size, uint32_t ssrc)
+{
+    // Ignore if not simulcast, or already bound.
+    if (track_desc_->rid_.empty() || track_desc_->ssrc_) {
+        return false;
+    }
+
+    int rid_id = track_desc_->get_rtp_extension_id(kRidExt);
+    if (rid_id <= 0) {
+        return false;
+    }
+
+    std::string rid;
+    srs_error_t err = srs_rtp_fast_parse_rid(buf, size, rid_id, rid);
+    if (err != srs_success) {
+        srs_freep(err);
+        return false;
+    }
+
+    if (rid != track_desc_->rid_) {
+        return false;
+    }
+
+    track_desc_->ssrc_ = ssrc;
+    srs_trace("RTC: Bind simulcast track=%s, rid=%s, ssrc=%u", track_desc_->id_.c_str(), rid.c_str(), ssrc);
+
+    return true;
+}
+
 srs_error_t SrsRtcRecvTrack::on_nack(SrsRtpPacket** ppkt)
 {
     srs_error_t err = srs_success;
@@ -2621,6 +3182,11 @@ uint32_t SrsRtcTsJitter::correct(uint32_t value)
     return jitter_->correct(value);
 }
 
+void SrsRtcTsJitter::rebase(uint32_t delta)
+{
+    jitter_->rebase(delta);
+}
+
 SrsRtcSeqJitter::SrsRtcSeqJitter(uint16_t base)
 {
     jitter_ = new SrsRtcJitter<uint16_t, int16_t>(base, 128, srs_rtp_seq_distance);
@@ -2636,6 +3202,11 @@ uint16_t SrsRtcSeqJitter::correct(uint16_t value)
     return jitter_->correct(value);
 }
 
+void SrsRtcSeqJitter::rebase(uint16_t delta)
+{
+    jitter_->rebase(delta);
+}
+
 SrsRtcSendTrack::SrsRtcSendTrack(SrsRtcConnection* session, SrsRtcTrackDescription* track_desc, bool is_audio)
 {
     session_ = session;
@@ -2822,13 +3393,34 @@ srs_error_t SrsRtcAudioSendTrack::on_rtcp(SrsRtpPacket* pkt)
     return err;
 }
 
+SrsRtcSimulcastLayer::SrsRtcSimulcastLayer(uint32_t ssrc, std::string rid)
+{
+    ssrc_ = ssrc;
+    rid_ = rid;
+    bitrate_ = 0;
+    bytes_ = 0;
+}
+
+SrsRtcSimulcastLayer::~SrsRtcSimulcastLayer()
+{
+}
+
 SrsRtcVideoSendTrack::SrsRtcVideoSendTrack(SrsRtcConnection* session, SrsRtcTrackDescription* track_desc)
     : SrsRtcSendTrack(session, track_desc, false)
 {
+    layer_ = target_ = NULL;
+    bandwidth_ = 0;
+    window_start_ = last_switch_ = last_pli_ = last_sent_ = 0;
+    probing_ = false;
+    probe_interval_ = kSimulcastProbeInterval;
 }
 
 SrsRtcVideoSendTrack::~SrsRtcVideoSendTrack()
 {
+    for (int i = 0; i < (int)layers_.size(); i++) {
+        SrsRtcSimulcastLayer* layer = layers_.at(i);
+        srs_freep(layer);
+    }
 }
 
 srs_error_t SrsRtcVideoSendTrack::on_rtp(SrsRtpPacket* pkt)
@@ -2872,6 +3464,206 @@ srs_error_t SrsRtcVideoSendTrack::on_rtcp(SrsRtpPacket* pkt)
     return err;
 }
 
+bool SrsRtcVideoSendTrack::is_simulcast()
+{
+    return !track_desc_->rid_.empty();
+}
+
+void SrsRtcVideoSendTrack::add_layer(uint32_t ssrc, std::string rid)
+{
+    for (int i = 0; i < (int)layers_.size(); i++) {
+        if (layers_.at(i)->ssrc_ == ssrc) {
+            return;
+        }
+    }
+
+    SrsRtcSimulcastLayer* layer = new SrsRtcSimulcastLayer(ssrc, rid);
+    layers_.push_back(layer);
+
+    if (!forced_rid_.empty() && rid == forced_rid_) {
+        target_ = layer;
+    }
+}
+
+void SrsRtcVideoSendTrack::set_layer(std::string rid)
+{
+    forced_rid_ = rid;
+
+    for (int i = 0; !rid.empty() && i < (int)layers_.size(); i++) {
+        if (layers_.at(i)->rid_ == rid) {
+            target_ = layers_.at(i);
+        }
+    }
+}
+
+uint32_t SrsRtcVideoSendTrack::get_layer_ssrc()
+{
+    return layer_ ? layer_->ssrc_ : 0;
+}
+
+void SrsRtcVideoSendTrack::on_bandwidth(int64_t bps)
+{
+    bandwidth_ = bps;
+}
+
+bool SrsRtcVideoSendTrack::on_layer_packet(SrsRtpPacket* pkt, srs_utime_t now, uint32_t* ppli_ssrc)
+{
+    *ppli_ssrc = 0;
+
+    SrsRtcSimulcastLayer* layer = NULL;
+    for (int i = 0; i < (int)layers_.size(); i++) {
+        if (layers_.at(i)->ssrc_ == pkt->header.get_ssrc()) {
+            layer = layers_.at(i);
+            break;
+        }
+    }
+    if (!layer) {
+        return false;
+    }
+
+    layer->bytes_ += pkt->nb_bytes();
+    update_layers(now);
+
+    // Switch to the wanted layer at keyframe, which is the target layer, or any layer if no target and no layer.
+    if (layer != layer_) {
+        bool wanted = target_ ? (layer == target_) : !layer_;
+        if (!wanted) {
+            return false;
+        }
+
+        if (!pkt->is_keyframe()) {
+            if (now - last_pli_ >= kSimulcastWindow) {
+                last_pli_ = now;
+                *ppli_ssrc = layer->ssrc_;
+            }
+            return false;
+        }
+
+        switch_layer(layer, now);
+    }
+
+    last_sent_ = now;
+    return true;
+}
+
+void SrsRtcVideoSendTrack::update_layers(srs_utime_t now)
+{
+    if (!window_start_) {
+        window_start_ = now;
+    }
+
+    // Update the bitrate of layers for each window.
+    srs_utime_t duration = now - window_start_;
+    if (duration < kSimulcastWindow) {
+        return;
+    }
+
+    for (int i = 0; i < (int)layers_.size(); i++) {
+        SrsRtcSimulcastLayer* layer = layers_.at(i);
+        layer->bitrate_ = layer->bytes_ * 8 * SRS_UTIME_SECONDS / duration;
+        layer->bytes_ = 0;
+    }
+    window_start_ = now;
+
+    SrsRtcSimulcastLayer* target = select_layer(now);
+    if (target && target != target_) {
+        srs_trace("RTC: Simulcast target layer %s=>%s, bitrate=%dkbps, bandwidth=%dkbps, probe=%dms, track=%s",
+            (target_ ? target_->rid_.c_str() : ""), target->rid_.c_str(), (int)(target->bitrate_ / 1000),
+            (int)(bandwidth_ / 1000), srsu2msi(probe_interval_), track_desc_->id_.c_str());
+        target_ = target;
+    }
+}
+
+static bool srs_rtc_layer_bitrate_less(SrsRtcSimulcastLayer* a, SrsRtcSimulcastLayer* b)
+{
+    return a->bitrate_ < b->bitrate_;
+}
+
+SrsRtcSimulcastLayer* SrsRtcVideoSendTrack::select_layer(srs_utime_t now)
+{
+    // The layer specified by API.
+    for (int i = 0; !forced_rid_.empty() && i < (int)layers_.size(); i++) {
+        if (layers_.at(i)->rid_ == forced_rid_) {
+            return layers_.at(i);
+        }
+    }
+
+    // Sort the active layers by bitrate, ignore the paused layers.
+    std::vector<SrsRtcSimulcastLayer*> actives;
+    for (int i = 0; i < (int)layers_.size(); i++) {
+        if (layers_.at(i)->bitrate_ > 0) {
+            actives.push_back(layers_.at(i));
+        }
+    }
+    if (actives.empty()) {
+        return target_;
+    }
+    std::sort(actives.begin(), actives.end(), srs_rtc_layer_bitrate_less);
+
+    // Without bandwidth estimation, use the best layer.
+    if (bandwidth_ <= 0) {
+        return actives.back();
+    }
+
+    int index = (int)(std::find(actives.begin(), actives.end(), layer_) - actives.begin());
+    if (index >= (int)actives.size()) {
+        // No layer yet, or the current layer is paused, start from the best layer which fits the bandwidth.
+        index = 0;
+        while (index < (int)actives.size() - 1 && actives.at(index + 1)->bitrate_ <= bandwidth_) {
+            index++;
+        }
+        return actives.at(index);
+    }
+
+    // Switch down to the layer which fits the bandwidth, and probe the upper layer later if probing failed.
+    if (actives.at(index)->bitrate_ > bandwidth_) {
+        if (probing_ && now - last_switch_ < probe_interval_) {
+            probe_interval_ = srs_min(probe_interval_ * 2, kSimulcastMaxProbeInterval);
+        }
+        probing_ = false;
+
+        while (index > 0 && actives.at(index)->bitrate_ > bandwidth_) {
+            index--;
+        }
+        return actives.at(index);
+    }
+
+    // The probing is done if the layer is stable for a while.
+    if (probing_ && now - last_switch_ >= probe_interval_) {
+        probing_ = false;
+        probe_interval_ = kSimulcastProbeInterval;
+    }
+
+    // Switch up if the upper layer fits the bandwidth, or probe it if stable for a while, because the bandwidth
+    // estimation is limited by the bitrate we sent.
+    if (index < (int)actives.size() - 1) {
+        SrsRtcSimulcastLayer* upper = actives.at(index + 1);
+        if (upper->bitrate_ <= bandwidth_ || (!probing_ && now - last_switch_ >= probe_interval_)) {
+            return upper;
+        }
+    }
+
+    return actives.at(index);
+}
+
+void SrsRtcVideoSendTrack::switch_layer(SrsRtcSimulcastLayer* layer, srs_utime_t now)
+{
+    // Continue the sequence number and timestamp from the previous layer, the timestamp delta is the elapsed time
+    // in TBN=90K, to make the player happy.
+    if (layer_) {
+        jitter_seq_->rebase(1);
+        jitter_ts_->rebase((uint32_t)srs_max(1, srsu2ms(now - last_sent_) * 90));
+
+        probing_ = layer->bitrate_ > layer_->bitrate_ && layer->bitrate_ > bandwidth_ && bandwidth_ > 0;
+    }
+
+    srs_trace("RTC: Simulcast switch layer %s=>%s, ssrc=%u=>%u, probing=%d, track=%s", (layer_ ? layer_->rid_.c_str() : ""),
+        layer->rid_.c_str(), (layer_ ? layer_->ssrc_ : 0), layer->ssrc_, probing_, track_desc_->id_.c_str());
+
+    layer_ = layer;
+    last_switch_ = now;
+}
+
 SrsRtcSSRCGenerator* SrsRtcSSRCGenerator::_instance = NULL;
 
 SrsRtcSSRCGenerator::SrsRtcSSRCGenerator()
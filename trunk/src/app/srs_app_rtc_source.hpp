@@ -21,6 +21,10 @@
 #include <srs_app_source.hpp>
 #include <srs_kernel_rtc_rtp.hpp>
 
+#ifdef SRS_SRT
+#include <srs_app_srt_source.hpp>
+#endif
+
 class SrsRequest;
 class SrsMetaCache;
 class SrsSharedPtrMessage;
@@ -120,6 +124,15 @@ public:
 // Global singleton instance.
 extern SrsRtcSourceManager* _srs_rtc_sources;
 
+// Fetch or create the RTC source, to bridge the stream published by other protocols such as RTMP and SRT.
+// @param pps the RTC source, NULL if RTC is disabled or for edge, which does not need a bridge.
+// @return error if the RTC stream is busy, that is published by a WebRTC client.
+extern srs_error_t srs_rtc_fetch_bridge_source(SrsRequest* r, bool edge, SrsRtcSource** pps);
+
+// Check whether RTC stream is busy, then bridge the live source to RTC, for the RTMP publishers such as the RTMP
+// client and the local publisher of casters. The SRT publisher has its own bridge, see SrsRtcFromSrtBridge.
+extern srs_error_t srs_rtc_bridge_live_source(SrsRequest* r, bool edge, SrsLiveSource* source);
+
 // A publish stream interface, for source to callback with.
 class ISrsRtcPublishStream
 {
@@ -239,11 +252,125 @@ public:
     bool has_stream_desc();
     void set_stream_desc(SrsRtcSourceDescription* stream_desc);
     std::vector<SrsRtcTrackDescription*> get_track_desc(std::string type, std::string media_type);
+    // For simulcast, bind the SSRC of layer, which is unknown until got the RTP packet with RID.
+    void bind_simulcast_layer(std::string id, std::string rid, uint32_t ssrc);
+    // For simulcast, find the video track of layer by the SSRC from publisher, NULL if not simulcast.
+    SrsRtcTrackDescription* find_simulcast_layer(uint32_t ssrc);
+    // For simulcast, the bridge only consumes one layer, the first one in SDP which is the most preferred, see
+    // https://www.rfc-editor.org/rfc/rfc8853#section-5.1 Return true if not simulcast.
+    bool is_bridge_layer(SrsRtpPacket* pkt);
+private:
+    bool is_bridge_layer(SrsRtcTrackDescription* desc);
 // interface ISrsFastTimer
 private:
     srs_error_t on_timer(srs_utime_t interval);
 };
 
+// The handler for frame builder, to consume the RTMP video message.
+class ISrsRtcFrameBuilderHandler
+{
+public:
+    ISrsRtcFrameBuilderHandler();
+    virtual ~ISrsRtcFrameBuilderHandler();
+public:
+    // When got a RTMP video message, the sequence header or a video frame with AVC NALUs.
+    virtual srs_error_t on_frame(SrsCommonMessage* frame) = 0;
+};
+
+// The slot of video packet in frame builder.
+struct SrsRtcFrameSlot
+{
+    uint16_t sn;
+    SrsRtpPacket* pkt;
+};
+
+// The jitter buffer and frame assembler for RTC to RTMP, which reorders the video packets by sequence number,
+// and builds the RTMP video frames. Each packet is scanned only once, to update the counts of frame and detect
+// the frame completion, and the NALUs of frame are copied once to the RTMP message.
+// For lost packet, it waits for the NACK retransmission until the jitter timeout, then drops the frames until
+// next keyframe, because the following frames are not decodable.
+class SrsRtcFrameBuilder
+{
+private:
+    ISrsRtcFrameBuilderHandler* handler_;
+    // The timeout to wait for the lost packet, for reordering or NACK retransmission.
+    srs_utime_t jitter_;
+    // The packets indexed by sequence number.
+    SrsRtcFrameSlot* slots_;
+    int capacity_;
+private:
+    // Whether wait for keyframe, to start a new GOP.
+    bool waiting_keyframe_;
+    // The SSRC of stream, we only build frames of one stream, for example, a simulcast layer.
+    uint32_t ssrc_;
+    // The first packet of next frame to build.
+    uint16_t head_sn_;
+    // The first packet not scanned, all packets in [head, cursor) are received.
+    uint16_t cursor_sn_;
+    // The latest packet received.
+    uint16_t highest_sn_;
+    // When the cursor is blocked by a lost packet, 0 if not blocked.
+    srs_utime_t blocked_at_;
+    // Whether the first frame after resync is incomplete, so we stop scanning and wait for the reordered packets
+    // before the head, for example, the FU-A start of keyframe.
+    bool stalled_;
+private:
+    // The frame in building, by scanning packets in [head, cursor).
+    bool has_frame_ts_;
+    uint32_t frame_ts_;
+    bool keyframe_;
+    // The size of RTMP payload, the NALUs with 4 bytes size.
+    int nb_payload_;
+    // Whether in a FU-A NALU, which is not finished.
+    bool fua_open_;
+    // Whether the FU-A fragments are not matched, for example, a start fragment without end.
+    bool corrupt_;
+    // Whether the frame is the first one after resync, whose head might move backward by reordered packets.
+    bool first_frame_;
+public:
+    SrsRtcFrameBuilder(ISrsRtcFrameBuilderHandler* handler);
+    virtual ~SrsRtcFrameBuilder();
+public:
+    void set_jitter(srs_utime_t v);
+    // Consume the video packet, which is copied by builder, at the time now.
+    srs_error_t on_rtp(SrsRtpPacket* pkt, srs_utime_t now);
+private:
+    srs_error_t on_sequence_header(SrsRtpPacket* pkt);
+    // Scan the received packets from cursor, to build the completed frames.
+    srs_error_t scan(srs_utime_t now);
+    srs_error_t build_frame(uint16_t end);
+    // Start a new GOP at the keyframe packet.
+    void resync(SrsRtpPacket* pkt);
+    // Drop all packets and wait for keyframe.
+    void reset();
+    void reset_frame();
+};
+
+// Package the H.264 NALUs to RTP packets of the video track of RTC source, which is shared by the bridges
+// from RTMP and SRT to RTC.
+class SrsRtcH264Packager
+{
+private:
+    SrsRtcSource* source_;
+    uint16_t sequence_;
+    uint32_t ssrc_;
+    uint8_t payload_type_;
+public:
+    SrsRtcH264Packager(SrsRtcSource* source);
+    virtual ~SrsRtcH264Packager();
+public:
+    // Package the SPS/PPS in STAP-A, which is sent before each IDR.
+    srs_error_t package_stap_a(uint32_t timestamp, const char* sps, int nb_sps, const char* pps, int nb_pps, SrsRtpPacket* pkt);
+    // Package each NALU(sample) to a RTP or FU-A packets, and mark the last packet of frame.
+    srs_error_t package_samples(SrsSharedPtrMessage* msg, uint32_t timestamp, const std::vector<SrsSample*>& samples, std::vector<SrsRtpPacket*>& pkts);
+    // Package all NALUs(samples) as one NALU, in a RTP or FU-A packets.
+    srs_error_t package_nalus(SrsSharedPtrMessage* msg, uint32_t timestamp, const std::vector<SrsSample*>& samples, std::vector<SrsRtpPacket*>& pkts);
+    srs_error_t package_single_nalu(SrsSharedPtrMessage* msg, uint32_t timestamp, SrsSample* sample, std::vector<SrsRtpPacket*>& pkts);
+    srs_error_t package_fu_a(SrsSharedPtrMessage* msg, uint32_t timestamp, SrsSample* sample, int fu_payload_size, std::vector<SrsRtpPacket*>& pkts);
+    // Deliver the packets to source, then free them.
+    srs_error_t consume_packets(std::vector<SrsRtpPacket*>& pkts);
+};
+
 #ifdef SRS_FFMPEG_FIT
 class SrsRtcFromRtmpBridge : public ISrsLiveSourceBridge
 {
@@ -261,11 +388,9 @@ private:
     bool keep_bframe;
     bool merge_nalus;
     uint16_t audio_sequence;
-    uint16_t video_sequence;
     uint32_t audio_ssrc;
-    uint32_t video_ssrc;
     uint8_t audio_payload_type_;
-    uint8_t video_payload_type_;
+    SrsRtcH264Packager* video_packager_;
 public:
     SrsRtcFromRtmpBridge(SrsRtcSource* source);
     virtual ~SrsRtcFromRtmpBridge();
@@ -282,14 +407,10 @@ public:
     virtual srs_error_t on_video(SrsSharedPtrMessage* msg);
 private:
     srs_error_t filter(SrsSharedPtrMessage* msg, SrsFormat* format, bool& has_idr, std::vector<SrsSample*>& samples);
-    srs_error_t package_stap_a(SrsRtcSource* source, SrsSharedPtrMessage* msg, SrsRtpPacket* pkt);
-    srs_error_t package_nalus(SrsSharedPtrMessage* msg, const std::vector<SrsSample*>& samples, std::vector<SrsRtpPacket*>& pkts);
-    srs_error_t package_single_nalu(SrsSharedPtrMessage* msg, SrsSample* sample, std::vector<SrsRtpPacket*>& pkts);
-    srs_error_t package_fu_a(SrsSharedPtrMessage* msg, SrsSample* sample, int fu_payload_size, std::vector<SrsRtpPacket*>& pkts);
-    srs_error_t consume_packets(std::vector<SrsRtpPacket*>& pkts);
+    srs_error_t package_stap_a(SrsSharedPtrMessage* msg, SrsRtpPacket* pkt);
 };
 
-class SrsRtmpFromRtcBridge : public ISrsRtcSourceBridge
+class SrsRtmpFromRtcBridge : public ISrsRtcSourceBridge, public ISrsRtcFrameBuilderHandler
 {
 private:
     SrsLiveSource *source_;
@@ -298,21 +419,8 @@ private:
     bool is_first_video;
     // The format, codec information.
     SrsRtmpFormat* format;
-
-    //TODO:use SrsRtpRingBuffer
-    //TODO:jitter buffer class
-    struct RtcPacketCache {
-        bool in_use;
-        uint16_t sn;
-        uint32_t ts;
-        uint32_t rtp_ts;
-        SrsRtpPacket* pkt;
-    };
-    const static uint16_t s_cache_size = 512;
-    RtcPacketCache cache_video_pkts_[s_cache_size];
-    uint16_t header_sn_;
-    uint16_t lost_sn_;
-    int64_t rtp_key_frame_ts_;
+    // The jitter buffer and frame assembler for video.
+    SrsRtcFrameBuilder* video_builder_;
 public:
     SrsRtmpFromRtcBridge(SrsLiveSource *src);
     virtual ~SrsRtmpFromRtcBridge();
@@ -325,15 +433,51 @@ public:
 private:
     srs_error_t transcode_audio(SrsRtpPacket *pkt);
     void packet_aac(SrsCommonMessage* audio, char* data, int len, uint32_t pts, bool is_header);
-    srs_error_t packet_video(SrsRtpPacket* pkt);
-    srs_error_t packet_video_key_frame(SrsRtpPacket* pkt);
-    srs_error_t packet_video_rtmp(const uint16_t start, const uint16_t end);
-    int32_t find_next_lost_sn(uint16_t current_sn, uint16_t& end_sn);
-    void clear_cached_video();
-    inline uint16_t cache_index(uint16_t current_sn) {
-        return current_sn % s_cache_size;
-    }
-    bool check_frame_complete(const uint16_t start, const uint16_t end);
+// Interface ISrsRtcFrameBuilderHandler
+public:
+    virtual srs_error_t on_frame(SrsCommonMessage* frame);
+};
+#endif
+
+#ifdef SRS_SRT
+// Bridge SRT to RTC, which packages the H.264 NALUs in TS PES to RTP packets directly, without converting to RTMP.
+// The AAC is transcoded to Opus only when FFmpeg is enabled, or it's video only.
+class SrsRtcFromSrtBridge : public ISrsSrtSourceBridge, public ISrsTsHandler
+{
+private:
+    SrsRequest* req_;
+    SrsRtcSource* source_;
+    // The TS context to demux the PES frames.
+    SrsTsContext* ts_ctx_;
+    bool keep_bframe_;
+    // The latest SPS/PPS in stream, packaged in STAP-A before each IDR.
+    std::string sps_;
+    std::string pps_;
+#ifdef SRS_FFMPEG_FIT
+    SrsAudioTranscoder* codec_;
+#endif
+private:
+    uint16_t audio_sequence_;
+    uint32_t audio_ssrc_;
+    uint8_t audio_payload_type_;
+    SrsRtcH264Packager* video_packager_;
+public:
+    SrsRtcFromSrtBridge(SrsRtcSource* source);
+    virtual ~SrsRtcFromSrtBridge();
+public:
+    srs_error_t initialize(SrsRequest* req);
+    virtual srs_error_t on_publish();
+    virtual srs_error_t on_packet(SrsSrtPacket* pkt);
+    virtual void on_unpublish();
+// Interface ISrsTsHandler
+public:
+    virtual srs_error_t on_ts_message(SrsTsMessage* msg);
+private:
+    srs_error_t on_ts_video_avc(SrsTsMessage* msg);
+#ifdef SRS_FFMPEG_FIT
+    srs_error_t on_ts_audio(SrsTsMessage* msg);
+    srs_error_t transcode(SrsAudioFrame* audio);
+#endif
 };
 #endif
 
@@ -460,6 +604,9 @@ public:
     std::string mid_;
     // msid_: track stream id
     std::string msid_;
+    // For simulcast, the RID of layer, and all layers share the same track id. The SSRC of layer is unknown in SDP,
+    // so it's zero until got the RTP packet with RID extension.
+    std::string rid_;
 
     // meida payload, such as opus, h264.
     SrsCodecPayload* media_;
@@ -504,6 +651,8 @@ public:
 public:
     SrsRtcSourceDescription* copy();
     SrsRtcTrackDescription* find_track_description_by_ssrc(uint32_t ssrc);
+    // Find the video track of simulcast layer, by the track id and RID.
+    SrsRtcTrackDescription* find_track_description_by_rid(std::string id, std::string rid);
 };
 
 class SrsRtcRecvTrack
@@ -514,6 +663,8 @@ protected:
     SrsRtcConnection* session_;
     SrsRtpRingBuffer* rtp_queue_;
     SrsRtpNackForReceiver* nack_receiver_;
+    // The extension layout of track, built once by the negotiated extmaps of track.
+    SrsRtpExtensionTypes extension_types_;
 private:
     // By config, whether no copy.
     bool nack_no_copy_;
@@ -536,6 +687,8 @@ public:
     void set_nack_no_copy(bool v) { nack_no_copy_ = v; }
     bool has_ssrc(uint32_t ssrc);
     uint32_t get_ssrc();
+    // Get the extension layout of track, to decode the RTP packets of this track.
+    SrsRtpExtensionTypes* extension_types();
     void update_rtt(int rtt);
     void update_send_report_time(const SrsNtp& ntp, uint32_t rtp_time);
     int64_t cal_avsync_time(uint32_t rtp_time);
@@ -544,6 +697,11 @@ public:
     bool set_track_status(bool active);
     bool get_track_status();
     std::string get_track_id();
+    // Get the RID of simulcast layer, empty if not simulcast.
+    std::string get_rid();
+    // For simulcast, bind the SSRC to the layer if the RID in RTP header extension matches, because there is no
+    // SSRC in SDP for RID based simulcast. Return whether bound to this track.
+    bool bind_simulcast_ssrc(char* buf, int size, uint32_t ssrc);
 public:
     // Note that we can set the pkt to NULL to avoid copy, for example, if the NACK cache the pkt and
     // set to NULL, nack nerver copy it but set the pkt to NULL.
@@ -598,6 +756,9 @@ private:
     T base_;
     // Whether initialized. Note that we should not use correct_base_(0) as init state, because it might flip back.
     bool init_;
+    // Whether rebase at the next value, which continues from the last corrected value plus the delta.
+    bool rebase_;
+    T rebase_delta_;
 public:
     SrsRtcJitter(T base, ST threshold, PFN distance) {
         threshold_ = threshold;
@@ -607,19 +768,30 @@ public:
         pkt_base_ = pkt_last_ = 0;
         correct_last_ = correct_base_ = 0;
         init_ = false;
+        rebase_ = false;
+        rebase_delta_ = 0;
     }
     virtual ~SrsRtcJitter() {
     }
 public:
+    // Rebase at the next value, for example, switch to another simulcast layer, whose value is not continuous.
+    void rebase(T delta) {
+        rebase_ = init_;
+        rebase_delta_ = delta;
+    }
     T correct(T value) {
         if (!init_) {
             init_ = true;
             correct_base_ = base_;
-            pkt_base_ = value;
+            pkt_base_ = pkt_last_ = value;
             srs_trace("RTC: Jitter init base=%u, value=%u", base_, value);
         }
 
-        if (true) {
+        if (rebase_) {
+            rebase_ = false;
+            pkt_base_ = value;
+            correct_base_ = correct_last_ + rebase_delta_;
+        } else {
             ST distance = distance_(value, pkt_last_);
             if (distance > threshold_ || distance < -1 * threshold_) {
                 srs_trace("RTC: Jitter rebase value=%u, last=%u, distance=%d, pkt-base=%u/%u, correct-base=%u/%u",
@@ -646,6 +818,7 @@ public:
     virtual ~SrsRtcTsJitter();
 public:
     uint32_t correct(uint32_t value);
+    void rebase(uint32_t delta);
 };
 
 // For RTC sequence jitter.
@@ -658,6 +831,7 @@ public:
     virtual ~SrsRtcSeqJitter();
 public:
     uint16_t correct(uint16_t value);
+    void rebase(uint16_t delta);
 };
 
 class SrsRtcSendTrack
@@ -712,14 +886,64 @@ public:
     virtual srs_error_t on_rtcp(SrsRtpPacket* pkt);
 };
 
+// The simulcast layer from publisher, identified by the SSRC.
+class SrsRtcSimulcastLayer
+{
+public:
+    uint32_t ssrc_;
+    std::string rid_;
+    // The bitrate in bps, measured in the last window.
+    int64_t bitrate_;
+    int64_t bytes_;
+public:
+    SrsRtcSimulcastLayer(uint32_t ssrc, std::string rid);
+    virtual ~SrsRtcSimulcastLayer();
+};
+
 class SrsRtcVideoSendTrack : public SrsRtcSendTrack
 {
+private:
+    // For simulcast, the layers from publisher, the current layer forwarding to player, and the target layer which
+    // we switch to at the next keyframe of it.
+    std::vector<SrsRtcSimulcastLayer*> layers_;
+    SrsRtcSimulcastLayer* layer_;
+    SrsRtcSimulcastLayer* target_;
+    // The RID specified by API, which overwrites the layer selected by bandwidth.
+    std::string forced_rid_;
+    // The estimated bandwidth of player in bps, 0 if unknown.
+    int64_t bandwidth_;
+    // The start time of window to measure the bitrate of layers.
+    srs_utime_t window_start_;
+    srs_utime_t last_switch_;
+    srs_utime_t last_pli_;
+    srs_utime_t last_sent_;
+    // Whether switched to the upper layer without enough bandwidth, and the interval to probe the upper layer, which
+    // is increased if probing failed.
+    bool probing_;
+    srs_utime_t probe_interval_;
 public:
     SrsRtcVideoSendTrack(SrsRtcConnection* session, SrsRtcTrackDescription* track_desc);
     virtual ~SrsRtcVideoSendTrack();
 public:
     virtual srs_error_t on_rtp(SrsRtpPacket* pkt);
     virtual srs_error_t on_rtcp(SrsRtpPacket* pkt);
+public:
+    // Whether forward the simulcast layers from publisher.
+    bool is_simulcast();
+    void add_layer(uint32_t ssrc, std::string rid);
+    // Specify the layer by RID, or empty to select layer by bandwidth.
+    void set_layer(std::string rid);
+    // Get the SSRC of current layer, 0 if no layer.
+    uint32_t get_layer_ssrc();
+    void on_bandwidth(int64_t bps);
+    // For simulcast, whether forward the packet of layer to player, and only switch layer at keyframe, so that the
+    // decoder of player never sees a broken GOP.
+    // @param ppli_ssrc Set to the SSRC of layer to request keyframe, or 0 if no need.
+    bool on_layer_packet(SrsRtpPacket* pkt, srs_utime_t now, uint32_t* ppli_ssrc);
+private:
+    void update_layers(srs_utime_t now);
+    SrsRtcSimulcastLayer* select_layer(srs_utime_t now);
+    void switch_layer(SrsRtcSimulcastLayer* layer, srs_utime_t now);
 };
 
 class SrsRtcSSRCGenerator
@@ -39,6 +39,9 @@ using namespace std;
 #include <srs_protocol_json.hpp>
 #include <srs_app_rtc_source.hpp>
 #include <srs_app_tencentcloud.hpp>
+#include <srs_app_hybrid.hpp>
+#include <srs_app_coworkers.hpp>
+#include <srs_kernel_buffer.hpp>
 
 // the timeout in srs_utime_t to wait encoder to republish
 // if timeout, close the connection.
@@ -74,6 +77,450 @@ srs_error_t SrsSimpleRtmpClient::connect_app()
     return do_connect_app(local_ip->ip, debug_srs_upnode);
 }
 
+ISrsRtmpPublisher::ISrsRtmpPublisher()
+{
+}
+
+ISrsRtmpPublisher::~ISrsRtmpPublisher()
+{
+}
+
+ISrsRtmpPublisher* srs_rtmp_publisher_create(string url, srs_utime_t ctm, srs_utime_t stm)
+{
+    if (srs_rtmp_url_is_local(url)) {
+        return new SrsLocalRtmpPublisher(url);
+    }
+    return new SrsRtmpClientPublisher(url, ctm, stm);
+}
+
+bool srs_rtmp_url_is_local(string url)
+{
+    SrsRequest req;
+    srs_parse_rtmp_url(url, req.tcUrl, req.stream);
+    srs_discovery_tc_url(req.tcUrl, req.schema, req.host, req.vhost, req.app, req.stream, req.port, req.param);
+
+    if (req.schema != "rtmp" || req.host.empty()) {
+        return false;
+    }
+
+    // For edge, we must proxy the stream to origin by RTMP client.
+    SrsConfDirective* vhost = _srs_config->get_vhost(req.vhost, true);
+    if (!vhost || _srs_config->get_vhost_is_edge(vhost->arg0())) {
+        return false;
+    }
+
+    // Whether the host is the address of this server, note that loopback is not in local ips.
+    bool local_host = (req.host == SRS_CONSTS_LOCALHOST || req.host == SRS_CONSTS_LOCALHOST_NAME || req.host == "::1");
+    std::vector<SrsIPAddress*>& ips = srs_get_local_ips();
+    for (int i = 0; !local_host && i < (int)ips.size(); i++) {
+        local_host = (ips[i]->ip == req.host);
+    }
+    if (!local_host) {
+        return false;
+    }
+
+    // Whether the port is listened by this server, for any address or the host.
+    std::vector<std::string> listens = _srs_config->get_listens();
+    for (int i = 0; i < (int)listens.size(); i++) {
+        string ip;
+        int port = 0;
+        srs_parse_endpoint(listens.at(i), ip, port);
+        if (port != req.port) {
+            continue;
+        }
+        if (ip.empty() || ip == "0.0.0.0" || ip == "::" || ip == req.host) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+SrsRtmpClientPublisher::SrsRtmpClientPublisher(string url, srs_utime_t ctm, srs_utime_t stm)
+{
+    sdk_ = new SrsSimpleRtmpClient(url, ctm, stm);
+}
+
+SrsRtmpClientPublisher::~SrsRtmpClientPublisher()
+{
+    srs_freep(sdk_);
+}
+
+srs_error_t SrsRtmpClientPublisher::connect()
+{
+    return sdk_->connect();
+}
+
+srs_error_t SrsRtmpClientPublisher::publish(int chunk_size)
+{
+    return sdk_->publish(chunk_size);
+}
+
+void SrsRtmpClientPublisher::close()
+{
+    sdk_->close();
+}
+
+int SrsRtmpClientPublisher::sid()
+{
+    return sdk_->sid();
+}
+
+srs_error_t SrsRtmpClientPublisher::send_and_free_message(SrsSharedPtrMessage* msg)
+{
+    return sdk_->send_and_free_message(msg);
+}
+
+// Copy the http hooks of vhost, empty if http hooks disabled. The http hooks will cause context switch, so we must
+// copy all hooks for the conf may be freed when reload.
+// @see https://github.com/ossrs/srs/issues/475
+static vector<string> srs_rtmp_copy_hooks(SrsRequest* req, SrsConfDirective* conf)
+{
+    vector<string> hooks;
+
+    if (conf && _srs_config->get_vhost_http_hooks_enabled(req->vhost)) {
+        hooks = conf->args;
+    }
+
+    return hooks;
+}
+
+// The http hooks of RTMP stream, shared by the RTMP connection and the in-process publisher.
+static srs_error_t srs_rtmp_hooks_on_connect(SrsRequest* req)
+{
+    srs_error_t err = srs_success;
+
+    vector<string> hooks = srs_rtmp_copy_hooks(req, _srs_config->get_vhost_on_connect(req->vhost));
+    for (int i = 0; i < (int)hooks.size(); i++) {
+        std::string url = hooks.at(i);
+        if ((err = SrsHttpHooks::on_connect(url, req)) != srs_success) {
+            return srs_error_wrap(err, "rtmp on_connect %s", url.c_str());
+        }
+    }
+
+    return err;
+}
+
+static void srs_rtmp_hooks_on_close(SrsRequest* req, int64_t send_bytes, int64_t recv_bytes)
+{
+    vector<string> hooks = srs_rtmp_copy_hooks(req, _srs_config->get_vhost_on_close(req->vhost));
+    for (int i = 0; i < (int)hooks.size(); i++) {
+        std::string url = hooks.at(i);
+        SrsHttpHooks::on_close(url, req, send_bytes, recv_bytes);
+    }
+}
+
+static srs_error_t srs_rtmp_hooks_on_publish(SrsRequest* req)
+{
+    srs_error_t err = srs_success;
+
+    vector<string> hooks = srs_rtmp_copy_hooks(req, _srs_config->get_vhost_on_publish(req->vhost));
+    for (int i = 0; i < (int)hooks.size(); i++) {
+        std::string url = hooks.at(i);
+        if ((err = SrsHttpHooks::on_publish(url, req)) != srs_success) {
+            return srs_error_wrap(err, "rtmp on_publish %s", url.c_str());
+        }
+    }
+
+    return err;
+}
+
+static void srs_rtmp_hooks_on_unpublish(SrsRequest* req)
+{
+    vector<string> hooks = srs_rtmp_copy_hooks(req, _srs_config->get_vhost_on_unpublish(req->vhost));
+    for (int i = 0; i < (int)hooks.size(); i++) {
+        std::string url = hooks.at(i);
+        SrsHttpHooks::on_unpublish(url, req);
+    }
+}
+
+static srs_error_t srs_rtmp_hooks_on_play(SrsRequest* req)
+{
+    srs_error_t err = srs_success;
+
+    vector<string> hooks = srs_rtmp_copy_hooks(req, _srs_config->get_vhost_on_play(req->vhost));
+    for (int i = 0; i < (int)hooks.size(); i++) {
+        std::string url = hooks.at(i);
+        if ((err = SrsHttpHooks::on_play(url, req)) != srs_success) {
+            return srs_error_wrap(err, "rtmp on_play %s", url.c_str());
+        }
+    }
+
+    return err;
+}
+
+static void srs_rtmp_hooks_on_stop(SrsRequest* req)
+{
+    vector<string> hooks = srs_rtmp_copy_hooks(req, _srs_config->get_vhost_on_stop(req->vhost));
+    for (int i = 0; i < (int)hooks.size(); i++) {
+        std::string url = hooks.at(i);
+        SrsHttpHooks::on_stop(url, req);
+    }
+}
+
+SrsLocalRtmpPublisher::SrsLocalRtmpPublisher(string url)
+{
+    req_ = new SrsRequest();
+    srs_parse_rtmp_url(url, req_->tcUrl, req_->stream);
+    srs_discovery_tc_url(req_->tcUrl, req_->schema, req_->host, req_->vhost, req_->app, req_->stream, req_->port, req_->param);
+    // The caster publish to this server, so it's always from the loopback address.
+    req_->ip = SRS_CONSTS_LOCALHOST;
+
+    security_ = new SrsSecurity();
+    source_ = NULL;
+    cid_ = _srs_context->generate_id();
+    recv_bytes_ = 0;
+    expired_ = false;
+
+    connected_ = false;
+    stat_client_ = false;
+    hooks_published_ = false;
+    source_published_ = false;
+}
+
+SrsLocalRtmpPublisher::~SrsLocalRtmpPublisher()
+{
+    close();
+
+    srs_freep(security_);
+    srs_freep(req_);
+}
+
+srs_error_t SrsLocalRtmpPublisher::connect()
+{
+    srs_error_t err = srs_success;
+
+    close();
+
+    // Discovery vhost, allow default vhost.
+    SrsConfDirective* vhost = _srs_config->get_vhost(req_->vhost, true);
+    if (vhost == NULL) {
+        return srs_error_new(ERROR_RTMP_VHOST_NOT_FOUND, "local: no vhost %s", req_->vhost.c_str());
+    }
+    req_->vhost = vhost->arg0();
+
+    if (!_srs_config->get_vhost_enabled(req_->vhost)) {
+        return srs_error_new(ERROR_RTMP_VHOST_NOT_FOUND, "local: vhost %s disabled", req_->vhost.c_str());
+    }
+
+    if (req_->schema.empty() || req_->port == 0 || req_->app.empty()) {
+        return srs_error_new(ERROR_RTMP_REQ_TCURL, "local: discovery tcUrl failed, tcUrl=%s, schema=%s, port=%d, app=%s",
+            req_->tcUrl.c_str(), req_->schema.c_str(), req_->port, req_->app.c_str());
+    }
+
+    if ((err = http_hooks_on_connect()) != srs_success) {
+        return srs_error_wrap(err, "local: callback on connect");
+    }
+    connected_ = true;
+
+    return err;
+}
+
+srs_error_t SrsLocalRtmpPublisher::publish(int /*chunk_size*/)
+{
+    srs_error_t err = srs_success;
+
+    if ((err = security_->check(SrsRtmpConnFMLEPublish, req_->ip, req_)) != srs_success) {
+        return srs_error_wrap(err, "local: security check");
+    }
+
+    // Never allow the empty stream name, for HLS may write to a file with empty name.
+    if (req_->stream.empty()) {
+        return srs_error_new(ERROR_RTMP_STREAM_NAME_EMPTY, "local: empty stream");
+    }
+
+    if ((err = _srs_sources->fetch_or_create(req_, _srs_hybrid->srs()->instance(), &source_)) != srs_success) {
+        return srs_error_wrap(err, "local: fetch source");
+    }
+    srs_assert(source_ != NULL);
+
+    source_->set_cache(_srs_config->get_gop_cache(req_->vhost));
+    source_->set_gop_cache_max_frames(_srs_config->get_gop_cache_max_frames(req_->vhost));
+
+    // We must do stat the client before hooks, because hooks depends on it.
+    SrsStatistic* stat = SrsStatistic::instance();
+    if ((err = stat->on_client(cid_.c_str(), req_, this, SrsRtmpConnFMLEPublish)) != srs_success) {
+        return srs_error_wrap(err, "local: stat client");
+    }
+    stat_client_ = true;
+
+    // We must do hook after stat, because depends on it.
+    if ((err = http_hooks_on_publish()) != srs_success) {
+        return srs_error_wrap(err, "local: callback on publish");
+    }
+    hooks_published_ = true;
+
+    if ((err = acquire_publish()) != srs_success) {
+        return srs_error_wrap(err, "local: acquire publish");
+    }
+
+    srs_trace("local: publish %s in process, cid=%s", req_->get_stream_url().c_str(), cid_.c_str());
+
+    return err;
+}
+
+void SrsLocalRtmpPublisher::close()
+{
+    if (source_published_) {
+        source_->on_unpublish();
+    }
+    if (hooks_published_) {
+        http_hooks_on_unpublish();
+    }
+    if (stat_client_) {
+        SrsStatistic::instance()->on_disconnect(cid_.c_str(), srs_success);
+    }
+    if (connected_) {
+        http_hooks_on_close();
+    }
+
+    source_ = NULL;
+    expired_ = false;
+    connected_ = stat_client_ = hooks_published_ = source_published_ = false;
+}
+
+int SrsLocalRtmpPublisher::sid()
+{
+    // Same to the stream id of RTMP server, which is useless for in-process publisher.
+    return 1;
+}
+
+srs_error_t SrsLocalRtmpPublisher::send_and_free_message(SrsSharedPtrMessage* msg)
+{
+    srs_error_t err = srs_success;
+
+    SrsAutoFree(SrsSharedPtrMessage, msg);
+
+    if (expired_) {
+        return srs_error_new(ERROR_THREAD_INTERRUPED, "local: kickoff %s", req_->get_stream_url().c_str());
+    }
+
+    if (!source_published_) {
+        return srs_error_new(ERROR_RTMP_STREAM_NOT_FOUND, "local: not publishing %s", req_->get_stream_url().c_str());
+    }
+
+    recv_bytes_ += msg->size;
+
+    if (msg->is_audio()) {
+        if ((err = source_->on_frame(msg)) != srs_success) {
+            return srs_error_wrap(err, "local: consume audio");
+        }
+        return err;
+    }
+
+    if (msg->is_video()) {
+        if ((err = source_->on_frame(msg)) != srs_success) {
+            return srs_error_wrap(err, "local: consume video");
+        }
+
+        // Update the stat for video fps.
+        if ((err = SrsStatistic::instance()->on_video_frames(req_, 1)) != srs_success) {
+            return srs_error_wrap(err, "local: stat video frames");
+        }
+        return err;
+    }
+
+    // For casters, the others are FLV script data in AMF0, such as onMetaData.
+    if ((err = on_meta_data(msg)) != srs_success) {
+        return srs_error_wrap(err, "local: consume metadata");
+    }
+
+    return err;
+}
+
+void SrsLocalRtmpPublisher::expire()
+{
+    expired_ = true;
+}
+
+srs_error_t SrsLocalRtmpPublisher::acquire_publish()
+{
+    srs_error_t err = srs_success;
+
+    // Check whether RTMP stream is busy.
+    if (!source_->can_publish(false)) {
+        return srs_error_new(ERROR_SYSTEM_STREAM_BUSY, "local: stream %s is busy", req_->get_stream_url().c_str());
+    }
+
+    // Check whether RTC stream is busy, and bridge to RTC streaming.
+#ifdef SRS_RTC
+    if ((err = srs_rtc_bridge_live_source(req_, false, source_)) != srs_success) {
+        return srs_error_wrap(err, "local: rtc bridge");
+    }
+#endif
+
+    // Whatever the result, the source is changed to publishing state, so we must release it.
+    source_published_ = true;
+    return source_->on_publish();
+}
+
+srs_error_t SrsLocalRtmpPublisher::on_meta_data(SrsSharedPtrMessage* msg)
+{
+    srs_error_t err = srs_success;
+
+    if (!msg->payload || msg->size <= 0) {
+        return err;
+    }
+
+    // Only the onMetaData or @setDataFrame is metadata, ignore others.
+    SrsBuffer stream(msg->payload, msg->size);
+    string name;
+    if ((err = srs_amf0_read_string(&stream, name)) != srs_success) {
+        srs_freep(err);
+        return err;
+    }
+    if (name != SRS_CONSTS_RTMP_SET_DATAFRAME && name != SRS_CONSTS_RTMP_ON_METADATA) {
+        return err;
+    }
+
+    SrsOnMetaDataPacket* metadata = new SrsOnMetaDataPacket();
+    SrsAutoFree(SrsOnMetaDataPacket, metadata);
+
+    stream.skip(-1 * stream.pos());
+    if ((err = metadata->decode(&stream)) != srs_success) {
+        return srs_error_wrap(err, "decode metadata");
+    }
+
+    // Build the message from the encoded metadata, as the RTMP connection which passes the received message.
+    int size = 0;
+    char* payload = NULL;
+    if ((err = metadata->encode(size, payload)) != srs_success) {
+        return srs_error_wrap(err, "encode metadata");
+    }
+
+    SrsMessageHeader header;
+    header.initialize_amf0_script(size, msg->stream_id);
+    header.timestamp = msg->timestamp;
+
+    // The message owns and frees the payload.
+    SrsCommonMessage common;
+    if ((err = common.create(&header, payload, size)) != srs_success) {
+        return srs_error_wrap(err, "create metadata");
+    }
+
+    return source_->on_meta_data(&common, metadata);
+}
+
+srs_error_t SrsLocalRtmpPublisher::http_hooks_on_connect()
+{
+    return srs_rtmp_hooks_on_connect(req_);
+}
+
+void SrsLocalRtmpPublisher::http_hooks_on_close()
+{
+    srs_rtmp_hooks_on_close(req_, 0, recv_bytes_);
+}
+
+srs_error_t SrsLocalRtmpPublisher::http_hooks_on_publish()
+{
+    return srs_rtmp_hooks_on_publish(req_);
+}
+
+void SrsLocalRtmpPublisher::http_hooks_on_unpublish()
+{
+    srs_rtmp_hooks_on_unpublish(req_);
+}
+
 SrsClientInfo::SrsClientInfo()
 {
     edge = false;
@@ -713,6 +1160,21 @@ srs_error_t SrsRtmpConn::playing(SrsLiveSource* source)
     // When origin cluster enabled, try to redirect to the origin which is active.
     // A active origin is a server which is delivering stream.
     if (!info->edge && _srs_config->get_vhost_origin_cluster(req->vhost) && source->inactive()) {
+        // Resolve the origin from the stream directory synced from co-workers, without querying each co-worker.
+        SrsCoWorkerStream* location = SrsCoWorkers::instance()->lookup(req->vhost, req->app, req->stream);
+        if (location && !location->ip.empty() && location->port > 0) {
+            string rurl = srs_generate_rtmp_url(location->ip, location->port, req->host, req->vhost, req->app, req->stream, req->param);
+            srs_trace("rtmp: redirect in cluster by directory, from=%s:%d, target=%s:%d, rurl=%s",
+                req->host.c_str(), req->port, location->ip.c_str(), location->port, rurl.c_str());
+
+            bool accepted = false;
+            if ((err = rtmp->redirect(req, rurl, accepted)) != srs_success) {
+                srs_error_reset(err);
+            } else {
+                return srs_error_new(ERROR_CONTROL_REDIRECT, "redirected");
+            }
+        }
+
         vector<string> coworkers = _srs_config->get_vhost_coworkers(req->vhost);
         for (int i = 0; i < (int)coworkers.size(); i++) {
             // TODO: FIXME: User may config the server itself as coworker, we must identify and ignore it.
@@ -1079,32 +1541,10 @@ srs_error_t SrsRtmpConn::acquire_publish(SrsLiveSource* source)
         return srs_error_new(ERROR_SYSTEM_STREAM_BUSY, "rtmp: stream %s is busy", req->get_stream_url().c_str());
     }
 
-    // Check whether RTC stream is busy.
+    // Check whether RTC stream is busy, and bridge to RTC streaming.
 #ifdef SRS_RTC
-    SrsRtcSource *rtc = NULL;
-    bool rtc_server_enabled = _srs_config->get_rtc_server_enabled();
-    bool rtc_enabled = _srs_config->get_rtc_enabled(req->vhost);
-    if (rtc_server_enabled && rtc_enabled && !info->edge) {
-        if ((err = _srs_rtc_sources->fetch_or_create(req, &rtc)) != srs_success) {
-            return srs_error_wrap(err, "create source");
-        }
-
-        if (!rtc->can_publish()) {
-            return srs_error_new(ERROR_SYSTEM_STREAM_BUSY, "rtc stream %s busy", req->get_stream_url().c_str());
-        }
-    }
-#endif
-
-    // Bridge to RTC streaming.
-#if defined(SRS_RTC) && defined(SRS_FFMPEG_FIT)
-    if (rtc) {
-        SrsRtcFromRtmpBridge *bridge = new SrsRtcFromRtmpBridge(rtc);
-        if ((err = bridge->initialize(req)) != srs_success) {
-            srs_freep(bridge);
-            return srs_error_wrap(err, "bridge init");
-        }
-
-        source->set_bridge(bridge);
+    if ((err = srs_rtc_bridge_live_source(req, info->edge, source)) != srs_success) {
+        return srs_error_wrap(err, "rtc bridge");
     }
 #endif
 
@@ -1375,196 +1815,32 @@ srs_error_t SrsRtmpConn::on_disconnect()
 
 srs_error_t SrsRtmpConn::http_hooks_on_connect()
 {
-    srs_error_t err = srs_success;
-    
-    SrsRequest* req = info->req;
-    
-    if (!_srs_config->get_vhost_http_hooks_enabled(req->vhost)) {
-        return err;
-    }
-    
-    // the http hooks will cause context switch,
-    // so we must copy all hooks for the on_connect may freed.
-    // @see https://github.com/ossrs/srs/issues/475
-    vector<string> hooks;
-    
-    if (true) {
-        SrsConfDirective* conf = _srs_config->get_vhost_on_connect(req->vhost);
-        
-        if (!conf) {
-            return err;
-        }
-        
-        hooks = conf->args;
-    }
-    
-    for (int i = 0; i < (int)hooks.size(); i++) {
-        std::string url = hooks.at(i);
-        if ((err = SrsHttpHooks::on_connect(url, req)) != srs_success) {
-            return srs_error_wrap(err, "rtmp on_connect %s", url.c_str());
-        }
-    }
-    
-    return err;
+    return srs_rtmp_hooks_on_connect(info->req);
 }
 
 void SrsRtmpConn::http_hooks_on_close()
 {
-    SrsRequest* req = info->req;
-    
-    if (!_srs_config->get_vhost_http_hooks_enabled(req->vhost)) {
-        return;
-    }
-    
-    // the http hooks will cause context switch,
-    // so we must copy all hooks for the on_connect may freed.
-    // @see https://github.com/ossrs/srs/issues/475
-    vector<string> hooks;
-    
-    if (true) {
-        SrsConfDirective* conf = _srs_config->get_vhost_on_close(req->vhost);
-        
-        if (!conf) {
-            return;
-        }
-        
-        hooks = conf->args;
-    }
-    
-    for (int i = 0; i < (int)hooks.size(); i++) {
-        std::string url = hooks.at(i);
-        SrsHttpHooks::on_close(url, req, skt->get_send_bytes(), skt->get_recv_bytes());
-    }
+    srs_rtmp_hooks_on_close(info->req, skt->get_send_bytes(), skt->get_recv_bytes());
 }
 
 srs_error_t SrsRtmpConn::http_hooks_on_publish()
 {
-    srs_error_t err = srs_success;
-    
-    SrsRequest* req = info->req;
-    
-    if (!_srs_config->get_vhost_http_hooks_enabled(req->vhost)) {
-        return err;
-    }
-    
-    // the http hooks will cause context switch,
-    // so we must copy all hooks for the on_connect may freed.
-    // @see https://github.com/ossrs/srs/issues/475
-    vector<string> hooks;
-    
-    if (true) {
-        SrsConfDirective* conf = _srs_config->get_vhost_on_publish(req->vhost);
-        
-        if (!conf) {
-            return err;
-        }
-        
-        hooks = conf->args;
-    }
-    
-    for (int i = 0; i < (int)hooks.size(); i++) {
-        std::string url = hooks.at(i);
-        if ((err = SrsHttpHooks::on_publish(url, req)) != srs_success) {
-            return srs_error_wrap(err, "rtmp on_publish %s", url.c_str());
-        }
-    }
-    
-    return err;
+    return srs_rtmp_hooks_on_publish(info->req);
 }
 
 void SrsRtmpConn::http_hooks_on_unpublish()
 {
-    SrsRequest* req = info->req;
-    
-    if (!_srs_config->get_vhost_http_hooks_enabled(req->vhost)) {
-        return;
-    }
-    
-    // the http hooks will cause context switch,
-    // so we must copy all hooks for the on_connect may freed.
-    // @see https://github.com/ossrs/srs/issues/475
-    vector<string> hooks;
-    
-    if (true) {
-        SrsConfDirective* conf = _srs_config->get_vhost_on_unpublish(req->vhost);
-        
-        if (!conf) {
-            return;
-        }
-        
-        hooks = conf->args;
-    }
-    
-    for (int i = 0; i < (int)hooks.size(); i++) {
-        std::string url = hooks.at(i);
-        SrsHttpHooks::on_unpublish(url, req);
-    }
+    srs_rtmp_hooks_on_unpublish(info->req);
 }
 
 srs_error_t SrsRtmpConn::http_hooks_on_play()
 {
-    srs_error_t err = srs_success;
-    
-    SrsRequest* req = info->req;
-    
-    if (!_srs_config->get_vhost_http_hooks_enabled(req->vhost)) {
-        return err;
-    }
-    
-    // the http hooks will cause context switch,
-    // so we must copy all hooks for the on_connect may freed.
-    // @see https://github.com/ossrs/srs/issues/475
-    vector<string> hooks;
-    
-    if (true) {
-        SrsConfDirective* conf = _srs_config->get_vhost_on_play(req->vhost);
-        
-        if (!conf) {
-            return err;
-        }
-        
-        hooks = conf->args;
-    }
-    
-    for (int i = 0; i < (int)hooks.size(); i++) {
-        std::string url = hooks.at(i);
-        if ((err = SrsHttpHooks::on_play(url, req)) != srs_success) {
-            return srs_error_wrap(err, "rtmp on_play %s", url.c_str());
-        }
-    }
-    
-    return err;
+    return srs_rtmp_hooks_on_play(info->req);
 }
 
 void SrsRtmpConn::http_hooks_on_stop()
 {
-    SrsRequest* req = info->req;
-    
-    if (!_srs_config->get_vhost_http_hooks_enabled(req->vhost)) {
-        return;
-    }
-    
-    // the http hooks will cause context switch,
-    // so we must copy all hooks for the on_connect may freed.
-    // @see https://github.com/ossrs/srs/issues/475
-    vector<string> hooks;
-    
-    if (true) {
-        SrsConfDirective* conf = _srs_config->get_vhost_on_stop(req->vhost);
-        
-        if (!conf) {
-            return;
-        }
-        
-        hooks = conf->args;
-    }
-    
-    for (int i = 0; i < (int)hooks.size(); i++) {
-        std::string url = hooks.at(i);
-        SrsHttpHooks::on_stop(url, req);
-    }
-    
-    return;
+    srs_rtmp_hooks_on_stop(info->req);
 }
 
 srs_error_t SrsRtmpConn::start()
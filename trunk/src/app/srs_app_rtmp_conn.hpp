@@ -50,6 +50,85 @@ protected:
     virtual srs_error_t connect_app();
 };
 
+// The publisher for casters, such as GB28181, MPEG-TS over UDP and HTTP-FLV, which convert the
+// stream to RTMP messages and publish to the output url.
+class ISrsRtmpPublisher
+{
+public:
+    ISrsRtmpPublisher();
+    virtual ~ISrsRtmpPublisher();
+public:
+    virtual srs_error_t connect() = 0;
+    virtual srs_error_t publish(int chunk_size) = 0;
+    virtual void close() = 0;
+    virtual int sid() = 0;
+    // Send the message, which is always freed by publisher.
+    virtual srs_error_t send_and_free_message(SrsSharedPtrMessage* msg) = 0;
+};
+
+// Create the publisher for the output url, which is in-process if the url is served by this
+// server, or a RTMP client over TCP for others, such as remote server or edge vhost.
+extern ISrsRtmpPublisher* srs_rtmp_publisher_create(std::string url, srs_utime_t ctm, srs_utime_t stm);
+// Whether the RTMP url is served by this server, and the vhost is origin.
+extern bool srs_rtmp_url_is_local(std::string url);
+
+// Publish to RTMP server over TCP, by the simple RTMP client.
+class SrsRtmpClientPublisher : public ISrsRtmpPublisher
+{
+private:
+    SrsSimpleRtmpClient* sdk_;
+public:
+    SrsRtmpClientPublisher(std::string url, srs_utime_t ctm, srs_utime_t stm);
+    virtual ~SrsRtmpClientPublisher();
+public:
+    virtual srs_error_t connect();
+    virtual srs_error_t publish(int chunk_size);
+    virtual void close();
+    virtual int sid();
+    virtual srs_error_t send_and_free_message(SrsSharedPtrMessage* msg);
+};
+
+// Publish to the live source of this server in process, without the loopback RTMP connection,
+// which does the same hooks, stat and security check as a RTMP publisher.
+class SrsLocalRtmpPublisher : public ISrsRtmpPublisher, public ISrsExpire
+{
+private:
+    SrsRequest* req_;
+    SrsSecurity* security_;
+    SrsLiveSource* source_;
+    // The id of client, for stat and kickoff.
+    SrsContextId cid_;
+    int64_t recv_bytes_;
+    // Whether expired by API, kickoff the publisher.
+    bool expired_;
+private:
+    // The state to cleanup, the hooks and source must be notified in the reverse order.
+    bool connected_;
+    bool stat_client_;
+    bool hooks_published_;
+    bool source_published_;
+public:
+    SrsLocalRtmpPublisher(std::string url);
+    virtual ~SrsLocalRtmpPublisher();
+// Interface ISrsRtmpPublisher
+public:
+    virtual srs_error_t connect();
+    virtual srs_error_t publish(int chunk_size);
+    virtual void close();
+    virtual int sid();
+    virtual srs_error_t send_and_free_message(SrsSharedPtrMessage* msg);
+// Interface ISrsExpire
+public:
+    virtual void expire();
+private:
+    virtual srs_error_t acquire_publish();
+    virtual srs_error_t on_meta_data(SrsSharedPtrMessage* msg);
+    virtual srs_error_t http_hooks_on_connect();
+    virtual void http_hooks_on_close();
+    virtual srs_error_t http_hooks_on_publish();
+    virtual void http_hooks_on_unpublish();
+};
+
 // Some information of client.
 class SrsClientInfo
 {
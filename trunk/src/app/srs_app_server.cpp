@@ -36,6 +36,7 @@ using namespace std;
 #include <srs_app_coworkers.hpp>
 #include <srs_protocol_log.hpp>
 #include <srs_app_latest_version.hpp>
+#include <srs_app_edge.hpp>
 #include <srs_app_conn.hpp>
 #ifdef SRS_RTC
 #include <srs_app_rtc_network.hpp>
@@ -420,6 +421,7 @@ void SrsServer::dispose()
 #ifdef SRS_GB28181
     stream_caster_gb28181_->close();
 #endif
+    _srs_edge_relay->close();
 
     // Fast stop to notify FFMPEG to quit, wait for a while then fast kill.
     ingester->dispose();
@@ -451,6 +453,7 @@ void SrsServer::gracefully_dispose()
 #ifdef SRS_GB28181
     stream_caster_gb28181_->close();
 #endif
+    _srs_edge_relay->close();
     srs_trace("listeners closed");
 
     // Fast stop to notify FFMPEG to quit, wait for a while then fast kill.
@@ -674,6 +677,18 @@ srs_error_t SrsServer::listen()
         }
     }
 
+    // Share the edge pull by the processes on the same box, the leader serves the followers.
+    if (_srs_config->get_edge_relay_enabled()) {
+        if ((err = _srs_edge_relay->initialize(this, _srs_config->get_edge_relay_listen())) != srs_success) {
+            return srs_error_wrap(err, "edge relay");
+        }
+    }
+
+    // Sync the stream directory from co-workers of origin cluster.
+    if ((err = SrsCoWorkers::instance()->start()) != srs_success) {
+        return srs_error_wrap(err, "coworkers");
+    }
+
     if ((err = conn_manager->start()) != srs_success) {
         return srs_error_wrap(err, "connection manager");
     }
@@ -1128,6 +1143,12 @@ srs_error_t SrsServer::do_on_tcp_client(ISrsListener* listener, srs_netfd_t& stf
     string ip = srs_get_peer_ip(fd);
     int port = srs_get_peer_port(fd);
 
+    // The follower of edge relay over unix domain socket, which is on the same box.
+    bool is_edge_relay = _srs_edge_relay->is_relay(listener);
+    if (is_edge_relay) {
+        ip = SRS_CONSTS_LOCALHOST;
+    }
+
     // Ignore if ip is empty, for example, load balancer keepalive.
     if (ip.empty()) {
         if (_srs_config->empty_ip_ok()) return err;
@@ -1182,7 +1203,7 @@ srs_error_t SrsServer::do_on_tcp_client(ISrsListener* listener, srs_netfd_t& stf
 
     // Create resource by normal listeners.
     if (!resource) {
-        if (listener == rtmp_listener_) {
+        if (listener == rtmp_listener_ || is_edge_relay) {
             resource = new SrsRtmpConn(this, stfd2, ip, port);
         } else if (listener == api_listener_ || listener == apis_listener_) {
             bool is_https = listener == apis_listener_;
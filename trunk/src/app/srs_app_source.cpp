@@ -834,6 +834,7 @@ SrsOriginHub::SrsOriginHub()
     hds = new SrsHds();
 #endif
     ng_exec = new SrsNgExec();
+    forward_ring_ = new SrsForwardRing();
     
     _srs_config->subscribe(this);
 }
@@ -850,6 +851,7 @@ SrsOriginHub::~SrsOriginHub()
         }
         forwarders.clear();
     }
+    srs_freep(forward_ring_);
     srs_freep(ng_exec);
 
     srs_freep(hls);
@@ -913,15 +915,9 @@ srs_error_t SrsOriginHub::on_meta_data(SrsSharedPtrMessage* shared_metadata, Srs
 {
     srs_error_t err = srs_success;
     
-    // copy to all forwarders
-    if (true) {
-        std::vector<SrsForwarder*>::iterator it;
-        for (it = forwarders.begin(); it != forwarders.end(); ++it) {
-            SrsForwarder* forwarder = *it;
-            if ((err = forwarder->on_meta_data(shared_metadata)) != srs_success) {
-                return srs_error_wrap(err, "Forwarder consume metadata");
-            }
-        }
+    // Copy once to the ring shared by all forwarders.
+    if (!forwarders.empty()) {
+        forward_ring_->push(shared_metadata);
     }
     
     if ((err = dvr->on_meta_data(shared_metadata)) != srs_success) {
@@ -1004,15 +1000,9 @@ srs_error_t SrsOriginHub::on_audio(SrsSharedPtrMessage* shared_audio)
     }
 #endif
     
-    // copy to all forwarders.
-    if (true) {
-        std::vector<SrsForwarder*>::iterator it;
-        for (it = forwarders.begin(); it != forwarders.end(); ++it) {
-            SrsForwarder* forwarder = *it;
-            if ((err = forwarder->on_audio(msg)) != srs_success) {
-                return srs_error_wrap(err, "forward: audio");
-            }
-        }
+    // Copy once to the ring shared by all forwarders.
+    if (!forwarders.empty()) {
+        forward_ring_->push(msg);
     }
     
     return err;
@@ -1098,15 +1088,9 @@ srs_error_t SrsOriginHub::on_video(SrsSharedPtrMessage* shared_video, bool is_se
     }
 #endif
     
-    // copy to all forwarders.
+    // Copy once to the ring shared by all forwarders.
     if (!forwarders.empty()) {
-        std::vector<SrsForwarder*>::iterator it;
-        for (it = forwarders.begin(); it != forwarders.end(); ++it) {
-            SrsForwarder* forwarder = *it;
-            if ((err = forwarder->on_video(msg)) != srs_success) {
-                return srs_error_wrap(err, "forward video");
-            }
-        }
+        forward_ring_->push(msg);
     }
     
     return err;
@@ -1162,6 +1146,7 @@ void SrsOriginHub::on_unpublish()
     
     // destroy all forwarders
     destroy_forwarders();
+    forward_ring_->clear();
     
     encoder->on_unpublish();
     hls->on_unpublish();
@@ -1184,15 +1169,9 @@ srs_error_t SrsOriginHub::on_forwarder_start(SrsForwarder* forwarder)
     SrsSharedPtrMessage* cache_sh_audio = source->meta->ash();
     
     // feed the forwarder the metadata/sequence header,
-    // when reload to enable the forwarder.
-    if (cache_metadata && (err = forwarder->on_meta_data(cache_metadata)) != srs_success) {
-        return srs_error_wrap(err, "forward metadata");
-    }
-    if (cache_sh_video && (err = forwarder->on_video(cache_sh_video)) != srs_success) {
-        return srs_error_wrap(err, "forward video sh");
-    }
-    if (cache_sh_audio && (err = forwarder->on_audio(cache_sh_audio)) != srs_success) {
-        return srs_error_wrap(err, "forward audio sh");
+    // when connected or reload to enable the forwarder.
+    if ((err = forwarder->on_sequence_header(cache_metadata, cache_sh_video, cache_sh_audio)) != srs_success) {
+        return srs_error_wrap(err, "forward sequence header");
     }
     
     return err;
@@ -1473,6 +1452,9 @@ srs_error_t SrsOriginHub::create_forwarders()
         return err;
     }
 
+    // The messages in ring are bounded by the queue size, for the forwarders to catch up.
+    forward_ring_->set_queue_size(_srs_config->get_queue_length(req_->vhost));
+
     // For backend config
     // If backend is enabled and applied, ignore destination.
     bool applied_backend_server = false;
@@ -1490,7 +1472,7 @@ srs_error_t SrsOriginHub::create_forwarders()
     for (int i = 0; conf && i < (int)conf->args.size(); i++) {
         std::string forward_server = conf->args.at(i);
         
-        SrsForwarder* forwarder = new SrsForwarder(this);
+        SrsForwarder* forwarder = new SrsForwarder(this, forward_ring_);
         forwarders.push_back(forwarder);
         
         // initialize the forwarder with request.
@@ -1498,8 +1480,7 @@ srs_error_t SrsOriginHub::create_forwarders()
             return srs_error_wrap(err, "init forwarder");
         }
 
-        srs_utime_t queue_size = _srs_config->get_queue_length(req_->vhost);
-        forwarder->set_queue_size(queue_size);
+        forwarder->set_backpressure(_srs_config->get_forward_backpressure(req_->vhost, forward_server));
         
         if ((err = forwarder->on_publish()) != srs_success) {
             return srs_error_wrap(err, "start forwarder failed, vhost=%s, app=%s, stream=%s, forward-to=%s",
@@ -1546,7 +1527,7 @@ srs_error_t SrsOriginHub::create_backend_forwarders(bool& applied)
         srs_discovery_tc_url(req->tcUrl, req->schema, req->host, req->vhost, req->app, req->stream, req->port, req->param);
 
         // create forwarder
-        SrsForwarder* forwarder = new SrsForwarder(this);
+        SrsForwarder* forwarder = new SrsForwarder(this, forward_ring_);
         forwarders.push_back(forwarder);
 
         std::stringstream forward_server;
@@ -1557,8 +1538,7 @@ srs_error_t SrsOriginHub::create_backend_forwarders(bool& applied)
             return srs_error_wrap(err, "init backend forwarder failed, forward-to=%s", forward_server.str().c_str());
         }
 
-        srs_utime_t queue_size = _srs_config->get_queue_length(req_->vhost);
-        forwarder->set_queue_size(queue_size);
+        forwarder->set_backpressure(_srs_config->get_forward_backpressure(req_->vhost, forward_server.str()));
 
         if ((err = forwarder->on_publish()) != srs_success) {
             return srs_error_wrap(err, "start backend forwarder failed, vhost=%s, app=%s, stream=%s, forward-to=%s",
@@ -2258,30 +2238,52 @@ srs_error_t SrsLiveSource::on_audio(SrsCommonMessage* shared_audio)
 {
     srs_error_t err = srs_success;
     
+    // convert shared_audio to msg, user should not use shared_audio again.
+    // the payload is transfer to msg, and set to NULL in shared_audio.
+    SrsSharedPtrMessage msg;
+    if ((err = msg.create(shared_audio)) != srs_success) {
+        return srs_error_wrap(err, "create message");
+    }
+    
+    return on_frame(&msg);
+}
+
+srs_error_t SrsLiveSource::on_frame(SrsSharedPtrMessage* msg)
+{
+    srs_error_t err = srs_success;
+    
     // Detect where stream is monotonically increasing.
     if (!mix_correct && is_monotonically_increase) {
-        if (last_packet_time > 0 && shared_audio->header.timestamp < last_packet_time) {
+        if (last_packet_time > 0 && msg->timestamp < last_packet_time) {
             is_monotonically_increase = false;
-            srs_warn("AUDIO: Timestamp %" PRId64 "=>%" PRId64 ", may need mix_correct.",
-                last_packet_time, shared_audio->header.timestamp);
+            srs_warn("%s: Timestamp %" PRId64 "=>%" PRId64 ", may need mix_correct.",
+                msg->is_audio()? "AUDIO" : "VIDEO", last_packet_time, msg->timestamp);
         }
     }
-    last_packet_time = shared_audio->header.timestamp;
+    last_packet_time = msg->timestamp;
     
-    // convert shared_audio to msg, user should not use shared_audio again.
-    // the payload is transfer to msg, and set to NULL in shared_audio.
-    SrsSharedPtrMessage msg;
-    if ((err = msg.create(shared_audio)) != srs_success) {
-        return srs_error_wrap(err, "create message");
+    // drop any unknown header video.
+    // @see https://github.com/ossrs/srs/issues/421
+    if (msg->is_video() && !SrsFlvVideo::acceptable(msg->payload, msg->size)) {
+        char b0 = 0x00;
+        if (msg->size > 0) {
+            b0 = msg->payload[0];
+        }
+        
+        srs_warn("drop unknown header video, size=%d, bytes[0]=%#x", msg->size, b0);
+        return err;
     }
     
-    // directly process the audio message.
+    // directly process the message.
     if (!mix_correct) {
-        return on_audio_imp(&msg);
+        if (msg->is_audio()) {
+            return on_audio_imp(msg);
+        }
+        return on_video_imp(msg);
     }
     
     // insert msg to the queue.
-    mix_queue->push(msg.copy());
+    mix_queue->push(msg->copy());
     
     // fetch someone from mix queue.
     SrsSharedPtrMessage* m = mix_queue->pop();
@@ -2380,28 +2382,6 @@ srs_error_t SrsLiveSource::on_audio_imp(SrsSharedPtrMessage* msg)
 srs_error_t SrsLiveSource::on_video(SrsCommonMessage* shared_video)
 {
     srs_error_t err = srs_success;
-
-    // Detect where stream is monotonically increasing.
-    if (!mix_correct && is_monotonically_increase) {
-        if (last_packet_time > 0 && shared_video->header.timestamp < last_packet_time) {
-            is_monotonically_increase = false;
-            srs_warn("VIDEO: Timestamp %" PRId64 "=>%" PRId64 ", may need mix_correct.",
-                last_packet_time, shared_video->header.timestamp);
-        }
-    }
-    last_packet_time = shared_video->header.timestamp;
-    
-    // drop any unknown header video.
-    // @see https://github.com/ossrs/srs/issues/421
-    if (!SrsFlvVideo::acceptable(shared_video->payload, shared_video->size)) {
-        char b0 = 0x00;
-        if (shared_video->size > 0) {
-            b0 = shared_video->payload[0];
-        }
-        
-        srs_warn("drop unknown header video, size=%d, bytes[0]=%#x", shared_video->size, b0);
-        return err;
-    }
     
     // convert shared_video to msg, user should not use shared_video again.
     // the payload is transfer to msg, and set to NULL in shared_video.
@@ -2410,29 +2390,7 @@ srs_error_t SrsLiveSource::on_video(SrsCommonMessage* shared_video)
         return srs_error_wrap(err, "create message");
     }
     
-    // directly process the video message.
-    if (!mix_correct) {
-        return on_video_imp(&msg);
-    }
-    
-    // insert msg to the queue.
-    mix_queue->push(msg.copy());
-    
-    // fetch someone from mix queue.
-    SrsSharedPtrMessage* m = mix_queue->pop();
-    if (!m) {
-        return err;
-    }
-    
-    // consume the monotonically increase message.
-    if (m->is_audio()) {
-        err = on_audio_imp(m);
-    } else {
-        err = on_video_imp(m);
-    }
-    srs_freep(m);
-    
-    return err;
+    return on_frame(&msg);
 }
 
 srs_error_t SrsLiveSource::on_video_imp(SrsSharedPtrMessage* msg)
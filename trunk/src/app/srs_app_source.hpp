@@ -29,6 +29,7 @@ class SrsCommonMessage;
 class SrsOnMetaDataPacket;
 class SrsSharedPtrMessage;
 class SrsForwarder;
+class SrsForwardRing;
 class SrsRequest;
 class SrsStSocket;
 class SrsRtmpServer;
@@ -334,6 +335,8 @@ private:
     SrsNgExec* ng_exec;
     // To forward stream to other servers
     std::vector<SrsForwarder*> forwarders;
+    // The messages shared by all forwarders.
+    SrsForwardRing* forward_ring_;
 public:
     SrsOriginHub();
     virtual ~SrsOriginHub();
@@ -572,6 +575,9 @@ public:
 public:
     // TODO: FIXME: Use SrsSharedPtrMessage instead.
     virtual srs_error_t on_audio(SrsCommonMessage* audio);
+    // Consume the audio or video frame, for the in-process publisher which already has the shared message.
+    // @remark The msg is not freed, the caller should free it.
+    virtual srs_error_t on_frame(SrsSharedPtrMessage* msg);
 private:
     virtual srs_error_t on_audio_imp(SrsSharedPtrMessage* audio);
 public:
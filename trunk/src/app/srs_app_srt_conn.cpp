@@ -23,6 +23,7 @@ using namespace std;
 #include <srs_app_statistic.hpp>
 #include <srs_protocol_rtmp_stack.hpp>
 #include <srs_kernel_utility.hpp>
+#include <srs_core_performance.hpp>
 
 SrsSrtConnection::SrsSrtConnection(srs_srt_t srt_fd)
 {
@@ -91,9 +92,10 @@ srs_error_t SrsSrtConnection::writev(const iovec *iov, int iov_size, ssize_t* nw
     return srs_error_new(ERROR_SRT_CONN, "unsupport method");
 }
 
-SrsSrtRecvThread::SrsSrtRecvThread(SrsSrtConnection* srt_conn)
+SrsSrtRecvThread::SrsSrtRecvThread(SrsSrtConnection* srt_conn, SrsSrtConsumer* consumer)
 {
     srt_conn_ = srt_conn;
+    consumer_ = consumer;
     trd_ = new SrsSTCoroutine("srt-recv", this, _srs_context->get_id());
     recv_err_ = srs_success;
 }
@@ -112,6 +114,11 @@ srs_error_t SrsSrtRecvThread::cycle()
         recv_err_ = srs_error_copy(err);
     }
 
+    // Wakeup the player, which waits for packets without timeout.
+    if (consumer_) {
+        consumer_->wakeup();
+    }
+
     return err;
 }
 
@@ -357,6 +364,24 @@ srs_error_t SrsMpegtsSrtConn::acquire_publish()
         return srs_error_new(ERROR_SRT_SOURCE_BUSY, "srt stream %s busy", req_->get_stream_url().c_str());
     }
 
+    // Free the bridges when failed, because the stream is not published.
+    if ((err = create_bridges()) != srs_success) {
+        srt_source_->on_unpublish();
+        return srs_error_wrap(err, "create bridges");
+    }
+
+    if ((err = srt_source_->on_publish()) != srs_success) {
+        srt_source_->on_unpublish();
+        return srs_error_wrap(err, "srt source publish");
+    }
+
+    return err;
+}
+
+srs_error_t SrsMpegtsSrtConn::create_bridges()
+{
+    srs_error_t err = srs_success;
+
     if (_srs_config->get_srt_to_rtmp(req_->vhost)) {
         // Check rtmp stream is busy.
         SrsLiveSource *live_source = _srs_sources->fetch(req_);
@@ -375,51 +400,37 @@ srs_error_t SrsMpegtsSrtConn::acquire_publish()
         live_source->set_cache(enabled_cache);
         live_source->set_gop_cache_max_frames(gcmf);
 
-        // srt->rtmp->rtc
-        // TODO: FIXME: the code below is repeat in srs_app_rtmp_conn.cpp, refactor it later, use function instead.
-
-        // Check whether RTC stream is busy.
-#ifdef SRS_RTC
-        SrsRtcSource *rtc = NULL;
-        bool rtc_server_enabled = _srs_config->get_rtc_server_enabled();
-        bool rtc_enabled = _srs_config->get_rtc_enabled(req_->vhost);
-        bool edge = _srs_config->get_vhost_is_edge(req_->vhost);
-        if (rtc_server_enabled && rtc_enabled && ! edge) {
-            if ((err = _srs_rtc_sources->fetch_or_create(req_, &rtc)) != srs_success) {
-                return srs_error_wrap(err, "create source");
-            }
-
-            if (!rtc->can_publish()) {
-                return srs_error_new(ERROR_SYSTEM_STREAM_BUSY, "rtc stream %s busy", req_->get_stream_url().c_str());
-            }
-        }
-#endif
-
-        // Bridge to RTC streaming.
-#if defined(SRS_RTC) && defined(SRS_FFMPEG_FIT)
-        if (rtc) {
-            SrsRtcFromRtmpBridge *bridge = new SrsRtcFromRtmpBridge(rtc);
-            if ((err = bridge->initialize(req_)) != srs_success) {
-                srs_freep(bridge);
-                return srs_error_wrap(err, "bridge init");
-            }
-
-            live_source->set_bridge(bridge);
-        }
-#endif
-
         SrsRtmpFromSrtBridge *bridger = new SrsRtmpFromSrtBridge(live_source);
         if ((err = bridger->initialize(req_)) != srs_success) {
             srs_freep(bridger);
             return srs_error_wrap(err, "create bridger");
         }
 
-        srt_source_->set_bridge(bridger);
+        srt_source_->add_bridge(bridger);
     }
 
-    if ((err = srt_source_->on_publish()) != srs_success) {
-        return srs_error_wrap(err, "srt source publish");
+    // Check whether RTC stream is busy. The gating is the same as the srt->rtmp->rtc before, which depends on
+    // srt_to_rtmp, but not rtmp_to_rtc. The busy check is shared with the RTMP publishers, while the bridge is
+    // not, because SRT packages RTP from the TS frames directly.
+#ifdef SRS_RTC
+    SrsRtcSource *rtc = NULL;
+    bool srt_to_rtmp = _srs_config->get_srt_to_rtmp(req_->vhost);
+    bool edge = _srs_config->get_vhost_is_edge(req_->vhost);
+    if (srt_to_rtmp && (err = srs_rtc_fetch_bridge_source(req_, edge, &rtc)) != srs_success) {
+        return srs_error_wrap(err, "rtc source");
+    }
+
+    // Bridge to RTC streaming, directly from the TS frames, without converting to RTMP.
+    if (rtc) {
+        SrsRtcFromSrtBridge *bridge = new SrsRtcFromSrtBridge(rtc);
+        if ((err = bridge->initialize(req_)) != srs_success) {
+            srs_freep(bridge);
+            return srs_error_wrap(err, "bridge init");
+        }
+
+        srt_source_->add_bridge(bridge);
     }
+#endif
 
     return err;
 }
@@ -496,12 +507,25 @@ srs_error_t SrsMpegtsSrtConn::do_playing()
     SrsPithyPrint* pprint = SrsPithyPrint::create_srt_play();
     SrsAutoFree(SrsPithyPrint, pprint);
 
-    SrsSrtRecvThread srt_recv_trd(srt_conn_);
+    SrsSrtRecvThread srt_recv_trd(srt_conn_, consumer);
     if ((err = srt_recv_trd.start()) != srs_success) {
         return srs_error_wrap(err, "start srt recv trd");
     }
 
+    // The small packets are coalesced to a message of payload size, because each message costs a sendmsg.
+    int payload_size = 0;
+    if ((err = srs_srt_get_payload_size(srt_fd_, payload_size)) != srs_success || payload_size <= 0) {
+        srs_freep(err);
+        payload_size = _srs_config->get_srto_payloadsize();
+    }
+
+    char* buf = new char[payload_size];
+    SrsAutoFreeA(char, buf);
+
+    SrsSrtPacket* pkts[SRS_PERF_SRT_SEND_BATCH];
     int nb_packets = 0;
+    int64_t nn_packets = 0, nn_msgs = 0, nn_batches = 0, nn_retrans = 0, nn_drop = 0;
+    SrsStatistic* stat = SrsStatistic::instance();
 
     while (true) {
         if ((err = trd_->pull()) != srs_success) {
@@ -512,17 +536,27 @@ srs_error_t SrsMpegtsSrtConn::do_playing()
             return srs_error_wrap(err, "srt play recv thread");
         }
 
-        // Wait for amount of packets.
-        SrsSrtPacket* pkt = NULL;
-        SrsAutoFree(SrsSrtPacket, pkt);
-        consumer->dump_packet(&pkt);
-        if (!pkt) {
-            // TODO: FIXME: We should check the quit event.
-            consumer->wait(1, 1000 * SRS_UTIME_MILLISECONDS);
+        // Wait for packets, until woken up by source, recv thread or interrupted.
+        int count = 0;
+        consumer->dump_packets(pkts, SRS_PERF_SRT_SEND_BATCH, count);
+        if (!count) {
+            consumer->wait(0);
             continue;
         }
 
-        ++nb_packets;
+        int nn = 0;
+        err = send_packets(pkts, count, buf, payload_size, &nn);
+        for (int i = 0; i < count; i++) {
+            SrsSrtPacket::release(pkts[i]);
+        }
+        if (err != srs_success) {
+            return srs_error_wrap(err, "srt send");
+        }
+
+        nb_packets += count;
+        nn_packets += count;
+        nn_msgs += nn;
+        nn_batches++;
 
         // reportable
         pprint->elapse();
@@ -531,25 +565,62 @@ srs_error_t SrsMpegtsSrtConn::do_playing()
             if ((err = s.fetch(srt_fd_, true)) != srs_success) {
                 srs_freep(err);
             } else {
+                nn_retrans += s.pktRetrans();
+                nn_drop += s.pktSndDrop();
                 srs_trace("-> " SRS_CONSTS_LOG_SRT_PLAY " Transport Stats # pktSent=%" PRId64 ", pktSndLoss=%d, pktRetrans=%d, pktSndDrop=%d",
                     s.pktSent(), s.pktSndLoss(), s.pktRetrans(), s.pktSndDrop());
             }
 
             kbps_->sample();
-            srs_trace("-> " SRS_CONSTS_LOG_SRT_PLAY " time=%" PRId64 ", packets=%d, okbps=%d,%d,%d, ikbps=%d,%d,%d",
-                srsu2ms(pprint->age()), nb_packets, kbps_->get_send_kbps(), kbps_->get_send_kbps_30s(), kbps_->get_send_kbps_5m(),
+            srs_trace("-> " SRS_CONSTS_LOG_SRT_PLAY " time=%" PRId64 ", packets=%d, msgs=%" PRId64 ", batches=%" PRId64 ", okbps=%d,%d,%d, ikbps=%d,%d,%d",
+                srsu2ms(pprint->age()), nb_packets, nn_msgs, nn_batches, kbps_->get_send_kbps(), kbps_->get_send_kbps_30s(), kbps_->get_send_kbps_5m(),
                 kbps_->get_recv_kbps(), kbps_->get_recv_kbps_30s(), kbps_->get_recv_kbps_5m());
             nb_packets = 0;
+
+            stat->on_client_srt_send(get_id().c_str(), nn_packets, nn_msgs, nn_batches, nn_retrans, nn_drop);
+        }
+    }
+
+    return err;
+}
+
+srs_error_t SrsMpegtsSrtConn::send_packets(SrsSrtPacket** pkts, int count, char* buf, int size, int* pnn_msgs)
+{
+    srs_error_t err = srs_success;
+
+    ssize_t nb_write = 0;
+    int nb_buf = 0;
+
+    for (int i = 0; i < count; i++) {
+        SrsSrtPacket* pkt = pkts[i];
+
+        // Flush the coalesced packets, if no space for this one.
+        if (nb_buf && nb_buf + pkt->size() > size) {
+            if ((err = srt_conn_->write(buf, nb_buf, &nb_write)) != srs_success) {
+                return srs_error_wrap(err, "srt send, size=%d", nb_buf);
+            }
+            ++*pnn_msgs;
+            nb_buf = 0;
+        }
+
+        // Coalesce the small packet, or send the large one directly without copy.
+        if (pkt->size() < size) {
+            memcpy(buf + nb_buf, pkt->data(), pkt->size());
+            nb_buf += pkt->size();
+            continue;
         }
 
-        ssize_t nb_write = 0;
         if ((err = srt_conn_->write(pkt->data(), pkt->size(), &nb_write)) != srs_success) {
             return srs_error_wrap(err, "srt send, size=%d", pkt->size());
         }
+        ++*pnn_msgs;
+    }
 
-        // Yield to another coroutines.
-        // @see https://github.com/ossrs/srs/issues/2194#issuecomment-777542162
-        // TODO: FIXME: Please check whether SRT sendmsg causing clock deviation, see srs_thread_yield of SrsUdpMuxSocket::sendto
+    if (nb_buf) {
+        if ((err = srt_conn_->write(buf, nb_buf, &nb_write)) != srs_success) {
+            return srs_error_wrap(err, "srt send, size=%d", nb_buf);
+        }
+        ++*pnn_msgs;
     }
 
     return err;
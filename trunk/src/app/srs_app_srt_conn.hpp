@@ -20,6 +20,8 @@
 class SrsBuffer;
 class SrsLiveSource;
 class SrsSrtSource;
+class SrsSrtConsumer;
+class SrsSrtPacket;
 class SrsSrtServer;
 class SrsNetworkDelta;
 
@@ -55,7 +57,8 @@ private:
 class SrsSrtRecvThread : public ISrsCoroutineHandler
 {
 public:
-    SrsSrtRecvThread(SrsSrtConnection* srt_conn);
+    // The consumer is woken up when recv thread quit, for example, the player is disconnected.
+    SrsSrtRecvThread(SrsSrtConnection* srt_conn, SrsSrtConsumer* consumer);
     ~SrsSrtRecvThread();
 // Interface ISrsCoroutineHandler
 public:
@@ -67,6 +70,7 @@ public:
     srs_error_t get_recv_err();
 private:
     SrsSrtConnection* srt_conn_;
+    SrsSrtConsumer* consumer_;
     SrsCoroutine* trd_;
     srs_error_t recv_err_;
 };
@@ -99,9 +103,12 @@ private:
     srs_error_t publishing();
     srs_error_t playing();
     srs_error_t acquire_publish();
+    // Create the bridges from SRT to other sources, such as RTMP, RTC and HLS.
+    srs_error_t create_bridges();
     void release_publish();
     srs_error_t do_publishing();
     srs_error_t do_playing();
+    srs_error_t send_packets(SrsSrtPacket** pkts, int count, char* buf, int size, int* pnn_msgs);
 private:
     srs_error_t on_srt_packet(char* buf, int nb_buf);
 private:
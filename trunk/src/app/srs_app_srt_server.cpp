@@ -419,19 +419,18 @@ srs_error_t SrsSrtEventLoop::cycle()
             return srs_error_wrap(err, "srt listener");
         }
        
-        // Check and notify fired SRT events by epoll.
+        // Yield until some SRT sockets are fired, then resume the coroutines which wait on them.
         //
-        // Note that the SRT poller use a dedicated and isolated epoll, which is not the same as the one of SRS, in
-        // short, the wait won't switch to other coroutines when no fd is active, so we must use timeout(0) to make sure
-        // to return directly, then use srs_usleep to do the coroutine switch.
+        // Note that the SRT poller use a dedicated and isolated epoll, which is not the same as the one of SRS, so it's
+        // waited by a worker thread of poller, which wakes this coroutine by a pipe, to avoid polling by sleep.
         int n_fds = 0;
-        if ((err = srt_poller_->wait(0, &n_fds)) != srs_success) {
+        if ((err = srt_poller_->wait_fired(SRS_UTIME_NO_TIMEOUT, &n_fds)) != srs_success) {
             srs_warn("srt poll wait failed, n_fds=%d, err=%s", n_fds, srs_error_desc(err).c_str());
             srs_error_reset(err);
-        }
 
-        // We use sleep to switch to other coroutines, because the SRT poller is not possible to do this.
-        srs_usleep((n_fds ? 1 : 10) * SRS_UTIME_MILLISECONDS);
+            // Avoid busy loop when poller fails.
+            srs_usleep(10 * SRS_UTIME_MILLISECONDS);
+        }
     }
     
     return err;
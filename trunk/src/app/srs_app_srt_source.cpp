@@ -19,11 +19,15 @@ using namespace std;
 #include <srs_app_source.hpp>
 #include <srs_app_statistic.hpp>
 #include <srs_app_pithy_print.hpp>
+#include <srs_app_hls.hpp>
+#include <srs_app_config.hpp>
+#include <srs_app_hybrid.hpp>
 
 SrsSrtPacket::SrsSrtPacket()
 {
     shared_buffer_ = NULL;
     actual_buffer_size_ = 0;
+    shared_count_ = 0;
 }
 
 SrsSrtPacket::~SrsSrtPacket()
@@ -82,6 +86,26 @@ SrsSrtPacket* SrsSrtPacket::copy()
     return cp;
 }
 
+SrsSrtPacket* SrsSrtPacket::share()
+{
+    shared_count_++;
+    return this;
+}
+
+void SrsSrtPacket::release(SrsSrtPacket* pkt)
+{
+    if (!pkt) {
+        return;
+    }
+
+    if (pkt->shared_count_ > 0) {
+        pkt->shared_count_--;
+        return;
+    }
+
+    srs_freep(pkt);
+}
+
 char* SrsSrtPacket::data() 
 { 
     return shared_buffer_->payload; 
@@ -173,7 +197,7 @@ SrsSrtConsumer::~SrsSrtConsumer()
     vector<SrsSrtPacket*>::iterator it;
     for (it = queue.begin(); it != queue.end(); ++it) {
         SrsSrtPacket* pkt = *it;
-        srs_freep(pkt);
+        SrsSrtPacket::release(pkt);
     }
 
     srs_cond_destroy(mw_wait);
@@ -201,7 +225,7 @@ srs_error_t SrsSrtConsumer::enqueue(SrsSrtPacket* packet)
     return err;
 }
 
-srs_error_t SrsSrtConsumer::dump_packet(SrsSrtPacket** ppkt)
+srs_error_t SrsSrtConsumer::dump_packets(SrsSrtPacket** pkts, int max, int& count)
 {
     srs_error_t err = srs_success;
 
@@ -210,16 +234,19 @@ srs_error_t SrsSrtConsumer::dump_packet(SrsSrtPacket** ppkt)
         should_update_source_id = false;
     }
 
-    // TODO: FIXME: Refine performance by ring buffer.
-    if (!queue.empty()) {
-        *ppkt = queue.front();
-        queue.erase(queue.begin());
+    // Dump all packets in a batch, so we only erase the queue once.
+    count = srs_min(max, (int)queue.size());
+    if (count <= 0) {
+        return err;
     }
 
+    std::copy(queue.begin(), queue.begin() + count, pkts);
+    queue.erase(queue.begin(), queue.begin() + count);
+
     return err;
 }
 
-void SrsSrtConsumer::wait(int nb_msgs, srs_utime_t timeout)
+void SrsSrtConsumer::wait(int nb_msgs)
 {
     mw_min_msgs = nb_msgs;
 
@@ -232,7 +259,15 @@ void SrsSrtConsumer::wait(int nb_msgs, srs_utime_t timeout)
     mw_waiting = true;
 
     // use cond block wait for high performance mode.
-    srs_cond_timedwait(mw_wait, timeout);
+    srs_cond_wait(mw_wait);
+}
+
+void SrsSrtConsumer::wakeup()
+{
+    if (mw_waiting) {
+        srs_cond_signal(mw_wait);
+        mw_waiting = false;
+    }
 }
 
 ISrsSrtSourceBridge::ISrsSrtSourceBridge()
@@ -851,11 +886,318 @@ srs_error_t SrsRtmpFromSrtBridge::on_aac_frame(SrsTsMessage* msg, uint32_t pts,
     return err;
 }
 
+SrsHlsFromSrtBridge::SrsHlsFromSrtBridge() : ISrsSrtSourceBridge()
+{
+    req_ = NULL;
+    controller_ = new SrsHlsController();
+    enabled_ = false;
+    disposable_ = false;
+    last_update_time_ = 0;
+
+    pmt_pid_ = -1;
+    video_pid_ = -1;
+    audio_pid_ = -1;
+    video_codec_ = SrsTsStreamReserved;
+}
+
+SrsHlsFromSrtBridge::~SrsHlsFromSrtBridge()
+{
+    _srs_hybrid->timer1s()->unsubscribe(this);
+
+    srs_freep(controller_);
+    srs_freep(req_);
+}
+
+srs_error_t SrsHlsFromSrtBridge::initialize(SrsRequest* req)
+{
+    srs_error_t err = srs_success;
+
+    req_ = req->copy();
+
+    if ((err = controller_->initialize()) != srs_success) {
+        return srs_error_wrap(err, "hls controller");
+    }
+
+    // For SrsHlsFromSrtBridge::on_timer()
+    _srs_hybrid->timer1s()->subscribe(this);
+
+    return err;
+}
+
+srs_error_t SrsHlsFromSrtBridge::on_publish()
+{
+    srs_error_t err = srs_success;
+
+    // Ignore if srt_to_hls disabled, then the HLS is written by live source if srt_to_rtmp.
+    if (!_srs_config->get_srt_to_hls(req_->vhost) || !_srs_config->get_hls_enabled(req_->vhost)) {
+        return err;
+    }
+
+    // The PSI might change when republish.
+    pmt_pid_ = video_pid_ = audio_pid_ = -1;
+    video_codec_ = SrsTsStreamReserved;
+    pat_ = pmt_ = psi_ = "";
+
+    last_update_time_ = srs_get_system_time();
+
+    // Like the ignore strategy of hls_on_error, the error of HLS never break the stream.
+    if ((err = controller_->on_publish(req_)) != srs_success) {
+        srs_warn("hls: ignore publish error %s", srs_error_desc(err).c_str());
+        srs_error_reset(err);
+        return err;
+    }
+
+    enabled_ = true;
+    disposable_ = true;
+
+    return err;
+}
+
+srs_error_t SrsHlsFromSrtBridge::on_packet(SrsSrtPacket* pkt)
+{
+    srs_error_t err = srs_success;
+
+    if (!enabled_) {
+        return err;
+    }
+
+    last_update_time_ = srs_get_system_time();
+
+    char* buf = pkt->data();
+    int nb_packet = pkt->size() / SRS_TS_PACKET_SIZE;
+    for (int i = 0; i < nb_packet; i++) {
+        if ((err = on_ts_packet(buf + (i * SRS_TS_PACKET_SIZE))) != srs_success) {
+            // Like the ignore strategy of hls_on_error, stop HLS but never break the stream.
+            srs_warn("hls: ignore ts error %s", srs_error_desc(err).c_str());
+            srs_error_reset(err);
+            on_unpublish();
+            return err;
+        }
+    }
+
+    return err;
+}
+
+void SrsHlsFromSrtBridge::on_unpublish()
+{
+    srs_error_t err = srs_success;
+
+    // Ignore if not enabled or already unpublished.
+    if (!enabled_) {
+        return;
+    }
+    enabled_ = false;
+
+    last_update_time_ = srs_get_system_time();
+
+    if ((err = controller_->on_unpublish()) != srs_success) {
+        srs_warn("hls unpublish err %s", srs_error_desc(err).c_str());
+        srs_freep(err);
+    }
+}
+
+srs_error_t SrsHlsFromSrtBridge::on_timer(srs_utime_t interval)
+{
+    srs_error_t err = srs_success;
+
+    // Ignore when publishing, or already disposed.
+    if (enabled_ || !disposable_) {
+        return err;
+    }
+
+    srs_utime_t hls_dispose = _srs_config->get_hls_dispose(req_->vhost);
+    if (hls_dispose <= 0) {
+        return err;
+    }
+    if (srs_get_system_time() - last_update_time_ <= hls_dispose) {
+        return err;
+    }
+    disposable_ = false;
+
+    srs_trace("hls cycle to dispose srt hls %s, timeout=%dms", req_->get_stream_url().c_str(), srsu2msi(hls_dispose));
+    controller_->dispose();
+
+    return err;
+}
+
+srs_error_t SrsHlsFromSrtBridge::on_ts_packet(char* data)
+{
+    srs_error_t err = srs_success;
+
+    int64_t dts = -1;
+    bool keyframe = false;
+    scan_ts_packet(data, dts, keyframe);
+
+    if ((err = controller_->write_ts(psi_, data, SRS_TS_PACKET_SIZE, dts, keyframe, video_pid_ < 0)) != srs_success) {
+        return srs_error_wrap(err, "write ts");
+    }
+
+    return err;
+}
+
+void SrsHlsFromSrtBridge::scan_ts_packet(char* data, int64_t& dts, bool& keyframe)
+{
+    // Ignore the corrupt packet, SRT handles the packet loss.
+    uint8_t* p = (uint8_t*)data;
+    if (p[0] != 0x47) {
+        return;
+    }
+
+    int pid = ((p[1] & 0x1f) << 8) | p[2];
+    bool pusi = (p[1] & 0x40) != 0;
+    int afc = (p[3] >> 4) & 0x03;
+
+    // Skip the adaptation field, but check the random access indicator for keyframe.
+    int pos = 4;
+    bool random_access = false;
+    if ((afc & 0x02) != 0) {
+        int nb_af = p[4];
+        if (nb_af > 0) {
+            random_access = (p[5] & 0x40) != 0;
+        }
+        pos += 1 + nb_af;
+    }
+
+    if (!pusi || (afc & 0x01) == 0 || pos >= SRS_TS_PACKET_SIZE) {
+        return;
+    }
+    char* payload = data + pos;
+    int nb_payload = SRS_TS_PACKET_SIZE - pos;
+
+    if (pid == SrsTsPidPAT) {
+        parse_pat(payload, nb_payload);
+        pat_.assign(data, SRS_TS_PACKET_SIZE);
+        psi_ = pat_ + pmt_;
+    } else if (pid == pmt_pid_) {
+        parse_pmt(payload, nb_payload);
+        pmt_.assign(data, SRS_TS_PACKET_SIZE);
+        psi_ = pat_ + pmt_;
+    } else if (pid == video_pid_) {
+        parse_pes(payload, nb_payload, true, dts, keyframe);
+        keyframe = keyframe || random_access;
+    } else if (video_pid_ < 0 && pid == audio_pid_) {
+        // Only the frame of video, or audio for pure audio stream, is able to reap the segment.
+        parse_pes(payload, nb_payload, false, dts, keyframe);
+    }
+}
+
+void SrsHlsFromSrtBridge::parse_pat(char* data, int size)
+{
+    SrsBuffer b(data, size);
+
+    // Skip the pointer field.
+    if (!b.require(1)) return;
+    int pointer_field = b.read_1bytes();
+    if (!b.require(pointer_field + 8)) return;
+    b.skip(pointer_field);
+
+    // table_id, section_length, transport_stream_id, version and section number.
+    if (b.read_1bytes() != SrsTsPsiIdPas) return;
+    int section_length = b.read_2bytes() & 0x0fff;
+    b.skip(5);
+
+    // The programs, exclude the 4B CRC32, and we use the first program.
+    int nb_programs = (section_length - 5 - 4) / 4;
+    for (int i = 0; i < nb_programs && b.require(4); i++) {
+        int16_t number = b.read_2bytes();
+        int16_t pid = b.read_2bytes() & 0x1fff;
+        if (number != 0) {
+            pmt_pid_ = pid;
+            break;
+        }
+    }
+}
+
+void SrsHlsFromSrtBridge::parse_pmt(char* data, int size)
+{
+    SrsBuffer b(data, size);
+
+    // Skip the pointer field.
+    if (!b.require(1)) return;
+    int pointer_field = b.read_1bytes();
+    if (!b.require(pointer_field + 12)) return;
+    b.skip(pointer_field);
+
+    // table_id, section_length, program_number, version, section number and PCR_PID.
+    if (b.read_1bytes() != SrsTsPsiIdPms) return;
+    int section_length = b.read_2bytes() & 0x0fff;
+    b.skip(7);
+    int program_info_length = b.read_2bytes() & 0x0fff;
+    if (!b.require(program_info_length)) return;
+    b.skip(program_info_length);
+
+    video_pid_ = audio_pid_ = -1;
+
+    // The elementary streams, exclude the 4B CRC32.
+    int nb_es = section_length - 9 - program_info_length - 4;
+    while (nb_es >= 5 && b.require(5)) {
+        SrsTsStream stream_type = (SrsTsStream)(uint8_t)b.read_1bytes();
+        int16_t pid = b.read_2bytes() & 0x1fff;
+        int es_info_length = b.read_2bytes() & 0x0fff;
+        if (!b.require(es_info_length)) break;
+        b.skip(es_info_length);
+        nb_es -= 5 + es_info_length;
+
+        if (video_pid_ < 0 && (stream_type == SrsTsStreamVideoH264 || stream_type == SrsTsStreamVideoHEVC)) {
+            video_pid_ = pid;
+            video_codec_ = stream_type;
+        } else if (audio_pid_ < 0 && (stream_type == SrsTsStreamAudioAAC || stream_type == SrsTsStreamAudioMp3)) {
+            audio_pid_ = pid;
+        }
+    }
+}
+
+void SrsHlsFromSrtBridge::parse_pes(char* data, int size, bool is_video, int64_t& dts, bool& keyframe)
+{
+    SrsBuffer b(data, size);
+
+    // packet_start_code_prefix, stream_id, PES_packet_length, flags and PES_header_data_length.
+    if (!b.require(9) || b.read_3bytes() != 0x01) return;
+    b.skip(3);
+    b.skip(1);
+    int pts_dts_flags = (b.read_1bytes() >> 6) & 0x03;
+    int header_length = b.read_1bytes();
+    if (!b.require(header_length)) return;
+
+    // The 33bits timestamp in 5 bytes, the DTS follows PTS if exists.
+    int offset = (pts_dts_flags == 0x03) ? 5 : 0;
+    if ((pts_dts_flags & 0x02) != 0 && header_length >= offset + 5) {
+        uint8_t* t = (uint8_t*)b.head() + offset;
+        dts = ((int64_t)(t[0] & 0x0e) << 29) | ((int64_t)t[1] << 22) | ((int64_t)(t[2] & 0xfe) << 14)
+            | ((int64_t)t[3] << 7) | ((int64_t)t[4] >> 1);
+    }
+    b.skip(header_length);
+
+    // Search the NALUs in the first TS packet of frame, for IDR or SPS.
+    if (!is_video) return;
+    uint8_t* p = (uint8_t*)b.head();
+    int left = b.left();
+    for (int i = 0; i + 3 < left; i++) {
+        if (p[i] != 0x00 || p[i + 1] != 0x00 || p[i + 2] != 0x01) {
+            continue;
+        }
+
+        uint8_t nalu = p[i + 3];
+        if (video_codec_ == SrsTsStreamVideoH264) {
+            SrsAvcNaluType nal_type = (SrsAvcNaluType)(nalu & 0x1f);
+            keyframe = nal_type == SrsAvcNaluTypeIDR || nal_type == SrsAvcNaluTypeSPS;
+        } else {
+            int nal_type = (nalu >> 1) & 0x3f;
+            // The IRAP(16~23), VPS(32) and SPS(33) of HEVC.
+            keyframe = (nal_type >= 16 && nal_type <= 23) || nal_type == 32 || nal_type == 33;
+        }
+
+        if (keyframe) {
+            break;
+        }
+    }
+}
+
 SrsSrtSource::SrsSrtSource()
 {
     req = NULL;
     can_publish_ = true;
-    bridge_ = NULL;
+    hls_ = new SrsHlsFromSrtBridge();
 }
 
 SrsSrtSource::~SrsSrtSource()
@@ -864,7 +1206,8 @@ SrsSrtSource::~SrsSrtSource()
     // for all consumers are auto free.
     consumers.clear();
 
-    srs_freep(bridge_);
+    free_bridges();
+    srs_freep(hls_);
     srs_freep(req);
 }
 
@@ -874,6 +1217,10 @@ srs_error_t SrsSrtSource::initialize(SrsRequest* r)
 
     req = r->copy();
 
+    if ((err = hls_->initialize(req)) != srs_success) {
+        return srs_error_wrap(err, "hls bridge init");
+    }
+
 	return err;
 }
 
@@ -915,10 +1262,18 @@ void SrsSrtSource::update_auth(SrsRequest* r)
     req->update_auth(r);
 }
 
-void SrsSrtSource::set_bridge(ISrsSrtSourceBridge* bridge)
+void SrsSrtSource::add_bridge(ISrsSrtSourceBridge* bridge)
 {
-    srs_freep(bridge_);
-    bridge_ = bridge;
+    bridges_.push_back(bridge);
+}
+
+void SrsSrtSource::free_bridges()
+{
+    for (int i = 0; i < (int)bridges_.size(); i++) {
+        ISrsSrtSourceBridge* bridge = bridges_.at(i);
+        srs_freep(bridge);
+    }
+    bridges_.clear();
 }
 
 srs_error_t SrsSrtSource::create_consumer(SrsSrtConsumer*& consumer)
@@ -965,8 +1320,15 @@ srs_error_t SrsSrtSource::on_publish()
         return srs_error_wrap(err, "source id change");
     }
 
-    if (bridge_ && (err = bridge_->on_publish()) != srs_success) {
-        return srs_error_wrap(err, "bridge on publish");
+    for (int i = 0; i < (int)bridges_.size(); i++) {
+        ISrsSrtSourceBridge* bridge = bridges_.at(i);
+        if ((err = bridge->on_publish()) != srs_success) {
+            return srs_error_wrap(err, "bridge on publish");
+        }
+    }
+
+    if ((err = hls_->on_publish()) != srs_success) {
+        return srs_error_wrap(err, "hls on publish");
     }
 
     SrsStatistic* stat = SrsStatistic::instance();
@@ -977,32 +1339,49 @@ srs_error_t SrsSrtSource::on_publish()
 
 void SrsSrtSource::on_unpublish()
 {
-    // ignore when already unpublished.
+    // ignore when already unpublished, but free the bridges of failed publish.
     if (can_publish_) {
+        free_bridges();
         return;
     }
 
     can_publish_ = true;
 
-    if (bridge_) {
-        bridge_->on_unpublish();
+    for (int i = 0; i < (int)bridges_.size(); i++) {
+        ISrsSrtSourceBridge* bridge = bridges_.at(i);
+        bridge->on_unpublish();
     }
-    srs_freep(bridge_);
+    free_bridges();
+
+    hls_->on_unpublish();
 }
 
 srs_error_t SrsSrtSource::on_packet(SrsSrtPacket* packet)
 {
     srs_error_t err = srs_success;
 
-    for (int i = 0; i < (int)consumers.size(); i++) {
-        SrsSrtConsumer* consumer = consumers.at(i);
-        if ((err = consumer->enqueue(packet->copy())) != srs_success) {
-            return srs_error_wrap(err, "consume ts packet");
+    // All consumers share the same copy of packet, which is freed by the last one.
+    if (!consumers.empty()) {
+        SrsSrtPacket* shared = packet->copy();
+        SrsAutoFreeH(SrsSrtPacket, shared, SrsSrtPacket::release);
+
+        for (int i = 0; i < (int)consumers.size(); i++) {
+            SrsSrtConsumer* consumer = consumers.at(i);
+            if ((err = consumer->enqueue(shared->share())) != srs_success) {
+                return srs_error_wrap(err, "consume ts packet");
+            }
+        }
+    }
+
+    for (int i = 0; i < (int)bridges_.size(); i++) {
+        ISrsSrtSourceBridge* bridge = bridges_.at(i);
+        if ((err = bridge->on_packet(packet)) != srs_success) {
+            return srs_error_wrap(err, "bridge consume message");
         }
     }
 
-    if (bridge_ && (err = bridge_->on_packet(packet)) != srs_success) {
-        return srs_error_wrap(err, "bridge consume message");
+    if ((err = hls_->on_packet(packet)) != srs_success) {
+        return srs_error_wrap(err, "hls consume message");
     }
 
     return err;
@@ -15,12 +15,14 @@
 #include <srs_kernel_ts.hpp>
 #include <srs_protocol_st.hpp>
 #include <srs_app_source.hpp>
+#include <srs_app_hourglass.hpp>
 
 class SrsSharedPtrMessage;
 class SrsRequest;
 class SrsLiveSource;
 class SrsSrtSource;
 class SrsAlonePithyPrint;
+class SrsHlsController;
 
 // The SRT packet with shared message.
 class SrsSrtPacket
@@ -36,6 +38,10 @@ public:
     char* wrap(SrsSharedPtrMessage* msg);
     // Copy the SRT packet.
     virtual SrsSrtPacket* copy();
+    // Share the SRT packet without copy, for example, by all consumers of source, then each owner should call release
+    // instead of free it, and the packet is freed by the last owner.
+    SrsSrtPacket* share();
+    static void release(SrsSrtPacket* pkt);
 public:
     char* data();
     int size();
@@ -43,6 +49,8 @@ private:
     SrsSharedPtrMessage* shared_buffer_;
     // The size of SRT packet or SRT payload.
     int actual_buffer_size_;
+    // The number of other owners which share this packet.
+    int shared_count_;
 };
 
 class SrsSrtSourceManager
@@ -83,12 +91,14 @@ private:
 public:
     // When source id changed, notice client to print.
     void update_source_id();
-    // Put SRT packet into queue.
+    // Put SRT packet into queue, which is shared by consumers, see SrsSrtPacket::share.
     srs_error_t enqueue(SrsSrtPacket* packet);
-    // For SRT, we only got one packet, because there is not many packets in queue.
-    virtual srs_error_t dump_packet(SrsSrtPacket** ppkt);
-    // Wait for at-least some messages incoming in queue.
-    virtual void wait(int nb_msgs, srs_utime_t timeout);
+    // Dump at most max packets in a batch, and the caller should free each packet by SrsSrtPacket::release.
+    virtual srs_error_t dump_packets(SrsSrtPacket** pkts, int max, int& count);
+    // Wait for at-least some messages incoming in queue, or wakeup, or interrupted.
+    virtual void wait(int nb_msgs);
+    // Wakeup the waiting consumer, for example, when the player is disconnected.
+    virtual void wakeup();
 };
 
 class ISrsSrtSourceBridge
@@ -160,6 +170,53 @@ private:
     SrsAlonePithyPrint* pp_audio_duration_;
 };
 
+// Bridge SRT to HLS, which writes the original TS packets to segments, without demux and remux. It only parses the
+// PAT/PMT and the PES header of video, to reap the segment at keyframe.
+// Unlike other bridges, it's owned by the SRT source and lives across publish, to dispose the segments by hls_dispose
+// after unpublished, like SrsHls of live source.
+class SrsHlsFromSrtBridge : public ISrsSrtSourceBridge, public ISrsFastTimer
+{
+private:
+    SrsRequest* req_;
+    SrsHlsController* controller_;
+    // Whether HLS is publishing, it's disabled when error, for HLS should never break the stream.
+    bool enabled_;
+    // Whether the segments should be disposed, when stream is unpublished.
+    bool disposable_;
+    srs_utime_t last_update_time_;
+private:
+    // The PID of PMT, parsed from PAT.
+    int pmt_pid_;
+    // The PID of video and audio, parsed from PMT, -1 if not found.
+    int video_pid_;
+    int audio_pid_;
+    SrsTsStream video_codec_;
+    // The latest PAT and PMT packets, written at the start of each segment.
+    std::string pat_;
+    std::string pmt_;
+    std::string psi_;
+public:
+    SrsHlsFromSrtBridge();
+    virtual ~SrsHlsFromSrtBridge();
+public:
+    srs_error_t initialize(SrsRequest* req);
+    // Ignore if srt_to_hls or hls is disabled. The errors of HLS are ignored, without breaking the publish.
+    virtual srs_error_t on_publish();
+    virtual srs_error_t on_packet(SrsSrtPacket *pkt);
+    virtual void on_unpublish();
+// Interface ISrsFastTimer
+private:
+    srs_error_t on_timer(srs_utime_t interval);
+private:
+    srs_error_t on_ts_packet(char* data);
+    // Scan the TS packet for PSI, and the dts of frame starts in packet, -1 if no frame.
+    void scan_ts_packet(char* data, int64_t& dts, bool& keyframe);
+    void parse_pat(char* data, int size);
+    void parse_pmt(char* data, int size);
+    // Parse the PES header for dts, and whether it starts with a keyframe.
+    void parse_pes(char* data, int size, bool is_video, int64_t& dts, bool& keyframe);
+};
+
 class SrsSrtSource
 {
 public:
@@ -176,7 +233,9 @@ public:
     // Update the authentication information in request.
     virtual void update_auth(SrsRequest* r);
 public:
-    void set_bridge(ISrsSrtSourceBridge *bridger);
+    // Add a bridge to deliver the TS packets to other sources, for example, RTMP and RTC. The bridges are freed
+    // when stream is unpublished, while the HLS is owned by source, see SrsHlsFromSrtBridge.
+    void add_bridge(ISrsSrtSourceBridge *bridge);
 public:
     // Create consumer
     // @param consumer, output the create consumer.
@@ -192,6 +251,8 @@ public:
     virtual void on_unpublish();
 public:
     srs_error_t on_packet(SrsSrtPacket* packet);
+private:
+    void free_bridges();
 private:
     // Source id.
     SrsContextId _source_id;
@@ -201,7 +262,8 @@ private:
     // To delivery packets to clients.
     std::vector<SrsSrtConsumer*> consumers;
     bool can_publish_;
-    ISrsSrtSourceBridge* bridge_;
+    std::vector<ISrsSrtSourceBridge*> bridges_;
+    SrsHlsFromSrtBridge* hls_;
 };
 
 #endif
@@ -212,6 +212,14 @@ SrsStatisticClient::SrsStatisticClient()
     create = srs_get_system_time();
 
     kbps = new SrsKbps();
+    bwe_kbps = 0;
+    pacing_kbps = 0;
+    loss = 0;
+    srt_packets = 0;
+    srt_msgs = 0;
+    srt_batches = 0;
+    srt_retrans = 0;
+    srt_drop = 0;
 }
 
 SrsStatisticClient::~SrsStatisticClient()
@@ -244,6 +252,28 @@ srs_error_t SrsStatisticClient::dumps(SrsJsonObject* obj)
 
     okbps->set("recv_30s", SrsJsonAny::integer(kbps->get_recv_kbps_30s()));
     okbps->set("send_30s", SrsJsonAny::integer(kbps->get_send_kbps_30s()));
+
+    // For RTC player, dumps the bandwidth estimation.
+    if (bwe_kbps > 0) {
+        SrsJsonObject* obwe = SrsJsonAny::object();
+        obj->set("bwe", obwe);
+
+        obwe->set("estimate", SrsJsonAny::integer(bwe_kbps));
+        obwe->set("pacing", SrsJsonAny::integer(pacing_kbps));
+        obwe->set("loss", SrsJsonAny::number(loss));
+    }
+
+    // For SRT player, dumps the send counters.
+    if (srt_msgs > 0) {
+        SrsJsonObject* osrt = SrsJsonAny::object();
+        obj->set("srt", osrt);
+
+        osrt->set("packets", SrsJsonAny::integer(srt_packets));
+        osrt->set("msgs", SrsJsonAny::integer(srt_msgs));
+        osrt->set("batches", SrsJsonAny::integer(srt_batches));
+        osrt->set("retrans", SrsJsonAny::integer(srt_retrans));
+        osrt->set("drop", SrsJsonAny::integer(srt_drop));
+    }
     
     return err;
 }
@@ -475,6 +505,30 @@ void SrsStatistic::on_disconnect(std::string id, srs_error_t err)
     cleanup_stream(stream);
 }
 
+void SrsStatistic::on_client_bwe(std::string id, int bwe_kbps, int pacing_kbps, float loss)
+{
+    std::map<std::string, SrsStatisticClient*>::iterator it = clients.find(id);
+    if (it == clients.end()) return;
+
+    SrsStatisticClient* client = it->second;
+    client->bwe_kbps = bwe_kbps;
+    client->pacing_kbps = pacing_kbps;
+    client->loss = loss;
+}
+
+void SrsStatistic::on_client_srt_send(std::string id, int64_t packets, int64_t msgs, int64_t batches, int64_t retrans, int64_t drop)
+{
+    std::map<std::string, SrsStatisticClient*>::iterator it = clients.find(id);
+    if (it == clients.end()) return;
+
+    SrsStatisticClient* client = it->second;
+    client->srt_packets = packets;
+    client->srt_msgs = msgs;
+    client->srt_batches = batches;
+    client->srt_retrans = retrans;
+    client->srt_drop = drop;
+}
+
 void SrsStatistic::cleanup_stream(SrsStatisticStream* stream)
 {
     // If stream has publisher(not active) or player(clients), never cleanup it.
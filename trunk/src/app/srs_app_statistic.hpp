@@ -115,6 +115,17 @@ public:
 public:
     // The stream total kbps.
     SrsKbps* kbps;
+    // For RTC player, the estimated bandwidth and pacing rate in kbps, and the loss rate in [0, 1].
+    int bwe_kbps;
+    int pacing_kbps;
+    float loss;
+    // For SRT player, the number of TS packets from source, SRT messages and batches sent, and the packets
+    // retransmitted or dropped by SRT.
+    int64_t srt_packets;
+    int64_t srt_msgs;
+    int64_t srt_batches;
+    int64_t srt_retrans;
+    int64_t srt_drop;
 public:
     SrsStatisticClient();
     virtual ~SrsStatisticClient();
@@ -192,6 +203,10 @@ public:
     //      only got the request object, so the client specified by id maybe not
     //      exists in stat.
     virtual void on_disconnect(std::string id, srs_error_t err);
+    // When RTC player got the estimated bandwidth, by TWCC feedback or REMB.
+    virtual void on_client_bwe(std::string id, int bwe_kbps, int pacing_kbps, float loss);
+    // When SRT player sent packets, update the send counters.
+    virtual void on_client_srt_send(std::string id, int64_t packets, int64_t msgs, int64_t batches, int64_t retrans, int64_t drop);
 private:
     // Cleanup the stream if stream is not active and for the last client.
     void cleanup_stream(SrsStatisticStream* stream);
@@ -18,6 +18,11 @@
 #include <srs_app_async_call.hpp>
 #include <srs_app_tencentcloud.hpp>
 #include <srs_app_conn.hpp>
+#include <srs_app_hls.hpp>
+#include <srs_app_dash.hpp>
+#include <srs_app_http_static.hpp>
+#include <srs_app_edge.hpp>
+#include <srs_app_http_hooks.hpp>
 #ifdef SRS_RTC
 #include <srs_app_rtc_dtls.hpp>
 #include <srs_app_rtc_conn.hpp>
@@ -31,10 +36,13 @@
 
 #include <stdlib.h>
 #include <string>
+#include <algorithm>
 using namespace std;
 
 #include <unistd.h>
 #include <fcntl.h>
+#include <stdio.h>
+#include <sys/time.h>
 
 #if defined(SRS_OSX) || defined(SRS_CYGWIN64)
     pid_t gettid() {
@@ -299,6 +307,7 @@ srs_error_t SrsCircuitBreaker::on_timer(srs_utime_t interval)
 
 SrsCircuitBreaker* _srs_circuit_breaker = NULL;
 SrsAsyncCallWorker* _srs_dvr_async = NULL;
+SrsAsyncCallWorker* _srs_hooks_async = NULL;
 
 srs_error_t srs_global_initialize()
 {
@@ -321,6 +330,11 @@ srs_error_t srs_global_initialize()
     _srs_sources = new SrsLiveSourceManager();
     _srs_stages = new SrsStageManager();
     _srs_circuit_breaker = new SrsCircuitBreaker();
+    _srs_async_file_worker = new SrsAsyncFileWorker();
+    _srs_hls_playlists = new SrsHlsPlaylistCache();
+    _srs_dash_partials = new SrsDashPartialFragments();
+    _srs_mp4_indexes = new SrsMp4IndexCache();
+    _srs_edge_relay = new SrsEdgeRelay();
 
 #ifdef SRS_SRT
     _srs_srt_sources = new SrsSrtSourceManager();
@@ -332,6 +346,7 @@ srs_error_t srs_global_initialize()
 
     _srs_rtc_manager = new SrsResourceManager("RTC", true);
     _srs_rtc_dtls_certificate = new SrsDtlsCertificate();
+    _srs_async_srtp = new SrsAsyncSrtpWorkers();
 #endif
 #ifdef SRS_GB28181
     _srs_gb_manager = new SrsResourceManager("GB", true);
@@ -445,6 +460,11 @@ srs_error_t srs_global_initialize()
     // Create global async worker for DVR.
     _srs_dvr_async = new SrsAsyncCallWorker();
 
+    // Create global async worker, keep-alive connections and decision cache for HTTP hooks.
+    _srs_hooks_async = new SrsAsyncCallWorker();
+    _srs_http_hooks_pool = new SrsHttpHooksPool();
+    _srs_http_hooks_cache = new SrsHttpHooksCache();
+
 #ifdef SRS_APM
     // Initialize global TencentCloud CLS object.
     _srs_cls = new SrsClsClient();
@@ -803,3 +823,631 @@ void* SrsThreadPool::start(void* arg)
 // It MUST be thread-safe, global and shared object.
 SrsThreadPool* _srs_thread_pool = new SrsThreadPool();
 
+
+// The wall clock for file I/O thread, note that we should never update the cached
+// system time of hybrid thread.
+static srs_utime_t srs_async_file_now()
+{
+    timeval now;
+    if (gettimeofday(&now, NULL) < 0) {
+        return 0;
+    }
+    return (srs_utime_t)now.tv_sec * SRS_UTIME_SECONDS + now.tv_usec;
+}
+
+SrsAsyncFileTask::SrsAsyncFileTask(SrsAsyncFileType t, string p)
+{
+    type = t;
+    path = p;
+    created = srs_async_file_now();
+}
+
+SrsAsyncFileTask::~SrsAsyncFileTask()
+{
+}
+
+srs_error_t SrsAsyncFileTask::execute()
+{
+    srs_error_t err = srs_success;
+
+    if (type == SrsAsyncFileTypeUnlink) {
+        if (::unlink(path.c_str()) < 0) {
+            return srs_error_new(ERROR_SYSTEM_FRAGMENT_UNLINK, "unlink %s", path.c_str());
+        }
+        return err;
+    }
+
+    if (type == SrsAsyncFileTypeRename) {
+        if (::rename(path.c_str(), target.c_str()) < 0) {
+            return srs_error_new(ERROR_SYSTEM_FRAGMENT_RENAME, "rename %s to %s", path.c_str(), target.c_str());
+        }
+        return err;
+    }
+
+    // Write to temporary file, then rename to make it atomic.
+    string tmp_file = path + ".temp";
+
+    FILE* fp = ::fopen(tmp_file.c_str(), "wb");
+    if (!fp) {
+        return srs_error_new(ERROR_SYSTEM_FILE_OPENE, "open file %s failed", tmp_file.c_str());
+    }
+
+    size_t nn = data.empty() ? 0 : ::fwrite(data.data(), 1, data.length(), fp);
+    if (::fclose(fp) < 0 || nn != data.length()) {
+        ::unlink(tmp_file.c_str());
+        return srs_error_new(ERROR_SYSTEM_FILE_WRITE, "write to file %s failed", tmp_file.c_str());
+    }
+
+    if (::rename(tmp_file.c_str(), path.c_str()) < 0) {
+        ::unlink(tmp_file.c_str());
+        return srs_error_new(ERROR_SYSTEM_FRAGMENT_RENAME, "rename %s to %s", tmp_file.c_str(), path.c_str());
+    }
+
+    return err;
+}
+
+SrsAsyncFileWorker::SrsAsyncFileWorker()
+{
+    started_ = false;
+    quit_ = exited_ = false;
+
+    int r0 = pthread_mutex_init(&lock_, NULL);
+    srs_assert(!r0);
+
+    r0 = pthread_cond_init(&cond_, NULL);
+    srs_assert(!r0);
+
+    r0 = pthread_cond_init(&done_, NULL);
+    srs_assert(!r0);
+
+    pipes_[0] = pipes_[1] = -1;
+    rfd_ = NULL;
+    trd_ = NULL;
+
+    nn_tasks_ = nn_errors_ = nn_dropped_ = 0;
+    total_latency_ = max_latency_ = 0;
+}
+
+SrsAsyncFileWorker::~SrsAsyncFileWorker()
+{
+    // Wait for the thread to execute the pending tasks and quit.
+    pthread_mutex_lock(&lock_);
+    quit_ = true;
+    pthread_cond_signal(&cond_);
+    while (started_ && !exited_) {
+        pthread_cond_wait(&done_, &lock_);
+    }
+    pthread_mutex_unlock(&lock_);
+
+    srs_freep(trd_);
+    if (rfd_) {
+        srs_close_stfd(rfd_);
+    } else if (pipes_[0] > 0) {
+        ::close(pipes_[0]);
+    }
+    if (pipes_[1] > 0) {
+        ::close(pipes_[1]);
+    }
+
+    for (int i = 0; i < (int)tasks_.size(); i++) {
+        SrsAsyncFileTask* task = tasks_.at(i);
+        srs_freep(task);
+    }
+    tasks_.clear();
+
+    for (int i = 0; i < (int)errors_.size(); i++) {
+        srs_error_t err = errors_.at(i);
+        srs_freep(err);
+    }
+    errors_.clear();
+
+    pthread_cond_destroy(&done_);
+    pthread_cond_destroy(&cond_);
+    pthread_mutex_destroy(&lock_);
+}
+
+srs_error_t SrsAsyncFileWorker::start()
+{
+    srs_error_t err = srs_success;
+
+    if (started_) {
+        return err;
+    }
+
+    if (::pipe(pipes_) < 0) {
+        return srs_error_new(ERROR_SYSTEM_CREATE_PIPE, "create pipe");
+    }
+
+    if ((err = _srs_thread_pool->execute("fileio", SrsAsyncFileWorker::start_thread, this)) != srs_success) {
+        return srs_error_wrap(err, "start file io thread");
+    }
+
+    pthread_mutex_lock(&lock_);
+    started_ = true;
+    pthread_mutex_unlock(&lock_);
+
+    return err;
+}
+
+srs_error_t SrsAsyncFileWorker::write(string path, string& data)
+{
+    SrsAsyncFileTask* task = new SrsAsyncFileTask(SrsAsyncFileTypeWrite, path);
+    task->data.swap(data);
+    return submit(task);
+}
+
+srs_error_t SrsAsyncFileWorker::rename(string from, string to)
+{
+    SrsAsyncFileTask* task = new SrsAsyncFileTask(SrsAsyncFileTypeRename, from);
+    task->target = to;
+    return submit(task);
+}
+
+srs_error_t SrsAsyncFileWorker::unlink(string path)
+{
+    return submit(new SrsAsyncFileTask(SrsAsyncFileTypeUnlink, path));
+}
+
+void SrsAsyncFileWorker::dumps(int* pending, int64_t* tasks, int64_t* errors, int64_t* dropped, srs_utime_t* avg_latency, srs_utime_t* max_latency)
+{
+    pthread_mutex_lock(&lock_);
+
+    *pending = (int)tasks_.size();
+    *tasks = nn_tasks_;
+    *errors = nn_errors_;
+    *dropped = nn_dropped_;
+    *avg_latency = nn_tasks_ ? total_latency_ / nn_tasks_ : 0;
+    *max_latency = max_latency_;
+
+    pthread_mutex_unlock(&lock_);
+}
+
+srs_error_t SrsAsyncFileWorker::submit(SrsAsyncFileTask* task)
+{
+    srs_error_t err = srs_success;
+
+    pthread_mutex_lock(&lock_);
+
+    // Execute in the caller thread, if the file I/O thread is not started or quit.
+    if (!started_ || exited_) {
+        pthread_mutex_unlock(&lock_);
+
+        err = task->execute();
+        on_done(task, srs_error_copy(err));
+        return err;
+    }
+
+    // Start the dispatcher in the hybrid thread, because the ST is thread-local.
+    if (!trd_ && pipes_[0] > 0) {
+        pthread_mutex_unlock(&lock_);
+
+        if ((rfd_ = srs_netfd_open(pipes_[0])) == NULL) {
+            srs_freep(task);
+            return srs_error_new(ERROR_ST_OPEN_SOCKET, "open pipe");
+        }
+
+        trd_ = new SrsSTCoroutine("fileio", this);
+        if ((err = trd_->start()) != srs_success) {
+            srs_freep(task);
+            return srs_error_wrap(err, "start file io dispatcher");
+        }
+
+        pthread_mutex_lock(&lock_);
+    }
+
+    // Overwrite the pending write to the same file, because only the latest content is useful, for
+    // example, the m3u8 is refreshed for each segment. Keep the position of task, to keep the order.
+    if (task->type == SrsAsyncFileTypeWrite) {
+        for (int i = (int)tasks_.size() - 1; i >= 0; i--) {
+            SrsAsyncFileTask* pending = tasks_.at(i);
+            if (pending->type == SrsAsyncFileTypeWrite && pending->path == task->path) {
+                pending->data.swap(task->data);
+                pthread_mutex_unlock(&lock_);
+
+                srs_freep(task);
+                return err;
+            }
+        }
+    }
+
+    // Drop the task if the queue is full, because the hybrid thread should never wait for the disk.
+    if ((int)tasks_.size() >= SRS_PERF_ASYNC_FILE_TASKS) {
+        int64_t nn_dropped = ++nn_dropped_;
+        pthread_mutex_unlock(&lock_);
+
+        srs_warn("file io: drop task type=%d, path=%s, pending=%d, dropped=%" PRId64,
+            (int)task->type, task->path.c_str(), SRS_PERF_ASYNC_FILE_TASKS, nn_dropped);
+        srs_freep(task);
+        return err;
+    }
+
+    tasks_.push_back(task);
+    pthread_cond_signal(&cond_);
+
+    pthread_mutex_unlock(&lock_);
+
+    return err;
+}
+
+void SrsAsyncFileWorker::on_done(SrsAsyncFileTask* task, srs_error_t err)
+{
+    srs_utime_t latency = srs_async_file_now() - task->created;
+
+    pthread_mutex_lock(&lock_);
+
+    nn_tasks_++;
+    if (err != srs_success) {
+        nn_errors_++;
+    }
+    total_latency_ += latency;
+    max_latency_ = srs_max(max_latency_, latency);
+
+    pthread_mutex_unlock(&lock_);
+
+    srs_freep(err);
+    srs_freep(task);
+}
+
+srs_error_t SrsAsyncFileWorker::cycle()
+{
+    srs_error_t err = srs_success;
+
+    while (true) {
+        if ((err = trd_->pull()) != srs_success) {
+            return srs_error_wrap(err, "file io dispatcher");
+        }
+
+        char buf[64];
+        if (srs_read(rfd_, buf, sizeof(buf), SRS_UTIME_NO_TIMEOUT) <= 0) {
+            return srs_error_new(ERROR_SOCKET_READ, "read pipe");
+        }
+
+        vector<srs_error_t> errors;
+        pthread_mutex_lock(&lock_);
+        errors.swap(errors_);
+        pthread_mutex_unlock(&lock_);
+
+        for (int i = 0; i < (int)errors.size(); i++) {
+            srs_error_t r0 = errors.at(i);
+            srs_warn("file io: ignore err %s", srs_error_desc(r0).c_str());
+            srs_freep(r0);
+        }
+    }
+
+    return err;
+}
+
+srs_error_t SrsAsyncFileWorker::do_cycle()
+{
+    while (true) {
+        vector<SrsAsyncFileTask*> tasks;
+
+        pthread_mutex_lock(&lock_);
+        while (tasks_.empty() && !quit_) {
+            pthread_cond_wait(&cond_, &lock_);
+        }
+        // Quit after all pending tasks are executed.
+        if (tasks_.empty() && quit_) {
+            exited_ = true;
+            pthread_cond_broadcast(&done_);
+            pthread_mutex_unlock(&lock_);
+            break;
+        }
+        tasks.swap(tasks_);
+        pthread_mutex_unlock(&lock_);
+
+        vector<srs_error_t> errors;
+        for (int i = 0; i < (int)tasks.size(); i++) {
+            SrsAsyncFileTask* task = tasks.at(i);
+
+            srs_error_t err = task->execute();
+            if (err != srs_success) {
+                errors.push_back(srs_error_copy(err));
+            }
+
+            on_done(task, err);
+        }
+
+        if (errors.empty()) {
+            continue;
+        }
+
+        // Notify the dispatcher only when the errors is empty, because it drains all errors.
+        pthread_mutex_lock(&lock_);
+        bool notify = errors_.empty();
+        errors_.insert(errors_.end(), errors.begin(), errors.end());
+        pthread_mutex_unlock(&lock_);
+
+        if (notify && ::write(pipes_[1], "e", 1) < 0) {
+            srs_warn("file io: notify dispatcher failed");
+        }
+    }
+
+    return srs_success;
+}
+
+srs_error_t SrsAsyncFileWorker::start_thread(void* arg)
+{
+    SrsAsyncFileWorker* worker = (SrsAsyncFileWorker*)arg;
+    return worker->do_cycle();
+}
+
+// It MUST be thread-safe, global and shared object.
+SrsAsyncFileWorker* _srs_async_file_worker = NULL;
+
+#ifdef SRS_RTC
+SrsAsyncSrtpTask::SrsAsyncSrtpTask(SrsSRTP* s, void** p, int* nb, int nn)
+{
+    srtp = s;
+    packets = p;
+    nb_ciphers = nb;
+    nn_packets = nn;
+    err = srs_success;
+    done = false;
+    cond = srs_cond_new();
+}
+
+SrsAsyncSrtpTask::~SrsAsyncSrtpTask()
+{
+    srs_freep(err);
+    srs_cond_destroy(cond);
+}
+
+SrsAsyncSrtpQueue::SrsAsyncSrtpQueue(SrsAsyncSrtpWorkers* w)
+{
+    workers = w;
+    started = quit = exited = false;
+
+    int r0 = pthread_mutex_init(&lock, NULL);
+    srs_assert(!r0);
+
+    r0 = pthread_cond_init(&cond, NULL);
+    srs_assert(!r0);
+}
+
+SrsAsyncSrtpQueue::~SrsAsyncSrtpQueue()
+{
+    pthread_cond_destroy(&cond);
+    pthread_mutex_destroy(&lock);
+}
+
+SrsAsyncSrtpWorkers::SrsAsyncSrtpWorkers()
+{
+    int r0 = pthread_mutex_init(&lock_, NULL);
+    srs_assert(!r0);
+
+    pipes_[0] = pipes_[1] = -1;
+    rfd_ = NULL;
+    trd_ = NULL;
+}
+
+SrsAsyncSrtpWorkers::~SrsAsyncSrtpWorkers()
+{
+    // Stop the worker threads, which protect the tasks in queue before quit.
+    for (int i = 0; i < (int)queues_.size(); i++) {
+        SrsAsyncSrtpQueue* queue = queues_.at(i);
+
+        pthread_mutex_lock(&queue->lock);
+        queue->quit = true;
+        pthread_cond_broadcast(&queue->cond);
+        while (queue->started && !queue->exited) {
+            pthread_cond_wait(&queue->cond, &queue->lock);
+        }
+        pthread_mutex_unlock(&queue->lock);
+    }
+
+    srs_freep(trd_);
+    if (rfd_) {
+        srs_close_stfd(rfd_);
+    } else if (pipes_[0] > 0) {
+        ::close(pipes_[0]);
+    }
+    if (pipes_[1] > 0) {
+        ::close(pipes_[1]);
+    }
+
+    for (int i = 0; i < (int)queues_.size(); i++) {
+        SrsAsyncSrtpQueue* queue = queues_.at(i);
+        srs_freep(queue);
+    }
+    queues_.clear();
+
+    pthread_mutex_destroy(&lock_);
+}
+
+srs_error_t SrsAsyncSrtpWorkers::start(int nn_workers)
+{
+    srs_error_t err = srs_success;
+
+    if (!queues_.empty() || nn_workers <= 0) {
+        return err;
+    }
+
+    if (::pipe(pipes_) < 0) {
+        return srs_error_new(ERROR_SYSTEM_CREATE_PIPE, "create pipe");
+    }
+
+    // Create all queues before starting threads, because the queues are never changed after started.
+    for (int i = 0; i < nn_workers; i++) {
+        queues_.push_back(new SrsAsyncSrtpQueue(this));
+    }
+
+    for (int i = 0; i < nn_workers; i++) {
+        SrsAsyncSrtpQueue* queue = queues_.at(i);
+        if ((err = _srs_thread_pool->execute("srtp", SrsAsyncSrtpWorkers::start_thread, queue)) != srs_success) {
+            return srs_error_wrap(err, "start srtp thread #%d", i);
+        }
+
+        pthread_mutex_lock(&queue->lock);
+        queue->started = true;
+        pthread_mutex_unlock(&queue->lock);
+    }
+
+    return err;
+}
+
+bool SrsAsyncSrtpWorkers::enabled()
+{
+    return !queues_.empty();
+}
+
+srs_error_t SrsAsyncSrtpWorkers::protect_rtps(SrsSRTP* srtp, void** packets, int* nb_ciphers, int nn_packets)
+{
+    srs_error_t err = srs_success;
+
+    // Protect in the caller thread, if the workers are not started, or the batch is too small to pay for the hop.
+    if (queues_.empty() || nn_packets < SRS_PERF_RTC_SRTP_OFFLOAD_MIN_PACKETS) {
+        return srtp->do_protect_rtps(packets, nb_ciphers, nn_packets);
+    }
+
+    // Start the dispatcher in the hybrid thread, because the ST is thread-local.
+    if (!trd_) {
+        if ((rfd_ = srs_netfd_open(pipes_[0])) == NULL) {
+            return srs_error_new(ERROR_ST_OPEN_SOCKET, "open pipe");
+        }
+
+        trd_ = new SrsSTCoroutine("srtp", this);
+        if ((err = trd_->start()) != srs_success) {
+            return srs_error_wrap(err, "start srtp dispatcher");
+        }
+    }
+
+    // Shard by the SRTP context, so a context is always protected by the same thread.
+    SrsAsyncSrtpQueue* queue = queues_.at(((uintptr_t)srtp >> 4) % queues_.size());
+
+    SrsAsyncSrtpTask task(srtp, packets, nb_ciphers, nn_packets);
+
+    pthread_mutex_lock(&queue->lock);
+    queue->tasks.push_back(&task);
+    pthread_cond_signal(&queue->cond);
+    pthread_mutex_unlock(&queue->lock);
+
+    // Never quit util done or canceled, even the coroutine is interrupted, because the task refers to the packets.
+    // If timeout, for example, the worker is blocked or the dispatcher quit, we take back the task.
+    while (!task.done) {
+        srs_cond_timedwait(task.cond, SRS_PERF_RTC_SRTP_WORKER_TIMEOUT_MS * SRS_UTIME_MILLISECONDS);
+        if (task.done || !cancel(queue, &task)) {
+            continue;
+        }
+
+        // Fail the batch if the worker doesn't pick it.
+        if (!task.done) {
+            memset(nb_ciphers, 0, sizeof(int) * nn_packets);
+            return srs_error_new(ERROR_RTC_SRTP_PROTECT, "timeout %dms for %d packets", SRS_PERF_RTC_SRTP_WORKER_TIMEOUT_MS, nn_packets);
+        }
+    }
+
+    err = task.err;
+    task.err = srs_success;
+    return err;
+}
+
+srs_error_t SrsAsyncSrtpWorkers::cycle()
+{
+    srs_error_t err = srs_success;
+
+    while (true) {
+        if ((err = trd_->pull()) != srs_success) {
+            return srs_error_wrap(err, "srtp dispatcher");
+        }
+
+        char buf[64];
+        if (srs_read(rfd_, buf, sizeof(buf), SRS_UTIME_NO_TIMEOUT) <= 0) {
+            return srs_error_new(ERROR_SOCKET_READ, "read pipe");
+        }
+
+        vector<SrsAsyncSrtpTask*> tasks;
+        pthread_mutex_lock(&lock_);
+        tasks.swap(done_);
+        pthread_mutex_unlock(&lock_);
+
+        for (int i = 0; i < (int)tasks.size(); i++) {
+            SrsAsyncSrtpTask* task = tasks.at(i);
+            task->done = true;
+            srs_cond_signal(task->cond);
+        }
+    }
+
+    return err;
+}
+
+bool SrsAsyncSrtpWorkers::cancel(SrsAsyncSrtpQueue* queue, SrsAsyncSrtpTask* task)
+{
+    // The task is not picked by worker.
+    pthread_mutex_lock(&queue->lock);
+    vector<SrsAsyncSrtpTask*>::iterator it = std::find(queue->tasks.begin(), queue->tasks.end(), task);
+    bool pending = (it != queue->tasks.end());
+    if (pending) {
+        queue->tasks.erase(it);
+    }
+    pthread_mutex_unlock(&queue->lock);
+
+    if (pending) {
+        return true;
+    }
+
+    // The task is done, but the dispatcher doesn't wakeup us.
+    pthread_mutex_lock(&lock_);
+    it = std::find(done_.begin(), done_.end(), task);
+    bool done = (it != done_.end());
+    if (done) {
+        done_.erase(it);
+    }
+    pthread_mutex_unlock(&lock_);
+
+    if (done) {
+        task->done = true;
+    }
+
+    return done;
+}
+
+srs_error_t SrsAsyncSrtpWorkers::do_cycle(SrsAsyncSrtpQueue* queue)
+{
+    while (true) {
+        vector<SrsAsyncSrtpTask*> tasks;
+
+        pthread_mutex_lock(&queue->lock);
+        while (queue->tasks.empty() && !queue->quit) {
+            pthread_cond_wait(&queue->cond, &queue->lock);
+        }
+
+        // Quit when all tasks are protected.
+        if (queue->tasks.empty()) {
+            queue->exited = true;
+            pthread_cond_broadcast(&queue->cond);
+            pthread_mutex_unlock(&queue->lock);
+            break;
+        }
+
+        tasks.swap(queue->tasks);
+        pthread_mutex_unlock(&queue->lock);
+
+        for (int i = 0; i < (int)tasks.size(); i++) {
+            SrsAsyncSrtpTask* task = tasks.at(i);
+            task->err = task->srtp->do_protect_rtps(task->packets, task->nb_ciphers, task->nn_packets);
+        }
+
+        // Notify the dispatcher only when the done queue is empty, because it drains all tasks.
+        pthread_mutex_lock(&lock_);
+        bool notify = done_.empty();
+        done_.insert(done_.end(), tasks.begin(), tasks.end());
+        pthread_mutex_unlock(&lock_);
+
+        if (notify && ::write(pipes_[1], "d", 1) < 0) {
+            srs_warn("srtp: notify dispatcher failed");
+        }
+    }
+
+    return srs_success;
+}
+
+srs_error_t SrsAsyncSrtpWorkers::start_thread(void* arg)
+{
+    SrsAsyncSrtpQueue* queue = (SrsAsyncSrtpQueue*)arg;
+    return queue->workers->do_cycle(queue);
+}
+
+// It MUST be thread-safe, global and shared object.
+SrsAsyncSrtpWorkers* _srs_async_srtp = NULL;
+#endif
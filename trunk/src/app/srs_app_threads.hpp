@@ -15,6 +15,7 @@
 
 class SrsThreadPool;
 class SrsProcSelfStat;
+class SrsAsyncSrtpWorkers;
 
 // Protect server in high load.
 class SrsCircuitBreaker : public ISrsFastTimer
@@ -78,12 +79,17 @@ class impl__SrsThreadLocker
 private:
     SrsThreadMutex* lock;
 public:
+    // @remark Ignore if NULL, for the object which is not shared by threads.
     impl__SrsThreadLocker(SrsThreadMutex* l) {
         lock = l;
-        lock->lock();
+        if (lock) {
+            lock->lock();
+        }
     }
     virtual ~impl__SrsThreadLocker() {
-        lock->unlock();
+        if (lock) {
+            lock->unlock();
+        }
     }
 };
 
@@ -158,5 +164,182 @@ private:
 // It MUST be thread-safe, global and shared object.
 extern SrsThreadPool* _srs_thread_pool;
 
+// The type of async file operation.
+enum SrsAsyncFileType
+{
+    // Write data to a temporary file, then rename to the file.
+    SrsAsyncFileTypeWrite = 0,
+    SrsAsyncFileTypeRename,
+    SrsAsyncFileTypeUnlink,
+};
+
+// The file operation, executed in the async file I/O thread.
+class SrsAsyncFileTask
+{
+public:
+    SrsAsyncFileType type;
+    // The file to write, rename or unlink.
+    std::string path;
+    // For rename, the target file.
+    std::string target;
+    // For write, the content of file.
+    std::string data;
+    // The time when submit the task, to stat the latency.
+    srs_utime_t created;
+public:
+    SrsAsyncFileTask(SrsAsyncFileType t, std::string p);
+    virtual ~SrsAsyncFileTask();
+public:
+    srs_error_t execute();
+};
+
+// The async file I/O worker, to execute the file operations such as m3u8 write and
+// HLS cleanup in a dedicated thread, so a slow disk or NFS never blocks the hybrid thread.
+// @remark The tasks are executed in FIFO order, for example, the m3u8 is always written
+//      before the expired segments are unlinked.
+// @remark Execute the task in the caller thread if worker is not started, for example,
+//      in utest or single thread mode.
+// @remark A pending write to the same file is overwritten by the latest data, and the task is
+//      dropped when the queue is full, so the caller never waits for the disk.
+// @remark The errors of tasks are reported to the hybrid thread by pipe, and logged there.
+class SrsAsyncFileWorker : public ISrsCoroutineHandler
+{
+private:
+    bool started_;
+    // Whether to quit the thread, and whether the thread quit, protected by lock.
+    bool quit_;
+    bool exited_;
+    pthread_mutex_t lock_;
+    pthread_cond_t cond_;
+    // Signal when the thread quit.
+    pthread_cond_t done_;
+    std::vector<SrsAsyncFileTask*> tasks_;
+private:
+    // The errors of tasks in the file I/O thread, notified to hybrid thread by pipe, protected by lock.
+    std::vector<srs_error_t> errors_;
+    int pipes_[2];
+    // The dispatcher in hybrid thread, to log the errors of tasks.
+    srs_netfd_t rfd_;
+    SrsCoroutine* trd_;
+private:
+    // The statistic of tasks, protected by lock.
+    int64_t nn_tasks_;
+    int64_t nn_errors_;
+    int64_t nn_dropped_;
+    srs_utime_t total_latency_;
+    srs_utime_t max_latency_;
+public:
+    SrsAsyncFileWorker();
+    virtual ~SrsAsyncFileWorker();
+public:
+    // Start the file I/O thread in thread pool.
+    srs_error_t start();
+public:
+    // Write data to file atomically, by a temporary file then rename.
+    // @remark The data is swapped to the task, so it's empty after return, to avoid copying large content.
+    srs_error_t write(std::string path, std::string& data);
+    srs_error_t rename(std::string from, std::string to);
+    srs_error_t unlink(std::string path);
+public:
+    // Dump the statistic, such as the latency of tasks.
+    void dumps(int* pending, int64_t* tasks, int64_t* errors, int64_t* dropped, srs_utime_t* avg_latency, srs_utime_t* max_latency);
+private:
+    srs_error_t submit(SrsAsyncFileTask* task);
+    void on_done(SrsAsyncFileTask* task, srs_error_t err);
+// Interface ISrsCoroutineHandler
+public:
+    virtual srs_error_t cycle();
+private:
+    srs_error_t do_cycle();
+    static srs_error_t start_thread(void* arg);
+};
+
+// It MUST be thread-safe, global and shared object.
+extern SrsAsyncFileWorker* _srs_async_file_worker;
+
+#ifdef SRS_RTC
+class SrsSRTP;
+
+// A batch of RTP packets to protect by SRTP in worker thread.
+class SrsAsyncSrtpTask
+{
+public:
+    SrsSRTP* srtp;
+    void** packets;
+    int* nb_ciphers;
+    int nn_packets;
+    // The error of protect, set by worker thread.
+    srs_error_t err;
+    // Whether done, set by the dispatcher in hybrid thread, to wakeup the waiting coroutine.
+    bool done;
+    srs_cond_t cond;
+public:
+    SrsAsyncSrtpTask(SrsSRTP* s, void** p, int* nb, int nn);
+    virtual ~SrsAsyncSrtpTask();
+};
+
+// The queue of SRTP tasks for a worker thread.
+class SrsAsyncSrtpQueue
+{
+public:
+    SrsAsyncSrtpWorkers* workers;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    std::vector<SrsAsyncSrtpTask*> tasks;
+    // Whether the worker thread is started, should quit and has quit, protected by lock.
+    bool started;
+    bool quit;
+    bool exited;
+public:
+    SrsAsyncSrtpQueue(SrsAsyncSrtpWorkers* w);
+    virtual ~SrsAsyncSrtpQueue();
+};
+
+// The optional SRTP offload, to protect the batches of RTP packets of players in N threads, sharded by
+// the SRTP context of connection. The player coroutine waits for its batch, while other coroutines keep
+// running. It's not a multi-threaded RTC server, the connections, sources and timers are still in the
+// hybrid thread, only the SRTP cipher of player batches is moved out.
+// @remark Protect in the caller thread if workers are not started, for example, in utest, or the batch is
+//      too small to pay for the hop, see SRS_PERF_RTC_SRTP_OFFLOAD_MIN_PACKETS.
+// @remark The hop is a net loss on a single core host, which only moves the cipher to another thread on
+//      the same core, see research/srtp/srtp-offload-bench.cpp for the measurement.
+class SrsAsyncSrtpWorkers : public ISrsCoroutineHandler
+{
+private:
+    std::vector<SrsAsyncSrtpQueue*> queues_;
+private:
+    // The done tasks, notified to hybrid thread by pipe.
+    pthread_mutex_t lock_;
+    std::vector<SrsAsyncSrtpTask*> done_;
+    int pipes_[2];
+    // The dispatcher in hybrid thread, to wakeup the coroutines when task done.
+    srs_netfd_t rfd_;
+    SrsCoroutine* trd_;
+public:
+    SrsAsyncSrtpWorkers();
+    virtual ~SrsAsyncSrtpWorkers();
+public:
+    // Start the worker threads in thread pool.
+    srs_error_t start(int nn_workers);
+    // Whether the workers are started, so the SRTP context is shared by threads.
+    bool enabled();
+    // Protect the batch of packets by SRTP, in worker thread if started.
+    // @remark It's called in hybrid thread coroutine, which waits for the task done, and the batch fails if
+    //      timeout before the worker picks it, with all nb_ciphers set to 0.
+    srs_error_t protect_rtps(SrsSRTP* srtp, void** packets, int* nb_ciphers, int nn_packets);
+// Interface ISrsCoroutineHandler
+public:
+    virtual srs_error_t cycle();
+private:
+    srs_error_t do_cycle(SrsAsyncSrtpQueue* queue);
+    // Take back the task from the queue or the done tasks, return false if the worker is protecting it.
+    bool cancel(SrsAsyncSrtpQueue* queue, SrsAsyncSrtpTask* task);
+    static srs_error_t start_thread(void* arg);
+};
+
+// It MUST be thread-safe, global and shared object.
+extern SrsAsyncSrtpWorkers* _srs_async_srtp;
+#endif
+
 #endif
 
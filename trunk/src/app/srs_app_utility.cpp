@@ -26,6 +26,7 @@ using namespace std;
 #include <srs_kernel_log.hpp>
 #include <srs_app_config.hpp>
 #include <srs_kernel_utility.hpp>
+#include <srs_app_threads.hpp>
 #include <srs_kernel_error.hpp>
 #include <srs_protocol_kbps.hpp>
 #include <srs_protocol_json.hpp>
@@ -1377,6 +1378,24 @@ void srs_api_dump_summaries(SrsJsonObject* obj)
     sys->set("conn_sys_tw", SrsJsonAny::integer(nrs->nb_conn_sys_tw));
     sys->set("conn_sys_udp", SrsJsonAny::integer(nrs->nb_conn_sys_udp));
     sys->set("conn_srs", SrsJsonAny::integer(nrs->nb_conn_srs));
+
+    // The file I/O thread, for m3u8 write and HLS cleanup.
+    if (true) {
+        int pending = 0;
+        int64_t nn_tasks = 0, nn_errors = 0, nn_dropped = 0;
+        srs_utime_t avg_latency = 0, max_latency = 0;
+        _srs_async_file_worker->dumps(&pending, &nn_tasks, &nn_errors, &nn_dropped, &avg_latency, &max_latency);
+
+        SrsJsonObject* fio = SrsJsonAny::object();
+        data->set("file_io", fio);
+
+        fio->set("pending", SrsJsonAny::integer(pending));
+        fio->set("tasks", SrsJsonAny::integer(nn_tasks));
+        fio->set("errors", SrsJsonAny::integer(nn_errors));
+        fio->set("dropped", SrsJsonAny::integer(nn_dropped));
+        fio->set("avg_latency_ms", SrsJsonAny::integer(srsu2ms(avg_latency)));
+        fio->set("max_latency_ms", SrsJsonAny::integer(srsu2ms(max_latency)));
+    }
 }
 
 string srs_string_dumps_hex(const std::string& str)
@@ -163,6 +163,139 @@
     #undef SRS_PERF_SO_SNDBUF_SIZE
 #endif
 
+/**
+ * The libc cache size for file writer, for DVR and HLS segments. Because the
+ * SrsFileWriter tracks the offset itself, the file is written to disk only when
+ * the cache is full, that is, about one write syscall for each 64KB.
+ * @see SrsFileWriter::set_iobuf_size
+ */
+#define SRS_PERF_FWRITE_CACHE_SIZE 65536
+
+/**
+ * The max number of pending tasks of the file I/O thread, for HLS m3u8 and cleanup, the task is
+ * dropped when the queue is full, so the memory is bounded when the disk is too slow.
+ * @see SrsAsyncFileWorker
+ */
+#define SRS_PERF_ASYNC_FILE_TASKS 4096
+
+/**
+ * The max number of MP4 indexes to cache for VOD, in LRU. Each index contains the moov
+ * and samples of a MP4 file, so we're able to seek without parsing the file again.
+ * @see SrsMp4IndexCache
+ */
+#define SRS_PERF_MP4_INDEX_CACHE_SIZE 64
+
+/**
+ * The pacing rate of RTC player, in multiple of the estimated or sent bitrate, so the bursts
+ * such as keyframe are smoothed, while the average bitrate of stream is never limited.
+ * @see SrsRtcConnection::pace_packet
+ */
+#define SRS_PERF_RTC_PACING_FACTOR 2.5
+
+/**
+ * The max number of RTP packets in a send batch of RTC player, which are protected by SRTP
+ * together then sent, to amortize the cost of SRTP context for each packet.
+ * @see SrsRtcConnection::flush_packets
+ */
+#define SRS_PERF_RTC_SEND_BATCH 16
+
+/**
+ * The min number of RTP packets in a batch to protect by the SRTP worker, the smaller batch is
+ * protected in the hybrid thread, because the hop to worker costs about the same CPU of hybrid
+ * thread as protecting one packet, and adds latency.
+ * @see research/srtp/srtp-offload-bench.cpp
+ */
+#define SRS_PERF_RTC_SRTP_OFFLOAD_MIN_PACKETS 4
+
+/**
+ * The max time in ms for the RTC player to wait for a batch protected by the SRTP worker, the
+ * batch fails if the worker doesn't pick it in time, for example, the worker is blocked.
+ * @see SrsAsyncSrtpWorkers::protect_rtps
+ */
+#define SRS_PERF_RTC_SRTP_WORKER_TIMEOUT_MS 500
+
+/**
+ * The number of RTP packets in jitter buffer of RTC to RTMP, must be power of 2, which should
+ * be larger than the packets of a keyframe with the reordered packets of next frames.
+ * @see SrsRtcFrameBuilder
+ */
+#define SRS_PERF_RTC_FRAME_BUILDER_SLOTS 512
+
+/**
+ * The max time in ms for the SRT poller worker thread to wait on the SRT epoll, which only
+ * bounds the time to quit, because the worker wakes ST as soon as any SRT socket is fired.
+ * @see SrsSrtPoller::worker_cycle
+ */
+#define SRS_PERF_SRT_WORKER_WAIT_MS 100
+
+/**
+ * The max number of packets dumped from SRT consumer in a batch, to send by SRT player, where
+ * the small packets are coalesced to a message of payload size.
+ * @see SrsMpegtsSrtConn::do_playing
+ */
+#define SRS_PERF_SRT_SEND_BATCH 64
+
+/**
+ * The max number of UDP packets received in a batch by UDP listener, by recvmmsg on linux, so
+ * the packets of many devices on the same port are read by one syscall when busy. It's opt-in
+ * by SrsUdpListener::set_batch, only for the GB28181 media over UDP.
+ * @see SrsUdpListener::cycle
+ */
+#define SRS_PERF_UDP_RECV_BATCH 16
+
+/**
+ * The number of RTP packets in reorder buffer of GB28181 media over UDP, must be power of 2,
+ * and the packets are lost when over half of slots are buffered, or wait for too long, see
+ * SRS_PERF_GB_UDP_REORDER_TIMEOUT.
+ * @see SrsGbMediaUdpStream
+ */
+#define SRS_PERF_GB_UDP_REORDER_SLOTS 128
+
+/**
+ * The max time in ms to wait for the lost packet in reorder buffer of GB28181 media over UDP,
+ * then skip to the first buffered packet, even if only a few packets are buffered.
+ * @see SrsGbMediaUdpStream::check_reorder
+ */
+#define SRS_PERF_GB_UDP_REORDER_TIMEOUT 30
+
+/**
+ * The max number of RTP packets queued for each GB28181 media stream over UDP, which are
+ * dispatched by the UDP listener and consumed by the coroutine of stream, so a slow device
+ * never blocks the others. The packets are dropped when queue is full.
+ * @see SrsGbMediaUdpStream::enqueue
+ */
+#define SRS_PERF_GB_UDP_QUEUE_SIZE 1024
+
+/**
+ * The max number of connections to each endpoint of HTTP hooks, the hooks wait for a connection to be
+ * released when exceed it, and the connections are kept alive to reuse by the next hooks.
+ * @see SrsHttpHooksEndpoint
+ */
+#define SRS_PERF_HTTP_HOOKS_MAX_CONNS 64
+
+/**
+ * The max number of decisions of on_connect and on_play to cache, in LRU, when the cache of HTTP hooks is
+ * enabled by cache_ttl or cache_negative_ttl of vhost.
+ * @see SrsHttpHooksCache
+ */
+#define SRS_PERF_HTTP_HOOKS_CACHE_SIZE 10240
+
+/**
+ * The capacity of the ring of messages shared by all forwarders of a stream, which is also bounded by the
+ * queue_length of vhost, so the forwarders which are too slow lose the messages.
+ * @see SrsForwardRing
+ */
+#define SRS_PERF_FORWARD_RING_SIZE 8192
+
+/**
+ * The max number of recent deltas of stream directory for origin cluster, so the co-workers sync the directory
+ * incrementally by version, or sync the whole directory when the deltas are lost.
+ * @see SrsCoWorkers::dumps_directory
+ */
+#define SRS_PERF_COWORKERS_DELTAS 1024
+// The interval to sync the stream directory from co-workers, or when a pushed delta is lost.
+#define SRS_PERF_COWORKERS_SYNC_INTERVAL (1 * SRS_UTIME_SECONDS)
+
 /**
  * whether ensure glibc memory check.
  */
@@ -38,6 +38,7 @@ SrsFileWriter::SrsFileWriter()
 {
     fp_  = NULL;
     buf_ = NULL;
+    offset_ = 0;
 }
 
 SrsFileWriter::~SrsFileWriter()
@@ -77,6 +78,7 @@ srs_error_t SrsFileWriter::open(string p)
     }
     
     path_ = p;
+    offset_ = 0;
     
     return err;
 }
@@ -94,6 +96,13 @@ srs_error_t SrsFileWriter::open_append(string p)
     }
     
     path_ = p;
+
+    // In append mode, all data is written to the end of file.
+    offset_ = 0;
+    if (_srs_fseek_fn(fp_, 0, SEEK_END) != -1) {
+        long pos = _srs_ftell_fn(fp_);
+        offset_ = (pos > 0) ? (off_t)pos : 0;
+    }
     
     return err;
 }
@@ -108,10 +117,24 @@ void SrsFileWriter::close()
         srs_warn("close file %s failed", path_.c_str());
     }
     fp_ = NULL;
+    offset_ = 0;
     
     return;
 }
 
+srs_error_t SrsFileWriter::flush()
+{
+    if (fp_ == NULL) {
+        return srs_error_new(ERROR_SYSTEM_FILE_NOT_OPEN, "file %s is not opened", path_.c_str());
+    }
+
+    if (fflush(fp_) != 0) {
+        return srs_error_new(ERROR_SYSTEM_FILE_WRITE, "flush file %s", path_.c_str());
+    }
+
+    return srs_success;
+}
+
 bool SrsFileWriter::is_open()
 {
     return fp_ != NULL;
@@ -123,13 +146,15 @@ void SrsFileWriter::seek2(int64_t offset)
 
     int r0 = _srs_fseek_fn(fp_, (long)offset, SEEK_SET);
     srs_assert(r0 != -1);
+
+    offset_ = (off_t)offset;
 }
 
 int64_t SrsFileWriter::tellg()
 {
     srs_assert(is_open());
 
-    return _srs_ftell_fn(fp_);
+    return (int64_t)offset_;
 }
 
 srs_error_t SrsFileWriter::write(void* buf, size_t count, ssize_t* pnwrite)
@@ -145,6 +170,8 @@ srs_error_t SrsFileWriter::write(void* buf, size_t count, ssize_t* pnwrite)
         return srs_error_new(ERROR_SYSTEM_FILE_WRITE, "write to file %s failed", path_.c_str());
     }
 
+    offset_ += (off_t)n;
+
     if (pnwrite != NULL) {
         *pnwrite = (ssize_t)n;
     }
@@ -177,12 +204,28 @@ srs_error_t SrsFileWriter::lseek(off_t offset, int whence, off_t* seeked)
 {
     srs_assert(is_open());
 
+    // Query the current position, for example, the MP4 encoder does this for each sample. Note
+    // that fseek always flush the libc cache and issue lseek syscall, so we use the logical
+    // offset to avoid the syscalls, see SrsMp4Encoder::do_write_sample.
+    if (whence == SEEK_CUR && offset == 0) {
+        if (seeked) {
+            *seeked = offset_;
+        }
+        return srs_success;
+    }
+
     if (_srs_fseek_fn(fp_, (long)offset, whence) == -1) {
         return srs_error_new(ERROR_SYSTEM_FILE_SEEK, "seek file");
     }
 
+    long pos = _srs_ftell_fn(fp_);
+    if (pos == -1) {
+        return srs_error_new(ERROR_SYSTEM_FILE_SEEK, "tell file");
+    }
+    offset_ = (off_t)pos;
+
     if (seeked) {
-        *seeked = _srs_ftell_fn(fp_);
+        *seeked = offset_;
     }
 
     return srs_success;
@@ -22,6 +22,8 @@ class SrsFileReader;
 
 /**
  * file writer, to write to file.
+ * @remark The writer tracks the logical offset itself, so query the current position by
+ *      lseek(0, SEEK_CUR) or tellg never flush the libc cache nor issue a syscall.
  */
 class SrsFileWriter : public ISrsWriteSeeker
 {
@@ -29,6 +31,8 @@ private:
     std::string path_;
     FILE *fp_;
     char *buf_;
+    // The logical offset of file, including the bytes cached by libc.
+    off_t offset_;
 public:
     SrsFileWriter();
     virtual ~SrsFileWriter();
@@ -53,6 +57,10 @@ public:
      * @remark user can reopen again.
      */
     virtual void close();
+    /**
+     * flush the bytes cached by libc to file, so that it's visible to other readers.
+     */
+    virtual srs_error_t flush();
 public:
     virtual bool is_open();
     virtual void seek2(int64_t offset);
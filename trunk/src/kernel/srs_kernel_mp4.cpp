@@ -17,6 +17,7 @@
 #include <string.h>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
 using namespace std;
 
 // For CentOS 6 or C++98, @see https://github.com/ossrs/srs/issues/2815
@@ -5009,7 +5010,9 @@ srs_error_t SrsMp4SampleManager::write(SrsMp4MovieFragmentBox* moof, uint64_t dt
         
         if (!previous) {
             previous = sample;
-            entry->sample_flags = 0x02000000;
+            // The chunk of low-latency DASH may start with a non-key frame, which depends on others.
+            bool depends = sample->type == SrsFrameTypeVideo && sample->frame_type != SrsVideoAvcFrameTypeKeyFrame;
+            entry->sample_flags = depends? 0x01000000 : 0x02000000;
         } else {
             entry->sample_flags = 0x01000000;
         }
@@ -5711,6 +5714,294 @@ srs_error_t SrsMp4Decoder::do_load_next_box(SrsMp4Box** ppbox, uint32_t required
     return err;
 }
 
+SrsMp4VodIndex::SrsMp4VodIndex()
+{
+    samples_ = new SrsMp4SampleManager();
+}
+
+SrsMp4VodIndex::~SrsMp4VodIndex()
+{
+    srs_freep(samples_);
+}
+
+srs_error_t SrsMp4VodIndex::initialize(ISrsReadSeeker* rs)
+{
+    srs_error_t err = srs_success;
+
+    SrsMp4BoxReader* br = new SrsMp4BoxReader();
+    SrsAutoFree(SrsMp4BoxReader, br);
+
+    if ((err = br->initialize(rs)) != srs_success) {
+        return srs_error_wrap(err, "init box reader");
+    }
+
+    SrsSimpleStream* stream = new SrsSimpleStream();
+    SrsAutoFree(SrsSimpleStream, stream);
+
+    while (moov_.empty()) {
+        SrsMp4Box* box = NULL;
+        SrsAutoFree(SrsMp4Box, box);
+
+        if ((err = br->read(stream, &box)) != srs_success) {
+            return srs_error_wrap(err, "read box");
+        }
+
+        // Only decode the ftyp and moov, for other boxes such as mdat, skip it.
+        if (box->is_ftyp() || box->is_moov()) {
+            SrsBuffer* buffer = new SrsBuffer(stream->bytes(), stream->length());
+            SrsAutoFree(SrsBuffer, buffer);
+
+            if ((err = box->decode(buffer)) != srs_success) {
+                return srs_error_wrap(err, "decode box");
+            }
+
+            if (box->is_ftyp()) {
+                ftyp_ = string(stream->bytes(), box->sz());
+            } else {
+                SrsMp4MovieBox* moov = dynamic_cast<SrsMp4MovieBox*>(box);
+                if ((err = samples_->load(moov)) != srs_success) {
+                    return srs_error_wrap(err, "load samples");
+                }
+
+                // Strip the sample tables which are rebuilt by trimmed samples, and the edit list which is not
+                // correct any more, then keep the bytes as template of trimmed moov.
+                SrsMp4TrackBox* traks[] = {moov->video(), moov->audio()};
+                for (int i = 0; i < 2; i++) {
+                    SrsMp4TrackBox* trak = traks[i];
+                    if (!trak || !trak->stbl()) {
+                        continue;
+                    }
+
+                    SrsMp4SampleTableBox* stbl = trak->stbl();
+                    stbl->remove(SrsMp4BoxTypeSTTS);
+                    stbl->remove(SrsMp4BoxTypeCTTS);
+                    stbl->remove(SrsMp4BoxTypeSTSS);
+                    stbl->remove(SrsMp4BoxTypeSTSC);
+                    stbl->remove(SrsMp4BoxTypeSTSZ);
+                    stbl->remove(SrsMp4BoxTypeSTCO);
+                    stbl->remove(SrsMp4BoxTypeCO64);
+                    trak->remove(SrsMp4BoxTypeEDTS);
+                }
+
+                int nb_data = moov->nb_bytes();
+                char* data = new char[nb_data];
+                SrsAutoFreeA(char, data);
+
+                SrsBuffer* b = new SrsBuffer(data, nb_data);
+                SrsAutoFree(SrsBuffer, b);
+
+                if ((err = moov->encode(b)) != srs_success) {
+                    return srs_error_wrap(err, "encode moov");
+                }
+                moov_.assign(data, nb_data);
+            }
+        }
+
+        if ((err = br->skip(box, stream)) != srs_success) {
+            return srs_error_wrap(err, "skip box");
+        }
+    }
+
+    if (ftyp_.empty()) {
+        return srs_error_new(ERROR_MP4_BOX_ILLEGAL_SCHEMA, "missing ftyp");
+    }
+
+    // Build the table of samples to seek, the samples is sorted by offset, and the dts is monotonically
+    // increasing in each track, so the keyframes are sorted by time.
+    bool has_video = false;
+    for (int i = 0; i < (int)samples_->samples.size(); i++) {
+        SrsMp4Sample* sample = samples_->samples[i];
+        if (sample->type == SrsFrameTypeVideo) {
+            has_video = true;
+            break;
+        }
+    }
+
+    for (int i = 0; i < (int)samples_->samples.size(); i++) {
+        SrsMp4Sample* sample = samples_->samples[i];
+        if (has_video && (sample->type != SrsFrameTypeVideo || sample->frame_type != SrsVideoAvcFrameTypeKeyFrame)) {
+            continue;
+        }
+
+        key_times_.push_back(sample->dts_ms());
+        key_samples_.push_back(i);
+    }
+
+    return err;
+}
+
+int SrsMp4VodIndex::seek(uint32_t time)
+{
+    if (key_samples_.empty()) {
+        return -1;
+    }
+
+    // Always start from the first sample, even the time is before it.
+    vector<uint32_t>::iterator it = std::upper_bound(key_times_.begin(), key_times_.end(), time);
+    int pos = srs_max(0, (int)(it - key_times_.begin()) - 1);
+
+    return key_samples_[pos];
+}
+
+srs_error_t SrsMp4VodIndex::trim(uint32_t time, std::string& head, int64_t& start, int64_t& end)
+{
+    srs_error_t err = srs_success;
+
+    int index = seek(time);
+    if (index < 0) {
+        return srs_error_new(ERROR_MP4_ILLEGAL_SAMPLES, "no sample to seek %u", time);
+    }
+
+    // Pick the samples since the keyframe, for A/V sync, by the timestamp rather than the offset.
+    uint32_t base = samples_->samples[index]->dts_ms();
+
+    SrsMp4SampleManager* trimmed = new SrsMp4SampleManager();
+    SrsAutoFree(SrsMp4SampleManager, trimmed);
+
+    start = -1;
+    end = -1;
+    vector<int64_t> offsets;
+    uint32_t nb_videos = 0, nb_audios = 0;
+    for (int i = 0; i < (int)samples_->samples.size(); i++) {
+        SrsMp4Sample* sample = samples_->samples[i];
+        if (sample->dts_ms() < base) {
+            continue;
+        }
+
+        SrsMp4Sample* ps = new SrsMp4Sample();
+        ps->type = sample->type;
+        ps->index = (sample->type == SrsFrameTypeVideo)? nb_videos++ : nb_audios++;
+        ps->dts = sample->dts;
+        ps->pts = sample->pts;
+        ps->tbn = sample->tbn;
+        ps->frame_type = sample->frame_type;
+        ps->adjust = sample->adjust;
+        ps->nb_data = sample->nb_data;
+        trimmed->append(ps);
+
+        int64_t offset = (int64_t)sample->offset;
+        offsets.push_back(offset);
+        start = (start == -1)? offset : srs_min(start, offset);
+        end = srs_max(end, offset + (int64_t)sample->nb_data);
+    }
+
+    // The mdat contains the bytes [start, end), maybe there are some bytes not referenced by any sample, which is
+    // the audio before the keyframe, it's ok.
+    SrsMp4MediaDataBox* mdat = new SrsMp4MediaDataBox();
+    SrsAutoFree(SrsMp4MediaDataBox, mdat);
+    mdat->nb_data = end - start;
+
+    // The size of moov depends on the offsets, for example, stco or co64, so we rewrite the offsets until the size
+    // of head is stable, generally in two rounds.
+    string moov;
+    int64_t head_bytes = 0;
+    for (int i = 0; ; i++) {
+        for (int j = 0; j < (int)trimmed->samples.size(); j++) {
+            trimmed->samples[j]->offset = (off_t)(offsets[j] - start + head_bytes);
+        }
+
+        if ((err = write_trimmed_moov(trimmed, moov)) != srs_success) {
+            return srs_error_wrap(err, "write moov");
+        }
+
+        int64_t bytes = (int64_t)(ftyp_.size() + moov.size() + mdat->sz_header());
+        if (bytes == head_bytes) {
+            break;
+        }
+        if (i >= 3) {
+            return srs_error_new(ERROR_MP4_ILLEGAL_MOOV, "moov size unstable, %" PRId64 "!=%" PRId64, bytes, head_bytes);
+        }
+        head_bytes = bytes;
+    }
+
+    head = ftyp_ + moov;
+    if (true) {
+        int nb_data = mdat->sz_header();
+        char* data = new char[nb_data];
+        SrsAutoFreeA(char, data);
+
+        SrsBuffer* buffer = new SrsBuffer(data, nb_data);
+        SrsAutoFree(SrsBuffer, buffer);
+
+        if ((err = mdat->encode(buffer)) != srs_success) {
+            return srs_error_wrap(err, "encode mdat");
+        }
+
+        head.append(data, nb_data);
+    }
+
+    return err;
+}
+
+srs_error_t SrsMp4VodIndex::write_trimmed_moov(SrsMp4SampleManager* trimmed, std::string& moov)
+{
+    srs_error_t err = srs_success;
+
+    // Decode the immutable moov for this request, which has the original durations and no sample tables, then
+    // the sample tables are written by the trimmed samples.
+    SrsMp4MovieBox* box = new SrsMp4MovieBox();
+    SrsAutoFree(SrsMp4MovieBox, box);
+
+    if (true) {
+        SrsBuffer* buffer = new SrsBuffer((char*)moov_.data(), (int)moov_.length());
+        SrsAutoFree(SrsBuffer, buffer);
+
+        if ((err = box->decode(buffer)) != srs_success) {
+            return srs_error_wrap(err, "decode moov");
+        }
+    }
+
+    SrsMp4MovieHeaderBox* mvhd = box->mvhd();
+    if (!mvhd) {
+        return srs_error_new(ERROR_MP4_ILLEGAL_MOOV, "no mvhd");
+    }
+
+    if ((err = trimmed->write(box)) != srs_success) {
+        return srs_error_wrap(err, "write samples");
+    }
+
+    // Update the duration of tracks, the dts of track always starts from 0 in moov.
+    SrsMp4TrackBox* traks[] = {box->video(), box->audio()};
+    mvhd->duration_in_tbn = 0;
+    for (int i = 0; i < 2; i++) {
+        SrsMp4TrackBox* trak = traks[i];
+        if (!trak || !trak->mdhd() || !trak->tkhd()) {
+            continue;
+        }
+
+        SrsFrameType type = (trak == box->video())? SrsFrameTypeVideo : SrsFrameTypeAudio;
+        SrsMp4MediaHeaderBox* mdhd = trak->mdhd();
+        for (int j = 0; j < (int)trimmed->samples.size(); j++) {
+            SrsMp4Sample* sample = trimmed->samples[j];
+            if (sample->type == type) {
+                mdhd->duration -= srs_min(mdhd->duration, sample->dts);
+                break;
+            }
+        }
+
+        SrsMp4TrackHeaderBox* tkhd = trak->tkhd();
+        if (mdhd->timescale) {
+            tkhd->duration = mdhd->duration * mvhd->timescale / mdhd->timescale;
+        }
+        mvhd->duration_in_tbn = srs_max(mvhd->duration_in_tbn, tkhd->duration);
+    }
+
+    int nb_data = box->nb_bytes();
+    char* data = new char[nb_data];
+    SrsAutoFreeA(char, data);
+
+    SrsBuffer* buffer = new SrsBuffer(data, nb_data);
+    SrsAutoFree(SrsBuffer, buffer);
+
+    if ((err = box->encode(buffer)) != srs_success) {
+        return srs_error_wrap(err, "encode moov");
+    }
+
+    moov.assign(data, nb_data);
+
+    return err;
+}
+
 SrsMp4Encoder::SrsMp4Encoder()
 {
     wsio = NULL;
@@ -6474,6 +6765,7 @@ SrsMp4M2tsSegmentEncoder::SrsMp4M2tsSegmentEncoder()
     styp_bytes = 0;
     mdat_bytes = 0;
     track_id = 0;
+    nb_chunks = 0;
 }
 
 SrsMp4M2tsSegmentEncoder::~SrsMp4M2tsSegmentEncoder()
@@ -6549,12 +6841,16 @@ srs_error_t SrsMp4M2tsSegmentEncoder::write_sample(SrsMp4HandlerType ht,
 
 srs_error_t SrsMp4M2tsSegmentEncoder::flush(uint64_t& dts)
 {
-    srs_error_t err = srs_success;
-    
     if (!nb_audios && !nb_videos) {
         return srs_error_new(ERROR_MP4_ILLEGAL_MOOF, "Missing audio and video track");
     }
 
+    // For chunked segment, we never know the duration of segment when writing the first chunk, so there is no sidx,
+    // and we write the remaining samples as the last chunk.
+    if (nb_chunks) {
+        return flush_chunk(dts);
+    }
+
     // Although the sidx is not required to start play DASH, but it's required for AV sync.
     SrsMp4SegmentIndexBox* sidx = new SrsMp4SegmentIndexBox();
     SrsAutoFree(SrsMp4SegmentIndexBox, sidx);
@@ -6577,6 +6873,40 @@ srs_error_t SrsMp4M2tsSegmentEncoder::flush(uint64_t& dts)
         sidx->entries.push_back(entry);
     }
 
+    return write_fragment(dts, sidx);
+}
+
+srs_error_t SrsMp4M2tsSegmentEncoder::flush_chunk(uint64_t dts)
+{
+    srs_error_t err = srs_success;
+
+    if (samples->samples.empty()) {
+        return err;
+    }
+
+    if ((err = write_fragment(dts, NULL)) != srs_success) {
+        return srs_error_wrap(err, "write chunk %d", nb_chunks);
+    }
+
+    // Start a new chunk, whose decode time is the dts of next sample.
+    srs_freep(samples);
+    samples = new SrsMp4SampleManager();
+    mdat_bytes = 0;
+    decode_basetime = dts * SRS_UTIME_MILLISECONDS;
+    nb_chunks++;
+
+    return err;
+}
+
+uint32_t SrsMp4M2tsSegmentEncoder::sequence()
+{
+    return sequence_number;
+}
+
+srs_error_t SrsMp4M2tsSegmentEncoder::write_fragment(uint64_t dts, SrsMp4SegmentIndexBox* sidx)
+{
+    srs_error_t err = srs_success;
+
     // Create a mdat box.
     // its payload will be writen by samples,
     // and we will update its header(size) when flush.
@@ -6591,7 +6921,8 @@ srs_error_t SrsMp4M2tsSegmentEncoder::flush(uint64_t& dts)
         SrsMp4MovieFragmentHeaderBox* mfhd = new SrsMp4MovieFragmentHeaderBox();
         moof->set_mfhd(mfhd);
         
-        mfhd->sequence_number = sequence_number;
+        // The sequence number increases for each moof, that is each chunk.
+        mfhd->sequence_number = sequence_number++;
         
         SrsMp4TrackFragmentBox* traf = new SrsMp4TrackFragmentBox();
         moof->set_traf(traf);
@@ -6621,10 +6952,12 @@ srs_error_t SrsMp4M2tsSegmentEncoder::flush(uint64_t& dts)
         mdat->nb_data = mdat_bytes;
 
         // Update the size of sidx.
-        SrsMp4SegmentIndexEntry* entry = &sidx->entries[0];
-        entry->referenced_size = moof_bytes + mdat->nb_bytes();
-        if ((err = srs_mp4_write_box(writer, sidx)) != srs_success) {
-            return srs_error_wrap(err, "write sidx");
+        if (sidx) {
+            SrsMp4SegmentIndexEntry* entry = &sidx->entries[0];
+            entry->referenced_size = moof_bytes + mdat->nb_bytes();
+            if ((err = srs_mp4_write_box(writer, sidx)) != srs_success) {
+                return srs_error_wrap(err, "write sidx");
+            }
         }
 
         if ((err = srs_mp4_write_box(writer, moof)) != srs_success) {
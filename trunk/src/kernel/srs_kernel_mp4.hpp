@@ -2041,6 +2041,39 @@ private:
     virtual srs_error_t do_load_next_box(SrsMp4Box** ppbox, uint32_t required_box_type);
 };
 
+// The index of MP4 for VOD, parsed from the ftyp and moov, without reading the mdat.
+// We're able to seek by time, and build a trimmed MP4 which starts from a keyframe.
+class SrsMp4VodIndex
+{
+private:
+    // The raw bytes of ftyp, to rebuild the trimmed MP4.
+    std::string ftyp_;
+    // The raw bytes of moov without the sample tables and edit list, which is immutable and decoded for each trim,
+    // so the requests never share a moov, and it's cheap to decode because the large tables are stripped.
+    std::string moov_;
+    // The samples build from moov.
+    SrsMp4SampleManager* samples_;
+    // The time in ms and index in samples of the video keyframes, or all audio samples for pure audio, sorted
+    // by time, to seek by binary search.
+    std::vector<uint32_t> key_times_;
+    std::vector<int> key_samples_;
+public:
+    SrsMp4VodIndex();
+    virtual ~SrsMp4VodIndex();
+public:
+    // Load the index from reader, only the ftyp and moov is read, and mdat is skipped.
+    virtual srs_error_t initialize(ISrsReadSeeker* rs);
+    // Get the index of sample to start from, which is the video keyframe at or before the time in ms.
+    // For pure audio, it's the audio sample at or before the time.
+    // @return The index in samples, -1 if no sample.
+    virtual int seek(uint32_t time);
+    // Build a MP4 which starts from the time in ms, with the samples before the keyframe dropped. The head
+    // is ftyp, the rewritten moov and mdat header, which should be followed by bytes [start, end) of the file.
+    virtual srs_error_t trim(uint32_t time, std::string& head, int64_t& start, int64_t& end);
+private:
+    virtual srs_error_t write_trimmed_moov(SrsMp4SampleManager* trimmed, std::string& moov);
+};
+
 // The MP4 muxer.
 class SrsMp4Encoder
 {
@@ -2140,6 +2173,8 @@ private:
     uint32_t styp_bytes;
     uint64_t mdat_bytes;
     SrsMp4SampleManager* samples;
+    // The number of chunks writen, for low-latency CMAF.
+    int nb_chunks;
 public:
     SrsMp4M2tsSegmentEncoder();
     virtual ~SrsMp4M2tsSegmentEncoder();
@@ -2158,6 +2193,14 @@ public:
         uint32_t dts, uint32_t pts, uint8_t* sample, uint32_t nb_sample);
     // Flush the encoder, to write the moof and mdat.
     virtual srs_error_t flush(uint64_t& dts);
+    // Write the cached samples as a CMAF chunk(moof and mdat), then start a new chunk from dts.
+    // @param dts The dts of next sample in milliseconds, to calculate the duration of last sample.
+    // @remark Once chunk is writen, the segment is in chunked mode, and no sidx is writen.
+    virtual srs_error_t flush_chunk(uint64_t dts);
+    // Get the sequence number of next moof, which increases for each moof.
+    virtual uint32_t sequence();
+private:
+    virtual srs_error_t write_fragment(uint64_t dts, SrsMp4SegmentIndexBox* sidx);
 };
 
 // LCOV_EXCL_START
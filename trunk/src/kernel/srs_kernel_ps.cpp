@@ -14,6 +14,7 @@
 #include <srs_kernel_rtc_rtp.hpp>
 #include <srs_kernel_utility.hpp>
 
+#include <string.h>
 #include <string>
 using namespace std;
 
@@ -496,3 +497,170 @@ srs_error_t SrsPsPsmPacket::decode(SrsBuffer* stream)
     return err;
 }
 
+
+ISrsPsPackDemuxHandler::ISrsPsPackDemuxHandler()
+{
+}
+
+ISrsPsPackDemuxHandler::~ISrsPsPackDemuxHandler()
+{
+}
+
+// Decode the 33bits PTS or DTS in 5 bytes, see Table 2-21 – PES packet, hls-mpeg-ts-iso13818-1.pdf, page 49
+int64_t srs_ps_decode_ts(uint8_t* p)
+{
+    int64_t v = 0;
+    v |= ((int64_t)(p[0] >> 1) & 0x07) << 30;
+    v |= (((int64_t)p[1] << 7) | (p[2] >> 1)) << 15;
+    v |= ((int64_t)p[3] << 7) | (p[4] >> 1);
+    return v;
+}
+
+SrsPsPackDemuxer::SrsPsPackDemuxer()
+{
+    video_stream_type_ = SrsTsStreamReserved;
+    audio_stream_type_ = SrsTsStreamReserved;
+    video_dts_ = video_pts_ = 0;
+    audio_dts_ = audio_pts_ = 0;
+}
+
+SrsPsPackDemuxer::~SrsPsPackDemuxer()
+{
+}
+
+srs_error_t SrsPsPackDemuxer::demux(char* data, int size, ISrsPsPackDemuxHandler* handler)
+{
+    srs_error_t err = srs_success;
+
+    uint8_t* p = (uint8_t*)data;
+    uint8_t* end = p + size;
+
+    // The video frame is joined at the start of pack, because the headers are always larger than the write position.
+    uint8_t* video = p;
+    int64_t video_dts = -1, video_pts = -1;
+
+    while (end - p >= 4) {
+        // Resync to next start code 00 00 01 XX, for the corrupt or unknown bytes.
+        if (p[0] != 0x00 || p[1] != 0x00 || p[2] != 0x01) {
+            p++;
+            continue;
+        }
+
+        uint8_t sid = p[3];
+
+        // Table 2-33 – Program Stream pack header, hls-mpeg-ts-iso13818-1.pdf, page 73
+        if (sid == 0xba) {
+            if (end - p < 14) {
+                return srs_error_new(ERROR_GB_PS_HEADER, "pack header requires 14 only %d bytes", (int)(end - p));
+            }
+            p += 14 + (p[13] & 0x07);
+            continue;
+        }
+
+        // The MPEG_program_end_code is only 4 bytes, without length, see Table 2-31, page 72.
+        if (sid == 0xb9) {
+            p += 4;
+            continue;
+        }
+
+        // The other packets, such as system header, PSM and PES, all have a 2 bytes length.
+        if (end - p < 6) {
+            return srs_error_new(ERROR_GB_PS_HEADER, "packet %#x requires 6 only %d bytes", sid, (int)(end - p));
+        }
+        int length = (p[4] << 8) | p[5];
+        uint8_t* next = p + 6 + length;
+
+        bool is_video = ((sid >> 4) & 0x0f) == SrsTsPESStreamIdVideoChecker;
+        bool is_audio = ((sid >> 5) & 0x07) == SrsTsPESStreamIdAudioChecker;
+
+        // Some devices set the PES_packet_length of video to 0, which is unbounded to the end of pack.
+        if (is_video && !length) {
+            next = end;
+        }
+        if (next > end) {
+            return srs_error_new(ERROR_GB_PS_HEADER, "packet %#x requires %d only %d bytes", sid, length, (int)(end - p - 6));
+        }
+
+        if (sid == SrsTsPESStreamIdProgramStreamMap) {
+            if ((err = on_psm((char*)p + 6, length)) != srs_success) {
+                return srs_error_wrap(err, "psm");
+            }
+            p = next;
+            continue;
+        }
+
+        // Ignore system header, padding and other streams.
+        if (!is_video && !is_audio) {
+            p = next;
+            continue;
+        }
+
+        // Table 2-21 – PES packet, hls-mpeg-ts-iso13818-1.pdf, page 49
+        if (next - p < 9 || next - p < 9 + p[8]) {
+            return srs_error_new(ERROR_GB_PS_HEADER, "PES %#x header requires 9 only %d bytes", sid, (int)(next - p));
+        }
+
+        uint8_t pts_dts_flags = (p[7] >> 6) & 0x03;
+        int64_t pts = is_video ? video_pts_ : audio_pts_;
+        int64_t dts = is_video ? video_dts_ : audio_dts_;
+        if ((pts_dts_flags & 0x02) && p[8] >= 5) {
+            dts = pts = srs_ps_decode_ts(p + 9);
+        }
+        if (pts_dts_flags == 0x03 && p[8] >= 10) {
+            dts = srs_ps_decode_ts(p + 14);
+        }
+
+        uint8_t* payload = p + 9 + p[8];
+        int nn_payload = (int)(next - payload);
+
+        if (is_video) {
+            video_dts_ = dts; video_pts_ = pts;
+            if (video_dts < 0) {
+                video_dts = dts; video_pts = pts;
+            }
+
+            // Join the payload to video frame, note that the payload might overlap with the frame.
+            if (video != payload) {
+                memmove(video, payload, nn_payload);
+            }
+            video += nn_payload;
+        } else {
+            audio_dts_ = dts; audio_pts_ = pts;
+            if (handler && (err = handler->on_ps_audio(audio_stream_type_, dts, pts, (char*)payload, nn_payload)) != srs_success) {
+                return srs_error_wrap(err, "audio");
+            }
+        }
+
+        p = next;
+    }
+
+    int nn_video = (int)(video - (uint8_t*)data);
+    if (handler && nn_video > 0) {
+        if ((err = handler->on_ps_video(video_stream_type_, video_dts, video_pts, data, nn_video)) != srs_success) {
+            return srs_error_wrap(err, "video");
+        }
+    }
+
+    return err;
+}
+
+srs_error_t SrsPsPackDemuxer::on_psm(char* data, int size)
+{
+    srs_error_t err = srs_success;
+
+    SrsBuffer buf(data, size);
+
+    SrsPsPsmPacket psm;
+    if ((err = psm.decode(&buf)) != srs_success) {
+        return srs_error_wrap(err, "decode psm");
+    }
+
+    if (video_stream_type_ == SrsTsStreamReserved && audio_stream_type_ == SrsTsStreamReserved) {
+        srs_trace("PS: Got PSM for video=%#x, audio=%#x", psm.video_stream_type_, psm.audio_stream_type_);
+    }
+    video_stream_type_ = (SrsTsStream)psm.video_stream_type_;
+    audio_stream_type_ = (SrsTsStream)psm.audio_stream_type_;
+
+    return err;
+}
+
@@ -314,5 +314,45 @@ public:
     virtual srs_error_t decode(SrsBuffer* stream);
 };
 
+// The handler for PS pack demuxer, to consume the frames in a PS pack.
+class ISrsPsPackDemuxHandler
+{
+public:
+    ISrsPsPackDemuxHandler();
+    virtual ~ISrsPsPackDemuxHandler();
+public:
+    // When got the video frame of a pack, in annexb, which is joined by all video PES payloads of the pack. The dts
+    // and pts is in 90kHz. Note that the data is only valid in the callback, user should copy it if need to keep.
+    virtual srs_error_t on_ps_video(SrsTsStream vcodec, int64_t dts, int64_t pts, char* data, int size) = 0;
+    // When got an audio PES payload, for example, ADTS frames for AAC.
+    virtual srs_error_t on_ps_audio(SrsTsStream acodec, int64_t dts, int64_t pts, char* data, int size) = 0;
+};
+
+// The PS demuxer for a complete PS pack in a contiguous buffer, for example, the pack joined by RTP packets over UDP.
+// It scans the start codes of pack, system header, PSM and PES, and never creates message objects for PES, because
+// the video PES payloads are joined in place to a frame.
+class SrsPsPackDemuxer
+{
+public:
+    // The stream type parsed from latest PSM packet.
+    SrsTsStream video_stream_type_;
+    SrsTsStream audio_stream_type_;
+private:
+    // The last timestamp, for PES without PTS or DTS.
+    int64_t video_dts_;
+    int64_t video_pts_;
+    int64_t audio_dts_;
+    int64_t audio_pts_;
+public:
+    SrsPsPackDemuxer();
+    virtual ~SrsPsPackDemuxer();
+public:
+    // Demux a PS pack, which should start with a pack header. Note that the data is modified in place, because the
+    // payloads of video PES packets are moved to join the video frame.
+    virtual srs_error_t demux(char* data, int size, ISrsPsPackDemuxHandler* handler);
+private:
+    srs_error_t on_psm(char* data, int size);
+};
+
 #endif
 
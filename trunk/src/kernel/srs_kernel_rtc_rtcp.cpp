@@ -714,6 +714,7 @@ void SrsRtcpTWCC::clear()
     pkt_deltas_.clear();
     recv_packets_.clear();
     recv_sns_.clear();
+    recv_status_.clear();
     next_base_sn_ = 0;
 }
 
@@ -746,6 +747,11 @@ vector<uint16_t> SrsRtcpTWCC::get_recv_deltas() const
     return pkt_deltas_;
 }
 
+const vector<SrsRtcpTWCCStatus>& SrsRtcpTWCC::get_recv_status() const
+{
+    return recv_status_;
+}
+
 void SrsRtcpTWCC::set_media_ssrc(uint32_t ssrc)
 {
     media_ssrc_ = ssrc;
@@ -834,6 +840,96 @@ srs_error_t SrsRtcpTWCC::decode(SrsBuffer *buffer)
     payload_len_ = (header_.length + 1) * 4 - sizeof(SrsRtcpHeader) - 4;
     buffer->read_bytes((char *)payload_, payload_len_);
 
+    SrsBuffer payload((char*)payload_, payload_len_);
+    if ((err = decode_status(&payload)) != srs_success) {
+        return srs_error_wrap(err, "decode status");
+    }
+
+    return err;
+}
+
+srs_error_t SrsRtcpTWCC::decode_status(SrsBuffer* buffer)
+{
+    srs_error_t err = srs_success;
+
+    encoded_chucks_.clear();
+    pkt_deltas_.clear();
+    recv_status_.clear();
+
+    if (!buffer->require(12)) {
+        return srs_error_new(ERROR_RTC_RTCP, "requires 12 only %d bytes", buffer->left());
+    }
+
+    media_ssrc_ = buffer->read_4bytes();
+    base_sn_ = buffer->read_2bytes();
+    uint16_t status_count = buffer->read_2bytes();
+    reference_time_ = buffer->read_3bytes();
+    fb_pkt_count_ = buffer->read_1bytes();
+
+    // Decode the packet chunks, to the symbols of status, which is the size of recv delta.
+    vector<uint8_t> symbols;
+    while (symbols.size() < status_count) {
+        if (!buffer->require(kTwccFbChunkBytes)) {
+            return srs_error_new(ERROR_RTC_RTCP, "requires chunk for %d/%d status", (int)symbols.size(), status_count);
+        }
+
+        uint16_t chunk = buffer->read_2bytes();
+        encoded_chucks_.push_back(chunk);
+
+        if ((chunk & 0x8000) == 0) {
+            // Run length chunk, T=0, S(2bits), Run Length(13bits).
+            uint8_t symbol = (chunk >> 13) & 0x03;
+            int run_length = chunk & kTwccFbMaxRunLength;
+            for (int i = 0; i < run_length && symbols.size() < status_count; i++) {
+                symbols.push_back(symbol);
+            }
+        } else if ((chunk & 0x4000) == 0) {
+            // Status vector chunk, T=1, S=0, with 14 one-bit symbols.
+            for (int i = kTwccFbOneBitElements - 1; i >= 0 && symbols.size() < status_count; i--) {
+                symbols.push_back((chunk >> i) & 0x01);
+            }
+        } else {
+            // Status vector chunk, T=1, S=1, with 7 two-bit symbols.
+            for (int i = kTwccFbTwoBitElements - 1; i >= 0 && symbols.size() < status_count; i--) {
+                symbols.push_back((chunk >> (2 * i)) & 0x03);
+            }
+        }
+    }
+
+    // Decode the recv deltas, which is relative to the reference time, or the previous received packet.
+    srs_utime_t recv_time = (srs_utime_t)reference_time_ * kTwccFbTimeMultiplier;
+    for (int i = 0; i < (int)symbols.size(); i++) {
+        SrsRtcpTWCCStatus status;
+        status.sn = base_sn_ + i;
+        status.received = false;
+        status.recv_time = 0;
+
+        uint8_t symbol = symbols.at(i);
+        if (symbol == 1) {
+            if (!buffer->require(1)) {
+                return srs_error_new(ERROR_RTC_RTCP, "requires small delta for sn=%u", status.sn);
+            }
+            uint8_t delta = buffer->read_1bytes();
+            pkt_deltas_.push_back(delta);
+            recv_time += delta * kTwccFbDeltaUnit;
+        } else if (symbol == 2) {
+            if (!buffer->require(kTwccFbLargeRecvDeltaBytes)) {
+                return srs_error_new(ERROR_RTC_RTCP, "requires large delta for sn=%u", status.sn);
+            }
+            int16_t delta = (int16_t)buffer->read_2bytes();
+            pkt_deltas_.push_back((uint16_t)delta);
+            recv_time += delta * kTwccFbDeltaUnit;
+        } else if (symbol == 3) {
+            return srs_error_new(ERROR_RTC_RTCP, "invalid symbol for sn=%u", status.sn);
+        }
+
+        if (symbol) {
+            status.received = true;
+            status.recv_time = recv_time;
+        }
+        recv_status_.push_back(status);
+    }
+
     return err;
 }
 
@@ -1224,8 +1320,18 @@ uint32_t SrsRtcpNack::get_media_ssrc() const
 
 vector<uint16_t> SrsRtcpNack::get_lost_sns() const
 {
+    set<uint16_t, SrsSeqCompareLess> sns = lost_sns_;
+    for (vector<SrsPidBlp>::const_iterator it = chunks_.begin(); it != chunks_.end(); ++it) {
+        sns.insert(it->pid);
+        for (int j = 0; j < 16; j++) {
+            if (it->blp & (1 << j)) {
+                sns.insert(it->pid + j + 1);
+            }
+        }
+    }
+
     vector<uint16_t> sn;
-    for(set<uint16_t, SrsSeqCompareLess>::iterator it = lost_sns_.begin(); it != lost_sns_.end(); ++it) {
+    for(set<uint16_t, SrsSeqCompareLess>::iterator it = sns.begin(); it != sns.end(); ++it) {
         sn.push_back(*it);
     }
     return sn;
@@ -1233,7 +1339,7 @@ vector<uint16_t> SrsRtcpNack::get_lost_sns() const
 
 bool SrsRtcpNack::empty()
 {
-    return lost_sns_.empty();
+    return lost_sns_.empty() && chunks_.empty();
 }
 
 void SrsRtcpNack::set_media_ssrc(uint32_t ssrc)
@@ -1246,6 +1352,15 @@ void SrsRtcpNack::add_lost_sn(uint16_t sn)
     lost_sns_.insert(sn);
 }
 
+void SrsRtcpNack::add_lost_pid_blp(uint16_t pid, uint16_t blp)
+{
+    SrsPidBlp chunk;
+    chunk.pid = pid;
+    chunk.blp = blp;
+    chunk.in_use = true;
+    chunks_.push_back(chunk);
+}
+
 srs_error_t SrsRtcpNack::decode(SrsBuffer *buffer)
 {
     /*
@@ -1360,6 +1475,7 @@ srs_error_t SrsRtcpNack::encode(SrsBuffer *buffer)
         if(chunk.in_use) {
             chunks.push_back(chunk);
         }
+        chunks.insert(chunks.end(), chunks_.begin(), chunks_.end());
 
         header_.length = 2 + chunks.size();
         if(srs_success != (err = encode_header(buffer))) {
@@ -1660,6 +1776,142 @@ srs_error_t SrsRtcpRpsi::encode(SrsBuffer *buffer)
     return err;
 }
 
+SrsRtcpRemb::SrsRtcpRemb(uint32_t sender_ssrc/* = 0*/)
+{
+    is_remb_ = false;
+    bitrate_ = 0;
+
+    header_.padding = 0;
+    header_.type = SrsRtcpType_psfb;
+    header_.rc = kAFB;
+    header_.version = kRtcpVersion;
+    ssrc_ = sender_ssrc;
+}
+
+SrsRtcpRemb::~SrsRtcpRemb()
+{
+}
+
+bool SrsRtcpRemb::is_remb()
+{
+    return is_remb_;
+}
+
+uint64_t SrsRtcpRemb::get_bitrate() const
+{
+    return bitrate_;
+}
+
+const vector<uint32_t>& SrsRtcpRemb::get_ssrcs() const
+{
+    return ssrcs_;
+}
+
+void SrsRtcpRemb::set_bitrate(uint64_t bitrate)
+{
+    is_remb_ = true;
+    bitrate_ = bitrate;
+}
+
+void SrsRtcpRemb::add_ssrc(uint32_t ssrc)
+{
+    ssrcs_.push_back(ssrc);
+}
+
+srs_error_t SrsRtcpRemb::decode(SrsBuffer *buffer)
+{
+    /*
+    @doc: https://datatracker.ietf.org/doc/html/draft-alvestrand-rmcat-remb-03#section-2.2
+        0                   1                   2                   3
+    0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |V=2|P| FMT=15  |   PT=206      |             length            |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |                  SSRC of packet sender                        |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |                  SSRC of media source                         |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |  Unique identifier 'R' 'E' 'M' 'B'                            |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |  Num SSRC     | BR Exp    |  BR Mantissa                      |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |   SSRC feedback                                               |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |  ...                                                          |
+    */
+    srs_error_t err = srs_success;
+    data_ = buffer->head();
+    nb_data_ = buffer->left();
+
+    if(srs_success != (err = decode_header(buffer))) {
+        return srs_error_wrap(err, "decode header");
+    }
+
+    media_ssrc_ = buffer->read_4bytes();
+    int len = (header_.length + 1) * 4 - 12;
+    if (!buffer->require(len)) {
+        return srs_error_new(ERROR_RTC_RTCP, "requires %d only %d bytes", len, buffer->left());
+    }
+
+    // Ignore the other AFB packets, which is not REMB.
+    SrsBuffer fci(buffer->head(), len);
+    buffer->skip(len);
+    if (!fci.require(8) || fci.read_4bytes() != 0x52454d42) {
+        return err;
+    }
+
+    uint8_t nn_ssrcs = fci.read_1bytes();
+    uint32_t v = fci.read_3bytes();
+    uint8_t exp = (v >> 18) & 0x3f;
+    uint32_t mantissa = v & 0x3ffff;
+
+    is_remb_ = true;
+    bitrate_ = ((uint64_t)mantissa) << exp;
+
+    ssrcs_.clear();
+    for (int i = 0; i < nn_ssrcs && fci.require(4); i++) {
+        ssrcs_.push_back(fci.read_4bytes());
+    }
+
+    return err;
+}
+
+uint64_t SrsRtcpRemb::nb_bytes()
+{
+    return 12 + 8 + 4 * ssrcs_.size();
+}
+
+srs_error_t SrsRtcpRemb::encode(SrsBuffer *buffer)
+{
+    srs_error_t err = srs_success;
+    if(!buffer->require(nb_bytes())) {
+        return srs_error_new(ERROR_RTC_RTCP, "requires %d bytes", nb_bytes());
+    }
+
+    // The mantissa is 18 bits, so we shift the bitrate until it fits.
+    uint8_t exp = 0;
+    uint64_t mantissa = bitrate_;
+    while (mantissa > 0x3ffff) {
+        mantissa >>= 1;
+        exp++;
+    }
+
+    header_.length = (uint16_t)(nb_bytes() / 4 - 1);
+    if(srs_success != (err = encode_header(buffer))) {
+        return srs_error_wrap(err, "encode header");
+    }
+
+    buffer->write_4bytes(media_ssrc_);
+    buffer->write_4bytes(0x52454d42);
+    buffer->write_1bytes((uint8_t)ssrcs_.size());
+    buffer->write_3bytes((exp << 18) | (uint32_t)mantissa);
+    for (int i = 0; i < (int)ssrcs_.size(); i++) {
+        buffer->write_4bytes(ssrcs_.at(i));
+    }
+
+    return err;
+}
+
 SrsRtcpXr::SrsRtcpXr(uint32_t ssrc/*= 0*/)
 {
     header_.padding = 0;
@@ -1773,6 +2025,9 @@ srs_error_t SrsRtcpCompound::decode(SrsBuffer *buffer)
             } else if(3 == header->rc) {
                 //rpsi
                 rtcp = new SrsRtcpRpsi();
+            } else if(15 == header->rc) {
+                //afb, for example, remb
+                rtcp = new SrsRtcpRemb();
             } else {
                 // common psfb
                 rtcp = new SrsRtcpPsfbCommon();
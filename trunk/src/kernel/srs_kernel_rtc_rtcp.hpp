@@ -247,6 +247,17 @@ public:
 #define kTwccFbLargeRecvDeltaBytes	2
 #define kTwccFbMaxBitElements 		kTwccFbOneBitElements
 
+// The status of packet in TWCC feedback, decoded from the packet chunks and recv deltas.
+struct SrsRtcpTWCCStatus
+{
+    // The transport-wide sequence number.
+    uint16_t sn;
+    // Whether the packet is received by peer.
+    bool received;
+    // The received time in srs_utime_t, base on the reference time, only valid when received.
+    srs_utime_t recv_time;
+};
+
 class SrsRtcpTWCC : public SrsRtcpCommon
 {
 private:
@@ -259,6 +270,8 @@ private:
 
     std::map<uint16_t, srs_utime_t> recv_packets_;
     std::set<uint16_t, SrsSeqCompareLess> recv_sns_;
+    // The status of packets, decoded from the feedback.
+    std::vector<SrsRtcpTWCCStatus> recv_status_;
 
     struct SrsRtcpTWCCChunk {
         uint8_t delta_sizes[kTwccFbMaxBitElements];
@@ -272,6 +285,7 @@ private:
     uint16_t next_base_sn_;
 private:
     void clear();
+    srs_error_t decode_status(SrsBuffer* buffer);
     srs_utime_t calculate_delta_us(srs_utime_t ts, srs_utime_t last);
     srs_error_t process_pkt_chunk(SrsRtcpTWCCChunk& chunk, int delta_size);
     bool can_add_to_chunk(SrsRtcpTWCCChunk& chunk, int delta_size);
@@ -292,6 +306,8 @@ public:
     uint8_t get_feedback_count() const;
     std::vector<uint16_t> get_packet_chucks() const;
     std::vector<uint16_t> get_recv_deltas() const;
+    // Get the status of packets, only available for decoded feedback.
+    const std::vector<SrsRtcpTWCCStatus>& get_recv_status() const;
 
     void set_media_ssrc(uint32_t ssrc);
     void set_base_sn(uint16_t sn);
@@ -323,6 +339,8 @@ private:
 
     uint32_t media_ssrc_;
     std::set<uint16_t, SrsSeqCompareLess> lost_sns_;
+    // The PID/BLP pairs added directly, for example, generated from the loss bitmap.
+    std::vector<SrsPidBlp> chunks_;
 public:
     SrsRtcpNack(uint32_t sender_ssrc = 0);
     virtual ~SrsRtcpNack();
@@ -333,6 +351,8 @@ public:
 
     void set_media_ssrc(uint32_t ssrc);
     void add_lost_sn(uint16_t sn);
+    // Add the lost seqs by PID/BLP pair, the BLP is the bitmap of the following 16 seqs after PID.
+    void add_lost_pid_blp(uint16_t pid, uint16_t blp);
 // interface ISrsCodec
 public:
     virtual srs_error_t decode(SrsBuffer *buffer);
@@ -407,6 +427,32 @@ public:
     virtual srs_error_t encode(SrsBuffer *buffer);   
 };
 
+// The Receiver Estimated Max Bitrate, which is an AFB(Application Layer Feedback) of PSFB.
+// @see https://datatracker.ietf.org/doc/html/draft-alvestrand-rmcat-remb-03#section-2.2
+class SrsRtcpRemb : public SrsRtcpPsfbCommon
+{
+private:
+    bool is_remb_;
+    // The bitrate in bps.
+    uint64_t bitrate_;
+    std::vector<uint32_t> ssrcs_;
+public:
+    SrsRtcpRemb(uint32_t sender_ssrc = 0);
+    virtual ~SrsRtcpRemb();
+public:
+    // Whether the AFB is REMB, by the unique identifier.
+    bool is_remb();
+    uint64_t get_bitrate() const;
+    const std::vector<uint32_t>& get_ssrcs() const;
+    void set_bitrate(uint64_t bitrate);
+    void add_ssrc(uint32_t ssrc);
+// interface ISrsCodec
+public:
+    virtual srs_error_t decode(SrsBuffer *buffer);
+    virtual uint64_t nb_bytes();
+    virtual srs_error_t encode(SrsBuffer *buffer);
+};
+
 class SrsRtcpXr : public SrsRtcpCommon
 {
 public:
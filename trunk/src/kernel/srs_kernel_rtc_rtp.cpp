@@ -62,64 +62,85 @@ uint8_t srs_rtp_fast_parse_pt(char* buf, int size)
     }
     return buf[1] & 0x7f;
 }
-srs_error_t srs_rtp_fast_parse_twcc(char* buf, int size, uint8_t twcc_id, uint16_t& twcc_sn)
+srs_error_t srs_rtp_fast_find_extension(char* buf, int size, uint8_t id, char** pvalue, int* pnb_value)
 {
-    srs_error_t err = srs_success;
-
-    int need_size = 12 /*rtp head fix len*/ + 4 /* extension header len*/ + 3 /* twcc extension len*/;
-    if(size < (need_size)) {
-        return srs_error_new(ERROR_RTC_RTP_MUXER, "required %d bytes, actual %d", need_size, size);
-    }
-
-    uint8_t first = buf[0];
-    bool extension = (first & 0x10);
-    uint8_t cc = (first & 0x0F);
-
-    if(!extension) {
-        return srs_error_new(ERROR_RTC_RTP, "no extension in rtp");
+    int need_size = 12 /*rtp head fix len*/ + 4 /* extension header len*/;
+    if (size < need_size || !(buf[0] & 0x10)) {
+        return srs_error_new(ERROR_RTC_RTP, "no extension in rtp, size=%d", size);
     }
 
+    int cc = (buf[0] & 0x0F);
     need_size += cc * 4; // csrc size
-    if(size < (need_size)) {
+    if (size < need_size) {
         return srs_error_new(ERROR_RTC_RTP_MUXER, "required %d bytes, actual %d", need_size, size);
     }
-    buf += 12 + 4*cc;
 
-    uint16_t value = *((uint16_t*)buf);
-    value = ntohs(value);
-    if(0xBEDE != value) {
-        return srs_error_new(ERROR_RTC_RTP_MUXER, "no support this type(0x%02x) extension", value);
+    uint8_t* p = (uint8_t*)buf + 12 + 4 * cc;
+    if (p[0] != 0xBE || p[1] != 0xDE) {
+        return srs_error_new(ERROR_RTC_RTP_MUXER, "no support this type(0x%02x%02x) extension", p[0], p[1]);
     }
-    buf += 2;
-    
-    uint16_t extension_length = ntohs(*((uint16_t*)buf));
-    buf += 2;
-    extension_length *= 4;
+
+    int extension_length = 4 * (p[2] << 8 | p[3]);
+    p += 4;
     need_size += extension_length; // entension size
-    if(size < (need_size)) {
+    if (size < need_size) {
         return srs_error_new(ERROR_RTC_RTP_MUXER, "required %d bytes, actual %d", need_size, size);
     }
 
-    while(extension_length > 0) {
-        uint8_t v = buf[0];
-        buf++;
-        extension_length--;
-        if(0 == v) {
+    // The one-byte header extensions, see https://www.rfc-editor.org/rfc/rfc8285#section-4.2
+    uint8_t* end = p + extension_length;
+    while (p < end) {
+        uint8_t v = *p++;
+        if (!v) {
             continue;
         }
 
-        uint8_t id = (v & 0xF0) >>4;
+        uint8_t ext_id = (v & 0xF0) >> 4;
         uint8_t len = (v & 0x0F) + 1;
+        if (p + len > end) {
+            return srs_error_new(ERROR_RTC_RTP_MUXER, "invalid extension id=%u, len=%u", ext_id, len);
+        }
 
-        if(id == twcc_id) {
-            twcc_sn = ntohs(*((uint16_t*)buf));
-            return err;
-        } else {
-            buf += len;
-            extension_length -= len;
+        if (ext_id == id) {
+            *pvalue = (char*)p;
+            *pnb_value = len;
+            return srs_success;
         }
+
+        p += len;
+    }
+
+    return srs_error_new(ERROR_RTC_RTP, "no extension id=%u", id);
+}
+
+srs_error_t srs_rtp_fast_parse_twcc(char* buf, int size, uint8_t twcc_id, uint16_t& twcc_sn)
+{
+    srs_error_t err = srs_success;
+
+    char* p = NULL; int nb_p = 0;
+    if ((err = srs_rtp_fast_find_extension(buf, size, twcc_id, &p, &nb_p)) != srs_success) {
+        return srs_error_wrap(err, "find twcc");
+    }
+
+    if (nb_p != 2) {
+        return srs_error_new(ERROR_RTC_RTP_MUXER, "invalid twcc len=%d", nb_p);
+    }
+
+    twcc_sn = (uint16_t)((uint8_t)p[0] << 8 | (uint8_t)p[1]);
+
+    return err;
+}
+
+srs_error_t srs_rtp_fast_parse_rid(char* buf, int size, uint8_t rid_id, std::string& rid)
+{
+    srs_error_t err = srs_success;
+
+    char* p = NULL; int nb_p = 0;
+    if ((err = srs_rtp_fast_find_extension(buf, size, rid_id, &p, &nb_p)) != srs_success) {
+        return srs_error_wrap(err, "find rid");
     }
 
+    rid.assign(p, nb_p);
 
     return err;
 }
@@ -146,7 +167,8 @@ int32_t srs_seq_distance(uint16_t value, uint16_t pre_value)
 
 SrsRtpExtensionTypes::SrsRtpExtensionTypes()
 {
-    memset(ids_, kRtpExtensionNone, sizeof(ids_));
+    memset(ids_, kInvalidId, sizeof(ids_));
+    memset(types_, kRtpExtensionNone, sizeof(types_));
 }
 
 SrsRtpExtensionTypes::~SrsRtpExtensionTypes()
@@ -169,18 +191,24 @@ bool SrsRtpExtensionTypes::register_id(int id, SrsRtpExtensionType type, std::st
         return false;
     }
 
+    // Unregister the previous id of this type.
+    if (ids_[type] > 0 && ids_[type] < 16) {
+        types_[ids_[type]] = kRtpExtensionNone;
+    }
+
     ids_[type] = static_cast<uint8_t>(id);
+    if (id < 16) {
+        types_[id] = static_cast<uint8_t>(type);
+    }
     return true;
 }
 
-SrsRtpExtensionType SrsRtpExtensionTypes::get_type(int id) const
+int SrsRtpExtensionTypes::get_id(SrsRtpExtensionType type) const
 {
-    for (int type = kRtpExtensionNone + 1; type < kRtpExtensionNumberOfExtensions; ++type) {
-        if (ids_[type] == id) {
-            return static_cast<SrsRtpExtensionType>(type);
-        }
+    if (type <= kRtpExtensionNone || type >= kRtpExtensionNumberOfExtensions) {
+        return kInvalidId;
     }
-    return kInvalidType;
+    return ids_[type];
 }
 
 SrsRtpExtensionTwcc::SrsRtpExtensionTwcc()
@@ -330,6 +358,8 @@ SrsRtpExtensions::SrsRtpExtensions()
     types_ = NULL;
     has_ext_ = false;
     decode_twcc_extension_ = false;
+    has_decoded_audio_level_ = false;
+    decoded_audio_level_ = 0;
 }
 
 SrsRtpExtensions::~SrsRtpExtensions()
@@ -372,16 +402,21 @@ srs_error_t SrsRtpExtensions::decode_0xbede(SrsBuffer* buf)
 {
     srs_error_t err = srs_success;
 
-    while (!buf->empty()) {
+    // Without extension types, there is nothing to decode.
+    if (!types_) {
+        buf->skip(buf->left());
+        return err;
+    }
+
+    // We only pull the extensions in the layout of stream, and skip others by length.
+    uint8_t* p = (uint8_t*)buf->head();
+    uint8_t* end = p + buf->left();
+    while (p < end) {
         // The first byte maybe padding or id+len.
-        if (!buf->require(1)) {
-            return srs_error_new(ERROR_RTC_RTP_MUXER, "requires %d bytes", 1);
-        }
-        uint8_t v = *((uint8_t*)buf->head());
+        uint8_t v = *p++;
 
         // Padding, ignore
         if(v == 0) {
-            buf->skip(1);
             continue;
         }
 
@@ -395,29 +430,44 @@ srs_error_t SrsRtpExtensions::decode_0xbede(SrsBuffer* buf)
         uint8_t id = (v & 0xF0) >> 4;
         uint8_t len = (v & 0x0F) + 1;
 
-        SrsRtpExtensionType xtype = types_? types_->get_type(id) : kRtpExtensionNone;
-        if (xtype == kRtpExtensionTransportSequenceNumber) {
-            if (decode_twcc_extension_) {
-                if ((err = twcc_.decode(buf)) != srs_success) {
-                    return srs_error_wrap(err, "decode twcc extension");
+        // Ignore the truncated extension, as there is no more element.
+        if (p + len > end) {
+            break;
+        }
+
+        switch (types_->get_type(id)) {
+            case kRtpExtensionTransportSequenceNumber:
+                if (!decode_twcc_extension_) {
+                    break;
                 }
+                //   0                   1                   2
+                //   0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3
+                //  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+                //  |  ID   | L=1   |transport wide sequence number |
+                //  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+                if (len != 2) {
+                    return srs_error_new(ERROR_RTC_RTP, "invalid twcc id=%d, len=%d", id, len - 1);
+                }
+                twcc_.set_id(id);
+                twcc_.set_sn(uint16_t(p[0]) << 8 | p[1]);
                 has_ext_ = true;
-            } else {
-                if (!buf->require(len+1)) {
-                    return srs_error_new(ERROR_RTC_RTP_MUXER, "requires %d bytes", len+1);
+                break;
+            case kRtpExtensionAudioLevel:
+                if (len != 1) {
+                    return srs_error_new(ERROR_RTC_RTP, "invalid rtp extension id=%d, len=%d", id, len - 1);
                 }
-                buf->skip(len + 1);
-            }
-        } else if (xtype == kRtpExtensionAudioLevel) {
-            if((err = audio_level_.decode(buf)) != srs_success) {
-                return srs_error_wrap(err, "decode audio level extension");
-            }
-            has_ext_ = true;
-        } else {
-            buf->skip(1 + len);
+                decoded_audio_level_ = p[0];
+                has_decoded_audio_level_ = true;
+                break;
+            default:
+                break;
         }
+
+        p += len;
     }
 
+    buf->skip(buf->left());
+
     return err;
 }
 
@@ -506,6 +556,10 @@ srs_error_t SrsRtpExtensions::get_audio_level(uint8_t& level)
         level = audio_level_.get_value();
         return srs_success;
     }
+    if (has_decoded_audio_level_) {
+        level = decoded_audio_level_;
+        return srs_success;
+    }
     return srs_error_new(ERROR_RTC_RTP_MUXER, "not find rtp extension audio level");
 }
 
@@ -757,6 +811,9 @@ SrsRtpPacket::SrsRtpPacket()
     payload_type_ = SrsRtspPacketPayloadTypeUnknown;
     shared_buffer_ = NULL;
     actual_buffer_size_ = 0;
+    wire_payload_ = NULL;
+    nn_wire_payload_ = 0;
+    wire_ = NULL;
 
     nalu_type = SrsAvcNaluTypeReserved;
     frame_type = SrsFrameTypeReserved;
@@ -771,6 +828,7 @@ SrsRtpPacket::~SrsRtpPacket()
 {
     srs_freep(payload_);
     srs_freep(shared_buffer_);
+    srs_freep(wire_);
 }
 
 char* SrsRtpPacket::wrap(int size)
@@ -778,6 +836,11 @@ char* SrsRtpPacket::wrap(int size)
     // The buffer size is larger or equals to the size of packet.
     actual_buffer_size_ = size;
 
+    // The buffer will be overwrote, so the wire bytes is invalid.
+    wire_payload_ = NULL;
+    nn_wire_payload_ = 0;
+    srs_freep(wire_);
+
     // If the buffer is large enough, reuse it.
     if (shared_buffer_ && shared_buffer_->size >= size) {
         return shared_buffer_->payload;
@@ -811,6 +874,10 @@ char* SrsRtpPacket::wrap(SrsSharedPtrMessage* msg)
     // is not generated by RTC.
     srs_freep(shared_buffer_);
 
+    wire_payload_ = NULL;
+    nn_wire_payload_ = 0;
+    srs_freep(wire_);
+
     // Copy from the new message.
     shared_buffer_ = msg->copy();
     // If we wrap a message, the size of packet equals to the message size.
@@ -830,6 +897,9 @@ SrsRtpPacket* SrsRtpPacket::copy()
     cp->nalu_type = nalu_type;
     cp->shared_buffer_ = shared_buffer_? shared_buffer_->copy2() : NULL;
     cp->actual_buffer_size_ = actual_buffer_size_;
+    cp->wire_ = wire_? wire_->copy2() : NULL;
+    cp->wire_payload_ = wire_payload_;
+    cp->nn_wire_payload_ = nn_wire_payload_;
     cp->frame_type = frame_type;
 
     cp->cached_payload_size = cached_payload_size;
@@ -841,6 +911,46 @@ SrsRtpPacket* SrsRtpPacket::copy()
     return cp;
 }
 
+void SrsRtpPacket::set_payload(ISrsRtpPayloader* p, SrsRtspPacketPayloadType pt)
+{
+    payload_ = p;
+    payload_type_ = pt;
+
+    // The payload is changed, so the wire bytes is invalid.
+    wire_payload_ = NULL;
+    nn_wire_payload_ = 0;
+    srs_freep(wire_);
+}
+
+srs_error_t SrsRtpPacket::cache_payload()
+{
+    srs_error_t err = srs_success;
+
+    if (wire_payload_ || !payload_) {
+        return err;
+    }
+
+    int size = (int)payload_->nb_bytes();
+    if (size <= 0) {
+        return err;
+    }
+
+    char* buf = new char[size];
+    SrsBuffer b(buf, size);
+    if ((err = payload_->encode(&b)) != srs_success) {
+        srs_freepa(buf);
+        return srs_error_wrap(err, "encode payload");
+    }
+
+    wire_ = new SrsSharedPtrMessage();
+    wire_->wrap(buf, size);
+
+    wire_payload_ = wire_->payload;
+    nn_wire_payload_ = size;
+
+    return err;
+}
+
 void SrsRtpPacket::set_padding(int size)
 {
     header.set_padding(size);
@@ -889,7 +999,13 @@ srs_error_t SrsRtpPacket::encode(SrsBuffer* buf)
         return srs_error_wrap(err, "rtp header");
     }
 
-    if (payload_ && (err = payload_->encode(buf)) != srs_success) {
+    // Copy the wire bytes of payload, or encode the payload objects.
+    if (wire_payload_) {
+        if (!buf->require(nn_wire_payload_)) {
+            return srs_error_new(ERROR_RTC_RTP_MUXER, "requires %d bytes", nn_wire_payload_);
+        }
+        buf->write_bytes(wire_payload_, nn_wire_payload_);
+    } else if (payload_ && (err = payload_->encode(buf)) != srs_success) {
         return srs_error_wrap(err, "rtp payload");
     }
 
@@ -932,10 +1048,20 @@ srs_error_t SrsRtpPacket::decode(SrsBuffer* buf)
         payload_type_ = SrsRtspPacketPayloadTypeRaw;
     }
 
+    // The payload bytes, before decoding.
+    char* p = buf->head();
+    int nn_payload = buf->left();
+
     if ((err = payload_->decode(buf)) != srs_success) {
         return srs_error_wrap(err, "rtp payload");
     }
 
+    // If decode from the shared buffer, keep the payload bytes as wire bytes.
+    if (shared_buffer_ && p >= shared_buffer_->payload && p + nn_payload <= shared_buffer_->payload + actual_buffer_size_) {
+        wire_payload_ = p;
+        nn_wire_payload_ = nn_payload;
+    }
+
     return err;
 }
 
@@ -47,7 +47,11 @@ class SrsRtpExtensionTypes;
 // Fast parse the SSRC from RTP packet. Return 0 if invalid.
 uint32_t srs_rtp_fast_parse_ssrc(char* buf, int size);
 uint8_t srs_rtp_fast_parse_pt(char* buf, int size);
+// Fast find the one-byte header extension by id from RTP packet, the value points to the buf.
+srs_error_t srs_rtp_fast_find_extension(char* buf, int size, uint8_t id, char** pvalue, int* pnb_value);
 srs_error_t srs_rtp_fast_parse_twcc(char* buf, int size, uint8_t twcc_id, uint16_t& twcc_sn);
+// Fast parse the RID of simulcast layer from RTP packet, see https://www.rfc-editor.org/rfc/rfc8852
+srs_error_t srs_rtp_fast_parse_rid(char* buf, int size, uint8_t rid_id, std::string& rid);
 
 // The "distance" between two uint16 number, for example:
 //      distance(prev_value=3, value=5) is (int16_t)(uint16_t)((uint16_t)3-(uint16_t)5) is -2
@@ -98,6 +102,7 @@ const SrsExtensionInfo kExtensions[] = {
     {kRtpExtensionAudioLevel, kAudioLevelUri},
 };
 
+// The extension layout of track, built once when SDP negotiated, to find the type of extension by id fastly.
 class SrsRtpExtensionTypes
 {
 public:
@@ -105,7 +110,12 @@ public:
     static const int kInvalidId = 0;
 public:
     bool register_by_uri(int id, std::string uri);
-    SrsRtpExtensionType get_type(int id) const;
+    // Get the type of one-byte extension id, by the layout table without any loop.
+    inline SrsRtpExtensionType get_type(int id) const { // SrsRtpExtensionTypes::get_type
+        return (id > 0 && id < 16)? (SrsRtpExtensionType)types_[id] : kInvalidType;
+    }
+    // Get the id of extension type, or kInvalidId if not registered.
+    int get_id(SrsRtpExtensionType type) const;
 public:
     SrsRtpExtensionTypes();
     virtual ~SrsRtpExtensionTypes();
@@ -113,6 +123,8 @@ private:
     bool register_id(int id, SrsRtpExtensionType type, std::string uri);
 private:
     uint8_t ids_[kRtpExtensionNumberOfExtensions];
+    // The type of each one-byte extension id, the id is 1 to 14, see https://www.rfc-editor.org/rfc/rfc8285#section-4.2
+    uint8_t types_[16];
 };
 
 // Note that the extensions should never extends from any class, for performance.
@@ -173,6 +185,11 @@ private:
 private:
     SrsRtpExtensionTwcc twcc_;
     SrsRtpExtensionOneByte audio_level_;
+private:
+    // The values decoded from packet, which are never encoded again, because the peer to send to negotiates
+    // its own extensions, so we only send the extensions we set.
+    bool has_decoded_audio_level_;
+    uint8_t decoded_audio_level_;
 public:
     SrsRtpExtensions();
     virtual ~SrsRtpExtensions();
@@ -236,6 +253,7 @@ public:
     void ignore_padding(bool v);
     srs_error_t get_twcc_sequence_number(uint16_t& twcc_sn);
     srs_error_t set_twcc_sequence_number(uint8_t id, uint16_t sn);
+    SrsRtpExtensions* get_extensions() { return &extensions_; } // SrsRtpHeader::get_extensions
 };
 
 // The common payload interface for RTP packet.
@@ -286,6 +304,12 @@ private:
     SrsSharedPtrMessage* shared_buffer_;
     // The size of RTP packet or RTP payload.
     int actual_buffer_size_;
+    // The wire bytes of payload without padding, shared by all copies. It points to the original RTP packet for
+    // RTC ingest, or to the wire_ encoded once by cache_payload for other sources, so that the player only encodes
+    // the header and copies the payload bytes, without encoding the payload objects for each player.
+    char* wire_payload_;
+    int nn_wire_payload_;
+    SrsSharedPtrMessage* wire_;
 // Helper fields.
 public:
     // The first byte as nalu type, for video decoder only.
@@ -316,8 +340,13 @@ public:
     void enable_twcc_decode() { header.enable_twcc_decode(); } // SrsRtpPacket::enable_twcc_decode
     // Get and set the payload of packet.
     // @remark Note that return NULL if no payload.
-    void set_payload(ISrsRtpPayloader* p, SrsRtspPacketPayloadType pt) { payload_ = p; payload_type_ = pt; }
+    void set_payload(ISrsRtpPayloader* p, SrsRtspPacketPayloadType pt);
     ISrsRtpPayloader* payload() { return payload_; }
+    // Encode the payload to wire bytes once, which is shared by all copies of packet.
+    // @remark Ignore if the packet already has the wire bytes, for example, the packet from RTC ingest.
+    srs_error_t cache_payload();
+    // Whether the packet has the wire bytes of payload.
+    bool has_wire_payload() { return wire_payload_; }
     // Set the padding of RTP packet.
     void set_padding(int size);
     // Increase the padding of RTP packet.
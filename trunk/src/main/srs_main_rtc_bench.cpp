@@ -0,0 +1,897 @@
+//
+// Copyright (c) 2013-2023 The SRS Authors
+//
+// SPDX-License-Identifier: MIT or MulanPSL-2.0
+//
+
+#include <srs_core.hpp>
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <algorithm>
+using namespace std;
+
+#include <srs_core_autofree.hpp>
+#include <srs_kernel_error.hpp>
+#include <srs_kernel_utility.hpp>
+#include <srs_kernel_buffer.hpp>
+#include <srs_kernel_rtc_rtp.hpp>
+#include <srs_kernel_rtc_rtcp.hpp>
+#include <srs_protocol_log.hpp>
+#include <srs_protocol_st.hpp>
+#include <srs_protocol_utility.hpp>
+#include <srs_protocol_json.hpp>
+#include <srs_protocol_http_stack.hpp>
+#include <srs_protocol_http_client.hpp>
+#include <srs_protocol_rtc_stun.hpp>
+#include <srs_app_config.hpp>
+#include <srs_app_st.hpp>
+#include <srs_app_rtc_sdp.hpp>
+#include <srs_app_rtc_dtls.hpp>
+#include <srs_app_threads.hpp>
+
+// @global log and context, created by srs_global_initialize.
+ISrsLog* _srs_log = NULL;
+ISrsContext* _srs_context = NULL;
+
+// @global config object for app module.
+SrsConfig* _srs_config = NULL;
+
+// @global Other variables.
+bool _srs_in_docker = false;
+bool _srs_config_by_env = false;
+
+// The binary name of SRS.
+const char* _srs_binary = NULL;
+
+// The options of benchmark.
+struct SrsRtcBenchOptions
+{
+    // The HTTP API of SRS, to publish by WHIP and play by WHEP.
+    std::string api_host;
+    int api_port;
+    std::string app;
+    // The prefix of streams, the stream of publisher i is prefix-i.
+    std::string stream;
+    int nn_publishers;
+    int nn_players;
+    srs_utime_t duration;
+    int fps;
+    int kbps;
+};
+
+// The statistic of all peers, which run in the same ST thread, so there is no lock.
+struct SrsRtcBenchStat
+{
+    int nn_publishers;
+    int nn_players;
+    int nn_failed;
+    // The packets sent by publishers, and received by players.
+    int64_t nn_sent;
+    int64_t nn_recv;
+    // The packets requested by NACK from SRS to publishers.
+    int64_t nn_nack;
+    int64_t nn_pli;
+    // The packets lost by players, detected by sequence number.
+    int64_t nn_lost;
+    // The end-to-end latency of packets in us, from publisher to player.
+    std::vector<srs_utime_t> latencies;
+};
+
+SrsRtcBenchStat* _bench_stat = NULL;
+
+// The payload size of video packet, which is less than MTU.
+#define SRS_RTC_BENCH_PAYLOAD 1000
+// The payload type of H.264 in offer.
+#define SRS_RTC_BENCH_PT 106
+// The size of history for NACK, must be power of 2.
+#define SRS_RTC_BENCH_HISTORY 1024
+
+// A local WebRTC peer, publish by WHIP or play by WHEP, with minimal ICE, DTLS and SRTP, to generate load for SRS.
+// The publisher sends fake H.264 packets, with the send time in payload, so the player is able to calculate the
+// end-to-end latency, as the publisher and player are in the same process.
+class SrsRtcBenchPeer : public ISrsCoroutineHandler, public ISrsDtlsCallback
+{
+private:
+    SrsRtcBenchOptions* opt_;
+    std::string stream_;
+    bool publish_;
+    SrsSTCoroutine* trd_;
+    // Whether connected to SRS, and DTLS is done.
+    bool ready_;
+private:
+    srs_netfd_t fd_;
+    sockaddr_in server_;
+    std::string ufrag_;
+    std::string pwd_;
+    std::string remote_ufrag_;
+    std::string remote_pwd_;
+    bool ice_done_;
+    SrsDtls* dtls_;
+    bool dtls_done_;
+    SrsSRTP* srtp_;
+private:
+    // For publisher.
+    uint32_t ssrc_;
+    uint16_t sn_;
+    uint32_t nn_frames_;
+    bool request_keyframe_;
+    std::vector<std::string> history_;
+    // For player.
+    bool has_sn_;
+    uint16_t expect_sn_;
+public:
+    SrsRtcBenchPeer(SrsRtcBenchOptions* opt, std::string stream, bool publish);
+    virtual ~SrsRtcBenchPeer();
+public:
+    srs_error_t start();
+    bool ready();
+// Interface ISrsCoroutineHandler
+public:
+    virtual srs_error_t cycle();
+private:
+    srs_error_t do_cycle();
+    // Exchange SDP by WHIP or WHEP.
+    srs_error_t signaling();
+    std::string offer();
+    srs_error_t handshake();
+    srs_error_t consume();
+    srs_error_t recv_packet(srs_utime_t timeout);
+    srs_error_t send_stun();
+    srs_error_t send_frame();
+    srs_error_t send_packet(char* data, int size);
+    srs_error_t on_rtp(char* data, int size);
+    srs_error_t on_rtcp(char* data, int size);
+// Interface ISrsDtlsCallback
+public:
+    virtual srs_error_t on_dtls_handshake_done();
+    virtual srs_error_t on_dtls_application_data(const char* data, const int len);
+    virtual srs_error_t write_dtls_data(void* data, int size);
+    virtual srs_error_t on_dtls_alert(std::string type, std::string desc);
+};
+
+SrsRtcBenchPeer::SrsRtcBenchPeer(SrsRtcBenchOptions* opt, string stream, bool publish)
+{
+    opt_ = opt;
+    stream_ = stream;
+    publish_ = publish;
+    trd_ = new SrsSTCoroutine("bench", this);
+    ready_ = false;
+
+    fd_ = NULL;
+    memset(&server_, 0, sizeof(server_));
+    ufrag_ = srs_random_str(8);
+    pwd_ = srs_random_str(32);
+    ice_done_ = false;
+    dtls_ = new SrsDtls(this);
+    dtls_done_ = false;
+    srtp_ = new SrsSRTP();
+
+    ssrc_ = (uint32_t)srs_random();
+    sn_ = 0;
+    nn_frames_ = 0;
+    request_keyframe_ = true;
+    history_.resize(SRS_RTC_BENCH_HISTORY);
+
+    has_sn_ = false;
+    expect_sn_ = 0;
+}
+
+SrsRtcBenchPeer::~SrsRtcBenchPeer()
+{
+    srs_freep(trd_);
+    srs_freep(dtls_);
+    srs_freep(srtp_);
+    srs_close_stfd(fd_);
+}
+
+srs_error_t SrsRtcBenchPeer::start()
+{
+    return trd_->start();
+}
+
+bool SrsRtcBenchPeer::ready()
+{
+    return ready_;
+}
+
+srs_error_t SrsRtcBenchPeer::cycle()
+{
+    srs_error_t err = do_cycle();
+
+    if (err != srs_success && srs_error_code(err) != ERROR_THREAD_INTERRUPED) {
+        _bench_stat->nn_failed++;
+        srs_error("bench %s %s err %s", publish_ ? "publish" : "play", stream_.c_str(), srs_error_desc(err).c_str());
+    }
+
+    srs_freep(err);
+    return srs_success;
+}
+
+srs_error_t SrsRtcBenchPeer::do_cycle()
+{
+    srs_error_t err = srs_success;
+
+    if ((err = signaling()) != srs_success) {
+        return srs_error_wrap(err, "signaling");
+    }
+
+    if ((err = handshake()) != srs_success) {
+        return srs_error_wrap(err, "handshake");
+    }
+
+    ready_ = true;
+    if (publish_) {
+        _bench_stat->nn_publishers++;
+    } else {
+        _bench_stat->nn_players++;
+    }
+
+    return consume();
+}
+
+srs_error_t SrsRtcBenchPeer::signaling()
+{
+    srs_error_t err = srs_success;
+
+    SrsHttpClient hc;
+    if ((err = hc.initialize("http", opt_->api_host, opt_->api_port)) != srs_success) {
+        return srs_error_wrap(err, "http init");
+    }
+    hc.set_header("Content-Type", "application/sdp");
+
+    // Use the host of API as candidate, because the benchmark runs on loopback or LAN.
+    string path = srs_fmt("/rtc/v1/%s/?app=%s&stream=%s&eip=%s", publish_ ? "whip" : "whip-play",
+        opt_->app.c_str(), stream_.c_str(), opt_->api_host.c_str());
+
+    ISrsHttpMessage* msg = NULL;
+    if ((err = hc.post(path, offer(), &msg)) != srs_success) {
+        return srs_error_wrap(err, "post %s", path.c_str());
+    }
+    SrsAutoFree(ISrsHttpMessage, msg);
+
+    string answer;
+    if ((err = msg->body_read_all(answer)) != srs_success) {
+        return srs_error_wrap(err, "read answer");
+    }
+
+    if (msg->status_code() != SRS_CONSTS_HTTP_OK && msg->status_code() != SRS_CONSTS_HTTP_Created) {
+        return srs_error_new(ERROR_RTC_SDP_EXCHANGE, "status=%d, answer=%s", msg->status_code(), answer.c_str());
+    }
+
+    SrsSdp sdp;
+    if ((err = sdp.parse(answer)) != srs_success) {
+        return srs_error_wrap(err, "parse answer %s", answer.c_str());
+    }
+
+    remote_ufrag_ = sdp.get_ice_ufrag();
+    remote_pwd_ = sdp.get_ice_pwd();
+
+    for (int i = 0; i < (int)sdp.media_descs_.size() && remote_ufrag_.empty(); i++) {
+        SrsMediaDesc& desc = sdp.media_descs_.at(i);
+        remote_ufrag_ = desc.session_info_.ice_ufrag_;
+        remote_pwd_ = desc.session_info_.ice_pwd_;
+    }
+
+    // The SDP parser ignores the candidates, so we parse the first one, for example:
+    //      a=candidate:0 1 udp 2130706431 127.0.0.1 8000 typ host generation 0
+    string ip;
+    int port = 0;
+    size_t pos = answer.find("a=candidate:");
+    if (pos != string::npos) {
+        string line = answer.substr(pos, answer.find_first_of("\r\n", pos) - pos);
+        vector<string> fields = srs_string_split(line, " ");
+        if (fields.size() >= 6 && fields[2] == "udp") {
+            ip = fields[4];
+            port = ::atoi(fields[5].c_str());
+        }
+    }
+    if (ip.empty() || port <= 0 || remote_ufrag_.empty()) {
+        return srs_error_new(ERROR_RTC_SDP_EXCHANGE, "no candidate or ice, answer=%s", answer.c_str());
+    }
+
+    server_.sin_family = AF_INET;
+    server_.sin_port = htons(port);
+    if (inet_pton(AF_INET, ip.c_str(), &server_.sin_addr) != 1) {
+        return srs_error_new(ERROR_RTC_SDP_EXCHANGE, "invalid candidate %s", ip.c_str());
+    }
+
+    return err;
+}
+
+string SrsRtcBenchPeer::offer()
+{
+    std::stringstream ss;
+    ss << "v=0" << SRS_HTTP_CRLF
+       << "o=- " << srs_random() << " 2 IN IP4 127.0.0.1" << SRS_HTTP_CRLF
+       << "s=-" << SRS_HTTP_CRLF
+       << "t=0 0" << SRS_HTTP_CRLF
+       << "a=group:BUNDLE 0" << SRS_HTTP_CRLF
+       << "a=msid-semantic: WMS bench" << SRS_HTTP_CRLF
+       << "m=video 9 UDP/TLS/RTP/SAVPF " << SRS_RTC_BENCH_PT << SRS_HTTP_CRLF
+       << "c=IN IP4 0.0.0.0" << SRS_HTTP_CRLF
+       << "a=rtcp:9 IN IP4 0.0.0.0" << SRS_HTTP_CRLF
+       << "a=ice-ufrag:" << ufrag_ << SRS_HTTP_CRLF
+       << "a=ice-pwd:" << pwd_ << SRS_HTTP_CRLF
+       << "a=fingerprint:sha-256 " << _srs_rtc_dtls_certificate->get_fingerprint() << SRS_HTTP_CRLF
+       << "a=setup:actpass" << SRS_HTTP_CRLF
+       << "a=mid:0" << SRS_HTTP_CRLF
+       << (publish_ ? "a=sendonly" : "a=recvonly") << SRS_HTTP_CRLF
+       << "a=rtcp-mux" << SRS_HTTP_CRLF
+       << "a=rtcp-rsize" << SRS_HTTP_CRLF
+       << "a=rtpmap:" << SRS_RTC_BENCH_PT << " H264/90000" << SRS_HTTP_CRLF
+       << "a=rtcp-fb:" << SRS_RTC_BENCH_PT << " nack" << SRS_HTTP_CRLF
+       << "a=rtcp-fb:" << SRS_RTC_BENCH_PT << " nack pli" << SRS_HTTP_CRLF
+       << "a=fmtp:" << SRS_RTC_BENCH_PT << " level-asymmetry-allowed=1;packetization-mode=1;profile-level-id=42e01f" << SRS_HTTP_CRLF;
+
+    if (publish_) {
+        ss << "a=msid:bench video" << SRS_HTTP_CRLF
+           << "a=ssrc:" << ssrc_ << " cname:" << ufrag_ << SRS_HTTP_CRLF
+           << "a=ssrc:" << ssrc_ << " msid:bench video" << SRS_HTTP_CRLF;
+    }
+
+    return ss.str();
+}
+
+srs_error_t SrsRtcBenchPeer::handshake()
+{
+    srs_error_t err = srs_success;
+
+    if ((err = srs_udp_listen("0.0.0.0", 0, &fd_)) != srs_success) {
+        return srs_error_wrap(err, "listen udp");
+    }
+
+    // ICE, we are the controlling agent, and nominate the only candidate.
+    srs_utime_t deadline = srs_update_system_time() + 10 * SRS_UTIME_SECONDS;
+    while (!ice_done_) {
+        if (srs_update_system_time() > deadline) {
+            return srs_error_new(ERROR_RTC_STUN, "ice timeout");
+        }
+        if ((err = send_stun()) != srs_success) {
+            return srs_error_wrap(err, "send stun");
+        }
+        if ((err = recv_packet(100 * SRS_UTIME_MILLISECONDS)) != srs_success) {
+            return srs_error_wrap(err, "recv");
+        }
+    }
+
+    // DTLS, we are the client, because SRS is always passive.
+    if ((err = dtls_->initialize("active", "dtls1.2")) != srs_success) {
+        return srs_error_wrap(err, "dtls init");
+    }
+    if ((err = dtls_->start_active_handshake()) != srs_success) {
+        return srs_error_wrap(err, "dtls start");
+    }
+
+    deadline = srs_update_system_time() + 10 * SRS_UTIME_SECONDS;
+    while (!dtls_done_) {
+        if (srs_update_system_time() > deadline) {
+            return srs_error_new(ERROR_RTC_DTLS, "dtls timeout");
+        }
+        if ((err = recv_packet(100 * SRS_UTIME_MILLISECONDS)) != srs_success) {
+            return srs_error_wrap(err, "recv");
+        }
+    }
+
+    return err;
+}
+
+srs_error_t SrsRtcBenchPeer::consume()
+{
+    srs_error_t err = srs_success;
+
+    srs_utime_t interval = SRS_UTIME_SECONDS / opt_->fps;
+    srs_utime_t next_frame = srs_update_system_time();
+    srs_utime_t next_stun = next_frame + 5 * SRS_UTIME_SECONDS;
+
+    while (true) {
+        if ((err = trd_->pull()) != srs_success) {
+            return srs_error_wrap(err, "pull");
+        }
+
+        srs_utime_t now = srs_update_system_time();
+        if (publish_ && now >= next_frame) {
+            if ((err = send_frame()) != srs_success) {
+                return srs_error_wrap(err, "send frame");
+            }
+            next_frame += interval;
+            continue;
+        }
+
+        // Keepalive by STUN, or SRS will dispose the session.
+        if (now >= next_stun) {
+            if ((err = send_stun()) != srs_success) {
+                return srs_error_wrap(err, "send stun");
+            }
+            next_stun = now + 5 * SRS_UTIME_SECONDS;
+        }
+
+        srs_utime_t timeout = next_stun - now;
+        if (publish_) {
+            timeout = srs_min(timeout, next_frame - now);
+        }
+        if ((err = recv_packet(timeout)) != srs_success) {
+            return srs_error_wrap(err, "recv");
+        }
+    }
+
+    return err;
+}
+
+srs_error_t SrsRtcBenchPeer::recv_packet(srs_utime_t timeout)
+{
+    srs_error_t err = srs_success;
+
+    char buf[1500];
+    sockaddr_in from;
+    int fromlen = sizeof(from);
+    int nn = srs_recvfrom(fd_, buf, sizeof(buf), (sockaddr*)&from, &fromlen, timeout);
+    if (nn <= 0) {
+        return err;
+    }
+
+    // Demux the packet by the first byte, see https://www.rfc-editor.org/rfc/rfc7983#section-7
+    uint8_t b0 = (uint8_t)buf[0];
+    if (b0 <= 3) {
+        SrsStunPacket ping;
+        if ((err = ping.decode(buf, nn)) != srs_success) {
+            return srs_error_wrap(err, "decode stun");
+        }
+        if (ping.is_binding_response()) {
+            ice_done_ = true;
+        }
+        return err;
+    }
+
+    if (b0 >= 20 && b0 <= 63) {
+        return dtls_->on_dtls(buf, nn);
+    }
+
+    if (b0 < 128 || b0 > 191 || nn < 12 || !dtls_done_) {
+        return err;
+    }
+
+    // For RTCP, the payload type is in [192, 223], see https://www.rfc-editor.org/rfc/rfc5761#section-4
+    uint8_t pt = (uint8_t)buf[1];
+    if (pt >= 192 && pt <= 223) {
+        return on_rtcp(buf, nn);
+    }
+    return on_rtp(buf, nn);
+}
+
+srs_error_t SrsRtcBenchPeer::send_stun()
+{
+    srs_error_t err = srs_success;
+
+    SrsStunPacket ping;
+    ping.set_message_type(BindingRequest);
+    ping.set_local_ufrag(ufrag_);
+    ping.set_remote_ufrag(remote_ufrag_);
+    ping.set_transcation_id(srs_random_str(12));
+    ping.set_use_candidate(true);
+    ping.set_ice_controlling(true);
+
+    char buf[1460];
+    SrsBuffer stream(buf, sizeof(buf));
+    if ((err = ping.encode(remote_pwd_, &stream)) != srs_success) {
+        return srs_error_wrap(err, "encode stun");
+    }
+
+    return send_packet(buf, stream.pos());
+}
+
+srs_error_t SrsRtcBenchPeer::send_frame()
+{
+    srs_error_t err = srs_success;
+
+    // The packets of frame, by the bitrate and fps.
+    int nn_packets = srs_max(1, opt_->kbps * 1000 / 8 / opt_->fps / SRS_RTC_BENCH_PAYLOAD);
+
+    bool keyframe = request_keyframe_ || (nn_frames_ % (opt_->fps * 2)) == 0;
+    request_keyframe_ = false;
+
+    uint32_t ts = nn_frames_++ * (90000 / opt_->fps);
+    for (int i = 0; i < nn_packets; i++) {
+        char buf[1500];
+        SrsBuffer stream(buf, sizeof(buf));
+
+        uint16_t sn = sn_++;
+        stream.write_1bytes(0x80);
+        stream.write_1bytes((i == nn_packets - 1 ? 0x80 : 0x00) | SRS_RTC_BENCH_PT);
+        stream.write_2bytes(sn);
+        stream.write_4bytes(ts);
+        stream.write_4bytes(ssrc_);
+
+        // The NALU with the send time, to calculate the latency by player.
+        stream.write_1bytes(keyframe ? 0x65 : 0x41);
+        stream.write_8bytes(srs_update_system_time());
+        memset(stream.head(), 0, SRS_RTC_BENCH_PAYLOAD - 9);
+        stream.skip(SRS_RTC_BENCH_PAYLOAD - 9);
+
+        history_[sn & (SRS_RTC_BENCH_HISTORY - 1)] = string(buf, stream.pos());
+
+        int nn_cipher = stream.pos();
+        if ((err = srtp_->protect_rtp(buf, &nn_cipher)) != srs_success) {
+            return srs_error_wrap(err, "protect rtp");
+        }
+        if ((err = send_packet(buf, nn_cipher)) != srs_success) {
+            return srs_error_wrap(err, "send rtp");
+        }
+        _bench_stat->nn_sent++;
+    }
+
+    return err;
+}
+
+srs_error_t SrsRtcBenchPeer::send_packet(char* data, int size)
+{
+    if (srs_sendto(fd_, data, size, (sockaddr*)&server_, sizeof(server_), SRS_UTIME_NO_TIMEOUT) <= 0) {
+        return srs_error_new(ERROR_SOCKET_WRITE, "sendto");
+    }
+    return srs_success;
+}
+
+srs_error_t SrsRtcBenchPeer::on_rtp(char* data, int size)
+{
+    srs_error_t err = srs_success;
+
+    if (publish_) {
+        return err;
+    }
+
+    int nn_plaintext = size;
+    if ((err = srtp_->unprotect_rtp(data, &nn_plaintext)) != srs_success) {
+        return srs_error_wrap(err, "unprotect rtp");
+    }
+
+    SrsBuffer stream(data, nn_plaintext);
+    SrsRtpHeader header;
+    if ((err = header.decode(&stream)) != srs_success) {
+        return srs_error_wrap(err, "decode rtp");
+    }
+    _bench_stat->nn_recv++;
+
+    // Detect the lost packets by sequence number, ignore the late packets.
+    uint16_t sn = header.get_sequence();
+    if (has_sn_) {
+        int16_t distance = srs_rtp_seq_distance(expect_sn_, sn);
+        if (distance < 0) {
+            return err;
+        }
+        _bench_stat->nn_lost += distance;
+    }
+    has_sn_ = true;
+    expect_sn_ = sn + 1;
+
+    if (stream.left() >= 9) {
+        stream.skip(1);
+        srs_utime_t latency = srs_update_system_time() - (srs_utime_t)stream.read_8bytes();
+        _bench_stat->latencies.push_back(srs_max(0, latency));
+    }
+
+    return err;
+}
+
+srs_error_t SrsRtcBenchPeer::on_rtcp(char* data, int size)
+{
+    srs_error_t err = srs_success;
+
+    if (!publish_) {
+        return err;
+    }
+
+    int nn_plaintext = size;
+    if ((err = srtp_->unprotect_rtcp(data, &nn_plaintext)) != srs_success) {
+        return srs_error_wrap(err, "unprotect rtcp");
+    }
+
+    SrsBuffer stream(data, nn_plaintext);
+    SrsRtcpCompound rtcps;
+    if ((err = rtcps.decode(&stream)) != srs_success) {
+        return srs_error_wrap(err, "decode rtcp");
+    }
+
+    SrsRtcpCommon* rtcp = NULL;
+    while ((rtcp = rtcps.get_next_rtcp()) != NULL) {
+        SrsAutoFree(SrsRtcpCommon, rtcp);
+
+        if (dynamic_cast<SrsRtcpPli*>(rtcp)) {
+            _bench_stat->nn_pli++;
+            request_keyframe_ = true;
+            continue;
+        }
+
+        // Retransmit the lost packets in history, without RTX.
+        SrsRtcpNack* nack = dynamic_cast<SrsRtcpNack*>(rtcp);
+        if (!nack) {
+            continue;
+        }
+
+        vector<uint16_t> sns = nack->get_lost_sns();
+        for (int i = 0; i < (int)sns.size(); i++) {
+            string& pkt = history_[sns[i] & (SRS_RTC_BENCH_HISTORY - 1)];
+            _bench_stat->nn_nack++;
+            if (pkt.size() < 12 || (uint16_t)((uint8_t)pkt[2] << 8 | (uint8_t)pkt[3]) != sns[i]) {
+                continue;
+            }
+
+            char buf[1500];
+            memcpy(buf, pkt.data(), pkt.size());
+            int nn_cipher = (int)pkt.size();
+            if ((err = srtp_->protect_rtp(buf, &nn_cipher)) != srs_success) {
+                return srs_error_wrap(err, "protect rtp");
+            }
+            if ((err = send_packet(buf, nn_cipher)) != srs_success) {
+                return srs_error_wrap(err, "send rtp");
+            }
+        }
+    }
+
+    return err;
+}
+
+srs_error_t SrsRtcBenchPeer::on_dtls_handshake_done()
+{
+    srs_error_t err = srs_success;
+
+    std::string recv_key, send_key;
+    if ((err = dtls_->get_srtp_key(recv_key, send_key)) != srs_success) {
+        return srs_error_wrap(err, "srtp key");
+    }
+
+    if ((err = srtp_->initialize(recv_key, send_key, dtls_->get_srtp_profile())) != srs_success) {
+        return srs_error_wrap(err, "srtp init");
+    }
+
+    dtls_done_ = true;
+    return err;
+}
+
+srs_error_t SrsRtcBenchPeer::on_dtls_application_data(const char* data, const int len)
+{
+    return srs_success;
+}
+
+srs_error_t SrsRtcBenchPeer::write_dtls_data(void* data, int size)
+{
+    return send_packet((char*)data, size);
+}
+
+srs_error_t SrsRtcBenchPeer::on_dtls_alert(std::string type, std::string desc)
+{
+    return srs_success;
+}
+
+// Get the CPU usage of SRS in percent, by the HTTP API.
+float srs_rtc_bench_server_cpu(SrsRtcBenchOptions* opt)
+{
+    srs_error_t err = srs_success;
+
+    SrsHttpClient hc;
+    if ((err = hc.initialize("http", opt->api_host, opt->api_port)) != srs_success) {
+        srs_freep(err);
+        return 0;
+    }
+
+    ISrsHttpMessage* msg = NULL;
+    if ((err = hc.get("/api/v1/summaries", "", &msg)) != srs_success) {
+        srs_freep(err);
+        return 0;
+    }
+    SrsAutoFree(ISrsHttpMessage, msg);
+
+    string body;
+    if ((err = msg->body_read_all(body)) != srs_success) {
+        srs_freep(err);
+        return 0;
+    }
+
+    SrsJsonAny* res = SrsJsonAny::loads(body);
+    SrsAutoFree(SrsJsonAny, res);
+
+    SrsJsonAny* prop = NULL;
+    if (!res || !res->is_object() || (prop = res->to_object()->get_property("data")) == NULL || !prop->is_object()) {
+        return 0;
+    }
+    if ((prop = prop->to_object()->get_property("self")) == NULL || !prop->is_object()) {
+        return 0;
+    }
+    if ((prop = prop->to_object()->ensure_property_number("cpu_percent")) == NULL) {
+        return 0;
+    }
+
+    return (float)(prop->to_number() * 100);
+}
+
+// Get the percentile of latencies in ms, the latencies must be sorted.
+double srs_rtc_bench_percentile(vector<srs_utime_t>& latencies, double v)
+{
+    if (latencies.empty()) {
+        return 0;
+    }
+
+    int index = srs_min((int)latencies.size() - 1, (int)(latencies.size() * v));
+    return latencies[index] / 1000.0;
+}
+
+srs_error_t srs_rtc_bench(SrsRtcBenchOptions* opt)
+{
+    srs_error_t err = srs_success;
+
+    // Initialize the certificate and SRTP, for all peers.
+    if ((err = _srs_rtc_dtls_certificate->initialize()) != srs_success) {
+        return srs_error_wrap(err, "dtls certificate");
+    }
+
+    _bench_stat = new SrsRtcBenchStat();
+    _bench_stat->nn_publishers = _bench_stat->nn_players = _bench_stat->nn_failed = 0;
+    _bench_stat->nn_sent = _bench_stat->nn_recv = _bench_stat->nn_nack = _bench_stat->nn_pli = _bench_stat->nn_lost = 0;
+
+    vector<SrsRtcBenchPeer*> peers;
+    for (int i = 0; i < opt->nn_publishers; i++) {
+        peers.push_back(new SrsRtcBenchPeer(opt, srs_fmt("%s-%d", opt->stream.c_str(), i), true));
+    }
+    // The players are distributed to publishers evenly.
+    for (int i = 0; i < opt->nn_players; i++) {
+        peers.push_back(new SrsRtcBenchPeer(opt, srs_fmt("%s-%d", opt->stream.c_str(), i % opt->nn_publishers), false));
+    }
+
+    // Start publishers first, because player requires the stream to be published.
+    for (int i = 0; i < opt->nn_publishers; i++) {
+        if ((err = peers[i]->start()) != srs_success) {
+            return srs_error_wrap(err, "start publisher");
+        }
+    }
+    for (int i = 0; i < 100 && _bench_stat->nn_publishers + _bench_stat->nn_failed < opt->nn_publishers; i++) {
+        srs_usleep(100 * SRS_UTIME_MILLISECONDS);
+    }
+    for (int i = opt->nn_publishers; i < (int)peers.size(); i++) {
+        if ((err = peers[i]->start()) != srs_success) {
+            return srs_error_wrap(err, "start player");
+        }
+    }
+
+    // Report the statistic for each interval.
+    vector<srs_utime_t> all_latencies;
+    int64_t nn_sent = 0, nn_recv = 0, nn_nack = 0, nn_lost = 0;
+    srs_utime_t interval = 5 * SRS_UTIME_SECONDS;
+    srs_utime_t starttime = srs_update_system_time();
+    float cpu = 0;
+    int nn_streams = 0;
+    srs_utime_t elapsed = 0;
+    while ((elapsed = srs_update_system_time() - starttime) < opt->duration) {
+        srs_utime_t tick = srs_min(interval, opt->duration - elapsed);
+        srs_usleep(tick);
+
+        SrsRtcBenchStat* s = _bench_stat;
+        std::sort(s->latencies.begin(), s->latencies.end());
+        cpu = srs_rtc_bench_server_cpu(opt);
+        nn_streams = s->nn_publishers + s->nn_players;
+        double seconds = srs_max(1, srsu2ms(tick)) / 1000.0;
+
+        srs_trace("bench: publishers=%d, players=%d, failed=%d, send=%dpps, recv=%dpps, nack=%dpps, lost=%dpps, pli=%d, "
+            "cpu=%.1f%%, cpu/stream=%.2f%%, latency p50=%.1fms, p90=%.1fms, p99=%.1fms",
+            s->nn_publishers, s->nn_players, s->nn_failed, (int)((s->nn_sent - nn_sent) / seconds),
+            (int)((s->nn_recv - nn_recv) / seconds), (int)((s->nn_nack - nn_nack) / seconds),
+            (int)((s->nn_lost - nn_lost) / seconds), (int)s->nn_pli, cpu, nn_streams ? cpu / nn_streams : 0,
+            srs_rtc_bench_percentile(s->latencies, 0.5), srs_rtc_bench_percentile(s->latencies, 0.9),
+            srs_rtc_bench_percentile(s->latencies, 0.99));
+
+        nn_sent = s->nn_sent; nn_recv = s->nn_recv; nn_nack = s->nn_nack; nn_lost = s->nn_lost;
+        all_latencies.insert(all_latencies.end(), s->latencies.begin(), s->latencies.end());
+        s->latencies.clear();
+    }
+
+    for (int i = 0; i < (int)peers.size(); i++) {
+        SrsRtcBenchPeer* peer = peers.at(i);
+        srs_freep(peer);
+    }
+
+    SrsRtcBenchStat* s = _bench_stat;
+    std::sort(all_latencies.begin(), all_latencies.end());
+    int seconds = srs_max(1, (int)((srs_update_system_time() - starttime) / SRS_UTIME_SECONDS));
+    printf("\nSummary of %ds:\n"
+        "    streams:  publishers=%d/%d, players=%d/%d, failed=%d\n"
+        "    packets:  send=%dpps, recv=%dpps, nack=%dpps, lost=%" PRId64 "(%.3f%%), pli=%d\n"
+        "    cpu:      server=%.1f%%, per stream=%.2f%%\n"
+        "    latency:  p50=%.1fms, p90=%.1fms, p99=%.1fms, max=%.1fms\n",
+        seconds, s->nn_publishers, opt->nn_publishers, s->nn_players, opt->nn_players, s->nn_failed,
+        (int)(s->nn_sent / seconds), (int)(s->nn_recv / seconds), (int)(s->nn_nack / seconds), s->nn_lost,
+        s->nn_recv + s->nn_lost ? 100.0 * s->nn_lost / (s->nn_recv + s->nn_lost) : 0, (int)s->nn_pli,
+        cpu, nn_streams ? cpu / nn_streams : 0, srs_rtc_bench_percentile(all_latencies, 0.5),
+        srs_rtc_bench_percentile(all_latencies, 0.9), srs_rtc_bench_percentile(all_latencies, 0.99),
+        srs_rtc_bench_percentile(all_latencies, 1));
+
+    if (s->nn_failed) {
+        return srs_error_new(ERROR_RTC_SDP_EXCHANGE, "%d peers failed", s->nn_failed);
+    }
+
+    return err;
+}
+
+int main(int argc, char** argv)
+{
+    _srs_binary = argv[0];
+
+    SrsRtcBenchOptions opt;
+    opt.api_host = "127.0.0.1";
+    opt.api_port = 1985;
+    opt.app = "live";
+    opt.stream = "bench";
+    opt.nn_publishers = 1;
+    opt.nn_players = 1;
+    opt.duration = 30 * SRS_UTIME_SECONDS;
+    opt.fps = 25;
+    opt.kbps = 800;
+
+    for (int i = 1; i < argc - 1; i += 2) {
+        char* p = argv[i];
+        char* v = argv[i + 1];
+
+        // only accept -x
+        if (p[0] != '-' || p[1] == 0 || p[2] != 0) {
+            continue;
+        }
+
+        switch (p[1]) {
+            case 's': opt.api_host = v; break;
+            case 'o': opt.api_port = ::atoi(v); break;
+            case 'a': opt.app = v; break;
+            case 'n': opt.stream = v; break;
+            case 'p': opt.nn_publishers = ::atoi(v); break;
+            case 'c': opt.nn_players = ::atoi(v); break;
+            case 't': opt.duration = ::atoi(v) * SRS_UTIME_SECONDS; break;
+            case 'f': opt.fps = ::atoi(v); break;
+            case 'b': opt.kbps = ::atoi(v); break;
+            default: break;
+        }
+    }
+
+    if (argc < 2 || opt.nn_publishers <= 0 || opt.nn_players < 0 || opt.fps <= 0 || opt.kbps <= 0) {
+        printf("SRS RTC benchmark/%d.%d.%d, publish by WHIP and play by WHEP, to benchmark the RTC capacity.\n"
+               "Usage: %s [-s api_host] [-o api_port] [-a app] [-n stream] [-p publishers] [-c players]\n"
+               "        [-t seconds] [-f fps] [-b kbps]\n"
+               "    -s      The host of SRS HTTP API, also the candidate. Default: 127.0.0.1\n"
+               "    -o      The port of SRS HTTP API. Default: 1985\n"
+               "    -a      The app of streams. Default: live\n"
+               "    -n      The prefix of streams, the stream of publisher i is prefix-i. Default: bench\n"
+               "    -p      The number of publishers. Default: 1\n"
+               "    -c      The number of players, which play the publishers in turn. Default: 1\n"
+               "    -t      The duration in seconds. Default: 30\n"
+               "    -f      The fps of video. Default: 25\n"
+               "    -b      The bitrate of video in kbps. Default: 800\n"
+               "For example:\n"
+               "    %s -p 10 -c 100 -t 60\n",
+               VERSION_MAJOR, VERSION_MINOR, VERSION_REVISION, argv[0], argv[0]);
+        exit(-1);
+    }
+
+    // Initialize global and thread-local variables, like SRS server.
+    srs_error_t err = srs_success;
+    if ((err = srs_global_initialize()) != srs_success || (err = SrsThreadPool::setup_thread_locals()) != srs_success) {
+        fprintf(stderr, "RTC bench init err %s\n", srs_error_desc(err).c_str());
+        srs_freep(err);
+        exit(-1);
+    }
+    _srs_context->set_id(_srs_context->generate_id());
+
+    srs_trace("RTC bench api=%s:%d, app=%s, stream=%s, publishers=%d, players=%d, duration=%ds, fps=%d, kbps=%d",
+        opt.api_host.c_str(), opt.api_port, opt.app.c_str(), opt.stream.c_str(), opt.nn_publishers, opt.nn_players,
+        srsu2msi(opt.duration) / 1000, opt.fps, opt.kbps);
+
+    err = srs_rtc_bench(&opt);
+    if (err != srs_success) {
+        srs_error("RTC bench err %s", srs_error_desc(err).c_str());
+    }
+
+    int ret = srs_error_code(err);
+    srs_freep(err);
+    return ret;
+}
+
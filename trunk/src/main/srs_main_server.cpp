@@ -518,7 +518,22 @@ srs_error_t run_in_thread_pool()
         return srs_error_wrap(err, "start hybrid server thread");
     }
 
-    srs_trace("Pool: Start threads primordial=1, hybrids=1 ok");
+    // Start the file I/O worker thread, for HLS m3u8 and cleanup, etc.
+    if (_srs_config->get_threads_async_file_io()) {
+        if ((err = _srs_async_file_worker->start()) != srs_success) {
+            return srs_error_wrap(err, "start file io thread");
+        }
+    }
+
+#ifdef SRS_RTC
+    // Start the SRTP worker threads, for RTC players.
+    if ((err = _srs_async_srtp->start(_srs_config->get_threads_srtp_workers())) != srs_success) {
+        return srs_error_wrap(err, "start srtp threads");
+    }
+#endif
+
+    srs_trace("Pool: Start threads primordial=1, hybrids=1, fileio=%d, srtp=%d ok", _srs_config->get_threads_async_file_io(),
+        _srs_config->get_threads_srtp_workers());
 
     return _srs_thread_pool->run();
 #endif
@@ -7,6 +7,8 @@
 #include <srs_protocol_http_stack.hpp>
 
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include <sstream>
 #include <algorithm>
 using namespace std;
@@ -106,6 +108,44 @@ string srs_go_http_detect(char* data, int size)
     return "application/octet-stream"; // fallback
 }
 
+string srs_http_format_date(time_t t)
+{
+    char buf[64];
+    struct tm tm;
+    if (!gmtime_r(&t, &tm) || strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", &tm) == 0) {
+        return "";
+    }
+    return buf;
+}
+
+bool srs_http_parse_date(string date, time_t* pt)
+{
+    // The IMF-fixdate, RFC 850 and asctime formats, for example:
+    //      Sun, 06 Nov 1994 08:49:37 GMT
+    //      Sunday, 06-Nov-94 08:49:37 GMT
+    //      Sun Nov  6 08:49:37 1994
+    static const char* formats[] = {
+        "%a, %d %b %Y %H:%M:%S GMT",
+        "%A, %d-%b-%y %H:%M:%S GMT",
+        "%a %b %d %H:%M:%S %Y",
+    };
+
+    for (int i = 0; i < (int)(sizeof(formats) / sizeof(formats[0])); i++) {
+        struct tm tm;
+        memset(&tm, 0, sizeof(tm));
+
+        const char* p = strptime(date.c_str(), formats[i], &tm);
+        if (!p || *p != '\0') {
+            continue;
+        }
+
+        *pt = timegm(&tm);
+        return true;
+    }
+
+    return false;
+}
+
 srs_error_t srs_go_http_error(ISrsHttpResponseWriter* w, int code)
 {
     return srs_go_http_error(w, code, srs_generate_http_status_text(code));
@@ -391,6 +431,11 @@ srs_error_t SrsHttpFileServer::serve_http(ISrsHttpResponseWriter* w, ISrsHttpMes
 
     // stat current dir, if exists, return error.
     if (!_srs_path_exists(fullpath)) {
+        // The DASH fragment in writing does not exist, which might be served in chunked encoding.
+        if (srs_string_ends_with(upath, ".m4s")) {
+            return serve_m4s_ctx(w, r, fullpath);
+        }
+
         srs_warn("http miss file=%s, pattern=%s, upath=%s",
                  fullpath.c_str(), entry->pattern.c_str(), upath.c_str());
         return SrsHttpNotFoundHandler().serve_http(w, r);
@@ -524,10 +569,17 @@ srs_error_t SrsHttpFileServer::serve_mp4_file(ISrsHttpResponseWriter* w, ISrsHtt
             range = range.substr(6);
         }
     }
+
+    // For seek by time in seconds, for example, x.mp4?start=10.5
+    std::string seek = r->query_get("start");
+    srs_utime_t time = (srs_utime_t)(::atof(seek.c_str()) * SRS_UTIME_SECONDS);
     
     // rollback to serve whole file.
     size_t pos = string::npos;
     if (range.empty() || (pos = range.find("-")) == string::npos) {
+        if (!seek.empty()) {
+            return serve_mp4_seek(w, r, fullpath, time, 0, -1);
+        }
         return serve_file(w, r, fullpath);
     }
     
@@ -545,7 +597,15 @@ srs_error_t SrsHttpFileServer::serve_mp4_file(ISrsHttpResponseWriter* w, ISrsHtt
     
     // invalid param, serve as whole mp4 file.
     if (start < 0 || (end != -1 && start > end)) {
-        return serve_file(w, r, fullpath);
+        start = 0;
+        end = -1;
+        if (seek.empty()) {
+            return serve_file(w, r, fullpath);
+        }
+    }
+
+    if (!seek.empty()) {
+        return serve_mp4_seek(w, r, fullpath, time, start, end);
     }
     
     return serve_mp4_stream(w, r, fullpath, start, end);
@@ -575,6 +635,12 @@ srs_error_t SrsHttpFileServer::serve_mp4_stream(ISrsHttpResponseWriter* w, ISrsH
     return serve_file(w, r, fullpath);
 }
 
+srs_error_t SrsHttpFileServer::serve_mp4_seek(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, string fullpath, srs_utime_t time, int64_t start, int64_t end)
+{
+    // @remark For common http file server, we don't support seek by time, please use SrsVodStream instead.
+    return serve_file(w, r, fullpath);
+}
+
 srs_error_t SrsHttpFileServer::serve_m3u8_ctx(ISrsHttpResponseWriter * w, ISrsHttpMessage * r, std::string fullpath)
 {
     // @remark For common http file server, we don't support stream request, please use SrsVodStream instead.
@@ -587,6 +653,13 @@ srs_error_t SrsHttpFileServer::serve_ts_ctx(ISrsHttpResponseWriter * w, ISrsHttp
     return serve_file(w, r, fullpath);
 }
 
+srs_error_t SrsHttpFileServer::serve_m4s_ctx(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, std::string fullpath)
+{
+    // @remark For common http file server, we don't support file in writing, please use SrsVodStream instead.
+    srs_warn("http miss file=%s, pattern=%s, upath=%s", fullpath.c_str(), entry->pattern.c_str(), r->path().c_str());
+    return SrsHttpNotFoundHandler().serve_http(w, r);
+}
+
 srs_error_t SrsHttpFileServer::copy(ISrsHttpResponseWriter* w, SrsFileReader* fs, ISrsHttpMessage* r, int64_t size)
 {
     srs_error_t err = srs_success;
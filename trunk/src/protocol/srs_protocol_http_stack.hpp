@@ -74,6 +74,13 @@ extern bool srs_go_http_body_allowd(int status);
 // returns "application/octet-stream".
 extern std::string srs_go_http_detect(char* data, int size);
 
+// Format the time as HTTP date, for example, Wed, 21 Oct 2015 07:28:00 GMT
+// @see https://www.rfc-editor.org/rfc/rfc7231#section-7.1.1.1
+extern std::string srs_http_format_date(time_t t);
+// Parse the HTTP date, in IMF-fixdate, or the obsolete RFC 850 and asctime formats.
+// @return false if the date is invalid.
+extern bool srs_http_parse_date(std::string date, time_t* pt);
+
 // The state of HTTP message
 enum SrsHttpParseState {
     SrsHttpParseStateInit = 0,
@@ -363,6 +370,11 @@ protected:
     // @param end the end offset in bytes. -1 to end of file.
     // @remark response data in [start, end].
     virtual srs_error_t serve_mp4_stream(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, std::string fullpath, int64_t start, int64_t end);
+    // When access mp4 file with x.mp4?start=seconds, to seek by time.
+    // @param time the time to seek to, starts from the keyframe at or before it.
+    // @param start the start offset in bytes of the seeked mp4, 0 for whole.
+    // @param end the end offset in bytes of the seeked mp4, -1 to end of file.
+    virtual srs_error_t serve_mp4_seek(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, std::string fullpath, srs_utime_t time, int64_t start, int64_t end);
     // For HLS protocol.
     // When the request url, like as "http://127.0.0.1:8080/live/livestream.m3u8", 
     // returns the response like as "http://127.0.0.1:8080/live/livestream.m3u8?hls_ctx=12345678" .
@@ -374,6 +386,8 @@ protected:
     //           If use two same "hls_ctx" in different requests, SRS cannot detect so that they will be treated as one.
     virtual srs_error_t serve_m3u8_ctx(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, std::string fullpath);
     virtual srs_error_t serve_ts_ctx(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, std::string fullpath);
+    // For low-latency DASH, the m4s file which does not exist yet, might be in writing.
+    virtual srs_error_t serve_m4s_ctx(ISrsHttpResponseWriter* w, ISrsHttpMessage* r, std::string fullpath);
 protected:
     // Copy the fs to response writer in size bytes.
     virtual srs_error_t copy(ISrsHttpResponseWriter* w, SrsFileReader* fs, ISrsHttpMessage* r, int64_t size);
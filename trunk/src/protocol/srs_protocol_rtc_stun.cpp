@@ -173,6 +173,16 @@ void SrsStunPacket::set_mapped_port(const uint32_t& port)
     mapped_port = port;
 }
 
+void SrsStunPacket::set_use_candidate(bool v)
+{
+    use_candidate = v;
+}
+
+void SrsStunPacket::set_ice_controlling(bool v)
+{
+    ice_controlling = v;
+}
+
 srs_error_t SrsStunPacket::decode(const char* buf, const int nb_buf)
 {
     srs_error_t err = srs_success;
@@ -258,6 +268,10 @@ srs_error_t SrsStunPacket::encode(const string& pwd, SrsBuffer* stream)
         return encode_binding_response(pwd, stream);
     }
 
+    if (is_binding_request()) {
+        return encode_binding_request(pwd, stream);
+    }
+
     return srs_error_new(ERROR_RTC_STUN, "unknown stun type=%d", get_message_type());
 }
 
@@ -303,6 +317,57 @@ srs_error_t SrsStunPacket::encode_binding_response(const string& pwd, SrsBuffer*
     return err;
 }
 
+srs_error_t SrsStunPacket::encode_binding_request(const string& pwd, SrsBuffer* stream)
+{
+    srs_error_t err = srs_success;
+
+    string property_username = encode_username();
+
+    stream->write_2bytes(BindingRequest);
+    stream->write_2bytes(0);
+    stream->write_4bytes(kStunMagicCookie);
+    stream->write_string(transcation_id);
+    stream->write_string(property_username);
+
+    if (use_candidate) {
+        stream->write_2bytes(UseCandidate);
+        stream->write_2bytes(0);
+    }
+
+    // The tie-breaker of ICE role, we always use zero because there is only one controlling agent.
+    if (ice_controlling) {
+        stream->write_2bytes(IceControlling);
+        stream->write_2bytes(8);
+        stream->write_8bytes(0);
+    }
+
+    stream->data()[2] = ((stream->pos() - 20 + 20 + 4) & 0x0000FF00) >> 8;
+    stream->data()[3] = ((stream->pos() - 20 + 20 + 4) & 0x000000FF);
+
+    char hmac_buf[20] = {0};
+    unsigned int hmac_buf_len = 0;
+    if ((err = hmac_encode("sha1", pwd.c_str(), pwd.size(), stream->data(), stream->pos(), hmac_buf, hmac_buf_len)) != srs_success) {
+        return srs_error_wrap(err, "hmac encode failed");
+    }
+
+    string hmac = encode_hmac(hmac_buf, hmac_buf_len);
+
+    stream->write_string(hmac);
+    stream->data()[2] = ((stream->pos() - 20 + 8) & 0x0000FF00) >> 8;
+    stream->data()[3] = ((stream->pos() - 20 + 8) & 0x000000FF);
+
+    uint32_t crc32 = srs_crc32_ieee(stream->data(), stream->pos(), 0) ^ 0x5354554E;
+
+    string fingerprint = encode_fingerprint(crc32);
+
+    stream->write_string(fingerprint);
+
+    stream->data()[2] = ((stream->pos() - 20) & 0x0000FF00) >> 8;
+    stream->data()[3] = ((stream->pos() - 20) & 0x000000FF);
+
+    return err;
+}
+
 string SrsStunPacket::encode_username()
 {
     char buf[1460];
@@ -94,10 +94,14 @@ public:
     void set_transcation_id(const std::string& t);
     void set_mapped_address(const uint32_t& addr);
     void set_mapped_port(const uint32_t& port);
+    void set_use_candidate(bool v);
+    void set_ice_controlling(bool v);
     srs_error_t decode(const char* buf, const int nb_buf);
     srs_error_t encode(const std::string& pwd, SrsBuffer* stream);
 private:
     srs_error_t encode_binding_response(const std::string& pwd, SrsBuffer* stream);
+    // Encode the binding request, as ICE controlling agent, for example, the client to benchmark server.
+    srs_error_t encode_binding_request(const std::string& pwd, SrsBuffer* stream);
     std::string encode_username();
     std::string encode_mapped_address();
     std::string encode_hmac(char* hamc_buf, const int hmac_buf_len);
@@ -49,6 +49,11 @@ SrsAmf0Object* SrsBasicRtmpClient::extra_args()
     return req->args;
 }
 
+void SrsBasicRtmpClient::set_unix_path(string path)
+{
+    unix_path_ = path;
+}
+
 srs_error_t SrsBasicRtmpClient::connect()
 {
     srs_error_t err = srs_success;
@@ -56,6 +61,9 @@ srs_error_t SrsBasicRtmpClient::connect()
     close();
     
     transport = new SrsTcpClient(req->host, req->port, srs_utime_t(connect_timeout));
+    if (!unix_path_.empty()) {
+        transport->set_unix_path(unix_path_);
+    }
     client = new SrsRtmpClient(transport);
     kbps->set_io(transport, transport);
 
@@ -41,6 +41,8 @@ private:
     SrsRtmpClient* client;
     SrsNetworkKbps* kbps;
     int stream_id;
+    // If not empty, connect to the unix domain socket path, rather than the host of url.
+    std::string unix_path_;
 public:
     // Constructor.
     // @param r The RTMP url, for example, rtmp://ip:port/app/stream?domain=vhost
@@ -51,6 +53,8 @@ public:
 public:
     // Get extra args to carry more information.
     SrsAmf0Object* extra_args();
+    // Connect to server by unix domain socket, while the url is still used for RTMP connect app.
+    void set_unix_path(std::string path);
 public:
     // Connect, handshake and connect app to RTMP server.
     // @remark We always close the transport.
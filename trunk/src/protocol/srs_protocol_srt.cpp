@@ -7,12 +7,16 @@
 #include <srs_protocol_srt.hpp>
 
 #include <sstream>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
 
 using namespace std;
 
 #include <srs_kernel_error.hpp>
 #include <srs_kernel_log.hpp>
 #include <srs_core_autofree.hpp>
+#include <srs_core_performance.hpp>
 
 #include <srt/srt.h>
 
@@ -532,22 +536,66 @@ public:
     srs_error_t mod_socket(SrsSrtSocket* srt_skt);
     srs_error_t del_socket(SrsSrtSocket* srt_skt);
     srs_error_t wait(int timeout_ms, int* pn_fds);
+    srs_error_t wait_fired(srs_utime_t timeout, int* pn_fds);
 public:
     virtual int size();
+private:
+    srs_error_t start_worker();
+    static void* worker_pfn(void* arg);
+    void worker_cycle();
 private:
     // Find SrsSrtSocket* context by srs_srt_t.
     std::map<srs_srt_t, SrsSrtSocket*> fd_sockets_;
     int srt_epoller_fd_;
     std::vector<SRT_EPOLL_EVENT> events_;
+private:
+    // The worker thread, which blocks on the SRT epoll for ST, because it's not a system fd. When any SRT socket
+    // is fired, it writes the pipe to wake the ST thread, then waits to be armed again by ST, after the fired sockets
+    // are notified and their coroutines have run, because the SRT epoll is level triggered.
+    pthread_t worker_;
+    bool worker_started_;
+    // The pipe to wake ST, the read end is opened as ST fd.
+    int pipes_[2];
+    srs_netfd_t pipe_stfd_;
+    // Protect the state shared with the worker thread.
+    pthread_mutex_t lock_;
+    pthread_cond_t cond_;
+    bool armed_;
+    bool quit_;
 };
 
 SrsSrtPoller::SrsSrtPoller()
 {
     srt_epoller_fd_ = -1;
+
+    worker_started_ = false;
+    pipes_[0] = pipes_[1] = -1;
+    pipe_stfd_ = NULL;
+    pthread_mutex_init(&lock_, NULL);
+    pthread_cond_init(&cond_, NULL);
+    armed_ = false;
+    quit_ = false;
 }
 
 SrsSrtPoller::~SrsSrtPoller()
 {
+    if (worker_started_) {
+        pthread_mutex_lock(&lock_);
+        quit_ = true;
+        pthread_cond_signal(&cond_);
+        pthread_mutex_unlock(&lock_);
+
+        pthread_join(worker_, NULL);
+    }
+
+    srs_close_stfd(pipe_stfd_);
+    if (pipes_[1] >= 0) {
+        ::close(pipes_[1]);
+    }
+
+    pthread_cond_destroy(&cond_);
+    pthread_mutex_destroy(&lock_);
+
     if (srt_epoller_fd_ > 0) {
         srt_epoll_release(srt_epoller_fd_);
     }
@@ -628,6 +676,10 @@ srs_error_t SrsSrtPoller::wait(int timeout_ms, int* pn_fds)
         // notify error, don't notify read/write event.
         if (event.events & SRT_EPOLL_ERR) {
             srt_skt->notify_error();
+
+            // The error is level triggered and never cleared, so unsubscribe the socket to fire it only once, or the
+            // poller spins on an idle socket with error. It's subscribed again when enable events.
+            srt_epoll_remove_usock(srt_epoller_fd_, event.fd);
         } else {
             if (event.events & SRT_EPOLL_IN) {
                 srt_skt->notify_readable();
@@ -641,6 +693,116 @@ srs_error_t SrsSrtPoller::wait(int timeout_ms, int* pn_fds)
     return err;
 }
 
+srs_error_t SrsSrtPoller::wait_fired(srs_utime_t timeout, int* pn_fds)
+{
+    srs_error_t err = srs_success;
+
+    *pn_fds = 0;
+
+    if (!worker_started_ && (err = start_worker()) != srs_success) {
+        return srs_error_wrap(err, "start worker");
+    }
+
+    // Arm the worker to wait for the SRT epoll.
+    pthread_mutex_lock(&lock_);
+    armed_ = true;
+    pthread_cond_signal(&cond_);
+    pthread_mutex_unlock(&lock_);
+
+    // Yield to other coroutines, until the worker wakes us.
+    char buf[64];
+    ssize_t nn = srs_read(pipe_stfd_, buf, sizeof(buf), timeout);
+    if (nn <= 0) {
+        if (errno == ETIME) {
+            return err;
+        }
+        if (errno == EINTR) {
+            return srs_error_new(ERROR_SRT_INTERRUPT, "srt poller interrupted");
+        }
+        return srs_error_new(ERROR_SRT_EPOLL, "srt poller read pipe, nn=%d", (int)nn);
+    }
+
+    // Now there must be some fired sockets, notify them without blocking.
+    if ((err = wait(0, pn_fds)) != srs_success) {
+        return srs_error_wrap(err, "notify sockets");
+    }
+
+    // Yield to the notified coroutines to drain their sockets, before the worker is armed again by the next round,
+    // because the SRT epoll is level triggered, or the worker is fired again by the same events.
+    if (*pn_fds > 0) {
+        srs_usleep(0);
+    }
+
+    return err;
+}
+
+srs_error_t SrsSrtPoller::start_worker()
+{
+    srs_error_t err = srs_success;
+
+    if (pipe(pipes_) < 0) {
+        return srs_error_new(ERROR_SYSTEM_CREATE_PIPE, "create pipe");
+    }
+
+    // Never block the worker when ST is slow to read the pipe, because one byte is enough to wake it.
+    int flags = fcntl(pipes_[1], F_GETFL, 0);
+    if (fcntl(pipes_[1], F_SETFL, flags | O_NONBLOCK) < 0) {
+        return srs_error_new(ERROR_SYSTEM_CREATE_PIPE, "set pipe nonblock");
+    }
+
+    if ((pipe_stfd_ = srs_netfd_open(pipes_[0])) == NULL) {
+        return srs_error_new(ERROR_SYSTEM_CREATE_PIPE, "open pipe fd=%d", pipes_[0]);
+    }
+
+    int r0 = pthread_create(&worker_, NULL, worker_pfn, this);
+    if (r0 != 0) {
+        return srs_error_new(ERROR_THREAD_CREATE, "create srt poller worker, r0=%d", r0);
+    }
+    worker_started_ = true;
+
+    return err;
+}
+
+void* SrsSrtPoller::worker_pfn(void* arg)
+{
+    SrsSrtPoller* poller = (SrsSrtPoller*)arg;
+    poller->worker_cycle();
+    return NULL;
+}
+
+// Note that it runs in the worker thread, so never use ST or log here.
+void SrsSrtPoller::worker_cycle()
+{
+    // The fired events are only used to detect readiness, the ST thread fetches them again to notify sockets.
+    std::vector<SRT_EPOLL_EVENT> events(events_.size());
+
+    pthread_mutex_lock(&lock_);
+    while (!quit_) {
+        if (!armed_) {
+            pthread_cond_wait(&cond_, &lock_);
+            continue;
+        }
+        pthread_mutex_unlock(&lock_);
+
+        // Wait with a timeout, to check the quit flag.
+        int ret = srt_epoll_uwait(srt_epoller_fd_, events.data(), events.size(), SRS_PERF_SRT_WORKER_WAIT_MS);
+
+        // Avoid busy loop if epoll fails, and let ST to report the error.
+        if (ret < 0) {
+            usleep(SRS_PERF_SRT_WORKER_WAIT_MS * 1000);
+        }
+
+        pthread_mutex_lock(&lock_);
+        if (ret != 0 && armed_) {
+            armed_ = false;
+            char v = 0;
+            ssize_t r0 = ::write(pipes_[1], &v, 1);
+            (void)r0;
+        }
+    }
+    pthread_mutex_unlock(&lock_);
+}
+
 int SrsSrtPoller::size()
 {
     return (int)fd_sockets_.size();
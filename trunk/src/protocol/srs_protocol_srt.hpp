@@ -103,8 +103,11 @@ public:
     virtual srs_error_t mod_socket(SrsSrtSocket* srt_skt) = 0;
     virtual srs_error_t del_socket(SrsSrtSocket* srt_skt) = 0;
     // Wait for the fds in its epoll to be fired in specified timeout_ms, where the pn_fds is the number of active fds.
-    // Note that for ST, please always use timeout_ms(0) and switch coroutine by yourself.
+    // Note that it blocks the whole ST thread, so for ST, please use timeout_ms(0) or wait_fired instead.
     virtual srs_error_t wait(int timeout_ms, int* pn_fds) = 0;
+    // Yield the coroutine until some fds in its epoll are fired or timeout, then notify the fired sockets, where the
+    // pn_fds is the number of active fds. The SRT epoll is waited by a worker thread, which wakes ST by a pipe.
+    virtual srs_error_t wait_fired(srs_utime_t timeout, int* pn_fds) = 0;
 public:
     virtual int size() = 0;
 };
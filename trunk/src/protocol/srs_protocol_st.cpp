@@ -9,6 +9,7 @@
 #include <st.h>
 #include <fcntl.h>
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <netdb.h>
 using namespace std;
 
@@ -355,6 +356,83 @@ srs_error_t srs_udp_listen(std::string ip, int port, srs_netfd_t* pfd)
     return err;
 }
 
+srs_error_t srs_unix_connect(std::string path, srs_utime_t tm, srs_netfd_t* pstfd)
+{
+    st_utime_t timeout = ST_UTIME_NO_TIMEOUT;
+    if (tm != SRS_UTIME_NO_TIMEOUT) {
+        timeout = tm;
+    }
+
+    *pstfd = NULL;
+
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.length() >= sizeof(addr.sun_path)) {
+        return srs_error_new(ERROR_SYSTEM_IP_INVALID, "invalid unix path %s", path.c_str());
+    }
+    memcpy(addr.sun_path, path.data(), path.length());
+
+    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(sock == -1){
+        return srs_error_new(ERROR_SOCKET_CREATE, "create socket");
+    }
+
+    srs_netfd_t stfd = st_netfd_open_socket(sock);
+    if(stfd == NULL){
+        ::close(sock);
+        return srs_error_new(ERROR_ST_OPEN_SOCKET, "open socket");
+    }
+
+    if (st_connect((st_netfd_t)stfd, (const sockaddr*)&addr, sizeof(addr), timeout) == -1){
+        srs_close_stfd(stfd);
+        return srs_error_new(ERROR_ST_CONNECT, "connect to unix:%s", path.c_str());
+    }
+
+    *pstfd = stfd;
+    return srs_success;
+}
+
+srs_error_t srs_unix_listen(std::string path, srs_netfd_t* pfd)
+{
+    srs_error_t err = srs_success;
+
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.length() >= sizeof(addr.sun_path)) {
+        return srs_error_new(ERROR_SYSTEM_IP_INVALID, "invalid unix path %s", path.c_str());
+    }
+    memcpy(addr.sun_path, path.data(), path.length());
+
+    int fd = 0;
+    if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) == -1) {
+        return srs_error_new(ERROR_SOCKET_CREATE, "socket domain=%d", AF_UNIX);
+    }
+
+    if ((err = srs_fd_closeexec(fd)) != srs_success) {
+        ::close(fd);
+        return srs_error_wrap(err, "set closeexec");
+    }
+
+    if (::bind(fd, (const sockaddr*)&addr, sizeof(addr)) == -1) {
+        ::close(fd);
+        return srs_error_new(ERROR_SOCKET_BIND, "bind unix:%s", path.c_str());
+    }
+
+    if (::listen(fd, SERVER_LISTEN_BACKLOG) == -1) {
+        ::close(fd);
+        return srs_error_new(ERROR_SOCKET_LISTEN, "listen unix:%s", path.c_str());
+    }
+
+    if ((*pfd = srs_netfd_open_socket(fd)) == NULL){
+        ::close(fd);
+        return srs_error_new(ERROR_ST_OPEN_SOCKET, "st open");
+    }
+
+    return err;
+}
+
 srs_cond_t srs_cond_new()
 {
     return (srs_cond_t)st_cond_new();
@@ -688,12 +766,21 @@ SrsTcpClient::~SrsTcpClient()
     srs_close_stfd(stfd_);
 }
 
+void SrsTcpClient::set_unix_path(string path)
+{
+    unix_path_ = path;
+}
+
 srs_error_t SrsTcpClient::connect()
 {
     srs_error_t err = srs_success;
     
     srs_netfd_t stfd = NULL;
-    if ((err = srs_tcp_connect(host, port, timeout, &stfd)) != srs_success) {
+    if (!unix_path_.empty()) {
+        if ((err = srs_unix_connect(unix_path_, timeout, &stfd)) != srs_success) {
+            return srs_error_wrap(err, "unix: connect %s to=%dms", unix_path_.c_str(), srsu2msi(timeout));
+        }
+    } else if ((err = srs_tcp_connect(host, port, timeout, &stfd)) != srs_success) {
         return srs_error_wrap(err, "tcp: connect %s:%d to=%dms", host.c_str(), port, srsu2msi(timeout));
     }
 
@@ -62,6 +62,13 @@ extern srs_error_t srs_tcp_listen(std::string ip, int port, srs_netfd_t* pfd);
 // For server, listen at UDP endpoint.
 extern srs_error_t srs_udp_listen(std::string ip, int port, srs_netfd_t* pfd);
 
+// For client, to open unix domain socket and connect to server, for local processes.
+// @param tm The timeout in srs_utime_t.
+extern srs_error_t srs_unix_connect(std::string path, srs_utime_t tm, srs_netfd_t* pstfd);
+
+// For server, listen at unix domain socket path, which should not exist.
+extern srs_error_t srs_unix_listen(std::string path, srs_netfd_t* pfd);
+
 // Wrap for coroutine.
 extern srs_cond_t srs_cond_new();
 extern int srs_cond_destroy(srs_cond_t cond);
@@ -172,6 +179,8 @@ private:
     int port;
     // The timeout in srs_utime_t.
     srs_utime_t timeout;
+    // If not empty, connect to the unix domain socket path, rather than host and port.
+    std::string unix_path_;
 public:
     // Constructor.
     // @param h the ip or hostname of server.
@@ -180,6 +189,8 @@ public:
     SrsTcpClient(std::string h, int p, srs_utime_t tm);
     virtual ~SrsTcpClient();
 public:
+    // Connect to the unix domain socket path, for server on the same box.
+    void set_unix_path(std::string path);
     // Connect to server over TCP.
     // @remark We will close the exists connection before do connect.
     virtual srs_error_t connect();
@@ -15,6 +15,20 @@ using namespace std;
 #include <srs_app_st.hpp>
 #include <srs_protocol_conn.hpp>
 #include <srs_app_conn.hpp>
+#include <srs_kernel_utility.hpp>
+#include <srs_app_threads.hpp>
+#include <srs_app_rtmp_conn.hpp>
+#include <srs_app_forward.hpp>
+#include <srs_app_coworkers.hpp>
+#include <srs_app_http_api.hpp>
+#include <srs_protocol_http_conn.hpp>
+#include <srs_utest_http.hpp>
+#include <srs_app_statistic.hpp>
+#include <srs_protocol_json.hpp>
+#include <srs_kernel_flv.hpp>
+#include <srs_core_autofree.hpp>
+#include <srs_utest_config.hpp>
+#include <srs_app_dash.hpp>
 
 class MockIDResource : public ISrsResource
 {
@@ -121,9 +135,184 @@ VOID TEST(AppResourceManagerTest, FindByFastID)
         SrsResourceManager m("test");
         HELPER_EXPECT_SUCCESS(m.start());
 
-        m.add_with_fast_id(101, new MockIDResource(1));
-        m.add_with_fast_id(101, new MockIDResource(4));
-        EXPECT_EQ(1, ((MockIDResource*)m.find_by_fast_id(101))->id);
+        // The last one wins, and the overwrote one never removes the key of others.
+        MockIDResource* r1 = new MockIDResource(1);
+        MockIDResource* r4 = new MockIDResource(4);
+        m.add_with_fast_id(101, r1);
+        m.add_with_fast_id(102, r1);
+        m.add_with_fast_id(101, r4);
+        EXPECT_EQ(4, ((MockIDResource*)m.find_by_fast_id(101))->id);
+        EXPECT_EQ(1, ((MockIDResource*)m.find_by_fast_id(102))->id);
+
+        m.remove(r1); srs_usleep(0);
+        EXPECT_EQ(4, ((MockIDResource*)m.find_by_fast_id(101))->id);
+        EXPECT_TRUE(m.find_by_fast_id(102) == NULL);
+
+        m.remove(r4); srs_usleep(0);
+        EXPECT_TRUE(m.find_by_fast_id(101) == NULL);
+    }
+}
+
+VOID TEST(AppResourceManagerTest, FindByAddressAndName)
+{
+    srs_error_t err = srs_success;
+
+    // The IPv6 address with the same port, should never be confused.
+    if (true) {
+        SrsResourceManager m("test");
+        HELPER_EXPECT_SUCCESS(m.start());
+
+        SrsResourceFastKey k0, k1, k2;
+        k0.id = k1.id = k2.id = uint64_t(8000)<<16 | AF_INET6;
+        k0.addr[0] = 0x20010db8; k0.addr[1] = 1;
+        k1.addr[0] = 0x20010db8; k1.addr[1] = 2;
+        k2.addr[0] = 0x20010db9; k2.addr[1] = 1;
+
+        MockIDResource* r0 = new MockIDResource(0);
+        MockIDResource* r1 = new MockIDResource(1);
+        m.add_with_fast_id(k0, r0);
+        m.add_with_fast_id(k1, r1);
+        EXPECT_EQ(0, ((MockIDResource*)m.find_by_fast_id(k0))->id);
+        EXPECT_EQ(1, ((MockIDResource*)m.find_by_fast_id(k1))->id);
+        EXPECT_TRUE(m.find_by_fast_id(k2) == NULL);
+        EXPECT_TRUE(m.find_by_fast_id(k0.id) == NULL);
+
+        m.remove(r0); srs_usleep(0);
+        EXPECT_TRUE(m.find_by_fast_id(k0) == NULL);
+        EXPECT_EQ(1, ((MockIDResource*)m.find_by_fast_id(k1))->id);
+    }
+
+    // The name is overwrote by the last one, and removed with resource.
+    if (true) {
+        SrsResourceManager m("test");
+        HELPER_EXPECT_SUCCESS(m.start());
+
+        MockIDResource* r0 = new MockIDResource(0);
+        MockIDResource* r1 = new MockIDResource(1);
+        m.add_with_name("abc:def", r0);
+        m.add_with_id("127.0.0.1:8000", r0);
+        m.add_with_name("abc:def", r1);
+        EXPECT_EQ(1, ((MockIDResource*)m.find_by_name("abc:def"))->id);
+        EXPECT_EQ(0, ((MockIDResource*)m.find_by_id("127.0.0.1:8000"))->id);
+        EXPECT_TRUE(m.find_by_name("abc:de") == NULL);
+
+        m.remove(r0); srs_usleep(0);
+        EXPECT_TRUE(m.find_by_id("127.0.0.1:8000") == NULL);
+        EXPECT_EQ(1, ((MockIDResource*)m.find_by_name("abc:def"))->id);
+    }
+}
+
+VOID TEST(AppResourceManagerTest, FastTableGrowAndErase)
+{
+    SrsResourceFastTable<SrsResourceFastKey> table;
+    vector<MockIDResource*> resources;
+    for (int i = 0; i < 1000; i++) {
+        resources.push_back(new MockIDResource(i));
+    }
+
+    // Keep adding and erasing, to build lots of deleted slots and rehash.
+    for (int round = 0; round < 10; round++) {
+        for (int i = 0; i < 1000; i++) {
+            table.set(SrsResourceFastKey(uint64_t(i)<<32 | round), resources[i]);
+        }
+        EXPECT_EQ(1000, table.size());
+
+        for (int i = 0; i < 1000; i++) {
+            MockIDResource* r = (MockIDResource*)table.find(SrsResourceFastKey(uint64_t(i)<<32 | round));
+            ASSERT_TRUE(r != NULL);
+            EXPECT_EQ(i, r->id);
+            EXPECT_TRUE(table.find(SrsResourceFastKey(uint64_t(i)<<32 | (round + 1))) == NULL);
+        }
+
+        for (int i = 0; i < 1000; i += 2) {
+            table.erase(resources[i]);
+        }
+        EXPECT_EQ(500, table.size());
+
+        for (int i = 0; i < 1000; i++) {
+            ISrsResource* r = table.find(SrsResourceFastKey(uint64_t(i)<<32 | round));
+            EXPECT_TRUE((i % 2) ? r == resources[i] : r == NULL);
+        }
+
+        for (int i = 1; i < 1000; i += 2) {
+            table.erase(resources[i]);
+        }
+        EXPECT_EQ(0, table.size());
+    }
+
+    for (int i = 0; i < 1000; i++) {
+        srs_freep(resources[i]);
+    }
+}
+
+// The microbenchmark of lookup with 100k sessions, compare the fast table to std::map and the peer id string.
+VOID TEST(AppResourceManagerTest, FastTableBenchmark)
+{
+    const int nn_sessions = 100000;
+    const int nn_lookups = 200000;
+
+    vector<MockIDResource*> resources;
+    vector<SrsResourceFastKey> keys;
+    vector<string> ids;
+
+    SrsResourceFastTable<SrsResourceFastKey> table;
+    map<uint64_t, ISrsResource*> fast_ids;
+    map<string, ISrsResource*> peer_ids;
+
+    for (int i = 0; i < nn_sessions; i++) {
+        // The random IPv4 address and port.
+        uint32_t ip = (uint32_t)random();
+        uint16_t port = (uint16_t)random();
+        SrsResourceFastKey key(uint64_t(port)<<48 | uint64_t(ip));
+
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%d.%d.%d.%d:%d", ip & 0xff, (ip >> 8) & 0xff, (ip >> 16) & 0xff, ip >> 24, port);
+
+        MockIDResource* r = new MockIDResource(i);
+        resources.push_back(r);
+        keys.push_back(key);
+        ids.push_back(buf);
+
+        table.set(key, r, false);
+        fast_ids[key.id] = r;
+        peer_ids[buf] = r;
+    }
+
+    // Lookup the random sessions, like packets from many clients.
+    vector<int> indexes;
+    for (int i = 0; i < nn_lookups; i++) {
+        indexes.push_back((int)(random() % nn_sessions));
+    }
+
+    int nn_found = 0;
+    srs_utime_t starttime = srs_update_system_time();
+    for (int i = 0; i < nn_lookups; i++) {
+        nn_found += (table.find(keys[indexes[i]]) != NULL);
+    }
+    srs_utime_t table_cost = srs_update_system_time() - starttime;
+    EXPECT_EQ(nn_lookups, nn_found);
+
+    nn_found = 0;
+    starttime = srs_update_system_time();
+    for (int i = 0; i < nn_lookups; i++) {
+        nn_found += (fast_ids.find(keys[indexes[i]].id) != fast_ids.end());
+    }
+    srs_utime_t map_cost = srs_update_system_time() - starttime;
+    EXPECT_EQ(nn_lookups, nn_found);
+
+    nn_found = 0;
+    starttime = srs_update_system_time();
+    for (int i = 0; i < nn_lookups; i++) {
+        nn_found += (peer_ids.find(ids[indexes[i]]) != peer_ids.end());
+    }
+    srs_utime_t str_cost = srs_update_system_time() - starttime;
+    EXPECT_EQ(nn_lookups, nn_found);
+
+    printf("lookup %d sessions by %d times, table=%dms, map=%dms, string=%dms\n", nn_sessions, nn_lookups,
+        srsu2msi(table_cost), srsu2msi(map_cost), srsu2msi(str_cost));
+
+    for (int i = 0; i < nn_sessions; i++) {
+        srs_freep(resources[i]);
     }
 }
 
@@ -512,6 +701,186 @@ VOID TEST(AppFragmentTest, CheckDuration)
 	}
 }
 
+VOID TEST(AppAsyncFileTest, ExecuteInCallerThread)
+{
+    srs_error_t err;
+
+    // Not started, so execute the task in caller thread.
+    SrsAsyncFileWorker worker;
+
+    string path = _srs_tmp_file_prefix + "app-async-file.m3u8";
+    string target = _srs_tmp_file_prefix + "app-async-file2.m3u8";
+
+    string data = "#EXTM3U\n";
+    HELPER_EXPECT_SUCCESS(worker.write(path, data));
+    EXPECT_TRUE(data.empty());
+    EXPECT_TRUE(srs_path_exists(path));
+    EXPECT_FALSE(srs_path_exists(path + ".temp"));
+
+    HELPER_EXPECT_SUCCESS(worker.rename(path, target));
+    EXPECT_FALSE(srs_path_exists(path));
+    EXPECT_TRUE(srs_path_exists(target));
+
+    HELPER_EXPECT_SUCCESS(worker.unlink(target));
+    EXPECT_FALSE(srs_path_exists(target));
+    HELPER_EXPECT_FAILED(worker.unlink(target));
+
+    int pending = 0;
+    int64_t nn_tasks = 0, nn_errors = 0, nn_dropped = 0;
+    srs_utime_t avg_latency = 0, max_latency = 0;
+    worker.dumps(&pending, &nn_tasks, &nn_errors, &nn_dropped, &avg_latency, &max_latency);
+    EXPECT_EQ(0, pending);
+    EXPECT_EQ(4, nn_tasks);
+    EXPECT_EQ(1, nn_errors);
+    EXPECT_EQ(0, nn_dropped);
+    EXPECT_LE(avg_latency, max_latency);
+}
+
+VOID TEST(AppAsyncFileTest, CoalesceAndDrop)
+{
+    srs_error_t err;
+
+    // Pretend the thread is started but never consumes the tasks.
+    SrsAsyncFileWorker worker;
+    worker.started_ = true;
+
+    string path = _srs_tmp_file_prefix + "app-async-coalesce.m3u8";
+    string seg = _srs_tmp_file_prefix + "app-async-coalesce-0.ts";
+
+    // The pending write to the same file is overwritten, and keep the order.
+    string v0 = "v0", v1 = "v1", v2 = "v2";
+    HELPER_EXPECT_SUCCESS(worker.write(path, v0));
+    HELPER_EXPECT_SUCCESS(worker.unlink(seg));
+    HELPER_EXPECT_SUCCESS(worker.write(path, v1));
+    ASSERT_EQ(2, (int)worker.tasks_.size());
+    EXPECT_EQ(SrsAsyncFileTypeWrite, worker.tasks_.at(0)->type);
+    EXPECT_STREQ("v1", worker.tasks_.at(0)->data.c_str());
+    EXPECT_EQ(SrsAsyncFileTypeUnlink, worker.tasks_.at(1)->type);
+
+    // Drop the task when queue is full, never wait.
+    for (int i = (int)worker.tasks_.size(); i < SRS_PERF_ASYNC_FILE_TASKS; i++) {
+        worker.tasks_.push_back(new SrsAsyncFileTask(SrsAsyncFileTypeUnlink, seg));
+    }
+    HELPER_EXPECT_SUCCESS(worker.unlink(seg));
+    HELPER_EXPECT_SUCCESS(worker.write(path, v2));
+    EXPECT_EQ(SRS_PERF_ASYNC_FILE_TASKS, (int)worker.tasks_.size());
+    EXPECT_STREQ("v2", worker.tasks_.at(0)->data.c_str());
+
+    int pending = 0;
+    int64_t nn_tasks = 0, nn_errors = 0, nn_dropped = 0;
+    srs_utime_t avg_latency = 0, max_latency = 0;
+    worker.dumps(&pending, &nn_tasks, &nn_errors, &nn_dropped, &avg_latency, &max_latency);
+    EXPECT_EQ(SRS_PERF_ASYNC_FILE_TASKS, pending);
+    EXPECT_EQ(1, nn_dropped);
+
+    // Free the pending tasks without the thread.
+    worker.started_ = false;
+}
+
+VOID TEST(AppAsyncFileTest, ReportErrorByPipe)
+{
+    srs_error_t err;
+
+    SrsAsyncFileWorker* worker = new SrsAsyncFileWorker();
+    SrsAutoFree(SrsAsyncFileWorker, worker);
+    HELPER_EXPECT_SUCCESS(worker->start());
+
+    // The error of worker thread is never returned to caller, but drained by the dispatcher.
+    string path = _srs_tmp_file_prefix + "app-async-not-exists.ts";
+    HELPER_EXPECT_SUCCESS(worker->unlink(path));
+    EXPECT_TRUE(worker->trd_ != NULL);
+
+    int64_t nn_errors = 0;
+    for (int i = 0; i < 100; i++) {
+        srs_usleep(10 * SRS_UTIME_MILLISECONDS);
+
+        int pending = 0;
+        int64_t nn_tasks = 0, nn_dropped = 0;
+        srs_utime_t avg_latency = 0, max_latency = 0;
+        worker->dumps(&pending, &nn_tasks, &nn_errors, &nn_dropped, &avg_latency, &max_latency);
+
+        pthread_mutex_lock(&worker->lock_);
+        bool drained = worker->errors_.empty();
+        pthread_mutex_unlock(&worker->lock_);
+
+        if (nn_errors == 1 && drained) {
+            break;
+        }
+    }
+    EXPECT_EQ(1, nn_errors);
+    EXPECT_TRUE(worker->errors_.empty());
+}
+
+class MockDashPartialWaiter : public ISrsCoroutineHandler
+{
+public:
+    SrsDashPartialFragments* partials;
+    std::string path;
+    // Whether wakeup before timeout.
+    bool woken;
+public:
+    MockDashPartialWaiter(SrsDashPartialFragments* p, std::string v) : partials(p), path(v), woken(false) {
+    }
+public:
+    virtual srs_error_t cycle() {
+        srs_utime_t starttime = srs_update_system_time();
+        partials->wait(path, 300 * SRS_UTIME_MILLISECONDS);
+        woken = srs_update_system_time() - starttime < 200 * SRS_UTIME_MILLISECONDS;
+        return srs_success;
+    }
+};
+
+VOID TEST(AppDashTest, PartialWaitPerFragment)
+{
+    srs_error_t err;
+
+    SrsDashPartialFragments partials;
+    partials.update("./objs/nginx/html//live/livestream-0.m4s", "livestream-0.m4s.tmp", 100);
+    partials.update("./objs/nginx/html/live/livestream-1.m4s", "livestream-1.m4s.tmp", 100);
+
+    // Only wakeup the players of the updated fragment.
+    if (true) {
+        MockDashPartialWaiter w0(&partials, "./objs/nginx/html/live/livestream-0.m4s");
+        MockDashPartialWaiter w1(&partials, "./objs/nginx/html/live/livestream-1.m4s");
+        SrsSTCoroutine trd0("dash0", &w0), trd1("dash1", &w1);
+        HELPER_EXPECT_SUCCESS(trd0.start());
+        HELPER_EXPECT_SUCCESS(trd1.start());
+        srs_usleep(10 * SRS_UTIME_MILLISECONDS);
+
+        partials.update("./objs/nginx/html/live/livestream-0.m4s", "livestream-0.m4s.tmp", 200);
+        srs_usleep(400 * SRS_UTIME_MILLISECONDS);
+        EXPECT_TRUE(w0.woken);
+        EXPECT_FALSE(w1.woken);
+    }
+
+    // The removed fragment is freed by the last waiting player.
+    if (true) {
+        MockDashPartialWaiter w0(&partials, "./objs/nginx/html/live/livestream-1.m4s");
+        MockDashPartialWaiter w1(&partials, "./objs/nginx/html/live/livestream-1.m4s");
+        SrsSTCoroutine trd0("dash0", &w0), trd1("dash1", &w1);
+        HELPER_EXPECT_SUCCESS(trd0.start());
+        HELPER_EXPECT_SUCCESS(trd1.start());
+        srs_usleep(10 * SRS_UTIME_MILLISECONDS);
+
+        SrsDashPartialFragment* fragment = partials.fetch("./objs/nginx/html/live/livestream-1.m4s");
+        ASSERT_TRUE(fragment != NULL);
+        EXPECT_EQ(2, fragment->nn_waiters_);
+
+        partials.remove("./objs/nginx/html/live/livestream-1.m4s");
+        EXPECT_TRUE(partials.fetch("./objs/nginx/html/live/livestream-1.m4s") == NULL);
+        srs_usleep(10 * SRS_UTIME_MILLISECONDS);
+        EXPECT_TRUE(w0.woken);
+        EXPECT_TRUE(w1.woken);
+    }
+
+    // Return immediately if not in writing.
+    if (true) {
+        srs_utime_t starttime = srs_update_system_time();
+        partials.wait("./objs/nginx/html/live/livestream-1.m4s", 300 * SRS_UTIME_MILLISECONDS);
+        EXPECT_LT(srs_update_system_time() - starttime, 100 * SRS_UTIME_MILLISECONDS);
+    }
+}
+
 VOID TEST(AppSecurity, CheckSecurity)
 {
     srs_error_t err;
@@ -783,3 +1152,422 @@ VOID TEST(AppSecurity, CheckSecurity)
     //       4. deny if matches deny strategy.
 }
 
+
+VOID TEST(AppCasterPublisherTest, LocalRtmpUrl)
+{
+    srs_error_t err;
+
+    MockSrsConfig conf;
+    HELPER_ASSERT_SUCCESS(conf.parse(_MIN_OK_CONF "vhost __defaultVhost__ {} vhost edge.ossrs.net {cluster {mode remote; origin 127.0.0.1:19350;}}"));
+
+    SrsConfig* saved = _srs_config;
+    _srs_config = &conf;
+
+    // Served by this server, publish in process.
+    bool v0 = srs_rtmp_url_is_local("rtmp://127.0.0.1/live/livestream");
+    bool v1 = srs_rtmp_url_is_local("rtmp://127.0.0.1:1935/live/livestream");
+    bool v2 = srs_rtmp_url_is_local("rtmp://localhost/live/livestream?vhost=__defaultVhost__");
+
+    // Not listened port, remote server or edge vhost, publish by RTMP client.
+    bool v3 = srs_rtmp_url_is_local("rtmp://127.0.0.1:19350/live/livestream");
+    bool v4 = srs_rtmp_url_is_local("rtmp://8.8.8.8/live/livestream");
+    bool v5 = srs_rtmp_url_is_local("rtmp://127.0.0.1/live/livestream?vhost=edge.ossrs.net");
+    bool v6 = srs_rtmp_url_is_local("http://127.0.0.1:1935/live/livestream.flv");
+
+    _srs_config = saved;
+
+    EXPECT_TRUE(v0);
+    EXPECT_TRUE(v1);
+    EXPECT_TRUE(v2);
+    EXPECT_FALSE(v3);
+    EXPECT_FALSE(v4);
+    EXPECT_FALSE(v5);
+    EXPECT_FALSE(v6);
+}
+
+SrsSharedPtrMessage* mock_forward_message(bool video, bool keyframe, int64_t timestamp)
+{
+    SrsMessageHeader h;
+    if (video) {
+        h.initialize_video(2, (uint32_t)timestamp, 1);
+    } else {
+        h.initialize_audio(2, (uint32_t)timestamp, 1);
+    }
+
+    // The AVC NALU or AAC raw, never the sequence header.
+    char* payload = new char[2];
+    payload[0] = video ? (keyframe ? 0x17 : 0x27) : (char)0xaf;
+    payload[1] = 0x01;
+
+    SrsSharedPtrMessage* msg = new SrsSharedPtrMessage();
+    msg->create(&h, payload, 2);
+    return msg;
+}
+
+void mock_forward_push(SrsForwardRing* ring, bool video, bool keyframe, int64_t timestamp)
+{
+    SrsSharedPtrMessage* msg = mock_forward_message(video, keyframe, timestamp);
+    ring->push(msg);
+    srs_freep(msg);
+}
+
+void mock_forward_dump(SrsForwardRing* ring, SrsForwardCursor* cursor, int max, int& count, int64_t& first)
+{
+    SrsSharedPtrMessage** msgs = new SrsSharedPtrMessage*[max];
+    ring->dump(cursor, max, msgs, count);
+
+    first = count ? msgs[0]->timestamp : -1;
+    for (int i = 0; i < count; i++) {
+        srs_freep(msgs[i]);
+    }
+    srs_freepa(msgs);
+}
+
+VOID TEST(AppForwardRingTest, SharedByCursors)
+{
+    int count = 0;
+    int64_t first = 0;
+
+    // Each cursor reads all messages, which are released when consumed by all cursors.
+    if (true) {
+        SrsForwardRing ring;
+        SrsForwardCursor c0(&ring), c1(&ring);
+
+        mock_forward_push(&ring, false, false, 0);
+        mock_forward_push(&ring, false, false, 20);
+        EXPECT_EQ(2, ring.size());
+
+        mock_forward_dump(&ring, &c0, 10, count, first);
+        EXPECT_EQ(2, count);
+        EXPECT_EQ(0, first);
+        EXPECT_EQ(2, ring.size());
+
+        mock_forward_dump(&ring, &c1, 1, count, first);
+        EXPECT_EQ(1, count);
+        EXPECT_EQ(1, ring.size());
+
+        mock_forward_dump(&ring, &c1, 10, count, first);
+        EXPECT_EQ(1, count);
+        EXPECT_EQ(20, first);
+        EXPECT_EQ(0, ring.size());
+    }
+
+    // Keep messages from the latest keyframe, and the new cursor starts from it.
+    if (true) {
+        SrsForwardRing ring;
+        mock_forward_push(&ring, true, true, 0);
+        mock_forward_push(&ring, true, false, 40);
+        mock_forward_push(&ring, true, true, 80);
+        mock_forward_push(&ring, true, false, 120);
+        EXPECT_EQ(2, ring.size());
+
+        SrsForwardCursor c0(&ring);
+        mock_forward_dump(&ring, &c0, 10, count, first);
+        EXPECT_EQ(2, count);
+        EXPECT_EQ(80, first);
+    }
+}
+
+VOID TEST(AppForwardRingTest, LaggedCursor)
+{
+    srs_error_t err = srs_success;
+
+    int count = 0;
+    int64_t first = 0;
+
+    // Drop the messages exceed the queue size, and skip to the latest keyframe.
+    if (true) {
+        SrsForwardRing ring;
+        ring.set_queue_size(1 * SRS_UTIME_SECONDS);
+
+        SrsForwardCursor c0(&ring);
+        for (int i = 0; i < 50; i++) {
+            mock_forward_push(&ring, true, i % 10 == 0, i * 40);
+        }
+        EXPECT_TRUE(ring.lagged(&c0));
+
+        ring.skip(&c0);
+        EXPECT_FALSE(ring.lagged(&c0));
+        mock_forward_dump(&ring, &c0, 100, count, first);
+        EXPECT_EQ(10, count);
+        EXPECT_EQ(1600, first);
+    }
+
+    // Drop the oldest messages when ring is full.
+    if (true) {
+        SrsForwardRing ring(4);
+
+        SrsForwardCursor c0(&ring);
+        for (int i = 0; i < 6; i++) {
+            mock_forward_push(&ring, false, false, i * 20);
+        }
+        EXPECT_EQ(4, ring.size());
+        EXPECT_TRUE(ring.lagged(&c0));
+
+        mock_forward_dump(&ring, &c0, 100, count, first);
+        EXPECT_EQ(4, count);
+        EXPECT_EQ(40, first);
+        EXPECT_FALSE(ring.lagged(&c0));
+    }
+
+    // Free all messages when unpublish.
+    if (true) {
+        SrsForwardRing ring;
+        ring.set_queue_size(1 * SRS_UTIME_SECONDS);
+        mock_forward_push(&ring, true, true, 0);
+        mock_forward_push(&ring, true, false, 5000);
+        ring.clear();
+        EXPECT_EQ(0, ring.size());
+        EXPECT_EQ(0, ring.last_timestamp_);
+
+        SrsForwardCursor c0(&ring);
+        mock_forward_dump(&ring, &c0, 10, count, first);
+        EXPECT_EQ(0, count);
+
+        // The timestamp restarts when republish, the metadata should not be expired by the stale timestamp.
+        if (true) {
+            SrsMessageHeader h;
+            h.initialize_amf0_script(2, 1);
+            char* payload = new char[2];
+            payload[0] = payload[1] = 0x02;
+
+            SrsSharedPtrMessage msg;
+            HELPER_EXPECT_SUCCESS(msg.create(&h, payload, 2));
+            ring.push(&msg);
+        }
+        mock_forward_push(&ring, true, true, 0);
+        EXPECT_EQ(2, ring.size());
+        mock_forward_dump(&ring, &c0, 10, count, first);
+        EXPECT_EQ(2, count);
+        EXPECT_EQ(0, first);
+    }
+}
+
+SrsJsonObject* mock_coworkers_directory(string epoch, int64_t version, int64_t since, string action, string stream)
+{
+    SrsJsonObject* obj = SrsJsonAny::object();
+    obj->set("epoch", SrsJsonAny::str(epoch.c_str()));
+    obj->set("version", SrsJsonAny::integer(version));
+    if (since >= 0) {
+        obj->set("since", SrsJsonAny::integer(since));
+    } else {
+        obj->set("full", SrsJsonAny::boolean(true));
+    }
+
+    SrsJsonArray* arr = SrsJsonAny::array();
+    obj->set("streams", arr);
+    if (!stream.empty()) {
+        arr->append(SrsJsonAny::object()
+            ->set("action", SrsJsonAny::str(action.c_str()))
+            ->set("vhost", SrsJsonAny::str("__defaultVhost__"))
+            ->set("app", SrsJsonAny::str("live"))
+            ->set("stream", SrsJsonAny::str(stream.c_str()))
+            ->set("ip", SrsJsonAny::str(""))
+            ->set("port", SrsJsonAny::integer(19350)));
+    }
+    return obj;
+}
+
+VOID TEST(AppCoWorkersTest, StreamDirectory)
+{
+    srs_error_t err;
+
+    // Never use the singleton, or the directory is left for other tests.
+    SrsCoWorkers* coworkers = new SrsCoWorkers();
+    SrsAutoFree(SrsCoWorkers, coworkers);
+    SrsCoWorkerStream* s = NULL;
+
+    // Sync the whole directory, the ip is the host of co-worker.
+    if (true) {
+        SrsJsonObject* obj = mock_coworkers_directory("e1", 2, -1, "publish", "s1");
+        SrsAutoFree(SrsJsonObject, obj);
+        HELPER_EXPECT_SUCCESS(coworkers->on_directory("10.0.0.1:1985", obj));
+
+        s = coworkers->lookup("__defaultVhost__", "live", "s1");
+        ASSERT_TRUE(s != NULL);
+        EXPECT_STREQ("10.0.0.1", s->ip.c_str());
+        EXPECT_EQ(19350, s->port);
+
+        // The vhost of edge might not exists in origin.
+        EXPECT_TRUE(coworkers->lookup("ossrs.net", "live", "s1") != NULL);
+        EXPECT_TRUE(coworkers->lookup("__defaultVhost__", "live", "s2") == NULL);
+    }
+
+    // Apply the deltas pushed by co-worker, found by epoch.
+    if (true) {
+        SrsJsonObject* obj = mock_coworkers_directory("e1", 3, 2, "publish", "s2");
+        SrsAutoFree(SrsJsonObject, obj);
+        HELPER_EXPECT_SUCCESS(coworkers->on_directory("", obj));
+        EXPECT_TRUE(coworkers->lookup("__defaultVhost__", "live", "s2") != NULL);
+    }
+    if (true) {
+        SrsJsonObject* obj = mock_coworkers_directory("e1", 4, 3, "unpublish", "s1");
+        SrsAutoFree(SrsJsonObject, obj);
+        HELPER_EXPECT_SUCCESS(coworkers->on_directory("", obj));
+        EXPECT_TRUE(coworkers->lookup("__defaultVhost__", "live", "s1") == NULL);
+        EXPECT_TRUE(coworkers->lookup("__defaultVhost__", "live", "s2") != NULL);
+    }
+
+    // Ignore the stale delta, which is already synced.
+    if (true) {
+        SrsJsonObject* obj = mock_coworkers_directory("e1", 3, 2, "publish", "s1");
+        SrsAutoFree(SrsJsonObject, obj);
+        HELPER_EXPECT_SUCCESS(coworkers->on_directory("", obj));
+        EXPECT_TRUE(coworkers->lookup("__defaultVhost__", "live", "s1") == NULL);
+    }
+
+    // Ignore the deltas of unknown co-worker.
+    if (true) {
+        SrsJsonObject* obj = mock_coworkers_directory("e2", 1, 0, "publish", "s3");
+        SrsAutoFree(SrsJsonObject, obj);
+        HELPER_EXPECT_SUCCESS(coworkers->on_directory("", obj));
+        EXPECT_TRUE(coworkers->lookup("__defaultVhost__", "live", "s3") == NULL);
+    }
+
+    // Never use the directory when some deltas are lost, until resync.
+    if (true) {
+        SrsJsonObject* obj = mock_coworkers_directory("e1", 6, 5, "publish", "s3");
+        SrsAutoFree(SrsJsonObject, obj);
+        HELPER_EXPECT_SUCCESS(coworkers->on_directory("", obj));
+        EXPECT_TRUE(coworkers->lookup("__defaultVhost__", "live", "s2") == NULL);
+        EXPECT_TRUE(coworkers->lookup("__defaultVhost__", "live", "s3") == NULL);
+    }
+    if (true) {
+        SrsJsonObject* obj = mock_coworkers_directory("e1", 6, -1, "publish", "s3");
+        SrsAutoFree(SrsJsonObject, obj);
+        HELPER_EXPECT_SUCCESS(coworkers->on_directory("10.0.0.1:1985", obj));
+        EXPECT_TRUE(coworkers->lookup("__defaultVhost__", "live", "s2") == NULL);
+        EXPECT_TRUE(coworkers->lookup("__defaultVhost__", "live", "s3") != NULL);
+    }
+
+    // The co-worker restarted, resync the whole directory.
+    if (true) {
+        SrsJsonObject* obj = mock_coworkers_directory("e3", 1, 0, "publish", "s4");
+        SrsAutoFree(SrsJsonObject, obj);
+        HELPER_EXPECT_SUCCESS(coworkers->on_directory("10.0.0.1:1985", obj));
+        EXPECT_TRUE(coworkers->lookup("__defaultVhost__", "live", "s3") == NULL);
+        EXPECT_TRUE(coworkers->lookup("__defaultVhost__", "live", "s4") == NULL);
+    }
+
+    // The co-worker is this server itself.
+    if (true) {
+        string epoch = SrsStatistic::instance()->service_id();
+        SrsJsonObject* obj = mock_coworkers_directory(epoch, 1, -1, "publish", "s5");
+        SrsAutoFree(SrsJsonObject, obj);
+        HELPER_EXPECT_SUCCESS(coworkers->on_directory("127.0.0.1:1985", obj));
+        EXPECT_TRUE(coworkers->lookup("__defaultVhost__", "live", "s5") == NULL);
+    }
+
+    // Drop the directory of co-worker.
+    if (true) {
+        SrsJsonObject* obj = mock_coworkers_directory("e1", 0, -1, "", "");
+        SrsAutoFree(SrsJsonObject, obj);
+        HELPER_EXPECT_SUCCESS(coworkers->on_directory("10.0.0.1:1985", obj));
+    }
+}
+
+VOID TEST(AppCoWorkersTest, SyncByPeer)
+{
+    srs_error_t err;
+
+    SrsCoWorkers* coworkers = new SrsCoWorkers();
+    SrsAutoFree(SrsCoWorkers, coworkers);
+
+    // The directory of two co-workers.
+    if (true) {
+        SrsJsonObject* obj = mock_coworkers_directory("e1", 1, -1, "publish", "s1");
+        SrsAutoFree(SrsJsonObject, obj);
+        HELPER_EXPECT_SUCCESS(coworkers->on_directory("10.0.0.1:1985", obj));
+    }
+    if (true) {
+        SrsJsonObject* obj = mock_coworkers_directory("e2", 1, -1, "publish", "s2");
+        SrsAutoFree(SrsJsonObject, obj);
+        HELPER_EXPECT_SUCCESS(coworkers->on_directory("127.0.0.1:1", obj));
+    }
+    EXPECT_TRUE(coworkers->lookup("__defaultVhost__", "live", "s1") != NULL);
+    EXPECT_TRUE(coworkers->lookup("__defaultVhost__", "live", "s2") != NULL);
+
+    // The co-worker syncs in its own coroutine, which drops the directory when unavailable.
+    SrsCoWorkerPeer* peer = coworkers->peers_["127.0.0.1:1"];
+    EXPECT_TRUE(peer->trd_ == NULL);
+    HELPER_EXPECT_SUCCESS(peer->start());
+    SrsCoroutine* trd = peer->trd_;
+    HELPER_EXPECT_SUCCESS(peer->start());
+    EXPECT_TRUE(trd == peer->trd_);
+
+    for (int i = 0; i < 100 && peer->synced; i++) {
+        srs_usleep(10 * SRS_UTIME_MILLISECONDS);
+    }
+    EXPECT_TRUE(coworkers->lookup("__defaultVhost__", "live", "s2") == NULL);
+
+    // The other co-worker is not affected.
+    EXPECT_TRUE(coworkers->lookup("__defaultVhost__", "live", "s1") != NULL);
+}
+
+VOID TEST(AppCoWorkersTest, DumpsDirectory)
+{
+    SrsCoWorkers* coworkers = new SrsCoWorkers();
+    SrsAutoFree(SrsCoWorkers, coworkers);
+    string epoch = SrsStatistic::instance()->service_id();
+
+    // The whole directory for the unknown epoch.
+    if (true) {
+        SrsJsonObject* obj = coworkers->dumps_directory("", 0);
+        SrsAutoFree(SrsJsonObject, obj);
+
+        SrsJsonAny* prop = obj->get_property("full");
+        ASSERT_TRUE(prop && prop->is_boolean());
+        EXPECT_TRUE(prop->to_boolean());
+        EXPECT_STREQ(epoch.c_str(), obj->get_property("epoch")->to_str().c_str());
+        EXPECT_TRUE(obj->get_property("since") == NULL);
+    }
+
+    // The deltas since the version of the same epoch.
+    if (true) {
+        SrsJsonObject* obj = coworkers->dumps_directory("", 0);
+        SrsAutoFree(SrsJsonObject, obj);
+        int64_t version = obj->get_property("version")->to_integer();
+
+        SrsJsonObject* delta = coworkers->dumps_directory(epoch, version);
+        SrsAutoFree(SrsJsonObject, delta);
+        EXPECT_TRUE(delta->get_property("full") == NULL);
+        EXPECT_EQ(version, delta->get_property("since")->to_integer());
+        EXPECT_EQ(0, delta->get_property("streams")->to_array()->count());
+    }
+
+    // The whole directory for the version in future.
+    if (true) {
+        SrsJsonObject* obj = coworkers->dumps_directory(epoch, 1<<30);
+        SrsAutoFree(SrsJsonObject, obj);
+        EXPECT_TRUE(obj->get_property("full") != NULL);
+    }
+}
+
+VOID TEST(AppCoWorkersTest, ClustersApi)
+{
+    srs_error_t err = srs_success;
+
+    SrsGoApiClusters api;
+
+    // The lookup of stream, even if no stream.
+    if (true) {
+        MockResponseWriter w;
+        SrsHttpMessage r(NULL, NULL);
+        HELPER_ASSERT_SUCCESS(r.set_url("/api/v1/clusters?vhost=__defaultVhost__&app=live", false));
+
+        HELPER_ASSERT_SUCCESS(api.serve_http(&w, &r));
+        __MOCK_HTTP_EXPECT_STRHAS(200, "\"query\":", w);
+        __MOCK_HTTP_EXPECT_STRHAS(200, "\"origin\":", w);
+    }
+
+    // The stream directory, only for the request with directory.
+    if (true) {
+        MockResponseWriter w;
+        SrsHttpMessage r(NULL, NULL);
+        HELPER_ASSERT_SUCCESS(r.set_url("/api/v1/clusters?directory=1&epoch=&since=0", false));
+
+        HELPER_ASSERT_SUCCESS(api.serve_http(&w, &r));
+        __MOCK_HTTP_EXPECT_STRHAS(200, "\"full\":true", w);
+        EXPECT_FALSE(is_string_contain("\"query\":", HELPER_BUFFER2STR(&w.io.out_buffer)));
+    }
+}
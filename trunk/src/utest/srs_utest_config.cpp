@@ -2904,6 +2904,26 @@ VOID TEST(ConfigMainTest, CheckStreamConverter)
 
         EXPECT_EQ(8080, conf.get_stream_caster_listen(arr.at(0)));
     }
+
+    if (true) {
+        MockSrsConfig conf;
+        HELPER_ASSERT_SUCCESS(conf.parse(_MIN_OK_CONF "stream_caster;"));
+
+        vector<SrsConfDirective*> arr = conf.get_stream_casters();
+        ASSERT_EQ(1, (int)arr.size());
+
+        EXPECT_STREQ("tcp", conf.get_stream_caster_media_transport(arr.at(0)).c_str());
+    }
+
+    if (true) {
+        MockSrsConfig conf;
+        HELPER_ASSERT_SUCCESS(conf.parse(_MIN_OK_CONF "stream_caster {media_transport udp;}"));
+
+        vector<SrsConfDirective*> arr = conf.get_stream_casters();
+        ASSERT_EQ(1, (int)arr.size());
+
+        EXPECT_STREQ("udp", conf.get_stream_caster_media_transport(arr.at(0)).c_str());
+    }
 }
 
 VOID TEST(ConfigMainTest, CheckVhostConfig2)
@@ -2968,6 +2988,24 @@ VOID TEST(ConfigMainTest, CheckVhostConfig2)
         EXPECT_TRUE(conf.get_forward_enabled("ossrs.net"));
     }
 
+    if (true) {
+        MockSrsConfig conf;
+        HELPER_ASSERT_SUCCESS(conf.parse(_MIN_OK_CONF "vhost ossrs.net{forward {enabled on;}}"));
+        EXPECT_STREQ("drop", conf.get_forward_backpressure("ossrs.net", "127.0.0.1:1936").c_str());
+    }
+
+    if (true) {
+        MockSrsConfig conf;
+        HELPER_ASSERT_SUCCESS(conf.parse(_MIN_OK_CONF "vhost ossrs.net{forward {backpressure disconnect 127.0.0.1:1937; backpressure drop;}}"));
+        EXPECT_STREQ("drop", conf.get_forward_backpressure("ossrs.net", "127.0.0.1:1936").c_str());
+        EXPECT_STREQ("disconnect", conf.get_forward_backpressure("ossrs.net", "127.0.0.1:1937").c_str());
+    }
+
+    if (true) {
+        MockSrsConfig conf;
+        HELPER_ASSERT_FAILED(conf.parse(_MIN_OK_CONF "vhost ossrs.net{forward {backpressure xxx;}}"));
+    }
+
     if (true) {
         MockSrsConfig conf;
         HELPER_ASSERT_SUCCESS(conf.parse(_MIN_OK_CONF "vhost ossrs.net{publish {normal_timeout 10;}}"));
@@ -3219,6 +3257,20 @@ VOID TEST(ConfigMainTest, CheckVhostConfig3)
         EXPECT_TRUE(conf.get_vhost_on_hls("ossrs.net") != NULL);
     }
 
+    if (true) {
+        MockSrsConfig conf;
+        HELPER_ASSERT_SUCCESS(conf.parse(_MIN_OK_CONF "vhost ossrs.net{http_hooks{enabled on;}}"));
+        EXPECT_EQ(0, conf.get_vhost_http_hooks_cache_ttl("ossrs.net"));
+        EXPECT_EQ(0, conf.get_vhost_http_hooks_cache_negative_ttl("ossrs.net"));
+    }
+
+    if (true) {
+        MockSrsConfig conf;
+        HELPER_ASSERT_SUCCESS(conf.parse(_MIN_OK_CONF "vhost ossrs.net{http_hooks{cache_ttl 30;cache_negative_ttl 5;}}"));
+        EXPECT_EQ(30 * SRS_UTIME_SECONDS, conf.get_vhost_http_hooks_cache_ttl("ossrs.net"));
+        EXPECT_EQ(5 * SRS_UTIME_SECONDS, conf.get_vhost_http_hooks_cache_negative_ttl("ossrs.net"));
+    }
+
     if (true) {
         MockSrsConfig conf;
         HELPER_ASSERT_SUCCESS(conf.parse(_MIN_OK_CONF "vhost ossrs.net{http_hooks{on_dvr xxx;}}"));
@@ -3699,6 +3751,25 @@ VOID TEST(ConfigMainTest, CheckVhostConfig5)
         EXPECT_STREQ("cn-beijing", conf.get_exporter_label().c_str());
         EXPECT_STREQ("cn-edge", conf.get_exporter_tag().c_str());
     }
+
+    if (true) {
+        MockSrsConfig conf;
+        HELPER_ASSERT_SUCCESS(conf.parse(_MIN_OK_CONF));
+        EXPECT_FALSE(conf.get_edge_relay_enabled());
+        EXPECT_STREQ("./objs/srs.edge.sock", conf.get_edge_relay_listen().c_str());
+    }
+
+    if (true) {
+        MockSrsConfig conf;
+        HELPER_ASSERT_SUCCESS(conf.parse(_MIN_OK_CONF "edge_relay{enabled on;listen /tmp/edge.sock;}"));
+        EXPECT_TRUE(conf.get_edge_relay_enabled());
+        EXPECT_STREQ("/tmp/edge.sock", conf.get_edge_relay_listen().c_str());
+    }
+
+    if (true) {
+        MockSrsConfig conf;
+        HELPER_ASSERT_FAILED(conf.parse(_MIN_OK_CONF "edge_relay{enabled on;port 1935;}"));
+    }
 }
 
 VOID TEST(ConfigMainTest, CheckIncludeConfig)
@@ -4064,6 +4135,22 @@ VOID TEST(ConfigEnvTest, CheckEnvValuesthreads)
         SrsSetEnvConfig(threads_interval, "SRS_THREADS_INTERVAL", "10");
         EXPECT_EQ(10 * SRS_UTIME_SECONDS, conf.get_threads_interval());
     }
+
+    if (true) {
+        MockSrsConfig conf;
+        EXPECT_TRUE(conf.get_threads_async_file_io());
+
+        SrsSetEnvConfig(async_file_io, "SRS_THREADS_ASYNC_FILE_IO", "off");
+        EXPECT_FALSE(conf.get_threads_async_file_io());
+    }
+
+    if (true) {
+        MockSrsConfig conf;
+        EXPECT_EQ(0, conf.get_threads_srtp_workers());
+
+        SrsSetEnvConfig(srtp_workers, "SRS_THREADS_SRTP_WORKERS", "3");
+        EXPECT_EQ(3, conf.get_threads_srtp_workers());
+    }
 }
 
 VOID TEST(ConfigEnvTest, CheckEnvValuesRtmp)
@@ -4244,6 +4331,13 @@ VOID TEST(ConfigEnvTest, CheckEnvValuesVhostSrt)
 
         SrsSetEnvConfig(srt_to_rtmp2, "SRS_VHOST_SRT_TO_RTMP", "off");
         EXPECT_FALSE(conf.get_srt_to_rtmp("__defaultVhost__"));
+
+        EXPECT_FALSE(conf.get_srt_to_hls("__defaultVhost__"));
+        SrsSetEnvConfig(srt_to_hls, "SRS_VHOST_SRT_SRT_TO_HLS", "on");
+        EXPECT_TRUE(conf.get_srt_to_hls("__defaultVhost__"));
+
+        SrsSetEnvConfig(srt_to_hls2, "SRS_VHOST_SRT_TO_HLS", "on");
+        EXPECT_TRUE(conf.get_srt_to_hls("__defaultVhost__"));
     }
 }
 
@@ -4285,6 +4379,9 @@ VOID TEST(ConfigEnvTest, CheckEnvValuesRtcServer)
         SrsSetEnvConfig(rtc_server_encrypt, "SRS_RTC_SERVER_ENCRYPT", "off");
         EXPECT_FALSE(conf.get_rtc_server_encrypt());
 
+        SrsSetEnvConfig(rtc_server_srtp_gcm, "SRS_RTC_SERVER_SRTP_GCM", "off");
+        EXPECT_FALSE(conf.get_rtc_server_srtp_gcm());
+
         SrsSetEnvConfig(rtc_server_reuseport, "SRS_RTC_SERVER_REUSEPORT", "0");
         EXPECT_EQ(0, conf.get_rtc_server_reuseport2());
 
@@ -4330,6 +4427,9 @@ VOID TEST(ConfigEnvTest, CheckEnvValuesVhostRtc)
         SrsSetEnvConfig(rtc_twcc_enabled, "SRS_VHOST_RTC_TWCC", "off");
         EXPECT_FALSE(conf.get_rtc_twcc_enabled("__defaultVhost__"));
 
+        SrsSetEnvConfig(rtc_pacer_enabled, "SRS_VHOST_RTC_PACER", "on");
+        EXPECT_TRUE(conf.get_rtc_pacer_enabled("__defaultVhost__"));
+
         SrsSetEnvConfig(rtc_stun_timeout, "SRS_VHOST_RTC_STUN_TIMEOUT", "15");
         EXPECT_EQ(15 * SRS_UTIME_SECONDS, conf.get_rtc_stun_timeout("__defaultVhost__"));
 
@@ -4368,6 +4468,21 @@ VOID TEST(ConfigEnvTest, CheckEnvValuesVhostRtc)
         SrsSetEnvConfig(rtc_pli_for_rtmp, "SRS_VHOST_RTC_PLI_FOR_RTMP", "60");
         EXPECT_EQ(6 * SRS_UTIME_SECONDS, conf.get_rtc_pli_for_rtmp("__defaultVhost__"));
     }
+
+    if (true) {
+        MockSrsConfig conf;
+        EXPECT_EQ(300 * SRS_UTIME_MILLISECONDS, conf.get_rtc_jitter_for_rtmp("__defaultVhost__"));
+
+        SrsSetEnvConfig(rtc_jitter_for_rtmp, "SRS_VHOST_RTC_JITTER_FOR_RTMP", "0.5");
+        EXPECT_EQ(500 * SRS_UTIME_MILLISECONDS, conf.get_rtc_jitter_for_rtmp("__defaultVhost__"));
+    }
+
+    if (true) {
+        MockSrsConfig conf;
+
+        SrsSetEnvConfig(rtc_jitter_for_rtmp, "SRS_VHOST_RTC_JITTER_FOR_RTMP", "10");
+        EXPECT_EQ(300 * SRS_UTIME_MILLISECONDS, conf.get_rtc_jitter_for_rtmp("__defaultVhost__"));
+    }
 }
 
 VOID TEST(ConfigEnvTest, CheckEnvValuesVhostPlay)
@@ -4586,6 +4701,19 @@ VOID TEST(ConfigEnvTest, CheckEnvValuesExporter)
     }
 }
 
+VOID TEST(ConfigEnvTest, CheckEnvValuesEdgeRelay)
+{
+    if (true) {
+        MockSrsConfig conf;
+
+        SrsSetEnvConfig(edge_relay_enabled, "SRS_EDGE_RELAY_ENABLED", "on");
+        EXPECT_TRUE(conf.get_edge_relay_enabled());
+
+        SrsSetEnvConfig(edge_relay_listen, "SRS_EDGE_RELAY_LISTEN", "/tmp/xxx.sock");
+        EXPECT_STREQ("/tmp/xxx.sock", conf.get_edge_relay_listen().c_str());
+    }
+}
+
 VOID TEST(ConfigEnvTest, CheckEnvValuesHeartbeat)
 {
     if (true) {
@@ -4735,6 +4863,9 @@ VOID TEST(ConfigEnvTest, CheckEnvValuesDash)
 
         SrsSetEnvConfig(dash_mpd_file, "SRS_VHOST_DASH_DASH_MPD_FILE", "xxx2");
         EXPECT_STREQ("xxx2", conf.get_dash_mpd_file("__defaultVhost__").c_str());
+
+        SrsSetEnvConfig(dash_chunk, "SRS_VHOST_DASH_DASH_CHUNK", "0.5");
+        EXPECT_EQ(500 * SRS_UTIME_MILLISECONDS, conf.get_dash_chunk("__defaultVhost__"));
     }
 }
 
@@ -4937,5 +5068,20 @@ VOID TEST(ConfigEnvTest, CheckEnvValuesHooks)
         ASSERT_TRUE((int)dir->args.size() == 1);
         ASSERT_STREQ("http://server/api/hls_notify", dir->arg0().c_str());
     }
+
+    if (true) {
+        SrsSetEnvConfig(backpressure, "SRS_VHOST_FORWARD_BACKPRESSURE", "disconnect");
+        EXPECT_STREQ("disconnect", conf.get_forward_backpressure("__defaultVhost__", "127.0.0.1:1936").c_str());
+    }
+
+    if (true) {
+        SrsSetEnvConfig(cache_ttl, "SRS_VHOST_HTTP_HOOKS_CACHE_TTL", "30");
+        EXPECT_EQ(30 * SRS_UTIME_SECONDS, conf.get_vhost_http_hooks_cache_ttl("__defaultVhost__"));
+    }
+
+    if (true) {
+        SrsSetEnvConfig(cache_negative_ttl, "SRS_VHOST_HTTP_HOOKS_CACHE_NEGATIVE_TTL", "5");
+        EXPECT_EQ(5 * SRS_UTIME_SECONDS, conf.get_vhost_http_hooks_cache_negative_ttl("__defaultVhost__"));
+    }
 }
 
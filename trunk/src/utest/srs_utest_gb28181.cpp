@@ -1944,3 +1944,302 @@ VOID TEST(KernelPSTest, PsPacketDecodePrivateStream)
     EXPECT_EQ(0, context.recover_);
 }
 
+
+class MockPsPackHandler : public ISrsPsPackDemuxHandler
+{
+public:
+    std::vector<std::string> videos_;
+    std::vector<std::string> audios_;
+    SrsTsStream vcodec_;
+    SrsTsStream acodec_;
+    int64_t video_dts_;
+    int64_t audio_dts_;
+public:
+    MockPsPackHandler() {
+        vcodec_ = acodec_ = SrsTsStreamReserved;
+        video_dts_ = audio_dts_ = -1;
+    }
+    virtual ~MockPsPackHandler() {
+    }
+public:
+    virtual srs_error_t on_ps_video(SrsTsStream vcodec, int64_t dts, int64_t pts, char* data, int size) {
+        vcodec_ = vcodec; video_dts_ = dts;
+        videos_.push_back(string(data, size));
+        return srs_success;
+    }
+    virtual srs_error_t on_ps_audio(SrsTsStream acodec, int64_t dts, int64_t pts, char* data, int size) {
+        acodec_ = acodec; audio_dts_ = dts;
+        audios_.push_back(string(data, size));
+        return srs_success;
+    }
+};
+
+// The PS pack header and PSM of H.264 and AAC.
+string mock_ps_pack_header()
+{
+    return string(
+        "\x00\x00\x01\xba\x44\x00\x04\x00\x04\x01\x01\x89\xc3\xf8" /* Pack header */ \
+        "\x00\x00\x01\xbc\x00\x12\xe0\xff\x00\x00\x00\x08" /* PSM header */ \
+        "\x1b\xe0\x00\x00\x0f\xc0\x00\x00" /* PSM H.264 and AAC */ \
+        "\x00\x00\x00\x00" /* PSM CRC32 */, 14+12+8+4);
+}
+
+// The PES with PTS if not negative, the length is the PES_packet_length if not negative.
+string mock_ps_pes(uint8_t sid, int64_t pts, string payload, int length = -1)
+{
+    string pes = string("\x00\x00\x01", 3);
+    pes.append(1, (char)sid);
+
+    int header = pts >= 0 ? 8 : 3;
+    if (length < 0) length = header + (int)payload.length();
+    pes.append(1, (char)(length >> 8));
+    pes.append(1, (char)length);
+
+    pes.append(1, (char)0x80);
+    pes.append(1, (char)(pts >= 0 ? 0x80 : 0x00));
+    pes.append(1, (char)(pts >= 0 ? 5 : 0));
+    if (pts >= 0) {
+        pes.append(1, (char)(0x21 | ((pts >> 29) & 0x0e)));
+        pes.append(1, (char)(pts >> 22));
+        pes.append(1, (char)(((pts >> 14) & 0xfe) | 0x01));
+        pes.append(1, (char)(pts >> 7));
+        pes.append(1, (char)(((pts << 1) & 0xfe) | 0x01));
+    }
+
+    return pes + payload;
+}
+
+VOID TEST(KernelPSTest, PsPackDemuxVideoAudio)
+{
+    srs_error_t err = srs_success;
+
+    string pack = mock_ps_pack_header();
+    pack += mock_ps_pes(0xe0, 3600, string("\x00\x00\x00\x01\x67\x42", 6));
+    pack += mock_ps_pes(0xe0, -1, string("\x00\x00\x00\x01\x65\x88", 6));
+    pack += mock_ps_pes(0xc0, 3000, string("\xff\xf1\x50\x80", 4));
+
+    MockPsPackHandler handler;
+    SrsPsPackDemuxer demuxer;
+    HELPER_ASSERT_SUCCESS(demuxer.demux((char*)pack.data(), (int)pack.length(), &handler));
+
+    // The PES payloads of video are joined as a frame.
+    ASSERT_EQ((size_t)1, handler.videos_.size());
+    EXPECT_STREQ(string("\x00\x00\x00\x01\x67\x42\x00\x00\x00\x01\x65\x88", 12).c_str(), handler.videos_.at(0).c_str());
+    EXPECT_EQ(12, (int)handler.videos_.at(0).length());
+    EXPECT_EQ(SrsTsStreamVideoH264, handler.vcodec_);
+    EXPECT_EQ(3600, handler.video_dts_);
+
+    ASSERT_EQ((size_t)1, handler.audios_.size());
+    EXPECT_EQ(4, (int)handler.audios_.at(0).length());
+    EXPECT_EQ(SrsTsStreamAudioAAC, handler.acodec_);
+    EXPECT_EQ(3000, handler.audio_dts_);
+}
+
+VOID TEST(KernelPSTest, PsPackDemuxTruncated)
+{
+    srs_error_t err;
+
+    // The PES_packet_length is larger than the pack.
+    string pack = mock_ps_pack_header();
+    pack += mock_ps_pes(0xe0, 3600, string("\x00\x00\x00\x01\x67\x42", 6), 100);
+
+    MockPsPackHandler handler;
+    SrsPsPackDemuxer demuxer;
+    HELPER_EXPECT_FAILED(demuxer.demux((char*)pack.data(), (int)pack.length(), &handler));
+    EXPECT_EQ((size_t)0, handler.videos_.size());
+
+    // Without PSM, the codec is unknown, and the bytes before pack are ignored.
+    pack = string("\x01\x02\x00\x00\x01\xba\x44\x00\x04\x00\x04\x01\x01\x89\xc3\xf8", 16);
+    pack += mock_ps_pes(0xe0, 3600, string("\x00\x00\x00\x01\x67\x42", 6));
+    SrsPsPackDemuxer demuxer2;
+    HELPER_ASSERT_SUCCESS(demuxer2.demux((char*)pack.data(), (int)pack.length(), &handler));
+    ASSERT_EQ((size_t)1, handler.videos_.size());
+    EXPECT_EQ(SrsTsStreamReserved, handler.vcodec_);
+}
+
+VOID TEST(KernelPSTest, PsPackDemuxEndCode)
+{
+    srs_error_t err = srs_success;
+
+    // The MPEG_program_end_code is 4 bytes, at the end of pack, or before the next pack.
+    string pack = mock_ps_pack_header();
+    pack += mock_ps_pes(0xe0, 3600, string("\x00\x00\x00\x01\x65\x88", 6));
+    pack += string("\x00\x00\x01\xb9", 4);
+
+    MockPsPackHandler handler;
+    SrsPsPackDemuxer demuxer;
+    HELPER_ASSERT_SUCCESS(demuxer.demux((char*)pack.data(), (int)pack.length(), &handler));
+    ASSERT_EQ((size_t)1, handler.videos_.size());
+    EXPECT_EQ(6, (int)handler.videos_.at(0).length());
+
+    pack = string("\x00\x00\x01\xb9", 4) + mock_ps_pack_header();
+    pack += mock_ps_pes(0xe0, 7200, string("\x00\x00\x00\x01\x41\x9a", 6));
+    HELPER_ASSERT_SUCCESS(demuxer.demux((char*)pack.data(), (int)pack.length(), &handler));
+    ASSERT_EQ((size_t)2, handler.videos_.size());
+    EXPECT_EQ(7200, handler.video_dts_);
+}
+
+class MockGbMediaUdpStream : public SrsGbMediaUdpStream
+{
+public:
+    MockPsPackHandler handler_;
+public:
+    MockGbMediaUdpStream() : SrsGbMediaUdpStream(NULL) {
+    }
+    virtual ~MockGbMediaUdpStream() {
+    }
+public:
+    virtual srs_error_t on_ps_video(SrsTsStream vcodec, int64_t dts, int64_t pts, char* data, int size) {
+        return handler_.on_ps_video(vcodec, dts, pts, data, size);
+    }
+    virtual srs_error_t on_ps_audio(SrsTsStream acodec, int64_t dts, int64_t pts, char* data, int size) {
+        return handler_.on_ps_audio(acodec, dts, pts, data, size);
+    }
+};
+
+string mock_gb_rtp(uint16_t seq, bool marker, string payload)
+{
+    string rtp = string("\x80\x60\x00\x00\x00\x00\x00\x00\x00\x00\x04\xd2", 12);
+    rtp[1] = (char)(marker ? 0xe0 : 0x60);
+    rtp[2] = (char)(seq >> 8);
+    rtp[3] = (char)seq;
+    return rtp + payload;
+}
+
+VOID TEST(KernelPSTest, GbMediaUdpReorder)
+{
+    srs_error_t err = srs_success;
+
+    // A frame in two RTP packets.
+    string pack = mock_ps_pack_header();
+    pack += mock_ps_pes(0xe0, 3600, string("\x00\x00\x00\x01\x65\x88\x84\x00", 8));
+    string p0 = mock_gb_rtp(100, false, pack.substr(0, 40));
+    string p1 = mock_gb_rtp(101, true, pack.substr(40));
+
+    MockGbMediaUdpStream udp;
+    EXPECT_FALSE(udp.is_active());
+
+    // The first packet is the sequence to start with.
+    HELPER_ASSERT_SUCCESS(udp.on_rtp((char*)p0.data(), (int)p0.length()));
+    EXPECT_TRUE(udp.is_active());
+    EXPECT_EQ((size_t)0, udp.handler_.videos_.size());
+
+    // Reorder the packets of next frame.
+    string p2 = mock_gb_rtp(102, false, pack.substr(0, 40));
+    string p3 = mock_gb_rtp(103, true, pack.substr(40));
+    HELPER_ASSERT_SUCCESS(udp.on_rtp((char*)p1.data(), (int)p1.length()));
+    HELPER_ASSERT_SUCCESS(udp.on_rtp((char*)p3.data(), (int)p3.length()));
+    EXPECT_EQ((size_t)1, udp.handler_.videos_.size());
+    HELPER_ASSERT_SUCCESS(udp.on_rtp((char*)p2.data(), (int)p2.length()));
+    ASSERT_EQ((size_t)2, udp.handler_.videos_.size());
+    EXPECT_EQ(8, (int)udp.handler_.videos_.at(1).length());
+    EXPECT_EQ(1, (int)udp.nn_reordered_);
+    EXPECT_EQ(2, (int)udp.nn_packs_);
+
+    // Drop the late packet.
+    HELPER_ASSERT_SUCCESS(udp.on_rtp((char*)p2.data(), (int)p2.length()));
+    EXPECT_EQ(1, (int)udp.nn_late_);
+    EXPECT_EQ((size_t)2, udp.handler_.videos_.size());
+}
+
+VOID TEST(KernelPSTest, GbMediaUdpLost)
+{
+    srs_error_t err = srs_success;
+
+    string pack = mock_ps_pack_header();
+    pack += mock_ps_pes(0xe0, 3600, string("\x00\x00\x00\x01\x65\x88\x84\x00", 8));
+
+    MockGbMediaUdpStream udp;
+
+    // The first half of frame, while the second half at seq 101 is lost.
+    string p0 = mock_gb_rtp(100, false, pack.substr(0, 40));
+    HELPER_ASSERT_SUCCESS(udp.on_rtp((char*)p0.data(), (int)p0.length()));
+
+    // The frames wait for the lost packet, until over half of the reorder buffer.
+    for (int i = 0; i <= SRS_PERF_GB_UDP_REORDER_SLOTS / 2; i++) {
+        string p = mock_gb_rtp(102 + i, true, pack);
+        HELPER_ASSERT_SUCCESS(udp.on_rtp((char*)p.data(), (int)p.length()));
+        if (i < SRS_PERF_GB_UDP_REORDER_SLOTS / 2) {
+            EXPECT_EQ((size_t)0, udp.handler_.videos_.size());
+        }
+    }
+
+    // The corrupt frame is dropped, and the buffered frames are consumed.
+    EXPECT_EQ(1, (int)udp.nn_lost_);
+    EXPECT_EQ((size_t)(SRS_PERF_GB_UDP_REORDER_SLOTS / 2 + 1), udp.handler_.videos_.size());
+
+    // The sequence jumps, restart from the packet.
+    string p = mock_gb_rtp(30000, true, pack);
+    HELPER_ASSERT_SUCCESS(udp.on_rtp((char*)p.data(), (int)p.length()));
+    EXPECT_EQ((size_t)(SRS_PERF_GB_UDP_REORDER_SLOTS / 2 + 2), udp.handler_.videos_.size());
+
+    // Invalid RTP packet.
+    HELPER_EXPECT_FAILED(udp.on_rtp((char*)p.data(), 8));
+}
+
+VOID TEST(KernelPSTest, GbMediaUdpReorderTimeout)
+{
+    srs_error_t err = srs_success;
+
+    string pack = mock_ps_pack_header();
+    pack += mock_ps_pes(0xe0, 3600, string("\x00\x00\x00\x01\x65\x88\x84\x00", 8));
+
+    MockGbMediaUdpStream udp;
+
+    // The first half of frame, while the second half at seq 101 is lost.
+    string p0 = mock_gb_rtp(100, false, pack.substr(0, 40));
+    HELPER_ASSERT_SUCCESS(udp.on_rtp((char*)p0.data(), (int)p0.length()));
+
+    // Only a frame waits for the lost packet.
+    string p1 = mock_gb_rtp(102, true, pack);
+    HELPER_ASSERT_SUCCESS(udp.on_rtp((char*)p1.data(), (int)p1.length()));
+    EXPECT_EQ(1, udp.nn_buffered_);
+    EXPECT_TRUE(udp.blocked_at_ > 0);
+
+    // Keep waiting in time.
+    srs_utime_t blocked_at = udp.blocked_at_;
+    udp.check_reorder(blocked_at + (SRS_PERF_GB_UDP_REORDER_TIMEOUT - 1) * SRS_UTIME_MILLISECONDS);
+    EXPECT_EQ((size_t)0, udp.handler_.videos_.size());
+
+    // Give up the lost packet, and consume the buffered frame.
+    udp.check_reorder(blocked_at + SRS_PERF_GB_UDP_REORDER_TIMEOUT * SRS_UTIME_MILLISECONDS);
+    EXPECT_EQ(1, (int)udp.nn_lost_);
+    EXPECT_EQ(0, udp.nn_buffered_);
+    EXPECT_EQ(0, (int)udp.blocked_at_);
+    EXPECT_EQ((size_t)1, udp.handler_.videos_.size());
+}
+
+VOID TEST(KernelPSTest, GbMediaUdpQueue)
+{
+    srs_error_t err = srs_success;
+
+    string pack = mock_ps_pack_header();
+    pack += mock_ps_pes(0xe0, 3600, string("\x00\x00\x00\x01\x65\x88\x84\x00", 8));
+    string p0 = mock_gb_rtp(100, false, pack.substr(0, 40));
+    string p1 = mock_gb_rtp(101, true, pack.substr(40));
+
+    MockGbMediaUdpStream udp;
+
+    // The packets are copied to queue, not consumed by the listener.
+    udp.enqueue((char*)p0.data(), (int)p0.length());
+    udp.enqueue((char*)p1.data(), (int)p1.length());
+    EXPECT_EQ((size_t)2, udp.queue_.size());
+    EXPECT_EQ((size_t)0, udp.handler_.videos_.size());
+
+    // Consumed by the coroutine of stream, and the packets are reused.
+    HELPER_ASSERT_SUCCESS(udp.start());
+    srs_usleep(1 * SRS_UTIME_MILLISECONDS);
+    EXPECT_EQ((size_t)0, udp.queue_.size());
+    EXPECT_EQ((size_t)2, udp.pool_.size());
+    ASSERT_EQ((size_t)1, udp.handler_.videos_.size());
+    EXPECT_EQ(8, (int)udp.handler_.videos_.at(0).length());
+
+    // Drop the packets when queue is full.
+    udp.interrupt();
+    srs_usleep(1 * SRS_UTIME_MILLISECONDS);
+    for (int i = 0; i < SRS_PERF_GB_UDP_QUEUE_SIZE + 1; i++) {
+        udp.enqueue((char*)p0.data(), (int)p0.length());
+    }
+    EXPECT_EQ((size_t)SRS_PERF_GB_UDP_QUEUE_SIZE, udp.queue_.size());
+    EXPECT_EQ(1, (int)udp.nn_overflow_);
+}
@@ -16,6 +16,7 @@ using namespace std;
 #include <srs_kernel_file.hpp>
 #include <srs_utest_kernel.hpp>
 #include <srs_app_http_static.hpp>
+#include <srs_app_hls.hpp>
 #include <srs_protocol_utility.hpp>
 #include <srs_core_autofree.hpp>
 
@@ -1145,6 +1146,178 @@ VOID TEST(ProtocolHTTPTest, HTTPServerMuxerCORS)
     }
 }
 
+VOID TEST(ProtocolHTTPTest, HLSPlaylistConditionalGet)
+{
+    srs_error_t err;
+
+    SrsHlsPlaylistCache cache;
+    EXPECT_TRUE(cache.fetch("./objs/nginx/html/live/livestream.m3u8") == NULL);
+
+    // The path with double slash is the same file.
+    SrsHlsPlaylist* playlist = cache.create("./objs/nginx/html//live/livestream.m3u8");
+    playlist->update("#EXTM3U\n");
+    EXPECT_TRUE(playlist == cache.fetch("./objs/nginx/html/live/livestream.m3u8"));
+    EXPECT_STREQ("#EXTM3U\n", playlist->content().c_str());
+    EXPECT_FALSE(playlist->last_modified.empty());
+
+    // The ETag changes with header.
+    string etag = playlist->etag;
+    EXPECT_FALSE(etag.empty());
+    playlist->update("#EXTM3U\n#EXT-X-VERSION:3\n");
+    EXPECT_STRNE(etag.c_str(), playlist->etag.c_str());
+
+    // The ETag changes with segments, and only the header is rebuilt.
+    if (true) {
+        string etag0 = playlist->etag;
+        playlist->append("#EXTINF:10.000,\nlivestream-0.ts\n");
+        playlist->append("#EXTINF:10.000,\nlivestream-1.ts\n");
+        playlist->update("#EXTM3U\n#EXT-X-VERSION:3\n");
+        EXPECT_EQ(2, playlist->size());
+        EXPECT_STRNE(etag0.c_str(), playlist->etag.c_str());
+
+        string etag1 = playlist->etag;
+        playlist->shrink(1);
+        playlist->update("#EXTM3U\n#EXT-X-VERSION:3\n");
+        EXPECT_EQ(1, playlist->size());
+        EXPECT_STRNE(etag1.c_str(), playlist->etag.c_str());
+        EXPECT_STREQ("#EXTM3U\n#EXT-X-VERSION:3\n#EXTINF:10.000,\nlivestream-1.ts\n", playlist->content().c_str());
+
+        // Same content, same ETag.
+        playlist->shrink(0);
+        playlist->update("#EXTM3U\n#EXT-X-VERSION:3\n");
+        EXPECT_STREQ(etag0.c_str(), playlist->etag.c_str());
+    }
+
+    // The ETag of variant for session never matches the playlist.
+    if (true) {
+        string v0 = srs_hls_playlist_variant_etag(playlist->etag, "ctx0");
+        string v1 = srs_hls_playlist_variant_etag(playlist->etag, "ctx1");
+        EXPECT_STRNE(v0.c_str(), playlist->etag.c_str());
+        EXPECT_STRNE(v0.c_str(), v1.c_str());
+        EXPECT_STREQ(v0.c_str(), srs_hls_playlist_variant_etag(playlist->etag, "ctx0").c_str());
+    }
+
+    // Response the content for normal GET.
+    if (true) {
+        MockResponseWriter w;
+        SrsHttpMessage r(NULL, NULL);
+        HELPER_ASSERT_SUCCESS(r.set_url("/live/livestream.m3u8", false));
+
+        HELPER_ASSERT_SUCCESS(srs_hls_serve_playlist(&w, &r, playlist->content(), playlist->etag, playlist->last_modified));
+        string res = HELPER_BUFFER2STR(&w.io.out_buffer);
+        EXPECT_TRUE(res.find("HTTP/1.1 200") == 0);
+        EXPECT_TRUE(res.find("ETag: " + playlist->etag) != string::npos);
+        EXPECT_TRUE(res.find("#EXT-X-VERSION:3") != string::npos);
+    }
+
+    // Response 304 if ETag matched.
+    if (true) {
+        MockResponseWriter w;
+        SrsHttpMessage r(NULL, NULL);
+        SrsHttpHeader h;
+        h.set("If-None-Match", playlist->etag);
+        r.set_header(&h, false);
+        HELPER_ASSERT_SUCCESS(r.set_url("/live/livestream.m3u8", false));
+
+        HELPER_ASSERT_SUCCESS(srs_hls_serve_playlist(&w, &r, playlist->content(), playlist->etag, playlist->last_modified));
+        string res = HELPER_BUFFER2STR(&w.io.out_buffer);
+        EXPECT_TRUE(res.find("HTTP/1.1 304") == 0);
+        EXPECT_TRUE(res.find("#EXTM3U") == string::npos);
+    }
+
+    // Response 200 if ETag not matched, even Last-Modified matched.
+    if (true) {
+        MockResponseWriter w;
+        SrsHttpMessage r(NULL, NULL);
+        SrsHttpHeader h;
+        h.set("If-None-Match", etag);
+        h.set("If-Modified-Since", playlist->last_modified);
+        r.set_header(&h, false);
+        HELPER_ASSERT_SUCCESS(r.set_url("/live/livestream.m3u8", false));
+
+        HELPER_ASSERT_SUCCESS(srs_hls_serve_playlist(&w, &r, playlist->content(), playlist->etag, playlist->last_modified));
+        string res = HELPER_BUFFER2STR(&w.io.out_buffer);
+        EXPECT_TRUE(res.find("HTTP/1.1 200") == 0);
+    }
+
+    // Response 304 if Last-Modified matched.
+    if (true) {
+        MockResponseWriter w;
+        SrsHttpMessage r(NULL, NULL);
+        SrsHttpHeader h;
+        h.set("If-Modified-Since", playlist->last_modified);
+        r.set_header(&h, false);
+        HELPER_ASSERT_SUCCESS(r.set_url("/live/livestream.m3u8", false));
+
+        HELPER_ASSERT_SUCCESS(srs_hls_serve_playlist(&w, &r, playlist->content(), playlist->etag, playlist->last_modified));
+        string res = HELPER_BUFFER2STR(&w.io.out_buffer);
+        EXPECT_TRUE(res.find("HTTP/1.1 304") == 0);
+    }
+
+    // Compare the HTTP date, rather than the string.
+    if (true) {
+        time_t modified = 0;
+        ASSERT_TRUE(srs_http_parse_date(playlist->last_modified, &modified));
+
+        // Response 304 if modified before the date of client, in obsolete format.
+        if (true) {
+            MockResponseWriter w;
+            SrsHttpMessage r(NULL, NULL);
+            SrsHttpHeader h;
+            char buf[64];
+            struct tm tm;
+            time_t since = modified + 10;
+            gmtime_r(&since, &tm);
+            strftime(buf, sizeof(buf), "%a %b %d %H:%M:%S %Y", &tm);
+            h.set("If-Modified-Since", buf);
+            r.set_header(&h, false);
+            HELPER_ASSERT_SUCCESS(r.set_url("/live/livestream.m3u8", false));
+
+            HELPER_ASSERT_SUCCESS(srs_hls_serve_playlist(&w, &r, playlist->content(), playlist->etag, playlist->last_modified));
+            string res = HELPER_BUFFER2STR(&w.io.out_buffer);
+            EXPECT_TRUE(res.find("HTTP/1.1 304") == 0);
+        }
+
+        // Response 200 if modified after the date of client, or the date is invalid.
+        for (int i = 0; i < 2; i++) {
+            MockResponseWriter w;
+            SrsHttpMessage r(NULL, NULL);
+            SrsHttpHeader h;
+            h.set("If-Modified-Since", i == 0 ? srs_http_format_date(modified - 1) : "invalid");
+            r.set_header(&h, false);
+            HELPER_ASSERT_SUCCESS(r.set_url("/live/livestream.m3u8", false));
+
+            HELPER_ASSERT_SUCCESS(srs_hls_serve_playlist(&w, &r, playlist->content(), playlist->etag, playlist->last_modified));
+            string res = HELPER_BUFFER2STR(&w.io.out_buffer);
+            EXPECT_TRUE(res.find("HTTP/1.1 200") == 0);
+        }
+    }
+
+    cache.remove("./objs/nginx/html/live/livestream.m3u8");
+    EXPECT_TRUE(cache.fetch("./objs/nginx/html/live/livestream.m3u8") == NULL);
+}
+
+VOID TEST(ProtocolHTTPTest, HTTPDate)
+{
+    EXPECT_STREQ("Sun, 06 Nov 1994 08:49:37 GMT", srs_http_format_date(784111777).c_str());
+
+    time_t t = 0;
+    EXPECT_TRUE(srs_http_parse_date("Sun, 06 Nov 1994 08:49:37 GMT", &t));
+    EXPECT_EQ(784111777, t);
+
+    t = 0;
+    EXPECT_TRUE(srs_http_parse_date("Sunday, 06-Nov-94 08:49:37 GMT", &t));
+    EXPECT_EQ(784111777, t);
+
+    t = 0;
+    EXPECT_TRUE(srs_http_parse_date("Sun Nov  6 08:49:37 1994", &t));
+    EXPECT_EQ(784111777, t);
+
+    EXPECT_FALSE(srs_http_parse_date("", &t));
+    EXPECT_FALSE(srs_http_parse_date("Sun, 06 Nov 1994 08:49:37 GMT+8", &t));
+    EXPECT_FALSE(srs_http_parse_date("1994-11-06", &t));
+}
+
 VOID TEST(ProtocolHTTPTest, VodStreamHandlers)
 {
     srs_error_t err;
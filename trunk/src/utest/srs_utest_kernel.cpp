@@ -4386,13 +4386,11 @@ VOID TEST(KernelFileWriterTest, WriteSpecialCase)
 		HELPER_EXPECT_SUCCESS(f.writev(iovs, 3, &nn));
 		EXPECT_EQ(5, nn);
 
+		// The writer tracks the logical offset itself.
 		off_t seeked = 0;
 		HELPER_EXPECT_SUCCESS(f.lseek(0, SEEK_CUR, &seeked));
-#ifdef SRS_OSX
 		EXPECT_EQ(10, seeked);
-#else
-		EXPECT_EQ(0, seeked);
-#endif
+		EXPECT_EQ(10, f.tellg());
 	}
 
 	// Always fail.
@@ -4435,12 +4433,14 @@ VOID TEST(KernelFileWriterTest, WriteSpecialCase)
 		HELPER_EXPECT_FAILED(f.set_iobuf_size(100));
 	}
 
+    // Never use ftell for tellg, because the writer tracks the offset.
     if (true) {
 		MockLibcIO _mockio(NULL, NULL, NULL, NULL, NULL, mock_ftell);
 		SrsFileWriter f;
 		HELPER_EXPECT_SUCCESS(f.open("/dev/null"));
 
-		EXPECT_EQ(f.tellg(), -1);
+		EXPECT_EQ(f.tellg(), 0);
+		HELPER_EXPECT_FAILED(f.lseek(0, SEEK_SET, NULL));
 	}
 }
 
@@ -4581,6 +4581,65 @@ VOID TEST(KernelFileTest, SeekCase)
 	EXPECT_STREQ("World", buf);
 }
 
+int mock_fseek_count = 0;
+int mock_counting_fseek(FILE* stream, long offset, int whence) {
+	mock_fseek_count++;
+	return ::fseek(stream, offset, whence);
+}
+
+int mock_fwrite_count = 0;
+size_t mock_counting_fwrite(const void* ptr, size_t size, size_t nitems, FILE* stream) {
+	mock_fwrite_count++;
+	return ::fwrite(ptr, size, nitems, stream);
+}
+
+VOID TEST(KernelFileTest, WriterTrackOffset)
+{
+	srs_error_t err;
+
+	string filepath = _srs_tmp_file_prefix + "kernel-file-track-offset.log";
+	MockFileRemover _mfr(filepath);
+
+	mock_fseek_count = mock_fwrite_count = 0;
+	MockLibcIO _mockio(NULL, mock_counting_fwrite, NULL, mock_counting_fseek);
+
+	SrsFileWriter w;
+	HELPER_EXPECT_SUCCESS(w.open(filepath.c_str()));
+	HELPER_EXPECT_SUCCESS(w.set_iobuf_size(65536));
+
+	// Like the MP4 encoder, query the offset before writing each sample, which
+	// should never seek the file, nor flush the libc cache.
+	char sample[188] = {0};
+	for (int i = 0; i < 1000; i++) {
+		off_t offset = 0;
+		HELPER_EXPECT_SUCCESS(w.lseek(0, SEEK_CUR, &offset));
+		EXPECT_EQ(i * 188, offset);
+		HELPER_EXPECT_SUCCESS(w.write(sample, sizeof(sample), NULL));
+	}
+	EXPECT_EQ(0, mock_fseek_count);
+	EXPECT_EQ(1000, mock_fwrite_count);
+	EXPECT_EQ(188000, w.tellg());
+
+	// Seek to update the header, then back to end of file.
+	off_t pos = 0;
+	HELPER_EXPECT_SUCCESS(w.lseek(100, SEEK_SET, &pos));
+	EXPECT_EQ(100, pos);
+	HELPER_EXPECT_SUCCESS(w.write(sample, 8, NULL));
+	EXPECT_EQ(108, w.tellg());
+	HELPER_EXPECT_SUCCESS(w.lseek(0, SEEK_END, &pos));
+	EXPECT_EQ(188000, pos);
+	EXPECT_EQ(2, mock_fseek_count);
+
+	w.close();
+
+	// Append mode starts from the end of file.
+	SrsFileWriter a;
+	HELPER_EXPECT_SUCCESS(a.open_append(filepath.c_str()));
+	EXPECT_EQ(188000, a.tellg());
+	HELPER_EXPECT_SUCCESS(a.write(sample, 12, NULL));
+	EXPECT_EQ(188012, a.tellg());
+}
+
 VOID TEST(KernelFLVTest, CoverAll)
 {
 	srs_error_t err;
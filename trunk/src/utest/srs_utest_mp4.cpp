@@ -1823,6 +1823,68 @@ VOID TEST(KernelMp4Test, STSDBox)
     }
 }
 
+VOID TEST(KernelMp4Test, SrsMp4M2tsSegmentEncoderChunked)
+{
+    srs_error_t err;
+
+    uint8_t sample[] = {0x00, 0x00, 0x00, 0x02, 0x09, 0xf0};
+
+    // Normal segment, with sidx and only one moof.
+    if (true) {
+        MockSrsFileWriter fw;
+        HELPER_ASSERT_SUCCESS(fw.open("test.m4s"));
+
+        SrsMp4M2tsSegmentEncoder enc;
+        HELPER_ASSERT_SUCCESS(enc.initialize(&fw, 1, 0, 1));
+        HELPER_ASSERT_SUCCESS(enc.write_sample(SrsMp4HandlerTypeVIDE, SrsVideoAvcFrameTypeKeyFrame, 0, 0, sample, sizeof(sample)));
+        HELPER_ASSERT_SUCCESS(enc.write_sample(SrsMp4HandlerTypeVIDE, SrsVideoAvcFrameTypeInterFrame, 40, 40, sample, sizeof(sample)));
+
+        uint64_t dts = 80;
+        HELPER_ASSERT_SUCCESS(enc.flush(dts));
+
+        string data = fw.str();
+        EXPECT_TRUE(data.find("sidx") != string::npos);
+        EXPECT_EQ(data.find("moof"), data.rfind("moof"));
+        EXPECT_EQ(2, (int)enc.sequence());
+    }
+
+    // Chunked segment, each chunk is a moof and mdat, without sidx.
+    if (true) {
+        MockSrsFileWriter fw;
+        HELPER_ASSERT_SUCCESS(fw.open("test.m4s"));
+
+        SrsMp4M2tsSegmentEncoder enc;
+        HELPER_ASSERT_SUCCESS(enc.initialize(&fw, 1, 0, 1));
+        int64_t styp_bytes = fw.tellg();
+
+        // Nothing to write for empty chunk.
+        HELPER_ASSERT_SUCCESS(enc.flush_chunk(0));
+        EXPECT_EQ(styp_bytes, fw.tellg());
+
+        HELPER_ASSERT_SUCCESS(enc.write_sample(SrsMp4HandlerTypeVIDE, SrsVideoAvcFrameTypeKeyFrame, 0, 0, sample, sizeof(sample)));
+        HELPER_ASSERT_SUCCESS(enc.flush_chunk(40));
+        int64_t chunk_bytes = fw.tellg();
+        EXPECT_GT(chunk_bytes, styp_bytes);
+
+        HELPER_ASSERT_SUCCESS(enc.write_sample(SrsMp4HandlerTypeVIDE, SrsVideoAvcFrameTypeInterFrame, 40, 40, sample, sizeof(sample)));
+        uint64_t dts = 80;
+        HELPER_ASSERT_SUCCESS(enc.flush(dts));
+        EXPECT_GT(fw.tellg(), chunk_bytes);
+
+        string data = fw.str();
+        EXPECT_TRUE(data.find("sidx") == string::npos);
+        EXPECT_NE(data.find("moof"), data.rfind("moof"));
+
+        // The sequence number of mfhd increases for each moof, after the version and flags.
+        size_t first = data.find("mfhd"), last = data.rfind("mfhd");
+        ASSERT_NE(first, last);
+        SrsBuffer b0((char*)data.data() + first + 8, 4), b1((char*)data.data() + last + 8, 4);
+        EXPECT_EQ(1, b0.read_4bytes());
+        EXPECT_EQ(2, b1.read_4bytes());
+        EXPECT_EQ(3, (int)enc.sequence());
+    }
+}
+
 VOID TEST(KernelMp4Test, SrsMp4M2tsInitEncoder)
 {
     srs_error_t err;
@@ -1869,3 +1931,121 @@ VOID TEST(KernelMp4Test, SrsMp4M2tsInitEncoder)
     }
 }
 
+
+// Get the offset in file of the sample to start from.
+static int64_t mock_mp4_offset_of(SrsMp4VodIndex* index, uint32_t time)
+{
+    int i = index->seek(time);
+    return (i < 0)? -1 : (int64_t)index->samples_->samples[i]->offset;
+}
+
+VOID TEST(KernelMp4Test, SrsMp4VodIndexTrim)
+{
+    srs_error_t err;
+
+    MockSrsFileWriter f;
+
+    // Two GOPs, keyframe at 0ms and 1000ms, with an audio frame at each 500ms.
+    if (true) {
+        SrsMp4Encoder enc; SrsFormat fmt;
+        HELPER_ASSERT_SUCCESS(enc.initialize(&f));
+        HELPER_ASSERT_SUCCESS(fmt.initialize());
+
+        uint8_t sh[] = {
+            0x17, 0x00, 0x00, 0x00, 0x00, 0x01, 0x64, 0x00, 0x20, 0xff, 0xe1, 0x00, 0x19, 0x67, 0x64, 0x00, 0x20, 0xac, 0xd9, 0x40, 0xc0, 0x29, 0xb0, 0x11, 0x00, 0x00, 0x03, 0x00, 0x01, 0x00, 0x00, 0x03, 0x00, 0x32, 0x0f, 0x18, 0x31, 0x96, 0x01, 0x00, 0x05, 0x68, 0xeb, 0xec, 0xb2, 0x2c
+        };
+        HELPER_ASSERT_SUCCESS(fmt.on_video(0, (char*)sh, sizeof(sh)));
+        HELPER_ASSERT_SUCCESS(enc.write_sample(&fmt, SrsMp4HandlerTypeVIDE, fmt.video->frame_type, fmt.video->avc_packet_type, 0, 0, (uint8_t*)fmt.raw, fmt.nb_raw));
+
+        uint8_t ash[] = {0xaf, 0x00, 0x12, 0x10};
+        HELPER_ASSERT_SUCCESS(fmt.on_audio(0, (char*)ash, sizeof(ash)));
+        HELPER_ASSERT_SUCCESS(enc.write_sample(&fmt, SrsMp4HandlerTypeSOUN, 0x00, fmt.audio->aac_packet_type, 0, 0, (uint8_t*)fmt.raw, fmt.nb_raw));
+
+        for (int i = 0; i < 4; i++) {
+            uint32_t dts = i * 500;
+
+            uint8_t video[] = {0x27, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x05, 0x41, 0x9a, 0x21, 0x6c, (uint8_t)i};
+            if (i % 2 == 0) {
+                video[0] = 0x17;
+            }
+            HELPER_ASSERT_SUCCESS(fmt.on_video(0, (char*)video, sizeof(video)));
+            HELPER_ASSERT_SUCCESS(enc.write_sample(&fmt, SrsMp4HandlerTypeVIDE, fmt.video->frame_type, fmt.video->avc_packet_type, dts, dts, (uint8_t*)fmt.raw, fmt.nb_raw));
+
+            uint8_t audio[] = {0xaf, 0x01, 0x21, 0x11, 0x45, (uint8_t)i};
+            HELPER_ASSERT_SUCCESS(fmt.on_audio(0, (char*)audio, sizeof(audio)));
+            HELPER_ASSERT_SUCCESS(enc.write_sample(&fmt, SrsMp4HandlerTypeSOUN, 0x00, fmt.audio->aac_packet_type, dts, dts, (uint8_t*)fmt.raw, fmt.nb_raw));
+        }
+
+        enc.acodec = SrsAudioCodecIdAAC;
+        enc.vcodec = SrsVideoCodecIdAVC;
+        HELPER_ASSERT_SUCCESS(enc.flush());
+    }
+
+    MockSrsFileReader fr((const char*)f.data(), f.filesize());
+    SrsMp4VodIndex index;
+    HELPER_ASSERT_SUCCESS(index.initialize(&fr));
+
+    // Seek to the keyframe at or before the time.
+    EXPECT_EQ(mock_mp4_offset_of(&index, 0), mock_mp4_offset_of(&index, 999));
+    EXPECT_EQ(mock_mp4_offset_of(&index, 1000), mock_mp4_offset_of(&index, 1500));
+    EXPECT_EQ(mock_mp4_offset_of(&index, 1000), mock_mp4_offset_of(&index, 100000));
+    EXPECT_LT(mock_mp4_offset_of(&index, 0), mock_mp4_offset_of(&index, 1000));
+
+    // Build the trimmed MP4 from the second GOP.
+    string head;
+    int64_t start = 0, end = 0;
+    HELPER_ASSERT_SUCCESS(index.trim(1500, head, start, end));
+    EXPECT_EQ(mock_mp4_offset_of(&index, 1500), start);
+    EXPECT_LT(start, end);
+    EXPECT_LT(end, f.filesize());
+
+    // The moov is immutable, so trim from other time must not change the next result.
+    if (true) {
+        string h0; int64_t s0 = 0, e0 = 0;
+        HELPER_ASSERT_SUCCESS(index.trim(0, h0, s0, e0));
+        EXPECT_EQ(mock_mp4_offset_of(&index, 0), s0);
+        EXPECT_NE(head, h0);
+
+        string h1; int64_t s1 = 0, e1 = 0;
+        HELPER_ASSERT_SUCCESS(index.trim(1500, h1, s1, e1));
+        EXPECT_EQ(head, h1); EXPECT_EQ(start, s1); EXPECT_EQ(end, e1);
+    }
+
+    string trimmed = head + string(f.data() + start, end - start);
+    MockSrsFileReader tr(trimmed.data(), (int)trimmed.length());
+    SrsMp4Decoder dec;
+    HELPER_ASSERT_SUCCESS(dec.initialize(&tr));
+
+    SrsMp4HandlerType ht; uint16_t ft, ct; uint32_t dts, pts, nb_sample; uint8_t* sample = NULL;
+
+    // Sequence header.
+    HELPER_ASSERT_SUCCESS(dec.read_sample(&ht, &ft, &ct, &dts, &pts, &sample, &nb_sample));
+    EXPECT_EQ(SrsMp4HandlerTypeVIDE, ht); EXPECT_EQ(SrsVideoAvcFrameTraitSequenceHeader, ct);
+    srs_freepa(sample);
+
+    HELPER_ASSERT_SUCCESS(dec.read_sample(&ht, &ft, &ct, &dts, &pts, &sample, &nb_sample));
+    EXPECT_EQ(SrsMp4HandlerTypeSOUN, ht); EXPECT_EQ(SrsAudioAacFrameTraitSequenceHeader, ct);
+    srs_freepa(sample);
+
+    // Starts from the keyframe of second GOP, with the timestamp from 0.
+    HELPER_ASSERT_SUCCESS(dec.read_sample(&ht, &ft, &ct, &dts, &pts, &sample, &nb_sample));
+    EXPECT_EQ(SrsMp4HandlerTypeVIDE, ht); EXPECT_EQ(SrsVideoAvcFrameTypeKeyFrame, ft); EXPECT_EQ(0, (int)dts);
+    EXPECT_EQ(2, (int)sample[nb_sample - 1]);
+    srs_freepa(sample);
+
+    HELPER_ASSERT_SUCCESS(dec.read_sample(&ht, &ft, &ct, &dts, &pts, &sample, &nb_sample));
+    EXPECT_EQ(SrsMp4HandlerTypeSOUN, ht); EXPECT_EQ(0, (int)dts);
+    EXPECT_EQ(2, (int)sample[nb_sample - 1]);
+    srs_freepa(sample);
+
+    HELPER_ASSERT_SUCCESS(dec.read_sample(&ht, &ft, &ct, &dts, &pts, &sample, &nb_sample));
+    EXPECT_EQ(SrsMp4HandlerTypeVIDE, ht); EXPECT_EQ(SrsVideoAvcFrameTypeInterFrame, ft); EXPECT_EQ(500, (int)dts);
+    EXPECT_EQ(3, (int)sample[nb_sample - 1]);
+    srs_freepa(sample);
+
+    HELPER_ASSERT_SUCCESS(dec.read_sample(&ht, &ft, &ct, &dts, &pts, &sample, &nb_sample));
+    EXPECT_EQ(SrsMp4HandlerTypeSOUN, ht); EXPECT_EQ(500, (int)dts);
+    srs_freepa(sample);
+
+    HELPER_EXPECT_FAILED(dec.read_sample(&ht, &ft, &ct, &dts, &pts, &sample, &nb_sample));
+}
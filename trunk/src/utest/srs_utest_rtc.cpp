@@ -14,6 +14,11 @@
 #include <srs_app_rtc_conn.hpp>
 #include <srs_kernel_codec.hpp>
 #include <srs_app_conn.hpp>
+#include <srs_app_rtc_pacer.hpp>
+#include <srs_app_rtc_dtls.hpp>
+#include <srs_app_threads.hpp>
+#include <srs_core_performance.hpp>
+#include <srs_protocol_rtc_stun.hpp>
 
 #include <srs_utest_service.hpp>
 
@@ -1369,3 +1374,1298 @@ VOID TEST(KernelRTCTest, JitterSequence)
     EXPECT_EQ((uint32_t)11, jitter.correct(11));
 }
 
+
+VOID TEST(KernelRTCTest, SrsRtcpTWCCDecodeStatus)
+{
+    srs_error_t err = srs_success;
+
+    // The sn=102 is lost, and sn=103 is a large delta which requires two bytes.
+    SrsRtcpTWCC encoder(0x0A);
+    encoder.set_media_ssrc(0x0B);
+    srs_utime_t base = 6400 * SRS_UTIME_MILLISECONDS;
+    HELPER_ASSERT_SUCCESS(encoder.recv_packet(100, base));
+    HELPER_ASSERT_SUCCESS(encoder.recv_packet(101, base + 1 * SRS_UTIME_MILLISECONDS));
+    HELPER_ASSERT_SUCCESS(encoder.recv_packet(103, base + 100 * SRS_UTIME_MILLISECONDS));
+
+    char buf[kRtcpPacketSize];
+    SrsBuffer stream(buf, sizeof(buf));
+    HELPER_ASSERT_SUCCESS(encoder.encode(&stream));
+
+    SrsRtcpTWCC decoder;
+    SrsBuffer b(buf, stream.pos());
+    HELPER_ASSERT_SUCCESS(decoder.decode(&b));
+    EXPECT_EQ((uint32_t)0x0B, decoder.get_media_ssrc());
+    EXPECT_EQ(100, decoder.get_base_sn());
+
+    const vector<SrsRtcpTWCCStatus>& status = decoder.get_recv_status();
+    ASSERT_EQ(4, (int)status.size());
+
+    EXPECT_EQ(100, status[0].sn);
+    EXPECT_TRUE(status[0].received);
+    EXPECT_EQ(base, status[0].recv_time);
+
+    EXPECT_EQ(101, status[1].sn);
+    EXPECT_TRUE(status[1].received);
+    EXPECT_EQ(base + 1 * SRS_UTIME_MILLISECONDS, status[1].recv_time);
+
+    EXPECT_EQ(102, status[2].sn);
+    EXPECT_FALSE(status[2].received);
+
+    EXPECT_EQ(103, status[3].sn);
+    EXPECT_TRUE(status[3].received);
+    EXPECT_EQ(base + 100 * SRS_UTIME_MILLISECONDS, status[3].recv_time);
+}
+
+VOID TEST(KernelRTCTest, SrsRtcpRemb)
+{
+    srs_error_t err = srs_success;
+
+    SrsRtcpRemb encoder(0x0A);
+    encoder.set_bitrate(1234567);
+    encoder.add_ssrc(0x0B);
+    encoder.add_ssrc(0x0C);
+
+    char buf[kRtcpPacketSize];
+    SrsBuffer stream(buf, sizeof(buf));
+    HELPER_ASSERT_SUCCESS(encoder.encode(&stream));
+    EXPECT_EQ(28, stream.pos());
+
+    // The compound should decode the AFB as REMB.
+    SrsRtcpCompound compound;
+    SrsBuffer b(buf, stream.pos());
+    HELPER_ASSERT_SUCCESS(compound.decode(&b));
+
+    SrsRtcpCommon* rtcp = compound.get_next_rtcp();
+    SrsAutoFree(SrsRtcpCommon, rtcp);
+
+    SrsRtcpRemb* remb = dynamic_cast<SrsRtcpRemb*>(rtcp);
+    ASSERT_TRUE(remb != NULL);
+    EXPECT_TRUE(remb->is_remb());
+    // The mantissa is 18 bits, so we lost some precision.
+    EXPECT_EQ((uint64_t)1234560, remb->get_bitrate());
+    ASSERT_EQ(2, (int)remb->get_ssrcs().size());
+    EXPECT_EQ((uint32_t)0x0B, remb->get_ssrcs().at(0));
+    EXPECT_EQ((uint32_t)0x0C, remb->get_ssrcs().at(1));
+}
+
+// Simulate the network link of player, which generates the TWCC feedback for estimator, and drops packets
+// like the NACK simulator of SrsRtcConnection.
+class MockRtcPlayerLink
+{
+public:
+    SrsRtcBandwidthEstimator bwe;
+    // The capacity of link in bps.
+    int64_t capacity;
+    // Drop the next N packets, see SrsRtcConnection::simulate_nack_drop.
+    int nn_simulate_player_nack_drop;
+private:
+    uint16_t sn_;
+    srs_utime_t link_free_;
+    std::map<uint16_t, srs_utime_t> arrivals_;
+public:
+    MockRtcPlayerLink(int64_t c) {
+        capacity = c;
+        nn_simulate_player_nack_drop = 0;
+        sn_ = 0;
+        link_free_ = 0;
+    }
+public:
+    void send(int size, srs_utime_t now) {
+        bwe.on_packet_sent(++sn_, size, now);
+
+        if (nn_simulate_player_nack_drop) {
+            nn_simulate_player_nack_drop--;
+            return;
+        }
+
+        // The packet queues in link, and the propagation delay is 20ms.
+        srs_utime_t arrival = srs_max(now, link_free_) + size * 8 * SRS_UTIME_SECONDS / capacity;
+        link_free_ = arrival;
+        arrivals_[sn_] = arrival + 20 * SRS_UTIME_MILLISECONDS;
+    }
+    srs_error_t feedback(srs_utime_t now) {
+        srs_error_t err = srs_success;
+
+        SrsRtcpTWCC twcc;
+        for (std::map<uint16_t, srs_utime_t>::iterator it = arrivals_.begin(); it != arrivals_.end();) {
+            if (it->second > now) {
+                ++it;
+                continue;
+            }
+            if ((err = twcc.recv_packet(it->first, it->second)) != srs_success) {
+                return srs_error_wrap(err, "recv");
+            }
+            arrivals_.erase(it++);
+        }
+
+        while (twcc.need_feedback()) {
+            char buf[kRtcpPacketSize];
+            SrsBuffer stream(buf, sizeof(buf));
+            if ((err = twcc.encode(&stream)) != srs_success) {
+                return srs_error_wrap(err, "encode");
+            }
+
+            SrsRtcpTWCC decoder;
+            SrsBuffer b(buf, stream.pos());
+            if ((err = decoder.decode(&b)) != srs_success) {
+                return srs_error_wrap(err, "decode");
+            }
+
+            if ((err = bwe.on_twcc_feedback(&decoder, now)) != srs_success) {
+                return srs_error_wrap(err, "feedback");
+            }
+        }
+
+        return err;
+    }
+    // Play a stream of bitrate for duration, a frame per 30ms which is sent in a burst of packets.
+    srs_error_t play(int64_t bitrate, srs_utime_t start, srs_utime_t duration, int drop_every = 0) {
+        srs_error_t err = srs_success;
+
+        int nn_packets = 0;
+        int frame_bytes = (int)(bitrate / 8 * 30 / 1000);
+        for (srs_utime_t now = start; now < start + duration; now += 10 * SRS_UTIME_MILLISECONDS) {
+            if (((now - start) / (10 * SRS_UTIME_MILLISECONDS)) % 3 == 0) {
+                for (int left = frame_bytes; left > 0; left -= 1200) {
+                    if (drop_every && ++nn_packets % drop_every == 0) {
+                        nn_simulate_player_nack_drop = 3;
+                    }
+                    send(srs_min(left, 1200), now);
+                }
+            }
+
+            // Feedback every 100ms.
+            if (((now - start) / (10 * SRS_UTIME_MILLISECONDS)) % 10 == 0) {
+                if ((err = feedback(now)) != srs_success) {
+                    return srs_error_wrap(err, "feedback");
+                }
+            }
+        }
+
+        return err;
+    }
+};
+
+VOID TEST(KernelRTCTest, BandwidthEstimatorNormal)
+{
+    srs_error_t err = srs_success;
+
+    // The link is large enough for the stream, so the estimate increase to the stream bitrate.
+    MockRtcPlayerLink link(10 * 1000 * 1000);
+    HELPER_ASSERT_SUCCESS(link.play(2 * 1000 * 1000, 10 * SRS_UTIME_SECONDS, 15 * SRS_UTIME_SECONDS));
+
+    EXPECT_NE(SrsRtcBweStateOverusing, link.bwe.state());
+    EXPECT_EQ(0, link.bwe.loss());
+    EXPECT_GT(link.bwe.bitrate(), 1500 * 1000);
+    EXPECT_NEAR(2000 * 1000, link.bwe.sent_bitrate(), 100 * 1000);
+    EXPECT_NEAR(2000 * 1000, link.bwe.acked_bitrate(), 200 * 1000);
+
+    // The REMB limits the estimate.
+    link.bwe.on_remb(800 * 1000);
+    EXPECT_EQ(800 * 1000, link.bwe.bitrate());
+}
+
+VOID TEST(KernelRTCTest, BandwidthEstimatorOveruse)
+{
+    srs_error_t err = srs_success;
+
+    // The link is smaller than the stream, the queue delay increase, so the estimate decrease.
+    MockRtcPlayerLink link(1000 * 1000);
+    HELPER_ASSERT_SUCCESS(link.play(2 * 1000 * 1000, 10 * SRS_UTIME_SECONDS, 5 * SRS_UTIME_SECONDS));
+
+    EXPECT_EQ(0, link.bwe.loss());
+    EXPECT_LT(link.bwe.bitrate(), 1000 * 1000);
+    EXPECT_NEAR(1000 * 1000, link.bwe.acked_bitrate(), 100 * 1000);
+}
+
+VOID TEST(KernelRTCTest, BandwidthEstimatorLoss)
+{
+    srs_error_t err = srs_success;
+
+    // Drop 3 packets for every 10 packets, the loss-based controller decrease the estimate.
+    MockRtcPlayerLink link(10 * 1000 * 1000);
+    HELPER_ASSERT_SUCCESS(link.play(2 * 1000 * 1000, 10 * SRS_UTIME_SECONDS, 5 * SRS_UTIME_SECONDS, 10));
+
+    EXPECT_GT(link.bwe.loss(), 0.2);
+    EXPECT_LT(link.bwe.bitrate(), 1000 * 1000);
+}
+
+VOID TEST(KernelRTCTest, RtcPacer)
+{
+    SrsRtcPacer pacer;
+    pacer.set_rate(1000 * 1000);
+
+    // Always allow the first packet, and wait for the debt to be paid off.
+    srs_utime_t now = 10 * SRS_UTIME_SECONDS;
+    EXPECT_EQ(0, pacer.on_packet(1000, now));
+    srs_utime_t delay = pacer.on_packet(1000, now);
+    EXPECT_NEAR(8 * SRS_UTIME_MILLISECONDS, delay, 10);
+    EXPECT_EQ(0, pacer.on_packet(1000, now + delay));
+
+    // The budget is limited after idle, so the burst is about 20ms of data, that is 2500 bytes.
+    now += 1 * SRS_UTIME_SECONDS;
+    EXPECT_EQ(0, pacer.on_packet(1000, now));
+    EXPECT_EQ(0, pacer.on_packet(1000, now));
+    EXPECT_EQ(0, pacer.on_packet(1000, now));
+    EXPECT_GT(pacer.on_packet(1000, now), 0);
+}
+
+VOID TEST(KernelRTCTest, SdpSimulcast)
+{
+    srs_error_t err;
+
+    SrsMediaDesc desc("video");
+    HELPER_ASSERT_SUCCESS(desc.parse_line("a=rid:h send max-width=1280;max-height=720"));
+    HELPER_ASSERT_SUCCESS(desc.parse_line("a=rid:m send"));
+    HELPER_ASSERT_SUCCESS(desc.parse_line("a=rid:l send"));
+    HELPER_ASSERT_SUCCESS(desc.parse_line("a=simulcast:send h;~m;l,x"));
+    HELPER_EXPECT_FAILED(desc.parse_line("a=rid:q unknown"));
+
+    ASSERT_EQ(3, (int)desc.rids_.size());
+    EXPECT_STREQ("h", desc.rids_.at(0).rid_.c_str());
+    EXPECT_STREQ("send", desc.rids_.at(0).direction_.c_str());
+    EXPECT_STREQ("max-width=1280;max-height=720", desc.rids_.at(0).params_.c_str());
+    EXPECT_TRUE(desc.rids_.at(1).params_.empty());
+
+    EXPECT_STREQ("send", desc.simulcast_direction_.c_str());
+    ASSERT_EQ(3, (int)desc.simulcast_rids_.size());
+    EXPECT_STREQ("h", desc.simulcast_rids_.at(0).c_str());
+    EXPECT_STREQ("m", desc.simulcast_rids_.at(1).c_str());
+    EXPECT_STREQ("l", desc.simulcast_rids_.at(2).c_str());
+
+    // Pick the first alternative which is not paused.
+    if (true) {
+        SrsMediaDesc d("video");
+        HELPER_ASSERT_SUCCESS(d.parse_line("a=simulcast:recv ~h,h2;~m1,~m2"));
+        EXPECT_STREQ("recv", d.simulcast_direction_.c_str());
+        ASSERT_EQ(2, (int)d.simulcast_rids_.size());
+        EXPECT_STREQ("h2", d.simulcast_rids_.at(0).c_str());
+        EXPECT_STREQ("m1", d.simulcast_rids_.at(1).c_str());
+    }
+
+    // Reject the invalid or unsupported simulcast.
+    if (true) {
+        SrsMediaDesc d("video");
+        HELPER_EXPECT_FAILED(d.parse_line("a=simulcast:sendrecv h;l"));
+        HELPER_EXPECT_FAILED(d.parse_line("a=simulcast:send h;l recv x"));
+        HELPER_EXPECT_FAILED(d.parse_line("a=simulcast:send h;;l"));
+        HELPER_EXPECT_FAILED(d.parse_line("a=simulcast:send h;~"));
+        HELPER_EXPECT_FAILED(d.parse_line("a=simulcast:send h;l=1"));
+    }
+
+    // Answer with recv direction.
+    SrsMediaDesc answer("video");
+    answer.rids_.push_back(SrsRidInfo("h", "recv"));
+    answer.rids_.push_back(SrsRidInfo("l", "recv"));
+    answer.simulcast_direction_ = "recv";
+    answer.simulcast_rids_.push_back("h");
+    answer.simulcast_rids_.push_back("l");
+
+    std::ostringstream os;
+    HELPER_ASSERT_SUCCESS(answer.encode(os));
+    EXPECT_TRUE(os.str().find("a=rid:h recv\r\na=rid:l recv\r\na=simulcast:recv h;l\r\n") != std::string::npos);
+}
+
+VOID TEST(KernelRTCTest, FastParseRid)
+{
+    srs_error_t err;
+
+    // The RTP header with one-byte extension, TWCC(id=3) and RID(id=10) with padding.
+    uint8_t data[] = {
+        0x90, 0x66, 0x00, 0x01, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x03, 0xe8,
+        0xbe, 0xde, 0x00, 0x02,
+        0x31, 0x00, 0x01, 0xa0, 0x68, 0x00, 0x00, 0x00,
+        0x00, 0x00,
+    };
+
+    std::string rid;
+    HELPER_ASSERT_SUCCESS(srs_rtp_fast_parse_rid((char*)data, sizeof(data), 10, rid));
+    EXPECT_STREQ("h", rid.c_str());
+
+    // The TWCC is found by the same extension parser.
+    uint16_t twcc_sn = 0;
+    HELPER_ASSERT_SUCCESS(srs_rtp_fast_parse_twcc((char*)data, sizeof(data), 3, twcc_sn));
+    EXPECT_EQ(1, twcc_sn);
+
+    char* p = NULL; int nb_p = 0;
+    HELPER_ASSERT_SUCCESS(srs_rtp_fast_find_extension((char*)data, sizeof(data), 10, &p, &nb_p));
+    EXPECT_EQ(1, nb_p); EXPECT_EQ((char*)data + 20, p);
+
+    // No such extension.
+    HELPER_EXPECT_FAILED(srs_rtp_fast_parse_rid((char*)data, sizeof(data), 5, rid));
+    HELPER_EXPECT_FAILED(srs_rtp_fast_parse_twcc((char*)data, sizeof(data), 5, twcc_sn));
+
+    // Truncated packet.
+    HELPER_EXPECT_FAILED(srs_rtp_fast_parse_rid((char*)data, 20, 10, rid));
+
+    // No extension.
+    data[0] = 0x80;
+    HELPER_EXPECT_FAILED(srs_rtp_fast_parse_rid((char*)data, sizeof(data), 10, rid));
+}
+
+VOID TEST(KernelRTCTest, ExtensionLayout)
+{
+    srs_error_t err;
+
+    // The RTP header with one-byte extension, audio-level(id=1), abs-send-time(id=2) which is not used, TWCC(id=3),
+    // unknown(id=5) and padding, then 4 bytes payload.
+    uint8_t data[] = {
+        0x90, 0x6f, 0x00, 0x01, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x03, 0xe8,
+        0xbe, 0xde, 0x00, 0x04,
+        0x10, 0x85, 0x22, 0x12, 0x34, 0x56, 0x31, 0x01, 0xa0, 0x50, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0xab, 0xcd, 0xef, 0x01,
+    };
+
+    SrsRtpExtensionTypes types;
+    EXPECT_TRUE(types.register_by_uri(1, kAudioLevelUri));
+    EXPECT_FALSE(types.register_by_uri(2, "http://www.webrtc.org/experiments/rtp-hdrext/abs-send-time"));
+    EXPECT_TRUE(types.register_by_uri(3, "http://www.ietf.org/id/draft-holmer-rmcat-transport-wide-cc-extensions-01"));
+    EXPECT_FALSE(types.register_by_uri(5, "urn:ietf:params:rtp-hdrext:sdes:mid"));
+    EXPECT_EQ(kRtpExtensionAudioLevel, types.get_type(1));
+    EXPECT_EQ(kRtpExtensionNone, types.get_type(2));
+    EXPECT_EQ(kRtpExtensionTransportSequenceNumber, types.get_type(3));
+    EXPECT_EQ(kRtpExtensionNone, types.get_type(5));
+    EXPECT_EQ(kRtpExtensionNone, types.get_type(0));
+    EXPECT_EQ(kRtpExtensionNone, types.get_type(15));
+    EXPECT_EQ(3, types.get_id(kRtpExtensionTransportSequenceNumber));
+
+    // Decode the extensions by layout.
+    if (true) {
+        SrsRtpHeader h;
+        h.set_extensions(&types);
+        h.enable_twcc_decode();
+
+        SrsBuffer b((char*)data, sizeof(data));
+        HELPER_ASSERT_SUCCESS(h.decode(&b));
+        EXPECT_EQ(4, b.left());
+
+        uint16_t twcc_sn = 0;
+        HELPER_EXPECT_SUCCESS(h.get_twcc_sequence_number(twcc_sn));
+        EXPECT_EQ(0x01a0, twcc_sn);
+
+        uint8_t level = 0;
+        HELPER_EXPECT_SUCCESS(h.get_extensions()->get_audio_level(level));
+        EXPECT_EQ(0x85, level);
+
+        // The decoded audio-level is never encoded, only the TWCC.
+        char buf[64];
+        SrsBuffer eb(buf, sizeof(buf));
+        HELPER_ASSERT_SUCCESS(h.encode(&eb));
+        EXPECT_EQ(20, eb.pos());
+        EXPECT_EQ((int)h.nb_bytes(), eb.pos());
+        EXPECT_EQ(0x31, (uint8_t)buf[16]);
+    }
+
+    // Without TWCC decoding, or without layout.
+    if (true) {
+        SrsRtpHeader h;
+        h.set_extensions(&types);
+
+        SrsBuffer b((char*)data, sizeof(data));
+        HELPER_ASSERT_SUCCESS(h.decode(&b));
+
+        uint16_t twcc_sn = 0;
+        HELPER_EXPECT_FAILED(h.get_twcc_sequence_number(twcc_sn));
+
+        SrsRtpHeader h2;
+        SrsBuffer b2((char*)data, sizeof(data));
+        HELPER_ASSERT_SUCCESS(h2.decode(&b2));
+        EXPECT_EQ(4, b2.left());
+
+        uint8_t level = 0;
+        HELPER_EXPECT_FAILED(h2.get_extensions()->get_audio_level(level));
+    }
+
+    // Register the TWCC to another id, the previous id is unregistered.
+    if (true) {
+        SrsRtpExtensionTypes t2;
+        EXPECT_TRUE(t2.register_by_uri(3, "http://www.ietf.org/id/draft-holmer-rmcat-transport-wide-cc-extensions-01"));
+        EXPECT_TRUE(t2.register_by_uri(4, "http://www.ietf.org/id/draft-holmer-rmcat-transport-wide-cc-extensions-01"));
+        EXPECT_EQ(kRtpExtensionNone, t2.get_type(3));
+        EXPECT_EQ(kRtpExtensionTransportSequenceNumber, t2.get_type(4));
+    }
+}
+
+VOID TEST(KernelRTCTest, WirePayload)
+{
+    srs_error_t err;
+
+    // The RTP packet from publisher, with TWCC(id=3), 6 bytes payload and 2 bytes padding.
+    uint8_t data[] = {
+        0xb0, 0x66, 0x00, 0x01, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x03, 0xe8,
+        0xbe, 0xde, 0x00, 0x01, 0x31, 0x01, 0xa0, 0x00,
+        0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x02, 0x02,
+    };
+
+    // The player rewrites the header of packet from publisher, and sends the wire bytes of payload.
+    if (true) {
+        SrsRtpPacket pkt;
+        char* p = pkt.wrap((char*)data, sizeof(data));
+        SrsBuffer b(p, sizeof(data));
+        HELPER_ASSERT_SUCCESS(pkt.decode(&b));
+        EXPECT_TRUE(pkt.has_wire_payload());
+
+        SrsRtpPacket* cp = pkt.copy();
+        SrsAutoFree(SrsRtpPacket, cp);
+        EXPECT_TRUE(cp->has_wire_payload());
+        cp->header.set_ssrc(0x2000);
+        cp->header.set_payload_type(111);
+        cp->header.set_sequence(100);
+        cp->header.set_twcc_sequence_number(5, 0x1234);
+
+        char buf[64];
+        SrsBuffer eb(buf, sizeof(buf));
+        HELPER_ASSERT_SUCCESS(cp->encode(&eb));
+
+        // The expected packet, which is encoded by objects.
+        SrsRtpPacket expect;
+        expect.header.set_ssrc(0x2000);
+        expect.header.set_payload_type(111);
+        expect.header.set_sequence(100);
+        expect.header.set_timestamp(0x10);
+        expect.header.set_padding(2);
+        expect.header.set_twcc_sequence_number(5, 0x1234);
+        SrsRtpRawPayload* raw = new SrsRtpRawPayload();
+        raw->payload = (char*)data + 20;
+        raw->nn_payload = 6;
+        expect.set_payload(raw, SrsRtspPacketPayloadTypeRaw);
+        EXPECT_FALSE(expect.has_wire_payload());
+
+        char ebuf[64];
+        SrsBuffer eeb(ebuf, sizeof(ebuf));
+        HELPER_ASSERT_SUCCESS(expect.encode(&eeb));
+        ASSERT_EQ(eeb.pos(), eb.pos());
+        EXPECT_EQ(0, memcmp(buf, ebuf, eb.pos()));
+        EXPECT_EQ(0x51, (uint8_t)buf[16]);
+        EXPECT_EQ(0x61, (uint8_t)buf[20]);
+
+        // Never use the wire bytes if payload changed.
+        ISrsRtpPayloader* previous = cp->payload();
+        SrsAutoFree(ISrsRtpPayloader, previous);
+        cp->set_payload(new SrsRtpRawPayload(), SrsRtspPacketPayloadTypeRaw);
+        EXPECT_FALSE(cp->has_wire_payload());
+    }
+
+    // The payload is encoded once for packets from other source, for example, RTMP.
+    if (true) {
+        SrsRtpPacket pkt;
+        pkt.header.set_ssrc(0x1000);
+        pkt.header.set_sequence(1);
+        SrsRtpRawPayload* raw = new SrsRtpRawPayload();
+        raw->payload = (char*)data + 20;
+        raw->nn_payload = 6;
+        pkt.set_payload(raw, SrsRtspPacketPayloadTypeRaw);
+
+        char ebuf[64];
+        SrsBuffer eeb(ebuf, sizeof(ebuf));
+        HELPER_ASSERT_SUCCESS(pkt.encode(&eeb));
+
+        HELPER_ASSERT_SUCCESS(pkt.cache_payload());
+        EXPECT_TRUE(pkt.has_wire_payload());
+
+        SrsRtpPacket* cp = pkt.copy();
+        SrsAutoFree(SrsRtpPacket, cp);
+        EXPECT_TRUE(cp->has_wire_payload());
+
+        // Change the payload, the wire bytes is not changed.
+        raw->payload = (char*)data;
+
+        char buf[64];
+        SrsBuffer eb(buf, sizeof(buf));
+        HELPER_ASSERT_SUCCESS(cp->encode(&eb));
+        ASSERT_EQ(eeb.pos(), eb.pos());
+        EXPECT_EQ(0, memcmp(buf, ebuf, eb.pos()));
+    }
+}
+
+VOID TEST(KernelRTCTest, JitterRebase)
+{
+    SrsRtcSeqJitter seq(100);
+    EXPECT_EQ((uint16_t)100, seq.correct(5000));
+    EXPECT_EQ((uint16_t)101, seq.correct(5001));
+
+    // Switch to another stream, continue from the last value.
+    seq.rebase(1);
+    EXPECT_EQ((uint16_t)102, seq.correct(30000));
+    EXPECT_EQ((uint16_t)103, seq.correct(30001));
+
+    SrsRtcTsJitter ts(1000);
+    EXPECT_EQ((uint32_t)1000, ts.correct(90000));
+    EXPECT_EQ((uint32_t)4000, ts.correct(93000));
+
+    ts.rebase(3000);
+    EXPECT_EQ((uint32_t)7000, ts.correct(1000));
+    EXPECT_EQ((uint32_t)10000, ts.correct(4000));
+}
+
+// Feed packets of simulcast layers to track, for duration in 10ms, return the SSRC of last forwarded packet.
+static uint32_t mock_simulcast_feed(SrsRtcVideoSendTrack* track, srs_utime_t& now, srs_utime_t duration,
+    std::map<uint32_t, int>& kbps, uint32_t keyframe_ssrc, uint32_t* ppli_ssrc)
+{
+    static char buf[1500];
+    uint32_t forwarded = 0;
+
+    for (srs_utime_t end = now + duration; now < end; now += 10 * SRS_UTIME_MILLISECONDS) {
+        for (std::map<uint32_t, int>::iterator it = kbps.begin(); it != kbps.end(); ++it) {
+            SrsRtpPacket pkt;
+            pkt.header.set_ssrc(it->first);
+            pkt.frame_type = SrsFrameTypeVideo;
+            if (it->first == keyframe_ssrc) {
+                pkt.nalu_type = SrsAvcNaluTypeIDR;
+            }
+
+            SrsRtpRawPayload* raw = new SrsRtpRawPayload();
+            raw->payload = buf;
+            raw->nn_payload = srs_min(it->second * 1000 / 8 / 100 - 12, (int)sizeof(buf));
+            pkt.set_payload(raw, SrsRtspPacketPayloadTypeRaw);
+
+            uint32_t pli_ssrc = 0;
+            if (track->on_layer_packet(&pkt, now, &pli_ssrc)) {
+                forwarded = it->first;
+            }
+            if (pli_ssrc && ppli_ssrc) {
+                *ppli_ssrc = pli_ssrc;
+            }
+        }
+    }
+
+    return forwarded;
+}
+
+VOID TEST(KernelRTCTest, SimulcastBridgeLayer)
+{
+    SrsRtcSourceDescription stream_desc;
+    for (int i = 0; i < 2; i++) {
+        SrsRtcTrackDescription* desc = new SrsRtcTrackDescription();
+        desc->type_ = "video";
+        desc->id_ = "video-0";
+        desc->rid_ = (i == 0)? "h" : "l";
+        stream_desc.video_track_descs_.push_back(desc);
+    }
+
+    SrsRtcSource source;
+    source.set_stream_desc(&stream_desc);
+    source.bind_simulcast_layer("video-0", "h", 100);
+    source.bind_simulcast_layer("video-0", "l", 200);
+
+    // Only the first layer is consumed by the bridge.
+    SrsRtpPacket pkt;
+    pkt.frame_type = SrsFrameTypeVideo;
+    pkt.header.set_ssrc(100);
+    EXPECT_TRUE(source.is_bridge_layer(&pkt));
+    pkt.header.set_ssrc(200);
+    EXPECT_FALSE(source.is_bridge_layer(&pkt));
+
+    // Not simulcast.
+    pkt.header.set_ssrc(300);
+    EXPECT_TRUE(source.is_bridge_layer(&pkt));
+}
+
+VOID TEST(KernelRTCTest, SimulcastLayerSelection)
+{
+    SrsRtcTrackDescription desc;
+    desc.type_ = "video";
+    desc.id_ = "video-0";
+    desc.ssrc_ = 1000;
+    desc.rid_ = "h";
+
+    SrsRtcVideoSendTrack track(NULL, &desc);
+    EXPECT_TRUE(track.is_simulcast());
+
+    track.add_layer(1, "l");
+    track.add_layer(2, "m");
+    track.add_layer(3, "h");
+
+    std::map<uint32_t, int> kbps;
+    kbps[1] = 150;
+    kbps[2] = 500;
+    kbps[3] = 1500;
+
+    // Drop all packets without keyframe, and request keyframe.
+    srs_utime_t now = 1000 * SRS_UTIME_SECONDS;
+    uint32_t pli_ssrc = 0;
+    EXPECT_EQ((uint32_t)0, mock_simulcast_feed(&track, now, 100 * SRS_UTIME_MILLISECONDS, kbps, 0, &pli_ssrc));
+    EXPECT_NE((uint32_t)0, pli_ssrc);
+    EXPECT_EQ((uint32_t)0, track.get_layer_ssrc());
+
+    // Start from any layer with keyframe.
+    EXPECT_EQ((uint32_t)1, mock_simulcast_feed(&track, now, 10 * SRS_UTIME_MILLISECONDS, kbps, 1, NULL));
+    EXPECT_EQ((uint32_t)1, track.get_layer_ssrc());
+
+    // Without bandwidth estimation, switch to the best layer at keyframe.
+    EXPECT_EQ((uint32_t)1, mock_simulcast_feed(&track, now, 2 * SRS_UTIME_SECONDS, kbps, 0, NULL));
+    EXPECT_EQ((uint32_t)1, track.get_layer_ssrc());
+    EXPECT_EQ((uint32_t)3, mock_simulcast_feed(&track, now, 10 * SRS_UTIME_MILLISECONDS, kbps, 3, NULL));
+    EXPECT_EQ((uint32_t)3, track.get_layer_ssrc());
+
+    // Switch down to the layer which fits the bandwidth.
+    track.on_bandwidth(600 * 1000);
+    mock_simulcast_feed(&track, now, 2 * SRS_UTIME_SECONDS, kbps, 0, NULL);
+    EXPECT_EQ((uint32_t)3, track.get_layer_ssrc());
+    EXPECT_EQ((uint32_t)2, mock_simulcast_feed(&track, now, 10 * SRS_UTIME_MILLISECONDS, kbps, 2, NULL));
+    EXPECT_EQ((uint32_t)2, track.get_layer_ssrc());
+
+    // Specified layer by API, overwrite the bandwidth.
+    track.set_layer("l");
+    EXPECT_EQ((uint32_t)2, mock_simulcast_feed(&track, now, 100 * SRS_UTIME_MILLISECONDS, kbps, 0, NULL));
+    EXPECT_EQ((uint32_t)1, mock_simulcast_feed(&track, now, 10 * SRS_UTIME_MILLISECONDS, kbps, 1, NULL));
+    EXPECT_EQ((uint32_t)1, track.get_layer_ssrc());
+
+    // Probe the upper layer when bandwidth is stable, and fallback if probing failed.
+    track.set_layer("");
+    track.on_bandwidth(200 * 1000);
+    mock_simulcast_feed(&track, now, 6 * SRS_UTIME_SECONDS, kbps, 0, NULL);
+    EXPECT_EQ((uint32_t)2, mock_simulcast_feed(&track, now, 10 * SRS_UTIME_MILLISECONDS, kbps, 2, NULL));
+    EXPECT_EQ((uint32_t)2, track.get_layer_ssrc());
+
+    mock_simulcast_feed(&track, now, 2 * SRS_UTIME_SECONDS, kbps, 0, NULL);
+    EXPECT_EQ((uint32_t)1, mock_simulcast_feed(&track, now, 10 * SRS_UTIME_MILLISECONDS, kbps, 1, NULL));
+    EXPECT_EQ((uint32_t)1, track.get_layer_ssrc());
+
+    // The probe interval is increased, so never probe again soon.
+    mock_simulcast_feed(&track, now, 6 * SRS_UTIME_SECONDS, kbps, 2, NULL);
+    EXPECT_EQ((uint32_t)1, track.get_layer_ssrc());
+}
+
+#ifndef SRS_OSX
+extern srs_gettimeofday_t _srs_gettimeofday;
+
+srs_utime_t _mock_nack_time = 0;
+int mock_nack_gettimeofday(struct timeval* tp, struct timezone* /*tzp*/)
+{
+    tp->tv_sec = _mock_nack_time / SRS_UTIME_SECONDS;
+    tp->tv_usec = _mock_nack_time % SRS_UTIME_SECONDS;
+    return 0;
+}
+
+// The NACK list by std::map, to verify the bitmap ring of SrsRtpNackForReceiver.
+class MockNackMapReceiver
+{
+public:
+    std::map<uint16_t, SrsRtpNackInfo, SrsSeqCompareLess> queue_;
+    size_t max_queue_size_;
+    SrsRtpRingBuffer* rtp_;
+    SrsNackOption opts_;
+    srs_utime_t pre_check_time_;
+public:
+    MockNackMapReceiver(SrsRtpRingBuffer* rtp, size_t queue_size) {
+        max_queue_size_ = queue_size;
+        rtp_ = rtp;
+        pre_check_time_ = 0;
+    }
+    void insert(uint16_t first, uint16_t last) {
+        for (uint16_t s = first; s != last; ++s) {
+            queue_[s] = SrsRtpNackInfo();
+        }
+    }
+    void check_queue_size() {
+        if (queue_.size() >= max_queue_size_) {
+            rtp_->notify_nack_list_full();
+            queue_.clear();
+        }
+    }
+    void get_nack_seqs(SrsRtcpNack& seqs, uint32_t& timeout_nacks) {
+        srs_utime_t now = srs_get_system_time();
+        if (now - pre_check_time_ < opts_.nack_check_interval) {
+            return;
+        }
+        pre_check_time_ = now;
+
+        std::map<uint16_t, SrsRtpNackInfo>::iterator iter = queue_.begin();
+        while (iter != queue_.end()) {
+            SrsRtpNackInfo& info = iter->second;
+            if (now - info.generate_time_ > opts_.max_alive_time || info.req_nack_count_ > opts_.max_count) {
+                ++timeout_nacks;
+                rtp_->notify_drop_seq(iter->first);
+                queue_.erase(iter++);
+                continue;
+            }
+            if (now - info.generate_time_ < opts_.first_nack_interval) {
+                break;
+            }
+            srs_utime_t nack_interval = srs_max(opts_.min_nack_interval, opts_.nack_interval / 3);
+            if (now - info.pre_req_nack_time_ >= nack_interval) {
+                ++info.req_nack_count_;
+                info.pre_req_nack_time_ = now;
+                seqs.add_lost_sn(iter->first);
+            }
+            ++iter;
+        }
+    }
+};
+
+VOID TEST(KernelRTCTest, NackBitmapRing)
+{
+    srs_error_t err = srs_success;
+
+    srs_gettimeofday_t ot = _srs_gettimeofday;
+    _mock_nack_time = srs_update_system_time();
+    _srs_gettimeofday = mock_nack_gettimeofday;
+
+    // Randomized loss patterns, start near the wraparound of seq.
+    for (int round = 0; round < 8; round++) {
+        srand(round);
+
+        SrsRtpRingBuffer rtp0(1000), rtp1(1000);
+        MockNackMapReceiver ref(&rtp0, 1000 * 2 / 3);
+        SrsRtpNackForReceiver nack(&rtp1, 1000 * 2 / 3);
+
+        int loss = 1 + round * 5;
+        uint16_t seq = 65535 - 100 * round;
+        for (int i = 0; i < 3000; i++, seq++) {
+            _mock_nack_time += (rand() % 4) * SRS_UTIME_MILLISECONDS;
+            srs_update_system_time();
+
+            // Lost packet, or burst of lost packets.
+            if (rand() % 100 < loss) {
+                seq += rand() % 10;
+                continue;
+            }
+
+            // Retransmitted packet of a lost seq.
+            uint16_t rseq = seq;
+            if (!ref.queue_.empty() && rand() % 3 == 0) {
+                rseq = ref.queue_.begin()->first + rand() % 32;
+            }
+
+            bool found = ref.queue_.find(rseq) != ref.queue_.end();
+            EXPECT_EQ(found, nack.find(rseq) != NULL);
+            if (found) {
+                ref.queue_.erase(rseq);
+                nack.remove(rseq);
+            } else if (rseq == seq) {
+                uint16_t first0 = 0, last0 = 0, first1 = 0, last1 = 0;
+                rtp0.update(seq, first0, last0);
+                rtp1.update(seq, first1, last1);
+                EXPECT_EQ(first0, first1);
+                EXPECT_EQ(last0, last1);
+                if (srs_rtp_seq_distance(first0, last0) > 0) {
+                    ref.insert(first0, last0);
+                    ref.check_queue_size();
+                    nack.insert(first1, last1);
+                    nack.check_queue_size();
+                }
+            }
+            EXPECT_EQ(ref.queue_.size(), nack.size());
+
+            SrsRtcpNack nack0, nack1;
+            uint32_t timeout0 = 0, timeout1 = 0;
+            ref.get_nack_seqs(nack0, timeout0);
+            nack.get_nack_seqs(nack1, timeout1);
+            EXPECT_EQ(timeout0, timeout1);
+            EXPECT_EQ(nack0.empty(), nack1.empty());
+
+            vector<uint16_t> sns0 = nack0.get_lost_sns();
+            vector<uint16_t> sns1 = nack1.get_lost_sns();
+            ASSERT_EQ(sns0.size(), sns1.size());
+            for (int j = 0; j < (int)sns0.size(); j++) {
+                EXPECT_EQ(sns0[j], sns1[j]);
+            }
+
+            // The encoded NACK should decode to the same seqs.
+            if (!nack1.empty()) {
+                char buf[kRtcpPacketSize];
+                SrsBuffer b(buf, sizeof(buf));
+                HELPER_EXPECT_SUCCESS(nack1.encode(&b));
+
+                SrsRtcpNack decoder;
+                SrsBuffer b2(buf, b.pos());
+                HELPER_EXPECT_SUCCESS(decoder.decode(&b2));
+                vector<uint16_t> sns2 = decoder.get_lost_sns();
+                ASSERT_EQ(sns1.size(), sns2.size());
+                for (int j = 0; j < (int)sns1.size(); j++) {
+                    EXPECT_EQ(sns1[j], sns2[j]);
+                }
+            }
+        }
+    }
+
+    _srs_gettimeofday = ot;
+    srs_update_system_time();
+}
+#endif
+
+VOID TEST(KernelRTCTest, SrtpBatchProtect)
+{
+    srs_error_t err = srs_success;
+
+    // The SRTP is initialized by DTLS certificate in main.
+    SrsSrtpProfile profiles[] = {SrsSrtpProfileAes128CmSha1_80, SrsSrtpProfileAeadAes128Gcm};
+    for (int i = 0; i < (int)(sizeof(profiles) / sizeof(profiles[0])); i++) {
+        SrsSrtpProfile profile = profiles[i];
+        if (profile == SrsSrtpProfileAeadAes128Gcm && !srs_srtp_gcm_supported()) {
+            continue;
+        }
+
+        // The key is master key of 16 bytes, and salt of 14 bytes for CM or 12 bytes for GCM.
+        int key_len = (profile == SrsSrtpProfileAeadAes128Gcm) ? 28 : 30;
+        string k0(key_len, 'a'), k1(key_len, 'b');
+
+        SrsSRTP sender, receiver;
+        HELPER_EXPECT_SUCCESS(sender.initialize(k0, k1, profile));
+        HELPER_EXPECT_SUCCESS(receiver.initialize(k1, k0, profile));
+
+        // Protect a batch of RTP packets.
+        char bufs[3][kRtpPacketSize];
+        void* packets[3];
+        int nb_ciphers[3];
+        for (int j = 0; j < 3; j++) {
+            SrsRtpPacket pkt;
+            pkt.header.set_payload_type(96);
+            pkt.header.set_ssrc(1234);
+            pkt.header.set_sequence(100 + j);
+            pkt.header.set_timestamp(9000);
+            SrsRtpRawPayload* raw = new SrsRtpRawPayload();
+            raw->payload = pkt.wrap(200);
+            raw->nn_payload = 200;
+            memset(raw->payload, j, 200);
+            pkt.set_payload(raw, SrsRtspPacketPayloadTypeRaw);
+
+            SrsBuffer b(bufs[j], kRtpPacketSize);
+            HELPER_EXPECT_SUCCESS(pkt.encode(&b));
+            packets[j] = bufs[j];
+            nb_ciphers[j] = b.pos();
+        }
+        HELPER_EXPECT_SUCCESS(sender.protect_rtps(packets, nb_ciphers, 3));
+
+        // Should decrypt by receiver.
+        for (int j = 0; j < 3; j++) {
+            EXPECT_EQ(12 + 200 + ((profile == SrsSrtpProfileAeadAes128Gcm) ? 16 : 10), nb_ciphers[j]);
+
+            int nb_plaintext = nb_ciphers[j];
+            HELPER_EXPECT_SUCCESS(receiver.unprotect_rtp(bufs[j], &nb_plaintext));
+            EXPECT_EQ(12 + 200, nb_plaintext);
+            EXPECT_EQ(j, bufs[j][12]);
+            EXPECT_EQ(j, bufs[j][12 + 199]);
+        }
+
+        // The packet failed to protect is set to 0 bytes, and others are protected.
+        for (int j = 0; j < 3; j++) {
+            SrsRtpPacket pkt;
+            pkt.header.set_payload_type(96);
+            pkt.header.set_ssrc(1234);
+            pkt.header.set_sequence(200 + j);
+            pkt.header.set_timestamp(9000);
+
+            SrsBuffer b(bufs[j], kRtpPacketSize);
+            HELPER_EXPECT_SUCCESS(pkt.encode(&b));
+            packets[j] = bufs[j];
+            nb_ciphers[j] = (j == 1)? 4 : b.pos();
+        }
+        HELPER_EXPECT_FAILED(sender.protect_rtps(packets, nb_ciphers, 3));
+        EXPECT_EQ(0, nb_ciphers[1]);
+        for (int j = 0; j < 3; j += 2) {
+            int nb_plaintext = nb_ciphers[j];
+            HELPER_EXPECT_SUCCESS(receiver.unprotect_rtp(bufs[j], &nb_plaintext));
+            EXPECT_EQ(12, nb_plaintext);
+        }
+    }
+}
+
+class MockDtlsPeer : public ISrsDtlsCallback
+{
+public:
+    std::vector<std::string> outs_;
+    bool done_;
+public:
+    MockDtlsPeer() {
+        done_ = false;
+    }
+    virtual ~MockDtlsPeer() {
+    }
+public:
+    virtual srs_error_t on_dtls_handshake_done() {
+        done_ = true;
+        return srs_success;
+    }
+    virtual srs_error_t on_dtls_application_data(const char* data, const int len) {
+        return srs_success;
+    }
+    virtual srs_error_t write_dtls_data(void* data, int size) {
+        outs_.push_back(std::string((char*)data, size));
+        return srs_success;
+    }
+    virtual srs_error_t on_dtls_alert(std::string type, std::string desc) {
+        return srs_success;
+    }
+};
+
+VOID TEST(KernelRTCTest, DtlsSrtpProfile)
+{
+    srs_error_t err = srs_success;
+
+    MockDtlsPeer client_peer, server_peer;
+    SrsDtls client(&client_peer), server(&server_peer);
+    HELPER_EXPECT_SUCCESS(client.initialize("active", "dtls1.2"));
+    HELPER_EXPECT_SUCCESS(server.initialize("passive", "dtls1.2"));
+
+    // Exchange the DTLS packets until handshake done.
+    HELPER_EXPECT_SUCCESS(client.start_active_handshake());
+    for (int i = 0; i < 16 && (!client_peer.done_ || !server_peer.done_); i++) {
+        std::vector<std::string> outs = client_peer.outs_;
+        client_peer.outs_.clear();
+        for (int j = 0; j < (int)outs.size(); j++) {
+            HELPER_EXPECT_SUCCESS(server.on_dtls((char*)outs[j].data(), (int)outs[j].size()));
+        }
+
+        outs = server_peer.outs_;
+        server_peer.outs_.clear();
+        for (int j = 0; j < (int)outs.size(); j++) {
+            HELPER_EXPECT_SUCCESS(client.on_dtls((char*)outs[j].data(), (int)outs[j].size()));
+        }
+    }
+    EXPECT_TRUE(client_peer.done_);
+    EXPECT_TRUE(server_peer.done_);
+
+    // Should prefer GCM if supported.
+    SrsSrtpProfile profile = srs_srtp_gcm_supported() ? SrsSrtpProfileAeadAes128Gcm : SrsSrtpProfileAes128CmSha1_80;
+    EXPECT_EQ(profile, client.get_srtp_profile());
+    EXPECT_EQ(profile, server.get_srtp_profile());
+
+    // The send key of client should be the recv key of server.
+    string crecv, csend, srecv, ssend;
+    HELPER_EXPECT_SUCCESS(client.get_srtp_key(crecv, csend));
+    HELPER_EXPECT_SUCCESS(server.get_srtp_key(srecv, ssend));
+    EXPECT_EQ(csend, srecv);
+    EXPECT_EQ(crecv, ssend);
+    EXPECT_EQ((profile == SrsSrtpProfileAeadAes128Gcm) ? 28 : 30, (int)csend.size());
+
+    // Protect by client and unprotect by server.
+    SrsSRTP csrtp, ssrtp;
+    HELPER_EXPECT_SUCCESS(csrtp.initialize(crecv, csend, profile));
+    HELPER_EXPECT_SUCCESS(ssrtp.initialize(srecv, ssend, profile));
+
+    char buf[kRtpPacketSize];
+    memset(buf, 0, sizeof(buf));
+    buf[0] = (char)0x80; buf[1] = 96; buf[3] = 1; buf[11] = 1;
+    int nb_buf = 100;
+    HELPER_EXPECT_SUCCESS(csrtp.protect_rtp(buf, &nb_buf));
+    HELPER_EXPECT_SUCCESS(ssrtp.unprotect_rtp(buf, &nb_buf));
+    EXPECT_EQ(100, nb_buf);
+}
+
+VOID TEST(KernelRTCTest, ExtensionTypesPerTrack)
+{
+    // The same id is negotiated as different extension for audio and video track.
+    SrsRtcTrackDescription audio_desc;
+    audio_desc.type_ = "audio";
+    audio_desc.add_rtp_extension_desc(1, kAudioLevelUri);
+
+    SrsRtcTrackDescription video_desc;
+    video_desc.type_ = "video";
+    video_desc.add_rtp_extension_desc(1, kTWCCExt);
+
+    SrsRtcAudioRecvTrack audio(NULL, &audio_desc);
+    SrsRtcVideoRecvTrack video(NULL, &video_desc);
+    EXPECT_EQ(kRtpExtensionAudioLevel, audio.extension_types()->get_type(1));
+    EXPECT_EQ(kRtpExtensionTransportSequenceNumber, video.extension_types()->get_type(1));
+    EXPECT_EQ(0, audio.extension_types()->get_id(kRtpExtensionTransportSequenceNumber));
+    EXPECT_EQ(0, video.extension_types()->get_id(kRtpExtensionAudioLevel));
+}
+
+VOID TEST(KernelRTCTest, SrtpWorkers)
+{
+    srs_error_t err = srs_success;
+
+    // The threads quit when free the workers.
+    SrsAsyncSrtpWorkers* workers = new SrsAsyncSrtpWorkers();
+    SrsAutoFree(SrsAsyncSrtpWorkers, workers);
+    HELPER_EXPECT_SUCCESS(workers->start(2));
+    EXPECT_TRUE(workers->enabled());
+
+    string k0(30, 'a'), k1(30, 'b');
+    SrsSRTP sender, receiver;
+    HELPER_EXPECT_SUCCESS(sender.initialize(k0, k1));
+    HELPER_EXPECT_SUCCESS(receiver.initialize(k1, k0));
+
+    // Protect the small batch in caller thread, never start the dispatcher.
+    if (true) {
+        char buf[kRtpPacketSize];
+        memset(buf, 0, sizeof(buf));
+        buf[0] = (char)0x80; buf[1] = 96; buf[3] = 1; buf[11] = 2;
+        void* packets[1] = {buf};
+        int nb_ciphers[1] = {100};
+        HELPER_EXPECT_SUCCESS(workers->protect_rtps(&sender, packets, nb_ciphers, 1));
+        EXPECT_EQ(110, nb_ciphers[0]);
+        EXPECT_TRUE(workers->trd_ == NULL);
+
+        int nb_plaintext = nb_ciphers[0];
+        HELPER_EXPECT_SUCCESS(receiver.unprotect_rtp(buf, &nb_plaintext));
+        EXPECT_EQ(100, nb_plaintext);
+    }
+
+    for (int round = 0; round < 10; round++) {
+        char bufs[4][kRtpPacketSize];
+        void* packets[4];
+        int nb_ciphers[4];
+        for (int j = 0; j < 4; j++) {
+            memset(bufs[j], j, sizeof(bufs[j]));
+            bufs[j][0] = (char)0x80; bufs[j][1] = 96; bufs[j][2] = 0; bufs[j][3] = (char)(round * 4 + j);
+            bufs[j][8] = 0; bufs[j][9] = 0; bufs[j][10] = 0; bufs[j][11] = 1;
+            packets[j] = bufs[j];
+            nb_ciphers[j] = 100;
+        }
+
+        // Protect in worker thread, and wait for done.
+        HELPER_EXPECT_SUCCESS(workers->protect_rtps(&sender, packets, nb_ciphers, 4));
+        EXPECT_TRUE(workers->trd_ != NULL);
+
+        for (int j = 0; j < 4; j++) {
+            EXPECT_EQ(110, nb_ciphers[j]);
+            int nb_plaintext = nb_ciphers[j];
+            HELPER_EXPECT_SUCCESS(receiver.unprotect_rtp(bufs[j], &nb_plaintext));
+            EXPECT_EQ(100, nb_plaintext);
+            EXPECT_EQ(j, bufs[j][99]);
+        }
+    }
+}
+
+class MockRtcFrameHandler : public ISrsRtcFrameBuilderHandler
+{
+public:
+    // The payload of RTMP video messages.
+    std::vector<std::string> frames;
+    std::vector<int64_t> timestamps;
+public:
+    virtual srs_error_t on_frame(SrsCommonMessage* frame) {
+        frames.push_back(std::string(frame->payload, frame->size));
+        timestamps.push_back(frame->header.timestamp);
+        return srs_success;
+    }
+};
+
+static SrsRtpPacket* mock_frame_packet(uint16_t sn, uint32_t ts, bool marker, SrsAvcNaluType nalu_type, ISrsRtpPayloader* p, SrsRtspPacketPayloadType pt)
+{
+    SrsRtpPacket* pkt = new SrsRtpPacket();
+    pkt->frame_type = SrsFrameTypeVideo;
+    pkt->nalu_type = nalu_type;
+    pkt->header.set_ssrc(0x100);
+    pkt->header.set_sequence(sn);
+    pkt->header.set_timestamp(ts);
+    pkt->header.set_marker(marker);
+    pkt->set_avsync_time(ts / 90);
+    pkt->set_payload(p, pt);
+    return pkt;
+}
+
+static SrsRtpPacket* mock_raw_packet(uint16_t sn, uint32_t ts, bool marker, char* nalu, int size)
+{
+    SrsRtpRawPayload* raw = new SrsRtpRawPayload();
+    raw->payload = nalu;
+    raw->nn_payload = size;
+    return mock_frame_packet(sn, ts, marker, SrsAvcNaluType(nalu[0] & 0x1f), raw, SrsRtspPacketPayloadTypeRaw);
+}
+
+static SrsRtpPacket* mock_fua_packet(uint16_t sn, uint32_t ts, bool marker, bool start, bool end, char* fragment, int size)
+{
+    SrsRtpFUAPayload2* fua = new SrsRtpFUAPayload2();
+    fua->nri = SrsAvcNaluType(0x60);
+    fua->nalu_type = SrsAvcNaluTypeIDR;
+    fua->start = start;
+    fua->end = end;
+    fua->payload = fragment;
+    fua->size = size;
+    return mock_frame_packet(sn, ts, marker, SrsAvcNaluType(kFuA), fua, SrsRtspPacketPayloadTypeFUA2);
+}
+
+static srs_error_t mock_frame_consume(SrsRtcFrameBuilder* builder, SrsRtpPacket* pkt, srs_utime_t now)
+{
+    SrsAutoFree(SrsRtpPacket, pkt);
+    return builder->on_rtp(pkt, now);
+}
+
+VOID TEST(KernelRTCTest, FrameBuilder)
+{
+    srs_error_t err;
+
+    char sps[] = {0x67, 0x42, (char)0xc0, 0x1e, (char)0x8c, (char)0x8d};
+    char pps[] = {0x68, (char)0xce, 0x3c, (char)0x80};
+    char idr[] = {0x65, 0x01, 0x02};
+    char inter[] = {0x41, 0x03};
+    char fragments[] = {0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+
+    // Build frames by marker or timestamp, with reordered, lost and duplicated packets.
+    if (true) {
+        MockRtcFrameHandler handler;
+        SrsRtcFrameBuilder builder(&handler);
+        builder.set_jitter(300 * SRS_UTIME_MILLISECONDS);
+
+        // Drop the inter frames before keyframe.
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, mock_raw_packet(9, 900, true, inter, sizeof(inter)), 0));
+        EXPECT_EQ(0, (int)handler.frames.size());
+
+        // The keyframe with SPS/PPS in STAP-A, and IDR in FU-A.
+        SrsRtpSTAPPayload* stap = new SrsRtpSTAPPayload();
+        SrsSample* sample = new SrsSample(); sample->bytes = sps; sample->size = sizeof(sps); stap->nalus.push_back(sample);
+        sample = new SrsSample(); sample->bytes = pps; sample->size = sizeof(pps); stap->nalus.push_back(sample);
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, mock_frame_packet(10, 9000, false, SrsAvcNaluType(kStapA), stap, SrsRtspPacketPayloadTypeSTAP), 0));
+        EXPECT_EQ(1, (int)handler.frames.size()); // Sequence header.
+        EXPECT_EQ(0x17, (uint8_t)handler.frames[0].at(0));
+        EXPECT_EQ(0x00, (uint8_t)handler.frames[0].at(1));
+
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, mock_fua_packet(11, 9000, false, true, false, fragments, 2), 0));
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, mock_fua_packet(13, 9000, true, false, true, fragments + 4, 2), 0));
+        EXPECT_EQ(1, (int)handler.frames.size());
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, mock_fua_packet(12, 9000, false, false, false, fragments + 2, 2), 0));
+        ASSERT_EQ(2, (int)handler.frames.size());
+        EXPECT_EQ(100, handler.timestamps[1]);
+
+        string expect("\x17\x01\x00\x00\x00", 5);
+        expect += string("\x00\x00\x00\x06", 4) + string(sps, sizeof(sps));
+        expect += string("\x00\x00\x00\x04", 4) + string(pps, sizeof(pps));
+        expect += string("\x00\x00\x00\x07\x65", 5) + string(fragments, sizeof(fragments));
+        EXPECT_TRUE(expect == handler.frames[1]);
+
+        // The duplicated packet is ignored.
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, mock_fua_packet(12, 9000, false, false, false, fragments + 2, 2), 0));
+        EXPECT_EQ(2, (int)handler.frames.size());
+
+        // The frame without marker, finished by the packet of next frame.
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, mock_raw_packet(14, 12000, false, inter, sizeof(inter)), 0));
+        EXPECT_EQ(2, (int)handler.frames.size());
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, mock_raw_packet(15, 15000, true, inter, sizeof(inter)), 0));
+        ASSERT_EQ(4, (int)handler.frames.size());
+        EXPECT_TRUE(string("\x27\x01\x00\x00\x00\x00\x00\x00\x02\x41\x03", 11) == handler.frames[2]);
+        EXPECT_EQ(133, handler.timestamps[2]);
+        EXPECT_EQ(166, handler.timestamps[3]);
+
+        // Lost packet 16, wait for NACK until timeout, then drop frames until next keyframe.
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, mock_raw_packet(17, 21000, true, inter, sizeof(inter)), 100 * SRS_UTIME_MILLISECONDS));
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, mock_raw_packet(18, 24000, true, inter, sizeof(inter)), 200 * SRS_UTIME_MILLISECONDS));
+        EXPECT_EQ(4, (int)handler.frames.size());
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, mock_raw_packet(19, 27000, true, inter, sizeof(inter)), 400 * SRS_UTIME_MILLISECONDS));
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, mock_raw_packet(16, 18000, true, inter, sizeof(inter)), 400 * SRS_UTIME_MILLISECONDS));
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, mock_raw_packet(20, 30000, true, inter, sizeof(inter)), 400 * SRS_UTIME_MILLISECONDS));
+        EXPECT_EQ(4, (int)handler.frames.size());
+
+        // Start from the next keyframe.
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, mock_raw_packet(21, 33000, true, idr, sizeof(idr)), 500 * SRS_UTIME_MILLISECONDS));
+        ASSERT_EQ(5, (int)handler.frames.size());
+        EXPECT_EQ(0x17, (uint8_t)handler.frames[4].at(0));
+
+        // Lost packet 22, but resync immediately by the next keyframe.
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, mock_raw_packet(23, 39000, true, inter, sizeof(inter)), 500 * SRS_UTIME_MILLISECONDS));
+        EXPECT_EQ(5, (int)handler.frames.size());
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, mock_raw_packet(24, 42000, true, idr, sizeof(idr)), 510 * SRS_UTIME_MILLISECONDS));
+        ASSERT_EQ(6, (int)handler.frames.size());
+        EXPECT_EQ(0x17, (uint8_t)handler.frames[5].at(0));
+        EXPECT_EQ(466, handler.timestamps[5]);
+
+        // The late packet is ignored.
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, mock_raw_packet(22, 36000, true, inter, sizeof(inter)), 510 * SRS_UTIME_MILLISECONDS));
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, mock_raw_packet(25, 45000, true, inter, sizeof(inter)), 510 * SRS_UTIME_MILLISECONDS));
+        ASSERT_EQ(7, (int)handler.frames.size());
+        EXPECT_EQ(0x27, (uint8_t)handler.frames[6].at(0));
+    }
+
+    // Resync at a reordered packet of keyframe, the head moves backward to build the whole keyframe.
+    if (true) {
+        MockRtcFrameHandler handler;
+        SrsRtcFrameBuilder builder(&handler);
+
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, mock_fua_packet(65535, 9000, true, false, true, fragments + 4, 2), 0));
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, mock_raw_packet(0, 12000, true, inter, sizeof(inter)), 0));
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, mock_fua_packet(65534, 9000, false, false, false, fragments + 2, 2), 0));
+        EXPECT_EQ(0, (int)handler.frames.size());
+
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, mock_fua_packet(65533, 9000, false, true, false, fragments, 2), 0));
+        ASSERT_EQ(2, (int)handler.frames.size());
+        EXPECT_TRUE(string("\x17\x01\x00\x00\x00\x00\x00\x00\x07\x65\x0a\x0b\x0c\x0d\x0e\x0f", 16) == handler.frames[0]);
+        EXPECT_EQ(0x27, (uint8_t)handler.frames[1].at(0));
+    }
+
+    // The packets far away from head, which overflows the jitter buffer.
+    if (true) {
+        MockRtcFrameHandler handler;
+        SrsRtcFrameBuilder builder(&handler);
+
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, mock_raw_packet(100, 9000, true, idr, sizeof(idr)), 0));
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, mock_raw_packet(102, 12000, true, inter, sizeof(inter)), 0));
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, mock_raw_packet(100 + SRS_PERF_RTC_FRAME_BUILDER_SLOTS + 1, 15000, true, inter, sizeof(inter)), 0));
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, mock_raw_packet(101, 10000, true, inter, sizeof(inter)), 0));
+        EXPECT_EQ(1, (int)handler.frames.size());
+
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, mock_raw_packet(2000, 18000, true, idr, sizeof(idr)), 0));
+        EXPECT_EQ(2, (int)handler.frames.size());
+    }
+
+    // Ignore the keyframe and sequence header of other streams, for example, other simulcast layers.
+    if (true) {
+        MockRtcFrameHandler handler;
+        SrsRtcFrameBuilder builder(&handler);
+
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, mock_raw_packet(100, 9000, true, idr, sizeof(idr)), 0));
+        EXPECT_EQ(1, (int)handler.frames.size());
+
+        SrsRtpSTAPPayload* stap = new SrsRtpSTAPPayload();
+        SrsSample* sample = new SrsSample(); sample->bytes = sps; sample->size = sizeof(sps); stap->nalus.push_back(sample);
+        sample = new SrsSample(); sample->bytes = pps; sample->size = sizeof(pps); stap->nalus.push_back(sample);
+        SrsRtpPacket* pkt = mock_frame_packet(500, 9000, false, SrsAvcNaluType(kStapA), stap, SrsRtspPacketPayloadTypeSTAP);
+        pkt->header.set_ssrc(0x200);
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, pkt, 0));
+
+        pkt = mock_raw_packet(501, 9000, true, idr, sizeof(idr));
+        pkt->header.set_ssrc(0x200);
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, pkt, 0));
+        EXPECT_EQ(1, (int)handler.frames.size());
+
+        HELPER_EXPECT_SUCCESS(mock_frame_consume(&builder, mock_raw_packet(101, 12000, true, inter, sizeof(inter)), 0));
+        EXPECT_EQ(2, (int)handler.frames.size());
+    }
+}
+
+VOID TEST(KernelRTCTest, StunBindingRequest)
+{
+    srs_error_t err = srs_success;
+
+    char buf[1500];
+    int size = 0;
+
+    // The client, which is the ICE controlling agent, sends binding request to server.
+    if (true) {
+        SrsStunPacket stun;
+        stun.set_message_type(BindingRequest);
+        stun.set_local_ufrag("client");
+        stun.set_remote_ufrag("server");
+        stun.set_transcation_id("123456789012");
+        stun.set_use_candidate(true);
+        stun.set_ice_controlling(true);
+
+        SrsBuffer stream(buf, sizeof(buf));
+        HELPER_EXPECT_SUCCESS(stun.encode("serverpwd", &stream));
+        size = stream.pos();
+        EXPECT_GT(size, 20);
+    }
+
+    // The server decodes it, where the local ufrag is the one of server.
+    if (true) {
+        SrsStunPacket stun;
+        HELPER_EXPECT_SUCCESS(stun.decode(buf, size));
+        EXPECT_TRUE(stun.is_binding_request());
+        EXPECT_STREQ("server:client", stun.get_username().c_str());
+        EXPECT_STREQ("server", stun.get_local_ufrag().c_str());
+        EXPECT_STREQ("client", stun.get_remote_ufrag().c_str());
+        EXPECT_STREQ("123456789012", stun.get_transcation_id().c_str());
+        EXPECT_TRUE(stun.get_use_candidate());
+        EXPECT_TRUE(stun.get_ice_controlling());
+        EXPECT_FALSE(stun.get_ice_controlled());
+    }
+
+    // Without the use candidate, for example, the keepalive request.
+    if (true) {
+        SrsStunPacket stun;
+        stun.set_message_type(BindingRequest);
+        stun.set_local_ufrag("client");
+        stun.set_remote_ufrag("server");
+        stun.set_transcation_id("123456789012");
+        stun.set_ice_controlling(true);
+
+        SrsBuffer stream(buf, sizeof(buf));
+        HELPER_EXPECT_SUCCESS(stun.encode("serverpwd", &stream));
+
+        SrsStunPacket req;
+        HELPER_EXPECT_SUCCESS(req.decode(buf, stream.pos()));
+        EXPECT_FALSE(req.get_use_candidate());
+        EXPECT_TRUE(req.get_ice_controlling());
+    }
+}
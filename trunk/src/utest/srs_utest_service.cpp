@@ -22,6 +22,9 @@ using namespace std;
 #include <srs_protocol_http_client.hpp>
 #include <srs_protocol_rtmp_conn.hpp>
 #include <srs_protocol_conn.hpp>
+#include <srs_app_edge.hpp>
+#include <srs_app_http_hooks.hpp>
+#include <srs_kernel_utility.hpp>
 #include <sys/socket.h>
 #include <netdb.h>
 #include <st.h>
@@ -918,6 +921,106 @@ VOID TEST(TCPServerTest, UDPListen)
     }
 }
 
+VOID TEST(TCPServerTest, UnixListen)
+{
+    srs_error_t err;
+
+    string path = "/tmp/srs-utest-unix.sock";
+    ::unlink(path.c_str());
+
+    // Failed for invalid path.
+    if (true) {
+        srs_netfd_t pfd = NULL;
+        HELPER_EXPECT_FAILED(srs_unix_listen("", &pfd));
+        HELPER_EXPECT_FAILED(srs_unix_listen("/tmp/not-exists-dir/srs.sock", &pfd));
+        srs_close_stfd(pfd);
+    }
+
+    if (true) {
+        MockTcpHandler h;
+        SrsUnixListener l(&h);
+        l.set_path(path);
+        HELPER_ASSERT_SUCCESS(l.listen());
+
+        // Failed for the path is in use.
+        srs_netfd_t pfd = NULL;
+        HELPER_EXPECT_FAILED(srs_unix_listen(path, &pfd));
+        srs_close_stfd(pfd);
+
+        SrsTcpClient c("", 0, _srs_tmp_timeout);
+        c.set_unix_path(path);
+        HELPER_ASSERT_SUCCESS(c.connect());
+
+        srs_usleep(30 * SRS_UTIME_MILLISECONDS);
+        ASSERT_TRUE(h.fd != NULL);
+        SrsStSocket skt(h.fd);
+
+        HELPER_EXPECT_SUCCESS(c.write((void*)"Hello", 5, NULL));
+
+        char buf[16] = {0};
+        HELPER_EXPECT_SUCCESS(skt.read(buf, 5, NULL));
+        EXPECT_STREQ(buf, "Hello");
+    }
+
+    ::unlink(path.c_str());
+}
+
+VOID TEST(TCPServerTest, EdgeRelayElect)
+{
+    srs_error_t err;
+
+    string path = "/tmp/srs-utest-edge.sock";
+    ::unlink(path.c_str());
+
+    // Ignore if disabled.
+    if (true) {
+        SrsEdgeRelay relay;
+        HELPER_EXPECT_SUCCESS(relay.elect());
+        EXPECT_FALSE(relay.is_leader());
+        EXPECT_FALSE(relay.is_follower());
+    }
+
+    if (true) {
+        MockTcpHandler h;
+        SrsEdgeRelay leader;
+        HELPER_ASSERT_SUCCESS(leader.initialize(&h, path));
+        EXPECT_TRUE(leader.is_leader());
+        EXPECT_FALSE(leader.is_follower());
+
+        // The lock is held by leader, so it's follower.
+        SrsEdgeRelay follower;
+        HELPER_ASSERT_SUCCESS(follower.initialize(&h, path));
+        EXPECT_FALSE(follower.is_leader());
+        EXPECT_TRUE(follower.is_follower());
+
+        // The follower connects to leader.
+        if (true) {
+            SrsTcpClient c("", 0, _srs_tmp_timeout);
+            c.set_unix_path(follower.path());
+            HELPER_ASSERT_SUCCESS(c.connect());
+
+            srs_usleep(30 * SRS_UTIME_MILLISECONDS);
+            EXPECT_TRUE(h.fd != NULL);
+        }
+
+        // Elect again, still follower.
+        HELPER_EXPECT_SUCCESS(follower.elect());
+        EXPECT_TRUE(follower.is_follower());
+
+        // After the leader quit, the follower is elected.
+        leader.close();
+        EXPECT_FALSE(leader.is_leader());
+        EXPECT_FALSE(leader.is_follower());
+
+        HELPER_EXPECT_SUCCESS(follower.elect());
+        EXPECT_TRUE(follower.is_leader());
+        EXPECT_FALSE(follower.is_follower());
+    }
+
+    ::unlink(path.c_str());
+    ::unlink((path + ".lock").c_str());
+}
+
 class MockOnCycleThread : public ISrsCoroutineHandler
 {
 public:
@@ -1394,6 +1497,218 @@ public:
     }
 };
 
+VOID TEST(HTTPClientTest, HTTPHooksPool)
+{
+    srs_error_t err;
+
+    // Reuse the keep-alive connection.
+    if (true) {
+        MockOnCycleThread4 trd;
+        HELPER_ASSERT_SUCCESS(trd.start("127.0.0.1", 8080));
+
+        SrsHttpHooksPool pool;
+        for (int i = 0; i < 3; i++) {
+            int code = 0; string res;
+            HELPER_ASSERT_SUCCESS(pool.post("http://127.0.0.1:8080/api/v1/hooks", "{}", code, res));
+            EXPECT_EQ(200, code);
+            EXPECT_STREQ("OK", res.c_str());
+        }
+
+        ASSERT_EQ(1, (int)pool.endpoints().size());
+        SrsHttpHooksEndpoint* ep = pool.endpoints().begin()->second;
+        EXPECT_STREQ("http://127.0.0.1:8080", ep->url().c_str());
+        EXPECT_EQ(3, ep->nn_requests_);
+        EXPECT_EQ(0, ep->nn_errors_);
+        EXPECT_EQ(1, ep->nn_connects_);
+
+        int64_t count = 0;
+        for (int i = 0; i <= SRS_HTTP_HOOKS_LATENCY_BUCKETS; i++) {
+            count += ep->latency_buckets_[i];
+        }
+        EXPECT_EQ(3, count);
+    }
+
+    // Retry by a new connection, if the reused connection is closed by server.
+    if (true) {
+        SrsHttpHooksPool pool;
+
+        if (true) {
+            MockOnCycleThread4 trd;
+            HELPER_ASSERT_SUCCESS(trd.start("127.0.0.1", 8080));
+
+            int code = 0; string res;
+            HELPER_ASSERT_SUCCESS(pool.post("http://127.0.0.1:8080/api/v1/hooks", "{}", code, res));
+        }
+
+        MockOnCycleThread4 trd;
+        HELPER_ASSERT_SUCCESS(trd.start("127.0.0.1", 8080));
+
+        int code = 0; string res;
+        HELPER_ASSERT_SUCCESS(pool.post("http://127.0.0.1:8080/api/v1/hooks", "{}", code, res));
+        EXPECT_EQ(200, code);
+
+        SrsHttpHooksEndpoint* ep = pool.endpoints().begin()->second;
+        EXPECT_EQ(2, ep->nn_requests_);
+        EXPECT_EQ(0, ep->nn_errors_);
+        EXPECT_EQ(2, ep->nn_connects_);
+        EXPECT_EQ(1, (int)ep->idles_.size());
+    }
+
+    // Never reuse the idle connections for a fresh one, and drop them all.
+    if (true) {
+        SrsHttpHooksPool pool;
+
+        MockOnCycleThread4 trd;
+        HELPER_ASSERT_SUCCESS(trd.start("127.0.0.1", 8080));
+
+        int code = 0; string res;
+        HELPER_ASSERT_SUCCESS(pool.post("http://127.0.0.1:8080/api/v1/hooks", "{}", code, res));
+
+        SrsHttpHooksEndpoint* ep = pool.endpoints().begin()->second;
+        ASSERT_EQ(1, (int)ep->idles_.size());
+
+        SrsHttpClient* hc = NULL;
+        bool reused = true;
+        HELPER_ASSERT_SUCCESS(ep->acquire(&hc, &reused, true));
+        EXPECT_FALSE(reused);
+        EXPECT_EQ(1, (int)ep->idles_.size());
+        ep->release(hc, false);
+
+        ep->close_idles();
+        EXPECT_EQ(0, (int)ep->idles_.size());
+        EXPECT_EQ(0, (int)ep->idle_times_.size());
+    }
+
+    // Never reuse the connection for error.
+    if (true) {
+        SrsHttpHooksPool pool;
+
+        int code = 0; string res;
+        HELPER_EXPECT_FAILED(pool.post("http://127.0.0.1:8080/api/v1/hooks", "{}", code, res));
+
+        SrsHttpHooksEndpoint* ep = pool.endpoints().begin()->second;
+        EXPECT_EQ(1, ep->nn_requests_);
+        EXPECT_EQ(1, ep->nn_errors_);
+        EXPECT_EQ(0, (int)ep->idles_.size());
+    }
+
+    // The latency in histogram.
+    if (true) {
+        SrsHttpHooksEndpoint ep("http", "127.0.0.1", 8080);
+        ep.on_response(1 * SRS_UTIME_MILLISECONDS, true);
+        ep.on_response(5 * SRS_UTIME_MILLISECONDS, true);
+        ep.on_response(6 * SRS_UTIME_MILLISECONDS, true);
+        ep.on_response(10 * SRS_UTIME_SECONDS, false);
+        EXPECT_EQ(2, ep.latency_buckets_[0]);
+        EXPECT_EQ(1, ep.latency_buckets_[1]);
+        EXPECT_EQ(1, ep.latency_buckets_[SRS_HTTP_HOOKS_LATENCY_BUCKETS]);
+        EXPECT_EQ(4, ep.nn_requests_);
+        EXPECT_EQ(1, ep.nn_errors_);
+    }
+}
+
+VOID TEST(HTTPClientTest, HTTPHooksCache)
+{
+    srs_error_t err;
+
+    SrsRequest req;
+    req.vhost = "ossrs.net"; req.app = "live"; req.stream = "livestream"; req.param = "?token=xxx";
+    string key = SrsHttpHooksCache::key("on_play", "http://127.0.0.1:8085/api/v1/sessions", &req);
+
+    // Cache the allowed decision by TTL.
+    if (true) {
+        SrsHttpHooksCache cache;
+        EXPECT_FALSE(cache.fetch(key, &err));
+
+        cache.update(key, srs_success, 200, "0", 10 * SRS_UTIME_SECONDS, 0);
+        EXPECT_EQ(1, cache.size());
+        EXPECT_TRUE(cache.fetch(key, &err));
+        HELPER_EXPECT_SUCCESS(err);
+        EXPECT_EQ(1, cache.nn_hits_);
+        EXPECT_EQ(1, cache.nn_misses_);
+
+        // The param is in key, so another token is not cached.
+        req.param = "?token=yyy";
+        EXPECT_FALSE(cache.fetch(SrsHttpHooksCache::key("on_play", "http://127.0.0.1:8085/api/v1/sessions", &req), &err));
+        req.param = "?token=xxx";
+    }
+
+    // Never cache if TTL is 0, and the backend is able to override the TTL.
+    if (true) {
+        SrsHttpHooksCache cache;
+        cache.update(key, srs_success, 200, "0", 0, 10 * SRS_UTIME_SECONDS);
+        EXPECT_EQ(0, cache.size());
+
+        cache.update(key, srs_success, 200, "{\"code\":0,\"cache_ttl\":0}", 10 * SRS_UTIME_SECONDS, 0);
+        EXPECT_EQ(0, cache.size());
+
+        cache.update(key, srs_success, 200, "{\"code\":0,\"cache_ttl\":60}", 0, 0);
+        EXPECT_EQ(1, cache.size());
+    }
+
+    // Expire the decision.
+    if (true) {
+        SrsHttpHooksCache cache;
+        cache.update(key, srs_success, 200, "{\"code\":0,\"cache_ttl\":-1}", 10 * SRS_UTIME_SECONDS, 0);
+        EXPECT_EQ(0, cache.size());
+
+        cache.update(key, srs_success, 200, "0", 1 * SRS_UTIME_MILLISECONDS, 0);
+        EXPECT_EQ(1, cache.size());
+        srs_usleep(10 * SRS_UTIME_MILLISECONDS);
+        srs_update_system_time();
+        EXPECT_FALSE(cache.fetch(key, &err));
+        EXPECT_EQ(0, cache.size());
+    }
+
+    // Cache the denied decision by negative TTL, but never the errors of backend.
+    if (true) {
+        SrsHttpHooksCache cache;
+        err = srs_error_new(ERROR_HTTP_STATUS_INVALID, "status 500");
+        cache.update(key, err, 500, "", 0, 10 * SRS_UTIME_SECONDS);
+        srs_freep(err);
+        EXPECT_EQ(0, cache.size());
+
+        err = srs_error_new(ERROR_SOCKET_TIMEOUT, "timeout");
+        cache.update(key, err, 0, "", 0, 10 * SRS_UTIME_SECONDS);
+        srs_freep(err);
+        EXPECT_EQ(0, cache.size());
+
+        err = srs_error_new(ERROR_HTTP_STATUS_INVALID, "status 403");
+        cache.update(key, err, 403, "", 10 * SRS_UTIME_SECONDS, 0);
+        srs_freep(err);
+        EXPECT_EQ(0, cache.size());
+
+        err = srs_error_new(ERROR_HTTP_STATUS_INVALID, "status 403");
+        cache.update(key, err, 403, "", 0, 10 * SRS_UTIME_SECONDS);
+        srs_freep(err);
+        EXPECT_EQ(1, cache.size());
+        EXPECT_TRUE(cache.fetch(key, &err));
+        EXPECT_EQ(ERROR_HTTP_STATUS_INVALID, srs_error_code(err));
+        srs_freep(err);
+
+        err = srs_error_new(ERROR_RESPONSE_CODE, "code 1");
+        cache.update(key, err, 200, "{\"code\":1}", 0, 10 * SRS_UTIME_SECONDS);
+        srs_freep(err);
+        EXPECT_TRUE(cache.fetch(key, &err));
+        EXPECT_EQ(ERROR_RESPONSE_CODE, srs_error_code(err));
+        srs_freep(err);
+    }
+
+    // Evict the least recently used decision.
+    if (true) {
+        SrsHttpHooksCache cache(2);
+        cache.update("a", srs_success, 200, "0", 10 * SRS_UTIME_SECONDS, 0);
+        cache.update("b", srs_success, 200, "0", 10 * SRS_UTIME_SECONDS, 0);
+        EXPECT_TRUE(cache.fetch("a", &err));
+
+        cache.update("c", srs_success, 200, "0", 10 * SRS_UTIME_SECONDS, 0);
+        EXPECT_EQ(2, cache.size());
+        EXPECT_TRUE(cache.fetch("a", &err));
+        EXPECT_FALSE(cache.fetch("b", &err));
+        EXPECT_TRUE(cache.fetch("c", &err));
+    }
+}
+
 VOID TEST(TCPServerTest, ContextUtility)
 {
     if (true) {
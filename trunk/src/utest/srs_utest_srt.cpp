@@ -11,10 +11,19 @@
 #include <srs_protocol_rtmp_stack.hpp>
 #include <srs_app_srt_utility.hpp>
 #include <srs_app_srt_server.hpp>
+#include <srs_app_srt_source.hpp>
+#include <srs_protocol_utility.hpp>
 #include <srs_core_autofree.hpp>
+#include <srs_kernel_ts.hpp>
+#include <srs_utest_kernel.hpp>
+#include <srs_utest_config.hpp>
+#ifdef SRS_RTC
+#include <srs_app_rtc_source.hpp>
+#endif
 
 #include <sstream>
 #include <vector>
+#include <sys/resource.h>
 using namespace std;
 
 #include <srt/srt.h>
@@ -316,6 +325,71 @@ VOID TEST(ServiceStSRTTest, ReadWrite)
     }
 }
 
+// Benchmark the latency of SRT echo and the CPU of idle SRT event loop, which should never poll by sleep.
+VOID TEST(ServiceStSRTTest, ReadWriteLatency)
+{
+    srs_error_t err = srs_success;
+
+    std::string server_ip = "127.0.0.1";
+    int server_port = 19001;
+
+    MockSrtServer srt_server;
+    HELPER_EXPECT_SUCCESS(srt_server.create_socket());
+    HELPER_EXPECT_SUCCESS(srt_server.listen(server_ip, server_port));
+
+    srs_srt_t srt_client_fd = srs_srt_socket_invalid();
+    HELPER_EXPECT_SUCCESS(srs_srt_socket_with_default_option(&srt_client_fd));
+    SrsSrtSocket* srt_client_socket = new SrsSrtSocket(_srt_eventloop->poller(), srt_client_fd);
+    SrsAutoFree(SrsSrtSocket, srt_client_socket);
+    HELPER_EXPECT_SUCCESS(srt_client_socket->connect(server_ip, server_port));
+
+    srs_srt_t srt_server_accepted_fd = srs_srt_socket_invalid();
+    HELPER_EXPECT_SUCCESS(srt_server.accept(&srt_server_accepted_fd));
+    SrsSrtSocket* srt_server_accepted_socket = new SrsSrtSocket(_srt_eventloop->poller(), srt_server_accepted_fd);
+    SrsAutoFree(SrsSrtSocket, srt_server_accepted_socket);
+
+    // The latency of echo, each round trip is two SRT hops.
+    if (true) {
+        char buf[1316];
+        memset(buf, 0, sizeof(buf));
+
+        int nn_rounds = 100;
+        srs_utime_t max_rtt = 0;
+        srs_utime_t starttime = srs_update_system_time();
+        for (int i = 0; i < nn_rounds; i++) {
+            srs_utime_t start = srs_update_system_time();
+
+            ssize_t nb = 0;
+            HELPER_ASSERT_SUCCESS(srt_client_socket->sendmsg(buf, sizeof(buf), &nb));
+            HELPER_ASSERT_SUCCESS(srt_server_accepted_socket->recvmsg(buf, sizeof(buf), &nb));
+            HELPER_ASSERT_SUCCESS(srt_server_accepted_socket->sendmsg(buf, nb, &nb));
+            HELPER_ASSERT_SUCCESS(srt_client_socket->recvmsg(buf, sizeof(buf), &nb));
+
+            max_rtt = srs_max(max_rtt, srs_update_system_time() - start);
+        }
+        srs_utime_t avg_rtt = (srs_update_system_time() - starttime) / nn_rounds;
+        printf("SRT echo %d rounds, avg rtt=%dus, max rtt=%dus\n", nn_rounds, (int)avg_rtt, (int)max_rtt);
+
+        // The libsrt fires IN when ACK for non-TSBPD mode, which is about 5ms for each hop, while it's about 10ms for
+        // each hop if polling by sleep of 10ms.
+        EXPECT_LT(avg_rtt, 15 * SRS_UTIME_MILLISECONDS);
+    }
+
+    // The CPU of idle event loop, which is blocked on the pipe without wakeups.
+    if (true) {
+        struct rusage ru0, ru1;
+        getrusage(RUSAGE_SELF, &ru0);
+
+        srs_utime_t duration = 500 * SRS_UTIME_MILLISECONDS;
+        srs_usleep(duration);
+
+        getrusage(RUSAGE_SELF, &ru1);
+        srs_utime_t cpu = (ru1.ru_utime.tv_sec - ru0.ru_utime.tv_sec) * SRS_UTIME_SECONDS + (ru1.ru_utime.tv_usec - ru0.ru_utime.tv_usec)
+            + (ru1.ru_stime.tv_sec - ru0.ru_stime.tv_sec) * SRS_UTIME_SECONDS + (ru1.ru_stime.tv_usec - ru0.ru_stime.tv_usec);
+        printf("SRT idle %dms, cpu=%dus, %.2f%%\n", srsu2msi(duration), (int)cpu, 100.0 * cpu / duration);
+    }
+}
+
 // Test srt server 
 class MockSrtHandler : public ISrsSrtHandler
 {
@@ -553,3 +627,249 @@ VOID TEST(ServiceSRTTest, Encrypt)
 // TODO: FIXME: add mpegts conn test
 // set srt option, recv srt client, get srt client opt and check.
 
+
+VOID TEST(SrtSourceTest, ConsumerSharedBatch)
+{
+    srs_error_t err = srs_success;
+
+    SrsRequest req;
+    req.vhost = "__defaultVhost__";
+    req.app = "live";
+    req.stream = "livestream";
+
+    SrsSrtSource source;
+    HELPER_EXPECT_SUCCESS(source.initialize(&req));
+
+    SrsSrtConsumer* c0 = NULL;
+    HELPER_EXPECT_SUCCESS(source.create_consumer(c0));
+    SrsAutoFree(SrsSrtConsumer, c0);
+
+    SrsSrtConsumer* c1 = NULL;
+    HELPER_EXPECT_SUCCESS(source.create_consumer(c1));
+    SrsAutoFree(SrsSrtConsumer, c1);
+
+    // Publish three packets, which are shared by all consumers.
+    for (int i = 0; i < 3; i++) {
+        char ts[188 * 7];
+        memset(ts, i, sizeof(ts));
+
+        SrsSrtPacket pkt;
+        pkt.wrap(ts, sizeof(ts));
+        HELPER_EXPECT_SUCCESS(source.on_packet(&pkt));
+    }
+
+    // Dump in batch, limited by the max.
+    SrsSrtPacket* pkts0[2];
+    int count = 0;
+    HELPER_EXPECT_SUCCESS(c0->dump_packets(pkts0, 2, count));
+    EXPECT_EQ(2, count);
+    EXPECT_EQ(0, pkts0[0]->data()[0]);
+    EXPECT_EQ(1, pkts0[1]->data()[0]);
+
+    SrsSrtPacket* pkts1[8];
+    HELPER_EXPECT_SUCCESS(c1->dump_packets(pkts1, 8, count));
+    EXPECT_EQ(3, count);
+
+    // The consumers share the same packets, without copy.
+    EXPECT_TRUE(pkts0[0] == pkts1[0]);
+    EXPECT_TRUE(pkts0[1] == pkts1[1]);
+    EXPECT_EQ(188 * 7, pkts1[2]->size());
+
+    // The packet is freed by the last owner.
+    for (int i = 0; i < 2; i++) {
+        SrsSrtPacket::release(pkts0[i]);
+    }
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(i, pkts1[i]->data()[0]);
+        SrsSrtPacket::release(pkts1[i]);
+    }
+
+    // The left packet is freed by consumer.
+    HELPER_EXPECT_SUCCESS(c1->dump_packets(pkts1, 8, count));
+    EXPECT_EQ(0, count);
+}
+
+// Mux a H.264 frame to TS, with SPS/PPS before IDR.
+srs_error_t srs_utest_mux_avc_ts(SrsTsContextWriter* writer, int64_t dts, int64_t pts, bool idr, int size)
+{
+    srs_error_t err = srs_success;
+
+    SrsTsMessage msg;
+    msg.sid = SrsTsPESStreamIdVideoCommon;
+    msg.dts = dts;
+    msg.pts = pts;
+
+    if (idr) {
+        uint8_t sps_pps[] = {
+            0x00, 0x00, 0x00, 0x01, 0x67, 0x64, 0x00, 0x1f, 0xac, 0xd9, 0x40, 0x50,
+            0x00, 0x00, 0x00, 0x01, 0x68, 0xeb, 0xe3, 0xcb,
+        };
+        msg.payload->append((char*)sps_pps, sizeof(sps_pps));
+    }
+
+    // The slice header of P/I frame, all bits set, so the first_mb_in_slice and slice_type are 0, not B frame.
+    uint8_t header[] = {0x00, 0x00, 0x00, 0x01, (uint8_t)(idr ? 0x65 : 0x41)};
+    msg.payload->append((char*)header, sizeof(header));
+
+    vector<char> slice(size, (char)0xff);
+    msg.payload->append(&slice[0], size);
+
+    if ((err = writer->write_video(&msg)) != srs_success) {
+        return srs_error_wrap(err, "write video");
+    }
+
+    return err;
+}
+
+VOID TEST(SrtSourceTest, HlsBridgeScanTs)
+{
+    srs_error_t err = srs_success;
+
+    MockSrsFileWriter f;
+    SrsTsContext ctx;
+    SrsTsContextWriter writer(&f, &ctx, SrsAudioCodecIdDisabled, SrsVideoCodecIdAVC);
+
+    HELPER_EXPECT_SUCCESS(srs_utest_mux_avc_ts(&writer, 90000, 93600, true, 1000));
+    HELPER_EXPECT_SUCCESS(srs_utest_mux_avc_ts(&writer, 93600, 97200, false, 500));
+
+    int nb_packets = (int)(f.filesize() / SRS_TS_PACKET_SIZE);
+    EXPECT_EQ(0, f.filesize() % SRS_TS_PACKET_SIZE);
+    EXPECT_TRUE(nb_packets > 4);
+
+    // Only scan the headers of TS packets, the frame starts with dts.
+    SrsHlsFromSrtBridge bridge;
+    vector<int64_t> dts;
+    vector<bool> keyframes;
+    for (int i = 0; i < nb_packets; i++) {
+        int64_t v = -1;
+        bool keyframe = false;
+        bridge.scan_ts_packet(f.data() + i * SRS_TS_PACKET_SIZE, v, keyframe);
+        if (v >= 0) {
+            dts.push_back(v);
+            keyframes.push_back(keyframe);
+        }
+    }
+
+    EXPECT_TRUE(bridge.pmt_pid_ > 0);
+    EXPECT_TRUE(bridge.video_pid_ > 0);
+    EXPECT_EQ(-1, bridge.audio_pid_);
+    EXPECT_EQ(SrsTsStreamVideoH264, bridge.video_codec_);
+    EXPECT_EQ(2 * SRS_TS_PACKET_SIZE, (int)bridge.psi_.size());
+
+    ASSERT_EQ(2, (int)dts.size());
+    EXPECT_EQ(90000, dts[0]);
+    EXPECT_TRUE(keyframes[0]);
+    EXPECT_EQ(93600, dts[1]);
+    EXPECT_FALSE(keyframes[1]);
+}
+
+VOID TEST(SrtSourceTest, HlsBridgeIgnoreError)
+{
+    srs_error_t err = srs_success;
+
+    MockSrsConfig conf;
+    HELPER_ASSERT_SUCCESS(conf.parse(_MIN_OK_CONF "vhost __defaultVhost__ {srt {enabled on; srt_to_hls on;} hls {enabled on; hls_path /proc/srs-utest-hls; hls_dispose 10;}}"));
+
+    SrsConfig* saved = _srs_config;
+    _srs_config = &conf;
+
+    SrsRequest req;
+    req.vhost = "__defaultVhost__";
+    req.app = "live";
+    req.stream = "livestream";
+
+    // The HLS is owned by source, which lives across publish.
+    SrsSrtSource* source = new SrsSrtSource();
+    SrsAutoFree(SrsSrtSource, source);
+    HELPER_EXPECT_SUCCESS(source->initialize(&req));
+    EXPECT_TRUE(source->hls_ != NULL);
+
+    // Failed to open the segment, but the stream is not broken.
+    HELPER_EXPECT_SUCCESS(source->on_publish());
+    EXPECT_TRUE(source->hls_->last_update_time_ > 0);
+    EXPECT_FALSE(source->hls_->enabled_);
+    EXPECT_FALSE(source->hls_->disposable_);
+
+    char ts[188 * 7];
+    memset(ts, 0, sizeof(ts));
+    SrsSrtPacket pkt;
+    pkt.wrap(ts, sizeof(ts));
+    HELPER_EXPECT_SUCCESS(source->on_packet(&pkt));
+
+    source->on_unpublish();
+    EXPECT_TRUE(source->can_publish());
+
+    // Nothing to dispose, for HLS is never published.
+    HELPER_EXPECT_SUCCESS(source->hls_->on_timer(1 * SRS_UTIME_SECONDS));
+    EXPECT_FALSE(source->hls_->disposable_);
+
+    _srs_config = saved;
+}
+
+#ifdef SRS_RTC
+VOID TEST(SrtSourceTest, RtcBridgeFromTs)
+{
+    srs_error_t err = srs_success;
+
+    SrsRequest req;
+    req.vhost = "__defaultVhost__";
+    req.app = "live";
+    req.stream = "livestream";
+
+    SrsRtcSource rtc;
+    HELPER_EXPECT_SUCCESS(rtc.initialize(&req));
+
+    SrsRtcConsumer* consumer = NULL;
+    HELPER_EXPECT_SUCCESS(rtc.create_consumer(consumer));
+    SrsAutoFree(SrsRtcConsumer, consumer);
+
+    SrsRtcFromSrtBridge bridge(&rtc);
+    HELPER_EXPECT_SUCCESS(bridge.initialize(&req));
+    HELPER_EXPECT_SUCCESS(bridge.on_publish());
+
+    // A IDR larger than a RTP packet, and a small P frame.
+    MockSrsFileWriter f;
+    SrsTsContext ctx;
+    SrsTsContextWriter writer(&f, &ctx, SrsAudioCodecIdDisabled, SrsVideoCodecIdAVC);
+    HELPER_EXPECT_SUCCESS(srs_utest_mux_avc_ts(&writer, 90000, 93600, true, 2000));
+    HELPER_EXPECT_SUCCESS(srs_utest_mux_avc_ts(&writer, 93600, 97200, false, 500));
+
+    SrsSrtPacket pkt;
+    pkt.wrap(f.data(), (int)f.filesize());
+    HELPER_EXPECT_SUCCESS(bridge.on_packet(&pkt));
+
+    // The STAP-A with SPS/PPS, two FU-A for IDR, then the P frame.
+    vector<SrsRtpPacket*> pkts;
+    while (true) {
+        SrsRtpPacket* p = NULL;
+        HELPER_EXPECT_SUCCESS(consumer->dump_packet(&p));
+        if (!p) break;
+        pkts.push_back(p);
+    }
+
+    ASSERT_EQ(4, (int)pkts.size());
+    EXPECT_EQ(kStapA, pkts[0]->nalu_type);
+    EXPECT_EQ(kFuA, pkts[1]->nalu_type);
+    EXPECT_EQ(kFuA, pkts[2]->nalu_type);
+    EXPECT_EQ(SrsAvcNaluTypeNonIDR, pkts[3]->nalu_type);
+
+    // The timestamp is the pts in 90kHz, and the last packet of frame is marked.
+    EXPECT_EQ(93600, (int)pkts[0]->header.get_timestamp());
+    EXPECT_EQ(93600, (int)pkts[2]->header.get_timestamp());
+    EXPECT_EQ(97200, (int)pkts[3]->header.get_timestamp());
+    EXPECT_FALSE(pkts[1]->header.get_marker());
+    EXPECT_TRUE(pkts[2]->header.get_marker());
+    EXPECT_TRUE(pkts[3]->header.get_marker());
+
+    // The sequence is continuous.
+    for (int i = 1; i < (int)pkts.size(); i++) {
+        EXPECT_EQ((uint16_t)(pkts[i - 1]->header.get_sequence() + 1), pkts[i]->header.get_sequence());
+    }
+
+    for (int i = 0; i < (int)pkts.size(); i++) {
+        srs_freep(pkts[i]);
+    }
+
+    bridge.on_unpublish();
+}
+#endif